@@ -0,0 +1,59 @@
+#ifndef _ANIMATIONCLIPCLASS_H_
+#define _ANIMATIONCLIPCLASS_H_
+
+//	Includes:
+#include <directxmath.h>
+#include <DirectXPackedVector.h>
+#include <vector>
+//	Namespaces:
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+using namespace std;
+
+//	The AnimationClipClass stores a looping animation for one skeleton in compressed form. Keys are sampled
+//	at a fixed rate, and the clip is compressed three ways:
+//
+//	- Tracks that do not change over the clip are stored once instead of per key.
+//	- Rotations are quantized to four signed 16 bit components, half the size of four floats.
+//	- Translations are quantized to 16 bits per axis inside the range the track actually covers.
+//
+//	The keys of all animated tracks are stored frame by frame, so sampling touches two short runs of
+//	memory, and each key is decoded with a single SIMD load that converts the integers to floats.
+class AnimationClipClass
+{
+public:
+	AnimationClipClass();
+	AnimationClipClass(const AnimationClipClass&);
+	~AnimationClipClass();
+
+//	Initialize takes frameCount keys for every joint, frame by frame, with the last frame equal to the
+//	first so the clip loops without a jump.
+	bool Initialize(int, int, float, const XMFLOAT4*, const XMFLOAT3*);
+	void Shutdown();
+
+	void Sample(float, XMVECTOR*, XMVECTOR*);
+
+	int GetJointCount();
+	float GetDuration();
+	unsigned int GetCompressedSize();
+
+private:
+	int m_jointCount, m_frameCount;
+	float m_framesPerSecond, m_duration;
+
+//	Constant tracks hold their single value here, animated tracks overwrite it when sampled:
+	vector<XMFLOAT4> m_constantRotations;
+	vector<XMFLOAT4> m_constantTranslations;
+
+//	The joint of every animated track, and the keys of all animated tracks frame by frame:
+	vector<int> m_rotationJoints;
+	vector<int> m_translationJoints;
+	vector<XMSHORTN4> m_rotationKeys;
+	vector<XMUSHORTN4> m_translationKeys;
+
+//	The range of every animated translation track that its quantized keys map to:
+	vector<XMFLOAT4> m_translationMinimums;
+	vector<XMFLOAT4> m_translationScales;
+};
+
+#endif
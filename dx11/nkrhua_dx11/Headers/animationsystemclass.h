@@ -0,0 +1,71 @@
+#ifndef _ANIMATIONSYSTEMCLASS_H_
+#define _ANIMATIONSYSTEMCLASS_H_
+
+//	Includes:
+#include <directxmath.h>
+#include <vector>
+#include "skeletonclass.h"
+#include "animationclipclass.h"
+#include "jobsystemclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	The number of clips that can be blended on one character at the same time.
+const int ANIMATION_MAX_LAYERS = 4;
+
+//	Characters are handed to the job threads in batches of this many.
+const int ANIMATION_BATCH_SIZE = 16;
+
+//	The AnimationSystemClass animates a crowd of characters that share one skeleton. Every character plays
+//	up to ANIMATION_MAX_LAYERS clips with their own time, speed and weight. Update samples and blends the
+//	clips of every character and computes its skinning palette, with the characters split across the job
+//	threads. The palettes of all characters live in one array so skinning can read them without chasing
+//	pointers.
+class AnimationSystemClass
+{
+private:
+	struct LayerType
+	{
+		AnimationClipClass* clip;
+		float time;
+		float speed;
+		float weight;
+	};
+
+	struct CharacterType
+	{
+		LayerType layers[ANIMATION_MAX_LAYERS];
+	};
+
+public:
+	AnimationSystemClass();
+	AnimationSystemClass(const AnimationSystemClass&);
+	~AnimationSystemClass();
+
+	bool Initialize(SkeletonClass*, int);
+	void Shutdown();
+
+	int AddCharacter();
+	void SetLayer(int, int, AnimationClipClass*, float, float, float);
+
+	void Update(JobSystemClass*, float);
+
+	const XMFLOAT4X4* GetPalette(int);
+	int GetCharacterCount();
+	int GetJointCount();
+
+//	The number of characters animated per millisecond on each job thread during the last Update.
+	float GetCharactersPerMillisecond();
+
+private:
+	void AnimateCharacter(int, float);
+
+	SkeletonClass* m_Skeleton;
+	int m_jointCount, m_maxCharacters;
+	vector<CharacterType> m_characters;
+	vector<XMFLOAT4X4> m_palettes;
+	float m_charactersPerMillisecond;
+};
+
+#endif
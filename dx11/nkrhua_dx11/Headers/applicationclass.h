@@ -1,19 +1,239 @@
 #ifndef _APPLICATIONCLASS_H_
 #define _APPLICATIONCLASS_H_
 
+#pragma comment(lib, "winmm.lib")
+
 #include "d3dclass.h"
 #include "cameraclass.h"
 #include "modelclass.h"
+#include "geometryheapclass.h"
+#include "shadermanagerclass.h"
 #include "colorshaderclass.h"
+#include "geometrystreamclass.h"
+#include "rendertextureclass.h"
+#include "framecaptureclass.h"
+#include "timerclass.h"
+#include "jobsystemclass.h"
+#include "skinnedmodelclass.h"
+#include "animationsystemclass.h"
+#include "particlesystemclass.h"
+#include "terrainclass.h"
+#include "terrainshaderclass.h"
+#include "bvhclass.h"
+#include "lightclusterclass.h"
+#include "shadowclass.h"
+#include "entityworldclass.h"
+#include "scenesystemsclass.h"
+#include "batchmathclass.h"
+#include "scenepackageclass.h"
+#include "scenecookclass.h"
+#include "taskgraphclass.h"
+#include "meshcodecclass.h"
+#include "staticbatchclass.h"
+#include "renderstatsclass.h"
+#include "dynamicresolutionclass.h"
+#include "triplebufferclass.h"
+#include "pipelinestatsclass.h"
+#include "fontclass.h"
+#include "textclass.h"
+#include "spritebatchclass.h"
+#include "debugdrawclass.h"
+#include "geometrybenchmarkclass.h"
+#include "mathbenchmarkclass.h"
+#include "meshbenchmarkclass.h"
+#include "staticbatchbenchmarkclass.h"
+#include "replaybenchmarkclass.h"
+#include "textbenchmarkclass.h"
+#include "spritebenchmarkclass.h"
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
 
 const bool FULL_SCREEN = false;
 const bool VSYNC_ENABLED = true;
 const float SCREEN_DEPTH = 1000.0f;
 const float SCREEN_NEAR = 0.3f;
+const unsigned int GEOMETRY_STREAM_SIZE = 32 * 1024 * 1024;
+
+//	Static meshes share the buffers of the Geometry Heap, which has room for GEOMETRY_HEAP_VERTICES vertices
+//	and GEOMETRY_HEAP_INDICES indices and moves up to GEOMETRY_DEFRAG_BYTES of them a frame to close the
+//	holes left by freed meshes. With a benchmark mesh count above zero Initialize also creates that many
+//	meshes both in a heap and in buffers of their own, times creating and drawing them both ways and how
+//	long the heap takes to defragment after half of them are replaced, and writes it all to GEOMETRY_REPORT.
+const unsigned int GEOMETRY_HEAP_VERTICES = 1024 * 1024;
+const unsigned int GEOMETRY_HEAP_INDICES = 4 * 1024 * 1024;
+const unsigned int GEOMETRY_DEFRAG_BYTES = 256 * 1024;
+const int GEOMETRY_BENCHMARK_MESHES = 0;
+const char* const GEOMETRY_REPORT = "geometry-report.txt";
+
+//	Frame capture renders every CAPTURE_INTERVAL frames offscreen as well and writes the result to
+//	CAPTURE_OUTPUT, comparing it with the image of the same frame under CAPTURE_GOLDEN if there is one.
+//	Captures meant to be compared should be rendered with the software renderer so they don't depend
+//	on the video card.
+const bool SOFTWARE_RENDERER = false;
+const bool CAPTURE_ENABLED = false;
+const int CAPTURE_INTERVAL = 60;
+const char* const CAPTURE_OUTPUT = "capture-";
+const char* const CAPTURE_GOLDEN = "golden/capture-";
+
+//	The number of animated characters in the scene. With CPU skinning off they are still animated every
+//	frame, which is useful for timing the animation on its own, but nothing is drawn for them.
+const int ANIMATED_CHARACTER_COUNT = 16;
+const bool CPU_SKINNING = true;
+const unsigned int SKINNED_OFFSET_NONE = 0xFFFFFFFF;
+
+//	The most particles the fountain can have alive at once. Every live particle takes 80 bytes of the
+//	Geometry Stream each frame.
+const int MAX_PARTICLES = 100000;
+
+//	The terrain is generated into TERRAIN_FILE with TERRAIN_SIZE quads a side when the file does not
+//	exist yet. Chunks are split until their error on screen is at most TERRAIN_ERROR_THRESHOLD pixels.
+const char* const TERRAIN_FILE = "terrain.dat";
+const int TERRAIN_SIZE = 4096;
+const float TERRAIN_ERROR_THRESHOLD = 2.0f;
+
+//	The scene is lit by LIGHT_COUNT point and spot lights circling above the terrain, culled into clusters
+//	every frame.
+const bool CLUSTERED_LIGHTING = true;
+const int LIGHT_COUNT = 4096;
+
+//	A directional light casts shadows from the triangle and the characters through cascaded shadow maps of
+//	SHADOW_MAP_SIZE texels a side. The shadows are drawn by the lit permutation, so they need the clustered
+//	lighting to be on as well.
+const bool SHADOWS_ENABLED = true;
+const int SHADOW_MAP_SIZE = 2048;
+
+//	With a benchmark count above zero Initialize times every batch math path the processor supports over
+//	arrays of that many points and matrices against the same work done one at a time with DirectXMath,
+//	counts the results that are not exactly what DirectXMath gives and writes both to MATH_REPORT.
+const int MATH_BENCHMARK_COUNT = 0;
+const char* const MATH_REPORT = "math-report.txt";
+
+//	The objects of the scene are read from the package in SCENE_FILE, which is cooked from the built in layout,
+//	the triangle with the characters in rows behind it, whenever it can't be opened.
+const char* const SCENE_FILE = "scene.pkg";
+
+//	Initialize runs as a graph of tasks on STARTUP_THREADS workers besides this thread, 0 meaning one less
+//	than there are cores, and appends the timeline of every launch to STARTUP_REPORT along with the time it
+//	took to present the first frame.
+const int STARTUP_THREADS = 0;
+const char* const STARTUP_REPORT = "startup-report.txt";
+
+//	The model is imported from the compressed mesh in MODEL_FILE, which is exported from the built in triangle
+//	whenever it can't be read. With a benchmark size above zero Initialize also encodes a grid of that many
+//	vertices a side in the full and the compact color vertex, times decoding it with SSE2 and a byte at a time
+//	and reading it from a mesh file against reading it uncompressed, and writes it to MESH_REPORT.
+const char* const MODEL_FILE = "triangle.mesh";
+const int MESH_BENCHMARK_SIZE = 0;
+const char* const MESH_REPORT = "mesh-report.txt";
+
+//	With static batching the mesh objects of the scene are merged by material into the Static Batch and drawn
+//	a batch or a run of visible ranges at a time, instead of a draw each. They still cast their shadows one by
+//	one, since the shadow cascades cull and sort them as objects. With a benchmark object count above zero
+//	Initialize also scatters that many triangles over a field in front of the camera with 16 materials and
+//	times drawing them one by one against drawing them batched, and writes the draw counts to STATIC_REPORT.
+const bool STATIC_BATCHING = true;
+const int STATIC_BENCHMARK_OBJECTS = 0;
+const char* const STATIC_REPORT = "static-report.txt";
+
+//	With a capture frame above zero the commands of COMMAND_CAPTURE_FRAMES frames starting with that one are
+//	recorded to COMMAND_CAPTURE_FILE. With a replay file Initialize plays its frames REPLAY_LOOPS times on a
+//	device of its own and appends the cost of every draw to REPLAY_REPORT. The software renderer is used for
+//	the replay when it is on, so reports from different machines can be compared.
+const int COMMAND_CAPTURE_FRAME = 0;
+const int COMMAND_CAPTURE_FRAMES = 1;
+const char* const COMMAND_CAPTURE_FILE = "frame.cmd";
+const char* const REPLAY_FILE = "";
+const int REPLAY_LOOPS = 100;
+const char* const REPLAY_REPORT = "replay-report.txt";
+
+//	With render statistics on the device context counts the draws, primitives, state binds, maps and uploads
+//	of every frame, and the frame time, culled objects and memory are added to them. The last STATS_WINDOW
+//	frames are kept, every frame is written to STATS_CSV when it has a name, and every STATS_EXPORT_INTERVAL
+//	frames the window is written to STATS_JSON and, with the overlay on, drawn in the top left corner of the
+//	screen, or shown in the title of the window when there is no text.
+const bool STATS_ENABLED = true;
+const int STATS_WINDOW = 300;
+const char* const STATS_CSV = "";
+const char* const STATS_JSON = "stats.json";
+const int STATS_EXPORT_INTERVAL = 60;
+const bool STATS_OVERLAY = true;
+
+//	With dynamic resolution on the scene is drawn at a scale of the screen between the smallest and the
+//	largest and stretched over the back buffer. The scale is picked from the time the GPU takes for a frame
+//	so it stays near DYNAMIC_RESOLUTION_TARGET milliseconds. A largest scale above one draws the scene at
+//	more than the size of the screen when there is time for it. It is off while frames are captured, since
+//	captures are compared with images of the size of the screen.
+const bool DYNAMIC_RESOLUTION_ENABLED = true;
+const float DYNAMIC_RESOLUTION_TARGET = 14.0f;
+const float DYNAMIC_RESOLUTION_MINIMUM = 0.5f;
+const float DYNAMIC_RESOLUTION_MAXIMUM = 1.0f;
+
+//	With the simulation threaded the characters, entities, lights and the flying camera are stepped
+//	SIMULATION_RATE times a second on a thread of their own, and every step is published as a snapshot the
+//	frames draw from, blended between the step before and the last one. Otherwise they are stepped once a
+//	frame by the time it took, as before. At shutdown the steps, the snapshots no frame drew and the time from
+//	the start of a step to the frame showing it are appended to PIPELINE_REPORT.
+const bool SIMULATION_THREADED = true;
+const int SIMULATION_RATE = 60;
+const char* const PIPELINE_REPORT = "pipeline-report.txt";
+
+//	Text is drawn in TEXT_FONT at TEXT_FONT_SIZE pixels, at most TEXT_FRAME_GLYPHS glyphs a frame. With a
+//	benchmark string count above zero Initialize lays out that many different strings without drawing them,
+//	then lays them out again from the cache, and appends the glyphs per millisecond of both to TEXT_REPORT.
+const bool TEXT_ENABLED = true;
+const wchar_t* const TEXT_FONT = L"Consolas";
+const int TEXT_FONT_SIZE = 16;
+const int TEXT_FRAME_GLYPHS = 4096;
+const int TEXT_BENCHMARK_STRINGS = 0;
+const char* const TEXT_REPORT = "text-report.txt";
+
+//	Sprites are drawn over the scene and under the text, at most SPRITE_MAX_SPRITES a frame, with
+//	SPRITE_TEXTURE_COUNT made up textures of SPRITE_TEXTURE_SIZE texels. With a demo count above zero the job
+//	threads draw that many sprites every frame, SPRITE_BATCH_SIZE to a batch, spread over SPRITE_LAYER_COUNT
+//	layers. With a benchmark count above zero Initialize draws that many the same way a few times, flushes them
+//	and appends the fastest time and how many sprites that makes in a frame at 60 Hz to SPRITE_REPORT.
+const bool SPRITE_ENABLED = true;
+const int SPRITE_MAX_SPRITES = 262144;
+const int SPRITE_TEXTURE_COUNT = 4;
+const int SPRITE_TEXTURE_SIZE = 32;
+const int SPRITE_LAYER_COUNT = 4;
+const int SPRITE_BATCH_SIZE = 4096;
+const int SPRITE_DEMO_COUNT = 0;
+const int SPRITE_BENCHMARK_COUNT = 0;
+const char* const SPRITE_REPORT = "sprite-report.txt";
+
+//	Debug drawing is only compiled into debug builds, see debugdrawclass.h. There DEBUG_DRAW_BOUNDS draws the
+//	box of every object, hidden by what is in front of it, and DEBUG_DRAW_LIGHTS the range of every light and the
+//	direction of the spot lights on top of everything, from the job threads DEBUG_DRAW_BATCH_SIZE lights to a
+//	batch. At most DEBUG_DRAW_MAX_VERTICES line vertices are drawn a frame.
+const bool DEBUG_DRAW_BOUNDS = false;
+const bool DEBUG_DRAW_LIGHTS = false;
+const int DEBUG_DRAW_BATCH_SIZE = 64;
+const int DEBUG_DRAW_MAX_VERTICES = 131072;
 
 
 class ApplicationClass
 {
+private:
+//	A snapshot is what a step of the simulation hands the frames: the state after the step along with the
+//	state before it, so a frame can be drawn anywhere in between. The transforms, renderables and boxes are
+//	those of the objects of the scene and the palettes those of all characters, one after another. The frames
+//	draw from nothing else, since the simulation runs the systems of the Entity World meanwhile.
+	struct SnapshotType
+	{
+		chrono::high_resolution_clock::time_point start, published;
+		XMFLOAT3 cameraPosition, previousCameraPosition;
+		vector<TransformType> transforms, previousTransforms;
+		vector<RenderableType> renderables;
+		vector<EntityBoundsType> bounds;
+		vector<XMFLOAT4X4> palettes;
+		vector<LightClusterClass::LightType> lights;
+		vector<XMFLOAT3> previousLightPositions;
+	};
+
 public:
 	ApplicationClass();
 	ApplicationClass(const ApplicationClass&);
@@ -22,12 +242,105 @@ public:
 	bool Initialize(int, int, HWND);
 	void Shutdown();
 	bool Frame();
+	void Pick(int, int);
 
 private:
 	bool Render();
+	bool RenderScene(XMMATRIX, XMMATRIX);
+	bool RenderCapture(XMMATRIX);
+	void SkinCharacters();
+	bool RenderParticles(XMMATRIX, XMMATRIX);
+	bool InitializePicking();
+	void UpdatePicking();
+	XMFLOAT3 GetCharacterPosition(int);
+	void InitializeLights();
+	void UpdateLights(float);
+	unsigned int GetLightingPermutation();
+	bool InitializeShadows();
+	bool RenderShadows();
+	bool InitializeEntities();
+	bool SetRenderable(const RenderableType&, int&, int&, int&);
+	bool InitializeScene();
+	int ResolveMesh(const char*);
+	bool InitializeStaticBatches();
+	bool RenderStaticBatches(StaticBatchClass*, XMMATRIX, XMMATRIX);
+	void UpdateRenderStats();
+	bool RenderText();
+	bool InitializeSprites(int, int);
+	void DrawSprites(int, float);
+	bool RenderSprites();
+#if DEBUG_DRAW_ENABLED
+	bool RenderDebugDraw(XMMATRIX, XMMATRIX);
+#endif
+	void Simulate(float);
+	void ApplyPick();
+	void PublishSnapshot(chrono::high_resolution_clock::time_point);
+	void ApplySnapshot();
+	void SimulationThread();
+
 	D3DClass* m_Direct3D;
 	CameraClass* m_Camera;
 	ModelClass* m_Model;
+	GeometryHeapClass* m_GeometryHeap;
+	ShaderManagerClass* m_ShaderManager;
 	ColorShaderClass* m_ColorShader;
+	GeometryStreamClass* m_GeometryStream;
+	RenderTextureClass* m_RenderTexture;
+	FrameCaptureClass* m_FrameCapture;
+	int m_frameNumber;
+	TimerClass* m_Timer;
+	JobSystemClass* m_JobSystem;
+	SkinnedModelClass* m_SkinnedModel;
+	AnimationSystemClass* m_Animation;
+	vector<unsigned int> m_skinnedOffsets;
+	ParticleSystemClass* m_ParticleSystem;
+	bool m_particlesWritten;
+	TerrainShaderClass* m_TerrainShader;
+	TerrainClass* m_Terrain;
+	BVHClass* m_MeshBVH;
+	BVHClass* m_SceneBVH;
+	vector<BVHClass::BoundsType> m_sceneBounds;
+	int m_screenWidth, m_screenHeight;
+	int m_pickedCharacter;
+	LightClusterClass* m_LightCluster;
+	vector<LightClusterClass::LightType> m_lights;
+	vector<XMFLOAT4> m_lightOrbits;
+	ShadowClass* m_Shadow;
+	ScenePackageClass* m_ScenePackage;
+	EntityWorldClass* m_Entities;
+	StaticBatchClass* m_StaticBatch;
+	SceneSystemsClass* m_SceneSystems;
+	int m_transformComponent, m_renderableComponent, m_boundsComponent;
+	vector<unsigned int> m_sceneEntities;
+	chrono::high_resolution_clock::time_point m_startTime;
+	bool m_firstFrameReported;
+	RenderStatsClass* m_RenderStats;
+	DynamicResolutionClass* m_DynamicResolution;
+	HWND m_hwnd;
+	TripleBufferClass* m_SnapshotBuffer;
+	SnapshotType m_snapshots[3];
+	thread m_simulationThread;
+	atomic<bool> m_simulationQuit;
+	XMFLOAT3 m_simulationCamera, m_publishedCamera;
+	vector<TransformType> m_publishedTransforms;
+	vector<XMFLOAT3> m_publishedLightPositions;
+	mutex m_pickMutex;
+	bool m_pickPending;
+	XMFLOAT3 m_pickOrigin, m_pickDirection;
+	vector<XMFLOAT4X4> m_renderWorlds;
+	vector<LightClusterClass::LightType> m_renderLights;
+	const XMFLOAT4X4* m_renderPalettes;
+	const RenderableType* m_renderRenderables;
+	const EntityBoundsType* m_renderBounds;
+	chrono::high_resolution_clock::time_point m_snapshotStart;
+	float m_snapshotAlpha;
+	PipelineStatsClass* m_PipelineStats;
+	FontClass* m_Font;
+	TextClass* m_Text;
+	char m_statsText[512];
+	SpriteBatchClass* m_SpriteBatch;
+#if DEBUG_DRAW_ENABLED
+	DebugDrawClass* m_DebugDraw;
+#endif
 };
 #endif;
\ No newline at end of file
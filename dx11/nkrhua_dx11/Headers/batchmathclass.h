@@ -0,0 +1,72 @@
+#ifndef _BATCHMATHCLASS_H_
+#define _BATCHMATHCLASS_H_
+
+//	Includes:
+#include <directxmath.h>
+//	Namespaces:
+using namespace DirectX;
+
+//	The instruction sets the kernels are written for, from the slowest to the fastest.
+enum BatchMathPath
+{
+	BATCH_MATH_SCALAR,
+	BATCH_MATH_SSE4,
+	BATCH_MATH_AVX2,
+	BATCH_MATH_PATH_COUNT
+};
+
+//	The BatchMathClass runs the math that is done over whole arrays at once: transforming points and
+//	normals by one matrix, multiplying arrays of matrices pair by pair, and transposing matrices into the
+//	column major layout the shaders read constant buffers in. Every kernel is written three times, in plain
+//	C++, with SSE4.1 and with AVX2 and FMA, and Initialize picks the fastest one the processor and the
+//	operating system support. The SSE4.1 kernels load four points at a time and turn them into one register
+//	per coordinate, the AVX2 kernels do the same with eight. The scalar and SSE4.1 kernels add in the same
+//	order as DirectXMath, so they give exactly what the one at a time XMVector3TransformCoord and
+//	XMMatrixMultiply give. The AVX2 kernels round once per fused multiply add and can be a bit or two off.
+//	Transposing only moves floats, so it is exact everywhere.
+//
+//	The arrays need no alignment, and the output of the kernels that keep the type may be the same array as
+//	the input.
+class BatchMathClass
+{
+private:
+	struct KernelsType
+	{
+		void (*transformCoords)(const XMFLOAT3*, int, const XMFLOAT4X4&, XMFLOAT3*);
+		void (*transformNormals)(const XMFLOAT3*, int, const XMFLOAT4X4&, XMFLOAT3*);
+		void (*multiplyMatrices)(const XMFLOAT4X4*, const XMFLOAT4X4*, int, XMFLOAT4X4*);
+		void (*transposeMatrices)(const XMFLOAT4X4*, int, XMFLOAT4X4*);
+		void (*packAffineMatrices)(const XMFLOAT4X4*, int, XMFLOAT4*);
+	};
+
+public:
+//	Initialize reads what the processor supports and picks the fastest path. Until it is called the scalar
+//	kernels are used.
+	static void Initialize();
+
+	static bool IsPathSupported(int);
+	static bool SetPath(int);
+	static int GetPath();
+	static const char* GetPathName(int);
+
+//	TransformCoords transforms points like XMVector3TransformCoord, divided by w, and TransformNormals
+//	transforms directions like XMVector3TransformNormal, without the translation.
+	static void TransformCoords(const XMFLOAT3*, int, const XMFLOAT4X4&, XMFLOAT3*);
+	static void TransformNormals(const XMFLOAT3*, int, const XMFLOAT4X4&, XMFLOAT3*);
+
+//	MultiplyMatrices multiplies every matrix of the first array by the matrix at the same place in the second.
+	static void MultiplyMatrices(const XMFLOAT4X4*, const XMFLOAT4X4*, int, XMFLOAT4X4*);
+
+//	TransposeMatrices writes every matrix transposed, ready to be copied into a constant buffer. An affine
+//	matrix transposed has (0, 0, 0, 1) as its last row, so PackAffineMatrices leaves it out and writes
+//	three rows a matrix, which fits a third more matrices in a constant buffer.
+	static void TransposeMatrices(const XMFLOAT4X4*, int, XMFLOAT4X4*);
+	static void PackAffineMatrices(const XMFLOAT4X4*, int, XMFLOAT4*);
+
+private:
+	static KernelsType m_kernels[BATCH_MATH_PATH_COUNT];
+	static bool m_supported[BATCH_MATH_PATH_COUNT];
+	static int m_path;
+};
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef _BVHCLASS_H_
+#define _BVHCLASS_H_
+
+//	Includes:
+#include <directxmath.h>
+#include <vector>
+#include <functional>
+#include "jobsystemclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	Every node of the tree has up to four children, whose boxes are tested against a ray at once.
+const int BVH_WIDTH = 4;
+
+//	Nodes with at most this many primitives become leaves when the SAH says splitting does not pay off.
+//	Larger nodes are always split.
+const int BVH_LEAF_SIZE = 4;
+
+//	The number of bins per axis the SAH split candidates are taken from.
+const int BVH_BIN_COUNT = 16;
+
+//	Nodes with at least this many primitives are binned on all job threads. Below it, whole subtrees are
+//	built on one thread each.
+const int BVH_PARALLEL_THRESHOLD = 8192;
+
+//	The traversal stack holds at most three entries per level, so this is plenty for any tree built here.
+const int BVH_STACK_SIZE = 256;
+
+//	The number of rays handed to a job thread at once by IntersectRays.
+const int BVH_RAY_BATCH_SIZE = 256;
+
+//	The BVHClass is a bounding volume hierarchy for ray queries. It is built either over the triangles of a
+//	mesh, which it keeps a copy of, or over the boxes of objects, whose tests are left to an intersect
+//	function the owner sets. The build splits nodes with the binned surface area heuristic, first binning
+//	the large nodes at the top on all job threads and then building the subtrees below them side by side,
+//	and finally collapses the binary tree into nodes of four children. The nodes store their child boxes as
+//	a structure of arrays, so the traversal tests all four children with one set of SIMD instructions.
+//	Object boxes can be moved with UpdateBounds, after which Refit grows or shrinks only the nodes above
+//	the boxes that changed. The tree is not rebuilt, so it gets slower to traverse if objects move far.
+class BVHClass
+{
+public:
+	struct BoundsType
+	{
+		XMFLOAT3 minimum;
+		XMFLOAT3 maximum;
+	};
+
+	struct RayType
+	{
+		XMFLOAT3 origin;
+		XMFLOAT3 direction;
+		float maxDistance;
+	};
+
+//	The primitive is the index of the triangle or object that was hit, or -1 for a miss. Distances are
+//	measured in lengths of the ray direction. For triangles u and v are the barycentric coordinates of
+//	the hit on the second and third vertex.
+	struct HitType
+	{
+		int primitive;
+		float distance;
+		float u, v;
+	};
+
+//	An intersect function gets the object index, the ray origin and direction and the distance to beat.
+//	It returns whether the object was hit closer than that, and at what distance.
+	typedef function<bool(int, FXMVECTOR, FXMVECTOR, float, float&)> IntersectFunctionType;
+
+private:
+	struct NodeType
+	{
+		XMFLOAT4A minimumX, minimumY, minimumZ;
+		XMFLOAT4A maximumX, maximumY, maximumZ;
+
+//	For an inner child the node index. For a leaf the first primitive in the leaf order and the count,
+//	which is zero for inner children. Unused children are -1.
+		int children[BVH_WIDTH];
+		int counts[BVH_WIDTH];
+		int parent;
+		bool dirty;
+	};
+
+	struct TriangleType
+	{
+		XMFLOAT3 vertex, edge1, edge2;
+	};
+
+	struct BuildNodeType
+	{
+		BoundsType bounds;
+		int left, right;
+		int first, count;
+	};
+
+	struct BinType
+	{
+		BoundsType bounds;
+		int count;
+	};
+
+	struct BuildTaskType
+	{
+		int node;
+		int first, count;
+	};
+
+public:
+	BVHClass();
+	BVHClass(const BVHClass&);
+	~BVHClass();
+
+	bool BuildTriangles(JobSystemClass*, const XMFLOAT3*, const unsigned long*, int);
+	bool BuildBounds(JobSystemClass*, const BoundsType*, int);
+	void Shutdown();
+
+	void SetIntersectFunction(const IntersectFunctionType&);
+
+	void UpdateBounds(int, const BoundsType&);
+	void Refit();
+
+	bool Intersect(FXMVECTOR, FXMVECTOR, float, HitType&);
+	bool IntersectAny(FXMVECTOR, FXMVECTOR, float);
+	bool IntersectSegment(FXMVECTOR, FXMVECTOR, HitType&);
+	void IntersectRays(JobSystemClass*, const RayType*, int, HitType*);
+
+	static bool IntersectBounds(const BoundsType&, FXMVECTOR, FXMVECTOR, float, float&);
+
+	int GetPrimitiveCount();
+	int GetNodeCount();
+
+//	The time in milliseconds the last build took, and the rays per second of the last IntersectRays.
+	float GetBuildTime();
+	float GetRaysPerSecond();
+
+private:
+	void ShutdownTree();
+	bool Build(JobSystemClass*);
+	bool SplitNode(JobSystemClass*, int, int, BoundsType&, int&);
+	void ComputeBounds(JobSystemClass*, int, int, BoundsType&, BoundsType&);
+	void BinPrimitives(JobSystemClass*, int, int, const BoundsType&, BinType[3][BVH_BIN_COUNT]);
+	int BuildSubtree(vector<BuildNodeType>&, int, int);
+	int CollapseNode(const vector<BuildNodeType>&, int, int);
+
+	bool Traverse(FXMVECTOR, FXMVECTOR, float, bool, HitType&);
+	bool IntersectLeaf(int, int, FXMVECTOR, FXMVECTOR, bool, HitType&);
+
+	static void ResetBounds(BoundsType&);
+	static void GrowBounds(BoundsType&, const BoundsType&);
+	static float GetSurfaceArea(const BoundsType&);
+
+	vector<NodeType> m_nodes;
+	vector<int> m_primitiveOrder;
+	vector<int> m_leafNodes;
+	vector<BoundsType> m_primitiveBounds;
+	vector<XMFLOAT3> m_centroids;
+	vector<TriangleType> m_triangles;
+	vector<int> m_dirtyNodes;
+	IntersectFunctionType m_intersectFunction;
+	bool m_triangleMode;
+
+	float m_buildTime;
+	float m_raysPerSecond;
+};
+
+#endif
@@ -19,6 +19,7 @@ public:
 
 	void Render();
 	void GetViewMatrix(XMMATRIX&);
+	void GetPickingRay(int, int, int, int, XMMATRIX, XMVECTOR&, XMVECTOR&);
 
 private:
 	float m_positionX, m_positionY, m_positionZ;
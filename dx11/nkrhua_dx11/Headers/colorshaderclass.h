@@ -6,6 +6,9 @@
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
 #include <fstream>
+#include "shadermanagerclass.h"
+#include "resourceregistryclass.h"
+#include "batchmathclass.h"
 //	Namespaces:
 using namespace DirectX;
 using namespace std;
@@ -31,22 +34,30 @@ public:
 //	The function here handle initializing shutdown of the shader. The render function sets
 //	the shader parameters and then draws the prepared model vertices using the shader.
 	
-	bool Initialize(ID3D11Device*, HWND);
+	bool Initialize(ID3D11Device*, ResourceRegistryClass*, ShaderManagerClass*);
+	static void Precompile(ShaderManagerClass*);
 	void Shutdown();
 	bool Render(ID3D11DeviceContext*, int, XMMATRIX, XMMATRIX, XMMATRIX);
+	bool Render(ID3D11DeviceContext*, int, int, int, XMMATRIX, XMMATRIX, XMMATRIX);
+	bool RenderInstanced(ID3D11DeviceContext*, int, int, XMMATRIX, XMMATRIX);
+
+//	The permutation is a combination of the SHADER_ flags from the ShaderManagerClass and selects which
+//	compiled variant of color.vs and color.ps the next Render call uses.
+	void SetPermutation(unsigned int);
 
 private:
-	bool InitializeShader(ID3D11Device*, HWND, WCHAR*, WCHAR*);
+	bool InitializeShader(ID3D11Device*, WCHAR*, WCHAR*);
 	void ShutdownShader();
-	void OutputShaderErrorMessage(ID3D10Blob*, HWND, WCHAR*);
 
 	bool SetShaderParameters(ID3D11DeviceContext*, XMMATRIX, XMMATRIX, XMMATRIX);
-	void RenderShader(ID3D11DeviceContext*, int);
-
-	ID3D11VertexShader* m_vertexShader;
-	ID3D11PixelShader* m_pixelShader;
-	ID3D11InputLayout* m_layout;
-	ID3D11Buffer* m_matrixBuffer;
+	void RenderShader(ID3D11DeviceContext*, int, int, int);
+	void RenderShaderInstanced(ID3D11DeviceContext*, int, int);
+
+	ShaderManagerClass* m_ShaderManager;
+	int m_shaderFamily;
+	unsigned int m_permutation;
+	ResourceRegistryClass* m_ResourceRegistry;
+	BufferHandle m_matrixBuffer;
 };
 
 #endif
\ No newline at end of file
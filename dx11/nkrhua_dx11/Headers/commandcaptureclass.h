@@ -0,0 +1,120 @@
+#ifndef _COMMANDCAPTURECLASS_H_
+#define _COMMANDCAPTURECLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <stdio.h>
+#include <vector>
+#include <unordered_map>
+#include "devicecontextproxyclass.h"
+#include "commandreplayclass.h"
+//	Namespaces:
+using namespace std;
+
+//	The private data the Shader Manager attaches to the shaders and input layouts it creates. Direct3D can't
+//	give back the bytecode of a shader or the elements of a layout, so this is all the capture has of them.
+const GUID COMMAND_CAPTURE_GUID = { 0x5c8e2f14, 0x9b3d, 0x4a61, { 0x8e, 0x27, 0xd1, 0x4f, 0x6a, 0x90, 0x3b, 0xc5 } };
+
+//	A buffer written through Map is compared with what it held before in blocks of this many bytes, and each
+//	run of blocks that changed is recorded as one update.
+const unsigned int COMMAND_CAPTURE_BLOCK = 64;
+
+//	The slots of each stage the state at the start of a capture is read back from.
+const unsigned int COMMAND_CAPTURE_SLOTS = 16;
+
+//	The CommandCaptureClass is a device context that records what is sent to it into a command file for the
+//	CommandReplayClass, and passes every call on to the device context it was given. D3DClass hands it out
+//	in place of its own while capturing, so nothing that draws has to know about it.
+//
+//	The calls the engine makes are recorded: the input assembler, the vertex and pixel shader stages, the
+//	output merger and the rasterizer state, clears, draws, copies and buffer updates. Every other call is
+//	passed on by the proxy without being recorded, so a call the engine starts making has to be added here
+//	to be captured. A recorded call the file can't hold, such as a map of a texture or a shader without the
+//	tag of the Shader Manager, is passed on and counted in the header, so a replay can say what it is
+//	missing. An object is defined in the file the first time a recorded call names it, with its description
+//	and, for buffers and textures, what it holds at that moment, read back through a staging copy. Render
+//	targets and depth buffers are defined without contents, since a frame draws them.
+//
+//	Map on a buffer hands out a copy of what the buffer held instead of the buffer's own memory, and Unmap
+//	records the blocks of the copy that changed before writing them to the buffer, so a buffer rewritten
+//	every frame costs only what actually changed. Defined objects are held until Shutdown, so none of them
+//	can be released and another created at the same address in the middle of a capture.
+class CommandCaptureClass : public DeviceContextProxyClass
+{
+private:
+	struct MappedType
+	{
+		ID3D11Resource* resource;
+		unsigned int object;
+		D3D11_MAP mapType;
+		void* data;
+		vector<unsigned char> contents;
+	};
+
+public:
+	CommandCaptureClass();
+	CommandCaptureClass(const CommandCaptureClass&);
+	~CommandCaptureClass();
+
+//	Initialize opens the file and records the state the device context is in, so the first frame of the
+//	replay starts from it.
+	bool Initialize(ID3D11DeviceContext*, const char*);
+	void Shutdown();
+	void EndFrame();
+
+	int GetFrameCount();
+
+	static void TagShader(ID3D11DeviceChild*, const void*, SIZE_T);
+	static void TagInputLayout(ID3D11InputLayout*, const D3D11_INPUT_ELEMENT_DESC*, UINT, const void*, SIZE_T);
+
+//	The calls that are recorded, which are those the engine makes:
+	void STDMETHODCALLTYPE IASetInputLayout(ID3D11InputLayout*);
+	void STDMETHODCALLTYPE IASetVertexBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*);
+	void STDMETHODCALLTYPE IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT);
+	void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY);
+	void STDMETHODCALLTYPE VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT);
+	void STDMETHODCALLTYPE VSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*);
+	void STDMETHODCALLTYPE VSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*);
+	void STDMETHODCALLTYPE VSSetSamplers(UINT, UINT, ID3D11SamplerState* const*);
+	void STDMETHODCALLTYPE PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT);
+	void STDMETHODCALLTYPE PSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*);
+	void STDMETHODCALLTYPE PSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*);
+	void STDMETHODCALLTYPE PSSetSamplers(UINT, UINT, ID3D11SamplerState* const*);
+	void STDMETHODCALLTYPE OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*);
+	void STDMETHODCALLTYPE OMSetBlendState(ID3D11BlendState*, const FLOAT[4], UINT);
+	void STDMETHODCALLTYPE OMSetDepthStencilState(ID3D11DepthStencilState*, UINT);
+	void STDMETHODCALLTYPE RSSetState(ID3D11RasterizerState*);
+	void STDMETHODCALLTYPE RSSetViewports(UINT, const D3D11_VIEWPORT*);
+	void STDMETHODCALLTYPE ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT[4]);
+	void STDMETHODCALLTYPE ClearDepthStencilView(ID3D11DepthStencilView*, UINT, FLOAT, UINT8);
+	HRESULT STDMETHODCALLTYPE Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*);
+	void STDMETHODCALLTYPE Unmap(ID3D11Resource*, UINT);
+	void STDMETHODCALLTYPE UpdateSubresource(ID3D11Resource*, UINT, const D3D11_BOX*, const void*, UINT, UINT);
+	void STDMETHODCALLTYPE CopyResource(ID3D11Resource*, ID3D11Resource*);
+	void STDMETHODCALLTYPE CopySubresourceRegion(ID3D11Resource*, UINT, UINT, UINT, UINT, ID3D11Resource*, UINT, const D3D11_BOX*);
+	void STDMETHODCALLTYPE Draw(UINT, UINT);
+	void STDMETHODCALLTYPE DrawIndexed(UINT, UINT, INT);
+	void STDMETHODCALLTYPE DrawInstanced(UINT, UINT, UINT, UINT);
+	void STDMETHODCALLTYPE DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT);
+
+private:
+	void CaptureState();
+	unsigned int Define(ID3D11DeviceChild*, unsigned int);
+	unsigned int DefineResource(ID3D11Resource*);
+	bool ReadBuffer(ID3D11Buffer*, vector<unsigned char>&);
+	bool ReadTexture(ID3D11Texture2D*, vector<unsigned char>&);
+	void RefreshShadow(ID3D11Resource*, unsigned int);
+	void RecordBindings(unsigned int, unsigned int, UINT, UINT, ID3D11DeviceChild* const*, unsigned int);
+	void WriteRecord(unsigned int, const void*, unsigned int);
+
+	ID3D11Device* m_device;
+	FILE* m_file;
+	CommandFileHeaderType m_header;
+	unordered_map<ID3D11DeviceChild*, unsigned int> m_objects;
+	vector<ID3D11DeviceChild*> m_definedObjects;
+	unordered_map<unsigned int, vector<unsigned char>> m_shadows;
+	vector<MappedType> m_mapped;
+	vector<unsigned char> m_record;
+};
+
+#endif
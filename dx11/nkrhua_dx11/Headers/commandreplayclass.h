@@ -0,0 +1,263 @@
+#ifndef _COMMANDREPLAYCLASS_H_
+#define _COMMANDREPLAYCLASS_H_
+
+//	Includes:
+#include <stdio.h>
+#include <vector>
+//	Namespaces:
+using namespace std;
+
+//	The command file the CommandCaptureClass writes and the CommandReplayClass plays. Nothing in here uses
+//	Direct3D, so the replay builds anywhere, and everything in the file is a 32 bit value. The file is a
+//	CommandFileHeaderType followed by records, each a CommandRecordType and its payload rounded up to four
+//	bytes. Objects are numbered from one in the order the capture first saw them, zero is no object, and
+//	every object is defined by a COMMAND_DEFINE record before the first command that uses it.
+const unsigned int COMMAND_FILE_VERSION = 1;
+
+//	The topologies the replay counts primitives for, with the values Direct3D gives them.
+const unsigned int COMMAND_TOPOLOGY_POINTLIST = 1;
+const unsigned int COMMAND_TOPOLOGY_LINELIST = 2;
+const unsigned int COMMAND_TOPOLOGY_LINESTRIP = 3;
+const unsigned int COMMAND_TOPOLOGY_TRIANGLELIST = 4;
+const unsigned int COMMAND_TOPOLOGY_TRIANGLESTRIP = 5;
+
+//	The payload of every command is a list of 32 bit values, objects given by their number:
+//	SET_INPUT_LAYOUT		layout
+//	SET_VERTEX_BUFFERS		start slot, count, then a buffer, stride and offset for each
+//	SET_INDEX_BUFFER		buffer, format, offset
+//	SET_TOPOLOGY			topology
+//	SET_SHADER				stage, shader
+//	SET_CONSTANT_BUFFERS, SET_SHADER_RESOURCES and SET_SAMPLERS
+//							stage, start slot, count, then the objects
+//	SET_RENDER_TARGETS		count, depth stencil view, then the render target views
+//	SET_BLEND_STATE			state, the four floats of the blend factor, sample mask
+//	SET_DEPTH_STENCIL_STATE	state, stencil reference
+//	SET_RASTERIZER_STATE	state
+//	SET_VIEWPORTS			count, then the six floats of each viewport
+//	CLEAR_RENDER_TARGET		view, the four floats of the color
+//	CLEAR_DEPTH_STENCIL		view, flags, depth as a float, stencil
+//	UPDATE_BUFFER			buffer, offset, size, then size bytes of contents
+//	COPY_RESOURCE			destination, source
+//	COPY_SUBRESOURCE_REGION	destination, subresource, x, y, z, source, subresource, whether there is a box,
+//							then its left, top, front, right, bottom and back
+//	DRAW					vertex count, start vertex
+//	DRAW_INDEXED			index count, start index, base vertex
+//	DRAW_INSTANCED			vertex count, instance count, start vertex, start instance
+//	DRAW_INDEXED_INSTANCED	index count, instance count, start index, base vertex, start instance
+//	FRAME_END has no payload.
+enum CommandType
+{
+	COMMAND_DEFINE,
+	COMMAND_FRAME_END,
+	COMMAND_SET_INPUT_LAYOUT,
+	COMMAND_SET_VERTEX_BUFFERS,
+	COMMAND_SET_INDEX_BUFFER,
+	COMMAND_SET_TOPOLOGY,
+	COMMAND_SET_SHADER,
+	COMMAND_SET_CONSTANT_BUFFERS,
+	COMMAND_SET_SHADER_RESOURCES,
+	COMMAND_SET_SAMPLERS,
+	COMMAND_SET_RENDER_TARGETS,
+	COMMAND_SET_BLEND_STATE,
+	COMMAND_SET_DEPTH_STENCIL_STATE,
+	COMMAND_SET_RASTERIZER_STATE,
+	COMMAND_SET_VIEWPORTS,
+	COMMAND_CLEAR_RENDER_TARGET,
+	COMMAND_CLEAR_DEPTH_STENCIL,
+	COMMAND_UPDATE_BUFFER,
+	COMMAND_COPY_RESOURCE,
+	COMMAND_COPY_SUBRESOURCE_REGION,
+	COMMAND_DRAW,
+	COMMAND_DRAW_INDEXED,
+	COMMAND_DRAW_INSTANCED,
+	COMMAND_DRAW_INDEXED_INSTANCED,
+	COMMAND_TYPE_COUNT
+};
+
+//	The kinds of objects a COMMAND_DEFINE record makes.
+enum CommandObjectKind
+{
+	COMMAND_OBJECT_BUFFER,
+	COMMAND_OBJECT_TEXTURE2D,
+	COMMAND_OBJECT_SHADER_RESOURCE_VIEW,
+	COMMAND_OBJECT_RENDER_TARGET_VIEW,
+	COMMAND_OBJECT_DEPTH_STENCIL_VIEW,
+	COMMAND_OBJECT_RASTERIZER_STATE,
+	COMMAND_OBJECT_BLEND_STATE,
+	COMMAND_OBJECT_DEPTH_STENCIL_STATE,
+	COMMAND_OBJECT_SAMPLER_STATE,
+	COMMAND_OBJECT_VERTEX_SHADER,
+	COMMAND_OBJECT_PIXEL_SHADER,
+	COMMAND_OBJECT_INPUT_LAYOUT,
+	COMMAND_OBJECT_KIND_COUNT
+};
+
+//	The shader stages the binding commands name.
+enum CommandStage
+{
+	COMMAND_STAGE_VERTEX,
+	COMMAND_STAGE_PIXEL
+};
+
+struct CommandFileHeaderType
+{
+	char magic[4];
+	unsigned int version;
+	unsigned int frameCount;
+	unsigned int recordCount;
+	unsigned int objectCount;
+	unsigned int skippedCount;
+};
+
+struct CommandRecordType
+{
+	unsigned int type;
+	unsigned int size;
+};
+
+//	A COMMAND_DEFINE payload starts with this, followed by descSize bytes of the description and dataSize
+//	bytes of contents. The description of a buffer is a CommandBufferDescType and of a texture a
+//	CommandTextureDescType, the same as the Direct3D ones; views and states have the Direct3D description as
+//	it is; shaders have none, and their bytecode as contents; and an input layout has its element count
+//	followed by a CommandInputElementType for each, with the bytecode of a vertex shader it fits as contents.
+//	Parent is the resource of a view. The contents of a texture are its subresources in order, each a row
+//	pitch and a row count followed by that many rows, and a render target or depth buffer has none.
+struct CommandDefineType
+{
+	unsigned int object;
+	unsigned int kind;
+	unsigned int parent;
+	unsigned int descSize;
+	unsigned int dataSize;
+};
+
+struct CommandBufferDescType
+{
+	unsigned int byteWidth;
+	unsigned int usage;
+	unsigned int bindFlags;
+	unsigned int cpuAccessFlags;
+	unsigned int miscFlags;
+	unsigned int structureByteStride;
+};
+
+struct CommandTextureDescType
+{
+	unsigned int width;
+	unsigned int height;
+	unsigned int mipLevels;
+	unsigned int arraySize;
+	unsigned int format;
+	unsigned int sampleCount;
+	unsigned int sampleQuality;
+	unsigned int usage;
+	unsigned int bindFlags;
+	unsigned int cpuAccessFlags;
+	unsigned int miscFlags;
+};
+
+struct CommandInputElementType
+{
+	char semanticName[32];
+	unsigned int semanticIndex;
+	unsigned int format;
+	unsigned int inputSlot;
+	unsigned int alignedByteOffset;
+	unsigned int inputSlotClass;
+	unsigned int instanceDataStepRate;
+};
+
+//	The ReplayBackendClass is what the CommandReplayClass plays a file into. Define is given every object,
+//	with its description and contents, and Execute every command with its payload. Reset puts the contents an
+//	object was defined with back, so every play starts from the same state. BeginDraw and EndDraw go around
+//	each draw with its number in the frame, for a backend that times them, and EndFrame is called at the end
+//	of every frame with the number of draws in it. GetDrawTime gives back how long a draw of the frame that
+//	was last ended took on the GPU in milliseconds, or less than zero when the backend can't tell.
+class ReplayBackendClass
+{
+public:
+	virtual ~ReplayBackendClass() {}
+
+	virtual bool Define(const CommandDefineType*, const unsigned char*, const unsigned char*) = 0;
+	virtual bool Execute(const CommandRecordType*, const unsigned char*) = 0;
+	virtual bool Reset(const CommandDefineType*, const unsigned char*) = 0;
+	virtual void BeginDraw(int) = 0;
+	virtual void EndDraw(int) = 0;
+	virtual bool EndFrame(int) = 0;
+	virtual float GetDrawTime(int) = 0;
+};
+
+//	The CommandReplayClass reads a command file into memory, checks every record in it and plays its frames
+//	over and over. Without a backend it is the null backend: it walks the commands without drawing anything,
+//	which still gives what every draw asks for, and it builds and runs without Direct3D, so captures from
+//	Windows can be looked at on Linux with the replay tool in replaymain.cpp.
+//
+//	For every draw it keeps its primitives and instances, the state changes and the bytes of buffer updates
+//	since the draw before it, and the least time the backend measured for it over all the plays. Objects are
+//	defined on the first play only, and before every play after it the resources the commands write to are
+//	reset, so each play draws the same thing and only the first one pays for creating everything.
+class CommandReplayClass
+{
+public:
+	struct DrawStatsType
+	{
+		int frame;
+		int command;
+		unsigned int type;
+		unsigned int elementCount;
+		unsigned int instanceCount;
+		unsigned int primitiveCount;
+		int stateChanges;
+		unsigned int updateBytes;
+		float time;
+	};
+
+private:
+	struct FrameType
+	{
+		int firstRecord, recordCount;
+		int firstDraw, drawCount;
+	};
+
+public:
+	CommandReplayClass();
+	CommandReplayClass(const CommandReplayClass&);
+	~CommandReplayClass();
+
+	bool Initialize(const char*);
+	void Shutdown();
+
+//	Play plays every frame the given number of times through the backend, or through nothing at all.
+	bool Play(ReplayBackendClass*, int);
+
+	int GetFrameCount();
+	int GetRecordCount();
+	int GetObjectCount();
+	int GetSkippedCount();
+	int GetDrawCount();
+	const DrawStatsType* GetDrawStats();
+
+//	The least and the mean time a play of all the frames took, in milliseconds. The first play is left out
+//	of both when there was more than one.
+	float GetBestPlayTime();
+	float GetMeanPlayTime();
+
+	bool WriteReport(FILE*);
+
+	static FILE* OpenFile(const char*, const char*);
+
+private:
+	bool CheckRecord(const CommandRecordType*, const unsigned char*, unsigned int&);
+	bool PlayFrame(ReplayBackendClass*, int, bool);
+
+	vector<unsigned char> m_data;
+	vector<const CommandRecordType*> m_records;
+	vector<FrameType> m_frames;
+	vector<int> m_resets;
+	vector<DrawStatsType> m_draws;
+	CommandFileHeaderType m_header;
+	float m_bestPlayTime, m_totalPlayTime;
+	int m_playCount;
+};
+
+#endif
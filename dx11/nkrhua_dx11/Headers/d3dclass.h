@@ -7,6 +7,9 @@
 
 #include <d3d11.h>
 #include <DirectXMath.h>
+#include "resourceregistryclass.h"
+#include "commandcaptureclass.h"
+#include "statscontextclass.h"
 using namespace DirectX;
 
 class D3DClass
@@ -16,7 +19,7 @@ public:
 	D3DClass(const D3DClass&);
 	~D3DClass();
 
-	bool Initialize(int, int, bool, HWND, bool, float, float);
+	bool Initialize(int, int, bool, HWND, bool, float, float, bool);
 	void Shutdown();
 
 	void BeginScene(float, float, float, float);
@@ -24,6 +27,7 @@ public:
 
 	ID3D11Device* GetDevice();
 	ID3D11DeviceContext* GetDeviceContext();
+	ResourceRegistryClass* GetResourceRegistry();
 
 	void GetProjectionMatrix(XMMATRIX&);
 	void GetWorldMatrix(XMMATRIX&);
@@ -33,6 +37,24 @@ public:
 
 	void SetBackBufferRenderTarget();
 	void ResetViewport();
+	void ResetRasterState();
+
+	void TurnOnAlphaBlending();
+	void TurnOffAlphaBlending();
+	void TurnOnDepthWrites();
+	void TurnOffDepthWrites();
+	void TurnOffDepthTest();
+
+//	While a capture runs the device context is the Command Capture, which records what is drawn to the file
+//	and passes everything on to the real one.
+	bool BeginCommandCapture(const char*);
+	void EndCommandFrame();
+	void EndCommandCapture();
+
+//	With render statistics on the device context is the Stats Context, which counts into the given stats and
+//	passes everything on. It is begun before any capture, so a capture records in front of it.
+	bool BeginRenderStats(RenderStatsClass*);
+	void EndRenderStats();
 
 private:
 	bool m_vsync_enabled;
@@ -44,9 +66,20 @@ private:
 	ID3D11DeviceContext* m_deviceContext;
 	ID3D11RenderTargetView* m_renderTargetView;
 	ID3D11Texture2D* m_depthStencilBuffer;
-	ID3D11DepthStencilState* m_depthStencilState;
 	ID3D11DepthStencilView* m_depthStencilView;
-	ID3D11RasterizerState* m_rasterState;
+
+//	The states are owned by the Resource Registry, which everything else created on the device goes
+//	through as well. EndScene ends its frame after presenting.
+	ResourceRegistryClass* m_ResourceRegistry;
+	DepthStencilStateHandle m_depthStencilState;
+	RasterizerStateHandle m_rasterState;
+	DepthStencilStateHandle m_depthReadOnlyState;
+	DepthStencilStateHandle m_depthDisabledState;
+	BlendStateHandle m_alphaEnableBlendingState;
+	BlendStateHandle m_alphaDisableBlendingState;
+
+	CommandCaptureClass* m_CommandCapture;
+	StatsContextClass* m_StatsContext;
 
 	XMMATRIX m_projectionMatrix;
 	XMMATRIX m_worldMatrix;
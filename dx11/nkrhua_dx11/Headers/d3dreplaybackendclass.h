@@ -0,0 +1,55 @@
+#ifndef _D3DREPLAYBACKENDCLASS_H_
+#define _D3DREPLAYBACKENDCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <vector>
+#include "commandreplayclass.h"
+//	Namespaces:
+using namespace std;
+
+//	The D3DReplayBackendClass plays a command file on a device of its own, with nothing to present to, and
+//	times every draw with a pair of timestamp queries. Buffers and textures the capture saw as dynamic are made
+//	default ones, since the replay writes them with UpdateSubresource and never maps them.
+class D3DReplayBackendClass : public ReplayBackendClass
+{
+private:
+	struct QueryType
+	{
+		ID3D11Query* begin;
+		ID3D11Query* end;
+	};
+
+public:
+	D3DReplayBackendClass();
+	D3DReplayBackendClass(const D3DReplayBackendClass&);
+	~D3DReplayBackendClass();
+
+	bool Initialize(bool);
+	void Shutdown();
+
+	bool Define(const CommandDefineType*, const unsigned char*, const unsigned char*);
+	bool Execute(const CommandRecordType*, const unsigned char*);
+	bool Reset(const CommandDefineType*, const unsigned char*);
+	void BeginDraw(int);
+	void EndDraw(int);
+	bool EndFrame(int);
+	float GetDrawTime(int);
+
+private:
+	ID3D11DeviceChild* Find(unsigned int, unsigned int);
+	ID3D11Resource* FindBufferOrTexture(unsigned int);
+	bool UploadTexture(ID3D11Texture2D*, const CommandTextureDescType*, const unsigned char*, unsigned int);
+
+	ID3D11Device* m_device;
+	ID3D11DeviceContext* m_deviceContext;
+	vector<ID3D11DeviceChild*> m_objects;
+	vector<unsigned int> m_kinds;
+	vector<vector<unsigned char>> m_constantBuffers;
+	vector<QueryType> m_queries;
+	vector<float> m_drawTimes;
+	ID3D11Query* m_disjointQuery;
+	bool m_frameBegun;
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef _DEBUGDRAWCLASS_H_
+#define _DEBUGDRAWCLASS_H_
+
+//	Debug drawing only exists in debug builds. In release builds the Debug Draw class isn't declared, its
+//	source compiles to nothing, and everything that uses it has to be inside #if DEBUG_DRAW_ENABLED as well.
+#if defined(_DEBUG)
+#define DEBUG_DRAW_ENABLED 1
+#else
+#define DEBUG_DRAW_ENABLED 0
+#endif
+
+#if DEBUG_DRAW_ENABLED
+
+//	Includes:
+#include <d3d11.h>
+#include <directxmath.h>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "resourceregistryclass.h"
+#include "shadermanagerclass.h"
+#include "vertexformatclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	The lines each of the three circles of a sphere is drawn with.
+const int DEBUG_DRAW_SPHERE_SEGMENTS = 24;
+
+//	The DebugDrawClass draws lines, boxes, spheres, frusta and arrows in world space, for looking at bounding
+//	volumes, lights and the like without a vertex buffer for every shape. The Add functions may be called from
+//	any number of threads at once: every thread keeps the primitives it adds in a buffer of its own, found
+//	through a thread local cache, and a thread's first buffer is pushed onto a lock free list, so adding never
+//	takes a lock. Every primitive is either drawn with the depth test or on top of everything. Flush turns the
+//	primitives of all threads into line list vertices in one dynamic vertex buffer, the depth tested ones
+//	first, and Render draws either part with one draw call. Flush must not run while a thread is still adding.
+class DebugDrawClass
+{
+private:
+	enum PrimitiveKind
+	{
+		DEBUG_PRIMITIVE_LINE,
+		DEBUG_PRIMITIVE_BOX,
+		DEBUG_PRIMITIVE_SPHERE,
+		DEBUG_PRIMITIVE_FRUSTUM,
+		DEBUG_PRIMITIVE_ARROW
+	};
+
+//	A line or an arrow keeps its ends in the first two rows of the transform and a sphere its center and
+//	radius in the first. A box keeps the matrix that takes the cube from -1 to 1 onto it, and a frustum the
+//	inverse of its view projection matrix, which takes the cube of clip space from a depth of 0 to 1 onto it.
+	struct PrimitiveType
+	{
+		int kind;
+		XMFLOAT4X4 transform;
+		PackedVector::XMUBYTEN4 color;
+	};
+
+	struct ThreadBufferType
+	{
+		thread::id owner;
+		vector<PrimitiveType> primitives[2];
+		ThreadBufferType* next;
+	};
+
+	struct DebugBufferType
+	{
+		XMMATRIX viewProjection;
+	};
+
+public:
+	DebugDrawClass();
+	DebugDrawClass(const DebugDrawClass&);
+	~DebugDrawClass();
+
+	static void Precompile(ShaderManagerClass*);
+
+//	Initialize takes the most line vertices a frame draws.
+	bool Initialize(ID3D11Device*, ResourceRegistryClass*, ShaderManagerClass*, int);
+	void Shutdown();
+
+//	Every Add function takes the color and whether the primitive is hidden by what is in front of it.
+	void AddLine(XMFLOAT3, XMFLOAT3, XMFLOAT4, bool);
+	void AddBox(XMFLOAT3, XMFLOAT3, XMFLOAT4, bool);
+	void AddOrientedBox(XMFLOAT3, XMFLOAT3, XMMATRIX, XMFLOAT4, bool);
+	void AddSphere(XMFLOAT3, float, XMFLOAT4, bool);
+	void AddFrustum(XMMATRIX, XMFLOAT4, bool);
+	void AddArrow(XMFLOAT3, XMFLOAT3, XMFLOAT4, bool);
+	void Clear();
+
+	bool Flush(ID3D11DeviceContext*, XMMATRIX, XMMATRIX);
+	bool Render(ID3D11DeviceContext*, bool);
+
+	int GetVertexCount();
+	int GetDroppedCount();
+
+private:
+	bool InitializeShader(WCHAR*, WCHAR*);
+	bool InitializeBuffers(ID3D11Device*);
+	void Add(int, const XMFLOAT4X4&, XMFLOAT4, bool);
+	ThreadBufferType* GetThreadBuffer();
+	int WritePrimitive(const PrimitiveType&, DebugVertexType*);
+
+	unsigned int m_id;
+	int m_maxVertices;
+	XMFLOAT2 m_circle[DEBUG_DRAW_SPHERE_SEGMENTS];
+
+	atomic<ThreadBufferType*> m_threadBuffers;
+
+	int m_vertexCounts[2];
+	int m_droppedCount;
+
+	ResourceRegistryClass* m_ResourceRegistry;
+	BufferHandle m_vertexBuffer, m_debugBuffer;
+	ShaderManagerClass* m_ShaderManager;
+	int m_shaderFamily;
+};
+
+#endif
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef _DEVICECONTEXTPROXYCLASS_H_
+#define _DEVICECONTEXTPROXYCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+
+//	The DeviceContextProxyClass is a device context that passes every call on to the device context it stands
+//	in front of. The classes that watch what is drawn derive from it and override only the calls they look
+//	at. D3DClass hands one out in place of its own device context, so nothing that draws has to know about
+//	them, and one proxy can stand in front of another.
+//
+//	A proxy is a COM object of its own. It starts with one reference, which belongs to whoever created it, holds
+//	a reference to the device context behind it, and deletes itself when its last reference is released. It is
+//	only ever let go of through Release, and the destructor is virtual so that reaches the derived classes.
+class DeviceContextProxyClass : public ID3D11DeviceContext
+{
+public:
+	DeviceContextProxyClass();
+	DeviceContextProxyClass(const DeviceContextProxyClass&);
+	virtual ~DeviceContextProxyClass();
+
+//	The device context the calls are passed on to.
+	ID3D11DeviceContext* GetDeviceContext();
+
+//	IUnknown and ID3D11DeviceChild:
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID, void**);
+	ULONG STDMETHODCALLTYPE AddRef();
+	ULONG STDMETHODCALLTYPE Release();
+	void STDMETHODCALLTYPE GetDevice(ID3D11Device**);
+	HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT*, void*);
+	HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*);
+	HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*);
+
+//	ID3D11DeviceContext:
+	void STDMETHODCALLTYPE IASetInputLayout(ID3D11InputLayout*);
+	void STDMETHODCALLTYPE IASetVertexBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*);
+	void STDMETHODCALLTYPE IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT);
+	void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY);
+	void STDMETHODCALLTYPE VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT);
+	void STDMETHODCALLTYPE VSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*);
+	void STDMETHODCALLTYPE VSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*);
+	void STDMETHODCALLTYPE VSSetSamplers(UINT, UINT, ID3D11SamplerState* const*);
+	void STDMETHODCALLTYPE PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT);
+	void STDMETHODCALLTYPE PSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*);
+	void STDMETHODCALLTYPE PSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*);
+	void STDMETHODCALLTYPE PSSetSamplers(UINT, UINT, ID3D11SamplerState* const*);
+	void STDMETHODCALLTYPE OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*);
+	void STDMETHODCALLTYPE OMSetBlendState(ID3D11BlendState*, const FLOAT[4], UINT);
+	void STDMETHODCALLTYPE OMSetDepthStencilState(ID3D11DepthStencilState*, UINT);
+	void STDMETHODCALLTYPE RSSetState(ID3D11RasterizerState*);
+	void STDMETHODCALLTYPE RSSetViewports(UINT, const D3D11_VIEWPORT*);
+	void STDMETHODCALLTYPE ClearRenderTargetView(ID3D11RenderTargetView*, const FLOAT[4]);
+	void STDMETHODCALLTYPE ClearDepthStencilView(ID3D11DepthStencilView*, UINT, FLOAT, UINT8);
+	HRESULT STDMETHODCALLTYPE Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*);
+	void STDMETHODCALLTYPE Unmap(ID3D11Resource*, UINT);
+	void STDMETHODCALLTYPE UpdateSubresource(ID3D11Resource*, UINT, const D3D11_BOX*, const void*, UINT, UINT);
+	void STDMETHODCALLTYPE CopyResource(ID3D11Resource*, ID3D11Resource*);
+	void STDMETHODCALLTYPE CopySubresourceRegion(ID3D11Resource*, UINT, UINT, UINT, UINT, ID3D11Resource*, UINT, const D3D11_BOX*);
+	void STDMETHODCALLTYPE Draw(UINT, UINT);
+	void STDMETHODCALLTYPE DrawIndexed(UINT, UINT, INT);
+	void STDMETHODCALLTYPE DrawInstanced(UINT, UINT, UINT, UINT);
+	void STDMETHODCALLTYPE DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT);
+	void STDMETHODCALLTYPE GSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*);
+	void STDMETHODCALLTYPE GSSetShader(ID3D11GeometryShader*, ID3D11ClassInstance* const*, UINT);
+	void STDMETHODCALLTYPE GSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*);
+	void STDMETHODCALLTYPE GSSetSamplers(UINT, UINT, ID3D11SamplerState* const*);
+	void STDMETHODCALLTYPE HSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*);
+	void STDMETHODCALLTYPE HSSetShader(ID3D11HullShader*, ID3D11ClassInstance* const*, UINT);
+	void STDMETHODCALLTYPE HSSetSamplers(UINT, UINT, ID3D11SamplerState* const*);
+	void STDMETHODCALLTYPE HSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*);
+	void STDMETHODCALLTYPE DSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*);
+	void STDMETHODCALLTYPE DSSetShader(ID3D11DomainShader*, ID3D11ClassInstance* const*, UINT);
+	void STDMETHODCALLTYPE DSSetSamplers(UINT, UINT, ID3D11SamplerState* const*);
+	void STDMETHODCALLTYPE DSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*);
+	void STDMETHODCALLTYPE CSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*);
+	void STDMETHODCALLTYPE CSSetUnorderedAccessViews(UINT, UINT, ID3D11UnorderedAccessView* const*, const UINT*);
+	void STDMETHODCALLTYPE CSSetShader(ID3D11ComputeShader*, ID3D11ClassInstance* const*, UINT);
+	void STDMETHODCALLTYPE CSSetSamplers(UINT, UINT, ID3D11SamplerState* const*);
+	void STDMETHODCALLTYPE CSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*);
+	void STDMETHODCALLTYPE SetPredication(ID3D11Predicate*, BOOL);
+	void STDMETHODCALLTYPE OMSetRenderTargetsAndUnorderedAccessViews(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*, UINT, UINT,
+		ID3D11UnorderedAccessView* const*, const UINT*);
+	void STDMETHODCALLTYPE SOSetTargets(UINT, ID3D11Buffer* const*, const UINT*);
+	void STDMETHODCALLTYPE DrawAuto();
+	void STDMETHODCALLTYPE DrawIndexedInstancedIndirect(ID3D11Buffer*, UINT);
+	void STDMETHODCALLTYPE DrawInstancedIndirect(ID3D11Buffer*, UINT);
+	void STDMETHODCALLTYPE Dispatch(UINT, UINT, UINT);
+	void STDMETHODCALLTYPE DispatchIndirect(ID3D11Buffer*, UINT);
+	void STDMETHODCALLTYPE RSSetScissorRects(UINT, const D3D11_RECT*);
+	void STDMETHODCALLTYPE CopyStructureCount(ID3D11Buffer*, UINT, ID3D11UnorderedAccessView*);
+	void STDMETHODCALLTYPE ClearUnorderedAccessViewUint(ID3D11UnorderedAccessView*, const UINT[4]);
+	void STDMETHODCALLTYPE ClearUnorderedAccessViewFloat(ID3D11UnorderedAccessView*, const FLOAT[4]);
+	void STDMETHODCALLTYPE GenerateMips(ID3D11ShaderResourceView*);
+	void STDMETHODCALLTYPE SetResourceMinLOD(ID3D11Resource*, FLOAT);
+	void STDMETHODCALLTYPE ResolveSubresource(ID3D11Resource*, UINT, ID3D11Resource*, UINT, DXGI_FORMAT);
+	void STDMETHODCALLTYPE ExecuteCommandList(ID3D11CommandList*, BOOL);
+	void STDMETHODCALLTYPE ClearState();
+	void STDMETHODCALLTYPE Begin(ID3D11Asynchronous*);
+	void STDMETHODCALLTYPE End(ID3D11Asynchronous*);
+	HRESULT STDMETHODCALLTYPE GetData(ID3D11Asynchronous*, void*, UINT, UINT);
+	FLOAT STDMETHODCALLTYPE GetResourceMinLOD(ID3D11Resource*);
+	void STDMETHODCALLTYPE VSGetConstantBuffers(UINT, UINT, ID3D11Buffer**);
+	void STDMETHODCALLTYPE PSGetShaderResources(UINT, UINT, ID3D11ShaderResourceView**);
+	void STDMETHODCALLTYPE PSGetShader(ID3D11PixelShader**, ID3D11ClassInstance**, UINT*);
+	void STDMETHODCALLTYPE PSGetSamplers(UINT, UINT, ID3D11SamplerState**);
+	void STDMETHODCALLTYPE VSGetShader(ID3D11VertexShader**, ID3D11ClassInstance**, UINT*);
+	void STDMETHODCALLTYPE PSGetConstantBuffers(UINT, UINT, ID3D11Buffer**);
+	void STDMETHODCALLTYPE IAGetInputLayout(ID3D11InputLayout**);
+	void STDMETHODCALLTYPE IAGetVertexBuffers(UINT, UINT, ID3D11Buffer**, UINT*, UINT*);
+	void STDMETHODCALLTYPE IAGetIndexBuffer(ID3D11Buffer**, DXGI_FORMAT*, UINT*);
+	void STDMETHODCALLTYPE GSGetConstantBuffers(UINT, UINT, ID3D11Buffer**);
+	void STDMETHODCALLTYPE GSGetShader(ID3D11GeometryShader**, ID3D11ClassInstance**, UINT*);
+	void STDMETHODCALLTYPE IAGetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY*);
+	void STDMETHODCALLTYPE VSGetShaderResources(UINT, UINT, ID3D11ShaderResourceView**);
+	void STDMETHODCALLTYPE VSGetSamplers(UINT, UINT, ID3D11SamplerState**);
+	void STDMETHODCALLTYPE GetPredication(ID3D11Predicate**, BOOL*);
+	void STDMETHODCALLTYPE GSGetShaderResources(UINT, UINT, ID3D11ShaderResourceView**);
+	void STDMETHODCALLTYPE GSGetSamplers(UINT, UINT, ID3D11SamplerState**);
+	void STDMETHODCALLTYPE OMGetRenderTargets(UINT, ID3D11RenderTargetView**, ID3D11DepthStencilView**);
+	void STDMETHODCALLTYPE OMGetRenderTargetsAndUnorderedAccessViews(UINT, ID3D11RenderTargetView**, ID3D11DepthStencilView**, UINT, UINT,
+		ID3D11UnorderedAccessView**);
+	void STDMETHODCALLTYPE OMGetBlendState(ID3D11BlendState**, FLOAT[4], UINT*);
+	void STDMETHODCALLTYPE OMGetDepthStencilState(ID3D11DepthStencilState**, UINT*);
+	void STDMETHODCALLTYPE SOGetTargets(UINT, ID3D11Buffer**);
+	void STDMETHODCALLTYPE RSGetState(ID3D11RasterizerState**);
+	void STDMETHODCALLTYPE RSGetViewports(UINT*, D3D11_VIEWPORT*);
+	void STDMETHODCALLTYPE RSGetScissorRects(UINT*, D3D11_RECT*);
+	void STDMETHODCALLTYPE HSGetShaderResources(UINT, UINT, ID3D11ShaderResourceView**);
+	void STDMETHODCALLTYPE HSGetShader(ID3D11HullShader**, ID3D11ClassInstance**, UINT*);
+	void STDMETHODCALLTYPE HSGetSamplers(UINT, UINT, ID3D11SamplerState**);
+	void STDMETHODCALLTYPE HSGetConstantBuffers(UINT, UINT, ID3D11Buffer**);
+	void STDMETHODCALLTYPE DSGetShaderResources(UINT, UINT, ID3D11ShaderResourceView**);
+	void STDMETHODCALLTYPE DSGetShader(ID3D11DomainShader**, ID3D11ClassInstance**, UINT*);
+	void STDMETHODCALLTYPE DSGetSamplers(UINT, UINT, ID3D11SamplerState**);
+	void STDMETHODCALLTYPE DSGetConstantBuffers(UINT, UINT, ID3D11Buffer**);
+	void STDMETHODCALLTYPE CSGetShaderResources(UINT, UINT, ID3D11ShaderResourceView**);
+	void STDMETHODCALLTYPE CSGetUnorderedAccessViews(UINT, UINT, ID3D11UnorderedAccessView**);
+	void STDMETHODCALLTYPE CSGetShader(ID3D11ComputeShader**, ID3D11ClassInstance**, UINT*);
+	void STDMETHODCALLTYPE CSGetSamplers(UINT, UINT, ID3D11SamplerState**);
+	void STDMETHODCALLTYPE CSGetConstantBuffers(UINT, UINT, ID3D11Buffer**);
+	void STDMETHODCALLTYPE Flush();
+	D3D11_DEVICE_CONTEXT_TYPE STDMETHODCALLTYPE GetType();
+	UINT STDMETHODCALLTYPE GetContextFlags();
+	HRESULT STDMETHODCALLTYPE FinishCommandList(BOOL, ID3D11CommandList**);
+
+protected:
+	void SetDeviceContext(ID3D11DeviceContext*);
+
+	ID3D11DeviceContext* m_deviceContext;
+
+private:
+	long m_referenceCount;
+};
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef _DYNAMICRESOLUTIONCLASS_H_
+#define _DYNAMICRESOLUTIONCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <directxmath.h>
+#include "rendertextureclass.h"
+#include "resolutioncontrollerclass.h"
+#include "resourceregistryclass.h"
+#include "shadermanagerclass.h"
+//	Namespaces:
+using namespace DirectX;
+
+//	The number of frames the GPU timings are read back behind, so reading them never waits on the GPU.
+const int DYNAMIC_RESOLUTION_QUERY_FRAMES = 4;
+
+//	The DynamicResolutionClass draws the scene into a render target the size of the screen at the largest
+//	scale, through a viewport of the current scale in its top left corner, and stretches that over the back
+//	buffer. The whole frame is timed on the GPU between BeginFrame and EndFrame, and the Resolution
+//	Controller picks the scale of the next frames from those times. They are the GPU's rather than the
+//	frame's, which with vsync on would never show the room there is to raise the scale. The scene keeps
+//	the projection of the screen, since the viewport keeps its shape.
+class DynamicResolutionClass
+{
+private:
+	struct UpscaleBufferType
+	{
+		XMFLOAT2 texScale;
+		XMFLOAT2 texLimit;
+	};
+
+	struct TimerQueryType
+	{
+		ID3D11Query* disjoint;
+		ID3D11Query* begin;
+		ID3D11Query* end;
+		bool issued;
+	};
+
+public:
+	DynamicResolutionClass();
+	DynamicResolutionClass(const DynamicResolutionClass&);
+	~DynamicResolutionClass();
+
+	static void Precompile(ShaderManagerClass*);
+
+//	Initialize takes the size of the screen, the depth range of the projection, the target GPU time of a
+//	frame in milliseconds and the smallest and largest scale.
+	bool Initialize(ID3D11Device*, ResourceRegistryClass*, ShaderManagerClass*, int, int, float, float, float, float, float);
+	void Shutdown();
+
+	void BeginFrame(ID3D11DeviceContext*);
+	void BeginScene(ID3D11DeviceContext*, float, float, float, float);
+	bool Upscale(ID3D11DeviceContext*);
+	void EndFrame(ID3D11DeviceContext*);
+
+	float GetScale();
+	int GetWidth();
+	int GetHeight();
+	float GetGPUTime();
+	int GetChangeCount();
+
+private:
+	bool InitializeShader(WCHAR*, WCHAR*);
+	bool InitializeQueries(ID3D11Device*);
+	void ReadQueries(ID3D11DeviceContext*);
+
+	int m_screenWidth, m_screenHeight;
+	int m_width, m_height;
+	float m_maximumScale;
+	float m_gpuTime;
+
+	RenderTextureClass* m_RenderTexture;
+	ResolutionControllerClass* m_Controller;
+
+	ResourceRegistryClass* m_ResourceRegistry;
+	BufferHandle m_upscaleBuffer;
+	SamplerStateHandle m_sampleState;
+	ShaderManagerClass* m_ShaderManager;
+	int m_shaderFamily;
+
+	TimerQueryType m_queries[DYNAMIC_RESOLUTION_QUERY_FRAMES];
+	int m_queryWrite, m_queryRead;
+	bool m_timing;
+};
+
+#endif
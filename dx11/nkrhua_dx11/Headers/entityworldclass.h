@@ -0,0 +1,136 @@
+#ifndef _ENTITYWORLDCLASS_H_
+#define _ENTITYWORLDCLASS_H_
+
+//	Includes:
+#include <vector>
+#include <functional>
+#include "jobsystemclass.h"
+//	Namespaces:
+using namespace std;
+
+//	A component type is a bit of a 32 bit mask, so there can be at most 32 of them.
+const int ENTITY_MAX_COMPONENT_TYPES = 32;
+
+//	The size of a chunk of entities. 16 KB keeps the chunks a system is working on well inside the cache.
+const unsigned int ENTITY_CHUNK_SIZE = 16 * 1024;
+const unsigned int ENTITY_ALIGNMENT = 16;
+
+//	An entity id is its index in the low 24 bits and the generation of the index above them. The generation
+//	is never zero, so an id of zero is never an entity.
+const int ENTITY_INDEX_BITS = 24;
+const unsigned int ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+const unsigned int ENTITY_GENERATION_MASK = 0xFF;
+
+//	The EntityWorldClass keeps entities grouped by archetype, the set of component types they have. Every
+//	archetype keeps its entities in chunks of ENTITY_CHUNK_SIZE bytes that hold one array per component type
+//	instead of one struct per entity, so a system that only touches two components of a large entity only
+//	pulls those two arrays through the cache. The chunks of an archetype are kept packed, every one of them
+//	full but the last, by moving the last entity into the hole left by one that is destroyed. Components are
+//	plain data, they are copied with memcpy when an entity changes archetype and start out zeroed.
+//
+//	Systems say which components they read and which they write. RunSystems runs every system in the first
+//	phase after all the earlier systems it conflicts with, one writing a component the other reads or writes,
+//	and runs the chunks of all the systems of a phase on the job threads at once. Entities must not be
+//	created, destroyed or changed while the systems run.
+class EntityWorldClass
+{
+public:
+//	What a system or ForEachChunk is given for every chunk that matches: the number of entities in it, their
+//	ids, and the array of every component type the archetype has, null for the ones it hasn't.
+	struct ChunkViewType
+	{
+		int count;
+		const unsigned int* entities;
+		void* components[ENTITY_MAX_COMPONENT_TYPES];
+	};
+
+	typedef function<void(const ChunkViewType&)> SystemFunctionType;
+
+private:
+	struct ChunkType
+	{
+		unsigned char* data;
+		int count;
+	};
+
+//	The entity ids of a chunk are at the start of it, then the component arrays in the order of their types.
+	struct ArchetypeType
+	{
+		unsigned int mask;
+		int capacity;
+		unsigned int chunkSize;
+		unsigned int offsets[ENTITY_MAX_COMPONENT_TYPES];
+		vector<ChunkType> chunks;
+	};
+
+	struct EntityType
+	{
+		int archetype, chunk, row;
+		unsigned int generation;
+	};
+
+	struct SystemType
+	{
+		unsigned int readMask, writeMask;
+		int phase;
+		SystemFunctionType function;
+	};
+
+	struct WorkType
+	{
+		int system, archetype, chunk;
+	};
+
+public:
+	EntityWorldClass();
+	EntityWorldClass(const EntityWorldClass&);
+	~EntityWorldClass();
+
+	bool Initialize();
+	void Shutdown();
+
+//	RegisterComponent returns the type of a new component of the given size, or -1 if there are already
+//	ENTITY_MAX_COMPONENT_TYPES of them. Its bit in a mask is 1 << type.
+	int RegisterComponent(unsigned int);
+
+	unsigned int CreateEntity(unsigned int);
+	void DestroyEntity(unsigned int);
+	bool IsAlive(unsigned int);
+
+//	AddComponents and RemoveComponents move the entity to the archetype with or without the given types.
+	void AddComponents(unsigned int, unsigned int);
+	void RemoveComponents(unsigned int, unsigned int);
+
+//	GetComponent returns the component of an entity, or null if it hasn't got one of that type. The pointer
+//	is only good until the next entity is created, destroyed or changed.
+	void* GetComponent(unsigned int, int);
+
+	void ForEachChunk(unsigned int, const SystemFunctionType&);
+
+	int AddSystem(unsigned int, unsigned int, const SystemFunctionType&);
+	void RunSystems(JobSystemClass*);
+
+	int GetEntityCount();
+	int GetArchetypeCount();
+	int GetChunkCount();
+	int GetPhaseCount();
+
+private:
+	int FindArchetype(unsigned int);
+	void PlaceEntity(unsigned int, int);
+	void RemoveFromChunk(int, int, int);
+	void MoveEntity(unsigned int, unsigned int);
+	void GetChunkView(int, int, ChunkViewType&);
+
+	vector<unsigned int> m_componentSizes;
+	vector<ArchetypeType> m_archetypes;
+	vector<EntityType> m_entities;
+	vector<unsigned int> m_freeEntities;
+	int m_entityCount;
+
+	vector<SystemType> m_systems;
+	vector<WorkType> m_work;
+	int m_phaseCount;
+};
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef _FONTCLASS_H_
+#define _FONTCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <vector>
+#include "resourceregistryclass.h"
+//	Namespaces:
+using namespace std;
+
+//	The characters the atlas has glyphs for. Any other character is drawn with the glyph of FONT_FALLBACK.
+const int FONT_FIRST_CHARACTER = 32;
+const int FONT_LAST_CHARACTER = 126;
+const char FONT_FALLBACK = '?';
+
+//	The width of the atlas in texels. It is as tall as the glyphs need, in rows of this width.
+const int FONT_ATLAS_WIDTH = 512;
+
+//	The FontClass draws the printable ASCII characters of a Windows font with GDI, once, into a texture
+//	atlas that only holds how much of every texel the glyph covers. A glyph is a cell as tall as a line of
+//	text and as wide as the character advances the pen, so runs are laid out by adding up advances.
+class FontClass
+{
+public:
+//	The corners of the glyph in the atlas, and its size and advance in pixels.
+	struct GlyphType
+	{
+		float left, top, right, bottom;
+		float width, height;
+		float advance;
+	};
+
+	FontClass();
+	FontClass(const FontClass&);
+	~FontClass();
+
+//	Initialize takes the face name of the font and its height in pixels.
+	bool Initialize(ID3D11Device*, ResourceRegistryClass*, const wchar_t*, int);
+	void Shutdown();
+
+	const GlyphType& GetGlyph(char);
+	float GetLineHeight();
+	ID3D11ShaderResourceView* GetShaderResourceView();
+	int GetAtlasHeight();
+
+private:
+	bool RasterizeGlyphs(const wchar_t*, int, vector<unsigned char>&);
+	bool InitializeTexture(ID3D11Device*, const vector<unsigned char>&);
+
+	GlyphType m_glyphs[FONT_LAST_CHARACTER - FONT_FIRST_CHARACTER + 1];
+	float m_lineHeight;
+	int m_atlasHeight;
+
+	ResourceRegistryClass* m_ResourceRegistry;
+	TextureHandle m_texture;
+	ShaderResourceHandle m_shaderResourceView;
+};
+
+#endif
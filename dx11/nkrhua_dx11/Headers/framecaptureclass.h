@@ -0,0 +1,81 @@
+#ifndef _FRAMECAPTURECLASS_H_
+#define _FRAMECAPTURECLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include "imagecompareclass.h"
+//	Namespaces:
+using namespace std;
+
+//	Number of staging textures in the readback ring. A capture is read back this many frames later at
+//	the latest, which is enough for the GPU to have finished the copy without us waiting on it.
+const int CAPTURE_STAGING_COUNT = 3;
+
+//	A pixel counts as different if its perceptual color difference is above the threshold, and a frame
+//	fails if more than the given share of its pixels are different.
+const float CAPTURE_COMPARE_THRESHOLD = 0.1f;
+const float CAPTURE_COMPARE_MAX_RATIO = 0.001f;
+
+//	The FrameCaptureClass reads rendered frames back to the CPU without stalling the pipeline. Capture
+//	copies a render target into the next free staging texture and returns right away, and Update maps
+//	the staging textures a few frames later with DO_NOT_WAIT so a copy the GPU has not finished yet is
+//	simply tried again next frame. The pixels are then handed to a worker thread that writes the image
+//	file and, if a golden image with the same frame number exists, compares the two and appends the
+//	result to the capture report.
+class FrameCaptureClass
+{
+private:
+	struct StagingSlotType
+	{
+		ID3D11Texture2D* texture;
+		int frameNumber;
+		bool pending;
+	};
+
+	struct CaptureJobType
+	{
+		int frameNumber;
+		ImageCompareClass::ImageType image;
+	};
+
+public:
+	FrameCaptureClass();
+	FrameCaptureClass(const FrameCaptureClass&);
+	~FrameCaptureClass();
+
+	bool Initialize(ID3D11Device*, int, int, const char*, const char*);
+	void Shutdown();
+
+	bool Capture(ID3D11DeviceContext*, ID3D11Texture2D*, int);
+	void Update(ID3D11DeviceContext*);
+	void Flush(ID3D11DeviceContext*);
+
+	int GetFailedCount();
+
+private:
+	bool ReadBack(ID3D11DeviceContext*, StagingSlotType&, bool);
+	void WriterThread();
+	void WriteCapture(CaptureJobType*);
+
+	int m_width, m_height;
+	char m_outputPrefix[128];
+	char m_goldenPrefix[128];
+
+	StagingSlotType m_staging[CAPTURE_STAGING_COUNT];
+	int m_oldestSlot, m_pendingCount;
+
+	thread m_writerThread;
+	mutex m_queueMutex;
+	condition_variable m_queueCondition;
+	deque<CaptureJobType*> m_queue;
+	bool m_quit;
+	int m_failedCount;
+
+	ImageCompareClass m_ImageCompare;
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef _GEOMETRYBENCHMARKCLASS_H_
+#define _GEOMETRYBENCHMARKCLASS_H_
+
+//	Includes:
+#include "d3dclass.h"
+#include "geometryheapclass.h"
+#include "colorshaderclass.h"
+
+//	The GeometryBenchmarkClass creates meshes once in a Geometry Heap of their own and once in buffers of
+//	their own, and draws them all both ways with the Color Shader, binding the heap's buffers once against
+//	binding the buffers of every mesh. Then half of the heap's meshes are replaced by meshes of other sizes
+//	and the heap is defragmented a frame's worth at a time until it is packed. The meshes are all zero, so
+//	they draw nothing. The times and how much was moved are appended to a report.
+class GeometryBenchmarkClass
+{
+public:
+//	Run takes the size of a vertex, the view matrix to draw with, the number of meshes, the bytes to move a
+//	frame and the report to append to.
+	static bool Run(D3DClass*, ColorShaderClass*, unsigned int, XMMATRIX, int, unsigned int, const char*);
+};
+
+#endif
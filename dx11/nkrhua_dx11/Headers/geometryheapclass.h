@@ -0,0 +1,94 @@
+#ifndef _GEOMETRYHEAPCLASS_H_
+#define _GEOMETRYHEAPCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <vector>
+#include "tlsfallocatorclass.h"
+#include "resourceregistryclass.h"
+//	Namespaces:
+using namespace std;
+
+//	The most blocks Defragment looks at in one call, whether they move or not.
+const int GEOMETRY_HEAP_DEFRAG_STEPS = 1024;
+
+//	The GeometryHeapClass keeps the vertices and indices of many static meshes in one large vertex buffer
+//	and one large index buffer, so meshes are created without asking the driver for buffers of their own
+//	and can be drawn one after the other without binding new buffers. The space in both buffers is handed
+//	out by a TLSFAllocatorClass. The indices of a mesh are stored as they are, relative to its first vertex,
+//	and drawn with the start index and base vertex of the mesh. Defragment is called once a frame and walks
+//	up either buffer from the bottom, sliding each mesh down over the free space below it through a scratch
+//	buffer on the video card, so the holes left by freed meshes gather at the top over a few frames without
+//	a stall. A mesh keeps its id while it moves, so the start index and base vertex have to be asked for
+//	every time it is drawn.
+class GeometryHeapClass
+{
+private:
+	struct MeshType
+	{
+		int vertexBlock, indexBlock;
+		int vertexCount, indexCount;
+	};
+
+//	Where the walk up a buffer has got to, whether anything has moved since it last started at the bottom,
+//	and whether a whole walk went by without anything moving. Creating or releasing a mesh starts it over.
+	struct DefragmentType
+	{
+		int cursor;
+		bool moved;
+		bool packed;
+	};
+
+public:
+	GeometryHeapClass();
+	GeometryHeapClass(const GeometryHeapClass&);
+	~GeometryHeapClass();
+
+	bool Initialize(ID3D11Device*, ResourceRegistryClass*, unsigned int, unsigned int, unsigned int, unsigned int);
+	void Shutdown();
+
+//	CreateMesh copies the vertices and indices into the heap and returns the id of the mesh, or -1 if the
+//	heap is full. A mesh without vertices or without indices has nothing to draw and is turned down with -1
+//	as well, before anything is taken from the heap.
+	int CreateMesh(ID3D11DeviceContext*, const void*, int, const unsigned long*, int);
+	void ReleaseMesh(int);
+
+//	Render puts both buffers on the pipeline. Any number of meshes can then be drawn with their start index
+//	and base vertex.
+	void Render(ID3D11DeviceContext*);
+
+	int GetIndexCount(int);
+	int GetStartIndex(int);
+	int GetBaseVertex(int);
+
+//	Defragment moves meshes down the buffers until the given number of bytes has been copied. It returns the
+//	number of bytes it copied, which is zero once both buffers are packed as far as they will go or it has
+//	looked at GEOMETRY_HEAP_DEFRAG_STEPS blocks without finding one to move.
+	unsigned int Defragment(ID3D11DeviceContext*, unsigned int);
+	bool IsPacked();
+
+	int GetMeshCount();
+	unsigned int GetUsedVertexCount();
+	unsigned int GetUsedIndexCount();
+	unsigned int GetLargestFreeVertexCount();
+	unsigned int GetLargestFreeIndexCount();
+
+private:
+	unsigned int MoveBlock(ID3D11DeviceContext*, TLSFAllocatorClass&, DefragmentType&, ID3D11Buffer*, unsigned int);
+	void ResetDefragment();
+
+	ResourceRegistryClass* m_ResourceRegistry;
+	BufferHandle m_vertexBuffer, m_indexBuffer;
+	BufferHandle m_scratchBuffer;
+	unsigned int m_vertexStride, m_scratchSize;
+
+	TLSFAllocatorClass m_vertexAllocator;
+	TLSFAllocatorClass m_indexAllocator;
+	DefragmentType m_vertexDefragment, m_indexDefragment;
+
+	vector<MeshType> m_meshes;
+	vector<int> m_unusedMeshes;
+	int m_meshCount;
+};
+
+#endif
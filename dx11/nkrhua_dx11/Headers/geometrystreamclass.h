@@ -0,0 +1,75 @@
+#ifndef _GEOMETRYSTREAMCLASS_H_
+#define _GEOMETRYSTREAMCLASS_H_
+
+#include <d3d11.h>
+#include <atomic>
+using namespace std;
+
+//	The GeometryStreamClass owns one large D3D11_USAGE_DYNAMIC buffer that is used as a ring for geometry
+//	generated at runtime (debug lines, UI, particles, procedural meshes). Each frame the buffer is mapped
+//	once with MAP_WRITE_NO_OVERWRITE and writers append behind the previous frames. When the end of the
+//	buffer is reached it wraps back to the start, using WRITE_DISCARD if the GPU may still be reading that
+//	region. An event query is issued after the last draw of each frame so we know which regions are still in
+//	flight.
+const int GEOMETRY_STREAM_FRAMES = 4;
+
+class GeometryStreamClass
+{
+private:
+//	Every frame that wrote to the ring keeps a fence and the byte range it used. The range is dropped
+//	once the query signals, or as soon as the buffer is discarded since the data then lives elsewhere.
+	struct FrameFenceType
+	{
+		ID3D11Query* query;
+		unsigned int begin, end;
+		bool pending;
+		bool hasRange;
+	};
+
+public:
+	GeometryStreamClass();
+	GeometryStreamClass(const GeometryStreamClass&);
+	~GeometryStreamClass();
+
+	bool Initialize(ID3D11Device*, unsigned int, unsigned int);
+	void Shutdown();
+
+//	BeginFrame maps the buffer and EndFrame unmaps it. Between the two calls any thread may call Reserve,
+//	which hands out space with an atomic cursor and returns 0 if this frame's region is full. The returned
+//	offset is in bytes from the start of GetBuffer(). Fence issues the fence of the frame and is called after
+//	the last draw that reads this frame's data, since the fence only covers the commands issued before it.
+	bool BeginFrame(ID3D11DeviceContext*);
+	void EndFrame(ID3D11DeviceContext*);
+	void Fence(ID3D11DeviceContext*);
+
+	void* Reserve(unsigned int, unsigned int, unsigned int&);
+
+	ID3D11Buffer* GetBuffer();
+	unsigned int GetBufferSize();
+
+//	The bytes written to the ring in the frame that was ended last.
+	unsigned int GetFrameBytes();
+
+private:
+	void RetireFrames(ID3D11DeviceContext*, bool);
+	void DropRanges();
+	bool FindInFlightTail(unsigned int&, bool&);
+
+	ID3D11Buffer* m_buffer;
+	unsigned int m_bufferSize;
+	unsigned char* m_mappedData;
+
+	atomic<unsigned int> m_cursor;
+	atomic<bool> m_overflowed;
+	unsigned int m_limit;
+	unsigned int m_frameBegin;
+	unsigned int m_frameBytes;
+	unsigned int m_frameEnd;
+	bool m_fenceDue;
+	bool m_discardNext;
+
+	FrameFenceType m_fences[GEOMETRY_STREAM_FRAMES];
+	int m_oldestFence, m_fenceCount;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef _IMAGECOMPARECLASS_H_
+#define _IMAGECOMPARECLASS_H_
+
+//	Includes:
+#include <stdio.h>
+#include <vector>
+//	Namespaces:
+using namespace std;
+
+//	The ImageCompareClass reads and writes uncompressed targa files and compares a rendered image against
+//	a golden image. It does not depend on Direct3D so the comparison can run anywhere the images can be read.
+//
+//	The comparison is perceptual rather than exact: each pixel pair is compared in the YIQ color space with
+//	weights that follow how sensitive the eye is to brightness and the two chroma axes, and a pixel only
+//	counts as different if no pixel in its 3x3 neighbourhood of the other image is within the threshold.
+//	That way a change like culling or LOD that moves an edge by one pixel or changes rounding is accepted,
+//	while a missing object or a wrong color is not.
+class ImageCompareClass
+{
+public:
+//	Images are kept as 8-bit RGBA rows from the top of the image down.
+	struct ImageType
+	{
+		int width, height;
+		vector<unsigned char> pixels;
+	};
+
+	struct CompareResultType
+	{
+		int differentPixels;
+		float differentRatio;
+		float maxDelta;
+		bool passed;
+	};
+
+public:
+	ImageCompareClass();
+	ImageCompareClass(const ImageCompareClass&);
+	~ImageCompareClass();
+
+	bool LoadTarga(const char*, ImageType&);
+	bool SaveTarga(const char*, const ImageType&);
+
+	bool Compare(const ImageType&, const ImageType&, float, float, CompareResultType&, ImageType*);
+
+private:
+	float ColorDelta(const unsigned char*, const unsigned char*);
+	float NeighbourDelta(const ImageType&, const ImageType&, int, int);
+};
+
+#endif
@@ -15,7 +15,16 @@ public:
 
 	bool IsKeyDown(unsigned int);
 
+	void MouseMove(int, int);
+	void MouseButtonDown();
+	void MouseButtonUp();
+
+	void GetMousePosition(int&, int&);
+	bool IsMouseButtonDown();
+
 private:
 	bool m_keys[256];
+	int m_mouseX, m_mouseY;
+	bool m_mouseButton;
 };
 #endif
@@ -0,0 +1,52 @@
+#ifndef _JOBSYSTEMCLASS_H_
+#define _JOBSYSTEMCLASS_H_
+
+//	Includes:
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+//	Namespaces:
+using namespace std;
+
+//	The JobSystemClass keeps a pool of worker threads that sleep until there is work. ParallelFor splits a
+//	range of items into batches and every worker, together with the calling thread, keeps taking the next
+//	batch off an atomic counter until the range is done, so uneven batches balance out by themselves.
+//	ParallelFor only returns once every batch has finished. Calls from different threads take turns, and a
+//	job must not call ParallelFor itself.
+class JobSystemClass
+{
+public:
+	JobSystemClass();
+	JobSystemClass(const JobSystemClass&);
+	~JobSystemClass();
+
+//	A thread count of 0 uses one worker less than the machine has cores, since the calling thread works too.
+	bool Initialize(int);
+	void Shutdown();
+
+	void ParallelFor(int, int, const function<void(int, int)>&);
+
+	int GetThreadCount();
+
+private:
+	void WorkerThread();
+	void RunBatches(const function<void(int, int)>*, int, int);
+
+	vector<thread> m_threads;
+	mutex m_mutex;
+	mutex m_callMutex;
+	condition_variable m_wakeCondition;
+	condition_variable m_doneCondition;
+
+	const function<void(int, int)>* m_job;
+	int m_count, m_batchSize;
+	atomic<int> m_nextIndex;
+	int m_busyWorkers;
+	unsigned int m_generation;
+	bool m_quit;
+};
+
+#endif
@@ -0,0 +1,144 @@
+#ifndef _LIGHTCLUSTERCLASS_H_
+#define _LIGHTCLUSTERCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <directxmath.h>
+#include <vector>
+#include "jobsystemclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	The view frustum is cut into LIGHT_CLUSTER_X by LIGHT_CLUSTER_Y tiles on screen and LIGHT_CLUSTER_Z
+//	slices in depth. The slices get thicker with the distance, so the clusters keep roughly the same shape.
+const int LIGHT_CLUSTER_X = 16;
+const int LIGHT_CLUSTER_Y = 9;
+const int LIGHT_CLUSTER_Z = 24;
+const int LIGHT_CLUSTER_COUNT = LIGHT_CLUSTER_X * LIGHT_CLUSTER_Y * LIGHT_CLUSTER_Z;
+
+//	The most lights a single cluster can hold, and the most light indices of all clusters together that fit
+//	the buffer on the video card. Lights past either limit are dropped from the cluster.
+const int LIGHT_CLUSTER_MAX_LIGHTS = 256;
+const int LIGHT_CLUSTER_MAX_INDICES = 256 * 1024;
+
+//	The number of lights and of cluster rows handed to a job thread at once.
+const int LIGHT_CLUSTER_LIGHT_BATCH_SIZE = 256;
+const int LIGHT_CLUSTER_ROW_BATCH_SIZE = 4;
+
+//	The LightClusterClass culls point and spot lights for clustered forward shading. Every frame Cull moves
+//	the lights into view space and bounds each with a sphere, then goes through the rows of clusters on the
+//	job threads, testing every light that overlaps a row against four clusters of it at a time with SIMD
+//	instructions. The lists of the clusters are packed into one array of light indices, which Render copies
+//	to the video card along with the lights and an offset and count for every cluster. The lit permutation
+//	of color.ps finds the cluster of a pixel from its screen position and depth and only shades the lights
+//	in its list. Cull does not touch Direct3D, so with no device given to Initialize the culling can be run
+//	and timed on its own.
+class LightClusterClass
+{
+public:
+//	A point light has a cone cosine of -1 or less. For a spot light the light falls off from the inner to
+//	the outer cone cosine around the direction. The range is where the light reaches zero for both.
+	struct LightType
+	{
+		XMFLOAT3 position;
+		float range;
+		XMFLOAT3 color;
+		float outerCosine;
+		XMFLOAT3 direction;
+		float innerCosine;
+	};
+
+private:
+//	This must match the ClusterBuffer in color.ps.
+	struct ClusterBufferType
+	{
+		XMFLOAT4 tileScale;
+		XMFLOAT4 depthScale;
+		XMFLOAT4 ambient;
+	};
+
+	struct ClusterType
+	{
+		unsigned int offset;
+		unsigned int count;
+	};
+
+//	The view space bounds of the lights, in the order of the lights, and the range of clusters each one
+//	overlaps. Lights that are outside the frustum get an empty range.
+	struct LightBoundsType
+	{
+		XMFLOAT4 sphere;
+		int minimumX, maximumX;
+		int minimumY, maximumY;
+		int minimumZ, maximumZ;
+	};
+
+public:
+	LightClusterClass();
+	LightClusterClass(const LightClusterClass&);
+	~LightClusterClass();
+
+	bool Initialize(ID3D11Device*, int);
+	void Shutdown();
+
+	void SetProjection(XMMATRIX, int, int);
+	void SetScreenSize(int, int);
+	void SetAmbient(XMFLOAT3);
+
+	void Cull(JobSystemClass*, const LightType*, int, XMMATRIX);
+	bool Render(ID3D11DeviceContext*);
+
+	int GetClusterLightCount(int, int, int);
+	const unsigned int* GetClusterLights(int, int, int);
+	int GetLightIndexCount();
+	int GetDroppedLightCount();
+
+//	The time in milliseconds the last Cull took.
+	float GetCullTime();
+
+private:
+	bool InitializeBuffers(ID3D11Device*);
+	void ShutdownBuffers();
+
+	void BoundLights(int, int, XMMATRIX);
+	void CullRows(int, int);
+	int GetSlice(float);
+
+	int m_maxLights;
+	float m_projectionX, m_projectionY;
+	float m_nearZ, m_farZ;
+	float m_sliceScale, m_sliceBias;
+	int m_screenWidth, m_screenHeight;
+	XMFLOAT3 m_ambient;
+
+//	The view space bounds of every cluster. The clusters of a row share their y and z bounds, the x bounds
+//	are kept for each column and are packed four to a vector for the SIMD test.
+	vector<XMFLOAT4A> m_columnMinimum, m_columnMaximum;
+	vector<XMFLOAT2> m_rowBoundsY;
+	vector<XMFLOAT2> m_sliceBoundsZ;
+
+	const LightType* m_lights;
+	int m_lightCount;
+	vector<LightType> m_viewLights;
+	vector<LightBoundsType> m_lightBounds;
+	vector<int> m_sliceLights, m_sliceOffsets;
+
+	vector<unsigned short> m_clusterLights;
+	vector<int> m_clusterCounts;
+	vector<ClusterType> m_clusters;
+	vector<unsigned int> m_lightIndices;
+	int m_droppedCount;
+
+	ID3D11Buffer* m_clusterBuffer;
+	ID3D11Buffer* m_clusterListBuffer;
+	ID3D11Buffer* m_indexBuffer;
+	ID3D11Buffer* m_lightBuffer;
+	ID3D11ShaderResourceView* m_clusterListView;
+	ID3D11ShaderResourceView* m_indexView;
+	ID3D11ShaderResourceView* m_lightView;
+
+	float m_cullTime;
+};
+
+#endif
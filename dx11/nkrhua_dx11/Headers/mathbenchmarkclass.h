@@ -0,0 +1,19 @@
+#ifndef _MATHBENCHMARKCLASS_H_
+#define _MATHBENCHMARKCLASS_H_
+
+//	Includes:
+#include "batchmathclass.h"
+
+//	The MathBenchmarkClass fills arrays with random points and random rotated, scaled and moved matrices, and
+//	does every batch operation over them one at a time with DirectXMath as the reference. Then it runs the
+//	kernels of every path the Batch Math class supports over the same arrays, and appends the fastest of a
+//	few runs of each to a report along with how many floats differ from the reference and by how much at
+//	most. The path that was picked is picked again afterwards.
+class MathBenchmarkClass
+{
+public:
+//	Run takes the number of points and matrices and the report to append to.
+	static void Run(int, const char*);
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _MESHCODECCLASS_H_
+#define _MESHCODECCLASS_H_
+
+//	Includes:
+#include <stddef.h>
+#include <vector>
+//	Namespaces:
+using namespace std;
+
+//	Vertices are encoded in blocks of this many, which is one SSE register of bytes per byte of the vertex.
+const int MESH_CODEC_BLOCK_SIZE = 16;
+//	The largest vertex the codec takes, in bytes. Vertices have to be a multiple of four bytes.
+const int MESH_CODEC_MAX_STRIDE = 256;
+const unsigned int MESH_FILE_VERSION = 1;
+
+//	The MeshCodecClass compresses meshes for the disk and decodes them fast enough that reading the
+//	smaller file and decoding it is quicker than reading the vertices and indices as they are.
+//
+//	Vertices are encoded byte by byte. Every byte of a vertex is replaced by how much it changed from the
+//	same byte of the vertex before, zigzagged so small changes either way are small numbers, and the 16
+//	changes of one byte over a block of 16 vertices are stored with 0, 2, 4 or 8 bits each, whichever is
+//	the fewest that holds all of them. The decoder unpacks, adds up and transposes a block with SSE2 four
+//	bytes of the vertex at a time, so it never goes through the vertices one by one.
+//
+//	Indices are encoded a triangle at a time against what the triangles before it used. A triangle that
+//	shares an edge with one of the last 15 edges seen is a byte naming the edge and its third vertex, and
+//	the third vertex is either the next vertex never used before, one of the last 14 vertices used, or an
+//	explicit difference from the next vertex. With the vertices in the order they are first used, which
+//	OptimizeVertexFetch puts them in, most triangles of a connected mesh take one byte. Triangles can come
+//	back rotated, with the same winding.
+//
+//	WriteMesh and ReadMesh are the export and import of .mesh files: a MeshHeaderType followed by the
+//	encoded vertices and the encoded indices.
+class MeshCodecClass
+{
+public:
+	struct MeshHeaderType
+	{
+		char magic[4];
+		unsigned int version;
+		unsigned int vertexCount;
+		unsigned int vertexStride;
+		unsigned int indexCount;
+		unsigned int vertexBytes;
+		unsigned int indexBytes;
+		unsigned int padding;
+	};
+
+public:
+	static bool EncodeVertices(const void*, int, int, vector<unsigned char>&);
+	static bool DecodeVertices(const unsigned char*, size_t, int, int, void*);
+	static bool DecodeVerticesScalar(const unsigned char*, size_t, int, int, void*);
+
+	static bool EncodeIndices(const unsigned long*, int, vector<unsigned char>&);
+	static bool DecodeIndices(const unsigned char*, size_t, int, unsigned long*);
+
+//	OptimizeVertexFetch reorders the vertices in place into the order the indices first use them, and
+//	changes the indices to match. Vertices no index uses are moved to the end.
+	static void OptimizeVertexFetch(void*, int, int, unsigned long*, int);
+
+//	WriteMesh reorders a copy of the mesh with OptimizeVertexFetch before encoding it, so what ReadMesh
+//	gives back is the same mesh with its vertices in another order. ReadMesh fails for a file whose
+//	vertices aren't the stride it is given, whose indices aren't whole triangles or which has an index past
+//	its last vertex, so what it gives back can be drawn without reading outside the vertex buffer.
+	static bool WriteMesh(const char*, const void*, int, int, const unsigned long*, int);
+	static bool ReadMesh(const char*, int, vector<unsigned char>&, vector<unsigned long>&);
+
+private:
+	static int GetHeaderSize(int);
+};
+
+#endif
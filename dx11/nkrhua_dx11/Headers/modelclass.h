@@ -3,18 +3,17 @@
 
 #include <d3d11.h>
 #include <directxmath.h>
+#include "geometryheapclass.h"
+#include "vertexformatclass.h"
 using namespace DirectX;
 
 class ModelClass
 {
 private:
 //	Here is the definition of our Vertex Type that will be used with the Vertex Buffer in this ModelClass.
-//	Also take note that this typedef must match the layout in the ColorShaderClass.
-	struct VertexType
-	{
-		XMFLOAT3 position;
-		XMFLOAT4 color;
-	};
+//	It is declared with the other vertex formats, which the Shader Manager checks against VertexInputType in
+//	color.vs and builds the input layout from.
+	typedef ColorVertexType VertexType;
 
 public:
 	ModelClass();
@@ -23,22 +22,41 @@ public:
 
 //	The function here handles Initializing and Shutdown of the model's vertex and index buffers. The Render
 //	function puts the model geometry on the video card to prepare it for drawing by the color shader.
-	bool Initialize(ID3D11Device*);
+//	Given a Geometry Heap the model keeps its vertices and indices in the heap's buffers instead of its
+//	own, and has to be drawn from its start index and base vertex in them. The model is imported from the
+//	mesh file it is given, which is exported from the built in triangle whenever it can't be read.
+	bool Initialize(ID3D11Device*, ID3D11DeviceContext*, GeometryHeapClass*, const char*);
 	void Shutdown();
 	void Render(ID3D11DeviceContext*);
 
 	int GetIndexCount();
+	int GetStartIndex();
+	int GetBaseVertex();
+	int GetMesh();
+	unsigned int GetVertexStride();
+
+//	The vertices, their positions and the indices are kept on the CPU as well, for building the BVH that
+//	picking uses and the static batches.
+	int GetVertexCount();
+	const VertexType* GetVertices();
+	const XMFLOAT3* GetPositions();
+	const unsigned long* GetIndices();
 
 //	The private variables in the ModelClass are the Vertex and Index buffers as well as two integers to keep
 //	track of the size of each buffer. Note that all DirectX 11 Buffers generally use the generic ID3D11Buffer type
 //	and are more clearly identified by a buffer description wen they're first created.
 private:
-	bool InitializeBuffers(ID3D11Device*);
+	bool InitializeBuffers(ID3D11Device*, ID3D11DeviceContext*, const char*);
 	void ShutdownBuffers();
 	void RenderBuffers(ID3D11DeviceContext*);
 
 	ID3D11Buffer* m_vertexBuffer, * m_indexBuffer;
+	GeometryHeapClass* m_GeometryHeap;
+	int m_mesh;
 	int m_vertexCount, m_indexCount;
+	VertexType* m_vertices;
+	XMFLOAT3* m_positions;
+	unsigned long* m_indices;
 };
 
 #endif 
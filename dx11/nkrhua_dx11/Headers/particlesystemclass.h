@@ -0,0 +1,109 @@
+#ifndef _PARTICLESYSTEMCLASS_H_
+#define _PARTICLESYSTEMCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <directxmath.h>
+#include <vector>
+#include "jobsystemclass.h"
+#include "geometrystreamclass.h"
+#include "vertexformatclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	The particle arrays are aligned to and padded to a multiple of eight floats, the width of an AVX
+//	register, so any vector width up to that can run over them without a scalar tail.
+const int PARTICLE_SIMD_WIDTH = 8;
+const int PARTICLE_ALIGNMENT = 32;
+
+//	Particles are handed to the job threads in chunks of this many. It has to be a multiple of
+//	PARTICLE_SIMD_WIDTH.
+const int PARTICLE_BATCH_SIZE = 4096;
+
+//	The depth sort is a radix sort over 32 bit keys in three passes of this many bits.
+const int PARTICLE_SORT_BITS = 11;
+
+//	The ParticleSystemClass runs one emitter. Particles are kept as a structure of arrays: every property
+//	has its own aligned array, so the simulation loads four particles per SIMD register and only touches
+//	the properties it needs. Each frame Update kills, simulates and emits particles on the job threads,
+//	and WriteInstances turns the live particles into instances for the INSTANCED permutation of the color
+//	shader, written straight into the Geometry Stream. Emitters drawn with alpha blending are sorted back
+//	to front by view depth first.
+class ParticleSystemClass
+{
+public:
+	struct EmitterType
+	{
+		XMFLOAT3 position;
+		XMFLOAT3 velocity;
+		XMFLOAT3 velocitySpread;
+		XMFLOAT3 gravity;
+		float emissionRate;
+		float minLifetime, maxLifetime;
+		float startSize, endSize;
+		XMFLOAT4 startColor, endColor;
+		bool alphaBlended;
+	};
+
+private:
+//	The billboard quad every particle is drawn with, in the format of the ModelClass vertices, and the per
+//	instance data read by the INSTANCED permutation of color.vs:
+	typedef ColorVertexType VertexType;
+	typedef ColorInstanceType InstanceType;
+
+public:
+	ParticleSystemClass();
+	ParticleSystemClass(const ParticleSystemClass&);
+	~ParticleSystemClass();
+
+	bool Initialize(ID3D11Device*, int, const EmitterType&);
+	void Shutdown();
+
+	void Update(JobSystemClass*, float);
+	bool WriteInstances(JobSystemClass*, GeometryStreamClass*, XMMATRIX);
+	void Render(ID3D11DeviceContext*, GeometryStreamClass*);
+
+//	SortByDepth orders the live particles back to front along the given view direction for the next draw.
+//	WriteInstances calls it for alpha blended emitters.
+	void SortByDepth(JobSystemClass*, XMVECTOR);
+
+	int GetIndexCount();
+	int GetInstanceCount();
+	int GetParticleCount();
+	bool IsAlphaBlended();
+
+//	The number of particles killed, simulated and emitted per second during the last Update.
+	float GetParticlesPerSecond();
+
+private:
+	bool InitializeArrays(int);
+	void ShutdownArrays();
+	bool InitializeBuffers(ID3D11Device*);
+	void ShutdownBuffers();
+
+	int SimulateChunk(int, int, float);
+	void EmitParticles(int, int);
+	void MoveParticles(int, int, int);
+
+	EmitterType m_emitter;
+	int m_capacity, m_particleCount;
+
+	float* m_positionX, * m_positionY, * m_positionZ;
+	float* m_velocityX, * m_velocityY, * m_velocityZ;
+	float* m_age, * m_lifetime;
+
+	vector<int> m_chunkCounts;
+	vector<unsigned int> m_sortKeys[2], m_sortIndices[2];
+	unsigned int* m_drawOrder;
+
+	float m_emitAccumulator;
+	unsigned int m_emitSeed;
+	float m_particlesPerSecond;
+
+	ID3D11Buffer* m_vertexBuffer, * m_indexBuffer;
+	unsigned int m_instanceOffset;
+	int m_instanceCount;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef _PIPELINESTATSCLASS_H_
+#define _PIPELINESTATSCLASS_H_
+
+//	Includes:
+#include "triplebufferclass.h"
+
+//	The PipelineStatsClass keeps what the frames saw of the snapshots the simulation handed them: how many
+//	frames drew the snapshot the frame before them drew again, and the latency of every frame from the start
+//	of the step it drew to it being presented. WriteReport appends them with the counts of the Triple Buffer
+//	the snapshots went through.
+class PipelineStatsClass
+{
+public:
+	PipelineStatsClass();
+	PipelineStatsClass(const PipelineStatsClass&);
+	~PipelineStatsClass();
+
+	void AddFrame(float);
+	void AddRepeatedFrame();
+
+//	WriteReport takes the report, whether the simulation runs on a thread of its own and the steps it runs a
+//	second.
+	void WriteReport(const char*, TripleBufferClass*, bool, int);
+
+private:
+	double m_latencyTotal;
+	float m_latencyMaximum;
+	int m_latencyFrames, m_repeatedFrames;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef _RENDERSTATSCLASS_H_
+#define _RENDERSTATSCLASS_H_
+
+//	Includes:
+#include <stdio.h>
+#include <vector>
+//	Namespaces:
+using namespace std;
+
+//	The counters kept for every frame. The device context ones are counted by the StatsContextClass, and the
+//	rest are handed in by the application from the subsystems that know them.
+enum RenderStat
+{
+	STAT_FRAME_TIME,
+	STAT_DRAWS,
+	STAT_PRIMITIVES,
+	STAT_STATE_BINDS,
+	STAT_MAPS,
+	STAT_UNMAPS,
+	STAT_UPLOAD_BYTES,
+	STAT_CULLED_OBJECTS,
+	STAT_MEMORY_BYTES,
+	STAT_LATENCY,
+	STAT_COUNT
+};
+
+//	The RenderStatsClass adds up the counters of the frame being drawn, and EndFrame moves them into a
+//	rolling window of the last frames the minimum, mean, maximum and percentiles are taken over. With a CSV
+//	file every ended frame is also written to it as a row, and WriteJSON writes the window as it stands, so
+//	tools can read both without parsing anything made for people.
+class RenderStatsClass
+{
+public:
+	RenderStatsClass();
+	RenderStatsClass(const RenderStatsClass&);
+	~RenderStatsClass();
+
+//	Initialize takes the number of frames in the window and the CSV file to write, or an empty name for none.
+	bool Initialize(int, const char*);
+	void Shutdown();
+
+	void Add(int, double);
+	void Set(int, double);
+	void EndFrame();
+
+	int GetFrameCount();
+	int GetWindowCount();
+	double GetLast(int);
+	double GetMinimum(int);
+	double GetMean(int);
+	double GetMaximum(int);
+	double GetPercentile(int, float);
+
+	bool WriteJSON(const char*);
+
+	static const char* GetName(int);
+
+private:
+	double* GetWindow(int);
+
+	vector<double> m_window;
+	vector<double> m_sorted;
+	double m_current[STAT_COUNT];
+	double m_last[STAT_COUNT];
+	int m_windowSize, m_windowCount, m_windowNext;
+	int m_frameCount;
+	FILE* m_csvFile;
+};
+
+#endif
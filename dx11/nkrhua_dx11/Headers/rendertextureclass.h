@@ -0,0 +1,48 @@
+#ifndef _RENDERTEXTURECLASS_H_
+#define _RENDERTEXTURECLASS_H_
+
+#include <d3d11.h>
+#include <directxmath.h>
+using namespace DirectX;
+
+//	The RenderTextureClass is an offscreen render target with its own depth buffer and viewport.
+//	Anything the D3DClass can draw to the back buffer can be drawn here instead, and afterwards the
+//	texture can be sampled by a shader or copied out for readback. D3DClass::SetBackBufferRenderTarget
+//	and ResetViewport switch rendering back to the screen.
+class RenderTextureClass
+{
+public:
+	RenderTextureClass();
+	RenderTextureClass(const RenderTextureClass&);
+	~RenderTextureClass();
+
+	bool Initialize(ID3D11Device*, int, int, float, float, DXGI_FORMAT);
+	void Shutdown();
+
+	void SetRenderTarget(ID3D11DeviceContext*);
+	void SetViewportSize(int, int);
+	void ClearRenderTarget(ID3D11DeviceContext*, float, float, float, float);
+
+	ID3D11Texture2D* GetTexture();
+	ID3D11ShaderResourceView* GetShaderResourceView();
+	void GetProjectionMatrix(XMMATRIX&);
+	void GetOrthoMatrix(XMMATRIX&);
+
+	int GetTextureWidth();
+	int GetTextureHeight();
+
+private:
+	int m_textureWidth, m_textureHeight;
+
+	ID3D11Texture2D* m_renderTargetTexture;
+	ID3D11RenderTargetView* m_renderTargetView;
+	ID3D11ShaderResourceView* m_shaderResourceView;
+	ID3D11Texture2D* m_depthStencilBuffer;
+	ID3D11DepthStencilView* m_depthStencilView;
+	D3D11_VIEWPORT m_viewport;
+
+	XMMATRIX m_projectionMatrix;
+	XMMATRIX m_orthoMatrix;
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef _REPLAYBENCHMARKCLASS_H_
+#define _REPLAYBENCHMARKCLASS_H_
+
+//	Includes:
+#include "commandreplayclass.h"
+#include "d3dreplaybackendclass.h"
+
+//	The ReplayBenchmarkClass reads the commands captured to a command file, plays them a number of times on a
+//	device of their own, timing every draw on the GPU, and appends the cost of every draw to a report. The
+//	replay tool in replaymain.cpp plays them through the null backend instead, for machines without Direct3D.
+class ReplayBenchmarkClass
+{
+public:
+//	Run takes the command file, the number of times to play it, whether to play it on the software renderer
+//	and the report to append to.
+	static bool Run(const char*, int, bool, const char*);
+};
+
+#endif
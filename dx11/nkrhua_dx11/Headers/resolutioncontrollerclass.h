@@ -0,0 +1,43 @@
+#ifndef _RESOLUTIONCONTROLLERCLASS_H_
+#define _RESOLUTIONCONTROLLERCLASS_H_
+
+//	The ResolutionControllerClass picks the scale of the resolution the scene is rendered at from the frame
+//	times it is given, so the frames stay within a target time. It is a PID controller on the relative
+//	error of the smoothed frame time. Around the target there is a band it does not act in, wider on the
+//	side of spare time than on the side of missed frames, so it drops the scale quickly and only raises it
+//	again once there is clearly room for it. After every change it waits a few frames for the frame times
+//	to show the new scale before it acts again. The frame times are smoothed from the median of the last three,
+//	so a single hitch doesn't move the scale. It has no device, so it can be driven from recorded traces, as
+//	resolutiontestmain.cpp does.
+class ResolutionControllerClass
+{
+public:
+	ResolutionControllerClass();
+	ResolutionControllerClass(const ResolutionControllerClass&);
+	~ResolutionControllerClass();
+
+//	Initialize takes the target frame time in milliseconds and the smallest and largest scale. The scale
+//	starts at the largest.
+	void Initialize(float, float, float);
+	void Reset();
+
+	float Update(float);
+
+	float GetScale();
+	float GetSmoothedTime();
+	int GetChangeCount();
+
+private:
+	float m_targetTime;
+	float m_minimumScale, m_maximumScale;
+	float m_scale;
+	float m_recentTimes[3];
+	int m_recentCount;
+	float m_smoothedTime, m_lastSmoothedTime;
+	float m_integral;
+	int m_holdFrames;
+	int m_changeCount;
+	bool m_started;
+};
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef _RESOURCEREGISTRYCLASS_H_
+#define _RESOURCEREGISTRYCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <vector>
+#include <deque>
+//	Namespaces:
+using namespace std;
+
+//	A handle is 32 bits: the slot index in the low bits, then the generation of the slot, then the type
+//	of resource. The generation is never zero, so a handle of zero is never valid. A slot whose generation
+//	has run through all 255 values is retired instead of starting over at one, so an old handle can never
+//	match a new resource. That costs one slot of the index range every 255 releases.
+const int RESOURCE_INDEX_BITS = 20;
+const int RESOURCE_GENERATION_BITS = 8;
+const int RESOURCE_TYPE_BITS = 4;
+const unsigned int RESOURCE_INDEX_MASK = (1u << RESOURCE_INDEX_BITS) - 1;
+const unsigned int RESOURCE_GENERATION_MASK = (1u << RESOURCE_GENERATION_BITS) - 1;
+
+//	The number of frames whose fences can be in flight before EndFrame waits for the oldest one.
+const int RESOURCE_REGISTRY_FRAMES = 4;
+
+enum ResourceType
+{
+	RESOURCE_BUFFER = 1,
+	RESOURCE_TEXTURE,
+	RESOURCE_SHADER_RESOURCE_VIEW,
+	RESOURCE_DEPTH_STENCIL_VIEW,
+	RESOURCE_RASTERIZER_STATE,
+	RESOURCE_DEPTH_STENCIL_STATE,
+	RESOURCE_BLEND_STATE,
+	RESOURCE_SAMPLER_STATE,
+	RESOURCE_TYPE_COUNT
+};
+
+//	The type of a handle says what the resource it names is, so a buffer handle can't be passed where a
+//	sampler handle is wanted. The id is all it holds, so it can be copied and stored like an integer.
+template <class T> struct ResourceHandle
+{
+	unsigned int id;
+};
+
+typedef ResourceHandle<ID3D11Buffer> BufferHandle;
+typedef ResourceHandle<ID3D11Texture2D> TextureHandle;
+typedef ResourceHandle<ID3D11ShaderResourceView> ShaderResourceHandle;
+typedef ResourceHandle<ID3D11DepthStencilView> DepthStencilViewHandle;
+typedef ResourceHandle<ID3D11RasterizerState> RasterizerStateHandle;
+typedef ResourceHandle<ID3D11DepthStencilState> DepthStencilStateHandle;
+typedef ResourceHandle<ID3D11BlendState> BlendStateHandle;
+typedef ResourceHandle<ID3D11SamplerState> SamplerStateHandle;
+
+inline ResourceType GetResourceType(ID3D11Buffer*) { return RESOURCE_BUFFER; }
+inline ResourceType GetResourceType(ID3D11Texture2D*) { return RESOURCE_TEXTURE; }
+inline ResourceType GetResourceType(ID3D11ShaderResourceView*) { return RESOURCE_SHADER_RESOURCE_VIEW; }
+inline ResourceType GetResourceType(ID3D11DepthStencilView*) { return RESOURCE_DEPTH_STENCIL_VIEW; }
+inline ResourceType GetResourceType(ID3D11RasterizerState*) { return RESOURCE_RASTERIZER_STATE; }
+inline ResourceType GetResourceType(ID3D11DepthStencilState*) { return RESOURCE_DEPTH_STENCIL_STATE; }
+inline ResourceType GetResourceType(ID3D11BlendState*) { return RESOURCE_BLEND_STATE; }
+inline ResourceType GetResourceType(ID3D11SamplerState*) { return RESOURCE_SAMPLER_STATE; }
+
+//	The ResourceRegistryClass owns the Direct3D resources of the other classes, which keep handles to them
+//	instead of pointers. Each type of resource has its own dense array of slots, and a handle is its slot
+//	index and the generation the slot was at when the resource was put in it. Get checks the generation
+//	before handing the pointer out, so a handle kept after its resource was released gets nothing instead
+//	of whatever took the slot next, and the lookup is counted so it shows up. Release bumps the generation
+//	straight away but only queues the resource itself. EndFrame puts a fence behind every frame, and the
+//	queued resources are let go of once the fence of the frame they were released in has passed, so the
+//	video card is never still using them.
+class ResourceRegistryClass
+{
+private:
+	struct SlotType
+	{
+		ID3D11DeviceChild* resource;
+		unsigned int generation;
+		unsigned int bytes;
+	};
+
+	struct PendingType
+	{
+		ID3D11DeviceChild* resource;
+		unsigned long long frame;
+		unsigned int bytes;
+	};
+
+	struct FrameFenceType
+	{
+		ID3D11Query* query;
+		unsigned long long frame;
+	};
+
+public:
+	ResourceRegistryClass();
+	ResourceRegistryClass(const ResourceRegistryClass&);
+	~ResourceRegistryClass();
+
+	bool Initialize(ID3D11Device*);
+	void Shutdown();
+
+//	Register takes over the reference the caller holds. A null resource gets a handle of zero.
+	template <class T> ResourceHandle<T> Register(T* resource)
+	{
+		ResourceHandle<T> handle;
+
+		handle.id = RegisterResource(resource, GetResourceType(resource));
+
+		return handle;
+	}
+
+	template <class T> T* Get(ResourceHandle<T> handle)
+	{
+		return (T*)GetResource(handle.id, GetResourceType((T*)0), true);
+	}
+
+	template <class T> bool IsValid(ResourceHandle<T> handle)
+	{
+		return GetResource(handle.id, GetResourceType((T*)0), false) != 0;
+	}
+
+//	Release clears the handle it is given, so the owner can't use it again by mistake.
+	template <class T> void Release(ResourceHandle<T>& handle)
+	{
+		ReleaseResource(handle.id, GetResourceType((T*)0));
+		handle.id = 0;
+
+		return;
+	}
+
+	void EndFrame(ID3D11DeviceContext*);
+
+	int GetResourceCount();
+	int GetPendingCount();
+	int GetStaleLookupCount();
+	unsigned long long GetResourceBytes();
+
+private:
+	unsigned int RegisterResource(ID3D11DeviceChild*, ResourceType);
+	ID3D11DeviceChild* GetResource(unsigned int, ResourceType, bool);
+	void ReleaseResource(unsigned int, ResourceType);
+	void RetireFrames(ID3D11DeviceContext*, bool);
+	static unsigned int GetSize(ID3D11DeviceChild*, ResourceType);
+	static unsigned int GetTexelBits(DXGI_FORMAT);
+
+	vector<SlotType> m_slots[RESOURCE_TYPE_COUNT];
+	vector<unsigned int> m_freeSlots[RESOURCE_TYPE_COUNT];
+	int m_resourceCount;
+	int m_staleLookups;
+	unsigned long long m_resourceBytes;
+
+	deque<PendingType> m_pending;
+	FrameFenceType m_fences[RESOURCE_REGISTRY_FRAMES];
+	int m_oldestFence, m_fenceCount;
+	unsigned long long m_frame, m_completedFrame;
+	bool m_fenced;
+};
+
+#endif
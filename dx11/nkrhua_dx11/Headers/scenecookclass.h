@@ -0,0 +1,18 @@
+#ifndef _SCENECOOKCLASS_H_
+#define _SCENECOOKCLASS_H_
+
+//	Includes:
+#include "scenepackageclass.h"
+#include "modelclass.h"
+
+//	The SceneCookClass writes the built in scene as a Scene Package: one material, the triangle of the model as
+//	the only mesh with the box around its positions, an object for the triangle at the origin and one for every
+//	character in its place.
+class SceneCookClass
+{
+public:
+//	Cook takes the file to write, the model and where every character stands.
+	static bool Cook(const char*, ModelClass*, const XMFLOAT3*, int);
+};
+
+#endif
@@ -0,0 +1,134 @@
+#ifndef _SCENEPACKAGECLASS_H_
+#define _SCENEPACKAGECLASS_H_
+
+//	Includes:
+#include <directxmath.h>
+#include <string.h>
+#include <vector>
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	Every section starts on a multiple of this many bytes from the start of the package, which is at least
+//	as much as any of the types in it need, so the mapped file can be read in place.
+const unsigned int SCENE_PACKAGE_ALIGNMENT = 64;
+
+//	The version changes with the layout or the hash, so packages written before are cooked again.
+const unsigned int SCENE_PACKAGE_VERSION = 2;
+
+//	The sections of a package, in the order they are written. A package has every one of them, empty or not.
+enum ScenePackageSection
+{
+	SCENE_SECTION_OBJECTS,
+	SCENE_SECTION_MATERIALS,
+	SCENE_SECTION_MESHES,
+	SCENE_SECTION_STRINGS,
+	SCENE_SECTION_COUNT
+};
+
+//	What an object of the scene is: an instance of one of the meshes of the package, or one of the animated
+//	characters, which are numbered by the animation system rather than the package.
+enum SceneObjectKind
+{
+	SCENE_OBJECT_MESH,
+	SCENE_OBJECT_CHARACTER
+};
+
+//	The ScenePackageClass opens a cooked scene by mapping the file into memory and hands out pointers
+//	straight into it, so there is nothing to parse and nothing allocated per object however large the scene.
+//	Nothing in a package is a pointer: sections are found through the table of contents after the header by
+//	their offset from the start of the file, objects refer to meshes and materials by their index, and names
+//	are offsets into the string section. The file can therefore be mapped anywhere and used as it is. The
+//	header holds a hash of everything after it, which Initialize checks when asked to, and the table of
+//	contents is always checked against the size of the file.
+//
+//	Meshes are references: a name for the engine to find the mesh by, and the local box around it so the
+//	bounds of the objects using it are known without touching the geometry. WritePackage is the cooker, it
+//	lays out a package from a SceneDescType built in memory.
+class ScenePackageClass
+{
+public:
+	struct HeaderType
+	{
+		char magic[4];
+		unsigned int version;
+		unsigned long long fileSize;
+		unsigned long long hash;
+		unsigned int sectionCount;
+		unsigned int padding;
+	};
+
+	struct SectionType
+	{
+		unsigned int type;
+		unsigned int count;
+		unsigned long long offset;
+		unsigned long long size;
+	};
+
+	struct ObjectType
+	{
+		XMFLOAT3 position;
+		float scale;
+		int kind;
+		int index;
+		int material;
+		unsigned int name;
+	};
+
+	struct MaterialType
+	{
+		XMFLOAT4 color;
+		unsigned int name;
+		unsigned int padding[3];
+	};
+
+	struct MeshType
+	{
+		XMFLOAT3 minimum;
+		unsigned int name;
+		XMFLOAT3 maximum;
+		unsigned int padding;
+	};
+
+//	A scene as the cooker is given it. Names are added with AddString, which returns their offset.
+	struct SceneDescType
+	{
+		vector<ObjectType> objects;
+		vector<MaterialType> materials;
+		vector<MeshType> meshes;
+		vector<char> strings;
+	};
+
+public:
+	ScenePackageClass();
+	ScenePackageClass(const ScenePackageClass&);
+	~ScenePackageClass();
+
+//	Initialize maps the package and checks its table of contents, and its hash if the second argument is
+//	true. The pointers the package hands out are good until Shutdown.
+	bool Initialize(const char*, bool);
+	void Shutdown();
+
+	int GetObjectCount();
+	const ObjectType* GetObjects();
+	int GetMaterialCount();
+	const MaterialType* GetMaterials();
+	int GetMeshCount();
+	const MeshType* GetMeshes();
+	const char* GetString(unsigned int);
+	unsigned long long GetSize();
+
+	static unsigned int AddString(SceneDescType&, const char*);
+	static bool WritePackage(const char*, const SceneDescType&);
+
+private:
+	bool CheckContents();
+	static unsigned long long HashBytes(const void*, unsigned long long);
+
+	const unsigned char* m_view;
+	unsigned long long m_size;
+	const SectionType* m_sections;
+};
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef _SCENESYSTEMSCLASS_H_
+#define _SCENESYSTEMSCLASS_H_
+
+//	Includes:
+#include <directxmath.h>
+#include "entityworldclass.h"
+#include "bvhclass.h"
+//	Namespaces:
+using namespace DirectX;
+
+//	The components of the entities of the scene. The world matrix of a transform is made from its position
+//	and scale by the transform system. A renderable is either a mesh of the Geometry Heap or a character,
+//	and object is its index in the scene BVH and among the shadow casters. A batched mesh is drawn by the
+//	Static Batch, and only as a shadow caster on its own. The bounds system moves the local box of the
+//	entity, which it takes from the pose for a character, into the world.
+enum RenderableKind
+{
+	RENDERABLE_MESH,
+	RENDERABLE_CHARACTER,
+	RENDERABLE_BATCHED
+};
+
+struct TransformType
+{
+	XMFLOAT3 position;
+	float scale;
+	XMFLOAT4X4 world;
+};
+
+struct RenderableType
+{
+	int kind;
+	int index;
+	int object;
+};
+
+struct EntityBoundsType
+{
+	XMFLOAT3 localMinimum, localMaximum;
+	BVHClass::BoundsType world;
+};
+
+//	The SceneSystemsClass registers the three components with an Entity World and adds the two systems that
+//	run over them. The transform system makes the world matrices, and the bounds system, which reads them,
+//	takes the local box of every character from its pose and moves every local box into the world. Every
+//	world it is initialized for registers the components in the same order, so their numbers are the same
+//	in all of them. The local box of a character comes from whoever owns the poses, through the function given
+//	to Initialize, so the systems need nothing of the model or the animation themselves.
+class SceneSystemsClass
+{
+public:
+//	CharacterBoundsFunction takes the index of a character and fills in the minimum and maximum of its box.
+	typedef function<void(int, XMFLOAT3&, XMFLOAT3&)> CharacterBoundsFunction;
+
+	SceneSystemsClass();
+	SceneSystemsClass(const SceneSystemsClass&);
+	~SceneSystemsClass();
+
+	void Initialize(EntityWorldClass*, CharacterBoundsFunction);
+
+	int GetTransformComponent();
+	int GetRenderableComponent();
+	int GetBoundsComponent();
+	unsigned int GetMask();
+
+	static void UpdateWorldMatrix(TransformType&);
+	static void UpdateWorldBounds(const TransformType&, EntityBoundsType&);
+	void UpdateBounds(const TransformType&, const RenderableType&, EntityBoundsType&);
+
+private:
+	int m_transformComponent, m_renderableComponent, m_boundsComponent;
+	CharacterBoundsFunction m_characterBounds;
+};
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef _SHADERMANAGERCLASS_H_
+#define _SHADERMANAGERCLASS_H_
+
+#pragma comment(lib, "dxguid.lib")
+
+//	Includes:
+#include <d3d11.h>
+#include <d3dcompiler.h>
+#include <d3d11shader.h>
+#include <fstream>
+#include <string.h>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <mutex>
+#include "vertexformatclass.h"
+#include "commandcaptureclass.h"
+//	Namespaces:
+using namespace std;
+
+//	Each bit of a permutation turns on one define when the shader files are compiled. A shader family
+//	compiles every combination of the bits it supports, so with four bits there are sixteen permutations.
+const unsigned int SHADER_INSTANCED = 1;
+const unsigned int SHADER_QUANTIZED = 2;
+const unsigned int SHADER_TEXTURED = 4;
+const unsigned int SHADER_LIT = 8;
+const unsigned int SHADER_PERMUTATION_BITS = 4;
+const unsigned int SHADER_PERMUTATION_COUNT = 1 << SHADER_PERMUTATION_BITS;
+
+//	Input elements whose semantic starts with this prefix are fed from the per-instance vertex buffer in slot 1.
+const char SHADER_INSTANCE_SEMANTIC[] = "INSTANCE";
+
+//	A vertex format a shader family is fed from, and the permutation flags it is for. Every permutation uses
+//	the format whose flags are its own flags without the ones none of the formats name, so a family with
+//	formats for 0 and QUANTIZED feeds every QUANTIZED permutation from the second format and every other
+//	permutation from the first.
+struct ShaderInputType
+{
+	unsigned int flags;
+	const VertexFormatType* format;
+};
+
+class ShaderManagerClass
+{
+public:
+//	A permutation is what gets bound at draw time: the shader objects and the input layout that was built
+//	from its vertex format and the vertex shader's reflection. The objects are shared with every other
+//	permutation that compiled to the same bytecode or needed the same layout, so they are owned by the
+//	manager and not released here.
+	struct ShaderPermutationType
+	{
+		ID3D11VertexShader* vertexShader;
+		ID3D11PixelShader* pixelShader;
+		ID3D11InputLayout* layout;
+	};
+
+private:
+	struct ShaderFamilyType
+	{
+		unsigned int supportedFlags;
+		ShaderPermutationType* permutations[SHADER_PERMUTATION_COUNT];
+	};
+
+//	The dedupe tables are keyed by a hash of the bytecode or of the layout description. The key data is
+//	kept next to the object so a hash collision can never hand out the wrong object.
+	struct SharedObjectType
+	{
+		vector<unsigned char> key;
+		IUnknown* object;
+	};
+
+	typedef unordered_multimap<unsigned long long, SharedObjectType> SharedTableType;
+
+public:
+	ShaderManagerClass();
+	ShaderManagerClass(const ShaderManagerClass&);
+	~ShaderManagerClass();
+
+	bool Initialize(ID3D11Device*, HWND);
+	void Shutdown();
+
+//	Precompile compiles every permutation of a vertex and pixel shader pair ahead of AddShader, which then
+//	takes the bytecode from here instead of compiling it again. It needs no device, so it can run before
+//	Initialize and on any thread, alongside other calls to it and to AddShader. A permutation that fails is
+//	left out and reported when AddShader compiles it.
+	void Precompile(WCHAR*, const char*, WCHAR*, const char*, unsigned int);
+
+	int AddShader(WCHAR*, const char*, WCHAR*, const char*, unsigned int, const ShaderInputType*, int, const VertexFormatType*);
+	ShaderPermutationType* GetPermutation(int, unsigned int);
+
+	bool SetShader(ID3D11DeviceContext*, int, unsigned int);
+
+	int GetUniqueShaderCount();
+	int GetUniqueLayoutCount();
+
+private:
+	bool CompileShader(WCHAR*, const char*, const char*, unsigned int, ID3D10Blob**);
+	HRESULT CompileShaderFile(WCHAR*, const char*, const char*, unsigned int, ID3D10Blob**, ID3D10Blob**);
+	void PrecompileShader(WCHAR*, const char*, const char*, unsigned int);
+	wstring GetCompileKey(WCHAR*, const char*, const char*, unsigned int);
+	bool BuildInputLayout(ID3D10Blob*, const VertexFormatType*, const VertexFormatType*, WCHAR*, ID3D11InputLayout**);
+	int FindElement(const VertexFormatType*, const D3D11_SIGNATURE_PARAMETER_DESC&);
+	void OutputShaderErrorMessage(ID3D10Blob*, WCHAR*);
+	void OutputLayoutErrorMessage(const D3D11_SIGNATURE_PARAMETER_DESC&, const VertexFormatType*, WCHAR*);
+
+	IUnknown* FindShared(SharedTableType&, unsigned long long, const void*, unsigned long long);
+	void AddShared(SharedTableType&, unsigned long long, const void*, unsigned long long, IUnknown*);
+	void ReleaseShared(SharedTableType&);
+	unsigned long long HashBytes(const void*, unsigned long long);
+
+	ID3D11Device* m_device;
+	HWND m_hwnd;
+
+	vector<ShaderFamilyType> m_families;
+	SharedTableType m_vertexShaders;
+	SharedTableType m_pixelShaders;
+	SharedTableType m_layouts;
+
+//	The bytecode from Precompile, keyed by the file, entry point, target and flags it was compiled with. The
+//	first mutex guards it, the second keeps AddShader to one caller at a time.
+	unordered_map<wstring, ID3D10Blob*> m_precompiled;
+	mutex m_precompiledMutex;
+	mutex m_addMutex;
+};
+
+#endif
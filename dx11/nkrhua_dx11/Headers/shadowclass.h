@@ -0,0 +1,141 @@
+#ifndef _SHADOWCLASS_H_
+#define _SHADOWCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <directxmath.h>
+#include <vector>
+#include "jobsystemclass.h"
+#include "shadermanagerclass.h"
+#include "resourceregistryclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	The view frustum is split into this many cascades, each with its own slice of the shadow map array.
+//	It must match the size of the arrays in the ShadowBuffer of color.ps.
+const int SHADOW_CASCADE_COUNT = 4;
+
+//	How far the split distances lean from evenly spaced, at zero, towards the logarithmic spacing that
+//	gives every cascade the same texel density on screen, at one.
+const float SHADOW_SPLIT_LAMBDA = 0.8f;
+
+//	The shadow casters are tested four at a time, the boxes are stored in blocks of that size.
+const int SHADOW_CASTER_BLOCK = 4;
+
+//	The ShadowClass sets up cascaded shadow maps for one directional light. Update splits the view frustum
+//	between its near and far plane into cascades and fits an orthographic projection from the light around
+//	each. The projections are sized by the bounding sphere of their slice and moved in whole texels, so
+//	the shadow edges stay still while the camera turns and moves. Every cascade then culls the boxes of
+//	the shadow casters against the sides and far end of its projection with SIMD instructions, four boxes
+//	at a time, and sorts the casters it keeps into a render queue front to back from the light. The near
+//	end is pulled back to the closest caster kept, so casters between the light and the view still cast
+//	their shadows. None of this touches Direct3D, so with no device given to Initialize the CPU setup can
+//	be run and timed on its own. With a device, BeginCascade and RenderCaster draw the queues into the
+//	shadow map array and Render hands the array and the cascade matrices to the lit permutation of color.ps.
+class ShadowClass
+{
+private:
+//	This must match the ShadowBuffer in color.ps. The matrices take a view space position to the shadow
+//	map texture coordinates and depth of their cascade.
+	struct ShadowBufferType
+	{
+		XMMATRIX cascades[SHADOW_CASCADE_COUNT];
+		XMFLOAT4 splits;
+		XMFLOAT4 lightDirection;
+		XMFLOAT4 lightColor;
+	};
+
+//	This must match the ShadowBuffer in shadow.vs.
+	struct CasterBufferType
+	{
+		XMMATRIX worldViewProjection;
+	};
+
+	struct CasterBlockType
+	{
+		XMFLOAT4A minimumX, minimumY, minimumZ;
+		XMFLOAT4A maximumX, maximumY, maximumZ;
+	};
+
+	struct QueueEntryType
+	{
+		float depth;
+		int caster;
+	};
+
+//	The center and radius of the bounding sphere of a cascade are in light space, snapped to whole texels.
+	struct CascadeType
+	{
+		float nearZ, farZ;
+		XMFLOAT3 center;
+		float radius;
+		XMFLOAT4X4 lightViewProjection;
+		vector<QueueEntryType> queue;
+		vector<int> casters;
+	};
+
+public:
+	ShadowClass();
+	ShadowClass(const ShadowClass&);
+	~ShadowClass();
+
+	bool Initialize(ID3D11Device*, ResourceRegistryClass*, ShaderManagerClass*, int);
+	static void Precompile(ShaderManagerClass*);
+	void Shutdown();
+
+	void SetLight(XMFLOAT3, XMFLOAT3);
+
+	int AddCaster(XMFLOAT3, XMFLOAT3);
+	void SetCasterBounds(int, XMFLOAT3, XMFLOAT3);
+	int GetCasterCount();
+
+	void Update(JobSystemClass*, XMMATRIX, XMMATRIX);
+
+	int GetCascadeCount();
+	float GetSplitDistance(int);
+	XMMATRIX GetCascadeMatrix(int);
+	int GetQueueSize(int);
+	const int* GetQueue(int);
+
+//	The time in milliseconds the last Update took to fit the cascades and fill their queues.
+	float GetUpdateTime();
+
+	void BeginCascade(ID3D11DeviceContext*, int);
+	bool RenderCaster(ID3D11DeviceContext*, int, int, int, XMMATRIX);
+	bool Render(ID3D11DeviceContext*);
+
+private:
+	bool InitializeShadowMaps(ID3D11Device*);
+	bool InitializeShader(WCHAR*, WCHAR*);
+	void ShutdownShadowMaps();
+
+	void FitCascade(int, XMMATRIX);
+	void CullCascade(int);
+
+	int m_mapSize;
+	XMFLOAT3 m_lightDirection, m_lightColor;
+	float m_nearZ, m_farZ;
+	float m_projectionX, m_projectionY;
+
+	vector<CasterBlockType> m_casterBlocks;
+	int m_casterCount;
+	CascadeType m_cascades[SHADOW_CASCADE_COUNT];
+	XMFLOAT4X4 m_viewMatrix, m_lightView;
+	int m_currentCascade;
+
+	ResourceRegistryClass* m_ResourceRegistry;
+	TextureHandle m_shadowMapArray;
+	DepthStencilViewHandle m_depthStencilViews[SHADOW_CASCADE_COUNT];
+	ShaderResourceHandle m_shaderResourceView;
+	SamplerStateHandle m_sampleState;
+	RasterizerStateHandle m_rasterState;
+	BufferHandle m_shadowBuffer;
+	BufferHandle m_casterBuffer;
+	ShaderManagerClass* m_ShaderManager;
+	int m_shaderFamily;
+
+	float m_updateTime;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef _SKELETONCLASS_H_
+#define _SKELETONCLASS_H_
+
+//	Includes:
+#include <directxmath.h>
+#include <vector>
+#include "batchmathclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	The largest skeleton we animate. Poses are worked on in arrays of this size on the stack, so no
+//	memory is allocated per character while animating.
+const int SKELETON_MAX_JOINTS = 128;
+
+//	The SkeletonClass holds the joint hierarchy and the bind pose that skinned meshes were modelled in.
+//	Joints are stored so that every parent comes before its children, which lets the model space pose
+//	be computed in one pass from the root down.
+//
+//	Poses are passed around as one rotation quaternion and one translation per joint. The skinning
+//	palette maps a vertex from the bind pose to the animated pose: inverse bind matrix, then the joint's
+//	model space matrix, using DirectXMath's row vector convention.
+class SkeletonClass
+{
+public:
+	SkeletonClass();
+	SkeletonClass(const SkeletonClass&);
+	~SkeletonClass();
+
+	bool Initialize(int, const int*, const XMFLOAT4*, const XMFLOAT3*);
+	void Shutdown();
+
+	int GetJointCount();
+	void GetBindPose(XMVECTOR*, XMVECTOR*);
+	void ComputeSkinningPalette(const XMVECTOR*, const XMVECTOR*, XMFLOAT4X4*);
+
+private:
+	int m_jointCount;
+	vector<int> m_parents;
+	vector<XMFLOAT4> m_bindRotations;
+	vector<XMFLOAT3> m_bindTranslations;
+	vector<XMFLOAT4X4> m_inverseBindMatrices;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef _SKINNEDMODELCLASS_H_
+#define _SKINNEDMODELCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <directxmath.h>
+#include <vector>
+#include "skeletonclass.h"
+#include "animationclipclass.h"
+#include "geometrystreamclass.h"
+#include "vertexformatclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	The number of joints in the generated model and the clips it comes with.
+const int SKINNED_MODEL_JOINTS = 6;
+const int SKINNED_MODEL_CLIPS = 2;
+
+//	The SkinnedModelClass is the animated counterpart of the ModelClass. Like the ModelClass it builds its
+//	geometry in code, here a tube standing on a chain of joints, along with the skeleton and two looping
+//	clips to play on it. The bind pose vertices stay on the CPU: Skin deforms them with a character's
+//	skinning palette and writes the result into the Geometry Stream, so every character gets its own
+//	vertices for the frame while all of them share one static index buffer.
+class SkinnedModelClass
+{
+private:
+//	The skinned vertices have the format of the ModelClass vertices, so the color shader draws them as is.
+	typedef ColorVertexType VertexType;
+
+//	Every bind pose vertex is influenced by up to four joints. The weights add up to one and are sorted
+//	from largest to smallest, so skinning can stop at the first zero weight.
+	struct SkinnedVertexType
+	{
+		XMFLOAT3 position;
+		XMFLOAT4 color;
+		int joints[4];
+		float weights[4];
+	};
+
+public:
+	SkinnedModelClass();
+	SkinnedModelClass(const SkinnedModelClass&);
+	~SkinnedModelClass();
+
+	bool Initialize(ID3D11Device*);
+	void Shutdown();
+
+	bool Skin(const XMFLOAT4X4*, GeometryStreamClass*, unsigned int&);
+	void Render(ID3D11DeviceContext*, GeometryStreamClass*, unsigned int);
+	void GetBounds(const XMFLOAT4X4*, XMFLOAT3&, XMFLOAT3&);
+
+	int GetIndexCount();
+	SkeletonClass* GetSkeleton();
+	AnimationClipClass* GetClip(int);
+
+private:
+	bool InitializeSkeleton();
+	bool InitializeClips();
+	bool InitializeBuffers(ID3D11Device*);
+	void ShutdownBuffers();
+
+	SkeletonClass m_Skeleton;
+	AnimationClipClass m_Clips[SKINNED_MODEL_CLIPS];
+
+	vector<SkinnedVertexType> m_vertices;
+	XMFLOAT3 m_jointMinimum[SKINNED_MODEL_JOINTS], m_jointMaximum[SKINNED_MODEL_JOINTS];
+	ID3D11Buffer* m_indexBuffer;
+	int m_indexCount;
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef _SPRITEBATCHCLASS_H_
+#define _SPRITEBATCHCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <directxmath.h>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include "resourceregistryclass.h"
+#include "shadermanagerclass.h"
+#include "vertexformatclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	The sort key of a sprite is its layer in the high 16 bits and its texture in the low 16 bits, so there can
+//	be this many of each.
+const int SPRITE_MAX_TEXTURES = 65536;
+const int SPRITE_MAX_LAYERS = 65536;
+
+//	The SpriteBatchClass draws the 2D sprites of a frame over whatever is on the render target. Draw may be
+//	called from any number of threads at once: every thread writes into a buffer of its own, which it finds
+//	through a thread local cache, so submitting takes no lock. Flush merges the buffers, sorts the sprites by
+//	layer and then texture with a radix sort, packs them four at a time into instances and draws every run of
+//	sprites with the same texture with one instanced draw of a four vertex strip. Lower layers are drawn first,
+//	and sprites with the same key keep the order their thread drew them in. Flush must not run while a thread
+//	is still drawing, and textures are added before the first sprite is drawn.
+class SpriteBatchClass
+{
+private:
+//	The rectangle is the top left corner and the size in pixels, the texture rectangle is in texture coordinates.
+	struct SpriteType
+	{
+		XMFLOAT4 rectangle;
+		XMFLOAT4 texRectangle;
+		float rotation;
+		PackedVector::XMUBYTEN4 color;
+		unsigned int key;
+	};
+
+	struct ThreadBufferType
+	{
+		thread::id owner;
+		vector<SpriteType> sprites;
+	};
+
+	struct SpriteBufferType
+	{
+		XMMATRIX ortho;
+	};
+
+public:
+	SpriteBatchClass();
+	SpriteBatchClass(const SpriteBatchClass&);
+	~SpriteBatchClass();
+
+	static void Precompile(ShaderManagerClass*);
+
+//	Initialize takes the most sprites a frame draws and the size of the screen.
+	bool Initialize(ID3D11Device*, ResourceRegistryClass*, ShaderManagerClass*, int, int, int);
+	void Shutdown();
+
+//	AddTexture creates a texture from RGBA pixels, a row after another, and returns its index or -1.
+	int AddTexture(ID3D11Device*, const unsigned int*, int, int);
+
+//	Draw adds a sprite with a texture on a layer. The rectangle is the top left corner and the size in pixels,
+//	the texture rectangle the left, top, right and bottom texture coordinates, and the rotation turns the
+//	sprite clockwise around its center, in radians. It returns false for a texture that doesn't exist.
+	bool Draw(int, int, XMFLOAT4, XMFLOAT4, float, XMFLOAT4);
+	void Clear();
+	bool Flush(ID3D11DeviceContext*, XMMATRIX);
+
+	int GetSpriteCount();
+	int GetDrawCount();
+	int GetDroppedCount();
+	int GetThreadBufferCount();
+
+private:
+	bool InitializeShader(WCHAR*, WCHAR*);
+	bool InitializeBuffers(ID3D11Device*);
+	ThreadBufferType* GetThreadBuffer();
+	int MergeThreadBuffers();
+	void SortSprites(int);
+	void PackInstances(SpriteInstanceType*, int);
+
+	unsigned int m_id;
+	int m_maxSprites;
+	float m_halfWidth, m_halfHeight;
+
+	mutex m_bufferMutex;
+	vector<ThreadBufferType*> m_threadBuffers;
+
+	vector<SpriteType> m_sprites;
+	vector<unsigned int> m_keys, m_indices, m_sortKeys, m_sortIndices;
+	int m_spriteCount, m_drawCount, m_droppedCount;
+
+	ResourceRegistryClass* m_ResourceRegistry;
+	vector<TextureHandle> m_textures;
+	vector<ShaderResourceHandle> m_shaderResourceViews;
+	BufferHandle m_instanceBuffer, m_spriteBuffer;
+	SamplerStateHandle m_sampleState;
+	ShaderManagerClass* m_ShaderManager;
+	int m_shaderFamily;
+};
+
+#endif
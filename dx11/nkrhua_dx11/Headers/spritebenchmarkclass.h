@@ -0,0 +1,22 @@
+#ifndef _SPRITEBENCHMARKCLASS_H_
+#define _SPRITEBENCHMARKCLASS_H_
+
+//	Includes:
+#include <functional>
+#include "d3dclass.h"
+#include "spritebatchclass.h"
+//	Namespaces:
+using namespace std;
+
+//	The SpriteBenchmarkClass draws sprites into a Sprite Batch and flushes them a few times, and appends the
+//	fastest of both to a report along with how many sprites would fit into a frame at 60 Hz at that rate. The
+//	flush is timed until the device context has handed the draws to the driver.
+class SpriteBenchmarkClass
+{
+public:
+//	Run takes the number of sprites, the report to append to, and the function that draws that many sprites
+//	at a time in seconds the way the frames do.
+	static bool Run(D3DClass*, SpriteBatchClass*, int, const char*, const function<void(int, float)>&);
+};
+
+#endif
@@ -0,0 +1,28 @@
+#ifndef _STATICBATCHBENCHMARKCLASS_H_
+#define _STATICBATCHBENCHMARKCLASS_H_
+
+//	Includes:
+#include <functional>
+#include "d3dclass.h"
+#include "staticbatchclass.h"
+#include "geometryheapclass.h"
+#include "modelclass.h"
+#include "colorshaderclass.h"
+//	Namespaces:
+using namespace std;
+
+//	The StaticBatchBenchmarkClass scatters copies of the model, turned and scaled, over a field in front of
+//	the camera that is wider than the view, with 16 materials between them. It draws them one by one from the
+//	Geometry Heap the way the scene draws entities, which culls nothing, and from a Static Batch of their own,
+//	and appends the draw counts and the fastest of four submits of each to a report. The timings are of the
+//	CPU only: recording the draws and flushing them to the driver.
+class StaticBatchBenchmarkClass
+{
+public:
+//	Run takes the view matrix to draw with, the number of objects, the report to append to, and the function
+//	the scene culls and draws a Static Batch with for a view and projection.
+	static bool Run(D3DClass*, ColorShaderClass*, GeometryHeapClass*, ModelClass*, XMMATRIX, int, const char*,
+		const function<bool(StaticBatchClass*, XMMATRIX, XMMATRIX)>&);
+};
+
+#endif
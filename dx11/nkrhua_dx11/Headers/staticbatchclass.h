@@ -0,0 +1,120 @@
+#ifndef _STATICBATCHCLASS_H_
+#define _STATICBATCHCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <directxmath.h>
+#include <vector>
+#include "vertexformatclass.h"
+#include "resourceregistryclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	The most indices a range of a batch holds. A range is the smallest part of a batch that is culled on its
+//	own, so this trades how many boxes are tested a frame against how much is drawn outside the view.
+const int STATIC_BATCH_RANGE_INDICES = 3 * 1024;
+
+//	The StaticBatchClass merges the static meshes of the scene into a few large draws. Every instance of a
+//	mesh is added with its world matrix and its material, and Build transforms the vertices of each into the
+//	world and appends them, with their indices, to the batch of its material in one immutable vertex buffer
+//	and one immutable index buffer. All instances are drawn by the Color Shader, so the material is all that
+//	can tell batches apart, and the batches are drawn with an identity world matrix.
+//
+//	Within a batch the instances are put in the order of a Morton code of where they are, so instances that
+//	are close in the world are close in the buffers, and cut into ranges of up to STATIC_BATCH_RANGE_INDICES
+//	indices. Batches and ranges both keep the box around their vertices. Cull tests a batch against the view
+//	frustum first: a batch outside is dropped, a batch inside is one draw, and only for a batch crossing an
+//	edge are its ranges tested, the visible ranges that follow each other in the index buffer being merged
+//	into one draw.
+class StaticBatchClass
+{
+public:
+	typedef ColorVertexType VertexType;
+
+//	A draw Cull leaves, drawn with the start index and base vertex after Render has bound the buffers.
+	struct DrawType
+	{
+		int material;
+		int indexCount;
+		int startIndex;
+		int baseVertex;
+	};
+
+private:
+	struct MeshType
+	{
+		int firstVertex, vertexCount;
+		int firstIndex, indexCount;
+	};
+
+	struct InstanceType
+	{
+		int mesh;
+		int material;
+		XMFLOAT4X4 world;
+		unsigned int order;
+	};
+
+	struct RangeType
+	{
+		int startIndex, indexCount;
+		XMFLOAT3 minimum, maximum;
+	};
+
+	struct BatchType
+	{
+		int material;
+		int baseVertex;
+		int firstRange, rangeCount;
+		XMFLOAT3 minimum, maximum;
+	};
+
+public:
+	StaticBatchClass();
+	StaticBatchClass(const StaticBatchClass&);
+	~StaticBatchClass();
+
+//	AddMesh keeps a copy of the mesh until Build and returns its id for AddInstance.
+	int AddMesh(const VertexType*, int, const unsigned long*, int);
+	void AddInstance(int, int, XMMATRIX);
+
+//	Build merges everything added into the batches and creates the buffers, after which the copies of the
+//	meshes are let go and nothing more can be added.
+	bool Build(ID3D11Device*, ResourceRegistryClass*);
+	void Shutdown();
+
+	int Cull(XMMATRIX, XMMATRIX);
+	void Render(ID3D11DeviceContext*);
+
+	int GetDrawCount();
+	const DrawType* GetDraws();
+
+	int GetInstanceCount();
+	int GetBatchCount();
+	int GetRangeCount();
+	int GetVisibleRangeCount();
+	int GetVertexCount();
+	int GetIndexCount();
+
+private:
+	int TestBox(const XMVECTOR*, const XMFLOAT3&, const XMFLOAT3&);
+	void AddDraw(const BatchType&, int, int);
+
+	vector<VertexType> m_meshVertices;
+	vector<unsigned long> m_meshIndices;
+	vector<MeshType> m_meshes;
+	vector<InstanceType> m_instances;
+	int m_instanceCount;
+
+	vector<BatchType> m_batches;
+	vector<RangeType> m_ranges;
+	vector<DrawType> m_draws;
+	int m_visibleRangeCount;
+	int m_vertexCount, m_indexCount;
+
+	ResourceRegistryClass* m_ResourceRegistry;
+	BufferHandle m_vertexBuffer, m_indexBuffer;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef _STATSCONTEXTCLASS_H_
+#define _STATSCONTEXTCLASS_H_
+
+//	Includes:
+#include "devicecontextproxyclass.h"
+#include "renderstatsclass.h"
+
+//	The StatsContextClass counts what is sent to the device context into a RenderStatsClass: draws and the
+//	primitives they make, binds of state, maps and unmaps, and the bytes sent to the video card. A buffer
+//	mapped with WRITE_DISCARD counts all of its bytes, since the driver hands out a fresh copy of all of it,
+//	while a map that doesn't discard counts none, and whoever writes through it adds what it wrote itself.
+//	Only the calls the engine makes are counted, every other one goes straight through the proxy.
+class StatsContextClass : public DeviceContextProxyClass
+{
+public:
+	StatsContextClass();
+	StatsContextClass(const StatsContextClass&);
+	~StatsContextClass();
+
+	void Initialize(ID3D11DeviceContext*, RenderStatsClass*);
+	void Shutdown();
+
+	void STDMETHODCALLTYPE IASetInputLayout(ID3D11InputLayout*);
+	void STDMETHODCALLTYPE IASetVertexBuffers(UINT, UINT, ID3D11Buffer* const*, const UINT*, const UINT*);
+	void STDMETHODCALLTYPE IASetIndexBuffer(ID3D11Buffer*, DXGI_FORMAT, UINT);
+	void STDMETHODCALLTYPE IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY);
+	void STDMETHODCALLTYPE VSSetShader(ID3D11VertexShader*, ID3D11ClassInstance* const*, UINT);
+	void STDMETHODCALLTYPE VSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*);
+	void STDMETHODCALLTYPE VSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*);
+	void STDMETHODCALLTYPE VSSetSamplers(UINT, UINT, ID3D11SamplerState* const*);
+	void STDMETHODCALLTYPE PSSetShader(ID3D11PixelShader*, ID3D11ClassInstance* const*, UINT);
+	void STDMETHODCALLTYPE PSSetConstantBuffers(UINT, UINT, ID3D11Buffer* const*);
+	void STDMETHODCALLTYPE PSSetShaderResources(UINT, UINT, ID3D11ShaderResourceView* const*);
+	void STDMETHODCALLTYPE PSSetSamplers(UINT, UINT, ID3D11SamplerState* const*);
+	void STDMETHODCALLTYPE OMSetRenderTargets(UINT, ID3D11RenderTargetView* const*, ID3D11DepthStencilView*);
+	void STDMETHODCALLTYPE OMSetBlendState(ID3D11BlendState*, const FLOAT[4], UINT);
+	void STDMETHODCALLTYPE OMSetDepthStencilState(ID3D11DepthStencilState*, UINT);
+	void STDMETHODCALLTYPE RSSetState(ID3D11RasterizerState*);
+	void STDMETHODCALLTYPE RSSetViewports(UINT, const D3D11_VIEWPORT*);
+	HRESULT STDMETHODCALLTYPE Map(ID3D11Resource*, UINT, D3D11_MAP, UINT, D3D11_MAPPED_SUBRESOURCE*);
+	void STDMETHODCALLTYPE Unmap(ID3D11Resource*, UINT);
+	void STDMETHODCALLTYPE UpdateSubresource(ID3D11Resource*, UINT, const D3D11_BOX*, const void*, UINT, UINT);
+	void STDMETHODCALLTYPE Draw(UINT, UINT);
+	void STDMETHODCALLTYPE DrawIndexed(UINT, UINT, INT);
+	void STDMETHODCALLTYPE DrawInstanced(UINT, UINT, UINT, UINT);
+	void STDMETHODCALLTYPE DrawIndexedInstanced(UINT, UINT, UINT, INT, UINT);
+
+private:
+	void CountDraw(UINT, UINT);
+
+	RenderStatsClass* m_RenderStats;
+	D3D11_PRIMITIVE_TOPOLOGY m_topology;
+};
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef _TASKGRAPHCLASS_H_
+#define _TASKGRAPHCLASS_H_
+
+//	Includes:
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <deque>
+#include <vector>
+//	Namespaces:
+using namespace std;
+
+//	The TaskGraphClass runs a set of tasks that depend on each other, each one as soon as every task it
+//	depends on has finished, on as many threads as there is work for. It is what the application starts
+//	up with. A task is either run by any of the worker threads or only by the thread that called Run, for
+//	the work that has to stay on one thread: anything with the window, the immediate context, or the other
+//	classes that are only meant to be called from one thread at a time. The main thread tasks run one after
+//	another in the order they became ready.
+//
+//	Every task is timed from the start of Run, and WriteTimeline writes when each one ran and on which
+//	thread, and the chain of tasks that the whole startup had to wait for, which is the one to shorten.
+//	A task that fails stops everything that was not started yet, and Run returns false with the error of
+//	that task.
+class TaskGraphClass
+{
+private:
+	struct TaskType
+	{
+		const char* name;
+		const wchar_t* error;
+		function<bool()> work;
+		bool mainThread;
+		vector<int> dependencies;
+		vector<int> dependents;
+		int waitingCount;
+		int thread;
+		float startTime, endTime;
+		bool finished;
+	};
+
+public:
+	TaskGraphClass();
+	TaskGraphClass(const TaskGraphClass&);
+	~TaskGraphClass();
+
+//	A thread count of 0 uses one worker less than the machine has cores, since the calling thread works too.
+	bool Initialize(int);
+	void Shutdown();
+
+//	AddTask returns the index of the new task. A task can only depend on tasks added before it, so the
+//	graph can never wait on itself, and AddDependency returns false for anything else.
+	int AddTask(const char*, const wchar_t*, bool, const function<bool()>&);
+	bool AddDependency(int, int);
+
+	bool Run();
+
+	const wchar_t* GetError();
+	int GetThreadCount();
+	float GetTotalTime();
+	bool WriteTimeline(const char*);
+	static bool WriteFirstFrame(const char*, float);
+
+private:
+	void RunTasks(bool, int);
+	float GetElapsedTime();
+
+	vector<TaskType> m_tasks;
+	mutex m_mutex;
+	condition_variable m_condition;
+	deque<int> m_mainQueue, m_workerQueue;
+	chrono::high_resolution_clock::time_point m_startTime;
+	int m_threadCount;
+	int m_runningCount;
+	int m_failedTask;
+	float m_totalTime;
+};
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef _TERRAINCLASS_H_
+#define _TERRAINCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <directxmath.h>
+#include <stdio.h>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "jobsystemclass.h"
+#include "terrainshaderclass.h"
+#include "vertexformatclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	Every chunk is a grid of TERRAIN_CHUNK_SIZE by TERRAIN_CHUNK_SIZE quads, whatever its level, so all
+//	chunks share one index buffer. A chunk of level l covers 2^l times the ground of a chunk of level 0.
+const int TERRAIN_CHUNK_SIZE = 64;
+const int TERRAIN_CHUNK_VERTICES = TERRAIN_CHUNK_SIZE + 1;
+const int TERRAIN_MAX_LEVELS = 16;
+
+//	The number of chunks that can be on the video card at once. Their vertex buffers are all created up
+//	front and reused, so the terrain takes the same memory however large the heightmap is.
+const int TERRAIN_CACHE_SIZE = 256;
+
+//	The most chunks waiting for the loader thread, and the most loaded chunks copied to the video card
+//	in one frame, which keeps the cost of streaming the same from frame to frame.
+const int TERRAIN_MAX_PENDING = 32;
+const int TERRAIN_UPLOADS_PER_FRAME = 8;
+
+//	The top levels are loaded by Initialize and never evicted, so there is always something to draw.
+const int TERRAIN_PINNED_LEVELS = 2;
+
+//	The TerrainClass draws a heightmap far larger than fits on the video card. The heightmap is stored in
+//	a tiled file as a pyramid of levels, each level having half the resolution of the one below, cut into
+//	tiles of the chunk size. The tiles form a quadtree: every frame Frame walks down from the coarsest
+//	level and splits a chunk into its four children while its geometric error, projected to the screen,
+//	is more than the threshold in pixels. Children that are not on the video card yet are requested from
+//	the loader thread and their parent is drawn until all of them have arrived. Chunks not drawn for the
+//	longest time make room for new ones. terrain.vs morphs every chunk towards the shape of its parent as
+//	it gets close to being replaced by it, so levels change without popping.
+class TerrainClass
+{
+private:
+//	The vertex format terrain.vs reads, declared with the other vertex formats.
+	typedef TerrainVertexType VertexType;
+
+//	The start of the terrain file. It is followed by the height bounds of every tile, level by level and
+//	row by row, and then by the heights of every tile in the same order.
+	struct FileHeaderType
+	{
+		char magic[4];
+		int size;
+		int levelCount;
+		float spacing;
+		float baseHeight;
+		float heightScale;
+		float levelErrors[TERRAIN_MAX_LEVELS];
+	};
+
+	struct TileBoundsType
+	{
+		unsigned short minimum, maximum;
+	};
+
+	enum ChunkStateType
+	{
+		CHUNK_FREE,
+		CHUNK_LOADING,
+		CHUNK_READY
+	};
+
+	struct ChunkType
+	{
+		int level, x, z;
+		ChunkStateType state;
+		unsigned int lastUsedFrame;
+		bool pinned;
+		ID3D11Buffer* vertexBuffer;
+		vector<unsigned short> heights;
+	};
+
+public:
+	TerrainClass();
+	TerrainClass(const TerrainClass&);
+	~TerrainClass();
+
+	bool Initialize(ID3D11Device*, ID3D11DeviceContext*, JobSystemClass*, const char*, int, int, float);
+	void Shutdown();
+
+	void Frame(ID3D11DeviceContext*, XMFLOAT3, XMMATRIX, XMMATRIX);
+	bool Render(ID3D11DeviceContext*, TerrainShaderClass*, XMMATRIX, XMMATRIX);
+
+	float GetErrorThreshold();
+	int GetDrawnChunkCount();
+	int GetResidentChunkCount();
+	int GetPendingChunkCount();
+	unsigned int GetMemoryUsage();
+
+//	The time in milliseconds the last Frame took to upload chunks and select the ones to draw.
+	float GetFrameTime();
+
+private:
+	bool CreateTerrainFile(JobSystemClass*, const char*, int);
+	bool ReadTerrainFile(const char*);
+	bool InitializeBuffers(ID3D11Device*);
+	void ShutdownBuffers();
+
+	static float GenerateHeight(int, int);
+	long long GetTileOffset(int, int, int);
+	int GetTileIndex(int, int, int);
+
+	void SelectChunk(int, int, int);
+	void GetChunkBounds(int, int, int, XMVECTOR&, XMVECTOR&);
+	bool IsChunkVisible(XMVECTOR, XMVECTOR);
+	float GetScreenError(int, XMVECTOR, XMVECTOR);
+	int FindChunk(int, int, int);
+	bool RequestChunk(int, int, int);
+	int AllocateChunk();
+	void UploadChunk(ID3D11DeviceContext*, int);
+
+	void LoaderThread();
+	bool ReadTile(FILE*, ChunkType*);
+
+	FileHeaderType m_header;
+	vector<TileBoundsType> m_tileBounds;
+	vector<long long> m_levelOffsets;
+	vector<int> m_levelTiles;
+	float m_originX, m_originZ;
+	int m_screenHeight;
+	float m_pixelsPerUnit, m_errorThreshold;
+
+	ID3D11Buffer* m_indexBuffer;
+	int m_indexCount;
+
+	vector<ChunkType> m_chunks;
+	unordered_map<unsigned long long, int> m_chunkMap;
+	vector<int> m_freeChunks;
+	vector<int> m_drawList;
+	vector<VertexType> m_vertices;
+	unsigned int m_frameNumber;
+
+	XMFLOAT3 m_cameraPosition;
+	XMVECTOR m_frustumPlanes[6];
+
+	char m_filename[128];
+	thread m_loaderThread;
+	mutex m_queueMutex;
+	condition_variable m_queueCondition;
+	deque<int> m_loadQueue, m_uploadQueue;
+	int m_pendingCount;
+	bool m_quit;
+
+	float m_frameTime;
+};
+
+#endif
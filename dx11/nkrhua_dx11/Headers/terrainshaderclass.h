@@ -0,0 +1,59 @@
+#ifndef _TERRAINSHADERCLASS_H_
+#define _TERRAINSHADERCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <DirectXMath.h>
+#include "shadermanagerclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	The TerrainShaderClass draws the chunks of the TerrainClass with terrain.vs, which morphs every vertex
+//	between the heights of its own level and of the parent level, and the pixel shader of color.ps. The
+//	view dependent values are set once per frame with SetParameters, after which Render only updates the
+//	error of the parent level for each chunk.
+class TerrainShaderClass
+{
+private:
+//	This must match the TerrainBuffer in terrain.vs exactly:
+	struct TerrainBufferType
+	{
+		XMMATRIX view;
+		XMMATRIX projection;
+		XMFLOAT3 cameraPosition;
+		float parentError;
+		float errorThreshold;
+		XMFLOAT3 padding;
+	};
+
+public:
+	TerrainShaderClass();
+	TerrainShaderClass(const TerrainShaderClass&);
+	~TerrainShaderClass();
+
+	bool Initialize(ID3D11Device*, ShaderManagerClass*);
+	static void Precompile(ShaderManagerClass*);
+	void Shutdown();
+
+	void SetParameters(XMMATRIX, XMMATRIX, XMFLOAT3, float);
+	bool Render(ID3D11DeviceContext*, int, float);
+
+//	Only SHADER_LIT is supported, which lights the terrain with the clustered lights.
+	void SetPermutation(unsigned int);
+
+private:
+	bool InitializeShader(ID3D11Device*, WCHAR*, WCHAR*);
+	void ShutdownShader();
+
+	bool SetShaderParameters(ID3D11DeviceContext*, float);
+	void RenderShader(ID3D11DeviceContext*, int);
+
+	ShaderManagerClass* m_ShaderManager;
+	int m_shaderFamily;
+	unsigned int m_permutation;
+	ID3D11Buffer* m_terrainBuffer;
+	TerrainBufferType m_parameters;
+};
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef _TEXTBENCHMARKCLASS_H_
+#define _TEXTBENCHMARKCLASS_H_
+
+//	Includes:
+#include "textclass.h"
+
+//	The TextBenchmarkClass lays out different strings like those of the overlay into a Text Object without
+//	drawing them, then adds the same strings again, which now come from its cache, and appends the glyphs per
+//	millisecond of both to a report. The frame is cleared whenever it is nearly full.
+class TextBenchmarkClass
+{
+public:
+//	Run takes the number of strings, the most glyphs the Text Object takes a frame and the report to append to.
+	static void Run(TextClass*, int, int, const char*);
+};
+
+#endif
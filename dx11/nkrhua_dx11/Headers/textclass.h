@@ -0,0 +1,96 @@
+#ifndef _TEXTCLASS_H_
+#define _TEXTCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <directxmath.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "fontclass.h"
+#include "resourceregistryclass.h"
+#include "shadermanagerclass.h"
+#include "vertexformatclass.h"
+//	Namespaces:
+using namespace DirectX;
+using namespace std;
+
+//	The most shaped runs the Text Object keeps. Once there are more, the runs the last frame didn't draw
+//	are dropped at the end of it.
+const int TEXT_RUN_CACHE_SIZE = 256;
+
+//	The most glyphs a frame can draw. The quads are indexed with 16 bits, so four vertices each have to fit.
+const int TEXT_MAX_GLYPHS = 16384;
+
+//	The TextClass draws all the text of a frame with one draw call. AddText lays a string out once into a
+//	run of glyph quads relative to where it starts and keeps the run, keyed by the string, so text that is
+//	drawn every frame is only copied and moved afterwards. The quads of every string added during the frame
+//	go into one array, which Render writes into a dynamic vertex buffer and draws over whatever is on the
+//	render target, in pixels from the top left corner of the screen.
+class TextClass
+{
+private:
+	struct GlyphQuadType
+	{
+		float left, top, right, bottom;
+		float texLeft, texTop, texRight, texBottom;
+	};
+
+	struct RunType
+	{
+		vector<GlyphQuadType> quads;
+		unsigned long long lastFrame;
+	};
+
+	struct TextBufferType
+	{
+		XMMATRIX ortho;
+	};
+
+public:
+	TextClass();
+	TextClass(const TextClass&);
+	~TextClass();
+
+	static void Precompile(ShaderManagerClass*);
+
+//	Initialize takes the font, the most glyphs a frame draws and the size of the screen.
+	bool Initialize(ID3D11Device*, ResourceRegistryClass*, ShaderManagerClass*, FontClass*, int, int, int);
+	void Shutdown();
+
+//	AddText adds a string at a position in pixels and returns false if not all of its glyphs fit into the
+//	frame. A newline starts the next line under the start of the string.
+	bool AddText(float, float, const char*, XMFLOAT4);
+	void Clear();
+	bool Render(ID3D11DeviceContext*, XMMATRIX);
+
+	int GetGlyphCount();
+	int GetRunCount();
+	int GetCacheHitCount();
+	int GetCacheMissCount();
+
+private:
+	bool InitializeShader(WCHAR*, WCHAR*);
+	bool InitializeBuffers(ID3D11Device*);
+	RunType* FindRun(const char*);
+
+	FontClass* m_Font;
+	int m_maxGlyphs;
+	float m_halfWidth, m_halfHeight;
+
+	unordered_map<string, RunType> m_runs;
+	string m_key;
+	unsigned long long m_frame;
+	int m_cacheHits, m_cacheMisses;
+
+	vector<TextVertexType> m_vertices;
+	int m_glyphCount;
+
+	ResourceRegistryClass* m_ResourceRegistry;
+	BufferHandle m_vertexBuffer, m_indexBuffer, m_textBuffer;
+	SamplerStateHandle m_sampleState;
+	ShaderManagerClass* m_ShaderManager;
+	int m_shaderFamily;
+};
+
+#endif
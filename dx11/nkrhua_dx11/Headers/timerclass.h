@@ -0,0 +1,26 @@
+#ifndef _TIMERCLASS_H_
+#define _TIMERCLASS_H_
+
+#include <windows.h>
+
+//	The TimerClass measures the time between frames with the high precision performance counter, so
+//	everything that moves can be driven by elapsed time instead of by the frame rate.
+class TimerClass
+{
+public:
+	TimerClass();
+	TimerClass(const TimerClass&);
+	~TimerClass();
+
+	bool Initialize();
+	void Frame();
+
+	float GetTime();
+
+private:
+	float m_frequency;
+	INT64 m_startTime;
+	float m_frameTime;
+};
+
+#endif
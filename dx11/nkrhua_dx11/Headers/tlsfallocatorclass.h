@@ -0,0 +1,78 @@
+#ifndef _TLSFALLOCATORCLASS_H_
+#define _TLSFALLOCATORCLASS_H_
+
+//	Includes:
+#include <vector>
+//	Namespaces:
+using namespace std;
+
+//	Every power of two range of free block sizes is split into this many lists, so a block found for an
+//	allocation is never more than 1/16th larger than asked for.
+const int TLSF_SECOND_LEVEL_BITS = 4;
+const int TLSF_SECOND_LEVEL_COUNT = 1 << TLSF_SECOND_LEVEL_BITS;
+const int TLSF_FIRST_LEVEL_COUNT = 32;
+
+//	The TLSFAllocatorClass hands out ranges of a heap it never touches itself, with the two level segregated
+//	fit scheme. Free blocks are kept in lists by size, a bitmap over the first level and one over the second
+//	level of each say which lists have blocks, so both Allocate and Free take a few bit scans and list
+//	operations however full or fragmented the heap is. Neighbouring free blocks are merged as they are
+//	freed. Sizes and offsets are in whatever unit the owner uses, the geometry heap uses vertices and
+//	indices. A block is named by an id that stays the same until it is freed, even when it is slid down.
+class TLSFAllocatorClass
+{
+private:
+	struct BlockType
+	{
+		unsigned int offset, size;
+		int previousBlock, nextBlock;
+		int previousFree, nextFree;
+		bool free;
+	};
+
+public:
+	TLSFAllocatorClass();
+	TLSFAllocatorClass(const TLSFAllocatorClass&);
+	~TLSFAllocatorClass();
+
+	bool Initialize(unsigned int);
+	void Shutdown();
+
+//	Allocate returns the id of the new block, or -1 if there is no free block large enough.
+	int Allocate(unsigned int);
+	void Free(int);
+
+//	SlideDown moves a block in use to the start of the free block right below it, if there is one, so the
+//	free space ends up above it instead. The caller has to move whatever the block holds to the new offset.
+	bool SlideDown(int);
+
+	unsigned int GetOffset(int);
+	unsigned int GetSize(int);
+
+//	The next block in use above the given one, or the lowest for -1. It returns -1 past the highest block.
+	int GetNextUsedBlock(int);
+
+	unsigned int GetCapacity();
+	unsigned int GetUsedSize();
+	unsigned int GetLargestFreeSize();
+	int GetBlockCount();
+
+private:
+	void MapSize(unsigned int, int&, int&);
+	int FindFreeBlock(unsigned int);
+	void InsertFreeBlock(int);
+	void RemoveFreeBlock(int);
+	int CreateBlock();
+	void DestroyBlock(int);
+
+	unsigned int m_capacity, m_usedSize;
+	int m_usedCount;
+	vector<BlockType> m_blocks;
+	vector<int> m_unusedBlocks;
+	int m_firstBlock, m_lastBlock;
+
+	unsigned int m_firstLevelMap;
+	unsigned int m_secondLevelMap[TLSF_FIRST_LEVEL_COUNT];
+	int m_freeLists[TLSF_FIRST_LEVEL_COUNT][TLSF_SECOND_LEVEL_COUNT];
+};
+
+#endif
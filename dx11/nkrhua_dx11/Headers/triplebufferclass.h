@@ -0,0 +1,38 @@
+#ifndef _TRIPLEBUFFERCLASS_H_
+#define _TRIPLEBUFFERCLASS_H_
+
+//	Includes:
+#include <atomic>
+//	Namespaces:
+using namespace std;
+
+//	The TripleBufferClass hands three slots between one thread that writes them and one that reads them,
+//	without either ever waiting. The writer fills its slot and publishes it, which swaps it with the slot in
+//	the middle. The reader takes the middle slot whenever a newer one has been published since it last
+//	did, and keeps reading the one it has otherwise. It only hands out slot numbers, the slots themselves
+//	belong to the caller.
+class TripleBufferClass
+{
+public:
+	TripleBufferClass();
+	TripleBufferClass(const TripleBufferClass&);
+	~TripleBufferClass();
+
+	void Initialize();
+
+	int GetWriteSlot();
+	void Publish();
+
+	bool Acquire();
+	int GetReadSlot();
+
+	int GetPublishCount();
+	int GetDroppedCount();
+
+private:
+	atomic<int> m_middle;
+	int m_write, m_read;
+	int m_publishCount, m_droppedCount;
+};
+
+#endif
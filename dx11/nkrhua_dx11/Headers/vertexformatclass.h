@@ -0,0 +1,254 @@
+#ifndef _VERTEXFORMATCLASS_H_
+#define _VERTEXFORMATCLASS_H_
+
+//	Includes:
+#include <d3d11.h>
+#include <d3dcommon.h>
+#include <directxmath.h>
+#include <DirectXPackedVector.h>
+#include <stddef.h>
+//	Namespaces:
+using namespace DirectX;
+
+//	A vertex format is declared once, as a list of attributes, and DECLARE_VERTEX_FORMAT turns the list into
+//	everything else that has to agree with it: the struct the vertex buffer is filled with, the input
+//	elements with the offsets the compiler gave the members, and a Pack function that turns the full float
+//	values the code works with into whatever the attributes store. Every attribute kind below says what it is
+//	given, what it stores, its DXGI format and how to pack one into the other, so a format is made compact by
+//	changing the kinds in its list and nothing else. The Shader Manager checks the list against what the
+//	Vertex Shader reads, so a vertex shader and the buffers it is fed from can't drift apart unnoticed.
+//
+//	An attribute is written as ATTRIBUTE(member, kind, semantic, semantic index), and every line of the list
+//	but the last ends in a backslash, left out here:
+//
+//	#define COLOR_VERTEX_ATTRIBUTES(ATTRIBUTE)
+//		ATTRIBUTE(position, VertexFloat3, "POSITION", 0)
+//		ATTRIBUTE(color, VertexFloat4, "COLOR", 0)
+//	DECLARE_VERTEX_FORMAT(ColorVertexType, COLOR_VERTEX_ATTRIBUTES)
+
+//	What the Shader Manager needs to build and check an input layout. The elements are all for slot 0 and
+//	per vertex, the manager moves the ones of an instance format to slot 1.
+struct VertexAttributeType
+{
+	int components;
+	D3D_REGISTER_COMPONENT_TYPE componentType;
+};
+
+struct VertexFormatType
+{
+	const char* name;
+	const D3D11_INPUT_ELEMENT_DESC* elements;
+	const VertexAttributeType* attributes;
+	int elementCount;
+	unsigned int stride;
+};
+
+//	The size of one element of the formats the attribute kinds use, so the kinds can be checked at compile time.
+constexpr unsigned int GetVertexFormatBytes(DXGI_FORMAT format)
+{
+	return (format == DXGI_FORMAT_R32G32B32A32_FLOAT) ? 16 :
+		(format == DXGI_FORMAT_R32G32B32_FLOAT) ? 12 :
+		(format == DXGI_FORMAT_R32G32_FLOAT || format == DXGI_FORMAT_R16G16B16A16_FLOAT) ? 8 :
+		(format == DXGI_FORMAT_R32_FLOAT || format == DXGI_FORMAT_R16G16_FLOAT || format == DXGI_FORMAT_R8G8B8A8_UNORM ||
+			format == DXGI_FORMAT_R8G8B8A8_SNORM) ? 4 : 0;
+}
+
+//	The attributes that are stored as they are given:
+template <class T, DXGI_FORMAT F, int N> struct VertexFloatAttribute
+{
+	typedef T SourceType;
+	typedef T StoredType;
+	static const DXGI_FORMAT format = F;
+	static const int components = N;
+	static const D3D_REGISTER_COMPONENT_TYPE componentType = D3D_REGISTER_COMPONENT_FLOAT32;
+
+	static void Pack(const SourceType& source, StoredType& stored)
+	{
+		stored = source;
+	}
+};
+
+typedef VertexFloatAttribute<float, DXGI_FORMAT_R32_FLOAT, 1> VertexFloat1;
+typedef VertexFloatAttribute<XMFLOAT2, DXGI_FORMAT_R32G32_FLOAT, 2> VertexFloat2;
+typedef VertexFloatAttribute<XMFLOAT3, DXGI_FORMAT_R32G32B32_FLOAT, 3> VertexFloat3;
+typedef VertexFloatAttribute<XMFLOAT4, DXGI_FORMAT_R32G32B32A32_FLOAT, 4> VertexFloat4;
+
+//	The compact attributes. The shader still reads floats, the input assembler expands them: half floats for
+//	texture coordinates, bytes from 0 to 1 for colors and bytes from -1 to 1 for directions.
+struct VertexHalf2
+{
+	typedef XMFLOAT2 SourceType;
+	typedef PackedVector::XMHALF2 StoredType;
+	static const DXGI_FORMAT format = DXGI_FORMAT_R16G16_FLOAT;
+	static const int components = 2;
+	static const D3D_REGISTER_COMPONENT_TYPE componentType = D3D_REGISTER_COMPONENT_FLOAT32;
+
+	static void Pack(const SourceType& source, StoredType& stored)
+	{
+		PackedVector::XMStoreHalf2(&stored, XMLoadFloat2(&source));
+	}
+};
+
+struct VertexHalf4
+{
+	typedef XMFLOAT4 SourceType;
+	typedef PackedVector::XMHALF4 StoredType;
+	static const DXGI_FORMAT format = DXGI_FORMAT_R16G16B16A16_FLOAT;
+	static const int components = 4;
+	static const D3D_REGISTER_COMPONENT_TYPE componentType = D3D_REGISTER_COMPONENT_FLOAT32;
+
+	static void Pack(const SourceType& source, StoredType& stored)
+	{
+		PackedVector::XMStoreHalf4(&stored, XMLoadFloat4(&source));
+	}
+};
+
+struct VertexUnorm4
+{
+	typedef XMFLOAT4 SourceType;
+	typedef PackedVector::XMUBYTEN4 StoredType;
+	static const DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	static const int components = 4;
+	static const D3D_REGISTER_COMPONENT_TYPE componentType = D3D_REGISTER_COMPONENT_FLOAT32;
+
+	static void Pack(const SourceType& source, StoredType& stored)
+	{
+		PackedVector::XMStoreUByteN4(&stored, XMLoadFloat4(&source));
+	}
+};
+
+struct VertexSnorm4
+{
+	typedef XMFLOAT4 SourceType;
+	typedef PackedVector::XMBYTEN4 StoredType;
+	static const DXGI_FORMAT format = DXGI_FORMAT_R8G8B8A8_SNORM;
+	static const int components = 4;
+	static const D3D_REGISTER_COMPONENT_TYPE componentType = D3D_REGISTER_COMPONENT_FLOAT32;
+
+	static void Pack(const SourceType& source, StoredType& stored)
+	{
+		PackedVector::XMStoreByteN4(&stored, XMLoadFloat4(&source));
+	}
+};
+
+//	What DECLARE_VERTEX_FORMAT makes of every attribute in the list:
+#define VERTEX_FORMAT_MEMBER(name, kind, semantic, index) kind::StoredType name;
+#define VERTEX_FORMAT_SOURCE_MEMBER(name, kind, semantic, index) kind::SourceType name;
+#define VERTEX_FORMAT_PACK(name, kind, semantic, index) kind::Pack(source.name, vertex.name);
+#define VERTEX_FORMAT_ELEMENT(name, kind, semantic, index) \
+	{ semantic, index, kind::format, 0, (UINT)offsetof(FormatType, name), D3D11_INPUT_PER_VERTEX_DATA, 0 },
+#define VERTEX_FORMAT_ATTRIBUTE(name, kind, semantic, index) { kind::components, kind::componentType },
+#define VERTEX_FORMAT_SIZE(name, kind, semantic, index) + sizeof(kind::StoredType)
+#define VERTEX_FORMAT_CHECK(name, kind, semantic, index) \
+	static_assert(sizeof(kind::StoredType) == GetVertexFormatBytes(kind::format), #name " is not the size of its format"); \
+	static_assert(offsetof(FormatType, name) % 4 == 0, #name " is not on a four byte boundary");
+
+//	The vertex struct has the stored members, SourceType has the same members as the code works with them,
+//	and Pack goes from one to the other with every attribute's own packing, all of it inline. CheckLayout is
+//	never called, it holds the compile time checks that need the struct to be complete: every member is the
+//	size of its DXGI format and on a four byte boundary, and there is no padding, so the stride is the sum
+//	of the attribute sizes.
+#define DECLARE_VERTEX_FORMAT(Type, ATTRIBUTES) \
+	struct Type \
+	{ \
+		typedef Type FormatType; \
+		struct SourceType \
+		{ \
+			ATTRIBUTES(VERTEX_FORMAT_SOURCE_MEMBER) \
+		}; \
+		ATTRIBUTES(VERTEX_FORMAT_MEMBER) \
+		static void Pack(const SourceType& source, Type& vertex) \
+		{ \
+			ATTRIBUTES(VERTEX_FORMAT_PACK) \
+		} \
+		static void Pack(const SourceType* sources, int count, Type* vertices) \
+		{ \
+			int i; \
+			for (i = 0; i < count; i++) \
+			{ \
+				Pack(sources[i], vertices[i]); \
+			} \
+		} \
+		static const VertexFormatType& GetFormat() \
+		{ \
+			static const D3D11_INPUT_ELEMENT_DESC elements[] = { ATTRIBUTES(VERTEX_FORMAT_ELEMENT) }; \
+			static const VertexAttributeType attributes[] = { ATTRIBUTES(VERTEX_FORMAT_ATTRIBUTE) }; \
+			static const VertexFormatType format = { #Type, elements, attributes, sizeof(elements) / sizeof(elements[0]), sizeof(Type) }; \
+			return format; \
+		} \
+		static void CheckLayout() \
+		{ \
+			ATTRIBUTES(VERTEX_FORMAT_CHECK) \
+			static_assert(sizeof(Type) == 0 ATTRIBUTES(VERTEX_FORMAT_SIZE), #Type " has padding between its attributes"); \
+		} \
+	};
+
+//	The vertex formats of the scene. VertexInputType in color.vs reads the position and the color, and the
+//	texture coordinates in the TEXTURED permutation; the QUANTIZED permutation is fed the compact formats.
+//	The model, the skinned characters and the particle quads all use ColorVertexType.
+#define COLOR_VERTEX_ATTRIBUTES(ATTRIBUTE) \
+	ATTRIBUTE(position, VertexFloat3, "POSITION", 0) \
+	ATTRIBUTE(color, VertexFloat4, "COLOR", 0)
+DECLARE_VERTEX_FORMAT(ColorVertexType, COLOR_VERTEX_ATTRIBUTES)
+
+#define COLOR_COMPACT_VERTEX_ATTRIBUTES(ATTRIBUTE) \
+	ATTRIBUTE(position, VertexFloat3, "POSITION", 0) \
+	ATTRIBUTE(color, VertexUnorm4, "COLOR", 0)
+DECLARE_VERTEX_FORMAT(ColorCompactVertexType, COLOR_COMPACT_VERTEX_ATTRIBUTES)
+
+#define COLOR_TEXTURED_VERTEX_ATTRIBUTES(ATTRIBUTE) \
+	ATTRIBUTE(position, VertexFloat3, "POSITION", 0) \
+	ATTRIBUTE(color, VertexFloat4, "COLOR", 0) \
+	ATTRIBUTE(tex, VertexFloat2, "TEXCOORD", 0)
+DECLARE_VERTEX_FORMAT(ColorTexturedVertexType, COLOR_TEXTURED_VERTEX_ATTRIBUTES)
+
+#define COLOR_COMPACT_TEXTURED_VERTEX_ATTRIBUTES(ATTRIBUTE) \
+	ATTRIBUTE(position, VertexFloat3, "POSITION", 0) \
+	ATTRIBUTE(color, VertexUnorm4, "COLOR", 0) \
+	ATTRIBUTE(tex, VertexHalf2, "TEXCOORD", 0)
+DECLARE_VERTEX_FORMAT(ColorCompactTexturedVertexType, COLOR_COMPACT_TEXTURED_VERTEX_ATTRIBUTES)
+
+//	The per instance data the INSTANCED permutation of color.vs reads from slot 1:
+#define COLOR_INSTANCE_ATTRIBUTES(ATTRIBUTE) \
+	ATTRIBUTE(world0, VertexFloat4, "INSTANCEWORLD", 0) \
+	ATTRIBUTE(world1, VertexFloat4, "INSTANCEWORLD", 1) \
+	ATTRIBUTE(world2, VertexFloat4, "INSTANCEWORLD", 2) \
+	ATTRIBUTE(world3, VertexFloat4, "INSTANCEWORLD", 3) \
+	ATTRIBUTE(color, VertexFloat4, "INSTANCECOLOR", 0)
+DECLARE_VERTEX_FORMAT(ColorInstanceType, COLOR_INSTANCE_ATTRIBUTES)
+
+//	The terrain vertices terrain.vs reads. The morph height is the height the vertex has in the parent level.
+#define TERRAIN_VERTEX_ATTRIBUTES(ATTRIBUTE) \
+	ATTRIBUTE(position, VertexFloat3, "POSITION", 0) \
+	ATTRIBUTE(morphHeight, VertexFloat1, "MORPHHEIGHT", 0) \
+	ATTRIBUTE(color, VertexFloat4, "COLOR", 0)
+DECLARE_VERTEX_FORMAT(TerrainVertexType, TERRAIN_VERTEX_ATTRIBUTES)
+
+//	The text quads text.vs reads, in pixels from the center of the screen, with the color of their string.
+#define TEXT_VERTEX_ATTRIBUTES(ATTRIBUTE) \
+	ATTRIBUTE(position, VertexFloat2, "POSITION", 0) \
+	ATTRIBUTE(tex, VertexFloat2, "TEXCOORD", 0) \
+	ATTRIBUTE(color, VertexUnorm4, "COLOR", 0)
+DECLARE_VERTEX_FORMAT(TextVertexType, TEXT_VERTEX_ATTRIBUTES)
+
+//	The per instance data sprite.vs reads from slot 1: the center and half the size in pixels from the center of
+//	the screen, the texture rectangle, the sine and cosine of the rotation and the color.
+#define SPRITE_INSTANCE_ATTRIBUTES(ATTRIBUTE) \
+	ATTRIBUTE(rectangle, VertexFloat4, "INSTANCERECTANGLE", 0) \
+	ATTRIBUTE(tex, VertexFloat4, "INSTANCETEXCOORD", 0) \
+	ATTRIBUTE(rotation, VertexFloat2, "INSTANCEROTATION", 0) \
+	ATTRIBUTE(color, VertexUnorm4, "INSTANCECOLOR", 0)
+DECLARE_VERTEX_FORMAT(SpriteInstanceType, SPRITE_INSTANCE_ATTRIBUTES)
+
+//	The line list vertices debug.vs reads, in world space.
+#define DEBUG_VERTEX_ATTRIBUTES(ATTRIBUTE) \
+	ATTRIBUTE(position, VertexFloat3, "POSITION", 0) \
+	ATTRIBUTE(color, VertexUnorm4, "COLOR", 0)
+DECLARE_VERTEX_FORMAT(DebugVertexType, DEBUG_VERTEX_ATTRIBUTES)
+
+//	shadow.vs only reads the position, and draws the casters from the vertex buffers of the scene with the
+//	layout of ColorVertexType. That works for every format whose position comes first as three floats:
+static_assert(offsetof(ColorVertexType, position) == 0, "The shadow casters need the position first");
+static_assert(offsetof(ColorCompactVertexType, position) == 0, "The shadow casters need the position first");
+
+#endif
@@ -0,0 +1,129 @@
+//	The animation benchmark animates a crowd of characters with the Animation System, every one blending two
+//	compressed clips on a chain of joints, and prints how many characters were animated per millisecond on
+//	each core. Nothing in it needs Direct3D. It is not part of the engine's project and is built on its own,
+//	with the DirectXMath headers on the include path, for example with:
+//	g++ -O2 -o animationbenchmark Source/animationbenchmarkmain.cpp Source/animationsystemclass.cpp
+//	    Source/animationclipclass.cpp Source/skeletonclass.cpp Source/batchmathclass.cpp Source/jobsystemclass.cpp -lpthread
+//	and run as: animationbenchmark [characters] [joints] [frames]
+#include "../Headers/animationsystemclass.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+//	The clips are sampled like the ones of the Skinned Model: a second long at 30 keys a second.
+static const int BENCHMARK_CLIP_FRAMES = 31;
+static const float BENCHMARK_CLIP_RATE = 30.0f;
+static const float BENCHMARK_BONE_LENGTH = 0.5f;
+
+//	InitializeSkeleton builds a chain of joints going straight up, each one bone length above its parent.
+static bool InitializeSkeleton(SkeletonClass& skeleton, int jointCount)
+{
+	vector<int> parents;
+	vector<XMFLOAT4> rotations;
+	vector<XMFLOAT3> translations;
+	int i;
+
+	parents.resize(jointCount);
+	rotations.resize(jointCount);
+	translations.resize(jointCount);
+	for (i = 0; i < jointCount; i++)
+	{
+		parents[i] = i - 1;
+		rotations[i] = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+		translations[i] = XMFLOAT3(0.0f, (i == 0) ? 0.0f : BENCHMARK_BONE_LENGTH, 0.0f);
+	}
+
+	return skeleton.Initialize(jointCount, parents.data(), rotations.data(), translations.data());
+}
+
+//	InitializeClip generates a sway that travels up the chain, around the z axis for the first clip and
+//	the x axis for the second, with the root of the second bobbing up and down, so both clips have animated
+//	rotation tracks for every joint and the second an animated translation track as well.
+static bool InitializeClip(AnimationClipClass& clip, int jointCount, int index)
+{
+	vector<XMFLOAT4> rotations;
+	vector<XMFLOAT3> translations;
+	float phase, angle;
+	int frame, joint, key;
+
+	rotations.resize(BENCHMARK_CLIP_FRAMES * jointCount);
+	translations.resize(BENCHMARK_CLIP_FRAMES * jointCount);
+
+	for (frame = 0; frame < BENCHMARK_CLIP_FRAMES; frame++)
+	{
+		phase = XM_2PI * (float)frame / (float)(BENCHMARK_CLIP_FRAMES - 1);
+		for (joint = 0; joint < jointCount; joint++)
+		{
+			key = frame * jointCount + joint;
+			angle = 0.3f * sinf(phase - 0.6f * (float)joint);
+			XMStoreFloat4(&rotations[key], XMQuaternionRotationRollPitchYaw(index == 1 ? angle : 0.0f, 0.0f, index == 0 ? angle : 0.0f));
+			translations[key] = XMFLOAT3(0.0f, (joint == 0) ? (index == 1 ? 0.15f * sinf(2.0f * phase) : 0.0f) : BENCHMARK_BONE_LENGTH, 0.0f);
+		}
+	}
+
+	return clip.Initialize(jointCount, BENCHMARK_CLIP_FRAMES, BENCHMARK_CLIP_RATE, rotations.data(), translations.data());
+}
+
+int main(int argc, char* argv[])
+{
+	JobSystemClass jobSystem;
+	SkeletonClass skeleton;
+	AnimationClipClass clips[2];
+	AnimationSystemClass animation;
+	float rate, fastest, total;
+	int characterCount, jointCount, frameCount, i, character;
+
+	characterCount = argc > 1 ? atoi(argv[1]) : 10000;
+	jointCount = argc > 2 ? atoi(argv[2]) : 64;
+	frameCount = argc > 3 ? atoi(argv[3]) : 100;
+	if (characterCount <= 0 || jointCount <= 0 || jointCount > SKELETON_MAX_JOINTS || frameCount <= 0)
+	{
+		fprintf(stderr, "usage: %s [characters] [joints, at most %d] [frames]\n", argv[0], SKELETON_MAX_JOINTS);
+		return 1;
+	}
+
+	jobSystem.Initialize(0);
+
+	if (!InitializeSkeleton(skeleton, jointCount) || !InitializeClip(clips[0], jointCount, 0) || !InitializeClip(clips[1], jointCount, 1))
+	{
+		fprintf(stderr, "Could not build the skeleton and clips\n");
+		return 1;
+	}
+
+	animation.Initialize(&skeleton, characterCount);
+
+//	Every character blends both clips, out of step with the others, the way the characters of the scene do:
+	for (i = 0; i < characterCount; i++)
+	{
+		character = animation.AddCharacter();
+		animation.SetLayer(character, 0, &clips[0], 0.13f * (float)i, 1.0f, 1.0f);
+		animation.SetLayer(character, 1, &clips[1], 0.07f * (float)i, 0.5f, 0.25f * (float)(1 + i % 4));
+	}
+
+//	One frame to warm up, then keep the fastest and the average of the rest:
+	animation.Update(&jobSystem, 1.0f / 60.0f);
+
+	fastest = 0.0f;
+	total = 0.0f;
+	for (i = 0; i < frameCount; i++)
+	{
+		animation.Update(&jobSystem, 1.0f / 60.0f);
+
+		rate = animation.GetCharactersPerMillisecond();
+		fastest = rate > fastest ? rate : fastest;
+		total += rate;
+	}
+
+	printf("%d characters, %d joints, 2 layers, clips of %u and %u bytes, %d threads: %.1f characters/ms per core best, %.1f average\n",
+		characterCount, jointCount, clips[0].GetCompressedSize(), clips[1].GetCompressedSize(), jobSystem.GetThreadCount(), fastest,
+		total / (float)frameCount);
+
+	animation.Shutdown();
+	clips[0].Shutdown();
+	clips[1].Shutdown();
+	skeleton.Shutdown();
+	jobSystem.Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,238 @@
+#include "../Headers/animationclipclass.h"
+
+#include <math.h>
+
+//	Tracks whose keys never move further than this from the first key are stored as constant.
+const float CLIP_CONSTANT_ROTATION_TOLERANCE = 0.0001f;
+const float CLIP_CONSTANT_TRANSLATION_TOLERANCE = 0.0001f;
+
+AnimationClipClass::AnimationClipClass()
+{
+	m_jointCount = 0;
+	m_frameCount = 0;
+	m_framesPerSecond = 0.0f;
+	m_duration = 0.0f;
+}
+
+AnimationClipClass::AnimationClipClass(const AnimationClipClass& other)
+{
+
+}
+
+AnimationClipClass::~AnimationClipClass()
+{
+
+}
+
+//	Initialize compresses the raw keys. Key [frame * jointCount + joint] is the local pose of that joint
+//	at that frame.
+bool AnimationClipClass::Initialize(int jointCount, int frameCount, float framesPerSecond, const XMFLOAT4* rotations, const XMFLOAT3* translations)
+{
+	vector<XMFLOAT4> alignedRotations;
+	XMVECTOR previous, current, minimum, maximum, scale;
+	XMFLOAT4 range;
+	XMUSHORTN4 translationKey;
+	XMSHORTN4 rotationKey;
+	bool constant;
+	int joint, frame, track, trackCount;
+
+	if (jointCount <= 0 || frameCount < 2 || framesPerSecond <= 0.0f)
+	{
+		return false;
+	}
+
+	m_jointCount = jointCount;
+	m_frameCount = frameCount;
+	m_framesPerSecond = framesPerSecond;
+	m_duration = (float)(frameCount - 1) / framesPerSecond;
+
+//	q and -q are the same rotation, so flip every key into the hemisphere of the key before it. Neighbouring
+//	keys can then be interpolated without checking the sign while sampling:
+	alignedRotations.assign(rotations, rotations + (size_t)jointCount * frameCount);
+	for (frame = 1; frame < frameCount; frame++)
+	{
+		for (joint = 0; joint < jointCount; joint++)
+		{
+			previous = XMLoadFloat4(&alignedRotations[(size_t)(frame - 1) * jointCount + joint]);
+			current = XMLoadFloat4(&alignedRotations[(size_t)frame * jointCount + joint]);
+
+			if (XMVectorGetX(XMVector4Dot(previous, current)) < 0.0f)
+			{
+				XMStoreFloat4(&alignedRotations[(size_t)frame * jointCount + joint], XMVectorNegate(current));
+			}
+		}
+	}
+
+//	Find the animated tracks and keep the first key of every track as its constant value:
+	m_constantRotations.resize(jointCount);
+	m_constantTranslations.resize(jointCount);
+	m_rotationJoints.clear();
+	m_translationJoints.clear();
+	m_translationMinimums.clear();
+	m_translationScales.clear();
+
+	for (joint = 0; joint < jointCount; joint++)
+	{
+		m_constantRotations[joint] = alignedRotations[joint];
+		m_constantTranslations[joint] = XMFLOAT4(translations[joint].x, translations[joint].y, translations[joint].z, 0.0f);
+
+		constant = true;
+		for (frame = 1; frame < frameCount && constant; frame++)
+		{
+			current = XMLoadFloat4(&alignedRotations[(size_t)frame * jointCount + joint]);
+			if (1.0f - fabsf(XMVectorGetX(XMVector4Dot(current, XMLoadFloat4(&alignedRotations[joint])))) > CLIP_CONSTANT_ROTATION_TOLERANCE)
+			{
+				constant = false;
+			}
+		}
+		if (!constant)
+		{
+			m_rotationJoints.push_back(joint);
+		}
+
+		minimum = XMLoadFloat3(&translations[joint]);
+		maximum = minimum;
+		for (frame = 1; frame < frameCount; frame++)
+		{
+			current = XMLoadFloat3(&translations[(size_t)frame * jointCount + joint]);
+			minimum = XMVectorMin(minimum, current);
+			maximum = XMVectorMax(maximum, current);
+		}
+
+		XMStoreFloat4(&range, XMVectorSubtract(maximum, minimum));
+		if (range.x > CLIP_CONSTANT_TRANSLATION_TOLERANCE || range.y > CLIP_CONSTANT_TRANSLATION_TOLERANCE || range.z > CLIP_CONSTANT_TRANSLATION_TOLERANCE)
+		{
+			m_translationJoints.push_back(joint);
+
+			m_translationMinimums.push_back(XMFLOAT4());
+			XMStoreFloat4(&m_translationMinimums.back(), minimum);
+			m_translationScales.push_back(range);
+		}
+	}
+
+//	Quantize the keys of the animated rotation tracks:
+	trackCount = (int)m_rotationJoints.size();
+	m_rotationKeys.resize((size_t)trackCount * frameCount);
+	for (frame = 0; frame < frameCount; frame++)
+	{
+		for (track = 0; track < trackCount; track++)
+		{
+			current = XMLoadFloat4(&alignedRotations[(size_t)frame * jointCount + m_rotationJoints[track]]);
+			XMStoreShortN4(&rotationKey, current);
+			m_rotationKeys[(size_t)frame * trackCount + track] = rotationKey;
+		}
+	}
+
+//	Quantize the keys of the animated translation tracks to their range. An axis that does not move
+//	within a moving track gets a scale of zero and decodes to its minimum:
+	trackCount = (int)m_translationJoints.size();
+	m_translationKeys.resize((size_t)trackCount * frameCount);
+	for (track = 0; track < trackCount; track++)
+	{
+		range = m_translationScales[track];
+		scale = XMVectorSet(range.x > 0.0f ? 1.0f / range.x : 0.0f, range.y > 0.0f ? 1.0f / range.y : 0.0f, range.z > 0.0f ? 1.0f / range.z : 0.0f, 0.0f);
+		minimum = XMLoadFloat4(&m_translationMinimums[track]);
+
+		for (frame = 0; frame < frameCount; frame++)
+		{
+			current = XMLoadFloat3(&translations[(size_t)frame * jointCount + m_translationJoints[track]]);
+			XMStoreUShortN4(&translationKey, XMVectorMultiply(XMVectorSubtract(current, minimum), scale));
+			m_translationKeys[(size_t)frame * trackCount + track] = translationKey;
+		}
+	}
+
+	return true;
+}
+
+void AnimationClipClass::Shutdown()
+{
+	m_constantRotations.clear();
+	m_constantTranslations.clear();
+	m_rotationJoints.clear();
+	m_translationJoints.clear();
+	m_rotationKeys.clear();
+	m_translationKeys.clear();
+	m_translationMinimums.clear();
+	m_translationScales.clear();
+
+	return;
+}
+
+//	Sample writes the pose at the given time into the arrays, which need room for every joint. The time
+//	wraps around the length of the clip. Rotations are blended with a normalized lerp, which for keys this
+//	close together is indistinguishable from a slerp and a lot cheaper.
+void AnimationClipClass::Sample(float time, XMVECTOR* rotations, XMVECTOR* translations)
+{
+	const XMSHORTN4* rotationKeys0, * rotationKeys1;
+	const XMUSHORTN4* translationKeys0, * translationKeys1;
+	XMVECTOR key0, key1, alpha;
+	float framePosition;
+	int frame, joint, track, trackCount;
+
+//	Find the two frames around the time:
+	time = fmodf(time, m_duration);
+	if (time < 0.0f)
+	{
+		time += m_duration;
+	}
+
+	framePosition = time * m_framesPerSecond;
+	frame = (int)framePosition;
+	if (frame > m_frameCount - 2)
+	{
+		frame = m_frameCount - 2;
+	}
+	alpha = XMVectorReplicate(framePosition - (float)frame);
+
+//	Start from the constant tracks:
+	for (joint = 0; joint < m_jointCount; joint++)
+	{
+		rotations[joint] = XMLoadFloat4(&m_constantRotations[joint]);
+		translations[joint] = XMLoadFloat4(&m_constantTranslations[joint]);
+	}
+
+//	Decode and blend the two keys of every animated rotation track:
+	trackCount = (int)m_rotationJoints.size();
+	rotationKeys0 = m_rotationKeys.data() + (size_t)frame * trackCount;
+	rotationKeys1 = rotationKeys0 + trackCount;
+	for (track = 0; track < trackCount; track++)
+	{
+		key0 = XMLoadShortN4(&rotationKeys0[track]);
+		key1 = XMLoadShortN4(&rotationKeys1[track]);
+
+		rotations[m_rotationJoints[track]] = XMQuaternionNormalize(XMVectorMultiplyAdd(XMVectorSubtract(key1, key0), alpha, key0));
+	}
+
+//	Decode and blend the two keys of every animated translation track:
+	trackCount = (int)m_translationJoints.size();
+	translationKeys0 = m_translationKeys.data() + (size_t)frame * trackCount;
+	translationKeys1 = translationKeys0 + trackCount;
+	for (track = 0; track < trackCount; track++)
+	{
+		key0 = XMLoadUShortN4(&translationKeys0[track]);
+		key1 = XMLoadUShortN4(&translationKeys1[track]);
+		key0 = XMVectorMultiplyAdd(XMVectorSubtract(key1, key0), alpha, key0);
+
+		translations[m_translationJoints[track]] = XMVectorMultiplyAdd(key0, XMLoadFloat4(&m_translationScales[track]), XMLoadFloat4(&m_translationMinimums[track]));
+	}
+
+	return;
+}
+
+int AnimationClipClass::GetJointCount()
+{
+	return m_jointCount;
+}
+
+float AnimationClipClass::GetDuration()
+{
+	return m_duration;
+}
+
+//	GetCompressedSize returns the bytes used by the keys and ranges, for comparing against the raw clip.
+unsigned int AnimationClipClass::GetCompressedSize()
+{
+	return (unsigned int)(m_constantRotations.size() * sizeof(XMFLOAT4) + m_constantTranslations.size() * sizeof(XMFLOAT4) +
+		m_rotationKeys.size() * sizeof(XMSHORTN4) + m_translationKeys.size() * sizeof(XMUSHORTN4) +
+		m_translationMinimums.size() * sizeof(XMFLOAT4) + m_translationScales.size() * sizeof(XMFLOAT4));
+}
@@ -0,0 +1,225 @@
+#include "../Headers/animationsystemclass.h"
+
+#include <math.h>
+#include <chrono>
+
+AnimationSystemClass::AnimationSystemClass()
+{
+	m_Skeleton = 0;
+	m_jointCount = 0;
+	m_maxCharacters = 0;
+	m_charactersPerMillisecond = 0.0f;
+}
+
+AnimationSystemClass::AnimationSystemClass(const AnimationSystemClass& other)
+{
+
+}
+
+AnimationSystemClass::~AnimationSystemClass()
+{
+
+}
+
+//	Initialize reserves room for the characters up front so the palette array never moves while the
+//	renderer holds pointers into it.
+bool AnimationSystemClass::Initialize(SkeletonClass* skeleton, int maxCharacters)
+{
+	if (!skeleton || skeleton->GetJointCount() <= 0 || maxCharacters <= 0)
+	{
+		return false;
+	}
+
+	m_Skeleton = skeleton;
+	m_jointCount = skeleton->GetJointCount();
+	m_maxCharacters = maxCharacters;
+
+	m_characters.reserve(maxCharacters);
+	m_palettes.reserve((size_t)maxCharacters * m_jointCount);
+
+	return true;
+}
+
+void AnimationSystemClass::Shutdown()
+{
+	m_characters.clear();
+	m_palettes.clear();
+	m_Skeleton = 0;
+
+	return;
+}
+
+//	AddCharacter adds a character in the bind pose and returns its index, or -1 if the system is full.
+int AnimationSystemClass::AddCharacter()
+{
+	CharacterType character;
+	int i;
+
+	if ((int)m_characters.size() == m_maxCharacters)
+	{
+		return -1;
+	}
+
+	for (i = 0; i < ANIMATION_MAX_LAYERS; i++)
+	{
+		character.layers[i].clip = 0;
+		character.layers[i].time = 0.0f;
+		character.layers[i].speed = 1.0f;
+		character.layers[i].weight = 0.0f;
+	}
+
+	m_characters.push_back(character);
+	m_palettes.resize(m_characters.size() * m_jointCount);
+
+	AnimateCharacter((int)m_characters.size() - 1, 0.0f);
+
+	return (int)m_characters.size() - 1;
+}
+
+//	SetLayer starts a clip on one of the character's layers. A null clip or a weight of zero turns the
+//	layer off. The weights of the active layers are normalized when blending, so they only need to be
+//	right relative to each other.
+void AnimationSystemClass::SetLayer(int character, int layer, AnimationClipClass* clip, float time, float speed, float weight)
+{
+	LayerType* target;
+
+	if (character < 0 || character >= (int)m_characters.size() || layer < 0 || layer >= ANIMATION_MAX_LAYERS)
+	{
+		return;
+	}
+
+	target = &m_characters[character].layers[layer];
+	target->clip = (clip && clip->GetJointCount() == m_jointCount) ? clip : 0;
+	target->time = time;
+	target->speed = speed;
+	target->weight = weight;
+
+	return;
+}
+
+//	Update advances every character by the frame time in seconds. Characters only write their own layers
+//	and palette, so the batches need no locking.
+void AnimationSystemClass::Update(JobSystemClass* jobSystem, float frameTime)
+{
+	chrono::high_resolution_clock::time_point startTime;
+	float elapsed;
+
+	startTime = chrono::high_resolution_clock::now();
+
+	jobSystem->ParallelFor((int)m_characters.size(), ANIMATION_BATCH_SIZE, [this, frameTime](int begin, int end)
+	{
+		int i;
+
+		for (i = begin; i < end; i++)
+		{
+			AnimateCharacter(i, frameTime);
+		}
+	});
+
+	elapsed = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+	if (elapsed > 0.0f)
+	{
+		m_charactersPerMillisecond = (float)m_characters.size() / (elapsed * (float)jobSystem->GetThreadCount());
+	}
+
+	return;
+}
+
+//	GetPalette returns the skinning matrices of a character, one per joint.
+const XMFLOAT4X4* AnimationSystemClass::GetPalette(int character)
+{
+	return &m_palettes[(size_t)character * m_jointCount];
+}
+
+int AnimationSystemClass::GetCharacterCount()
+{
+	return (int)m_characters.size();
+}
+
+int AnimationSystemClass::GetJointCount()
+{
+	return m_jointCount;
+}
+
+float AnimationSystemClass::GetCharactersPerMillisecond()
+{
+	return m_charactersPerMillisecond;
+}
+
+//	AnimateCharacter samples every active layer and accumulates it into the blended pose. Translations are
+//	summed by weight, and so are rotations after each one is flipped into the hemisphere of the first
+//	layer, which makes the normalized sum a good blend for any number of layers. Without active layers
+//	the character stays in the bind pose.
+void AnimationSystemClass::AnimateCharacter(int index, float frameTime)
+{
+	XMVECTOR rotations[SKELETON_MAX_JOINTS], translations[SKELETON_MAX_JOINTS];
+	XMVECTOR blendedRotations[SKELETON_MAX_JOINTS], blendedTranslations[SKELETON_MAX_JOINTS];
+	XMVECTOR weight, sign;
+	CharacterType& character = m_characters[index];
+	LayerType* layer;
+	float totalWeight;
+	int i, joint;
+	bool first;
+
+	totalWeight = 0.0f;
+	for (i = 0; i < ANIMATION_MAX_LAYERS; i++)
+	{
+		layer = &character.layers[i];
+		if (layer->clip && layer->weight > 0.0f)
+		{
+			layer->time = fmodf(layer->time + frameTime * layer->speed, layer->clip->GetDuration());
+			totalWeight += layer->weight;
+		}
+	}
+
+	if (totalWeight <= 0.0f)
+	{
+		m_Skeleton->GetBindPose(blendedRotations, blendedTranslations);
+		m_Skeleton->ComputeSkinningPalette(blendedRotations, blendedTranslations, &m_palettes[(size_t)index * m_jointCount]);
+		return;
+	}
+
+	first = true;
+	for (i = 0; i < ANIMATION_MAX_LAYERS; i++)
+	{
+		layer = &character.layers[i];
+		if (!layer->clip || layer->weight <= 0.0f)
+		{
+			continue;
+		}
+
+		weight = XMVectorReplicate(layer->weight / totalWeight);
+
+//	The first layer is sampled straight into the blended pose:
+		if (first)
+		{
+			layer->clip->Sample(layer->time, blendedRotations, blendedTranslations);
+			for (joint = 0; joint < m_jointCount; joint++)
+			{
+				blendedRotations[joint] = XMVectorMultiply(blendedRotations[joint], weight);
+				blendedTranslations[joint] = XMVectorMultiply(blendedTranslations[joint], weight);
+			}
+			first = false;
+			continue;
+		}
+
+		layer->clip->Sample(layer->time, rotations, translations);
+		for (joint = 0; joint < m_jointCount; joint++)
+		{
+//	Negate the weight where the rotation points away from the blend so far, without branching:
+			sign = XMVectorSelect(XMVectorSplatOne(), XMVectorReplicate(-1.0f), XMVectorLess(XMVector4Dot(blendedRotations[joint], rotations[joint]), XMVectorZero()));
+
+			blendedRotations[joint] = XMVectorMultiplyAdd(rotations[joint], XMVectorMultiply(weight, sign), blendedRotations[joint]);
+			blendedTranslations[joint] = XMVectorMultiplyAdd(translations[joint], weight, blendedTranslations[joint]);
+		}
+	}
+
+	for (joint = 0; joint < m_jointCount; joint++)
+	{
+		blendedRotations[joint] = XMQuaternionNormalize(blendedRotations[joint]);
+	}
+
+	m_Skeleton->ComputeSkinningPalette(blendedRotations, blendedTranslations, &m_palettes[(size_t)index * m_jointCount]);
+
+	return;
+}
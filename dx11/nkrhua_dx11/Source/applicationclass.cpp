@@ -1,11 +1,72 @@
 #include "../Headers/applicationclass.h"
 
+#include <math.h>
+#include <chrono>
+#include <mmsystem.h>
+
+//	LerpFloat3 blends two points, t of the way from the first to the second.
+static XMFLOAT3 LerpFloat3(const XMFLOAT3& a, const XMFLOAT3& b, float t)
+{
+	return XMFLOAT3(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t);
+}
+
 ApplicationClass::ApplicationClass()
 {
 	m_Direct3D = 0;
 	m_Camera = 0;
 	m_Model = 0;
+	m_GeometryHeap = 0;
+	m_ShaderManager = 0;
 	m_ColorShader = 0;
+	m_GeometryStream = 0;
+	m_RenderTexture = 0;
+	m_FrameCapture = 0;
+	m_frameNumber = 0;
+	m_Timer = 0;
+	m_JobSystem = 0;
+	m_SkinnedModel = 0;
+	m_Animation = 0;
+	m_ParticleSystem = 0;
+	m_particlesWritten = false;
+	m_TerrainShader = 0;
+	m_Terrain = 0;
+	m_MeshBVH = 0;
+	m_SceneBVH = 0;
+	m_screenWidth = 0;
+	m_screenHeight = 0;
+	m_pickedCharacter = -1;
+	m_LightCluster = 0;
+	m_Shadow = 0;
+	m_ScenePackage = 0;
+	m_Entities = 0;
+	m_StaticBatch = 0;
+	m_SceneSystems = 0;
+	m_transformComponent = -1;
+	m_renderableComponent = -1;
+	m_boundsComponent = -1;
+	m_firstFrameReported = false;
+	m_RenderStats = 0;
+	m_DynamicResolution = 0;
+	m_hwnd = 0;
+	m_SnapshotBuffer = 0;
+	m_simulationQuit = false;
+	m_simulationCamera = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	m_publishedCamera = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	m_pickPending = false;
+	m_pickOrigin = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	m_pickDirection = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	m_renderPalettes = 0;
+	m_renderRenderables = 0;
+	m_renderBounds = 0;
+	m_snapshotAlpha = 1.0f;
+	m_PipelineStats = 0;
+	m_Font = 0;
+	m_Text = 0;
+	m_statsText[0] = 0;
+	m_SpriteBatch = 0;
+#if DEBUG_DRAW_ENABLED
+	m_DebugDraw = 0;
+#endif
 }
 
 ApplicationClass::ApplicationClass(const ApplicationClass& other)
@@ -18,49 +79,705 @@ ApplicationClass::~ApplicationClass()
 
 }
 
+//	Initialize starts the application up as a graph of tasks, so that the work that doesn't wait on anything
+//	else overlaps: the shaders are compiled and the scene package is opened while the device is created, and
+//	everything that only needs the device is created on the workers the moment it exists. The tasks that use
+//	the window, the immediate context, the Resource Registry or the Job System run on this thread, one after
+//	another, since none of those can be used from two threads at once. Every task is timed, and the timeline
+//	is appended to STARTUP_REPORT, followed by the time to the first frame once it has been presented.
 bool ApplicationClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
 {
+	TaskGraphClass startup;
+	XMMATRIX viewMatrix;
+	int device, jobs, model, colorCompile, terrainCompile, shadowCompile, upscaleCompile, textCompile, spriteCompile, skinnedModel, animation, sceneOpen, sceneCook, entities, picking, task;
+#if DEBUG_DRAW_ENABLED
+	int debugCompile;
+#endif
 	bool result;
 
-	m_Direct3D = new D3DClass;
-	result = m_Direct3D->Initialize(screenWidth, screenHeight, VSYNC_ENABLED, hwnd, FULL_SCREEN, SCREEN_DEPTH, SCREEN_NEAR);
+	m_startTime = chrono::high_resolution_clock::now();
+	m_hwnd = hwnd;
+	m_screenWidth = screenWidth;
+	m_screenHeight = screenHeight;
+
+//	Pick the fastest batch math kernels the processor supports before anything uses them:
+	BatchMathClass::Initialize();
+
+//	Create the Camera Object and set its Initial Position:
+	m_Camera = new CameraClass;
+	m_Camera->SetPosition(0.0f, 0.0f, -5.0f);
+
+//	Create and Initialize the Timer that the animation is driven by:
+	m_Timer = new TimerClass;
+
+	result = m_Timer->Initialize();
 	if (!result)
 	{
-		MessageBox(hwnd, L"Could not initialize Direct3D", L"Error", MB_OK);
+		MessageBox(hwnd, L"Could not initialize the Timer Object", L"Error", MB_OK);
 		return false;
 	}
 
-//	Create the Camera Object:
-	m_Camera = new CameraClass;
-
-//	Set the Initial Position of the Camera:
-	m_Camera->SetPosition(0.0f, 0.0f, -5.0f);
+//	The Shader Manager exists from the start so the shaders can be compiled into it before there is a device:
+	m_ShaderManager = new ShaderManagerClass;
 
-//	Create and Initialize the Model Class:
-	m_Model = new ModelClass;
-	
-	result = m_Model->Initialize(m_Direct3D->GetDevice());
+	result = startup.Initialize(STARTUP_THREADS);
 	if (!result)
 	{
-		MessageBox(hwnd, L"Could not open the initializer of model object", L"Error", MB_OK);
+		MessageBox(hwnd, L"Could not initialize the Startup Task Graph", L"Error", MB_OK);
 		return false;
 	}
 
+//	Create Direct3D and give the Shader Manager its device:
+	device = startup.AddTask("direct3d", L"Could not initialize Direct3D", true, [this, screenWidth, screenHeight, hwnd]()
+	{
+		m_Direct3D = new D3DClass;
+		if (!m_Direct3D->Initialize(screenWidth, screenHeight, VSYNC_ENABLED, hwnd, FULL_SCREEN, SCREEN_DEPTH, SCREEN_NEAR, SOFTWARE_RENDERER))
+		{
+			return false;
+		}
+
+		return m_ShaderManager->Initialize(m_Direct3D->GetDevice(), hwnd);
+	});
+
+//	Compile the shaders, which needs no device:
+	colorCompile = startup.AddTask("compile color shaders", L"Could not compile the Color Shaders", false, [this]()
+	{
+		ColorShaderClass::Precompile(m_ShaderManager);
+		return true;
+	});
+
+	terrainCompile = startup.AddTask("compile terrain shaders", L"Could not compile the Terrain Shaders", false, [this]()
+	{
+		TerrainShaderClass::Precompile(m_ShaderManager);
+		return true;
+	});
+
+	shadowCompile = startup.AddTask("compile shadow shaders", L"Could not compile the Shadow Shaders", false, [this]()
+	{
+		if (SHADOWS_ENABLED)
+		{
+			ShadowClass::Precompile(m_ShaderManager);
+		}
+		return true;
+	});
+
+	upscaleCompile = startup.AddTask("compile upscale shaders", L"Could not compile the Upscale Shaders", false, [this]()
+	{
+		if (DYNAMIC_RESOLUTION_ENABLED && !CAPTURE_ENABLED)
+		{
+			DynamicResolutionClass::Precompile(m_ShaderManager);
+		}
+		return true;
+	});
+
+	textCompile = startup.AddTask("compile text shaders", L"Could not compile the Text Shaders", false, [this]()
+	{
+		if (TEXT_ENABLED)
+		{
+			TextClass::Precompile(m_ShaderManager);
+		}
+		return true;
+	});
+
+	spriteCompile = startup.AddTask("compile sprite shaders", L"Could not compile the Sprite Shaders", false, [this]()
+	{
+		if (SPRITE_ENABLED)
+		{
+			SpriteBatchClass::Precompile(m_ShaderManager);
+		}
+		return true;
+	});
+
+#if DEBUG_DRAW_ENABLED
+	debugCompile = startup.AddTask("compile debug shaders", L"Could not compile the Debug Shaders", false, [this]()
+	{
+		DebugDrawClass::Precompile(m_ShaderManager);
+		return true;
+	});
+#endif
+
+//	Open the Scene Package. If it can't be opened it is cooked once the model and the characters exist:
+	sceneOpen = startup.AddTask("open scene package", L"Could not initialize the Scene Package Object", false, [this]()
+	{
+		m_ScenePackage = new ScenePackageClass;
+		m_ScenePackage->Initialize(SCENE_FILE, true);
+		return true;
+	});
+
+//	Create and Initialize the Job System with a worker thread for every core but this one:
+	jobs = startup.AddTask("job system", L"Could not initialize the Job System Object", false, [this]()
+	{
+		m_JobSystem = new JobSystemClass;
+		return m_JobSystem->Initialize(0);
+	});
+
+//	Create the Model Class and the Geometry Heap it keeps its vertices and indices in, then Initialize the model:
+	model = startup.AddTask("model", L"Could not open the initializer of model object", true, [this]()
+	{
+		m_Model = new ModelClass;
+		m_GeometryHeap = new GeometryHeapClass;
+
+		if (!m_GeometryHeap->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetResourceRegistry(), m_Model->GetVertexStride(),
+			GEOMETRY_HEAP_VERTICES, GEOMETRY_HEAP_INDICES, GEOMETRY_DEFRAG_BYTES))
+		{
+			return false;
+		}
+
+		return m_Model->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext(), m_GeometryHeap, MODEL_FILE);
+	});
+	startup.AddDependency(model, device);
+
 //	Create and Initialize the Color Shader Object:
-	m_ColorShader = new ColorShaderClass;
-	
-	result = m_ColorShader->Initialize(m_Direct3D->GetDevice(), hwnd);
+	task = startup.AddTask("color shader", L"Could not initialize the Color Shader Objects", true, [this]()
+	{
+		m_ColorShader = new ColorShaderClass;
+		return m_ColorShader->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetResourceRegistry(), m_ShaderManager);
+	});
+	startup.AddDependency(task, device);
+	startup.AddDependency(task, colorCompile);
+
+//	Create and Initialize the ring buffer that runtime generated geometry is streamed through:
+	task = startup.AddTask("geometry stream", L"Could not initialize the Geometry Stream Object", false, [this]()
+	{
+		m_GeometryStream = new GeometryStreamClass;
+		return m_GeometryStream->Initialize(m_Direct3D->GetDevice(), GEOMETRY_STREAM_SIZE, D3D11_BIND_VERTEX_BUFFER);
+	});
+	startup.AddDependency(task, device);
+
+//	Create and Initialize the Skinned Model with its skeleton and clips:
+	skinnedModel = startup.AddTask("skinned model", L"Could not initialize the Skinned Model Object", false, [this]()
+	{
+		m_SkinnedModel = new SkinnedModelClass;
+		return m_SkinnedModel->Initialize(m_Direct3D->GetDevice());
+	});
+	startup.AddDependency(skinnedModel, device);
+
+//	Create the Animation System and give every character a blend of the two clips, each one starting at
+//	a different time and with a different mix so the crowd does not move in lockstep:
+	animation = startup.AddTask("animation", L"Could not initialize the Animation System Object", false, [this]()
+	{
+		int i, character;
+
+		m_Animation = new AnimationSystemClass;
+		if (!m_Animation->Initialize(m_SkinnedModel->GetSkeleton(), ANIMATED_CHARACTER_COUNT))
+		{
+			return false;
+		}
+
+		for (i = 0; i < ANIMATED_CHARACTER_COUNT; i++)
+		{
+			character = m_Animation->AddCharacter();
+			m_Animation->SetLayer(character, 0, m_SkinnedModel->GetClip(0), 0.13f * (float)i, 1.0f, 1.0f);
+			m_Animation->SetLayer(character, 1, m_SkinnedModel->GetClip(1), 0.07f * (float)i, 0.5f, 0.25f * (float)(i % 4));
+		}
+
+		m_skinnedOffsets.resize(ANIMATED_CHARACTER_COUNT, SKINNED_OFFSET_NONE);
+
+		return true;
+	});
+	startup.AddDependency(animation, skinnedModel);
+
+//	Cook the Scene Package if it could not be opened:
+	sceneCook = startup.AddTask("cook scene package", L"Could not initialize the Scene Package Object", false, [this]()
+	{
+		return InitializeScene();
+	});
+	startup.AddDependency(sceneCook, sceneOpen);
+	startup.AddDependency(sceneCook, model);
+	startup.AddDependency(sceneCook, animation);
+
+//	Create the Entity World with an entity for every object of the scene:
+	entities = startup.AddTask("entities", L"Could not initialize the Entity World Object", true, [this]()
+	{
+		return InitializeEntities();
+	});
+	startup.AddDependency(entities, sceneCook);
+	startup.AddDependency(entities, jobs);
+
+//	Merge the mesh objects of the scene into the Static Batch:
+	if (STATIC_BATCHING)
+	{
+		task = startup.AddTask("static batches", L"Could not initialize the Static Batch Object", true, [this]()
+		{
+			return InitializeStaticBatches();
+		});
+		startup.AddDependency(task, entities);
+	}
+
+//	Create and Initialize the Particle System as a fountain to the right of the triangle. Its particles
+//	fade out as they age, so it is drawn blended and sorted by depth:
+	task = startup.AddTask("particle system", L"Could not initialize the Particle System Object", false, [this]()
+	{
+		ParticleSystemClass::EmitterType emitter;
+
+		emitter.position = XMFLOAT3(2.5f, -2.0f, 3.0f);
+		emitter.velocity = XMFLOAT3(0.0f, 4.0f, 0.0f);
+		emitter.velocitySpread = XMFLOAT3(0.8f, 0.8f, 0.8f);
+		emitter.gravity = XMFLOAT3(0.0f, -2.5f, 0.0f);
+		emitter.emissionRate = 30000.0f;
+		emitter.minLifetime = 1.5f;
+		emitter.maxLifetime = 3.0f;
+		emitter.startSize = 0.04f;
+		emitter.endSize = 0.1f;
+		emitter.startColor = XMFLOAT4(1.0f, 0.9f, 0.4f, 1.0f);
+		emitter.endColor = XMFLOAT4(1.0f, 0.2f, 0.1f, 0.0f);
+		emitter.alphaBlended = true;
+
+		m_ParticleSystem = new ParticleSystemClass;
+		return m_ParticleSystem->Initialize(m_Direct3D->GetDevice(), MAX_PARTICLES, emitter);
+	});
+	startup.AddDependency(task, device);
+
+//	Create and Initialize the Terrain Shader and the Terrain below the rest of the scene. Generating the
+//	terrain file the first time can take a while for large sizes:
+	task = startup.AddTask("terrain shader", L"Could not initialize the Terrain Shader Object", false, [this]()
+	{
+		m_TerrainShader = new TerrainShaderClass;
+		return m_TerrainShader->Initialize(m_Direct3D->GetDevice(), m_ShaderManager);
+	});
+	startup.AddDependency(task, device);
+	startup.AddDependency(task, terrainCompile);
+
+	task = startup.AddTask("terrain", L"Could not initialize the Terrain Object", true, [this, screenHeight]()
+	{
+		m_Terrain = new TerrainClass;
+		return m_Terrain->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetDeviceContext(), m_JobSystem, TERRAIN_FILE, TERRAIN_SIZE, screenHeight,
+			TERRAIN_ERROR_THRESHOLD);
+	});
+	startup.AddDependency(task, device);
+	startup.AddDependency(task, jobs);
+
+//	Create and Initialize the Light Cluster for the lights of the scene. The clusters are cut from the
+//	frustum of the projection the scene is drawn with:
+	task = startup.AddTask("light cluster", L"Could not initialize the Light Cluster Object", false, [this, screenWidth, screenHeight]()
+	{
+		XMMATRIX projectionMatrix;
+
+		m_LightCluster = new LightClusterClass;
+		if (!m_LightCluster->Initialize(m_Direct3D->GetDevice(), LIGHT_COUNT))
+		{
+			return false;
+		}
+
+		m_Direct3D->GetProjectionMatrix(projectionMatrix);
+		m_LightCluster->SetProjection(projectionMatrix, screenWidth, screenHeight);
+		m_LightCluster->SetAmbient(XMFLOAT3(0.25f, 0.25f, 0.3f));
+
+		InitializeLights();
+
+		return true;
+	});
+	startup.AddDependency(task, device);
+
+//	Create and Initialize the BVHs the mouse picks the scene with:
+	picking = startup.AddTask("picking", L"Could not initialize the BVH Objects", true, [this]()
+	{
+		return InitializePicking();
+	});
+	startup.AddDependency(picking, entities);
+
+//	Create and Initialize the Shadow Object with the objects of the scene BVH as its casters:
+	if (SHADOWS_ENABLED)
+	{
+		task = startup.AddTask("shadows", L"Could not initialize the Shadow Object", true, [this]()
+		{
+			return InitializeShadows();
+		});
+		startup.AddDependency(task, picking);
+		startup.AddDependency(task, shadowCompile);
+	}
+
+//	Create and Initialize the offscreen Render Texture and the Frame Capture that reads it back. The
+//	texture has the size and format of the back buffer so captures look like what is on screen:
+	if (CAPTURE_ENABLED)
+	{
+		task = startup.AddTask("render texture", L"Could not initialize the Render Texture Object", false, [this, screenWidth, screenHeight]()
+		{
+			m_RenderTexture = new RenderTextureClass;
+			return m_RenderTexture->Initialize(m_Direct3D->GetDevice(), screenWidth, screenHeight, SCREEN_DEPTH, SCREEN_NEAR, DXGI_FORMAT_R8G8B8A8_UNORM);
+		});
+		startup.AddDependency(task, device);
+
+		task = startup.AddTask("frame capture", L"Could not initialize the Frame Capture Object", false, [this, screenWidth, screenHeight]()
+		{
+			m_FrameCapture = new FrameCaptureClass;
+			return m_FrameCapture->Initialize(m_Direct3D->GetDevice(), screenWidth, screenHeight, CAPTURE_OUTPUT, CAPTURE_GOLDEN);
+		});
+		startup.AddDependency(task, device);
+	}
+
+//	Create and Initialize the Dynamic Resolution the scene is drawn through:
+	if (DYNAMIC_RESOLUTION_ENABLED && !CAPTURE_ENABLED)
+	{
+		task = startup.AddTask("dynamic resolution", L"Could not initialize the Dynamic Resolution Object", true, [this, screenWidth, screenHeight]()
+		{
+			m_DynamicResolution = new DynamicResolutionClass;
+			return m_DynamicResolution->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetResourceRegistry(), m_ShaderManager, screenWidth, screenHeight,
+				SCREEN_DEPTH, SCREEN_NEAR, DYNAMIC_RESOLUTION_TARGET, DYNAMIC_RESOLUTION_MINIMUM, DYNAMIC_RESOLUTION_MAXIMUM);
+		});
+		startup.AddDependency(task, device);
+		startup.AddDependency(task, upscaleCompile);
+	}
+
+//	Create the Font with its atlas and the Text Object that draws with it:
+	if (TEXT_ENABLED)
+	{
+		task = startup.AddTask("text", L"Could not initialize the Text Object", true, [this, screenWidth, screenHeight]()
+		{
+			m_Font = new FontClass;
+			if (!m_Font->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetResourceRegistry(), TEXT_FONT, TEXT_FONT_SIZE))
+			{
+				return false;
+			}
+
+			m_Text = new TextClass;
+			return m_Text->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetResourceRegistry(), m_ShaderManager, m_Font, TEXT_FRAME_GLYPHS,
+				screenWidth, screenHeight);
+		});
+		startup.AddDependency(task, device);
+		startup.AddDependency(task, textCompile);
+	}
+
+//	Create the Sprite Batch with its textures:
+	if (SPRITE_ENABLED)
+	{
+		task = startup.AddTask("sprites", L"Could not initialize the Sprite Batch Object", true, [this, screenWidth, screenHeight]()
+		{
+			return InitializeSprites(screenWidth, screenHeight);
+		});
+		startup.AddDependency(task, device);
+		startup.AddDependency(task, spriteCompile);
+	}
+
+#if DEBUG_DRAW_ENABLED
+//	Create the Debug Draw Object:
+	task = startup.AddTask("debug draw", L"Could not initialize the Debug Draw Object", true, [this]()
+	{
+		m_DebugDraw = new DebugDrawClass;
+		return m_DebugDraw->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetResourceRegistry(), m_ShaderManager, DEBUG_DRAW_MAX_VERTICES);
+	});
+	startup.AddDependency(task, device);
+	startup.AddDependency(task, debugCompile);
+#endif
+
+	result = startup.Run();
+	startup.WriteTimeline(STARTUP_REPORT);
 	if (!result)
 	{
-		MessageBox(hwnd, L"Could not initialize the Color Shader Objects", L"Error", MB_OK);
+		MessageBox(hwnd, startup.GetError(), L"Error", MB_OK);
 		return false;
 	}
 
+	startup.Shutdown();
+
+	m_ColorShader->SetPermutation(GetLightingPermutation());
+	m_TerrainShader->SetPermutation(GetLightingPermutation());
+
+//	The benchmarks run after startup, so they are not part of its timeline:
+	if (MATH_BENCHMARK_COUNT > 0)
+	{
+		MathBenchmarkClass::Run(MATH_BENCHMARK_COUNT, MATH_REPORT);
+	}
+
+	if (MESH_BENCHMARK_SIZE > 0)
+	{
+		result = MeshBenchmarkClass::Run(MESH_BENCHMARK_SIZE, MESH_REPORT);
+		if (!result)
+		{
+			MessageBox(hwnd, L"Could not run the mesh benchmark", L"Error", MB_OK);
+			return false;
+		}
+	}
+
+	if (STATIC_BENCHMARK_OBJECTS > 0)
+	{
+		m_Camera->Render();
+		m_Camera->GetViewMatrix(viewMatrix);
+
+		result = StaticBatchBenchmarkClass::Run(m_Direct3D, m_ColorShader, m_GeometryHeap, m_Model, viewMatrix, STATIC_BENCHMARK_OBJECTS,
+			STATIC_REPORT, [this](StaticBatchClass* staticBatch, XMMATRIX view, XMMATRIX projection)
+		{
+			return RenderStaticBatches(staticBatch, view, projection);
+		});
+		if (!result)
+		{
+			MessageBox(hwnd, L"Could not run the static batching benchmark", L"Error", MB_OK);
+			return false;
+		}
+	}
+
+	if (TEXT_BENCHMARK_STRINGS > 0 && m_Text)
+	{
+		TextBenchmarkClass::Run(m_Text, TEXT_BENCHMARK_STRINGS, TEXT_FRAME_GLYPHS, TEXT_REPORT);
+	}
+
+	if (SPRITE_BENCHMARK_COUNT > 0 && m_SpriteBatch)
+	{
+		result = SpriteBenchmarkClass::Run(m_Direct3D, m_SpriteBatch, SPRITE_BENCHMARK_COUNT, SPRITE_REPORT, [this](int count, float time)
+		{
+			DrawSprites(count, time);
+		});
+		if (!result)
+		{
+			MessageBox(hwnd, L"Could not run the sprite benchmark", L"Error", MB_OK);
+			return false;
+		}
+	}
+
+	if (GEOMETRY_BENCHMARK_MESHES > 0)
+	{
+		m_Camera->Render();
+		m_Camera->GetViewMatrix(viewMatrix);
+
+		result = GeometryBenchmarkClass::Run(m_Direct3D, m_ColorShader, m_Model->GetVertexStride(), viewMatrix, GEOMETRY_BENCHMARK_MESHES,
+			GEOMETRY_DEFRAG_BYTES, GEOMETRY_REPORT);
+		if (!result)
+		{
+			MessageBox(hwnd, L"Could not run the geometry benchmark", L"Error", MB_OK);
+			return false;
+		}
+	}
+
+	if (REPLAY_FILE[0] != 0)
+	{
+		result = ReplayBenchmarkClass::Run(REPLAY_FILE, REPLAY_LOOPS, SOFTWARE_RENDERER, REPLAY_REPORT);
+		if (!result)
+		{
+			MessageBox(hwnd, L"Could not replay the command file", L"Error", MB_OK);
+			return false;
+		}
+	}
+
+//	The statistics start counting after the benchmarks, so the first frame in them is the first one drawn:
+	if (STATS_ENABLED)
+	{
+		m_RenderStats = new RenderStatsClass;
+
+		result = m_RenderStats->Initialize(STATS_WINDOW, STATS_CSV);
+		if (!result)
+		{
+			MessageBox(hwnd, L"Could not initialize the Render Stats Object", L"Error", MB_OK);
+			return false;
+		}
+
+		result = m_Direct3D->BeginRenderStats(m_RenderStats);
+		if (!result)
+		{
+			MessageBox(hwnd, L"Could not start counting the render statistics", L"Error", MB_OK);
+			return false;
+		}
+	}
+
+//	Hand the frames the state the scene starts in, then leave stepping it to the simulation thread. The
+//	timer period is lowered while it runs, or every step would wait for the next tick of the system clock:
+	m_SnapshotBuffer = new TripleBufferClass;
+	m_SnapshotBuffer->Initialize();
+
+	m_PipelineStats = new PipelineStatsClass;
+
+	m_simulationCamera = m_Camera->GetPosition();
+	PublishSnapshot(chrono::high_resolution_clock::now());
+
+	if (SIMULATION_THREADED)
+	{
+		timeBeginPeriod(1);
+
+		m_simulationQuit = false;
+		m_simulationThread = thread(&ApplicationClass::SimulationThread, this);
+	}
+
 	return true;
 }
 
 void ApplicationClass::Shutdown()
 {
+//	Stop the simulation before anything it steps is shut down:
+	if (m_simulationThread.joinable())
+	{
+		m_simulationQuit = true;
+		m_simulationThread.join();
+
+		timeEndPeriod(1);
+	}
+
+	if (m_SnapshotBuffer)
+	{
+		if (m_PipelineStats)
+		{
+			m_PipelineStats->WriteReport(PIPELINE_REPORT, m_SnapshotBuffer, SIMULATION_THREADED, SIMULATION_RATE);
+
+			delete m_PipelineStats;
+			m_PipelineStats = 0;
+		}
+
+		delete m_SnapshotBuffer;
+		m_SnapshotBuffer = 0;
+	}
+
+//	Wait for the captures still on the GPU so the last frames are written too:
+	if (m_FrameCapture)
+	{
+		m_FrameCapture->Flush(m_Direct3D->GetDeviceContext());
+		m_FrameCapture->Shutdown();
+		delete m_FrameCapture;
+		m_FrameCapture = 0;
+	}
+
+	if (m_DynamicResolution)
+	{
+		m_DynamicResolution->Shutdown();
+		delete m_DynamicResolution;
+		m_DynamicResolution = 0;
+	}
+
+#if DEBUG_DRAW_ENABLED
+	if (m_DebugDraw)
+	{
+		m_DebugDraw->Shutdown();
+		delete m_DebugDraw;
+		m_DebugDraw = 0;
+	}
+#endif
+
+	if (m_SpriteBatch)
+	{
+		m_SpriteBatch->Shutdown();
+		delete m_SpriteBatch;
+		m_SpriteBatch = 0;
+	}
+
+	if (m_Text)
+	{
+		m_Text->Shutdown();
+		delete m_Text;
+		m_Text = 0;
+	}
+
+	if (m_Font)
+	{
+		m_Font->Shutdown();
+		delete m_Font;
+		m_Font = 0;
+	}
+
+	if (m_RenderTexture)
+	{
+		m_RenderTexture->Shutdown();
+		delete m_RenderTexture;
+		m_RenderTexture = 0;
+	}
+
+	if (m_Shadow)
+	{
+		m_Shadow->Shutdown();
+		delete m_Shadow;
+		m_Shadow = 0;
+	}
+
+	if (m_LightCluster)
+	{
+		m_LightCluster->Shutdown();
+		delete m_LightCluster;
+		m_LightCluster = 0;
+	}
+
+	if (m_SceneBVH)
+	{
+		m_SceneBVH->Shutdown();
+		delete m_SceneBVH;
+		m_SceneBVH = 0;
+	}
+
+	if (m_MeshBVH)
+	{
+		m_MeshBVH->Shutdown();
+		delete m_MeshBVH;
+		m_MeshBVH = 0;
+	}
+
+	if (m_Terrain)
+	{
+		m_Terrain->Shutdown();
+		delete m_Terrain;
+		m_Terrain = 0;
+	}
+
+	if (m_TerrainShader)
+	{
+		m_TerrainShader->Shutdown();
+		delete m_TerrainShader;
+		m_TerrainShader = 0;
+	}
+
+	if (m_ParticleSystem)
+	{
+		m_ParticleSystem->Shutdown();
+		delete m_ParticleSystem;
+		m_ParticleSystem = 0;
+	}
+
+	if (m_StaticBatch)
+	{
+		m_StaticBatch->Shutdown();
+		delete m_StaticBatch;
+		m_StaticBatch = 0;
+	}
+
+	if (m_Entities)
+	{
+		m_Entities->Shutdown();
+		delete m_Entities;
+		m_Entities = 0;
+	}
+
+//	The systems of the world call into the Scene Systems Object, so it goes after the world:
+	if (m_SceneSystems)
+	{
+		delete m_SceneSystems;
+		m_SceneSystems = 0;
+	}
+
+	if (m_ScenePackage)
+	{
+		m_ScenePackage->Shutdown();
+		delete m_ScenePackage;
+		m_ScenePackage = 0;
+	}
+
+	if (m_Animation)
+	{
+		m_Animation->Shutdown();
+		delete m_Animation;
+		m_Animation = 0;
+	}
+
+	if (m_SkinnedModel)
+	{
+		m_SkinnedModel->Shutdown();
+		delete m_SkinnedModel;
+		m_SkinnedModel = 0;
+	}
+
+	if (m_JobSystem)
+	{
+		m_JobSystem->Shutdown();
+		delete m_JobSystem;
+		m_JobSystem = 0;
+	}
+
+	if (m_Timer)
+	{
+		delete m_Timer;
+		m_Timer = 0;
+	}
+
+	if (m_GeometryStream)
+	{
+		m_GeometryStream->Shutdown();
+		delete m_GeometryStream;
+		m_GeometryStream = 0;
+	}
+
 	if (m_ColorShader)
 	{
 		m_ColorShader->Shutdown();
@@ -68,6 +785,13 @@ void ApplicationClass::Shutdown()
 		m_ColorShader = 0;
 	}
 
+	if (m_ShaderManager)
+	{
+		m_ShaderManager->Shutdown();
+		delete m_ShaderManager;
+		m_ShaderManager = 0;
+	}
+
 	if (m_Model)
 	{
 		m_Model->Shutdown();
@@ -75,6 +799,13 @@ void ApplicationClass::Shutdown()
 		m_Model = 0;
 	}
 
+	if (m_GeometryHeap)
+	{
+		m_GeometryHeap->Shutdown();
+		delete m_GeometryHeap;
+		m_GeometryHeap = 0;
+	}
+
 	if (m_Camera)
 	{
 		delete m_Camera;
@@ -88,57 +819,1364 @@ void ApplicationClass::Shutdown()
 		m_Direct3D = 0;
 	}
 
+//	The statistics go last, since everything shut down before Direct3D still draws through the Stats Context:
+	if (m_RenderStats)
+	{
+		m_RenderStats->Shutdown();
+		delete m_RenderStats;
+		m_RenderStats = 0;
+	}
+
 	return;
 }
 
 bool ApplicationClass::Frame()
 {
+	chrono::high_resolution_clock::time_point start;
+	float latency;
 	bool result;
 
+	m_Timer->Frame();
+
+//	Without the simulation thread the scene is stepped here by the time the last frame took:
+	if (!SIMULATION_THREADED)
+	{
+		start = chrono::high_resolution_clock::now();
+		Simulate(m_Timer->GetTime() / 1000.0f);
+		PublishSnapshot(start);
+	}
+
+//	Draw from the newest state of the simulation. The particles are only for show and nothing reads them
+//	back, so they are still advanced here by the time of the frame:
+	ApplySnapshot();
+	m_ParticleSystem->Update(m_JobSystem, m_Timer->GetTime() / 1000.0f);
+
+//	Start recording the commands of the frames to capture. A capture that can't be started is not worth
+//	stopping for, so the frame goes on without it:
+	if (COMMAND_CAPTURE_FRAME > 0 && m_frameNumber == COMMAND_CAPTURE_FRAME)
+	{
+		m_Direct3D->BeginCommandCapture(COMMAND_CAPTURE_FILE);
+	}
+
 	result = Render();
 	if (!result)
 	{
 		return false;
 	}
 
+	m_Direct3D->EndCommandFrame();
+	if (COMMAND_CAPTURE_FRAME > 0 && m_frameNumber == COMMAND_CAPTURE_FRAME + COMMAND_CAPTURE_FRAMES)
+	{
+		m_Direct3D->EndCommandCapture();
+	}
+
+//	The latency runs from the start of the step the frame was drawn from until the frame has been presented
+//	and, with the step only partly blended in, until it would have been all the way:
+	latency = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - m_snapshotStart).count();
+	latency += (1.0f - m_snapshotAlpha) * 1000.0f / (float)SIMULATION_RATE;
+
+	m_PipelineStats->AddFrame(latency);
+
+	if (m_RenderStats)
+	{
+		m_RenderStats->Add(STAT_LATENCY, latency);
+		UpdateRenderStats();
+	}
+
+	if (!m_firstFrameReported)
+	{
+		TaskGraphClass::WriteFirstFrame(STARTUP_REPORT, chrono::duration<float, milli>(chrono::high_resolution_clock::now() - m_startTime).count());
+		m_firstFrameReported = true;
+	}
+
 	return true;
 }
 
-//	It still b egins with clearing the scene except that it is cleared to black. After that it calls the
-//	Render function for the Cameraobject to create a View Matrix based on the Camera's location that was set
-//	in the Initialize function. Once the view matrix is created, we get a copy of it from the Camera Class
-//	We also get copies of the world and projection matrix from the D3DClass object. We then call the 
-//	ModelClass::Render function to put the green triangle model geometry on the graphics pipeline. With the
-//	vertices now prepared we call the Color Shader to draw the Vertices using hte Model Information and the
-//	three matrices for positioning each vertex. The green triangle is now drawn to the Back Buffer. With that
-//	the scene is complete and we call EndScene to display it to the green.2
-bool ApplicationClass::Render()
+//	Simulate steps everything the frames only look at: the characters, the lights, the systems of the
+//	entities over their new poses, the boxes of the scene BVH and the last pick.
+void ApplicationClass::Simulate(float stepTime)
 {
-	XMMATRIX worldMatrix, viewMatrix, projectionMatrix;
-	bool result;
+	m_Animation->Update(m_JobSystem, stepTime);
+
+	if (CLUSTERED_LIGHTING)
+	{
+		UpdateLights(stepTime);
+	}
 
-//	Clear the buffers to begin the scene:
-	m_Direct3D->BeginScene(0.0f, 0.0f, 0.0f, 1.0f);
+	m_Entities->RunSystems(m_JobSystem);
+	UpdatePicking();
+	ApplyPick();
 
-//	Generate the View Matrix based on the Camera's Position:
-	m_Camera->Render();
+	return;
+}
 
-//	Get the world, view and projection matrices from the camera and d3d objects:
-	m_Direct3D->GetWorldMatrix(worldMatrix);
-	m_Camera->GetViewMatrix(viewMatrix);
-	m_Direct3D->GetProjectionMatrix(projectionMatrix);
+//	PublishSnapshot copies the state of the simulation into the slot it writes next, along with the state
+//	it last published, and publishes it. The first snapshot has no step before it, so it starts where it ends.
+void ApplicationClass::PublishSnapshot(chrono::high_resolution_clock::time_point start)
+{
+	SnapshotType* snapshot;
+	int i;
 
-//	Put the Model Vertex and Index Buffers on the Graphics Pilepine to prepare them for drawing:
-	m_Model->Render(m_Direct3D->GetDeviceContext());
+	snapshot = &m_snapshots[m_SnapshotBuffer->GetWriteSlot()];
+	snapshot->start = start;
+	snapshot->cameraPosition = m_simulationCamera;
 
-//	Render the model using the Color Shader:
-	result = m_ColorShader->Render(m_Direct3D->GetDeviceContext(), m_Model->GetIndexCount(), worldMatrix, viewMatrix, projectionMatrix);
-	if (!result)
+	snapshot->transforms.resize(m_sceneEntities.size());
+	snapshot->renderables.resize(m_sceneEntities.size());
+	snapshot->bounds.resize(m_sceneEntities.size());
+	for (i = 0; i < (int)m_sceneEntities.size(); i++)
 	{
-		return false;
+		snapshot->transforms[i] = *(TransformType*)m_Entities->GetComponent(m_sceneEntities[i], m_transformComponent);
+		snapshot->renderables[i] = *(RenderableType*)m_Entities->GetComponent(m_sceneEntities[i], m_renderableComponent);
+		snapshot->bounds[i] = *(EntityBoundsType*)m_Entities->GetComponent(m_sceneEntities[i], m_boundsComponent);
 	}
 
-	m_Direct3D->EndScene();
-	
-	return true;
-}
\ No newline at end of file
+	snapshot->palettes.clear();
+	if (m_Animation->GetCharacterCount() > 0)
+	{
+		snapshot->palettes.assign(m_Animation->GetPalette(0), m_Animation->GetPalette(0) + (size_t)m_Animation->GetCharacterCount() * m_Animation->GetJointCount());
+	}
+
+	snapshot->lights = m_lights;
+
+	if (m_SnapshotBuffer->GetPublishCount() == 0)
+	{
+		m_publishedCamera = snapshot->cameraPosition;
+		m_publishedTransforms = snapshot->transforms;
+		m_publishedLightPositions.resize(m_lights.size());
+		for (i = 0; i < (int)m_lights.size(); i++)
+		{
+			m_publishedLightPositions[i] = m_lights[i].position;
+		}
+	}
+
+	snapshot->previousCameraPosition = m_publishedCamera;
+	snapshot->previousTransforms = m_publishedTransforms;
+	snapshot->previousLightPositions = m_publishedLightPositions;
+
+	m_publishedCamera = snapshot->cameraPosition;
+	m_publishedTransforms = snapshot->transforms;
+	for (i = 0; i < (int)m_lights.size(); i++)
+	{
+		m_publishedLightPositions[i] = m_lights[i].position;
+	}
+
+	snapshot->published = chrono::high_resolution_clock::now();
+	m_SnapshotBuffer->Publish();
+
+	return;
+}
+
+//	ApplySnapshot takes the newest snapshot, if one was published since the last frame, and blends its two
+//	states by how far into the next step the frame is, so the frames between steps still move smoothly at
+//	one step behind the simulation. Transforms that didn't change keep the world matrix of the snapshot. The
+//	palettes are taken as they are, since blending matrices would shear the joints.
+void ApplicationClass::ApplySnapshot()
+{
+	SnapshotType* snapshot;
+	TransformType transform;
+	XMFLOAT3 cameraPosition;
+	float alpha;
+	int i;
+
+	if (!m_SnapshotBuffer->Acquire())
+	{
+		m_PipelineStats->AddRepeatedFrame();
+	}
+	snapshot = &m_snapshots[m_SnapshotBuffer->GetReadSlot()];
+
+	alpha = 1.0f;
+	if (SIMULATION_THREADED)
+	{
+		alpha = chrono::duration<float>(chrono::high_resolution_clock::now() - snapshot->published).count() * (float)SIMULATION_RATE;
+		alpha = alpha < 1.0f ? alpha : 1.0f;
+	}
+
+	cameraPosition = LerpFloat3(snapshot->previousCameraPosition, snapshot->cameraPosition, alpha);
+	m_Camera->SetPosition(cameraPosition.x, cameraPosition.y, cameraPosition.z);
+
+	m_renderWorlds.resize(snapshot->transforms.size());
+	for (i = 0; i < (int)snapshot->transforms.size(); i++)
+	{
+		if (memcmp(&snapshot->previousTransforms[i], &snapshot->transforms[i], sizeof(XMFLOAT3) + sizeof(float)) == 0)
+		{
+			m_renderWorlds[i] = snapshot->transforms[i].world;
+			continue;
+		}
+
+		transform.position = LerpFloat3(snapshot->previousTransforms[i].position, snapshot->transforms[i].position, alpha);
+		transform.scale = snapshot->previousTransforms[i].scale + (snapshot->transforms[i].scale - snapshot->previousTransforms[i].scale) * alpha;
+		SceneSystemsClass::UpdateWorldMatrix(transform);
+		m_renderWorlds[i] = transform.world;
+	}
+
+	m_renderLights = snapshot->lights;
+	for (i = 0; i < (int)m_renderLights.size(); i++)
+	{
+		m_renderLights[i].position = LerpFloat3(snapshot->previousLightPositions[i], snapshot->lights[i].position, alpha);
+	}
+
+	m_renderPalettes = snapshot->palettes.data();
+	m_renderRenderables = snapshot->renderables.data();
+	m_renderBounds = snapshot->bounds.data();
+	m_snapshotStart = snapshot->start;
+	m_snapshotAlpha = alpha;
+
+	return;
+}
+
+//	SimulationThread steps the simulation SIMULATION_RATE times a second until it is told to quit. When it
+//	falls more than a few steps behind it gives them up rather than running them all back to back.
+void ApplicationClass::SimulationThread()
+{
+	chrono::high_resolution_clock::time_point start, next;
+	chrono::high_resolution_clock::duration step;
+
+	step = chrono::duration_cast<chrono::high_resolution_clock::duration>(chrono::duration<double>(1.0 / (double)SIMULATION_RATE));
+	next = chrono::high_resolution_clock::now();
+
+	while (!m_simulationQuit)
+	{
+		start = chrono::high_resolution_clock::now();
+		Simulate(1.0f / (float)SIMULATION_RATE);
+		PublishSnapshot(start);
+
+		next += step;
+		if (chrono::high_resolution_clock::now() - next > step * 4)
+		{
+			next = chrono::high_resolution_clock::now();
+		}
+
+		this_thread::sleep_until(next);
+	}
+
+	return;
+}
+
+//	UpdateRenderStats adds what the device context can't see to the counters of the frame and ends it. The
+//	culled objects are the ranges the Static Batch left out of its last cull and the casters the shadow
+//	cascades didn't queue, and the memory is what the Resource Registry, the Geometry Stream and the terrain
+//	hold. The overlay is drawn by RenderText from the text kept here, or put in the window title without text.
+void ApplicationClass::UpdateRenderStats()
+{
+	wchar_t title[256];
+	double culled, memory;
+	int cascade;
+
+	m_RenderStats->Add(STAT_FRAME_TIME, m_Timer->GetTime());
+	m_RenderStats->Add(STAT_UPLOAD_BYTES, m_GeometryStream->GetFrameBytes());
+
+	culled = 0.0;
+	if (m_StaticBatch)
+	{
+		culled += m_StaticBatch->GetRangeCount() - m_StaticBatch->GetVisibleRangeCount();
+	}
+
+	if (m_Shadow)
+	{
+		for (cascade = 0; cascade < m_Shadow->GetCascadeCount(); cascade++)
+		{
+			culled += m_Shadow->GetCasterCount() - m_Shadow->GetQueueSize(cascade);
+		}
+	}
+	m_RenderStats->Add(STAT_CULLED_OBJECTS, culled);
+
+	memory = (double)m_Direct3D->GetResourceRegistry()->GetResourceBytes() + m_GeometryStream->GetBufferSize();
+	if (m_Terrain)
+	{
+		memory += m_Terrain->GetMemoryUsage();
+	}
+	m_RenderStats->Set(STAT_MEMORY_BYTES, memory);
+
+	m_RenderStats->EndFrame();
+
+	if (m_RenderStats->GetFrameCount() % STATS_EXPORT_INTERVAL == 0)
+	{
+		m_RenderStats->WriteJSON(STATS_JSON);
+
+		if (STATS_OVERLAY && m_Text)
+		{
+			sprintf_s(m_statsText, 512, "%.2f ms (p99 %.2f)  latency %.1f ms\n%.0f draws  %.0f prims  %.0f binds\n%.0f KB up  %.0f culled  %.1f MB",
+				m_RenderStats->GetMean(STAT_FRAME_TIME), m_RenderStats->GetPercentile(STAT_FRAME_TIME, 0.99f), m_RenderStats->GetMean(STAT_LATENCY),
+				m_RenderStats->GetMean(STAT_DRAWS), m_RenderStats->GetMean(STAT_PRIMITIVES), m_RenderStats->GetMean(STAT_STATE_BINDS),
+				m_RenderStats->GetMean(STAT_UPLOAD_BYTES) / 1024.0, m_RenderStats->GetMean(STAT_CULLED_OBJECTS),
+				m_RenderStats->GetLast(STAT_MEMORY_BYTES) / (1024.0 * 1024.0));
+		}
+		else if (STATS_OVERLAY)
+		{
+			swprintf_s(title, 256, L"%.2f ms (p99 %.2f)  %.0f draws  %.0f prims  %.0f binds  %.0f KB up  %.0f culled  %.1f MB",
+				m_RenderStats->GetMean(STAT_FRAME_TIME), m_RenderStats->GetPercentile(STAT_FRAME_TIME, 0.99f),
+				m_RenderStats->GetMean(STAT_DRAWS), m_RenderStats->GetMean(STAT_PRIMITIVES), m_RenderStats->GetMean(STAT_STATE_BINDS),
+				m_RenderStats->GetMean(STAT_UPLOAD_BYTES) / 1024.0, m_RenderStats->GetMean(STAT_CULLED_OBJECTS),
+				m_RenderStats->GetLast(STAT_MEMORY_BYTES) / (1024.0 * 1024.0));
+			SetWindowText(m_hwnd, title);
+		}
+	}
+
+	return;
+}
+
+//	RenderText draws the text of the frame over whatever is on the back buffer, with blending on and the
+//	depth test off, then puts both back the way the scene is drawn.
+bool ApplicationClass::RenderText()
+{
+	XMMATRIX orthoMatrix;
+	bool result;
+
+	if (STATS_OVERLAY && m_statsText[0] != 0)
+	{
+		m_Text->AddText(8.0f, 8.0f, m_statsText, XMFLOAT4(1.0f, 1.0f, 0.6f, 1.0f));
+	}
+
+	m_Direct3D->GetOrthoMatrix(orthoMatrix);
+
+	m_Direct3D->TurnOffDepthTest();
+	m_Direct3D->TurnOnAlphaBlending();
+
+	result = m_Text->Render(m_Direct3D->GetDeviceContext(), orthoMatrix);
+
+	m_Direct3D->TurnOffAlphaBlending();
+	m_Direct3D->TurnOnDepthWrites();
+
+	return result;
+}
+
+//	Render draws a frame from the snapshot ApplySnapshot took. It first does everything the scene needs before
+//	it is drawn: it writes the skinned characters and the particles into the Geometry Stream, picks the terrain
+//	chunks, culls the lights into their clusters, and draws the shadow cascades. Then it clears the target,
+//	draws the scene with RenderScene and, with dynamic resolution, stretches it over the back buffer. The
+//	sprites and the text go over the finished frame before it is presented.
+bool ApplicationClass::Render()
+{
+	XMMATRIX viewMatrix, projectionMatrix;
+	TransformType transform;
+	EntityBoundsType bounds;
+	int i;
+	bool result;
+
+//	Start timing the frame on the GPU for the Dynamic Resolution:
+	if (m_DynamicResolution)
+	{
+		m_DynamicResolution->BeginFrame(m_Direct3D->GetDeviceContext());
+	}
+
+//	Generate the View Matrix based on the Camera's Position:
+	m_Camera->Render();
+
+//	Close up some of the free space in the Geometry Heap before anything is drawn from it:
+	m_GeometryHeap->Defragment(m_Direct3D->GetDeviceContext(), GEOMETRY_DEFRAG_BYTES);
+
+//	Map the Geometry Stream so this frame's runtime geometry can be written into it. It must be
+//	unmapped again before anything that reads from it is drawn:
+	result = m_GeometryStream->BeginFrame(m_Direct3D->GetDeviceContext());
+	if (!result)
+	{
+		return false;
+	}
+
+	m_Camera->GetViewMatrix(viewMatrix);
+	m_Direct3D->GetProjectionMatrix(projectionMatrix);
+
+	if (CPU_SKINNING)
+	{
+		SkinCharacters();
+	}
+
+	m_particlesWritten = m_ParticleSystem->WriteInstances(m_JobSystem, m_GeometryStream, viewMatrix);
+
+	m_GeometryStream->EndFrame(m_Direct3D->GetDeviceContext());
+
+//	Bring in the terrain chunks that finished loading and pick the ones to draw from here:
+	m_Terrain->Frame(m_Direct3D->GetDeviceContext(), m_Camera->GetPosition(), viewMatrix, projectionMatrix);
+
+//	Sort the lights into the clusters of this view and hand the lists to the pixel shader:
+	if (CLUSTERED_LIGHTING)
+	{
+		m_LightCluster->Cull(m_JobSystem, m_renderLights.data(), (int)m_renderLights.size(), viewMatrix);
+
+//	The clusters are found from the pixel position, so they have to know the size the scene is drawn at:
+		if (m_DynamicResolution)
+		{
+			m_LightCluster->SetScreenSize(m_DynamicResolution->GetWidth(), m_DynamicResolution->GetHeight());
+		}
+
+		result = m_LightCluster->Render(m_Direct3D->GetDeviceContext());
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+//	Move every caster to the box of its object where this frame draws it, from the local box of the snapshot
+//	and the blended world matrix. Then fit the shadow cascades to this view, draw their casters and hand the
+//	shadow maps to the pixel shader:
+	if (m_Shadow)
+	{
+		for (i = 0; i < (int)m_renderWorlds.size(); i++)
+		{
+			transform.world = m_renderWorlds[i];
+			bounds = m_renderBounds[i];
+			SceneSystemsClass::UpdateWorldBounds(transform, bounds);
+			m_Shadow->SetCasterBounds(i, bounds.world.minimum, bounds.world.maximum);
+		}
+
+		m_Shadow->Update(m_JobSystem, viewMatrix, projectionMatrix);
+
+		result = RenderShadows();
+		if (!result)
+		{
+			return false;
+		}
+
+		result = m_Shadow->Render(m_Direct3D->GetDeviceContext());
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+//	Every so often render the frame into the Render Texture first and capture it:
+	if (m_FrameCapture)
+	{
+		if (m_frameNumber % CAPTURE_INTERVAL == 0)
+		{
+			result = RenderCapture(viewMatrix);
+			if (!result)
+			{
+				return false;
+			}
+		}
+
+//	Hand the captures the GPU has finished with to the writer thread:
+		m_FrameCapture->Update(m_Direct3D->GetDeviceContext());
+	}
+
+	m_frameNumber++;
+
+//	Clear the buffers to begin the scene, which with dynamic resolution are those of its render target:
+	if (m_DynamicResolution)
+	{
+		m_DynamicResolution->BeginScene(m_Direct3D->GetDeviceContext(), 0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	else
+	{
+		m_Direct3D->BeginScene(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+
+	result = RenderScene(viewMatrix, projectionMatrix);
+	if (!result)
+	{
+		return false;
+	}
+
+#if DEBUG_DRAW_ENABLED
+//	Draw the debug lines into the scene, where its depth buffer can still hide them:
+	if (m_DebugDraw)
+	{
+		result = RenderDebugDraw(viewMatrix, projectionMatrix);
+		if (!result)
+		{
+			return false;
+		}
+	}
+#endif
+
+//	Stretch the scene over the back buffer and pick the scale of the frames to come:
+	if (m_DynamicResolution)
+	{
+		m_Direct3D->SetBackBufferRenderTarget();
+		m_Direct3D->ResetViewport();
+		m_Direct3D->BeginScene(0.0f, 0.0f, 0.0f, 1.0f);
+
+		result = m_DynamicResolution->Upscale(m_Direct3D->GetDeviceContext());
+		if (!result)
+		{
+			return false;
+		}
+
+		m_DynamicResolution->EndFrame(m_Direct3D->GetDeviceContext());
+	}
+
+//	Draw the sprites and then the text over the finished frame, at the size of the screen:
+	if (m_SpriteBatch)
+	{
+		result = RenderSprites();
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	if (m_Text)
+	{
+		result = RenderText();
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+//	Fence the Geometry Stream behind the last draw that reads from it before the frame is presented:
+	m_GeometryStream->Fence(m_Direct3D->GetDeviceContext());
+
+	m_Direct3D->EndScene();
+	
+	return true;
+}
+
+//	RenderScene draws everything in the scene to whatever render target is currently set. The objects are
+//	drawn with the renderables and world matrices of the snapshot, since the simulation may be moving them meanwhile.
+bool ApplicationClass::RenderScene(XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+{
+	int i, indexCount, startIndex, baseVertex;
+	bool result;
+
+//	Draw the batched meshes first, then every other object using the Color Shader:
+	if (m_StaticBatch)
+	{
+		result = RenderStaticBatches(m_StaticBatch, viewMatrix, projectionMatrix);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	for (i = 0; i < (int)m_renderWorlds.size(); i++)
+	{
+		if (m_renderRenderables[i].kind == RENDERABLE_BATCHED || !SetRenderable(m_renderRenderables[i], indexCount, startIndex, baseVertex))
+		{
+			continue;
+		}
+
+		result = m_ColorShader->Render(m_Direct3D->GetDeviceContext(), indexCount, startIndex, baseVertex,
+			XMLoadFloat4x4(&m_renderWorlds[i]), viewMatrix, projectionMatrix);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	result = m_Terrain->Render(m_Direct3D->GetDeviceContext(), m_TerrainShader, viewMatrix, projectionMatrix);
+	if (!result)
+	{
+		return false;
+	}
+
+//	Blended geometry goes last, after everything solid it can be seen through:
+	result = RenderParticles(viewMatrix, projectionMatrix);
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+//	SkinCharacters deforms the model for every character on the job threads. The Geometry Stream hands
+//	out space to all of them at once, so the only thing the batches share is its atomic cursor. The poses are
+//	the palettes of the snapshot.
+void ApplicationClass::SkinCharacters()
+{
+	m_JobSystem->ParallelFor(m_Animation->GetCharacterCount(), ANIMATION_BATCH_SIZE, [this](int begin, int end)
+	{
+		unsigned int offset;
+		int i;
+
+		for (i = begin; i < end; i++)
+		{
+			m_skinnedOffsets[i] = m_SkinnedModel->Skin(m_renderPalettes + (size_t)i * m_Animation->GetJointCount(), m_GeometryStream, offset) ?
+				offset : SKINNED_OFFSET_NONE;
+		}
+	});
+
+	return;
+}
+
+//	RenderCapture renders the scene into the Render Texture, queues its readback and then points
+//	rendering back at the back buffer. If the readback ring is full the capture is skipped.
+bool ApplicationClass::RenderCapture(XMMATRIX viewMatrix)
+{
+	XMMATRIX projectionMatrix;
+	bool result;
+
+	m_RenderTexture->SetRenderTarget(m_Direct3D->GetDeviceContext());
+	m_RenderTexture->ClearRenderTarget(m_Direct3D->GetDeviceContext(), 0.0f, 0.0f, 0.0f, 1.0f);
+
+	m_RenderTexture->GetProjectionMatrix(projectionMatrix);
+
+	result = RenderScene(viewMatrix, projectionMatrix);
+	if (!result)
+	{
+		return false;
+	}
+
+	m_FrameCapture->Capture(m_Direct3D->GetDeviceContext(), m_RenderTexture->GetTexture(), m_frameNumber);
+
+	m_Direct3D->SetBackBufferRenderTarget();
+	m_Direct3D->ResetViewport();
+
+	return true;
+}
+
+//	RenderParticles draws all particles with one instanced draw call. Blended particles are drawn without
+//	writing depth, so the ones behind still show through the ones in front that were drawn later.
+bool ApplicationClass::RenderParticles(XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+{
+	bool result;
+
+	if (!m_particlesWritten || m_ParticleSystem->GetInstanceCount() == 0)
+	{
+		return true;
+	}
+
+	if (m_ParticleSystem->IsAlphaBlended())
+	{
+		m_Direct3D->TurnOnAlphaBlending();
+		m_Direct3D->TurnOffDepthWrites();
+	}
+
+	m_ParticleSystem->Render(m_Direct3D->GetDeviceContext(), m_GeometryStream);
+
+//	The particles glow on their own, so they are not lit:
+	m_ColorShader->SetPermutation(SHADER_INSTANCED);
+	result = m_ColorShader->RenderInstanced(m_Direct3D->GetDeviceContext(), m_ParticleSystem->GetIndexCount(), m_ParticleSystem->GetInstanceCount(), viewMatrix, projectionMatrix);
+	m_ColorShader->SetPermutation(GetLightingPermutation());
+
+	if (m_ParticleSystem->IsAlphaBlended())
+	{
+		m_Direct3D->TurnOnDepthWrites();
+		m_Direct3D->TurnOffAlphaBlending();
+	}
+
+	return result;
+}
+
+//	Pick casts a ray from the camera through the mouse position. The scene BVH belongs to the simulation,
+//	so the ray is only handed to it here, and the next step finds what it hits.
+void ApplicationClass::Pick(int mouseX, int mouseY)
+{
+	XMMATRIX projectionMatrix;
+	XMVECTOR origin, direction;
+
+	m_Direct3D->GetProjectionMatrix(projectionMatrix);
+	m_Camera->GetPickingRay(mouseX, mouseY, m_screenWidth, m_screenHeight, projectionMatrix, origin, direction);
+
+	{
+		lock_guard<mutex> lock(m_pickMutex);
+		XMStoreFloat3(&m_pickOrigin, origin);
+		XMStoreFloat3(&m_pickDirection, direction);
+		m_pickPending = true;
+	}
+
+	return;
+}
+
+//	ApplyPick finds the closest thing the last ray handed over by Pick hits. A picked character plays the
+//	second clip over the first one until another character is picked.
+void ApplicationClass::ApplyPick()
+{
+	XMFLOAT3 origin, direction;
+	BVHClass::HitType hit;
+	RenderableType* renderable;
+	int character, i;
+	bool pending;
+
+	{
+		lock_guard<mutex> lock(m_pickMutex);
+		pending = m_pickPending;
+		origin = m_pickOrigin;
+		direction = m_pickDirection;
+		m_pickPending = false;
+	}
+	if (!pending)
+	{
+		return;
+	}
+
+	m_SceneBVH->Intersect(XMLoadFloat3(&origin), XMLoadFloat3(&direction), SCREEN_DEPTH, hit);
+
+//	The objects are the entities of the scene, and only a character entity can be picked:
+	character = -1;
+	if (hit.primitive >= 0)
+	{
+		renderable = (RenderableType*)m_Entities->GetComponent(m_sceneEntities[hit.primitive], m_renderableComponent);
+		if (renderable->kind == RENDERABLE_CHARACTER)
+		{
+			character = renderable->index;
+		}
+	}
+	if (character == m_pickedCharacter)
+	{
+		return;
+	}
+
+	if (m_pickedCharacter >= 0)
+	{
+		i = m_pickedCharacter;
+		m_Animation->SetLayer(i, 1, m_SkinnedModel->GetClip(1), 0.07f * (float)i, 0.5f, 0.25f * (float)(i % 4));
+	}
+
+	if (character >= 0)
+	{
+		m_Animation->SetLayer(character, 1, m_SkinnedModel->GetClip(1), 0.0f, 1.0f, 2.0f);
+	}
+
+	m_pickedCharacter = character;
+
+	return;
+}
+
+//	InitializePicking builds a BVH over the triangles of the model and a BVH over the objects of the scene,
+//	from the world boxes of their entities. The scene BVH only knows the boxes of the objects, its intersect
+//	function tests the objects showing the model against the triangle BVH, with the ray moved into the space
+//	of the model, and the characters against their boxes.
+bool ApplicationClass::InitializePicking()
+{
+	EntityBoundsType* bounds;
+	int i;
+	bool result;
+
+	m_MeshBVH = new BVHClass;
+
+	result = m_MeshBVH->BuildTriangles(m_JobSystem, m_Model->GetPositions(), m_Model->GetIndices(), m_Model->GetIndexCount() / 3);
+	if (!result)
+	{
+		return false;
+	}
+
+	m_sceneBounds.resize(m_sceneEntities.size());
+	for (i = 0; i < (int)m_sceneEntities.size(); i++)
+	{
+		bounds = (EntityBoundsType*)m_Entities->GetComponent(m_sceneEntities[i], m_boundsComponent);
+		m_sceneBounds[i] = bounds->world;
+	}
+
+	m_SceneBVH = new BVHClass;
+
+	result = m_SceneBVH->BuildBounds(m_JobSystem, m_sceneBounds.data(), (int)m_sceneBounds.size());
+	if (!result)
+	{
+		return false;
+	}
+
+	m_SceneBVH->SetIntersectFunction([this](int object, FXMVECTOR origin, FXMVECTOR direction, float maxDistance, float& distance)
+	{
+		BVHClass::HitType hit;
+		TransformType* transform;
+		RenderableType* renderable;
+		XMVECTOR localOrigin, localDirection;
+		float inverseScale;
+
+		renderable = (RenderableType*)m_Entities->GetComponent(m_sceneEntities[object], m_renderableComponent);
+		if (renderable->kind == RENDERABLE_CHARACTER)
+		{
+			return BVHClass::IntersectBounds(m_sceneBounds[object], origin, direction, maxDistance, distance);
+		}
+
+//	Scaling the origin and the direction alike keeps the distance along the ray the same in both spaces:
+		transform = (TransformType*)m_Entities->GetComponent(m_sceneEntities[object], m_transformComponent);
+		inverseScale = 1.0f / transform->scale;
+		localOrigin = XMVectorScale(XMVectorSubtract(origin, XMLoadFloat3(&transform->position)), inverseScale);
+		localDirection = XMVectorScale(direction, inverseScale);
+
+		if (!m_MeshBVH->Intersect(localOrigin, localDirection, maxDistance, hit))
+		{
+			return false;
+		}
+
+		distance = hit.distance;
+		return true;
+	});
+
+	UpdatePicking();
+
+	return true;
+}
+
+//	UpdatePicking copies the world box the bounds system gave every entity into the scene BVH and refits it.
+void ApplicationClass::UpdatePicking()
+{
+	m_Entities->ForEachChunk((1u << m_renderableComponent) | (1u << m_boundsComponent), [this](const EntityWorldClass::ChunkViewType& chunk)
+	{
+		RenderableType* renderables;
+		EntityBoundsType* bounds;
+		int i;
+
+		renderables = (RenderableType*)chunk.components[m_renderableComponent];
+		bounds = (EntityBoundsType*)chunk.components[m_boundsComponent];
+
+		for (i = 0; i < chunk.count; i++)
+		{
+			m_sceneBounds[renderables[i].object] = bounds[i].world;
+			m_SceneBVH->UpdateBounds(renderables[i].object, bounds[i].world);
+		}
+	});
+
+	m_SceneBVH->Refit();
+
+	return;
+}
+
+//	GetCharacterPosition places the characters in rows of eight behind the triangle.
+XMFLOAT3 ApplicationClass::GetCharacterPosition(int character)
+{
+	return XMFLOAT3(-4.9f + 1.4f * (float)(character % 8), -3.0f, 6.0f + 4.0f * (float)(character / 8));
+}
+
+//	InitializeLights scatters the lights over the terrain in front of the camera, a quarter of them spot
+//	lights shining down. Every light circles its own point, the orbit keeps the point and the angular speed.
+void ApplicationClass::InitializeLights()
+{
+	LightClusterClass::LightType* light;
+	unsigned int seed;
+	int i;
+
+	seed = 7;
+	auto random = [&seed]()
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (float)(seed >> 8) / 16777216.0f;
+	};
+
+	m_lights.resize(LIGHT_COUNT);
+	m_lightOrbits.resize(LIGHT_COUNT);
+	for (i = 0; i < LIGHT_COUNT; i++)
+	{
+		m_lightOrbits[i] = XMFLOAT4(-80.0f + 160.0f * random(), -45.0f + 40.0f * random(), 160.0f * random(), 0.2f + 0.8f * random());
+
+		light = &m_lights[i];
+		light->position = XMFLOAT3(m_lightOrbits[i].x, m_lightOrbits[i].y, m_lightOrbits[i].z);
+		light->range = 6.0f + 10.0f * random();
+		light->color = XMFLOAT3(0.3f + 0.7f * random(), 0.3f + 0.7f * random(), 0.3f + 0.7f * random());
+		light->direction = XMFLOAT3(0.0f, -1.0f, 0.0f);
+
+		if (i % 4 == 0)
+		{
+			light->outerCosine = 0.8f;
+			light->innerCosine = 0.9f;
+		}
+		else
+		{
+			light->outerCosine = -2.0f;
+			light->innerCosine = -2.0f;
+		}
+	}
+
+	return;
+}
+
+//	UpdateLights moves every light a step further around its orbit.
+void ApplicationClass::UpdateLights(float frameTime)
+{
+	int i;
+	float angle;
+
+	for (i = 0; i < (int)m_lights.size(); i++)
+	{
+		m_lightOrbits[i].w += frameTime;
+		angle = m_lightOrbits[i].w * (float)(1 + i % 3);
+
+		m_lights[i].position = XMFLOAT3(m_lightOrbits[i].x + 4.0f * cosf(angle), m_lightOrbits[i].y, m_lightOrbits[i].z + 4.0f * sinf(angle));
+	}
+
+	return;
+}
+
+//	The color and terrain shaders use the lit permutation when the clustered lighting is on.
+unsigned int ApplicationClass::GetLightingPermutation()
+{
+	return CLUSTERED_LIGHTING ? SHADER_LIT : 0;
+}
+
+//	InitializeShadows creates the Shadow Object, points its light down at a slant and adds the objects of
+//	the scene BVH as casters, so caster i is the triangle for i = 0 and character i - 1 after that. Render
+//	moves them to where their objects are drawn every frame.
+bool ApplicationClass::InitializeShadows()
+{
+	int i;
+	bool result;
+
+	m_Shadow = new ShadowClass;
+
+	result = m_Shadow->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetResourceRegistry(), m_ShaderManager, SHADOW_MAP_SIZE);
+	if (!result)
+	{
+		return false;
+	}
+
+	m_Shadow->SetLight(XMFLOAT3(-0.4f, -1.0f, 0.3f), XMFLOAT3(0.8f, 0.75f, 0.6f));
+
+	for (i = 0; i < (int)m_sceneBounds.size(); i++)
+	{
+		m_Shadow->AddCaster(m_sceneBounds[i].minimum, m_sceneBounds[i].maximum);
+	}
+
+	return true;
+}
+
+//	RenderShadows draws the render queue of every cascade into its shadow map and then points rendering
+//	back at the back buffer. The casters are the objects of the scene, so each one is drawn with the renderable
+//	and world matrix of that object in the snapshot.
+bool ApplicationClass::RenderShadows()
+{
+	const int* queue;
+	int cascade, i, indexCount, startIndex, baseVertex;
+	bool result;
+
+	for (cascade = 0; cascade < m_Shadow->GetCascadeCount(); cascade++)
+	{
+		m_Shadow->BeginCascade(m_Direct3D->GetDeviceContext(), cascade);
+
+		queue = m_Shadow->GetQueue(cascade);
+		for (i = 0; i < m_Shadow->GetQueueSize(cascade); i++)
+		{
+			if (!SetRenderable(m_renderRenderables[queue[i]], indexCount, startIndex, baseVertex))
+			{
+				continue;
+			}
+
+			result = m_Shadow->RenderCaster(m_Direct3D->GetDeviceContext(), indexCount, startIndex, baseVertex,
+				XMLoadFloat4x4(&m_renderWorlds[queue[i]]));
+			if (!result)
+			{
+				return false;
+			}
+		}
+	}
+
+	m_Direct3D->SetBackBufferRenderTarget();
+	m_Direct3D->ResetViewport();
+	m_Direct3D->ResetRasterState();
+
+	return true;
+}
+
+//	InitializeScene finishes opening the Scene Package, which startup has already tried to open while the
+//	device was created. If it couldn't be opened or failed its checks it is cooked again from the built in
+//	layout, which needs the model and the characters, and opened once more.
+bool ApplicationClass::InitializeScene()
+{
+	vector<XMFLOAT3> characterPositions;
+	int i;
+	bool result;
+
+//	A package that was opened has a size:
+	if (m_ScenePackage->GetSize() > 0)
+	{
+		return true;
+	}
+
+	characterPositions.resize(m_Animation->GetCharacterCount());
+	for (i = 0; i < (int)characterPositions.size(); i++)
+	{
+		characterPositions[i] = GetCharacterPosition(i);
+	}
+
+	result = SceneCookClass::Cook(SCENE_FILE, m_Model, characterPositions.data(), (int)characterPositions.size());
+	if (!result)
+	{
+		return false;
+	}
+
+	result = m_ScenePackage->Initialize(SCENE_FILE, true);
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+//	ResolveMesh finds the mesh of the Geometry Heap a mesh reference of the package names, or returns -1 for a
+//	mesh the engine doesn't have. The triangle of the model is the only one so far.
+int ApplicationClass::ResolveMesh(const char* name)
+{
+	if (strcmp(name, "triangle") == 0)
+	{
+		return m_Model->GetMesh();
+	}
+
+	return -1;
+}
+
+//	InitializeStaticBatches moves every mesh entity into the Static Batch, with its world matrix and the
+//	material of its object in the package. The model's triangle is the only mesh with its vertices kept on
+//	the CPU, so it is the only one that can be batched, and meshes of any other kind stay entities of their own.
+bool ApplicationClass::InitializeStaticBatches()
+{
+	const ScenePackageClass::ObjectType* objects;
+	int mesh;
+
+	m_StaticBatch = new StaticBatchClass;
+
+	mesh = m_StaticBatch->AddMesh(m_Model->GetVertices(), m_Model->GetVertexCount(), m_Model->GetIndices(), m_Model->GetIndexCount());
+	objects = m_ScenePackage->GetObjects();
+
+	m_Entities->ForEachChunk((1u << m_transformComponent) | (1u << m_renderableComponent), [&](const EntityWorldClass::ChunkViewType& chunk)
+	{
+		TransformType* transforms;
+		RenderableType* renderables;
+		int i;
+
+		transforms = (TransformType*)chunk.components[m_transformComponent];
+		renderables = (RenderableType*)chunk.components[m_renderableComponent];
+
+		for (i = 0; i < chunk.count; i++)
+		{
+			if (renderables[i].kind == RENDERABLE_MESH && renderables[i].index == m_Model->GetMesh())
+			{
+				m_StaticBatch->AddInstance(mesh, objects[renderables[i].object].material, XMLoadFloat4x4(&transforms[i].world));
+				renderables[i].kind = RENDERABLE_BATCHED;
+			}
+		}
+	});
+
+	return m_StaticBatch->Build(m_Direct3D->GetDevice(), m_Direct3D->GetResourceRegistry());
+}
+
+//	RenderStaticBatches culls a Static Batch for the view and projection and draws what is left with the
+//	Color Shader. The vertices are already in the world, so the world matrix is the identity.
+bool ApplicationClass::RenderStaticBatches(StaticBatchClass* staticBatch, XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+{
+	const StaticBatchClass::DrawType* draws;
+	XMMATRIX worldMatrix;
+	int i, drawCount;
+	bool result;
+
+	drawCount = staticBatch->Cull(viewMatrix, projectionMatrix);
+	if (drawCount == 0)
+	{
+		return true;
+	}
+
+	staticBatch->Render(m_Direct3D->GetDeviceContext());
+
+	worldMatrix = XMMatrixIdentity();
+	draws = staticBatch->GetDraws();
+	for (i = 0; i < drawCount; i++)
+	{
+		result = m_ColorShader->Render(m_Direct3D->GetDeviceContext(), draws[i].indexCount, draws[i].startIndex, draws[i].baseVertex,
+			worldMatrix, viewMatrix, projectionMatrix);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//	InitializeEntities creates the Entity World with its systems and an entity for every object of the Scene
+//	Package, straight from the objects in the mapped file, and runs the systems once so they all have a world
+//	matrix and a world box before anything asks for them. The box of a mesh comes from its reference in the
+//	package, the characters get theirs from their pose when the bounds system runs.
+bool ApplicationClass::InitializeEntities()
+{
+	const ScenePackageClass::ObjectType* objects;
+	const ScenePackageClass::MeshType* mesh;
+	TransformType* transform;
+	RenderableType* renderable;
+	EntityBoundsType* bounds;
+	unsigned int mask;
+	int i;
+	bool result;
+
+	m_Entities = new EntityWorldClass;
+
+	result = m_Entities->Initialize();
+	if (!result)
+	{
+		return false;
+	}
+
+	m_SceneSystems = new SceneSystemsClass;
+	m_SceneSystems->Initialize(m_Entities, [this](int character, XMFLOAT3& minimum, XMFLOAT3& maximum)
+	{
+		m_SkinnedModel->GetBounds(m_Animation->GetPalette(character), minimum, maximum);
+	});
+
+	m_transformComponent = m_SceneSystems->GetTransformComponent();
+	m_renderableComponent = m_SceneSystems->GetRenderableComponent();
+	m_boundsComponent = m_SceneSystems->GetBoundsComponent();
+	mask = m_SceneSystems->GetMask();
+
+	objects = m_ScenePackage->GetObjects();
+
+	m_sceneEntities.resize(m_ScenePackage->GetObjectCount());
+	for (i = 0; i < (int)m_sceneEntities.size(); i++)
+	{
+//	The package says what it refers to by index, so every index is checked before it is used:
+		if (objects[i].material < 0 || objects[i].material >= m_ScenePackage->GetMaterialCount())
+		{
+			return false;
+		}
+
+		if (objects[i].kind == SCENE_OBJECT_MESH && (objects[i].index < 0 || objects[i].index >= m_ScenePackage->GetMeshCount()))
+		{
+			return false;
+		}
+
+		if (objects[i].kind == SCENE_OBJECT_CHARACTER && (objects[i].index < 0 || objects[i].index >= m_Animation->GetCharacterCount()))
+		{
+			return false;
+		}
+
+		m_sceneEntities[i] = m_Entities->CreateEntity(mask);
+		if (m_sceneEntities[i] == 0)
+		{
+			return false;
+		}
+
+		transform = (TransformType*)m_Entities->GetComponent(m_sceneEntities[i], m_transformComponent);
+		renderable = (RenderableType*)m_Entities->GetComponent(m_sceneEntities[i], m_renderableComponent);
+		bounds = (EntityBoundsType*)m_Entities->GetComponent(m_sceneEntities[i], m_boundsComponent);
+
+		transform->position = objects[i].position;
+		transform->scale = objects[i].scale;
+		renderable->object = i;
+
+		if (objects[i].kind == SCENE_OBJECT_MESH)
+		{
+			mesh = &m_ScenePackage->GetMeshes()[objects[i].index];
+
+			renderable->kind = RENDERABLE_MESH;
+			renderable->index = ResolveMesh(m_ScenePackage->GetString(mesh->name));
+			if (renderable->index < 0)
+			{
+				return false;
+			}
+
+			bounds->localMinimum = mesh->minimum;
+			bounds->localMaximum = mesh->maximum;
+		}
+		else if (objects[i].kind == SCENE_OBJECT_CHARACTER)
+		{
+			renderable->kind = RENDERABLE_CHARACTER;
+			renderable->index = objects[i].index;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	m_Entities->RunSystems(m_JobSystem);
+
+	return true;
+}
+
+//	SetRenderable puts the geometry of a renderable on the pipeline and gives back the index count, start
+//	index and base vertex to draw it with. It returns false for a character that wasn't skinned this frame,
+//	which has nothing to draw. A batched mesh is still in the Geometry Heap, and is drawn from there.
+bool ApplicationClass::SetRenderable(const RenderableType& renderable, int& indexCount, int& startIndex, int& baseVertex)
+{
+	if (renderable.kind == RENDERABLE_CHARACTER)
+	{
+		if (!CPU_SKINNING || m_skinnedOffsets[renderable.index] == SKINNED_OFFSET_NONE)
+		{
+			return false;
+		}
+
+		m_SkinnedModel->Render(m_Direct3D->GetDeviceContext(), m_GeometryStream, m_skinnedOffsets[renderable.index]);
+
+		indexCount = m_SkinnedModel->GetIndexCount();
+		startIndex = 0;
+		baseVertex = 0;
+
+		return true;
+	}
+
+	m_GeometryHeap->Render(m_Direct3D->GetDeviceContext());
+
+	indexCount = m_GeometryHeap->GetIndexCount(renderable.index);
+	startIndex = m_GeometryHeap->GetStartIndex(renderable.index);
+	baseVertex = m_GeometryHeap->GetBaseVertex(renderable.index);
+
+	return true;
+}
+
+//	InitializeSprites creates the Sprite Batch and makes up its textures: white shapes whose alpha is how much of
+//	every texel they cover, so the color of a sprite tints them. The textures take turns being a disc, a ring, a
+//	square and a diamond, each with an edge about a texel wide.
+bool ApplicationClass::InitializeSprites(int screenWidth, int screenHeight)
+{
+	vector<unsigned int> pixels;
+	float x, y, distance, coverage;
+	int texture, i, j;
+
+	m_SpriteBatch = new SpriteBatchClass;
+	if (!m_SpriteBatch->Initialize(m_Direct3D->GetDevice(), m_Direct3D->GetResourceRegistry(), m_ShaderManager, SPRITE_MAX_SPRITES, screenWidth,
+		screenHeight))
+	{
+		return false;
+	}
+
+	pixels.resize((size_t)SPRITE_TEXTURE_SIZE * SPRITE_TEXTURE_SIZE);
+	for (texture = 0; texture < SPRITE_TEXTURE_COUNT; texture++)
+	{
+		for (j = 0; j < SPRITE_TEXTURE_SIZE; j++)
+		{
+			for (i = 0; i < SPRITE_TEXTURE_SIZE; i++)
+			{
+				x = 2.0f * ((float)i + 0.5f) / (float)SPRITE_TEXTURE_SIZE - 1.0f;
+				y = 2.0f * ((float)j + 0.5f) / (float)SPRITE_TEXTURE_SIZE - 1.0f;
+
+//	How far the texel is from the center, measured so that the edge of the shape is at 1:
+				if (texture % 4 == 0)
+				{
+					distance = sqrtf(x * x + y * y);
+				}
+				else if (texture % 4 == 1)
+				{
+					distance = fabsf(sqrtf(x * x + y * y) - 0.7f) / 0.3f;
+				}
+				else if (texture % 4 == 2)
+				{
+					distance = (fabsf(x) > fabsf(y)) ? fabsf(x) : fabsf(y);
+				}
+				else
+				{
+					distance = fabsf(x) + fabsf(y);
+				}
+
+				coverage = (1.0f - distance) * (float)SPRITE_TEXTURE_SIZE * 0.5f;
+				coverage = (coverage < 0.0f) ? 0.0f : coverage;
+				coverage = (coverage > 1.0f) ? 1.0f : coverage;
+
+				pixels[(size_t)j * SPRITE_TEXTURE_SIZE + i] = ((unsigned int)(coverage * 255.0f) << 24) | 0x00FFFFFF;
+			}
+		}
+
+		if (m_SpriteBatch->AddTexture(m_Direct3D->GetDevice(), pixels.data(), SPRITE_TEXTURE_SIZE, SPRITE_TEXTURE_SIZE) < 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//	DrawSprites draws sprites into the Sprite Batch from the job threads, so every worker fills a buffer of its
+//	own. The size, speed, spin and color of every sprite come from a hash of its index, so the same sprites drift
+//	across the screen every frame, and neighbouring sprites have different textures and layers so the batch has
+//	something to sort.
+void ApplicationClass::DrawSprites(int count, float time)
+{
+	m_JobSystem->ParallelFor(count, SPRITE_BATCH_SIZE, [this, time](int begin, int end)
+	{
+		XMFLOAT4 rectangle, color;
+		unsigned int hash;
+		float random0, random1, size, width;
+		int i;
+
+		width = (float)m_screenWidth + 64.0f;
+
+		for (i = begin; i < end; i++)
+		{
+			hash = (unsigned int)i;
+			hash = (hash ^ (hash >> 16)) * 0x7feb352d;
+			hash = (hash ^ (hash >> 15)) * 0x846ca68b;
+			hash = hash ^ (hash >> 16);
+
+			random0 = (float)(hash & 0xFFFF) / 65535.0f;
+			random1 = (float)(hash >> 16) / 65535.0f;
+			size = 8.0f + 24.0f * random1;
+
+			rectangle = XMFLOAT4(fmodf(random0 * width + (20.0f + 80.0f * random1) * time, width) - 32.0f, random1 * (float)m_screenHeight, size, size);
+			color = XMFLOAT4(0.5f + 0.5f * random0, 0.5f + 0.5f * random1, 1.0f - 0.5f * random0, 0.75f);
+
+			m_SpriteBatch->Draw(i % SPRITE_TEXTURE_COUNT, (i / SPRITE_TEXTURE_COUNT) % SPRITE_LAYER_COUNT, rectangle, XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f),
+				(random0 - 0.5f) * 4.0f * time, color);
+		}
+	});
+
+	return;
+}
+
+//	RenderSprites flushes the sprites of the frame over whatever is on the back buffer, with blending on and the
+//	depth test off, then puts both back the way the scene is drawn.
+bool ApplicationClass::RenderSprites()
+{
+	XMMATRIX orthoMatrix;
+	bool result;
+
+	if (SPRITE_DEMO_COUNT > 0)
+	{
+		DrawSprites(SPRITE_DEMO_COUNT, chrono::duration<float>(chrono::high_resolution_clock::now() - m_startTime).count());
+	}
+
+	m_Direct3D->GetOrthoMatrix(orthoMatrix);
+
+	m_Direct3D->TurnOffDepthTest();
+	m_Direct3D->TurnOnAlphaBlending();
+
+	result = m_SpriteBatch->Flush(m_Direct3D->GetDeviceContext(), orthoMatrix);
+
+	m_Direct3D->TurnOffAlphaBlending();
+	m_Direct3D->TurnOnDepthWrites();
+
+	return result;
+}
+
+#if DEBUG_DRAW_ENABLED
+//	RenderDebugDraw adds the debug primitives the configuration asks for and draws every debug primitive of the
+//	frame. The box of every object is its local box in the snapshot moved by the world matrix it is drawn with,
+//	which for a character is the box of the pose the snapshot holds. The lights are added from the job threads.
+//	The depth tested lines are drawn without writing depth, then the rest without the depth test.
+bool ApplicationClass::RenderDebugDraw(XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+{
+	int i;
+	bool result;
+
+	if (DEBUG_DRAW_BOUNDS)
+	{
+		for (i = 0; i < (int)m_renderWorlds.size(); i++)
+		{
+			m_DebugDraw->AddOrientedBox(m_renderBounds[i].localMinimum, m_renderBounds[i].localMaximum, XMLoadFloat4x4(&m_renderWorlds[i]),
+				XMFLOAT4(0.2f, 1.0f, 0.2f, 1.0f), true);
+		}
+	}
+
+	if (DEBUG_DRAW_LIGHTS)
+	{
+		m_JobSystem->ParallelFor((int)m_renderLights.size(), DEBUG_DRAW_BATCH_SIZE, [this](int begin, int end)
+		{
+			const LightClusterClass::LightType* light;
+			XMFLOAT3 tip;
+			XMFLOAT4 color;
+			int i;
+
+			for (i = begin; i < end; i++)
+			{
+				light = &m_renderLights[i];
+				color = XMFLOAT4(light->color.x, light->color.y, light->color.z, 1.0f);
+
+				m_DebugDraw->AddSphere(light->position, light->range, color, false);
+
+				if (light->outerCosine > -1.0f)
+				{
+					tip = XMFLOAT3(light->position.x + light->direction.x * light->range, light->position.y + light->direction.y * light->range,
+						light->position.z + light->direction.z * light->range);
+					m_DebugDraw->AddArrow(light->position, tip, color, false);
+				}
+			}
+		});
+	}
+
+	result = m_DebugDraw->Flush(m_Direct3D->GetDeviceContext(), viewMatrix, projectionMatrix);
+	if (!result)
+	{
+		return false;
+	}
+
+	m_Direct3D->TurnOffDepthWrites();
+	result = m_DebugDraw->Render(m_Direct3D->GetDeviceContext(), true);
+
+	m_Direct3D->TurnOffDepthTest();
+	result = result && m_DebugDraw->Render(m_Direct3D->GetDeviceContext(), false);
+
+	m_Direct3D->TurnOnDepthWrites();
+
+	return result;
+}
+#endif
@@ -0,0 +1,670 @@
+#include "../Headers/batchmathclass.h"
+
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+//	MSVC lets any function use any instruction set, GCC and Clang have to be told which functions may.
+#if defined(_MSC_VER)
+#define BATCH_MATH_SSE4_TARGET
+#define BATCH_MATH_AVX2_TARGET
+#else
+#define BATCH_MATH_SSE4_TARGET __attribute__((target("sse4.1")))
+#define BATCH_MATH_AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+
+//	The scalar kernels. They add up in the same order as the SSE code of DirectXMath, the translation and
+//	the z term first, so their results match it to the bit.
+static void TransformCoordsScalar(const XMFLOAT3* points, int count, const XMFLOAT4X4& matrix, XMFLOAT3* results)
+{
+	float x, y, z, resultX, resultY, resultZ, resultW;
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		x = points[i].x;
+		y = points[i].y;
+		z = points[i].z;
+
+		resultX = z * matrix._31 + matrix._41;
+		resultX = y * matrix._21 + resultX;
+		resultX = x * matrix._11 + resultX;
+
+		resultY = z * matrix._32 + matrix._42;
+		resultY = y * matrix._22 + resultY;
+		resultY = x * matrix._12 + resultY;
+
+		resultZ = z * matrix._33 + matrix._43;
+		resultZ = y * matrix._23 + resultZ;
+		resultZ = x * matrix._13 + resultZ;
+
+		resultW = z * matrix._34 + matrix._44;
+		resultW = y * matrix._24 + resultW;
+		resultW = x * matrix._14 + resultW;
+
+		results[i].x = resultX / resultW;
+		results[i].y = resultY / resultW;
+		results[i].z = resultZ / resultW;
+	}
+
+	return;
+}
+
+static void TransformNormalsScalar(const XMFLOAT3* normals, int count, const XMFLOAT4X4& matrix, XMFLOAT3* results)
+{
+	float x, y, z, resultX, resultY, resultZ;
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		x = normals[i].x;
+		y = normals[i].y;
+		z = normals[i].z;
+
+		resultX = z * matrix._31;
+		resultX = y * matrix._21 + resultX;
+		resultX = x * matrix._11 + resultX;
+
+		resultY = z * matrix._32;
+		resultY = y * matrix._22 + resultY;
+		resultY = x * matrix._12 + resultY;
+
+		resultZ = z * matrix._33;
+		resultZ = y * matrix._23 + resultZ;
+		resultZ = x * matrix._13 + resultZ;
+
+		results[i].x = resultX;
+		results[i].y = resultY;
+		results[i].z = resultZ;
+	}
+
+	return;
+}
+
+static void MultiplyMatricesScalar(const XMFLOAT4X4* first, const XMFLOAT4X4* second, int count, XMFLOAT4X4* results)
+{
+	XMFLOAT4X4 result;
+	int i, row, column;
+
+	for (i = 0; i < count; i++)
+	{
+		for (row = 0; row < 4; row++)
+		{
+			for (column = 0; column < 4; column++)
+			{
+				result.m[row][column] = (first[i].m[row][0] * second[i].m[0][column] + first[i].m[row][2] * second[i].m[2][column]) +
+					(first[i].m[row][1] * second[i].m[1][column] + first[i].m[row][3] * second[i].m[3][column]);
+			}
+		}
+
+		results[i] = result;
+	}
+
+	return;
+}
+
+static void TransposeMatricesScalar(const XMFLOAT4X4* matrices, int count, XMFLOAT4X4* results)
+{
+	XMFLOAT4X4 result;
+	int i, row, column;
+
+	for (i = 0; i < count; i++)
+	{
+		for (row = 0; row < 4; row++)
+		{
+			for (column = 0; column < 4; column++)
+			{
+				result.m[row][column] = matrices[i].m[column][row];
+			}
+		}
+
+		results[i] = result;
+	}
+
+	return;
+}
+
+static void PackAffineMatricesScalar(const XMFLOAT4X4* matrices, int count, XMFLOAT4* results)
+{
+	int i, row;
+
+	for (i = 0; i < count; i++)
+	{
+		for (row = 0; row < 3; row++)
+		{
+			results[i * 3 + row] = XMFLOAT4(matrices[i].m[0][row], matrices[i].m[1][row], matrices[i].m[2][row], matrices[i].m[3][row]);
+		}
+	}
+
+	return;
+}
+
+//	The SSE4.1 kernels. Four points are three loads, (x0 y0 z0 x1) (y1 z1 x2 y2) (z2 x3 y3 z3), which two
+//	blends and a shuffle turn into (x0 x1 x2 x3) and so on. Storing does the same backwards.
+static BATCH_MATH_SSE4_TARGET inline void LoadPoints4(const float* source, __m128& x, __m128& y, __m128& z)
+{
+	__m128 a, b, c;
+
+	a = _mm_loadu_ps(source);
+	b = _mm_loadu_ps(source + 4);
+	c = _mm_loadu_ps(source + 8);
+
+	x = _mm_blend_ps(_mm_blend_ps(a, b, 0x4), c, 0x2);
+	y = _mm_blend_ps(_mm_blend_ps(a, b, 0x9), c, 0x4);
+	z = _mm_blend_ps(_mm_blend_ps(a, b, 0x2), c, 0x9);
+
+	x = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 2, 3, 0));
+	y = _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 3, 0, 1));
+	z = _mm_shuffle_ps(z, z, _MM_SHUFFLE(3, 0, 1, 2));
+
+	return;
+}
+
+static BATCH_MATH_SSE4_TARGET inline void StorePoints4(float* destination, __m128 x, __m128 y, __m128 z)
+{
+	x = _mm_shuffle_ps(x, x, _MM_SHUFFLE(1, 2, 3, 0));
+	y = _mm_shuffle_ps(y, y, _MM_SHUFFLE(2, 3, 0, 1));
+	z = _mm_shuffle_ps(z, z, _MM_SHUFFLE(3, 0, 1, 2));
+
+	_mm_storeu_ps(destination, _mm_blend_ps(_mm_blend_ps(x, y, 0x2), z, 0x4));
+	_mm_storeu_ps(destination + 4, _mm_blend_ps(_mm_blend_ps(y, z, 0x2), x, 0x4));
+	_mm_storeu_ps(destination + 8, _mm_blend_ps(_mm_blend_ps(z, x, 0x2), y, 0x4));
+
+	return;
+}
+
+static BATCH_MATH_SSE4_TARGET void TransformCoordsSSE4(const XMFLOAT3* points, int count, const XMFLOAT4X4& matrix, XMFLOAT3* results)
+{
+	__m128 elements[16];
+	__m128 x, y, z, resultX, resultY, resultZ, resultW;
+	int i;
+
+	for (i = 0; i < 16; i++)
+	{
+		elements[i] = _mm_set1_ps((&matrix._11)[i]);
+	}
+
+	for (i = 0; i + 4 <= count; i += 4)
+	{
+		LoadPoints4(&points[i].x, x, y, z);
+
+		resultX = _mm_add_ps(_mm_mul_ps(z, elements[8]), elements[12]);
+		resultX = _mm_add_ps(_mm_mul_ps(y, elements[4]), resultX);
+		resultX = _mm_add_ps(_mm_mul_ps(x, elements[0]), resultX);
+
+		resultY = _mm_add_ps(_mm_mul_ps(z, elements[9]), elements[13]);
+		resultY = _mm_add_ps(_mm_mul_ps(y, elements[5]), resultY);
+		resultY = _mm_add_ps(_mm_mul_ps(x, elements[1]), resultY);
+
+		resultZ = _mm_add_ps(_mm_mul_ps(z, elements[10]), elements[14]);
+		resultZ = _mm_add_ps(_mm_mul_ps(y, elements[6]), resultZ);
+		resultZ = _mm_add_ps(_mm_mul_ps(x, elements[2]), resultZ);
+
+		resultW = _mm_add_ps(_mm_mul_ps(z, elements[11]), elements[15]);
+		resultW = _mm_add_ps(_mm_mul_ps(y, elements[7]), resultW);
+		resultW = _mm_add_ps(_mm_mul_ps(x, elements[3]), resultW);
+
+		StorePoints4(&results[i].x, _mm_div_ps(resultX, resultW), _mm_div_ps(resultY, resultW), _mm_div_ps(resultZ, resultW));
+	}
+
+	TransformCoordsScalar(points + i, count - i, matrix, results + i);
+
+	return;
+}
+
+static BATCH_MATH_SSE4_TARGET void TransformNormalsSSE4(const XMFLOAT3* normals, int count, const XMFLOAT4X4& matrix, XMFLOAT3* results)
+{
+	__m128 elements[12];
+	__m128 x, y, z, resultX, resultY, resultZ;
+	int i;
+
+	for (i = 0; i < 12; i++)
+	{
+		elements[i] = _mm_set1_ps((&matrix._11)[i]);
+	}
+
+	for (i = 0; i + 4 <= count; i += 4)
+	{
+		LoadPoints4(&normals[i].x, x, y, z);
+
+		resultX = _mm_mul_ps(z, elements[8]);
+		resultX = _mm_add_ps(_mm_mul_ps(y, elements[4]), resultX);
+		resultX = _mm_add_ps(_mm_mul_ps(x, elements[0]), resultX);
+
+		resultY = _mm_mul_ps(z, elements[9]);
+		resultY = _mm_add_ps(_mm_mul_ps(y, elements[5]), resultY);
+		resultY = _mm_add_ps(_mm_mul_ps(x, elements[1]), resultY);
+
+		resultZ = _mm_mul_ps(z, elements[10]);
+		resultZ = _mm_add_ps(_mm_mul_ps(y, elements[6]), resultZ);
+		resultZ = _mm_add_ps(_mm_mul_ps(x, elements[2]), resultZ);
+
+		StorePoints4(&results[i].x, resultX, resultY, resultZ);
+	}
+
+	TransformNormalsScalar(normals + i, count - i, matrix, results + i);
+
+	return;
+}
+
+static BATCH_MATH_SSE4_TARGET void MultiplyMatricesSSE4(const XMFLOAT4X4* first, const XMFLOAT4X4* second, int count, XMFLOAT4X4* results)
+{
+	__m128 rows[4], secondRows[4];
+	__m128 x, y, z, w;
+	int i, row;
+
+	for (i = 0; i < count; i++)
+	{
+		for (row = 0; row < 4; row++)
+		{
+			rows[row] = _mm_loadu_ps(first[i].m[row]);
+			secondRows[row] = _mm_loadu_ps(second[i].m[row]);
+		}
+
+		for (row = 0; row < 4; row++)
+		{
+			x = _mm_mul_ps(_mm_shuffle_ps(rows[row], rows[row], _MM_SHUFFLE(0, 0, 0, 0)), secondRows[0]);
+			y = _mm_mul_ps(_mm_shuffle_ps(rows[row], rows[row], _MM_SHUFFLE(1, 1, 1, 1)), secondRows[1]);
+			z = _mm_mul_ps(_mm_shuffle_ps(rows[row], rows[row], _MM_SHUFFLE(2, 2, 2, 2)), secondRows[2]);
+			w = _mm_mul_ps(_mm_shuffle_ps(rows[row], rows[row], _MM_SHUFFLE(3, 3, 3, 3)), secondRows[3]);
+
+			_mm_storeu_ps(results[i].m[row], _mm_add_ps(_mm_add_ps(x, z), _mm_add_ps(y, w)));
+		}
+	}
+
+	return;
+}
+
+static BATCH_MATH_SSE4_TARGET void TransposeMatricesSSE4(const XMFLOAT4X4* matrices, int count, XMFLOAT4X4* results)
+{
+	__m128 row0, row1, row2, row3;
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		row0 = _mm_loadu_ps(matrices[i].m[0]);
+		row1 = _mm_loadu_ps(matrices[i].m[1]);
+		row2 = _mm_loadu_ps(matrices[i].m[2]);
+		row3 = _mm_loadu_ps(matrices[i].m[3]);
+
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+		_mm_storeu_ps(results[i].m[0], row0);
+		_mm_storeu_ps(results[i].m[1], row1);
+		_mm_storeu_ps(results[i].m[2], row2);
+		_mm_storeu_ps(results[i].m[3], row3);
+	}
+
+	return;
+}
+
+static BATCH_MATH_SSE4_TARGET void PackAffineMatricesSSE4(const XMFLOAT4X4* matrices, int count, XMFLOAT4* results)
+{
+	__m128 row0, row1, row2, row3;
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		row0 = _mm_loadu_ps(matrices[i].m[0]);
+		row1 = _mm_loadu_ps(matrices[i].m[1]);
+		row2 = _mm_loadu_ps(matrices[i].m[2]);
+		row3 = _mm_loadu_ps(matrices[i].m[3]);
+
+		_MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+		_mm_storeu_ps(&results[i * 3].x, row0);
+		_mm_storeu_ps(&results[i * 3 + 1].x, row1);
+		_mm_storeu_ps(&results[i * 3 + 2].x, row2);
+	}
+
+	return;
+}
+
+//	The AVX2 kernels. The blends and shuffles of AVX only work within each 128 bit half of a register, so
+//	eight points are loaded as four into each half and the SSE4.1 steps run on both halves at once.
+static BATCH_MATH_AVX2_TARGET inline __m256 LoadHalves(const float* low, const float* high)
+{
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+}
+
+static BATCH_MATH_AVX2_TARGET inline void StoreHalves(float* low, float* high, __m256 value)
+{
+	_mm_storeu_ps(low, _mm256_castps256_ps128(value));
+	_mm_storeu_ps(high, _mm256_extractf128_ps(value, 1));
+
+	return;
+}
+
+static BATCH_MATH_AVX2_TARGET inline void LoadPoints8(const float* source, __m256& x, __m256& y, __m256& z)
+{
+	__m256 a, b, c;
+
+	a = LoadHalves(source, source + 12);
+	b = LoadHalves(source + 4, source + 16);
+	c = LoadHalves(source + 8, source + 20);
+
+	x = _mm256_blend_ps(_mm256_blend_ps(a, b, 0x44), c, 0x22);
+	y = _mm256_blend_ps(_mm256_blend_ps(a, b, 0x99), c, 0x44);
+	z = _mm256_blend_ps(_mm256_blend_ps(a, b, 0x22), c, 0x99);
+
+	x = _mm256_permute_ps(x, _MM_SHUFFLE(1, 2, 3, 0));
+	y = _mm256_permute_ps(y, _MM_SHUFFLE(2, 3, 0, 1));
+	z = _mm256_permute_ps(z, _MM_SHUFFLE(3, 0, 1, 2));
+
+	return;
+}
+
+static BATCH_MATH_AVX2_TARGET inline void StorePoints8(float* destination, __m256 x, __m256 y, __m256 z)
+{
+	x = _mm256_permute_ps(x, _MM_SHUFFLE(1, 2, 3, 0));
+	y = _mm256_permute_ps(y, _MM_SHUFFLE(2, 3, 0, 1));
+	z = _mm256_permute_ps(z, _MM_SHUFFLE(3, 0, 1, 2));
+
+	StoreHalves(destination, destination + 12, _mm256_blend_ps(_mm256_blend_ps(x, y, 0x22), z, 0x44));
+	StoreHalves(destination + 4, destination + 16, _mm256_blend_ps(_mm256_blend_ps(y, z, 0x22), x, 0x44));
+	StoreHalves(destination + 8, destination + 20, _mm256_blend_ps(_mm256_blend_ps(z, x, 0x22), y, 0x44));
+
+	return;
+}
+
+static BATCH_MATH_AVX2_TARGET void TransformCoordsAVX2(const XMFLOAT3* points, int count, const XMFLOAT4X4& matrix, XMFLOAT3* results)
+{
+	__m256 elements[16];
+	__m256 x, y, z, resultX, resultY, resultZ, resultW;
+	int i;
+
+	for (i = 0; i < 16; i++)
+	{
+		elements[i] = _mm256_set1_ps((&matrix._11)[i]);
+	}
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		LoadPoints8(&points[i].x, x, y, z);
+
+		resultX = _mm256_fmadd_ps(x, elements[0], _mm256_fmadd_ps(y, elements[4], _mm256_fmadd_ps(z, elements[8], elements[12])));
+		resultY = _mm256_fmadd_ps(x, elements[1], _mm256_fmadd_ps(y, elements[5], _mm256_fmadd_ps(z, elements[9], elements[13])));
+		resultZ = _mm256_fmadd_ps(x, elements[2], _mm256_fmadd_ps(y, elements[6], _mm256_fmadd_ps(z, elements[10], elements[14])));
+		resultW = _mm256_fmadd_ps(x, elements[3], _mm256_fmadd_ps(y, elements[7], _mm256_fmadd_ps(z, elements[11], elements[15])));
+
+		StorePoints8(&results[i].x, _mm256_div_ps(resultX, resultW), _mm256_div_ps(resultY, resultW), _mm256_div_ps(resultZ, resultW));
+	}
+
+	TransformCoordsScalar(points + i, count - i, matrix, results + i);
+
+	return;
+}
+
+static BATCH_MATH_AVX2_TARGET void TransformNormalsAVX2(const XMFLOAT3* normals, int count, const XMFLOAT4X4& matrix, XMFLOAT3* results)
+{
+	__m256 elements[12];
+	__m256 x, y, z, resultX, resultY, resultZ;
+	int i;
+
+	for (i = 0; i < 12; i++)
+	{
+		elements[i] = _mm256_set1_ps((&matrix._11)[i]);
+	}
+
+	for (i = 0; i + 8 <= count; i += 8)
+	{
+		LoadPoints8(&normals[i].x, x, y, z);
+
+		resultX = _mm256_fmadd_ps(x, elements[0], _mm256_fmadd_ps(y, elements[4], _mm256_mul_ps(z, elements[8])));
+		resultY = _mm256_fmadd_ps(x, elements[1], _mm256_fmadd_ps(y, elements[5], _mm256_mul_ps(z, elements[9])));
+		resultZ = _mm256_fmadd_ps(x, elements[2], _mm256_fmadd_ps(y, elements[6], _mm256_mul_ps(z, elements[10])));
+
+		StorePoints8(&results[i].x, resultX, resultY, resultZ);
+	}
+
+	TransformNormalsScalar(normals + i, count - i, matrix, results + i);
+
+	return;
+}
+
+//	Two rows of the first matrix fit in one register, each in its own half, against the rows of the second
+//	matrix repeated in both halves.
+static BATCH_MATH_AVX2_TARGET void MultiplyMatricesAVX2(const XMFLOAT4X4* first, const XMFLOAT4X4* second, int count, XMFLOAT4X4* results)
+{
+	__m256 secondRows[4];
+	__m256 rows01, rows23, result01, result23;
+	int i, row;
+
+	for (i = 0; i < count; i++)
+	{
+		for (row = 0; row < 4; row++)
+		{
+			secondRows[row] = _mm256_broadcast_ps((const __m128*)second[i].m[row]);
+		}
+
+		rows01 = _mm256_loadu_ps(first[i].m[0]);
+		rows23 = _mm256_loadu_ps(first[i].m[2]);
+
+		result01 = _mm256_add_ps(_mm256_fmadd_ps(_mm256_permute_ps(rows01, 0xAA), secondRows[2], _mm256_mul_ps(_mm256_permute_ps(rows01, 0x00), secondRows[0])),
+			_mm256_fmadd_ps(_mm256_permute_ps(rows01, 0xFF), secondRows[3], _mm256_mul_ps(_mm256_permute_ps(rows01, 0x55), secondRows[1])));
+		result23 = _mm256_add_ps(_mm256_fmadd_ps(_mm256_permute_ps(rows23, 0xAA), secondRows[2], _mm256_mul_ps(_mm256_permute_ps(rows23, 0x00), secondRows[0])),
+			_mm256_fmadd_ps(_mm256_permute_ps(rows23, 0xFF), secondRows[3], _mm256_mul_ps(_mm256_permute_ps(rows23, 0x55), secondRows[1])));
+
+		_mm256_storeu_ps(results[i].m[0], result01);
+		_mm256_storeu_ps(results[i].m[2], result23);
+	}
+
+	return;
+}
+
+//	Two matrices are transposed at once, one in each half of the registers.
+static BATCH_MATH_AVX2_TARGET inline void TransposePair(const XMFLOAT4X4* matrices, __m256& column0, __m256& column1, __m256& column2, __m256& column3)
+{
+	__m256 row0, row1, row2, row3, low01, high01, low23, high23;
+
+	row0 = LoadHalves(matrices[0].m[0], matrices[1].m[0]);
+	row1 = LoadHalves(matrices[0].m[1], matrices[1].m[1]);
+	row2 = LoadHalves(matrices[0].m[2], matrices[1].m[2]);
+	row3 = LoadHalves(matrices[0].m[3], matrices[1].m[3]);
+
+	low01 = _mm256_unpacklo_ps(row0, row1);
+	high01 = _mm256_unpackhi_ps(row0, row1);
+	low23 = _mm256_unpacklo_ps(row2, row3);
+	high23 = _mm256_unpackhi_ps(row2, row3);
+
+	column0 = _mm256_shuffle_ps(low01, low23, _MM_SHUFFLE(1, 0, 1, 0));
+	column1 = _mm256_shuffle_ps(low01, low23, _MM_SHUFFLE(3, 2, 3, 2));
+	column2 = _mm256_shuffle_ps(high01, high23, _MM_SHUFFLE(1, 0, 1, 0));
+	column3 = _mm256_shuffle_ps(high01, high23, _MM_SHUFFLE(3, 2, 3, 2));
+
+	return;
+}
+
+static BATCH_MATH_AVX2_TARGET void TransposeMatricesAVX2(const XMFLOAT4X4* matrices, int count, XMFLOAT4X4* results)
+{
+	__m256 column0, column1, column2, column3;
+	int i;
+
+	for (i = 0; i + 2 <= count; i += 2)
+	{
+		TransposePair(&matrices[i], column0, column1, column2, column3);
+
+		StoreHalves(results[i].m[0], results[i + 1].m[0], column0);
+		StoreHalves(results[i].m[1], results[i + 1].m[1], column1);
+		StoreHalves(results[i].m[2], results[i + 1].m[2], column2);
+		StoreHalves(results[i].m[3], results[i + 1].m[3], column3);
+	}
+
+	TransposeMatricesScalar(matrices + i, count - i, results + i);
+
+	return;
+}
+
+static BATCH_MATH_AVX2_TARGET void PackAffineMatricesAVX2(const XMFLOAT4X4* matrices, int count, XMFLOAT4* results)
+{
+	__m256 column0, column1, column2, column3;
+	int i;
+
+	for (i = 0; i + 2 <= count; i += 2)
+	{
+		TransposePair(&matrices[i], column0, column1, column2, column3);
+
+		StoreHalves(&results[i * 3].x, &results[i * 3 + 3].x, column0);
+		StoreHalves(&results[i * 3 + 1].x, &results[i * 3 + 4].x, column1);
+		StoreHalves(&results[i * 3 + 2].x, &results[i * 3 + 5].x, column2);
+	}
+
+	PackAffineMatricesScalar(matrices + i, count - i, results + i * 3);
+
+	return;
+}
+
+//	ReadCpuid and ReadEnabledState wrap the compiler's way of asking the processor what it supports and the
+//	operating system which registers it saves.
+static void ReadCpuid(int leaf, int subleaf, int registers[4])
+{
+#if defined(_MSC_VER)
+	__cpuidex(registers, leaf, subleaf);
+#else
+	unsigned int eax, ebx, ecx, edx;
+
+	__cpuid_count(leaf, subleaf, eax, ebx, ecx, edx);
+	registers[0] = (int)eax;
+	registers[1] = (int)ebx;
+	registers[2] = (int)ecx;
+	registers[3] = (int)edx;
+#endif
+
+	return;
+}
+
+static unsigned long long ReadEnabledState()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	unsigned int low, high;
+
+	__asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+
+	return ((unsigned long long)high << 32) | low;
+#endif
+}
+
+BatchMathClass::KernelsType BatchMathClass::m_kernels[BATCH_MATH_PATH_COUNT] =
+{
+	{ TransformCoordsScalar, TransformNormalsScalar, MultiplyMatricesScalar, TransposeMatricesScalar, PackAffineMatricesScalar },
+	{ TransformCoordsSSE4, TransformNormalsSSE4, MultiplyMatricesSSE4, TransposeMatricesSSE4, PackAffineMatricesSSE4 },
+	{ TransformCoordsAVX2, TransformNormalsAVX2, MultiplyMatricesAVX2, TransposeMatricesAVX2, PackAffineMatricesAVX2 }
+};
+
+bool BatchMathClass::m_supported[BATCH_MATH_PATH_COUNT] = { true, false, false };
+int BatchMathClass::m_path = BATCH_MATH_SCALAR;
+
+//	AVX2 needs the processor to have AVX, AVX2 and FMA, and the operating system to save the upper halves of
+//	the registers, which it says in bits 1 and 2 of XCR0.
+void BatchMathClass::Initialize()
+{
+	int registers[4];
+	int maxLeaf;
+	bool sse41, avx, fma, osxsave, avx2;
+
+	ReadCpuid(0, 0, registers);
+	maxLeaf = registers[0];
+
+	ReadCpuid(1, 0, registers);
+	sse41 = (registers[2] & (1 << 19)) != 0;
+	fma = (registers[2] & (1 << 12)) != 0;
+	osxsave = (registers[2] & (1 << 27)) != 0;
+	avx = (registers[2] & (1 << 28)) != 0;
+
+	avx2 = false;
+	if (maxLeaf >= 7)
+	{
+		ReadCpuid(7, 0, registers);
+		avx2 = (registers[1] & (1 << 5)) != 0;
+	}
+
+	m_supported[BATCH_MATH_SCALAR] = true;
+	m_supported[BATCH_MATH_SSE4] = sse41;
+	m_supported[BATCH_MATH_AVX2] = sse41 && avx && avx2 && fma && osxsave && (ReadEnabledState() & 6) == 6;
+
+	m_path = BATCH_MATH_SCALAR;
+	while (m_path + 1 < BATCH_MATH_PATH_COUNT && m_supported[m_path + 1])
+	{
+		m_path++;
+	}
+
+	return;
+}
+
+bool BatchMathClass::IsPathSupported(int path)
+{
+	return path >= 0 && path < BATCH_MATH_PATH_COUNT && m_supported[path];
+}
+
+//	SetPath is for comparing the paths, everything else should keep the one Initialize picked.
+bool BatchMathClass::SetPath(int path)
+{
+	if (!IsPathSupported(path))
+	{
+		return false;
+	}
+
+	m_path = path;
+
+	return true;
+}
+
+int BatchMathClass::GetPath()
+{
+	return m_path;
+}
+
+const char* BatchMathClass::GetPathName(int path)
+{
+	switch (path)
+	{
+	case BATCH_MATH_SCALAR:
+		return "scalar";
+	case BATCH_MATH_SSE4:
+		return "SSE4.1";
+	case BATCH_MATH_AVX2:
+		return "AVX2";
+	}
+
+	return "unknown";
+}
+
+void BatchMathClass::TransformCoords(const XMFLOAT3* points, int count, const XMFLOAT4X4& matrix, XMFLOAT3* results)
+{
+	m_kernels[m_path].transformCoords(points, count, matrix, results);
+
+	return;
+}
+
+void BatchMathClass::TransformNormals(const XMFLOAT3* normals, int count, const XMFLOAT4X4& matrix, XMFLOAT3* results)
+{
+	m_kernels[m_path].transformNormals(normals, count, matrix, results);
+
+	return;
+}
+
+void BatchMathClass::MultiplyMatrices(const XMFLOAT4X4* first, const XMFLOAT4X4* second, int count, XMFLOAT4X4* results)
+{
+	m_kernels[m_path].multiplyMatrices(first, second, count, results);
+
+	return;
+}
+
+void BatchMathClass::TransposeMatrices(const XMFLOAT4X4* matrices, int count, XMFLOAT4X4* results)
+{
+	m_kernels[m_path].transposeMatrices(matrices, count, results);
+
+	return;
+}
+
+void BatchMathClass::PackAffineMatrices(const XMFLOAT4X4* matrices, int count, XMFLOAT4* results)
+{
+	m_kernels[m_path].packAffineMatrices(matrices, count, results);
+
+	return;
+}
@@ -0,0 +1,391 @@
+//	The batch math test runs the SSE4.1 and AVX2 kernels of the Batch Math class over random arrays and over
+//	arrays made to be awkward, and checks them against the scalar kernels. It is not part of the engine's
+//	project and is built on its own for x64, for example with:
+//	g++ -O2 -o batchmathtest Source/batchmathtestmain.cpp Source/batchmathclass.cpp
+//	and run as: batchmathtest
+//	Paths the processor doesn't support are skipped. It prints a line for every path, kernel and case and
+//	returns 1 if any of them failed.
+#include "../Headers/batchmathclass.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+//	The largest number of items a case has, and the guard items after the end of every output array, which
+//	the kernels must leave alone.
+static const int TEST_MAX_COUNT = 1027;
+static const int TEST_GUARD_COUNT = 9;
+
+//	The counts every case is run with: none, one, and ones on either side of the four and eight items the
+//	SSE4.1 and AVX2 kernels do at once, so the scalar tails are run with every length they can have.
+static const int TEST_COUNTS[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 11, 15, 16, 17, 31, 33, 1027 };
+static const int TEST_COUNT_COUNT = sizeof(TEST_COUNTS) / sizeof(TEST_COUNTS[0]);
+
+//	How far the AVX2 kernels may be from the scalar ones, relative to the size of the reference value or to
+//	the size of the terms the case adds up for values smaller than that, since a sum that cancels keeps the
+//	rounding of its terms. The SSE4.1 kernels have to give the same bits.
+static const float TEST_FUSED_TOLERANCE = 1.0e-5f;
+
+//	The guard value is a NaN with a payload the kernels would never produce.
+static const unsigned int TEST_GUARD_BITS = 0x7fc0dead;
+
+//	The inputs of a case: the points, normals and matrices the kernels read, and about how large the
+//	products they add up get.
+struct CaseType
+{
+	const char* name;
+	float magnitude;
+	XMFLOAT3 points[TEST_MAX_COUNT];
+	XMFLOAT4X4 left[TEST_MAX_COUNT];
+	XMFLOAT4X4 right[TEST_MAX_COUNT];
+	XMFLOAT4X4 transform;
+};
+
+//	The outputs of a run, with the guard items behind every array.
+struct ResultType
+{
+	XMFLOAT3 coords[TEST_MAX_COUNT + TEST_GUARD_COUNT];
+	XMFLOAT3 normals[TEST_MAX_COUNT + TEST_GUARD_COUNT];
+	XMFLOAT4X4 products[TEST_MAX_COUNT + TEST_GUARD_COUNT];
+	XMFLOAT4X4 transposes[TEST_MAX_COUNT + TEST_GUARD_COUNT];
+	XMFLOAT4 packed[TEST_MAX_COUNT * 3 + TEST_GUARD_COUNT];
+	XMFLOAT3 inPlaceCoords[TEST_MAX_COUNT];
+	XMFLOAT4X4 inPlaceTransposes[TEST_MAX_COUNT];
+};
+
+static CaseType g_case;
+static ResultType g_reference, g_result;
+
+static unsigned int g_seed = 12345;
+
+//	A float from minimum to maximum, from the same linear congruential generator the benchmarks use.
+static float Random(float minimum, float maximum)
+{
+	g_seed = g_seed * 1664525 + 1013904223;
+
+	return minimum + (maximum - minimum) * (float)(g_seed >> 8) / 16777216.0f;
+}
+
+static unsigned int GetBits(float value)
+{
+	unsigned int bits;
+
+	memcpy(&bits, &value, sizeof(bits));
+
+	return bits;
+}
+
+static void FillGuard(float* values, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		memcpy(&values[i], &TEST_GUARD_BITS, sizeof(float));
+	}
+
+	return;
+}
+
+//	A matrix that rotates about a random axis, scales and moves, so it has no zero entries to hide mistakes
+//	and its fourth column is 0, 0, 0, 1 like the world matrices the engine transforms with.
+static void RandomAffine(XMFLOAT4X4& matrix, float scale, float move)
+{
+	float x, y, z, length, angle, c, s, t;
+
+	x = Random(-1.0f, 1.0f);
+	y = Random(-1.0f, 1.0f);
+	z = Random(-1.0f, 1.0f);
+	length = sqrtf(x * x + y * y + z * z);
+	length = length > 0.001f ? length : 1.0f;
+	x /= length;
+	y /= length;
+	z /= length;
+
+	angle = Random(0.0f, 6.2831853f);
+	c = cosf(angle);
+	s = sinf(angle);
+	t = 1.0f - c;
+
+	matrix._11 = (t * x * x + c) * scale;
+	matrix._12 = (t * x * y + s * z) * scale;
+	matrix._13 = (t * x * z - s * y) * scale;
+	matrix._14 = 0.0f;
+	matrix._21 = (t * x * y - s * z) * scale;
+	matrix._22 = (t * y * y + c) * scale;
+	matrix._23 = (t * y * z + s * x) * scale;
+	matrix._24 = 0.0f;
+	matrix._31 = (t * x * z + s * y) * scale;
+	matrix._32 = (t * y * z - s * x) * scale;
+	matrix._33 = (t * z * z + c) * scale;
+	matrix._34 = 0.0f;
+	matrix._41 = Random(-move, move);
+	matrix._42 = Random(-move, move);
+	matrix._43 = Random(-move, move);
+	matrix._44 = 1.0f;
+
+	return;
+}
+
+//	A left handed perspective projection, which gives w the depth of the point, as the view projection
+//	matrices of the cameras do.
+static void Perspective(XMFLOAT4X4& matrix)
+{
+	memset(&matrix, 0, sizeof(matrix));
+	matrix._11 = 1.3f;
+	matrix._22 = 1.7f;
+	matrix._33 = 1000.0f / (1000.0f - 0.1f);
+	matrix._34 = 1.0f;
+	matrix._43 = -0.1f * 1000.0f / (1000.0f - 0.1f);
+
+	return;
+}
+
+//	Random points anywhere in a large world and random matrices, transformed by a random world matrix.
+static void BuildRandomCase()
+{
+	int i;
+
+	g_case.name = "random";
+	g_case.magnitude = 1000.0f;
+	for (i = 0; i < TEST_MAX_COUNT; i++)
+	{
+		g_case.points[i] = XMFLOAT3(Random(-500.0f, 500.0f), Random(-500.0f, 500.0f), Random(-500.0f, 500.0f));
+		RandomAffine(g_case.left[i], Random(0.1f, 10.0f), 500.0f);
+		RandomAffine(g_case.right[i], Random(0.1f, 10.0f), 500.0f);
+	}
+	RandomAffine(g_case.transform, 2.0f, 100.0f);
+
+	return;
+}
+
+//	Points in front of the camera through a projection, so every point is divided by its own w.
+static void BuildPerspectiveCase()
+{
+	int i;
+
+	g_case.name = "perspective";
+	g_case.magnitude = 1000.0f;
+	for (i = 0; i < TEST_MAX_COUNT; i++)
+	{
+		g_case.points[i] = XMFLOAT3(Random(-50.0f, 50.0f), Random(-50.0f, 50.0f), Random(0.5f, 900.0f));
+		RandomAffine(g_case.left[i], Random(0.1f, 10.0f), 100.0f);
+		Perspective(g_case.right[i]);
+	}
+	Perspective(g_case.transform);
+
+	return;
+}
+
+//	Zero length vectors, which must come out as the translation and as zero, denormal coordinates, and
+//	matrices with denormal and zero entries, mixed so every lane of the wide kernels sees each of them.
+static void BuildEdgeCase()
+{
+	const float denormal = 1.0e-40f;
+	int i, j, k;
+
+	g_case.name = "edge";
+	g_case.magnitude = 10.0f;
+	for (i = 0; i < TEST_MAX_COUNT; i++)
+	{
+		switch (i % 5)
+		{
+		case 0:
+			g_case.points[i] = XMFLOAT3(0.0f, 0.0f, 0.0f);
+			break;
+		case 1:
+			g_case.points[i] = XMFLOAT3(denormal, -denormal, denormal * 3.0f);
+			break;
+		case 2:
+			g_case.points[i] = XMFLOAT3(-0.0f, 0.0f, -0.0f);
+			break;
+		case 3:
+			g_case.points[i] = XMFLOAT3(denormal, 0.0f, Random(-1.0f, 1.0f));
+			break;
+		default:
+			g_case.points[i] = XMFLOAT3(Random(-1.0f, 1.0f), Random(-1.0f, 1.0f), Random(-1.0f, 1.0f));
+			break;
+		}
+
+		RandomAffine(g_case.left[i], Random(0.1f, 2.0f), 10.0f);
+		if (i % 3 == 0)
+		{
+			memset(&g_case.right[i], 0, sizeof(XMFLOAT4X4));
+		}
+		else
+		{
+			for (j = 0; j < 4; j++)
+			{
+				for (k = 0; k < 4; k++)
+				{
+					g_case.right[i].m[j][k] = (j + k + i) % 2 == 0 ? denormal * (float)(j + 1) : Random(-2.0f, 2.0f);
+				}
+			}
+		}
+	}
+
+	RandomAffine(g_case.transform, 1.0f, 5.0f);
+	g_case.transform._12 = denormal;
+	g_case.transform._23 = -denormal;
+
+	return;
+}
+
+//	Run runs every kernel of the current path over the first count items of the case. The coordinates and
+//	transposes are also done again in place, from a copy of the input.
+static void Run(int count, ResultType& result)
+{
+	FillGuard((float*)result.coords, (TEST_MAX_COUNT + TEST_GUARD_COUNT) * 3);
+	FillGuard((float*)result.normals, (TEST_MAX_COUNT + TEST_GUARD_COUNT) * 3);
+	FillGuard((float*)result.products, (TEST_MAX_COUNT + TEST_GUARD_COUNT) * 16);
+	FillGuard((float*)result.transposes, (TEST_MAX_COUNT + TEST_GUARD_COUNT) * 16);
+	FillGuard((float*)result.packed, (TEST_MAX_COUNT * 3 + TEST_GUARD_COUNT) * 4);
+
+	BatchMathClass::TransformCoords(g_case.points, count, g_case.transform, result.coords);
+	BatchMathClass::TransformNormals(g_case.points, count, g_case.transform, result.normals);
+	BatchMathClass::MultiplyMatrices(g_case.left, g_case.right, count, result.products);
+	BatchMathClass::TransposeMatrices(g_case.left, count, result.transposes);
+	BatchMathClass::PackAffineMatrices(g_case.left, count, result.packed);
+
+	memcpy(result.inPlaceCoords, g_case.points, sizeof(XMFLOAT3) * TEST_MAX_COUNT);
+	BatchMathClass::TransformCoords(result.inPlaceCoords, count, g_case.transform, result.inPlaceCoords);
+
+	memcpy(result.inPlaceTransposes, g_case.left, sizeof(XMFLOAT4X4) * TEST_MAX_COUNT);
+	BatchMathClass::TransposeMatrices(result.inPlaceTransposes, count, result.inPlaceTransposes);
+
+	return;
+}
+
+//	Compare checks count floats of a result against the reference, bit for bit when exact, otherwise within
+//	the tolerance, with NaNs only matching NaNs and infinities only the same infinity. The guard floats behind
+//	them have to be untouched. It returns how many floats failed and the largest difference.
+static int Compare(const float* reference, const float* result, int count, int guardCount, bool exact,
+	float& largest)
+{
+	float difference, size;
+	int i, failures;
+
+	failures = 0;
+	for (i = 0; i < count; i++)
+	{
+		if (GetBits(reference[i]) == GetBits(result[i]))
+		{
+			continue;
+		}
+
+		if (exact || isnan(reference[i]) || isnan(result[i]) || isinf(reference[i]) || isinf(result[i]))
+		{
+			failures++;
+			continue;
+		}
+
+		size = fabsf(reference[i]);
+		size = size > g_case.magnitude ? size : g_case.magnitude;
+		difference = fabsf(result[i] - reference[i]) / size;
+		largest = difference > largest ? difference : largest;
+		if (difference > TEST_FUSED_TOLERANCE)
+		{
+			failures++;
+		}
+	}
+
+	for (i = count; i < count + guardCount; i++)
+	{
+		if (GetBits(result[i]) != TEST_GUARD_BITS)
+		{
+			failures++;
+		}
+	}
+
+	return failures;
+}
+
+//	CheckKernel compares one output of every count and prints a line for it.
+static bool CheckKernel(const char* pathName, const char* kernel, int path, int floatsPerItem, int guardFloats,
+	bool exact, const float* (*select)(const ResultType&))
+{
+	float largest;
+	int i, count, failures, checked;
+
+	largest = 0.0f;
+	failures = 0;
+	checked = 0;
+	for (i = 0; i < TEST_COUNT_COUNT; i++)
+	{
+		count = TEST_COUNTS[i];
+
+		BatchMathClass::SetPath(BATCH_MATH_SCALAR);
+		Run(count, g_reference);
+		BatchMathClass::SetPath(path);
+		Run(count, g_result);
+
+		failures += Compare(select(g_reference), select(g_result), count * floatsPerItem, guardFloats, exact, largest);
+		checked += count * floatsPerItem;
+	}
+
+	printf("%s %s %s: %s, %d of %d floats wrong, largest difference %g\n", pathName, g_case.name, kernel,
+		failures == 0 ? "passed" : "FAILED", failures, checked, largest);
+
+	return failures == 0;
+}
+
+static const float* SelectCoords(const ResultType& result) { return (const float*)result.coords; }
+static const float* SelectNormals(const ResultType& result) { return (const float*)result.normals; }
+static const float* SelectProducts(const ResultType& result) { return (const float*)result.products; }
+static const float* SelectTransposes(const ResultType& result) { return (const float*)result.transposes; }
+static const float* SelectPacked(const ResultType& result) { return (const float*)result.packed; }
+static const float* SelectInPlaceCoords(const ResultType& result) { return (const float*)result.inPlaceCoords; }
+static const float* SelectInPlaceTransposes(const ResultType& result) { return (const float*)result.inPlaceTransposes; }
+
+//	CheckPath checks every kernel of one path on the case that is built. Only the AVX2 kernels that multiply
+//	and add may differ from the scalar ones, and only by rounding.
+static int CheckPath(int path)
+{
+	const char* name;
+	bool exact;
+	int failed;
+
+	name = BatchMathClass::GetPathName(path);
+	exact = path != BATCH_MATH_AVX2;
+
+	failed = 0;
+	failed += CheckKernel(name, "TransformCoords", path, 3, TEST_GUARD_COUNT * 3, exact, SelectCoords) ? 0 : 1;
+	failed += CheckKernel(name, "TransformNormals", path, 3, TEST_GUARD_COUNT * 3, exact, SelectNormals) ? 0 : 1;
+	failed += CheckKernel(name, "MultiplyMatrices", path, 16, TEST_GUARD_COUNT * 16, exact, SelectProducts) ? 0 : 1;
+	failed += CheckKernel(name, "TransposeMatrices", path, 16, TEST_GUARD_COUNT * 16, true, SelectTransposes) ? 0 : 1;
+	failed += CheckKernel(name, "PackAffineMatrices", path, 12, TEST_GUARD_COUNT * 4, true, SelectPacked) ? 0 : 1;
+	failed += CheckKernel(name, "TransformCoords in place", path, 3, 0, exact, SelectInPlaceCoords) ? 0 : 1;
+	failed += CheckKernel(name, "TransposeMatrices in place", path, 16, 0, true, SelectInPlaceTransposes) ? 0 : 1;
+
+	return failed;
+}
+
+int main()
+{
+	void (*builders[3])();
+	int i, path, failed;
+
+	BatchMathClass::Initialize();
+
+	builders[0] = BuildRandomCase;
+	builders[1] = BuildPerspectiveCase;
+	builders[2] = BuildEdgeCase;
+
+	failed = 0;
+	for (path = BATCH_MATH_SCALAR + 1; path < BATCH_MATH_PATH_COUNT; path++)
+	{
+		if (!BatchMathClass::IsPathSupported(path))
+		{
+			printf("%s: not supported, skipped\n", BatchMathClass::GetPathName(path));
+			continue;
+		}
+
+		for (i = 0; i < 3; i++)
+		{
+			builders[i]();
+			failed += CheckPath(path);
+		}
+	}
+
+	return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+//	The BVH benchmark builds a BVH over a soup of small random triangles in a cube and casts random rays
+//	through it on the job threads, and prints the build time, the size of the tree and the rays per second.
+//	Nothing in it needs Direct3D. It is not part of the engine's project and is built on its own, with the
+//	DirectXMath headers on the include path, for example with:
+//	g++ -O2 -o bvhbenchmark Source/bvhbenchmarkmain.cpp Source/bvhclass.cpp Source/jobsystemclass.cpp -lpthread
+//	and run as: bvhbenchmark [triangles] [rays]
+#include "../Headers/bvhclass.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char* argv[])
+{
+	JobSystemClass jobSystem;
+	BVHClass bvh;
+	vector<XMFLOAT3> positions;
+	vector<unsigned long> indices;
+	vector<BVHClass::RayType> rays;
+	vector<BVHClass::HitType> hits;
+	XMFLOAT3 center;
+	unsigned int seed;
+	int triangleCount, rayCount, i, j, hitCount;
+
+	triangleCount = argc > 1 ? atoi(argv[1]) : 1000000;
+	rayCount = argc > 2 ? atoi(argv[2]) : 1000000;
+	if (triangleCount <= 0 || rayCount <= 0)
+	{
+		fprintf(stderr, "usage: %s [triangles] [rays]\n", argv[0]);
+		return 1;
+	}
+
+	jobSystem.Initialize(0);
+
+	seed = 1;
+	auto random = [&seed]()
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (float)(seed >> 8) / 16777216.0f;
+	};
+
+	positions.resize(triangleCount * 3);
+	indices.resize(triangleCount * 3);
+	for (i = 0; i < triangleCount; i++)
+	{
+		center = XMFLOAT3(100.0f * random(), 100.0f * random(), 100.0f * random());
+		for (j = 0; j < 3; j++)
+		{
+			positions[i * 3 + j] = XMFLOAT3(center.x + random(), center.y + random(), center.z + random());
+			indices[i * 3 + j] = i * 3 + j;
+		}
+	}
+
+	if (!bvh.BuildTriangles(&jobSystem, positions.data(), indices.data(), triangleCount))
+	{
+		fprintf(stderr, "Could not build the BVH over %d triangles\n", triangleCount);
+		return 1;
+	}
+
+	rays.resize(rayCount);
+	hits.resize(rayCount);
+	for (i = 0; i < rayCount; i++)
+	{
+		rays[i].origin = XMFLOAT3(100.0f * random(), 100.0f * random(), -10.0f);
+		rays[i].direction = XMFLOAT3(random() - 0.5f, random() - 0.5f, 1.0f);
+		rays[i].maxDistance = 1000.0f;
+	}
+
+	bvh.IntersectRays(&jobSystem, rays.data(), rayCount, hits.data());
+
+	hitCount = 0;
+	for (i = 0; i < rayCount; i++)
+	{
+		if (hits[i].primitive >= 0)
+		{
+			hitCount++;
+		}
+	}
+
+	printf("%d triangles: build %.2f ms on %d threads, %d nodes, %d rays %d hits, %.2f million rays/s\n", triangleCount, bvh.GetBuildTime(),
+		jobSystem.GetThreadCount(), bvh.GetNodeCount(), rayCount, hitCount, bvh.GetRaysPerSecond() / 1000000.0f);
+
+	bvh.Shutdown();
+	jobSystem.Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,1026 @@
+#include "../Headers/bvhclass.h"
+
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+#include <mutex>
+#include <chrono>
+
+//	The cost of visiting a node relative to testing one primitive, used by the surface area heuristic.
+const float BVH_TRAVERSAL_COST = 1.0f;
+
+//	The number of primitives per batch when bounds and bins are gathered on the job threads.
+const int BVH_BUILD_BATCH_SIZE = 4096;
+
+BVHClass::BVHClass()
+{
+	m_triangleMode = false;
+	m_buildTime = 0.0f;
+	m_raysPerSecond = 0.0f;
+}
+
+BVHClass::BVHClass(const BVHClass& other)
+{
+
+}
+
+BVHClass::~BVHClass()
+{
+
+}
+
+//	BuildTriangles builds the tree over an indexed triangle list. The triangles are copied in the order of
+//	the leaves, each as a vertex and two edges, which is what the ray test needs.
+bool BVHClass::BuildTriangles(JobSystemClass* jobSystem, const XMFLOAT3* positions, const unsigned long* indices, int triangleCount)
+{
+	vector<TriangleType> triangles;
+	XMVECTOR vertex0, vertex1, vertex2;
+	int i;
+	bool result;
+
+	ShutdownTree();
+
+	if (triangleCount <= 0)
+	{
+		return false;
+	}
+
+	m_triangleMode = true;
+	triangles.resize(triangleCount);
+	m_primitiveBounds.resize(triangleCount);
+
+	for (i = 0; i < triangleCount; i++)
+	{
+		vertex0 = XMLoadFloat3(&positions[indices[i * 3]]);
+		vertex1 = XMLoadFloat3(&positions[indices[i * 3 + 1]]);
+		vertex2 = XMLoadFloat3(&positions[indices[i * 3 + 2]]);
+
+		XMStoreFloat3(&triangles[i].vertex, vertex0);
+		XMStoreFloat3(&triangles[i].edge1, XMVectorSubtract(vertex1, vertex0));
+		XMStoreFloat3(&triangles[i].edge2, XMVectorSubtract(vertex2, vertex0));
+
+		XMStoreFloat3(&m_primitiveBounds[i].minimum, XMVectorMin(XMVectorMin(vertex0, vertex1), vertex2));
+		XMStoreFloat3(&m_primitiveBounds[i].maximum, XMVectorMax(XMVectorMax(vertex0, vertex1), vertex2));
+	}
+
+	result = Build(jobSystem);
+	if (!result)
+	{
+		ShutdownTree();
+		return false;
+	}
+
+	m_triangles.resize(triangleCount);
+	for (i = 0; i < triangleCount; i++)
+	{
+		m_triangles[i] = triangles[m_primitiveOrder[i]];
+	}
+
+//	The triangle boxes were only needed for the build, triangles can't be moved:
+	m_primitiveBounds.clear();
+	m_primitiveBounds.shrink_to_fit();
+
+	return true;
+}
+
+//	BuildBounds builds the tree over the boxes of objects. The boxes are kept so they can be moved later.
+bool BVHClass::BuildBounds(JobSystemClass* jobSystem, const BoundsType* bounds, int count)
+{
+	bool result;
+
+	ShutdownTree();
+
+	if (count <= 0)
+	{
+		return false;
+	}
+
+	m_triangleMode = false;
+	m_primitiveBounds.assign(bounds, bounds + count);
+
+	result = Build(jobSystem);
+	if (!result)
+	{
+		ShutdownTree();
+		return false;
+	}
+
+	return true;
+}
+
+void BVHClass::Shutdown()
+{
+	ShutdownTree();
+	m_intersectFunction = nullptr;
+
+	return;
+}
+
+//	SetIntersectFunction sets the test for the objects of a tree built with BuildBounds. Without one a ray
+//	hits an object where it enters its box. IntersectRays calls it from the job threads.
+void BVHClass::SetIntersectFunction(const IntersectFunctionType& intersectFunction)
+{
+	m_intersectFunction = intersectFunction;
+	return;
+}
+
+//	UpdateBounds moves the box of an object and marks the nodes above it for the next Refit. The walk up
+//	stops at the first node already marked, since everything above it is marked too.
+void BVHClass::UpdateBounds(int primitive, const BoundsType& bounds)
+{
+	int node;
+
+	if (m_triangleMode || primitive < 0 || primitive >= (int)m_primitiveBounds.size())
+	{
+		return;
+	}
+
+	m_primitiveBounds[primitive] = bounds;
+
+	node = m_leafNodes[primitive];
+	while (node >= 0 && !m_nodes[node].dirty)
+	{
+		m_nodes[node].dirty = true;
+		m_dirtyNodes.push_back(node);
+		node = m_nodes[node].parent;
+	}
+
+	return;
+}
+
+//	Refit recomputes the child boxes of the marked nodes. Children always come after their parent in the
+//	node array, so going through the marked nodes from the highest index down finishes every child before
+//	its parent reads it.
+void BVHClass::Refit()
+{
+	BoundsType bounds, childBounds;
+	int i, slot, child, primitive;
+
+	sort(m_dirtyNodes.begin(), m_dirtyNodes.end(), greater<int>());
+
+	for (i = 0; i < (int)m_dirtyNodes.size(); i++)
+	{
+		NodeType& node = m_nodes[m_dirtyNodes[i]];
+
+		for (slot = 0; slot < BVH_WIDTH; slot++)
+		{
+			if (node.children[slot] < 0)
+			{
+				continue;
+			}
+
+			ResetBounds(bounds);
+
+			if (node.counts[slot] > 0)
+			{
+				for (primitive = node.children[slot]; primitive < node.children[slot] + node.counts[slot]; primitive++)
+				{
+					GrowBounds(bounds, m_primitiveBounds[m_primitiveOrder[primitive]]);
+				}
+			}
+			else
+			{
+				const NodeType& childNode = m_nodes[node.children[slot]];
+				for (child = 0; child < BVH_WIDTH; child++)
+				{
+					if (childNode.children[child] < 0)
+					{
+						continue;
+					}
+
+					childBounds.minimum = XMFLOAT3((&childNode.minimumX.x)[child], (&childNode.minimumY.x)[child], (&childNode.minimumZ.x)[child]);
+					childBounds.maximum = XMFLOAT3((&childNode.maximumX.x)[child], (&childNode.maximumY.x)[child], (&childNode.maximumZ.x)[child]);
+					GrowBounds(bounds, childBounds);
+				}
+			}
+
+			(&node.minimumX.x)[slot] = bounds.minimum.x;
+			(&node.minimumY.x)[slot] = bounds.minimum.y;
+			(&node.minimumZ.x)[slot] = bounds.minimum.z;
+			(&node.maximumX.x)[slot] = bounds.maximum.x;
+			(&node.maximumY.x)[slot] = bounds.maximum.y;
+			(&node.maximumZ.x)[slot] = bounds.maximum.z;
+		}
+
+		node.dirty = false;
+	}
+
+	m_dirtyNodes.clear();
+
+	return;
+}
+
+//	Intersect finds the closest hit along a ray up to the maximum distance.
+bool BVHClass::Intersect(FXMVECTOR origin, FXMVECTOR direction, float maxDistance, HitType& hit)
+{
+	return Traverse(origin, direction, maxDistance, false, hit);
+}
+
+//	IntersectAny returns as soon as anything is hit, which is all a line of sight test needs.
+bool BVHClass::IntersectAny(FXMVECTOR origin, FXMVECTOR direction, float maxDistance)
+{
+	HitType hit;
+
+	return Traverse(origin, direction, maxDistance, true, hit);
+}
+
+//	IntersectSegment finds the closest hit between two points. The distance of the hit is the fraction of
+//	the way from the start to the end.
+bool BVHClass::IntersectSegment(FXMVECTOR start, FXMVECTOR end, HitType& hit)
+{
+	return Traverse(start, XMVectorSubtract(end, start), 1.0f, false, hit);
+}
+
+//	IntersectRays finds the closest hit of every ray on the job threads and measures the rays per second.
+void BVHClass::IntersectRays(JobSystemClass* jobSystem, const RayType* rays, int count, HitType* hits)
+{
+	chrono::high_resolution_clock::time_point startTime;
+	float elapsed;
+
+	startTime = chrono::high_resolution_clock::now();
+
+	jobSystem->ParallelFor(count, BVH_RAY_BATCH_SIZE, [this, rays, hits](int begin, int end)
+	{
+		int i;
+
+		for (i = begin; i < end; i++)
+		{
+			Traverse(XMLoadFloat3(&rays[i].origin), XMLoadFloat3(&rays[i].direction), rays[i].maxDistance, false, hits[i]);
+		}
+	});
+
+	elapsed = chrono::duration<float>(chrono::high_resolution_clock::now() - startTime).count();
+	if (elapsed > 0.0f)
+	{
+		m_raysPerSecond = (float)count / elapsed;
+	}
+
+	return;
+}
+
+//	IntersectBounds is the slab test of a ray against a single box. A ray starting inside the box hits it
+//	at a distance of zero.
+bool BVHClass::IntersectBounds(const BoundsType& bounds, FXMVECTOR origin, FXMVECTOR direction, float maxDistance, float& distance)
+{
+	XMVECTOR inverseDirection, t0, t1;
+	XMFLOAT3 nearDistances, farDistances;
+	float nearDistance, farDistance;
+
+	inverseDirection = XMVectorReciprocal(XMVectorSelect(direction, XMVectorReplicate(1.0e-20f), XMVectorLess(XMVectorAbs(direction), XMVectorReplicate(1.0e-20f))));
+
+	t0 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&bounds.minimum), origin), inverseDirection);
+	t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&bounds.maximum), origin), inverseDirection);
+
+	XMStoreFloat3(&nearDistances, XMVectorMin(t0, t1));
+	XMStoreFloat3(&farDistances, XMVectorMax(t0, t1));
+
+	nearDistance = 0.0f;
+	nearDistance = (nearDistances.x > nearDistance) ? nearDistances.x : nearDistance;
+	nearDistance = (nearDistances.y > nearDistance) ? nearDistances.y : nearDistance;
+	nearDistance = (nearDistances.z > nearDistance) ? nearDistances.z : nearDistance;
+
+	farDistance = maxDistance;
+	farDistance = (farDistances.x < farDistance) ? farDistances.x : farDistance;
+	farDistance = (farDistances.y < farDistance) ? farDistances.y : farDistance;
+	farDistance = (farDistances.z < farDistance) ? farDistances.z : farDistance;
+
+	if (nearDistance > farDistance)
+	{
+		return false;
+	}
+
+	distance = nearDistance;
+
+	return true;
+}
+
+int BVHClass::GetPrimitiveCount()
+{
+	return (int)m_primitiveOrder.size();
+}
+
+int BVHClass::GetNodeCount()
+{
+	return (int)m_nodes.size();
+}
+
+float BVHClass::GetBuildTime()
+{
+	return m_buildTime;
+}
+
+float BVHClass::GetRaysPerSecond()
+{
+	return m_raysPerSecond;
+}
+
+void BVHClass::ShutdownTree()
+{
+	m_nodes.clear();
+	m_primitiveOrder.clear();
+	m_leafNodes.clear();
+	m_primitiveBounds.clear();
+	m_centroids.clear();
+	m_triangles.clear();
+	m_dirtyNodes.clear();
+
+	return;
+}
+
+//	Build makes the tree over m_primitiveBounds. The nodes near the root hold most of the primitives, so
+//	they are split one at a time with their bounds and bins gathered on all job threads. Once there are
+//	enough open nodes to keep every thread busy, or the open nodes have become small, each of them is
+//	built into a subtree of its own on one thread, and the subtrees are appended to the top of the tree.
+bool BVHClass::Build(JobSystemClass* jobSystem)
+{
+	chrono::high_resolution_clock::time_point startTime;
+	vector<BuildNodeType> buildNodes;
+	vector<vector<BuildNodeType> > subtrees;
+	vector<BuildTaskType> openTasks, tasks;
+	BuildTaskType task, childTask;
+	BuildNodeType node;
+	int count, targetTasks, splitIndex, base, i, j;
+	bool split;
+
+	startTime = chrono::high_resolution_clock::now();
+
+	count = (int)m_primitiveBounds.size();
+	m_centroids.resize(count);
+	m_primitiveOrder.resize(count);
+
+	jobSystem->ParallelFor(count, BVH_BUILD_BATCH_SIZE, [this](int begin, int end)
+	{
+		int i;
+
+		for (i = begin; i < end; i++)
+		{
+			XMStoreFloat3(&m_centroids[i], XMVectorScale(XMVectorAdd(XMLoadFloat3(&m_primitiveBounds[i].minimum), XMLoadFloat3(&m_primitiveBounds[i].maximum)), 0.5f));
+			m_primitiveOrder[i] = i;
+		}
+	});
+
+	node.left = -1;
+	node.right = -1;
+	node.first = 0;
+	node.count = count;
+	ResetBounds(node.bounds);
+	buildNodes.push_back(node);
+
+	task.node = 0;
+	task.first = 0;
+	task.count = count;
+	openTasks.push_back(task);
+
+	targetTasks = jobSystem->GetThreadCount() * 4;
+
+	for (i = 0; i < (int)openTasks.size(); i++)
+	{
+		task = openTasks[i];
+
+		if (task.count < BVH_PARALLEL_THRESHOLD || (int)tasks.size() + (int)openTasks.size() - i >= targetTasks)
+		{
+			tasks.push_back(task);
+			continue;
+		}
+
+		split = SplitNode(jobSystem, task.first, task.count, buildNodes[task.node].bounds, splitIndex);
+		if (!split)
+		{
+			buildNodes[task.node].first = task.first;
+			buildNodes[task.node].count = task.count;
+			continue;
+		}
+
+		node.left = -1;
+		node.right = -1;
+		node.first = 0;
+		node.count = 0;
+		ResetBounds(node.bounds);
+
+		buildNodes[task.node].left = (int)buildNodes.size();
+		buildNodes[task.node].right = (int)buildNodes.size() + 1;
+		buildNodes[task.node].count = 0;
+
+		childTask.node = (int)buildNodes.size();
+		childTask.first = task.first;
+		childTask.count = splitIndex - task.first;
+		buildNodes.push_back(node);
+		openTasks.push_back(childTask);
+
+		childTask.node = (int)buildNodes.size();
+		childTask.first = splitIndex;
+		childTask.count = task.first + task.count - splitIndex;
+		buildNodes.push_back(node);
+		openTasks.push_back(childTask);
+	}
+
+//	Build the subtrees below the open nodes, one job each:
+	subtrees.resize(tasks.size());
+	jobSystem->ParallelFor((int)tasks.size(), 1, [this, &tasks, &subtrees](int begin, int end)
+	{
+		int i;
+
+		for (i = begin; i < end; i++)
+		{
+			BuildSubtree(subtrees[i], tasks[i].first, tasks[i].count);
+		}
+	});
+
+//	The root of each subtree takes the place of its open node and the rest is appended, with the child
+//	indices moved along:
+	for (i = 0; i < (int)tasks.size(); i++)
+	{
+		base = (int)buildNodes.size();
+		for (j = 0; j < (int)subtrees[i].size(); j++)
+		{
+			node = subtrees[i][j];
+			if (node.left >= 0)
+			{
+				node.left = base + node.left - 1;
+				node.right = base + node.right - 1;
+			}
+
+			if (j == 0)
+			{
+				buildNodes[tasks[i].node] = node;
+			}
+			else
+			{
+				buildNodes.push_back(node);
+			}
+		}
+	}
+
+	m_nodes.clear();
+	m_nodes.reserve(buildNodes.size() / 2 + 1);
+	m_leafNodes.resize(count);
+	CollapseNode(buildNodes, 0, -1);
+
+	m_centroids.clear();
+	m_centroids.shrink_to_fit();
+
+	m_buildTime = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+
+	return true;
+}
+
+//	SplitNode works out the bounds of a range of primitives and, unless it should stay a leaf, partitions
+//	it at the cheapest bin boundary the surface area heuristic finds. Ranges whose centroids can't be told
+//	apart, or that no bin boundary splits, are cut in half when they are too large for a leaf.
+bool BVHClass::SplitNode(JobSystemClass* jobSystem, int first, int count, BoundsType& bounds, int& splitIndex)
+{
+	BinType bins[3][BVH_BIN_COUNT];
+	BoundsType centroidBounds, leftBounds, rightBounds[BVH_BIN_COUNT];
+	float extent[3], cost, bestCost, parentArea, scale, minimum;
+	int axis, bin, leftCount, rightCounts[BVH_BIN_COUNT], bestAxis, bestBin;
+	int* middle;
+
+	ComputeBounds(jobSystem, first, count, bounds, centroidBounds);
+
+	if (count <= 1)
+	{
+		return false;
+	}
+
+	extent[0] = centroidBounds.maximum.x - centroidBounds.minimum.x;
+	extent[1] = centroidBounds.maximum.y - centroidBounds.minimum.y;
+	extent[2] = centroidBounds.maximum.z - centroidBounds.minimum.z;
+
+	bestAxis = -1;
+	bestBin = 0;
+	bestCost = FLT_MAX;
+
+	if (extent[0] > 0.0f || extent[1] > 0.0f || extent[2] > 0.0f)
+	{
+		BinPrimitives(jobSystem, first, count, centroidBounds, bins);
+
+		for (axis = 0; axis < 3; axis++)
+		{
+			if (extent[axis] <= 0.0f)
+			{
+				continue;
+			}
+
+//	Sweep from the right to get the bounds and counts of every right side, then from the left to cost
+//	every split between two bins:
+			ResetBounds(rightBounds[BVH_BIN_COUNT - 1]);
+			GrowBounds(rightBounds[BVH_BIN_COUNT - 1], bins[axis][BVH_BIN_COUNT - 1].bounds);
+			rightCounts[BVH_BIN_COUNT - 1] = bins[axis][BVH_BIN_COUNT - 1].count;
+			for (bin = BVH_BIN_COUNT - 2; bin >= 0; bin--)
+			{
+				rightBounds[bin] = rightBounds[bin + 1];
+				GrowBounds(rightBounds[bin], bins[axis][bin].bounds);
+				rightCounts[bin] = rightCounts[bin + 1] + bins[axis][bin].count;
+			}
+
+			ResetBounds(leftBounds);
+			leftCount = 0;
+			for (bin = 0; bin < BVH_BIN_COUNT - 1; bin++)
+			{
+				GrowBounds(leftBounds, bins[axis][bin].bounds);
+				leftCount += bins[axis][bin].count;
+
+				if (leftCount == 0 || rightCounts[bin + 1] == 0)
+				{
+					continue;
+				}
+
+				cost = GetSurfaceArea(leftBounds) * (float)leftCount + GetSurfaceArea(rightBounds[bin + 1]) * (float)rightCounts[bin + 1];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = bin;
+				}
+			}
+		}
+	}
+
+//	Small ranges stay leaves unless splitting is cheaper than testing every primitive:
+	parentArea = GetSurfaceArea(bounds);
+	if (count <= BVH_LEAF_SIZE && (bestAxis < 0 || parentArea <= 0.0f || BVH_TRAVERSAL_COST + bestCost / parentArea >= (float)count))
+	{
+		return false;
+	}
+
+	splitIndex = first + count / 2;
+
+	if (bestAxis >= 0)
+	{
+		minimum = (&centroidBounds.minimum.x)[bestAxis];
+		scale = (float)BVH_BIN_COUNT / extent[bestAxis];
+
+		middle = partition(&m_primitiveOrder[first], &m_primitiveOrder[first] + count, [this, bestAxis, bestBin, minimum, scale](int primitive)
+		{
+			int bin;
+
+			bin = (int)(((&m_centroids[primitive].x)[bestAxis] - minimum) * scale);
+			return ((bin < BVH_BIN_COUNT) ? bin : BVH_BIN_COUNT - 1) <= bestBin;
+		});
+
+		if (middle != &m_primitiveOrder[first] && middle != &m_primitiveOrder[first] + count)
+		{
+			splitIndex = first + (int)(middle - &m_primitiveOrder[first]);
+		}
+	}
+
+	return true;
+}
+
+//	ComputeBounds gathers the bounds of a range of primitives and of their centroids. Large ranges are
+//	split over the job threads, which merge their results under a lock once per batch.
+void BVHClass::ComputeBounds(JobSystemClass* jobSystem, int first, int count, BoundsType& bounds, BoundsType& centroidBounds)
+{
+	mutex boundsMutex;
+
+	ResetBounds(bounds);
+	ResetBounds(centroidBounds);
+
+	auto gather = [this, first, &bounds, &centroidBounds, &boundsMutex](int begin, int end)
+	{
+		BoundsType localBounds, localCentroids, centroid;
+		int i, primitive;
+
+		ResetBounds(localBounds);
+		ResetBounds(localCentroids);
+
+		for (i = first + begin; i < first + end; i++)
+		{
+			primitive = m_primitiveOrder[i];
+			GrowBounds(localBounds, m_primitiveBounds[primitive]);
+
+			centroid.minimum = m_centroids[primitive];
+			centroid.maximum = m_centroids[primitive];
+			GrowBounds(localCentroids, centroid);
+		}
+
+		lock_guard<mutex> lock(boundsMutex);
+		GrowBounds(bounds, localBounds);
+		GrowBounds(centroidBounds, localCentroids);
+	};
+
+	if (jobSystem && count >= BVH_PARALLEL_THRESHOLD)
+	{
+		jobSystem->ParallelFor(count, BVH_BUILD_BATCH_SIZE, gather);
+	}
+	else
+	{
+		gather(0, count);
+	}
+
+	return;
+}
+
+//	BinPrimitives sorts a range of primitives into equal bins along the centroid bounds on each axis,
+//	keeping the count and bounds of every bin.
+void BVHClass::BinPrimitives(JobSystemClass* jobSystem, int first, int count, const BoundsType& centroidBounds, BinType bins[3][BVH_BIN_COUNT])
+{
+	mutex binMutex;
+	float scale[3];
+	int axis, bin;
+
+	for (axis = 0; axis < 3; axis++)
+	{
+		scale[axis] = ((&centroidBounds.maximum.x)[axis] > (&centroidBounds.minimum.x)[axis]) ?
+			(float)BVH_BIN_COUNT / ((&centroidBounds.maximum.x)[axis] - (&centroidBounds.minimum.x)[axis]) : 0.0f;
+
+		for (bin = 0; bin < BVH_BIN_COUNT; bin++)
+		{
+			ResetBounds(bins[axis][bin].bounds);
+			bins[axis][bin].count = 0;
+		}
+	}
+
+	auto gather = [this, first, &centroidBounds, &scale, bins, &binMutex](int begin, int end)
+	{
+		BinType localBins[3][BVH_BIN_COUNT];
+		int i, primitive, axis, bin;
+
+		for (axis = 0; axis < 3; axis++)
+		{
+			for (bin = 0; bin < BVH_BIN_COUNT; bin++)
+			{
+				ResetBounds(localBins[axis][bin].bounds);
+				localBins[axis][bin].count = 0;
+			}
+		}
+
+		for (i = first + begin; i < first + end; i++)
+		{
+			primitive = m_primitiveOrder[i];
+			for (axis = 0; axis < 3; axis++)
+			{
+				bin = (int)(((&m_centroids[primitive].x)[axis] - (&centroidBounds.minimum.x)[axis]) * scale[axis]);
+				bin = (bin < BVH_BIN_COUNT) ? bin : BVH_BIN_COUNT - 1;
+				GrowBounds(localBins[axis][bin].bounds, m_primitiveBounds[primitive]);
+				localBins[axis][bin].count++;
+			}
+		}
+
+		lock_guard<mutex> lock(binMutex);
+		for (axis = 0; axis < 3; axis++)
+		{
+			for (bin = 0; bin < BVH_BIN_COUNT; bin++)
+			{
+				GrowBounds(bins[axis][bin].bounds, localBins[axis][bin].bounds);
+				bins[axis][bin].count += localBins[axis][bin].count;
+			}
+		}
+	};
+
+	if (jobSystem && count >= BVH_PARALLEL_THRESHOLD)
+	{
+		jobSystem->ParallelFor(count, BVH_BUILD_BATCH_SIZE, gather);
+	}
+	else
+	{
+		gather(0, count);
+	}
+
+	return;
+}
+
+//	BuildSubtree builds a range of primitives into binary nodes on the calling thread. The root of the
+//	subtree is always the first node it adds.
+int BVHClass::BuildSubtree(vector<BuildNodeType>& nodes, int first, int count)
+{
+	BuildNodeType node;
+	int index, splitIndex, left, right;
+	bool split;
+
+	index = (int)nodes.size();
+	node.left = -1;
+	node.right = -1;
+	node.first = first;
+	node.count = count;
+	nodes.push_back(node);
+
+	split = SplitNode(0, first, count, nodes[index].bounds, splitIndex);
+	if (!split)
+	{
+		return index;
+	}
+
+	left = BuildSubtree(nodes, first, splitIndex - first);
+	right = BuildSubtree(nodes, splitIndex, first + count - splitIndex);
+
+	nodes[index].left = left;
+	nodes[index].right = right;
+	nodes[index].count = 0;
+
+	return index;
+}
+
+//	CollapseNode turns a binary node and the nodes below it into wide nodes. The children of the binary
+//	node are opened, largest surface first, until there are four of them or only leaves are left. The
+//	wide node is added before its children, which Refit relies on.
+int BVHClass::CollapseNode(const vector<BuildNodeType>& buildNodes, int binaryIndex, int parent)
+{
+	int candidates[BVH_WIDTH];
+	float area, bestArea;
+	int count, best, index, child, primitive, i;
+
+	if (buildNodes[binaryIndex].left < 0)
+	{
+		candidates[0] = binaryIndex;
+		count = 1;
+	}
+	else
+	{
+		candidates[0] = buildNodes[binaryIndex].left;
+		candidates[1] = buildNodes[binaryIndex].right;
+		count = 2;
+
+		while (count < BVH_WIDTH)
+		{
+			best = -1;
+			bestArea = -1.0f;
+			for (i = 0; i < count; i++)
+			{
+				area = GetSurfaceArea(buildNodes[candidates[i]].bounds);
+				if (buildNodes[candidates[i]].left >= 0 && area > bestArea)
+				{
+					best = i;
+					bestArea = area;
+				}
+			}
+
+			if (best < 0)
+			{
+				break;
+			}
+
+			child = candidates[best];
+			candidates[best] = buildNodes[child].left;
+			candidates[count] = buildNodes[child].right;
+			count++;
+		}
+	}
+
+	index = (int)m_nodes.size();
+	m_nodes.push_back(NodeType());
+	m_nodes[index].minimumX = m_nodes[index].minimumY = m_nodes[index].minimumZ = XMFLOAT4A(0.0f, 0.0f, 0.0f, 0.0f);
+	m_nodes[index].maximumX = m_nodes[index].maximumY = m_nodes[index].maximumZ = XMFLOAT4A(0.0f, 0.0f, 0.0f, 0.0f);
+	m_nodes[index].parent = parent;
+	m_nodes[index].dirty = false;
+	for (i = 0; i < BVH_WIDTH; i++)
+	{
+		m_nodes[index].children[i] = -1;
+		m_nodes[index].counts[i] = 0;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		const BuildNodeType& node = buildNodes[candidates[i]];
+
+		(&m_nodes[index].minimumX.x)[i] = node.bounds.minimum.x;
+		(&m_nodes[index].minimumY.x)[i] = node.bounds.minimum.y;
+		(&m_nodes[index].minimumZ.x)[i] = node.bounds.minimum.z;
+		(&m_nodes[index].maximumX.x)[i] = node.bounds.maximum.x;
+		(&m_nodes[index].maximumY.x)[i] = node.bounds.maximum.y;
+		(&m_nodes[index].maximumZ.x)[i] = node.bounds.maximum.z;
+
+		if (node.left < 0)
+		{
+			m_nodes[index].children[i] = node.first;
+			m_nodes[index].counts[i] = node.count;
+			for (primitive = node.first; primitive < node.first + node.count; primitive++)
+			{
+				m_leafNodes[m_primitiveOrder[primitive]] = index;
+			}
+		}
+		else
+		{
+//	The recursion adds nodes, so the new node is only looked up again once it returns:
+			child = CollapseNode(buildNodes, candidates[i], index);
+			m_nodes[index].children[i] = child;
+		}
+	}
+
+	return index;
+}
+
+//	Traverse walks the tree from the root, testing the ray against the four child boxes of a node at once.
+//	Leaves are tested right away, which can only bring the closest hit nearer, and the inner children that
+//	were hit are pushed furthest first so the nearest one is visited next. Nodes on the stack that start
+//	beyond the closest hit found since they were pushed are skipped.
+bool BVHClass::Traverse(FXMVECTOR origin, FXMVECTOR direction, float maxDistance, bool anyHit, HitType& hit)
+{
+	int stackNodes[BVH_STACK_SIZE];
+	float stackDistances[BVH_STACK_SIZE];
+	int innerNodes[BVH_WIDTH];
+	float innerDistances[BVH_WIDTH];
+	XMVECTOR inverseDirection, originX, originY, originZ, inverseX, inverseY, inverseZ;
+	XMVECTOR t0, t1, nearDistance, farDistance;
+	XMFLOAT4A nearDistances;
+	XMUINT4 hitFlags;
+	int stackSize, innerCount, child, i, j;
+	float distance;
+
+	hit.primitive = -1;
+	hit.distance = maxDistance;
+	hit.u = 0.0f;
+	hit.v = 0.0f;
+
+	if (m_nodes.empty())
+	{
+		return false;
+	}
+
+//	Keep axis parallel rays from dividing by zero:
+	inverseDirection = XMVectorReciprocal(XMVectorSelect(direction, XMVectorReplicate(1.0e-20f), XMVectorLess(XMVectorAbs(direction), XMVectorReplicate(1.0e-20f))));
+
+	originX = XMVectorSplatX(origin);
+	originY = XMVectorSplatY(origin);
+	originZ = XMVectorSplatZ(origin);
+	inverseX = XMVectorSplatX(inverseDirection);
+	inverseY = XMVectorSplatY(inverseDirection);
+	inverseZ = XMVectorSplatZ(inverseDirection);
+
+	stackNodes[0] = 0;
+	stackDistances[0] = 0.0f;
+	stackSize = 1;
+
+	while (stackSize > 0)
+	{
+		stackSize--;
+		if (stackDistances[stackSize] > hit.distance)
+		{
+			continue;
+		}
+
+		const NodeType& node = m_nodes[stackNodes[stackSize]];
+
+		t0 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat4A(&node.minimumX), originX), inverseX);
+		t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat4A(&node.maximumX), originX), inverseX);
+		nearDistance = XMVectorMax(XMVectorMin(t0, t1), XMVectorZero());
+		farDistance = XMVectorMin(XMVectorMax(t0, t1), XMVectorReplicate(hit.distance));
+
+		t0 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat4A(&node.minimumY), originY), inverseY);
+		t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat4A(&node.maximumY), originY), inverseY);
+		nearDistance = XMVectorMax(XMVectorMin(t0, t1), nearDistance);
+		farDistance = XMVectorMin(XMVectorMax(t0, t1), farDistance);
+
+		t0 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat4A(&node.minimumZ), originZ), inverseZ);
+		t1 = XMVectorMultiply(XMVectorSubtract(XMLoadFloat4A(&node.maximumZ), originZ), inverseZ);
+		nearDistance = XMVectorMax(XMVectorMin(t0, t1), nearDistance);
+		farDistance = XMVectorMin(XMVectorMax(t0, t1), farDistance);
+
+		XMStoreFloat4A(&nearDistances, nearDistance);
+		XMStoreUInt4(&hitFlags, XMVectorLessOrEqual(nearDistance, farDistance));
+
+		innerCount = 0;
+		for (i = 0; i < BVH_WIDTH; i++)
+		{
+			child = node.children[i];
+			if (child < 0 || (&hitFlags.x)[i] == 0)
+			{
+				continue;
+			}
+
+			if (node.counts[i] > 0)
+			{
+				if (IntersectLeaf(child, node.counts[i], origin, direction, anyHit, hit) && anyHit)
+				{
+					return true;
+				}
+				continue;
+			}
+
+//	Insert the child so the list stays sorted from furthest to nearest:
+			distance = (&nearDistances.x)[i];
+			for (j = innerCount; j > 0 && innerDistances[j - 1] < distance; j--)
+			{
+				innerNodes[j] = innerNodes[j - 1];
+				innerDistances[j] = innerDistances[j - 1];
+			}
+			innerNodes[j] = child;
+			innerDistances[j] = distance;
+			innerCount++;
+		}
+
+		for (i = 0; i < innerCount && stackSize < BVH_STACK_SIZE; i++)
+		{
+			stackNodes[stackSize] = innerNodes[i];
+			stackDistances[stackSize] = innerDistances[i];
+			stackSize++;
+		}
+	}
+
+	return hit.primitive >= 0;
+}
+
+//	IntersectLeaf tests the primitives of a leaf and keeps the closest hit. Triangles use the Moller
+//	Trumbore test, which hits both sides, objects their intersect function or else their box.
+bool BVHClass::IntersectLeaf(int first, int count, FXMVECTOR origin, FXMVECTOR direction, bool anyHit, HitType& hit)
+{
+	XMVECTOR edge1, edge2, p, q, s;
+	float determinant, inverseDeterminant, u, v, distance;
+	int i;
+	bool found;
+
+	found = false;
+
+	for (i = first; i < first + count; i++)
+	{
+		if (m_triangleMode)
+		{
+			edge1 = XMLoadFloat3(&m_triangles[i].edge1);
+			edge2 = XMLoadFloat3(&m_triangles[i].edge2);
+
+			p = XMVector3Cross(direction, edge2);
+			determinant = XMVectorGetX(XMVector3Dot(edge1, p));
+			if (fabsf(determinant) < 1.0e-12f)
+			{
+				continue;
+			}
+			inverseDeterminant = 1.0f / determinant;
+
+			s = XMVectorSubtract(origin, XMLoadFloat3(&m_triangles[i].vertex));
+			u = XMVectorGetX(XMVector3Dot(s, p)) * inverseDeterminant;
+			if (u < 0.0f || u > 1.0f)
+			{
+				continue;
+			}
+
+			q = XMVector3Cross(s, edge1);
+			v = XMVectorGetX(XMVector3Dot(direction, q)) * inverseDeterminant;
+			if (v < 0.0f || u + v > 1.0f)
+			{
+				continue;
+			}
+
+			distance = XMVectorGetX(XMVector3Dot(edge2, q)) * inverseDeterminant;
+			if (distance < 0.0f || distance >= hit.distance)
+			{
+				continue;
+			}
+		}
+		else if (m_intersectFunction)
+		{
+			u = v = 0.0f;
+			if (!m_intersectFunction(m_primitiveOrder[i], origin, direction, hit.distance, distance) || distance >= hit.distance)
+			{
+				continue;
+			}
+		}
+		else
+		{
+			u = v = 0.0f;
+			if (!IntersectBounds(m_primitiveBounds[m_primitiveOrder[i]], origin, direction, hit.distance, distance) || distance >= hit.distance)
+			{
+				continue;
+			}
+		}
+
+		hit.primitive = m_primitiveOrder[i];
+		hit.distance = distance;
+		hit.u = u;
+		hit.v = v;
+		found = true;
+
+		if (anyHit)
+		{
+			return true;
+		}
+	}
+
+	return found;
+}
+
+void BVHClass::ResetBounds(BoundsType& bounds)
+{
+	bounds.minimum = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+	bounds.maximum = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+	return;
+}
+
+void BVHClass::GrowBounds(BoundsType& bounds, const BoundsType& other)
+{
+	bounds.minimum.x = (other.minimum.x < bounds.minimum.x) ? other.minimum.x : bounds.minimum.x;
+	bounds.minimum.y = (other.minimum.y < bounds.minimum.y) ? other.minimum.y : bounds.minimum.y;
+	bounds.minimum.z = (other.minimum.z < bounds.minimum.z) ? other.minimum.z : bounds.minimum.z;
+	bounds.maximum.x = (other.maximum.x > bounds.maximum.x) ? other.maximum.x : bounds.maximum.x;
+	bounds.maximum.y = (other.maximum.y > bounds.maximum.y) ? other.maximum.y : bounds.maximum.y;
+	bounds.maximum.z = (other.maximum.z > bounds.maximum.z) ? other.maximum.z : bounds.maximum.z;
+
+	return;
+}
+
+//	GetSurfaceArea returns half the surface area of a box, which is all the heuristic needs since it only
+//	compares areas. Empty boxes have none.
+float BVHClass::GetSurfaceArea(const BoundsType& bounds)
+{
+	float x, y, z;
+
+	x = bounds.maximum.x - bounds.minimum.x;
+	y = bounds.maximum.y - bounds.minimum.y;
+	z = bounds.maximum.z - bounds.minimum.z;
+	if (x < 0.0f || y < 0.0f || z < 0.0f)
+	{
+		return 0.0f;
+	}
+
+	return x * y + y * z + z * x;
+}
@@ -110,5 +110,29 @@ void CameraClass::Render()
 void CameraClass::GetViewMatrix(XMMATRIX& viewMatrix)
 {
 	viewMatrix = m_viewMatrix;
+	return;
+}
+
+//	GetPickingRay turns a point on the screen into a ray in world space. The point is moved into view space
+//	by undoing the scaling of the projection, where the ray leaves the camera at a depth of one, and then
+//	into world space by the inverse of the view matrix. The direction is not normalized.
+void CameraClass::GetPickingRay(int mouseX, int mouseY, int screenWidth, int screenHeight, XMMATRIX projectionMatrix, XMVECTOR& origin, XMVECTOR& direction)
+{
+	XMFLOAT4X4 projection;
+	XMMATRIX inverseViewMatrix;
+	float x, y;
+
+
+	XMStoreFloat4x4(&projection, projectionMatrix);
+
+// Move the mouse position into the -1 to +1 range of the screen and undo the projection.
+	x = (2.0f * (float)mouseX / (float)screenWidth - 1.0f) / projection._11;
+	y = (1.0f - 2.0f * (float)mouseY / (float)screenHeight) / projection._22;
+
+	inverseViewMatrix = XMMatrixInverse(NULL, m_viewMatrix);
+
+	origin = XMVector3TransformCoord(XMVectorZero(), inverseViewMatrix);
+	direction = XMVector3TransformNormal(XMVectorSet(x, y, 1.0f, 0.0f), inverseViewMatrix);
+
 	return;
 }
\ No newline at end of file
@@ -19,17 +19,41 @@ cbuffer MatrixBuffer
 //  semantics are different for vertex and pixel shaders even though the structure are the same.
 //  POSIION works for pixel shaders while COLOR works for both.
 
+//  The input layout is built from the vertex formats in vertexformatclass.h, and every member here has to
+//  be in the format of the permutation with the same semantic and number of components, or the layout is
+//  not created: the position is a float3 because ColorVertexType stores three floats. The permutation
+//  defines add members: INSTANCED reads a world matrix and a color per instance from ColorInstanceType in
+//  the second vertex buffer, TEXTURED adds texture coordinates. QUANTIZED changes nothing in here, it only
+//  feeds the shader from the compact formats, whose colors the input assembler expands from bytes. LIT passes the view space position on to the
+//  pixel shader, which needs it to find the light cluster of the pixel and to light it.
+
 //  Typedefs:
 struct VertexInputType
 {
-    float4 position : POSITION;
-    float4 color : COLOR;  
+    float3 position : POSITION;
+    float4 color : COLOR;
+#ifdef TEXTURED
+    float2 tex : TEXCOORD0;
+#endif
+#ifdef INSTANCED
+    float4 instanceWorld0 : INSTANCEWORLD0;
+    float4 instanceWorld1 : INSTANCEWORLD1;
+    float4 instanceWorld2 : INSTANCEWORLD2;
+    float4 instanceWorld3 : INSTANCEWORLD3;
+    float4 instanceColor : INSTANCECOLOR;
+#endif
 };
 
 struct PixelInputType
 {
     float4 position : SV_Position;
     float4 color : COLOR;
+#ifdef TEXTURED
+    float2 tex : TEXCOORD0;
+#endif
+#ifdef LIT
+    float3 viewPosition : TEXCOORD1;
+#endif
 };
 
 //  The vertex shader is called by the GPU when it is processing data from the vertex buffers
@@ -50,17 +74,36 @@ struct PixelInputType
 PixelInputType ColorVertexShader(VertexInputType input)
 {
     PixelInputType output;
+    float4 position;
+#ifdef INSTANCED
+    float4x4 instanceWorld;
+#endif
     
 //  Change the position vector to be 4 units for proper matrix calculations.
-    input.position.w = 1.0f;
+    position = float4(input.position, 1.0f);
     
 //  Calculate the position of the vertex against the world, view, and projection matrices.
-    output.position = mul(input.position, worldMatrix);
+//  Instanced draws take the world matrix from the instance data instead of the constant buffer.
+#ifdef INSTANCED
+    instanceWorld = float4x4(input.instanceWorld0, input.instanceWorld1, input.instanceWorld2, input.instanceWorld3);
+    output.position = mul(position, instanceWorld);
+#else
+    output.position = mul(position, worldMatrix);
+#endif
     output.position = mul(output.position, viewMatrix);
+#ifdef LIT
+    output.viewPosition = output.position.xyz;
+#endif
     output.position = mul(output.position, projectionMatrix);
     
 //  Store the input color for the pixel shader to use.
     output.color = input.color;
+#ifdef INSTANCED
+    output.color = output.color * input.instanceColor;
+#endif
+#ifdef TEXTURED
+    output.tex = input.tex;
+#endif
     
     return output;
 };
\ No newline at end of file
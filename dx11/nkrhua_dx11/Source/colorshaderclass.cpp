@@ -2,10 +2,11 @@
 
 ColorShaderClass::ColorShaderClass()
 {
-	m_vertexShader = 0;
-	m_pixelShader = 0;
-	m_layout = 0;
-	m_matrixBuffer = 0;
+	m_ShaderManager = 0;
+	m_shaderFamily = -1;
+	m_permutation = 0;
+	m_ResourceRegistry = 0;
+	m_matrixBuffer.id = 0;
 }
 
 ColorShaderClass::ColorShaderClass(const ColorShaderClass& other)
@@ -18,15 +19,38 @@ ColorShaderClass::~ColorShaderClass()
 
 }
 
+//	Precompile has the Shader Manager compile the permutations Initialize is going to ask for, which needs
+//	no device, so it can be done while the device is still being created.
+void ColorShaderClass::Precompile(ShaderManagerClass* shaderManager)
+{
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+
+	if (wcscpy_s(vsFilename, 128, L"./Source/color.vs") != 0 || wcscpy_s(psFilename, 128, L"./Source/color.ps") != 0)
+	{
+		return;
+	}
+
+	shaderManager->Precompile(vsFilename, "ColorVertexShader", psFilename, "ColorPixelShader",
+		SHADER_INSTANCED | SHADER_QUANTIZED | SHADER_TEXTURED | SHADER_LIT);
+
+	return;
+}
+
 //	The initialize function will call the initialization function for the shaders.
-//	We pass in the name of the HLSL shader files.
-bool ColorShaderClass::Initialize(ID3D11Device* device, HWND hwnd)
+//	We pass in the name of the HLSL shader files. The shaders themselves are compiled
+//	and owned by the Shader Manager so identical permutations are shared with other classes. The
+//	constant buffer is owned by the Resource Registry.
+bool ColorShaderClass::Initialize(ID3D11Device* device, ResourceRegistryClass* resourceRegistry, ShaderManagerClass* shaderManager)
 {
 	bool result;
 	wchar_t vsFilename[128];
 	wchar_t psFilename[128];
 	int error;
 
+	m_ResourceRegistry = resourceRegistry;
+	m_ShaderManager = shaderManager;
+
 //	Set the filename of the Vertex Shader:
 	error = wcscpy_s(vsFilename, 128, L"./Source/color.vs");
 	if (error != 0)
@@ -42,7 +66,7 @@ bool ColorShaderClass::Initialize(ID3D11Device* device, HWND hwnd)
 	}
 
 //	Initialize the Vertex and Pixel Shaders:
-	result = InitializeShader(device, hwnd, vsFilename, psFilename);
+	result = InitializeShader(device, vsFilename, psFilename);
 	if (!result)
 	{
 		return false;
@@ -75,139 +99,85 @@ bool ColorShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCount
 	}
 
 //	Now render the prepared buffer with the shader:
-	RenderShader(deviceContext, indexCount);
+	RenderShader(deviceContext, indexCount, 0, 0);
 
 	return true;
 }
 
-//	Now we will start with one of the more important functions called InitializeShader.
-//	The function is what actually loads the shader files and makes it usable to DirectX and GPU.
-bool ColorShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR* vsFilename, WCHAR* psFilename)
+//	This Render draws a range of the prepared buffers, for models that share their buffers with others
+//	in the Geometry Heap. The indices are relative to the base vertex.
+bool ColorShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCount, int startIndex, int baseVertex,
+	XMMATRIX worldMatrix, XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
 {
-	HRESULT result;
-	ID3D10Blob* errorMessage;
-	ID3D10Blob* vertexShaderBuffer;
-	ID3D10Blob* pixelShaderBuffer;
-	D3D11_INPUT_ELEMENT_DESC polygonLayout[2];
-	unsigned int numElements;
-	D3D11_BUFFER_DESC matrixBufferDesc;
-
-//	Initialize the pointers this function will use to null:
-	errorMessage = 0;
-	vertexShaderBuffer = 0;
-	pixelShaderBuffer = 0;
-
-//	Here is where we compile the shader programs into buffers. We give it the name of the Shader file,
-//	the name of the shader, the shader version (5.0 in DirectX 11), and the Buffer to compile the Shader
-// 	into. If it fails compiling the Shader it will put an error message inside the errorMessage string which
-// 	we send to another function to write out the error. If it stills fails and there is no errorMessage string
-// 	then it means it could not find the Shader file in which case we pop up a dialog box saying so.
+	bool result;
 
-//	Compile the Vertex Shader color:
-	result = D3DCompileFromFile(vsFilename, NULL, NULL, "ColorVertexShader", 
-		"vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, &vertexShaderBuffer, &errorMessage);
-	if (FAILED(result))
+	result = SetShaderParameters(deviceContext, worldMatrix, viewMatrix, projectionMatrix);
+	if (!result)
 	{
-//	If the Shader failed to compile it should have writen something to the Error Message.
-		if (errorMessage)
-		{
-			OutputShaderErrorMessage(errorMessage, hwnd, vsFilename);
-		}
-//	If there was nothing in the error message then it simply could not find the Shader itself.
-		else
-		{
-			MessageBox(hwnd, vsFilename, L"Missing Shader File", MB_OK);
-		}
-
 		return false;
 	}
 
-//	Compile the Pixel Shader Code:
-	result = D3DCompileFromFile(psFilename, NULL, NULL, "ColorPixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, &pixelShaderBuffer, &errorMessage);
-	if (FAILED(result))
-	{
-	//	If the Shader failed to compile it should have writen something to the error message.
-		if (errorMessage)
-		{
-			OutputShaderErrorMessage(errorMessage, hwnd, psFilename);
-		}
-	//	If there was nothing in the error message then it simply could not find the file itself.
-		else
-		{
-			MessageBox(hwnd, psFilename, L"Missing Shader File", MB_OK);
-		}
+	RenderShader(deviceContext, indexCount, startIndex, baseVertex);
 
-		return false;
-	}
+	return true;
+}
 
-//	Once the Vertex Shader and Pixel Shader code has successfully compiled into buffers,
-//	we then use those Buffers to create the Shader objects themselves. We will use these
-// 	pointers to interface with the Vertex and Pixel Shader from this point forward.
+//	RenderInstanced draws the prepared model once for every instance in the second vertex buffer. The
+//	world matrix comes from the instance data, so only the view and projection matrices are passed, and
+//	the INSTANCED permutation has to be set for the shader to read the instances.
+bool ColorShaderClass::RenderInstanced(ID3D11DeviceContext* deviceContext, int indexCount, int instanceCount,
+	XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+{
+	bool result;
 
-//	Create the Vertex Shader from the Buffer:
-	result = device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &m_vertexShader);
-	if (FAILED(result))
+	result = SetShaderParameters(deviceContext, XMMatrixIdentity(), viewMatrix, projectionMatrix);
+	if (!result)
 	{
 		return false;
 	}
 
-//	Create the Pixel Shader from the Buffer:
-	result = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_pixelShader);
-	if (FAILED(result))
-	{
-		return false;
-	}
+	RenderShaderInstanced(deviceContext, indexCount, instanceCount);
 
-//	The next step is to create the Layout of the Vertex Data that will be processed by the Shader.
-//	As this shader uses a position and color vector, we need to create both in the layout specifying
-// 	the size of both. The semantic name is the first thing to fill out in the layout, this allows the
-// 	shader to determine the usage of this element of the layout. As we have two different elements, we
-// 	use the POSITION for the first one and COLOR for the second. 
-// 	The next important part is the Format. For the Position Vector we use DXGI_FORMAT_R32G32B32_FLOAT and
-// 	for the color we use DXGI_FORMAT_R32G32B32A32_FLOAT. The final thing is the AlignedByteOffset which
-// 	indicates how the data is spaced in the Buffer. For this layout we are telling it the first 12 bytes
-// 	are POSITION and the next 16 will be COLOR. You can also use the D3D11_APPEND_ALIGNED_ELEMENT instead
-// 	of placing your own values in AlignedByteOffset and it will figure out spacing for you.
-
-//	Create the Vertex Input Layout description:
-//	This Setup needs to match the VertexType structure in the ModelClass and in the Shader:
-	polygonLayout[0].SemanticName = "POSITION";
-	polygonLayout[0].SemanticIndex = 0;
-	polygonLayout[0].Format = DXGI_FORMAT_R32G32B32_FLOAT;
-	polygonLayout[0].InputSlot = 0;
-	polygonLayout[0].AlignedByteOffset = 0;
-	polygonLayout[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	polygonLayout[0].InstanceDataStepRate = 0;
-
-	polygonLayout[1].SemanticName = "COLOR";
-	polygonLayout[1].SemanticIndex = 0;
-	polygonLayout[1].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-	polygonLayout[1].InputSlot = 0;
-	polygonLayout[1].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
-	polygonLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
-	polygonLayout[1].InstanceDataStepRate = 0;
-
-//	Once the layout description has been setup, we can get the size of it and then create
-//	the input layout using the D3D device. Also release the Vertex and Pixel Shader Buffers
-// 	since they're not longer needed once the layout has been created.
-
-//	Get a count of the elements in the Layout:
-	numElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
-
-//	Create the Vertex Input Layout:
-	result = device->CreateInputLayout(polygonLayout, numElements, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), &m_layout);
-	if (FAILED(result))
+	return true;
+}
+
+void ColorShaderClass::SetPermutation(unsigned int permutation)
+{
+	m_permutation = permutation;
+	return;
+}
+
+//	Now we will start with one of the more important functions called InitializeShader.
+//	The function is what actually loads the shader files and makes it usable to DirectX and GPU.
+bool ColorShaderClass::InitializeShader(ID3D11Device* device, WCHAR* vsFilename, WCHAR* psFilename)
+{
+	HRESULT result;
+	D3D11_BUFFER_DESC matrixBufferDesc;
+	ID3D11Buffer* matrixBuffer;
+	ShaderInputType inputs[4];
+
+//	Here is where we compile the shader programs. The Shader Manager compiles one variant of the Vertex
+//	and Pixel Shader for every combination of the defines we say this shader supports, and builds the
+//	Input Layout of each variant from the vertex formats declared in vertexformatclass.h. That is why there
+//	is no polygonLayout here anymore. The QUANTIZED variants are fed the compact formats and the TEXTURED
+//	variants the ones with texture coordinates. If compiling fails, or color.vs reads something the format
+//	of a variant does not have, the manager writes out the error message.
+	inputs[0].flags = 0;
+	inputs[0].format = &ColorVertexType::GetFormat();
+	inputs[1].flags = SHADER_QUANTIZED;
+	inputs[1].format = &ColorCompactVertexType::GetFormat();
+	inputs[2].flags = SHADER_TEXTURED;
+	inputs[2].format = &ColorTexturedVertexType::GetFormat();
+	inputs[3].flags = SHADER_QUANTIZED | SHADER_TEXTURED;
+	inputs[3].format = &ColorCompactTexturedVertexType::GetFormat();
+
+	m_shaderFamily = m_ShaderManager->AddShader(vsFilename, "ColorVertexShader", psFilename, "ColorPixelShader",
+		SHADER_INSTANCED | SHADER_QUANTIZED | SHADER_TEXTURED | SHADER_LIT, inputs, 4, &ColorInstanceType::GetFormat());
+	if (m_shaderFamily < 0)
 	{
 		return false;
 	}
 
-//	Release the Vertex Shader Buffer and Pixel Shader Buffer since theyre no longer needed:
-	vertexShaderBuffer->Release();
-	vertexShaderBuffer = 0;
-
-	pixelShaderBuffer->Release();
-	pixelShaderBuffer = 0;
-
 //	The final thing that needs to be setup to utilize the Shader is the Constant Buffer. As you
 //	saw in the Vertex Shader, we currently have just one constant buffer so we only need to setup
 //	one here so we can interface the shader. The Buffer usage needs to be set to dynamic since we
@@ -225,78 +195,30 @@ bool ColorShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR*
 	matrixBufferDesc.StructureByteStride = 0;
 
 //	Create the Constant Buffer Pointer so we can access the	Vertex Shader 
-//	Constant buffer from within this class:
-	result = device->CreateBuffer(&matrixBufferDesc, NULL, &m_matrixBuffer);
+//	Constant buffer from within this class, and hand it to the Resource Registry for a handle:
+	result = device->CreateBuffer(&matrixBufferDesc, NULL, &matrixBuffer);
 	if (FAILED(result))
 	{
 		return false;
 	}
 
+	m_matrixBuffer = m_ResourceRegistry->Register(matrixBuffer);
+
 	return true;
 }
 
 void ColorShaderClass::ShutdownShader()
 {
-//	Release the Matrix Buffer Constant:
-	if (m_matrixBuffer)
-	{
-		m_matrixBuffer->Release();
-		m_matrixBuffer = 0;
-	}
-//	Release the Layout
-	if (m_layout)
-	{
-		m_layout->Release();
-		m_layout = 0;
-	}
-//	Release the Pixel Shader:
-	if (m_pixelShader)
-	{
-		m_pixelShader->Release();
-		m_pixelShader = 0;
-	}
-//	Release the Vertex Shader:
-	if (m_vertexShader)
-	{
-		m_vertexShader->Release();
-		m_vertexShader = 0;
-	}
-
-	return;
-}
-
-//	The OutputShaderErrorMessage writes out error messages that are
-//	generating when compiling either Vertex Shaders or Pixel Shaders:
-void ColorShaderClass::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, WCHAR* shaderFilename)
-{
-	char* compileErrors;
-	unsigned long long bufferSize, i;
-	ofstream fout;
-
-//	Get a pointer to the error message text buffer:
-	compileErrors = (char*)(errorMessage->GetBufferPointer());
-
-//	Get the length of the Message:
-	bufferSize = errorMessage->GetBufferSize();
-
-//	Open a file to write the error message to:
-	fout.open("shader-error.txt");
-
-//	Write out the error message:
-	for (i = 0; i < bufferSize; i++)
+//	Release the Matrix Buffer Constant, the registry lets go of it once the frames using it are done:
+	if (m_ResourceRegistry)
 	{
-		fout << compileErrors[i];
+		m_ResourceRegistry->Release(m_matrixBuffer);
+		m_ResourceRegistry = 0;
 	}
 
-//	Close the file:
-	fout.close();
-
-//	Release the Error Message:
-	errorMessage->Release();
-	errorMessage = 0;
-
-//	Pop a message up on the screen to notify the user to check the text file for compile errors.
-	MessageBox(hwnd, L"Error compiling shader. Check shader-error.txt for message.", shaderFilename, MB_OK);
+//	The Shaders and the Layout belong to the Shader Manager which releases them on its own Shutdown.
+	m_shaderFamily = -1;
+	m_ShaderManager = 0;
 
 	return;
 }
@@ -312,16 +234,20 @@ bool ColorShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext, X
 	D3D11_MAPPED_SUBRESOURCE mappedResource;
 	MatrixBufferType* dataPTR;
 	unsigned int bufferNumber;
+	ID3D11Buffer* matrixBuffer;
+	XMFLOAT4X4 matrices[3];
 
 //	Make sure to transpose matrices before sending them into the shader, this is a requirement for DirectX 11.
-//	Transpose the matrices to prepare them for the Shader:
-	worldMatrix = XMMatrixTranspose(worldMatrix);
-	viewMatrix = XMMatrixTranspose(viewMatrix);
-	projectionMatrix = XMMatrixTranspose(projectionMatrix);
+//	The three matrices are stored next to each other so the batch kernels can transpose them on the way in:
+	XMStoreFloat4x4(&matrices[0], worldMatrix);
+	XMStoreFloat4x4(&matrices[1], viewMatrix);
+	XMStoreFloat4x4(&matrices[2], projectionMatrix);
 
 //	Lock the m_matrixBuffer, set the new Matrices inside it, and then unlock it.
-//	Lock the Constant Buffer so it can be written to:
-	result = deviceContext->Map(m_matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+//	Look the buffer up from its handle and lock it so it can be written to:
+	matrixBuffer = m_ResourceRegistry->Get(m_matrixBuffer);
+
+	result = deviceContext->Map(matrixBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
 	if (FAILED(result))
 	{
 		return false;
@@ -330,19 +256,17 @@ bool ColorShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext, X
 //	Get a pointer to the data in the Constant Buffer:
 	dataPTR = (MatrixBufferType*)mappedResource.pData;
 
-//	Copy the matrices into the Constant Buffer:
-	dataPTR->world = worldMatrix;
-	dataPTR->view = viewMatrix;
-	dataPTR->projection = projectionMatrix;
+//	Transpose the matrices straight into the Constant Buffer, which holds them in the same order:
+	BatchMathClass::TransposeMatrices(matrices, 3, (XMFLOAT4X4*)dataPTR);
 
 //	Unlock the Constant Buffer:
-	deviceContext->Unmap(m_matrixBuffer, 0);
+	deviceContext->Unmap(matrixBuffer, 0);
 
 //	Now set the Update Matrix Buffer in the HLSL Vertex Shader:
 	bufferNumber = 0;
 
 //	Finaly set the Constant Buffer in the Vertex Shade with the Updated Values:
-	deviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
+	deviceContext->VSSetConstantBuffers(bufferNumber, 1, &matrixBuffer);
 
 	return true;
 }
@@ -351,20 +275,26 @@ bool ColorShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext, X
 //	SetShaderParameters is called before this to ensure the Shader Parameters are setup correctly.
 //	The first step in this function is to set our Input Layout to active in the Input Assembler.
 //	This lets the GPU know the format of the Vertex Buffer. The second step is to set the Vertex
-//	Shader and Pixel Shader we will be using to render this Vertex Buffer. Once the Shaders are set
-//	we render the triangle by calling the DrawIndexed DirectX 11 function using the D3D Device Context.
+//	Shader and Pixel Shader we will be using to render this Vertex Buffer. Both come from the
+//	current permutation, which the Shader Manager finds with a single array lookup. Once the Shaders
+//	are set we render the triangle by calling the DrawIndexed DirectX 11 function using the D3D Device Context.
 //	Once this function is called it will render the green triangle.
-void ColorShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
+void ColorShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount, int startIndex, int baseVertex)
 {
-//	Set the Vertex Input Layout:
-	deviceContext->IASetInputLayout(m_layout);
-
-//	Set the Vertex and Pixel Shaders that will be used to render this triangle.
-	deviceContext->VSSetShader(m_vertexShader, NULL, 0);
-	deviceContext->PSSetShader(m_pixelShader, NULL, 0);
+//	Set the Vertex Input Layout and the Vertex and Pixel Shaders that will be used to render this triangle:
+	m_ShaderManager->SetShader(deviceContext, m_shaderFamily, m_permutation);
 
 //	Render the triangle:
-	deviceContext->DrawIndexed(indexCount, 0, 0);
+	deviceContext->DrawIndexed(indexCount, startIndex, baseVertex);
+
+	return;
+}
+
+void ColorShaderClass::RenderShaderInstanced(ID3D11DeviceContext* deviceContext, int indexCount, int instanceCount)
+{
+	m_ShaderManager->SetShader(deviceContext, m_shaderFamily, m_permutation);
+
+	deviceContext->DrawIndexedInstanced(indexCount, instanceCount, 0, 0, 0);
 
 	return;
 }
\ No newline at end of file
@@ -0,0 +1,1117 @@
+#include "../Headers/commandcaptureclass.h"
+
+#include <string.h>
+
+CommandCaptureClass::CommandCaptureClass()
+{
+	m_device = 0;
+	m_file = 0;
+	memset(&m_header, 0, sizeof(m_header));
+}
+
+CommandCaptureClass::CommandCaptureClass(const CommandCaptureClass& other) : DeviceContextProxyClass()
+{
+
+}
+
+CommandCaptureClass::~CommandCaptureClass()
+{
+
+}
+
+bool CommandCaptureClass::Initialize(ID3D11DeviceContext* deviceContext, const char* filename)
+{
+	SetDeviceContext(deviceContext);
+	m_deviceContext->GetDevice(&m_device);
+
+//	The header is written again with the counts when the capture ends:
+	if (fopen_s(&m_file, filename, "wb") != 0)
+	{
+		m_file = 0;
+		return false;
+	}
+
+	memcpy(m_header.magic, "CMD1", 4);
+	m_header.version = COMMAND_FILE_VERSION;
+	fwrite(&m_header, sizeof(m_header), 1, m_file);
+
+	CaptureState();
+
+	return true;
+}
+
+void CommandCaptureClass::Shutdown()
+{
+	int i;
+
+//	Write the counts into the header and close the file:
+	if (m_file)
+	{
+		fseek(m_file, 0, SEEK_SET);
+		fwrite(&m_header, sizeof(m_header), 1, m_file);
+		fclose(m_file);
+		m_file = 0;
+	}
+
+//	Let go of everything that was held for the capture:
+	for (i = 0; i < (int)m_definedObjects.size(); i++)
+	{
+		m_definedObjects[i]->Release();
+	}
+	m_definedObjects.clear();
+	m_objects.clear();
+	m_shadows.clear();
+	m_mapped.clear();
+
+	if (m_device)
+	{
+		m_device->Release();
+		m_device = 0;
+	}
+
+	SetDeviceContext(0);
+
+	return;
+}
+
+void CommandCaptureClass::EndFrame()
+{
+	WriteRecord(COMMAND_FRAME_END, 0, 0);
+	m_header.frameCount++;
+
+	return;
+}
+
+int CommandCaptureClass::GetFrameCount()
+{
+	return (int)m_header.frameCount;
+}
+
+//	TagShader attaches the bytecode a shader was created from to it, for the capture to define it with.
+void CommandCaptureClass::TagShader(ID3D11DeviceChild* shader, const void* bytecode, SIZE_T bytecodeSize)
+{
+	shader->SetPrivateData(COMMAND_CAPTURE_GUID, (UINT)bytecodeSize, bytecode);
+
+	return;
+}
+
+//	TagInputLayout attaches the elements of an input layout to it in the form of the command file, the count
+//	followed by the elements, along with the bytecode of the vertex shader it was created for.
+void CommandCaptureClass::TagInputLayout(ID3D11InputLayout* layout, const D3D11_INPUT_ELEMENT_DESC* elements, UINT elementCount,
+	const void* bytecode, SIZE_T bytecodeSize)
+{
+	vector<unsigned char> tag;
+	CommandInputElementType element;
+	UINT i;
+
+	tag.insert(tag.end(), (const unsigned char*)&elementCount, (const unsigned char*)&elementCount + sizeof(UINT));
+
+	for (i = 0; i < elementCount; i++)
+	{
+		memset(&element, 0, sizeof(element));
+		strncpy_s(element.semanticName, sizeof(element.semanticName), elements[i].SemanticName, _TRUNCATE);
+		element.semanticIndex = elements[i].SemanticIndex;
+		element.format = elements[i].Format;
+		element.inputSlot = elements[i].InputSlot;
+		element.alignedByteOffset = elements[i].AlignedByteOffset;
+		element.inputSlotClass = elements[i].InputSlotClass;
+		element.instanceDataStepRate = elements[i].InstanceDataStepRate;
+
+		tag.insert(tag.end(), (const unsigned char*)&element, (const unsigned char*)&element + sizeof(element));
+	}
+
+	tag.insert(tag.end(), (const unsigned char*)bytecode, (const unsigned char*)bytecode + bytecodeSize);
+
+	layout->SetPrivateData(COMMAND_CAPTURE_GUID, (UINT)tag.size(), tag.data());
+
+	return;
+}
+
+//	CaptureState reads back everything bound to the stages that are recorded and binds it again through the
+//	capture, which records it as the first commands of the file.
+void CommandCaptureClass::CaptureState()
+{
+	ID3D11InputLayout* layout;
+	ID3D11Buffer* buffers[COMMAND_CAPTURE_SLOTS];
+	UINT strides[COMMAND_CAPTURE_SLOTS], offsets[COMMAND_CAPTURE_SLOTS];
+	ID3D11Buffer* indexBuffer;
+	DXGI_FORMAT indexFormat;
+	UINT indexOffset;
+	D3D11_PRIMITIVE_TOPOLOGY topology;
+	ID3D11VertexShader* vertexShader;
+	ID3D11PixelShader* pixelShader;
+	ID3D11ShaderResourceView* views[COMMAND_CAPTURE_SLOTS];
+	ID3D11SamplerState* samplers[COMMAND_CAPTURE_SLOTS];
+	ID3D11RenderTargetView* renderTargets[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT];
+	ID3D11DepthStencilView* depthStencilView;
+	ID3D11BlendState* blendState;
+	FLOAT blendFactor[4];
+	UINT sampleMask;
+	ID3D11DepthStencilState* depthStencilState;
+	UINT stencilRef;
+	ID3D11RasterizerState* rasterState;
+	D3D11_VIEWPORT viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+	UINT viewportCount, i;
+
+//	The input assembler:
+	m_deviceContext->IAGetInputLayout(&layout);
+	IASetInputLayout(layout);
+	if (layout)
+	{
+		layout->Release();
+	}
+
+	m_deviceContext->IAGetVertexBuffers(0, COMMAND_CAPTURE_SLOTS, buffers, strides, offsets);
+	IASetVertexBuffers(0, COMMAND_CAPTURE_SLOTS, buffers, strides, offsets);
+	for (i = 0; i < COMMAND_CAPTURE_SLOTS; i++)
+	{
+		if (buffers[i])
+		{
+			buffers[i]->Release();
+		}
+	}
+
+	m_deviceContext->IAGetIndexBuffer(&indexBuffer, &indexFormat, &indexOffset);
+	IASetIndexBuffer(indexBuffer, indexFormat, indexOffset);
+	if (indexBuffer)
+	{
+		indexBuffer->Release();
+	}
+
+	m_deviceContext->IAGetPrimitiveTopology(&topology);
+	IASetPrimitiveTopology(topology);
+
+//	The vertex shader stage:
+	m_deviceContext->VSGetShader(&vertexShader, NULL, NULL);
+	VSSetShader(vertexShader, NULL, 0);
+	if (vertexShader)
+	{
+		vertexShader->Release();
+	}
+
+	m_deviceContext->VSGetConstantBuffers(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT, buffers);
+	VSSetConstantBuffers(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT, buffers);
+	for (i = 0; i < D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT; i++)
+	{
+		if (buffers[i])
+		{
+			buffers[i]->Release();
+		}
+	}
+
+	m_deviceContext->VSGetShaderResources(0, COMMAND_CAPTURE_SLOTS, views);
+	VSSetShaderResources(0, COMMAND_CAPTURE_SLOTS, views);
+	m_deviceContext->VSGetSamplers(0, COMMAND_CAPTURE_SLOTS, samplers);
+	VSSetSamplers(0, COMMAND_CAPTURE_SLOTS, samplers);
+	for (i = 0; i < COMMAND_CAPTURE_SLOTS; i++)
+	{
+		if (views[i])
+		{
+			views[i]->Release();
+		}
+		if (samplers[i])
+		{
+			samplers[i]->Release();
+		}
+	}
+
+//	The pixel shader stage:
+	m_deviceContext->PSGetShader(&pixelShader, NULL, NULL);
+	PSSetShader(pixelShader, NULL, 0);
+	if (pixelShader)
+	{
+		pixelShader->Release();
+	}
+
+	m_deviceContext->PSGetConstantBuffers(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT, buffers);
+	PSSetConstantBuffers(0, D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT, buffers);
+	for (i = 0; i < D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT; i++)
+	{
+		if (buffers[i])
+		{
+			buffers[i]->Release();
+		}
+	}
+
+	m_deviceContext->PSGetShaderResources(0, COMMAND_CAPTURE_SLOTS, views);
+	PSSetShaderResources(0, COMMAND_CAPTURE_SLOTS, views);
+	m_deviceContext->PSGetSamplers(0, COMMAND_CAPTURE_SLOTS, samplers);
+	PSSetSamplers(0, COMMAND_CAPTURE_SLOTS, samplers);
+	for (i = 0; i < COMMAND_CAPTURE_SLOTS; i++)
+	{
+		if (views[i])
+		{
+			views[i]->Release();
+		}
+		if (samplers[i])
+		{
+			samplers[i]->Release();
+		}
+	}
+
+//	The output merger and the rasterizer:
+	m_deviceContext->OMGetRenderTargets(D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT, renderTargets, &depthStencilView);
+	OMSetRenderTargets(D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT, renderTargets, depthStencilView);
+	for (i = 0; i < D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT; i++)
+	{
+		if (renderTargets[i])
+		{
+			renderTargets[i]->Release();
+		}
+	}
+	if (depthStencilView)
+	{
+		depthStencilView->Release();
+	}
+
+	m_deviceContext->OMGetBlendState(&blendState, blendFactor, &sampleMask);
+	OMSetBlendState(blendState, blendFactor, sampleMask);
+	if (blendState)
+	{
+		blendState->Release();
+	}
+
+	m_deviceContext->OMGetDepthStencilState(&depthStencilState, &stencilRef);
+	OMSetDepthStencilState(depthStencilState, stencilRef);
+	if (depthStencilState)
+	{
+		depthStencilState->Release();
+	}
+
+	m_deviceContext->RSGetState(&rasterState);
+	RSSetState(rasterState);
+	if (rasterState)
+	{
+		rasterState->Release();
+	}
+
+	viewportCount = D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE;
+	m_deviceContext->RSGetViewports(&viewportCount, viewports);
+	RSSetViewports(viewportCount, viewports);
+
+	return;
+}
+
+//	Define gives the number of an object in the file, defining it first if this is the first time it is
+//	named. The parent of a view is defined before the view, so it always has the lower number.
+unsigned int CommandCaptureClass::Define(ID3D11DeviceChild* object, unsigned int kind)
+{
+	unordered_map<ID3D11DeviceChild*, unsigned int>::iterator found;
+	CommandDefineType define;
+	CommandBufferDescType bufferDesc;
+	CommandTextureDescType textureDesc;
+	D3D11_BUFFER_DESC d3dBufferDesc;
+	D3D11_TEXTURE2D_DESC d3dTextureDesc;
+	D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceDesc;
+	D3D11_RENDER_TARGET_VIEW_DESC renderTargetDesc;
+	D3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc;
+	D3D11_RASTERIZER_DESC rasterDesc;
+	D3D11_BLEND_DESC blendDesc;
+	D3D11_DEPTH_STENCIL_DESC depthStencilDesc;
+	D3D11_SAMPLER_DESC samplerDesc;
+	ID3D11Resource* resource;
+	vector<unsigned char> desc, data, payload;
+	const void* descData;
+	unsigned int descSize, count;
+	UINT tagSize;
+
+	if (!object)
+	{
+		return 0;
+	}
+
+	found = m_objects.find(object);
+	if (found != m_objects.end())
+	{
+		return found->second;
+	}
+
+	define.kind = kind;
+	define.parent = 0;
+	descData = 0;
+	descSize = 0;
+
+	switch (kind)
+	{
+	case COMMAND_OBJECT_BUFFER:
+		((ID3D11Buffer*)object)->GetDesc(&d3dBufferDesc);
+		bufferDesc.byteWidth = d3dBufferDesc.ByteWidth;
+		bufferDesc.usage = d3dBufferDesc.Usage;
+		bufferDesc.bindFlags = d3dBufferDesc.BindFlags;
+		bufferDesc.cpuAccessFlags = d3dBufferDesc.CPUAccessFlags;
+		bufferDesc.miscFlags = d3dBufferDesc.MiscFlags;
+		bufferDesc.structureByteStride = d3dBufferDesc.StructureByteStride;
+		descData = &bufferDesc;
+		descSize = sizeof(bufferDesc);
+		ReadBuffer((ID3D11Buffer*)object, data);
+		break;
+
+	case COMMAND_OBJECT_TEXTURE2D:
+		((ID3D11Texture2D*)object)->GetDesc(&d3dTextureDesc);
+		textureDesc.width = d3dTextureDesc.Width;
+		textureDesc.height = d3dTextureDesc.Height;
+		textureDesc.mipLevels = d3dTextureDesc.MipLevels;
+		textureDesc.arraySize = d3dTextureDesc.ArraySize;
+		textureDesc.format = d3dTextureDesc.Format;
+		textureDesc.sampleCount = d3dTextureDesc.SampleDesc.Count;
+		textureDesc.sampleQuality = d3dTextureDesc.SampleDesc.Quality;
+		textureDesc.usage = d3dTextureDesc.Usage;
+		textureDesc.bindFlags = d3dTextureDesc.BindFlags;
+		textureDesc.cpuAccessFlags = d3dTextureDesc.CPUAccessFlags;
+		textureDesc.miscFlags = d3dTextureDesc.MiscFlags;
+		descData = &textureDesc;
+		descSize = sizeof(textureDesc);
+
+//	What a frame draws into is left without contents, and so is anything a staging copy can't be made of:
+		if ((d3dTextureDesc.BindFlags & (D3D11_BIND_RENDER_TARGET | D3D11_BIND_DEPTH_STENCIL)) == 0 && d3dTextureDesc.SampleDesc.Count == 1)
+		{
+			ReadTexture((ID3D11Texture2D*)object, data);
+		}
+		break;
+
+	case COMMAND_OBJECT_SHADER_RESOURCE_VIEW:
+	case COMMAND_OBJECT_RENDER_TARGET_VIEW:
+	case COMMAND_OBJECT_DEPTH_STENCIL_VIEW:
+		((ID3D11View*)object)->GetResource(&resource);
+		define.parent = DefineResource(resource);
+		resource->Release();
+
+		if (define.parent == 0)
+		{
+			return 0;
+		}
+
+		if (kind == COMMAND_OBJECT_SHADER_RESOURCE_VIEW)
+		{
+			((ID3D11ShaderResourceView*)object)->GetDesc(&shaderResourceDesc);
+			descData = &shaderResourceDesc;
+			descSize = sizeof(shaderResourceDesc);
+		}
+		else if (kind == COMMAND_OBJECT_RENDER_TARGET_VIEW)
+		{
+			((ID3D11RenderTargetView*)object)->GetDesc(&renderTargetDesc);
+			descData = &renderTargetDesc;
+			descSize = sizeof(renderTargetDesc);
+		}
+		else
+		{
+			((ID3D11DepthStencilView*)object)->GetDesc(&depthStencilViewDesc);
+			descData = &depthStencilViewDesc;
+			descSize = sizeof(depthStencilViewDesc);
+		}
+		break;
+
+	case COMMAND_OBJECT_RASTERIZER_STATE:
+		((ID3D11RasterizerState*)object)->GetDesc(&rasterDesc);
+		descData = &rasterDesc;
+		descSize = sizeof(rasterDesc);
+		break;
+
+	case COMMAND_OBJECT_BLEND_STATE:
+		((ID3D11BlendState*)object)->GetDesc(&blendDesc);
+		descData = &blendDesc;
+		descSize = sizeof(blendDesc);
+		break;
+
+	case COMMAND_OBJECT_DEPTH_STENCIL_STATE:
+		((ID3D11DepthStencilState*)object)->GetDesc(&depthStencilDesc);
+		descData = &depthStencilDesc;
+		descSize = sizeof(depthStencilDesc);
+		break;
+
+	case COMMAND_OBJECT_SAMPLER_STATE:
+		((ID3D11SamplerState*)object)->GetDesc(&samplerDesc);
+		descData = &samplerDesc;
+		descSize = sizeof(samplerDesc);
+		break;
+
+//	Shaders and input layouts have only what the Shader Manager attached to them. One it didn't create is
+//	defined empty, and the replay leaves it unbound:
+	case COMMAND_OBJECT_VERTEX_SHADER:
+	case COMMAND_OBJECT_PIXEL_SHADER:
+	case COMMAND_OBJECT_INPUT_LAYOUT:
+		tagSize = 0;
+		if (SUCCEEDED(object->GetPrivateData(COMMAND_CAPTURE_GUID, &tagSize, NULL)) && tagSize > 0)
+		{
+			data.resize(tagSize);
+			object->GetPrivateData(COMMAND_CAPTURE_GUID, &tagSize, data.data());
+		}
+		else
+		{
+			m_header.skippedCount++;
+		}
+
+		if (kind == COMMAND_OBJECT_INPUT_LAYOUT)
+		{
+			if (data.size() < sizeof(unsigned int))
+			{
+				data.clear();
+				count = 0;
+				data.insert(data.end(), (unsigned char*)&count, (unsigned char*)&count + sizeof(unsigned int));
+			}
+
+			memcpy(&count, data.data(), sizeof(unsigned int));
+			desc.assign(data.begin(), data.begin() + sizeof(unsigned int) + count * sizeof(CommandInputElementType));
+			data.erase(data.begin(), data.begin() + desc.size());
+			descData = desc.data();
+			descSize = (unsigned int)desc.size();
+		}
+		break;
+	}
+
+//	Number the object only now, after its parent:
+	define.object = (unsigned int)m_objects.size() + 1;
+	define.descSize = descSize;
+	define.dataSize = (unsigned int)data.size();
+
+	payload.resize(sizeof(define) + descSize + data.size());
+	memcpy(payload.data(), &define, sizeof(define));
+	if (descSize > 0)
+	{
+		memcpy(payload.data() + sizeof(define), descData, descSize);
+	}
+	if (!data.empty())
+	{
+		memcpy(payload.data() + sizeof(define) + descSize, data.data(), data.size());
+	}
+
+	WriteRecord(COMMAND_DEFINE, payload.data(), (unsigned int)payload.size());
+
+	object->AddRef();
+	m_definedObjects.push_back(object);
+	m_objects[object] = define.object;
+	m_header.objectCount++;
+
+//	A buffer the CPU writes to keeps a copy of what it holds, for Unmap to compare what was written with:
+	if (kind == COMMAND_OBJECT_BUFFER && (d3dBufferDesc.CPUAccessFlags & D3D11_CPU_ACCESS_WRITE))
+	{
+		m_shadows[define.object] = data;
+	}
+
+	return define.object;
+}
+
+//	DefineResource defines a resource as a buffer or a texture. Other kinds of resources aren't recorded.
+unsigned int CommandCaptureClass::DefineResource(ID3D11Resource* resource)
+{
+	D3D11_RESOURCE_DIMENSION dimension;
+
+	if (!resource)
+	{
+		return 0;
+	}
+
+	resource->GetType(&dimension);
+
+	if (dimension == D3D11_RESOURCE_DIMENSION_BUFFER)
+	{
+		return Define(resource, COMMAND_OBJECT_BUFFER);
+	}
+
+	if (dimension == D3D11_RESOURCE_DIMENSION_TEXTURE2D)
+	{
+		return Define(resource, COMMAND_OBJECT_TEXTURE2D);
+	}
+
+	m_header.skippedCount++;
+
+	return 0;
+}
+
+//	ReadBuffer copies a buffer into a staging buffer and reads that, which works whatever the buffer's usage.
+bool CommandCaptureClass::ReadBuffer(ID3D11Buffer* buffer, vector<unsigned char>& contents)
+{
+	D3D11_BUFFER_DESC bufferDesc, stagingDesc;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	ID3D11Buffer* staging;
+	HRESULT result;
+
+	buffer->GetDesc(&bufferDesc);
+
+	stagingDesc.ByteWidth = bufferDesc.ByteWidth;
+	stagingDesc.Usage = D3D11_USAGE_STAGING;
+	stagingDesc.BindFlags = 0;
+	stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	stagingDesc.MiscFlags = 0;
+	stagingDesc.StructureByteStride = 0;
+
+	result = m_device->CreateBuffer(&stagingDesc, NULL, &staging);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_deviceContext->CopyResource(staging, buffer);
+
+	result = m_deviceContext->Map(staging, 0, D3D11_MAP_READ, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		staging->Release();
+		return false;
+	}
+
+	contents.assign((unsigned char*)mappedResource.pData, (unsigned char*)mappedResource.pData + bufferDesc.ByteWidth);
+
+	m_deviceContext->Unmap(staging, 0);
+	staging->Release();
+
+	return true;
+}
+
+//	ReadTexture copies a texture into a staging texture and reads every subresource of it, each as its row
+//	pitch and row count followed by the rows.
+bool CommandCaptureClass::ReadTexture(ID3D11Texture2D* texture, vector<unsigned char>& contents)
+{
+	D3D11_TEXTURE2D_DESC stagingDesc;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	ID3D11Texture2D* staging;
+	unsigned int rowCount, height, subresource;
+	HRESULT result;
+
+	texture->GetDesc(&stagingDesc);
+	stagingDesc.Usage = D3D11_USAGE_STAGING;
+	stagingDesc.BindFlags = 0;
+	stagingDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	stagingDesc.MiscFlags = 0;
+
+	result = m_device->CreateTexture2D(&stagingDesc, NULL, &staging);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_deviceContext->CopyResource(staging, texture);
+
+	for (subresource = 0; subresource < stagingDesc.MipLevels * stagingDesc.ArraySize; subresource++)
+	{
+		result = m_deviceContext->Map(staging, subresource, D3D11_MAP_READ, 0, &mappedResource);
+		if (FAILED(result))
+		{
+			staging->Release();
+			contents.clear();
+			return false;
+		}
+
+//	The depth pitch of a 2D subresource is the size of all of its rows, which also counts block compressed
+//	rows right:
+		height = stagingDesc.Height >> (subresource % stagingDesc.MipLevels);
+		height = height > 0 ? height : 1;
+		rowCount = (mappedResource.RowPitch > 0 && mappedResource.DepthPitch >= mappedResource.RowPitch) ? mappedResource.DepthPitch / mappedResource.RowPitch : height;
+
+		contents.insert(contents.end(), (unsigned char*)&mappedResource.RowPitch, (unsigned char*)&mappedResource.RowPitch + sizeof(UINT));
+		contents.insert(contents.end(), (unsigned char*)&rowCount, (unsigned char*)&rowCount + sizeof(unsigned int));
+		contents.insert(contents.end(), (unsigned char*)mappedResource.pData, (unsigned char*)mappedResource.pData + mappedResource.RowPitch * rowCount);
+
+		m_deviceContext->Unmap(staging, subresource);
+	}
+
+	staging->Release();
+
+	return true;
+}
+
+//	RefreshShadow reads a buffer the CPU writes to again after the GPU has written to it, so Unmap still
+//	compares with what it holds.
+void CommandCaptureClass::RefreshShadow(ID3D11Resource* resource, unsigned int object)
+{
+	unordered_map<unsigned int, vector<unsigned char>>::iterator shadow;
+
+	shadow = m_shadows.find(object);
+	if (shadow != m_shadows.end())
+	{
+		ReadBuffer((ID3D11Buffer*)resource, shadow->second);
+	}
+
+	return;
+}
+
+//	RecordBindings records the objects bound to a range of slots of a stage. Every object is defined before
+//	the record is written, since each definition is a record of its own.
+void CommandCaptureClass::RecordBindings(unsigned int type, unsigned int stage, UINT startSlot, UINT count, ID3D11DeviceChild* const* objects, unsigned int kind)
+{
+	vector<unsigned int> values;
+	UINT i;
+
+	values.push_back(stage);
+	values.push_back(startSlot);
+	values.push_back(count);
+
+	for (i = 0; i < count; i++)
+	{
+		values.push_back(objects ? Define(objects[i], kind) : 0);
+	}
+
+	WriteRecord(type, values.data(), (unsigned int)(values.size() * sizeof(unsigned int)));
+
+	return;
+}
+
+//	WriteRecord writes a record with its payload rounded up to four bytes.
+void CommandCaptureClass::WriteRecord(unsigned int type, const void* payload, unsigned int size)
+{
+	CommandRecordType record;
+	unsigned int padding;
+
+	record.type = type;
+	record.size = size;
+	padding = 0;
+
+	fwrite(&record, sizeof(record), 1, m_file);
+	if (size > 0)
+	{
+		fwrite(payload, 1, size, m_file);
+		fwrite(&padding, 1, (4 - size % 4) % 4, m_file);
+	}
+
+	m_header.recordCount++;
+
+	return;
+}
+
+void CommandCaptureClass::IASetInputLayout(ID3D11InputLayout* layout)
+{
+	unsigned int value;
+
+	value = Define(layout, COMMAND_OBJECT_INPUT_LAYOUT);
+	WriteRecord(COMMAND_SET_INPUT_LAYOUT, &value, sizeof(value));
+
+	m_deviceContext->IASetInputLayout(layout);
+}
+
+void CommandCaptureClass::IASetVertexBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers, const UINT* strides, const UINT* offsets)
+{
+	vector<unsigned int> values;
+	UINT i;
+
+	values.push_back(startSlot);
+	values.push_back(count);
+
+	for (i = 0; i < count; i++)
+	{
+		values.push_back(buffers ? Define(buffers[i], COMMAND_OBJECT_BUFFER) : 0);
+		values.push_back(strides ? strides[i] : 0);
+		values.push_back(offsets ? offsets[i] : 0);
+	}
+
+	WriteRecord(COMMAND_SET_VERTEX_BUFFERS, values.data(), (unsigned int)(values.size() * sizeof(unsigned int)));
+
+	m_deviceContext->IASetVertexBuffers(startSlot, count, buffers, strides, offsets);
+}
+
+void CommandCaptureClass::IASetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset)
+{
+	unsigned int values[3];
+
+	values[0] = Define(buffer, COMMAND_OBJECT_BUFFER);
+	values[1] = format;
+	values[2] = offset;
+	WriteRecord(COMMAND_SET_INDEX_BUFFER, values, sizeof(values));
+
+	m_deviceContext->IASetIndexBuffer(buffer, format, offset);
+}
+
+void CommandCaptureClass::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	unsigned int value;
+
+	value = topology;
+	WriteRecord(COMMAND_SET_TOPOLOGY, &value, sizeof(value));
+
+	m_deviceContext->IASetPrimitiveTopology(topology);
+}
+
+//	Class instances aren't recorded, since nothing here uses dynamic linkage.
+void CommandCaptureClass::VSSetShader(ID3D11VertexShader* shader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount)
+{
+	unsigned int values[2];
+
+	values[0] = COMMAND_STAGE_VERTEX;
+	values[1] = Define(shader, COMMAND_OBJECT_VERTEX_SHADER);
+	WriteRecord(COMMAND_SET_SHADER, values, sizeof(values));
+
+	m_deviceContext->VSSetShader(shader, classInstances, classInstanceCount);
+}
+
+void CommandCaptureClass::VSSetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers)
+{
+	RecordBindings(COMMAND_SET_CONSTANT_BUFFERS, COMMAND_STAGE_VERTEX, startSlot, count, (ID3D11DeviceChild* const*)buffers, COMMAND_OBJECT_BUFFER);
+	m_deviceContext->VSSetConstantBuffers(startSlot, count, buffers);
+}
+
+void CommandCaptureClass::VSSetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	RecordBindings(COMMAND_SET_SHADER_RESOURCES, COMMAND_STAGE_VERTEX, startSlot, count, (ID3D11DeviceChild* const*)views, COMMAND_OBJECT_SHADER_RESOURCE_VIEW);
+	m_deviceContext->VSSetShaderResources(startSlot, count, views);
+}
+
+void CommandCaptureClass::VSSetSamplers(UINT startSlot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	RecordBindings(COMMAND_SET_SAMPLERS, COMMAND_STAGE_VERTEX, startSlot, count, (ID3D11DeviceChild* const*)samplers, COMMAND_OBJECT_SAMPLER_STATE);
+	m_deviceContext->VSSetSamplers(startSlot, count, samplers);
+}
+
+void CommandCaptureClass::PSSetShader(ID3D11PixelShader* shader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount)
+{
+	unsigned int values[2];
+
+	values[0] = COMMAND_STAGE_PIXEL;
+	values[1] = Define(shader, COMMAND_OBJECT_PIXEL_SHADER);
+	WriteRecord(COMMAND_SET_SHADER, values, sizeof(values));
+
+	m_deviceContext->PSSetShader(shader, classInstances, classInstanceCount);
+}
+
+void CommandCaptureClass::PSSetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers)
+{
+	RecordBindings(COMMAND_SET_CONSTANT_BUFFERS, COMMAND_STAGE_PIXEL, startSlot, count, (ID3D11DeviceChild* const*)buffers, COMMAND_OBJECT_BUFFER);
+	m_deviceContext->PSSetConstantBuffers(startSlot, count, buffers);
+}
+
+void CommandCaptureClass::PSSetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	RecordBindings(COMMAND_SET_SHADER_RESOURCES, COMMAND_STAGE_PIXEL, startSlot, count, (ID3D11DeviceChild* const*)views, COMMAND_OBJECT_SHADER_RESOURCE_VIEW);
+	m_deviceContext->PSSetShaderResources(startSlot, count, views);
+}
+
+void CommandCaptureClass::PSSetSamplers(UINT startSlot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	RecordBindings(COMMAND_SET_SAMPLERS, COMMAND_STAGE_PIXEL, startSlot, count, (ID3D11DeviceChild* const*)samplers, COMMAND_OBJECT_SAMPLER_STATE);
+	m_deviceContext->PSSetSamplers(startSlot, count, samplers);
+}
+
+void CommandCaptureClass::OMSetRenderTargets(UINT count, ID3D11RenderTargetView* const* renderTargets, ID3D11DepthStencilView* depthStencilView)
+{
+	vector<unsigned int> values;
+	UINT i;
+
+	values.push_back(count);
+	values.push_back(Define(depthStencilView, COMMAND_OBJECT_DEPTH_STENCIL_VIEW));
+
+	for (i = 0; i < count; i++)
+	{
+		values.push_back(renderTargets ? Define(renderTargets[i], COMMAND_OBJECT_RENDER_TARGET_VIEW) : 0);
+	}
+
+	WriteRecord(COMMAND_SET_RENDER_TARGETS, values.data(), (unsigned int)(values.size() * sizeof(unsigned int)));
+
+	m_deviceContext->OMSetRenderTargets(count, renderTargets, depthStencilView);
+}
+
+//	No blend factor is the same as a factor of one.
+void CommandCaptureClass::OMSetBlendState(ID3D11BlendState* state, const FLOAT blendFactor[4], UINT sampleMask)
+{
+	unsigned int values[6];
+	FLOAT factor[4];
+	int i;
+
+	for (i = 0; i < 4; i++)
+	{
+		factor[i] = blendFactor ? blendFactor[i] : 1.0f;
+	}
+
+	values[0] = Define(state, COMMAND_OBJECT_BLEND_STATE);
+	memcpy(&values[1], factor, sizeof(factor));
+	values[5] = sampleMask;
+	WriteRecord(COMMAND_SET_BLEND_STATE, values, sizeof(values));
+
+	m_deviceContext->OMSetBlendState(state, blendFactor, sampleMask);
+}
+
+void CommandCaptureClass::OMSetDepthStencilState(ID3D11DepthStencilState* state, UINT stencilRef)
+{
+	unsigned int values[2];
+
+	values[0] = Define(state, COMMAND_OBJECT_DEPTH_STENCIL_STATE);
+	values[1] = stencilRef;
+	WriteRecord(COMMAND_SET_DEPTH_STENCIL_STATE, values, sizeof(values));
+
+	m_deviceContext->OMSetDepthStencilState(state, stencilRef);
+}
+
+void CommandCaptureClass::RSSetState(ID3D11RasterizerState* state)
+{
+	unsigned int value;
+
+	value = Define(state, COMMAND_OBJECT_RASTERIZER_STATE);
+	WriteRecord(COMMAND_SET_RASTERIZER_STATE, &value, sizeof(value));
+
+	m_deviceContext->RSSetState(state);
+}
+
+void CommandCaptureClass::RSSetViewports(UINT count, const D3D11_VIEWPORT* viewports)
+{
+	vector<unsigned int> values;
+
+	values.resize(1 + count * 6);
+	values[0] = count;
+	if (count > 0)
+	{
+		memcpy(&values[1], viewports, count * sizeof(D3D11_VIEWPORT));
+	}
+
+	WriteRecord(COMMAND_SET_VIEWPORTS, values.data(), (unsigned int)(values.size() * sizeof(unsigned int)));
+
+	m_deviceContext->RSSetViewports(count, viewports);
+}
+
+void CommandCaptureClass::ClearRenderTargetView(ID3D11RenderTargetView* view, const FLOAT color[4])
+{
+	unsigned int values[5];
+
+	values[0] = Define(view, COMMAND_OBJECT_RENDER_TARGET_VIEW);
+	memcpy(&values[1], color, 4 * sizeof(FLOAT));
+	WriteRecord(COMMAND_CLEAR_RENDER_TARGET, values, sizeof(values));
+
+	m_deviceContext->ClearRenderTargetView(view, color);
+}
+
+void CommandCaptureClass::ClearDepthStencilView(ID3D11DepthStencilView* view, UINT clearFlags, FLOAT depth, UINT8 stencil)
+{
+	unsigned int values[4];
+
+	values[0] = Define(view, COMMAND_OBJECT_DEPTH_STENCIL_VIEW);
+	values[1] = clearFlags;
+	memcpy(&values[2], &depth, sizeof(FLOAT));
+	values[3] = stencil;
+	WriteRecord(COMMAND_CLEAR_DEPTH_STENCIL, values, sizeof(values));
+
+	m_deviceContext->ClearDepthStencilView(view, clearFlags, depth, stencil);
+}
+
+//	Map hands out a copy of what a buffer held when it is mapped to be written. Reading back, and writing to
+//	anything but a buffer, goes to the device context as it is.
+HRESULT CommandCaptureClass::Map(ID3D11Resource* resource, UINT subresource, D3D11_MAP mapType, UINT mapFlags, D3D11_MAPPED_SUBRESOURCE* mappedResource)
+{
+	D3D11_RESOURCE_DIMENSION dimension;
+	unordered_map<unsigned int, vector<unsigned char>>::iterator shadow;
+	MappedType mapped;
+	HRESULT result;
+
+	if (mapType == D3D11_MAP_READ)
+	{
+		return m_deviceContext->Map(resource, subresource, mapType, mapFlags, mappedResource);
+	}
+
+	resource->GetType(&dimension);
+	if (dimension != D3D11_RESOURCE_DIMENSION_BUFFER)
+	{
+		m_header.skippedCount++;
+		return m_deviceContext->Map(resource, subresource, mapType, mapFlags, mappedResource);
+	}
+
+	mapped.object = DefineResource(resource);
+
+	result = m_deviceContext->Map(resource, subresource, mapType, mapFlags, mappedResource);
+	if (FAILED(result))
+	{
+		return result;
+	}
+
+	shadow = m_shadows.find(mapped.object);
+	if (shadow == m_shadows.end())
+	{
+		m_header.skippedCount++;
+		return result;
+	}
+
+	mapped.resource = resource;
+	mapped.mapType = mapType;
+	mapped.data = mappedResource->pData;
+	mapped.contents = shadow->second;
+	m_mapped.push_back(mapped);
+
+	mappedResource->pData = m_mapped.back().contents.data();
+
+	return result;
+}
+
+//	Unmap records every run of blocks of the copy that changed since the buffer was last mapped and writes
+//	them to the buffer. A discarded buffer holds nothing until it is written, so all of the copy goes to it.
+void CommandCaptureClass::Unmap(ID3D11Resource* resource, UINT subresource)
+{
+	vector<unsigned char>* shadow;
+	MappedType* mapped;
+	unsigned int size, first, end, block, header[3];
+	int i;
+
+	mapped = 0;
+	for (i = 0; i < (int)m_mapped.size(); i++)
+	{
+		if (m_mapped[i].resource == resource)
+		{
+			mapped = &m_mapped[i];
+			break;
+		}
+	}
+
+	if (!mapped)
+	{
+		m_deviceContext->Unmap(resource, subresource);
+		return;
+	}
+
+	shadow = &m_shadows[mapped->object];
+	size = (unsigned int)shadow->size();
+
+	block = 0;
+	while (block < size)
+	{
+//	Skip the blocks that are the same:
+		while (block < size && memcmp(&mapped->contents[block], &(*shadow)[block], (size - block) < COMMAND_CAPTURE_BLOCK ? size - block : COMMAND_CAPTURE_BLOCK) == 0)
+		{
+			block += COMMAND_CAPTURE_BLOCK;
+		}
+
+		if (block >= size)
+		{
+			break;
+		}
+
+//	And take in every block that changed after the first:
+		first = block;
+		while (block < size && memcmp(&mapped->contents[block], &(*shadow)[block], (size - block) < COMMAND_CAPTURE_BLOCK ? size - block : COMMAND_CAPTURE_BLOCK) != 0)
+		{
+			block += COMMAND_CAPTURE_BLOCK;
+		}
+		end = block < size ? block : size;
+
+		header[0] = mapped->object;
+		header[1] = first;
+		header[2] = end - first;
+
+		m_record.assign((unsigned char*)header, (unsigned char*)header + sizeof(header));
+		m_record.insert(m_record.end(), mapped->contents.begin() + first, mapped->contents.begin() + end);
+		WriteRecord(COMMAND_UPDATE_BUFFER, m_record.data(), (unsigned int)m_record.size());
+
+		memcpy(&(*shadow)[first], &mapped->contents[first], end - first);
+		if (mapped->mapType != D3D11_MAP_WRITE_DISCARD)
+		{
+			memcpy((unsigned char*)mapped->data + first, &mapped->contents[first], end - first);
+		}
+	}
+
+	if (mapped->mapType == D3D11_MAP_WRITE_DISCARD)
+	{
+		memcpy(mapped->data, mapped->contents.data(), size);
+	}
+
+	m_mapped.erase(m_mapped.begin() + i);
+
+	m_deviceContext->Unmap(resource, subresource);
+}
+
+//	Only updates of buffers are recorded. The whole buffer is updated when there is no box.
+void CommandCaptureClass::UpdateSubresource(ID3D11Resource* resource, UINT subresource, const D3D11_BOX* box, const void* data, UINT rowPitch, UINT depthPitch)
+{
+	D3D11_RESOURCE_DIMENSION dimension;
+	D3D11_BUFFER_DESC bufferDesc;
+	unsigned int header[3];
+
+	resource->GetType(&dimension);
+	if (dimension != D3D11_RESOURCE_DIMENSION_BUFFER)
+	{
+		m_header.skippedCount++;
+		m_deviceContext->UpdateSubresource(resource, subresource, box, data, rowPitch, depthPitch);
+		return;
+	}
+
+	((ID3D11Buffer*)resource)->GetDesc(&bufferDesc);
+
+	header[0] = DefineResource(resource);
+	header[1] = box ? box->left : 0;
+	header[2] = box ? box->right - box->left : bufferDesc.ByteWidth;
+
+	m_record.assign((unsigned char*)header, (unsigned char*)header + sizeof(header));
+	m_record.insert(m_record.end(), (const unsigned char*)data, (const unsigned char*)data + header[2]);
+	WriteRecord(COMMAND_UPDATE_BUFFER, m_record.data(), (unsigned int)m_record.size());
+
+	m_deviceContext->UpdateSubresource(resource, subresource, box, data, rowPitch, depthPitch);
+	RefreshShadow(resource, header[0]);
+}
+
+void CommandCaptureClass::CopyResource(ID3D11Resource* destination, ID3D11Resource* source)
+{
+	unsigned int values[2];
+
+	values[0] = DefineResource(destination);
+	values[1] = DefineResource(source);
+	WriteRecord(COMMAND_COPY_RESOURCE, values, sizeof(values));
+
+	m_deviceContext->CopyResource(destination, source);
+	RefreshShadow(destination, values[0]);
+}
+
+void CommandCaptureClass::CopySubresourceRegion(ID3D11Resource* destination, UINT destinationSubresource, UINT x, UINT y, UINT z,
+	ID3D11Resource* source, UINT sourceSubresource, const D3D11_BOX* sourceBox)
+{
+	unsigned int values[14];
+
+	values[0] = DefineResource(destination);
+	values[1] = destinationSubresource;
+	values[2] = x;
+	values[3] = y;
+	values[4] = z;
+	values[5] = DefineResource(source);
+	values[6] = sourceSubresource;
+	values[7] = sourceBox ? 1 : 0;
+	values[8] = sourceBox ? sourceBox->left : 0;
+	values[9] = sourceBox ? sourceBox->top : 0;
+	values[10] = sourceBox ? sourceBox->front : 0;
+	values[11] = sourceBox ? sourceBox->right : 0;
+	values[12] = sourceBox ? sourceBox->bottom : 0;
+	values[13] = sourceBox ? sourceBox->back : 0;
+	WriteRecord(COMMAND_COPY_SUBRESOURCE_REGION, values, sizeof(values));
+
+	m_deviceContext->CopySubresourceRegion(destination, destinationSubresource, x, y, z, source, sourceSubresource, sourceBox);
+	RefreshShadow(destination, values[0]);
+}
+
+void CommandCaptureClass::Draw(UINT vertexCount, UINT startVertex)
+{
+	unsigned int values[2];
+
+	values[0] = vertexCount;
+	values[1] = startVertex;
+	WriteRecord(COMMAND_DRAW, values, sizeof(values));
+
+	m_deviceContext->Draw(vertexCount, startVertex);
+}
+
+void CommandCaptureClass::DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex)
+{
+	unsigned int values[3];
+
+	values[0] = indexCount;
+	values[1] = startIndex;
+	values[2] = (unsigned int)baseVertex;
+	WriteRecord(COMMAND_DRAW_INDEXED, values, sizeof(values));
+
+	m_deviceContext->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void CommandCaptureClass::DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance)
+{
+	unsigned int values[4];
+
+	values[0] = vertexCount;
+	values[1] = instanceCount;
+	values[2] = startVertex;
+	values[3] = startInstance;
+	WriteRecord(COMMAND_DRAW_INSTANCED, values, sizeof(values));
+
+	m_deviceContext->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+}
+
+void CommandCaptureClass::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	unsigned int values[5];
+
+	values[0] = indexCount;
+	values[1] = instanceCount;
+	values[2] = startIndex;
+	values[3] = (unsigned int)baseVertex;
+	values[4] = startInstance;
+	WriteRecord(COMMAND_DRAW_INDEXED_INSTANCED, values, sizeof(values));
+
+	m_deviceContext->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
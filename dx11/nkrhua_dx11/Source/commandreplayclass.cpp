@@ -0,0 +1,726 @@
+#include "../Headers/commandreplayclass.h"
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+//	The number of draws that cost the most the report lists on their own.
+static const int REPLAY_REPORT_COSTLIEST = 10;
+
+static const char* const COMMAND_DRAW_NAMES[] = { "draw", "indexed", "instanced", "indexed instanced" };
+
+//	The NullReplayBackendClass is what a replay without a backend plays into. It takes every command and does
+//	nothing with it, so playing through it times walking the file and nothing else.
+class NullReplayBackendClass : public ReplayBackendClass
+{
+public:
+	bool Define(const CommandDefineType*, const unsigned char*, const unsigned char*) { return true; }
+	bool Execute(const CommandRecordType*, const unsigned char*) { return true; }
+	bool Reset(const CommandDefineType*, const unsigned char*) { return true; }
+	void BeginDraw(int) {}
+	void EndDraw(int) {}
+	bool EndFrame(int) { return true; }
+	float GetDrawTime(int) { return -1.0f; }
+};
+
+//	CountPrimitives gives the number of primitives that many vertices or indices make in a topology.
+static unsigned int CountPrimitives(unsigned int topology, unsigned int elementCount)
+{
+	switch (topology)
+	{
+	case COMMAND_TOPOLOGY_POINTLIST:
+		return elementCount;
+	case COMMAND_TOPOLOGY_LINELIST:
+		return elementCount / 2;
+	case COMMAND_TOPOLOGY_LINESTRIP:
+		return elementCount > 1 ? elementCount - 1 : 0;
+	case COMMAND_TOPOLOGY_TRIANGLELIST:
+		return elementCount / 3;
+	case COMMAND_TOPOLOGY_TRIANGLESTRIP:
+		return elementCount > 2 ? elementCount - 2 : 0;
+	}
+
+	return 0;
+}
+
+static bool IsDraw(unsigned int type)
+{
+	return type >= COMMAND_DRAW && type <= COMMAND_DRAW_INDEXED_INSTANCED;
+}
+
+CommandReplayClass::CommandReplayClass()
+{
+	memset(&m_header, 0, sizeof(m_header));
+	m_bestPlayTime = 0.0f;
+	m_totalPlayTime = 0.0f;
+	m_playCount = 0;
+}
+
+CommandReplayClass::CommandReplayClass(const CommandReplayClass& other)
+{
+
+}
+
+CommandReplayClass::~CommandReplayClass()
+{
+
+}
+
+//	Initialize reads the whole file and walks its records once, checking each of them and the objects it
+//	names, splitting them into frames and taking down what every draw asks for. Nothing is played here. The
+//	counts in the header are written last, so a capture that was cut short has none, and they are counted
+//	again from the records.
+bool CommandReplayClass::Initialize(const char* filename)
+{
+	FILE* filePtr;
+	const CommandRecordType* record;
+	const unsigned char* payload;
+	const unsigned int* words;
+	vector<int> defines;
+	vector<bool> written;
+	FrameType frame;
+	DrawStatsType draw;
+	long fileSize;
+	size_t offset, paddedSize;
+	unsigned int objectCount, topology, updateBytes;
+	int stateChanges, i;
+
+	filePtr = OpenFile(filename, "rb");
+	if (!filePtr)
+	{
+		return false;
+	}
+
+	fseek(filePtr, 0, SEEK_END);
+	fileSize = ftell(filePtr);
+	fseek(filePtr, 0, SEEK_SET);
+
+	if (fileSize < (long)sizeof(CommandFileHeaderType))
+	{
+		fclose(filePtr);
+		return false;
+	}
+
+	m_data.resize(fileSize);
+	if (fread(m_data.data(), 1, fileSize, filePtr) != (size_t)fileSize)
+	{
+		fclose(filePtr);
+		return false;
+	}
+
+	fclose(filePtr);
+
+	memcpy(&m_header, m_data.data(), sizeof(m_header));
+	if (memcmp(m_header.magic, "CMD1", 4) != 0 || m_header.version != COMMAND_FILE_VERSION)
+	{
+		return false;
+	}
+
+	objectCount = 0;
+	topology = 0;
+	stateChanges = 0;
+	updateBytes = 0;
+	defines.push_back(-1);
+	written.push_back(false);
+
+	frame.firstRecord = 0;
+	frame.firstDraw = 0;
+
+	offset = sizeof(CommandFileHeaderType);
+	while (offset < m_data.size())
+	{
+		if (m_data.size() - offset < sizeof(CommandRecordType))
+		{
+			return false;
+		}
+
+		record = (const CommandRecordType*)&m_data[offset];
+		payload = (const unsigned char*)(record + 1);
+		words = (const unsigned int*)payload;
+
+		paddedSize = (record->size + 3) & ~3u;
+		if (paddedSize > m_data.size() - offset - sizeof(CommandRecordType))
+		{
+			return false;
+		}
+
+		if (!CheckRecord(record, payload, objectCount))
+		{
+			return false;
+		}
+
+		switch (record->type)
+		{
+		case COMMAND_DEFINE:
+			defines.push_back((int)m_records.size());
+			written.push_back(false);
+			break;
+
+		case COMMAND_SET_TOPOLOGY:
+			topology = words[0];
+			stateChanges++;
+			break;
+
+		case COMMAND_UPDATE_BUFFER:
+			written[words[0]] = true;
+			updateBytes += words[2];
+			break;
+
+		case COMMAND_COPY_RESOURCE:
+		case COMMAND_COPY_SUBRESOURCE_REGION:
+			written[words[0]] = true;
+			break;
+
+		case COMMAND_CLEAR_RENDER_TARGET:
+		case COMMAND_CLEAR_DEPTH_STENCIL:
+		case COMMAND_FRAME_END:
+			break;
+
+		case COMMAND_DRAW:
+		case COMMAND_DRAW_INDEXED:
+		case COMMAND_DRAW_INSTANCED:
+		case COMMAND_DRAW_INDEXED_INSTANCED:
+			draw.frame = (int)m_frames.size();
+			draw.command = (int)m_records.size() - frame.firstRecord;
+			draw.type = record->type;
+			draw.elementCount = words[0];
+			draw.instanceCount = (record->type == COMMAND_DRAW || record->type == COMMAND_DRAW_INDEXED) ? 1 : words[1];
+			draw.primitiveCount = CountPrimitives(topology, draw.elementCount) * draw.instanceCount;
+			draw.stateChanges = stateChanges;
+			draw.updateBytes = updateBytes;
+			draw.time = -1.0f;
+			m_draws.push_back(draw);
+
+			stateChanges = 0;
+			updateBytes = 0;
+			break;
+
+		default:
+			stateChanges++;
+			break;
+		}
+
+		m_records.push_back(record);
+		offset += sizeof(CommandRecordType) + paddedSize;
+
+//	Every frame ends with a marker. Records after the last one are from a capture that was cut short and
+//	are played as a frame of their own:
+		if (record->type == COMMAND_FRAME_END || offset == m_data.size())
+		{
+			frame.recordCount = (int)m_records.size() - frame.firstRecord;
+			frame.drawCount = (int)m_draws.size() - frame.firstDraw;
+			m_frames.push_back(frame);
+
+			frame.firstRecord = (int)m_records.size();
+			frame.firstDraw = (int)m_draws.size();
+		}
+	}
+
+	if (m_frames.empty())
+	{
+		return false;
+	}
+
+//	Keep the definitions of everything the commands write to, to put them back before each play:
+	for (i = 1; i < (int)written.size(); i++)
+	{
+		if (written[i])
+		{
+			m_resets.push_back(defines[i]);
+		}
+	}
+
+	m_header.frameCount = (unsigned int)m_frames.size();
+	m_header.recordCount = (unsigned int)m_records.size();
+	m_header.objectCount = objectCount;
+
+	return true;
+}
+
+void CommandReplayClass::Shutdown()
+{
+	m_draws.clear();
+	m_resets.clear();
+	m_frames.clear();
+	m_records.clear();
+	m_data.clear();
+
+	return;
+}
+
+//	CheckRecord makes sure the payload of a record is the size its type and counts say and that every object
+//	it names has been defined, so neither the replay nor a backend ever reads past a record or looks up an
+//	object that isn't there. A definition has to define the next object.
+bool CommandReplayClass::CheckRecord(const CommandRecordType* record, const unsigned char* payload, unsigned int& objectCount)
+{
+	const unsigned int* words;
+	const CommandDefineType* define;
+	unsigned int count, expected, idFirst, idCount, idStride, i;
+
+	words = (const unsigned int*)payload;
+	count = record->size / sizeof(unsigned int);
+	idFirst = 0;
+	idCount = 0;
+	idStride = 1;
+
+	switch (record->type)
+	{
+	case COMMAND_DEFINE:
+		if (record->size < sizeof(CommandDefineType))
+		{
+			return false;
+		}
+
+		define = (const CommandDefineType*)payload;
+		if (define->object != objectCount + 1 || define->kind >= COMMAND_OBJECT_KIND_COUNT || define->parent > objectCount)
+		{
+			return false;
+		}
+
+		if (define->descSize > record->size - sizeof(CommandDefineType) || define->dataSize != record->size - sizeof(CommandDefineType) - define->descSize)
+		{
+			return false;
+		}
+
+		if ((define->kind == COMMAND_OBJECT_BUFFER && define->descSize != sizeof(CommandBufferDescType)) ||
+			(define->kind == COMMAND_OBJECT_TEXTURE2D && define->descSize != sizeof(CommandTextureDescType)) ||
+			(define->kind >= COMMAND_OBJECT_SHADER_RESOURCE_VIEW && define->kind <= COMMAND_OBJECT_DEPTH_STENCIL_VIEW && define->parent == 0))
+		{
+			return false;
+		}
+
+		if (define->kind == COMMAND_OBJECT_INPUT_LAYOUT)
+		{
+			if (define->descSize < sizeof(unsigned int))
+			{
+				return false;
+			}
+
+			count = words[sizeof(CommandDefineType) / sizeof(unsigned int)];
+			if (count > define->descSize / sizeof(CommandInputElementType) ||
+				define->descSize != sizeof(unsigned int) + count * sizeof(CommandInputElementType))
+			{
+				return false;
+			}
+		}
+
+		objectCount++;
+		return true;
+
+	case COMMAND_FRAME_END:
+		expected = 0;
+		break;
+
+	case COMMAND_SET_INPUT_LAYOUT:
+	case COMMAND_SET_RASTERIZER_STATE:
+		expected = 1;
+		idCount = 1;
+		break;
+
+	case COMMAND_SET_VERTEX_BUFFERS:
+		if (count < 2 || words[1] > count)
+		{
+			return false;
+		}
+		expected = 2 + words[1] * 3;
+		idFirst = 2;
+		idCount = words[1];
+		idStride = 3;
+		break;
+
+	case COMMAND_SET_INDEX_BUFFER:
+		expected = 3;
+		idCount = 1;
+		break;
+
+	case COMMAND_SET_TOPOLOGY:
+		expected = 1;
+		break;
+
+	case COMMAND_SET_SHADER:
+		if (count < 1 || words[0] > COMMAND_STAGE_PIXEL)
+		{
+			return false;
+		}
+		expected = 2;
+		idFirst = 1;
+		idCount = 1;
+		break;
+
+	case COMMAND_SET_CONSTANT_BUFFERS:
+	case COMMAND_SET_SHADER_RESOURCES:
+	case COMMAND_SET_SAMPLERS:
+		if (count < 3 || words[0] > COMMAND_STAGE_PIXEL || words[2] > count)
+		{
+			return false;
+		}
+		expected = 3 + words[2];
+		idFirst = 3;
+		idCount = words[2];
+		break;
+
+	case COMMAND_SET_RENDER_TARGETS:
+		if (count < 1 || words[0] > count)
+		{
+			return false;
+		}
+		expected = 2 + words[0];
+		idFirst = 1;
+		idCount = 1 + words[0];
+		break;
+
+	case COMMAND_SET_BLEND_STATE:
+		expected = 6;
+		idCount = 1;
+		break;
+
+	case COMMAND_SET_DEPTH_STENCIL_STATE:
+		expected = 2;
+		idCount = 1;
+		break;
+
+	case COMMAND_SET_VIEWPORTS:
+		if (count < 1 || words[0] > count)
+		{
+			return false;
+		}
+		expected = 1 + words[0] * 6;
+		break;
+
+	case COMMAND_CLEAR_RENDER_TARGET:
+		expected = 5;
+		idCount = 1;
+		break;
+
+	case COMMAND_CLEAR_DEPTH_STENCIL:
+		expected = 4;
+		idCount = 1;
+		break;
+
+//	The contents of an update are bytes, so its size is checked here rather than in words:
+	case COMMAND_UPDATE_BUFFER:
+		if (record->size < 3 * sizeof(unsigned int) || words[0] == 0 || words[2] != record->size - 3 * sizeof(unsigned int))
+		{
+			return false;
+		}
+		return words[0] <= objectCount;
+
+	case COMMAND_COPY_RESOURCE:
+		expected = 2;
+		idCount = 2;
+		break;
+
+	case COMMAND_COPY_SUBRESOURCE_REGION:
+		expected = 14;
+		idCount = 2;
+		idStride = 5;
+		break;
+
+	case COMMAND_DRAW:
+		expected = 2;
+		break;
+
+	case COMMAND_DRAW_INDEXED:
+		expected = 3;
+		break;
+
+	case COMMAND_DRAW_INSTANCED:
+		expected = 4;
+		break;
+
+	case COMMAND_DRAW_INDEXED_INSTANCED:
+		expected = 5;
+		break;
+
+	default:
+		return false;
+	}
+
+	if (record->size != expected * sizeof(unsigned int))
+	{
+		return false;
+	}
+
+	for (i = 0; i < idCount; i++)
+	{
+		if (words[idFirst + i * idStride] > objectCount)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//	Play defines every object on the first play and resets the written ones before each play after it, and
+//	times each play of all the frames on its own, without the resets. The first play is left out of the
+//	times when there is more than one, since it creates everything.
+bool CommandReplayClass::Play(ReplayBackendClass* backend, int loops)
+{
+	NullReplayBackendClass nullBackend;
+	chrono::high_resolution_clock::time_point start;
+	const CommandDefineType* define;
+	float time;
+	int loop, frame, i;
+
+	if (!backend)
+	{
+		backend = &nullBackend;
+	}
+
+	for (i = 0; i < (int)m_draws.size(); i++)
+	{
+		m_draws[i].time = -1.0f;
+	}
+
+	m_bestPlayTime = 0.0f;
+	m_totalPlayTime = 0.0f;
+	m_playCount = 0;
+
+	for (loop = 0; loop < loops; loop++)
+	{
+		if (loop > 0)
+		{
+			for (i = 0; i < (int)m_resets.size(); i++)
+			{
+				define = (const CommandDefineType*)(m_records[m_resets[i]] + 1);
+				if (!backend->Reset(define, (const unsigned char*)(define + 1) + define->descSize))
+				{
+					return false;
+				}
+			}
+		}
+
+		start = chrono::high_resolution_clock::now();
+
+		for (frame = 0; frame < (int)m_frames.size(); frame++)
+		{
+			if (!PlayFrame(backend, frame, loop == 0))
+			{
+				return false;
+			}
+		}
+
+		time = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - start).count();
+
+		if (loop > 0 || loops == 1)
+		{
+			m_bestPlayTime = (m_playCount == 0 || time < m_bestPlayTime) ? time : m_bestPlayTime;
+			m_totalPlayTime += time;
+			m_playCount++;
+		}
+	}
+
+	return true;
+}
+
+//	PlayFrame sends the records of a frame to the backend, each draw between BeginDraw and EndDraw, and
+//	keeps the least time the backend gives for each draw once the frame has ended.
+bool CommandReplayClass::PlayFrame(ReplayBackendClass* backend, int frame, bool define)
+{
+	const CommandRecordType* record;
+	const CommandDefineType* definition;
+	const unsigned char* payload;
+	DrawStatsType* draws;
+	float time;
+	int draw, i;
+
+	draw = 0;
+
+	for (i = m_frames[frame].firstRecord; i < m_frames[frame].firstRecord + m_frames[frame].recordCount; i++)
+	{
+		record = m_records[i];
+		payload = (const unsigned char*)(record + 1);
+
+		if (record->type == COMMAND_DEFINE)
+		{
+			if (define)
+			{
+				definition = (const CommandDefineType*)payload;
+				if (!backend->Define(definition, payload + sizeof(CommandDefineType), payload + sizeof(CommandDefineType) + definition->descSize))
+				{
+					return false;
+				}
+			}
+		}
+		else if (IsDraw(record->type))
+		{
+			backend->BeginDraw(draw);
+			if (!backend->Execute(record, payload))
+			{
+				return false;
+			}
+			backend->EndDraw(draw);
+			draw++;
+		}
+		else if (record->type != COMMAND_FRAME_END)
+		{
+			if (!backend->Execute(record, payload))
+			{
+				return false;
+			}
+		}
+	}
+
+	if (!backend->EndFrame(draw))
+	{
+		return false;
+	}
+
+	draws = m_draws.data() + m_frames[frame].firstDraw;
+	for (i = 0; i < draw; i++)
+	{
+		time = backend->GetDrawTime(i);
+		if (time >= 0.0f && (draws[i].time < 0.0f || time < draws[i].time))
+		{
+			draws[i].time = time;
+		}
+	}
+
+	return true;
+}
+
+int CommandReplayClass::GetFrameCount()
+{
+	return (int)m_frames.size();
+}
+
+int CommandReplayClass::GetRecordCount()
+{
+	return (int)m_records.size();
+}
+
+int CommandReplayClass::GetObjectCount()
+{
+	return (int)m_header.objectCount;
+}
+
+//	The calls of the engine the capture could only pass on to the device, which the replay can't play.
+int CommandReplayClass::GetSkippedCount()
+{
+	return (int)m_header.skippedCount;
+}
+
+int CommandReplayClass::GetDrawCount()
+{
+	return (int)m_draws.size();
+}
+
+const CommandReplayClass::DrawStatsType* CommandReplayClass::GetDrawStats()
+{
+	return m_draws.data();
+}
+
+float CommandReplayClass::GetBestPlayTime()
+{
+	return m_bestPlayTime;
+}
+
+float CommandReplayClass::GetMeanPlayTime()
+{
+	return m_playCount > 0 ? m_totalPlayTime / (float)m_playCount : 0.0f;
+}
+
+//	WriteReport writes the totals of every frame, every draw and then the draws that cost the most: by their
+//	time on the GPU when the backend measured it, and by their primitives when it didn't.
+bool CommandReplayClass::WriteReport(FILE* filePtr)
+{
+	vector<int> order;
+	char timeText[16];
+	unsigned int primitives, updateBytes;
+	float time;
+	int stateChanges, frame, count, i, j;
+	bool timed;
+
+	fprintf(filePtr, "command replay: %d frames, %d records, %d objects, %d draws, %d calls not captured\n",
+		GetFrameCount(), GetRecordCount(), GetObjectCount(), GetDrawCount(), GetSkippedCount());
+	fprintf(filePtr, "play of all frames: best %.3f ms, mean %.3f ms over %d plays\n", m_bestPlayTime, GetMeanPlayTime(), m_playCount);
+
+	timed = false;
+	for (frame = 0; frame < (int)m_frames.size(); frame++)
+	{
+		primitives = 0;
+		updateBytes = 0;
+		stateChanges = 0;
+		time = 0.0f;
+
+		for (i = m_frames[frame].firstDraw; i < m_frames[frame].firstDraw + m_frames[frame].drawCount; i++)
+		{
+			primitives += m_draws[i].primitiveCount;
+			updateBytes += m_draws[i].updateBytes;
+			stateChanges += m_draws[i].stateChanges;
+			if (m_draws[i].time >= 0.0f)
+			{
+				time += m_draws[i].time;
+				timed = true;
+			}
+		}
+
+		fprintf(filePtr, "frame %d: %d draws, %u primitives, %d state changes, %u bytes updated, %.3f ms of draws on the GPU\n",
+			frame, m_frames[frame].drawCount, primitives, stateChanges, updateBytes, time);
+	}
+
+	fprintf(filePtr, "\n%6s %6s %8s %18s %10s %10s %10s %7s %10s %10s\n", "draw", "frame", "command", "type", "elements", "instances",
+		"primitives", "states", "bytes", "gpu us");
+	for (i = 0; i < (int)m_draws.size(); i++)
+	{
+		if (m_draws[i].time >= 0.0f)
+		{
+			snprintf(timeText, sizeof(timeText), "%.2f", m_draws[i].time * 1000.0f);
+		}
+		else
+		{
+			snprintf(timeText, sizeof(timeText), "-");
+		}
+
+		fprintf(filePtr, "%6d %6d %8d %18s %10u %10u %10u %7d %10u %10s\n", i, m_draws[i].frame, m_draws[i].command,
+			COMMAND_DRAW_NAMES[m_draws[i].type - COMMAND_DRAW], m_draws[i].elementCount, m_draws[i].instanceCount, m_draws[i].primitiveCount,
+			m_draws[i].stateChanges, m_draws[i].updateBytes, timeText);
+	}
+
+//	Sort the draws by what they cost, most first:
+	for (i = 0; i < (int)m_draws.size(); i++)
+	{
+		order.push_back(i);
+	}
+
+	sort(order.begin(), order.end(), [this, timed](int a, int b)
+	{
+		return timed ? m_draws[a].time > m_draws[b].time : m_draws[a].primitiveCount > m_draws[b].primitiveCount;
+	});
+
+	count = (int)order.size() < REPLAY_REPORT_COSTLIEST ? (int)order.size() : REPLAY_REPORT_COSTLIEST;
+	fprintf(filePtr, "\ncostliest draws by %s:", timed ? "time on the GPU" : "primitives");
+	for (i = 0; i < count; i++)
+	{
+		j = order[i];
+		if (timed)
+		{
+			fprintf(filePtr, " %d (%.2f us)", j, m_draws[j].time * 1000.0f);
+		}
+		else
+		{
+			fprintf(filePtr, " %d (%u)", j, m_draws[j].primitiveCount);
+		}
+	}
+	fprintf(filePtr, "\n\n");
+
+	return true;
+}
+
+//	OpenFile opens a file the same way on Windows and on the systems the replay tool is built on as well.
+FILE* CommandReplayClass::OpenFile(const char* filename, const char* mode)
+{
+	FILE* filePtr;
+
+#ifdef _MSC_VER
+	if (fopen_s(&filePtr, filename, mode) != 0)
+	{
+		return 0;
+	}
+#else
+	filePtr = fopen(filename, mode);
+#endif
+
+	return filePtr;
+}
@@ -7,9 +7,16 @@ D3DClass::D3DClass()
 	m_deviceContext = 0;
 	m_renderTargetView = 0;
 	m_depthStencilBuffer = 0;
-	m_depthStencilState = 0;
 	m_depthStencilView = 0;
-	m_rasterState = 0;
+	m_ResourceRegistry = 0;
+	m_depthStencilState.id = 0;
+	m_rasterState.id = 0;
+	m_depthReadOnlyState.id = 0;
+	m_depthDisabledState.id = 0;
+	m_alphaEnableBlendingState.id = 0;
+	m_alphaDisableBlendingState.id = 0;
+	m_CommandCapture = 0;
+	m_StatsContext = 0;
 }
 
 D3DClass::D3DClass(const D3DClass& other)
@@ -22,7 +29,7 @@ D3DClass::~D3DClass()
 
 }
 
-bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hwnd, bool fullscreen, float screenDepth, float screenNear)
+bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hwnd, bool fullscreen, float screenDepth, float screenNear, bool softwareRenderer)
 {
 
 	HRESULT result;
@@ -41,11 +48,16 @@ bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
 
 	DXGI_SWAP_CHAIN_DESC swapChainDesc;
 	D3D_FEATURE_LEVEL featureLevel;
+	D3D_DRIVER_TYPE driverType;
 	ID3D11Texture2D* backBufferPTR;
 	D3D11_TEXTURE2D_DESC depthBufferDesc;
 	D3D11_DEPTH_STENCIL_DESC depthStencilDesc;
 	D3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc;
 	D3D11_RASTERIZER_DESC rasterDesc;
+	D3D11_BLEND_DESC blendStateDesc;
+	ID3D11DepthStencilState* depthStencilState;
+	ID3D11RasterizerState* rasterState;
+	ID3D11BlendState* blendState;
 
 	float fieldOfView, screenAspect;
 
@@ -217,14 +229,27 @@ bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
 //	Now that the swap description and feature level have been filled out, we can create the
 //	swap chain, the Direct3D device and the Direct3D device context.
 
+//	The software renderer uses WARP, the rasterizer that ships with Windows and runs on the CPU. It does
+//	not depend on the video card or driver, so images it renders are the same on every machine, which
+//	is what golden image captures need to be compared against:
+	driverType = softwareRenderer ? D3D_DRIVER_TYPE_WARP : D3D_DRIVER_TYPE_HARDWARE;
+
 //	Create the swap chain, Direct3D device and Direct3D device context:
-	result = D3D11CreateDeviceAndSwapChain(NULL, D3D_DRIVER_TYPE_HARDWARE, NULL, 0, &featureLevel, 1,
+	result = D3D11CreateDeviceAndSwapChain(NULL, driverType, NULL, 0, &featureLevel, 1,
 		D3D11_SDK_VERSION, &swapChainDesc, &m_swapChain, &m_device, NULL, &m_deviceContext);
 	if (FAILED(result))
 	{
 		return false;
 	}
 
+//	Create the Resource Registry that holds the resources made on the device from here on:
+	m_ResourceRegistry = new ResourceRegistryClass;
+
+	if (!m_ResourceRegistry->Initialize(m_device))
+	{
+		return false;
+	}
+
 
 //	This will fail if the primary video card is not compatible with DirectX 11. Some machines may have
 //	the primary card as a DirectX 10 video card and the secondary card as a DirectX 11. Also some
@@ -312,14 +337,39 @@ bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
 
 //	With the description filled out we can create a depth stencil state:
 // Create the depth stencil state.
-	result = m_device->CreateDepthStencilState(&depthStencilDesc, &m_depthStencilState);
+	result = m_device->CreateDepthStencilState(&depthStencilDesc, &depthStencilState);
 	if (FAILED(result))
 	{
 		return false;
 	}
 
+	m_depthStencilState = m_ResourceRegistry->Register(depthStencilState);
+
 //	With the depth stencil state, we can now set it so that it takes effect.
-	m_deviceContext->OMSetDepthStencilState(m_depthStencilState, 1);
+	m_deviceContext->OMSetDepthStencilState(depthStencilState, 1);
+
+//	Create a second state that still tests against the depth buffer but does not write to it. Blended
+//	geometry like particles uses it so that it is hidden behind solid objects without hiding itself:
+	depthStencilDesc.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+
+	result = m_device->CreateDepthStencilState(&depthStencilDesc, &depthStencilState);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_depthReadOnlyState = m_ResourceRegistry->Register(depthStencilState);
+
+//	And a third that doesn't test at all, for what is drawn over the finished frame like text:
+	depthStencilDesc.DepthEnable = false;
+
+	result = m_device->CreateDepthStencilState(&depthStencilDesc, &depthStencilState);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_depthDisabledState = m_ResourceRegistry->Register(depthStencilState);
 
 //	So we can create the description of the view of the depth stencil buffer. We do this so that
 //	Direct3D knows to use the depth buffer as a depth stencil texture. After filling out the
@@ -368,14 +418,16 @@ bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
 	rasterDesc.SlopeScaledDepthBias = 0.0f;
 
 //	Create the rasterizer state from the description we just filled out:
-	result = m_device->CreateRasterizerState(&rasterDesc, &m_rasterState);
+	result = m_device->CreateRasterizerState(&rasterDesc, &rasterState);
 	if (FAILED(result))
 	{
 		return false;
 	}
 
+	m_rasterState = m_ResourceRegistry->Register(rasterState);
+
 //	Now set the rasterizer state:
-	m_deviceContext->RSSetState(m_rasterState);
+	m_deviceContext->RSSetState(rasterState);
 
 //	The viewport also needs to be setup so that Direct3D can map clip space coordinates to
 //	the render target space. Set this to be the entire size of the window.
@@ -422,21 +474,60 @@ bool D3DClass::Initialize(int screenWidth, int screenHeight, bool vsync, HWND hw
 //	Create an orthographic projection matrix for 2D rendering:
 	m_orthoMatrix = XMMatrixOrthographicLH((float)screenWidth, (float)screenHeight, screenNear, screenDepth);
 
+//	Finally we create the two blend states. The enabled one blends the pixel over what is already in the
+//	back buffer by its alpha, the disabled one is the same description with blending turned off:
+	ZeroMemory(&blendStateDesc, sizeof(D3D11_BLEND_DESC));
+
+	blendStateDesc.RenderTarget[0].BlendEnable = TRUE;
+	blendStateDesc.RenderTarget[0].SrcBlend = D3D11_BLEND_SRC_ALPHA;
+	blendStateDesc.RenderTarget[0].DestBlend = D3D11_BLEND_INV_SRC_ALPHA;
+	blendStateDesc.RenderTarget[0].BlendOp = D3D11_BLEND_OP_ADD;
+	blendStateDesc.RenderTarget[0].SrcBlendAlpha = D3D11_BLEND_ONE;
+	blendStateDesc.RenderTarget[0].DestBlendAlpha = D3D11_BLEND_ZERO;
+	blendStateDesc.RenderTarget[0].BlendOpAlpha = D3D11_BLEND_OP_ADD;
+	blendStateDesc.RenderTarget[0].RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+
+	result = m_device->CreateBlendState(&blendStateDesc, &blendState);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_alphaEnableBlendingState = m_ResourceRegistry->Register(blendState);
+
+	blendStateDesc.RenderTarget[0].BlendEnable = FALSE;
+
+	result = m_device->CreateBlendState(&blendStateDesc, &blendState);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_alphaDisableBlendingState = m_ResourceRegistry->Register(blendState);
+
 	return true;
 }
 
 void D3DClass::Shutdown()
 {
+//	A capture still running is ended so its file is complete, and the statistics give the real device
+//	context back before it is released:
+	EndCommandCapture();
+	EndRenderStats();
+
 //	Before shutting down, set to windowed mode or when you release the swap chain it will throw an exception.
 	if (m_swapChain)
 	{
 		m_swapChain->SetFullscreenState(false, NULL);
 	}
 
-	if (m_rasterState)
+//	Release the states and everything else still in the Resource Registry. The other objects have all been
+//	shut down by now, so nothing is drawing with them:
+	if (m_ResourceRegistry)
 	{
-		m_rasterState->Release();
-		m_rasterState = 0;
+		m_ResourceRegistry->Shutdown();
+		delete m_ResourceRegistry;
+		m_ResourceRegistry = 0;
 	}
 	
 	if (m_depthStencilView)
@@ -444,12 +535,6 @@ void D3DClass::Shutdown()
 		m_depthStencilView->Release();
 		m_depthStencilView = 0;
 	}
-	
-	if (m_depthStencilState)
-	{
-		m_depthStencilState->Release();
-		m_depthStencilState = 0;
-	}
 
 	if (m_depthStencilBuffer)
 	{
@@ -517,6 +602,9 @@ void D3DClass::EndScene()
 		m_swapChain->Present(0, 0);
 	}
 
+//	Fence the frame and let go of the resources released in frames the video card has finished with:
+	m_ResourceRegistry->EndFrame(m_deviceContext);
+
 	return;
 }
 
@@ -532,6 +620,11 @@ ID3D11DeviceContext* D3DClass::GetDeviceContext()
 	return m_deviceContext;
 }
 
+ResourceRegistryClass* D3DClass::GetResourceRegistry()
+{
+	return m_ResourceRegistry;
+}
+
 //	The next three helper functions give copies of the projection, world and orthographic matrices:
 //	Most shaders will need these matrices for rendering so there needed to be an easy way for outside
 //	objects to get a copy of them.
@@ -570,4 +663,147 @@ void D3DClass::ResetViewport()
 	m_deviceContext->RSSetViewports(1, &m_viewport);
 
 	return;
-}
\ No newline at end of file
+}
+
+//	ResetRasterState puts back the rasterizer state the scene is drawn with, after a pass that set its own.
+void D3DClass::ResetRasterState()
+{
+	m_deviceContext->RSSetState(m_ResourceRegistry->Get(m_rasterState));
+
+	return;
+}
+
+//	The blend and depth functions switch between drawing solid and see through geometry. Anything drawn
+//	with blending on should also be drawn after the solid geometry and with depth writes off.
+
+void D3DClass::TurnOnAlphaBlending()
+{
+	float blendFactor[4];
+
+	blendFactor[0] = 0.0f;
+	blendFactor[1] = 0.0f;
+	blendFactor[2] = 0.0f;
+	blendFactor[3] = 0.0f;
+
+	m_deviceContext->OMSetBlendState(m_ResourceRegistry->Get(m_alphaEnableBlendingState), blendFactor, 0xffffffff);
+
+	return;
+}
+
+void D3DClass::TurnOffAlphaBlending()
+{
+	float blendFactor[4];
+
+	blendFactor[0] = 0.0f;
+	blendFactor[1] = 0.0f;
+	blendFactor[2] = 0.0f;
+	blendFactor[3] = 0.0f;
+
+	m_deviceContext->OMSetBlendState(m_ResourceRegistry->Get(m_alphaDisableBlendingState), blendFactor, 0xffffffff);
+
+	return;
+}
+
+void D3DClass::TurnOnDepthWrites()
+{
+	m_deviceContext->OMSetDepthStencilState(m_ResourceRegistry->Get(m_depthStencilState), 1);
+	return;
+}
+
+void D3DClass::TurnOffDepthWrites()
+{
+	m_deviceContext->OMSetDepthStencilState(m_ResourceRegistry->Get(m_depthReadOnlyState), 1);
+	return;
+}
+
+//	TurnOffDepthTest draws over everything regardless of depth. TurnOnDepthWrites turns the test back on too.
+void D3DClass::TurnOffDepthTest()
+{
+	m_deviceContext->OMSetDepthStencilState(m_ResourceRegistry->Get(m_depthDisabledState), 1);
+	return;
+}
+
+//	BeginCommandCapture puts the Command Capture in front of the device context, so everything drawn from now
+//	on goes through it.
+bool D3DClass::BeginCommandCapture(const char* filename)
+{
+	if (m_CommandCapture)
+	{
+		return true;
+	}
+
+	m_CommandCapture = new CommandCaptureClass;
+
+	if (!m_CommandCapture->Initialize(m_deviceContext, filename))
+	{
+		m_CommandCapture->Shutdown();
+		m_CommandCapture->Release();
+		m_CommandCapture = 0;
+		return false;
+	}
+
+	m_deviceContext = m_CommandCapture;
+
+	return true;
+}
+
+void D3DClass::EndCommandFrame()
+{
+	if (m_CommandCapture)
+	{
+		m_CommandCapture->EndFrame();
+	}
+
+	return;
+}
+
+//	EndCommandCapture gives the real device context back and finishes the file.
+void D3DClass::EndCommandCapture()
+{
+	if (m_CommandCapture)
+	{
+		m_deviceContext = m_CommandCapture->GetDeviceContext();
+
+		m_CommandCapture->Shutdown();
+		m_CommandCapture->Release();
+		m_CommandCapture = 0;
+	}
+
+	return;
+}
+
+//	BeginRenderStats puts the Stats Context in front of the device context. It can't go behind a capture that is
+//	already running, since the capture holds the device context it was begun with.
+bool D3DClass::BeginRenderStats(RenderStatsClass* renderStats)
+{
+	if (m_StatsContext)
+	{
+		return true;
+	}
+
+	if (m_CommandCapture)
+	{
+		return false;
+	}
+
+	m_StatsContext = new StatsContextClass;
+	m_StatsContext->Initialize(m_deviceContext, renderStats);
+
+	m_deviceContext = m_StatsContext;
+
+	return true;
+}
+
+void D3DClass::EndRenderStats()
+{
+	if (m_StatsContext)
+	{
+		m_deviceContext = m_StatsContext->GetDeviceContext();
+
+		m_StatsContext->Shutdown();
+		m_StatsContext->Release();
+		m_StatsContext = 0;
+	}
+
+	return;
+}
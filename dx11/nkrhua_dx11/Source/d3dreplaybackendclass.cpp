@@ -0,0 +1,757 @@
+#include "../Headers/d3dreplaybackendclass.h"
+
+#include <string.h>
+
+D3DReplayBackendClass::D3DReplayBackendClass()
+{
+	m_device = 0;
+	m_deviceContext = 0;
+	m_disjointQuery = 0;
+	m_frameBegun = false;
+}
+
+D3DReplayBackendClass::D3DReplayBackendClass(const D3DReplayBackendClass& other)
+{
+
+}
+
+D3DReplayBackendClass::~D3DReplayBackendClass()
+{
+
+}
+
+bool D3DReplayBackendClass::Initialize(bool softwareRenderer)
+{
+	D3D_FEATURE_LEVEL featureLevel;
+	D3D_DRIVER_TYPE driverType;
+	D3D11_QUERY_DESC queryDesc;
+	HRESULT result;
+
+	featureLevel = D3D_FEATURE_LEVEL_11_0;
+	driverType = softwareRenderer ? D3D_DRIVER_TYPE_WARP : D3D_DRIVER_TYPE_HARDWARE;
+
+	result = D3D11CreateDevice(NULL, driverType, NULL, 0, &featureLevel, 1, D3D11_SDK_VERSION, &m_device, NULL, &m_deviceContext);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	queryDesc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+	queryDesc.MiscFlags = 0;
+
+	result = m_device->CreateQuery(&queryDesc, &m_disjointQuery);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+//	Object zero is no object:
+	m_objects.push_back(0);
+	m_kinds.push_back(COMMAND_OBJECT_KIND_COUNT);
+	m_constantBuffers.push_back(vector<unsigned char>());
+
+	return true;
+}
+
+void D3DReplayBackendClass::Shutdown()
+{
+	int i;
+
+	for (i = 0; i < (int)m_queries.size(); i++)
+	{
+		m_queries[i].begin->Release();
+		m_queries[i].end->Release();
+	}
+	m_queries.clear();
+
+	for (i = 0; i < (int)m_objects.size(); i++)
+	{
+		if (m_objects[i])
+		{
+			m_objects[i]->Release();
+		}
+	}
+	m_objects.clear();
+	m_kinds.clear();
+	m_constantBuffers.clear();
+
+	if (m_disjointQuery)
+	{
+		m_disjointQuery->Release();
+		m_disjointQuery = 0;
+	}
+
+	if (m_deviceContext)
+	{
+		m_deviceContext->ClearState();
+		m_deviceContext->Release();
+		m_deviceContext = 0;
+	}
+
+	if (m_device)
+	{
+		m_device->Release();
+		m_device = 0;
+	}
+
+	return;
+}
+
+//	Define makes an object from what the capture wrote of it. A shader or an input layout that came without
+//	bytecode is kept as no object, so what it is bound to is left unbound.
+bool D3DReplayBackendClass::Define(const CommandDefineType* define, const unsigned char* desc, const unsigned char* data)
+{
+	const CommandBufferDescType* bufferDesc;
+	const CommandTextureDescType* textureDesc;
+	const CommandInputElementType* elements;
+	D3D11_BUFFER_DESC d3dBufferDesc;
+	D3D11_TEXTURE2D_DESC d3dTextureDesc;
+	D3D11_SUBRESOURCE_DATA initialData;
+	vector<D3D11_INPUT_ELEMENT_DESC> layout;
+	vector<unsigned char> constants;
+	ID3D11DeviceChild* object;
+	ID3D11Resource* parent;
+	unsigned int count, i;
+	HRESULT result;
+
+	object = 0;
+	result = S_OK;
+
+	switch (define->kind)
+	{
+	case COMMAND_OBJECT_BUFFER:
+		bufferDesc = (const CommandBufferDescType*)desc;
+		if (define->dataSize != 0 && define->dataSize != bufferDesc->byteWidth)
+		{
+			return false;
+		}
+
+		d3dBufferDesc.ByteWidth = bufferDesc->byteWidth;
+		d3dBufferDesc.Usage = (D3D11_USAGE)bufferDesc->usage;
+		d3dBufferDesc.BindFlags = bufferDesc->bindFlags;
+		d3dBufferDesc.CPUAccessFlags = bufferDesc->cpuAccessFlags;
+		d3dBufferDesc.MiscFlags = bufferDesc->miscFlags;
+		d3dBufferDesc.StructureByteStride = bufferDesc->structureByteStride;
+
+		if (d3dBufferDesc.Usage != D3D11_USAGE_STAGING)
+		{
+			d3dBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+			d3dBufferDesc.CPUAccessFlags = 0;
+		}
+
+		initialData.pSysMem = data;
+		initialData.SysMemPitch = 0;
+		initialData.SysMemSlicePitch = 0;
+
+		result = m_device->CreateBuffer(&d3dBufferDesc, define->dataSize > 0 ? &initialData : NULL, (ID3D11Buffer**)&object);
+
+//	A constant buffer can only be updated all at once, so its contents are kept to update parts of:
+		if (d3dBufferDesc.BindFlags & D3D11_BIND_CONSTANT_BUFFER)
+		{
+			constants.resize(bufferDesc->byteWidth);
+			if (define->dataSize > 0)
+			{
+				memcpy(constants.data(), data, define->dataSize);
+			}
+		}
+		break;
+
+	case COMMAND_OBJECT_TEXTURE2D:
+		textureDesc = (const CommandTextureDescType*)desc;
+
+		d3dTextureDesc.Width = textureDesc->width;
+		d3dTextureDesc.Height = textureDesc->height;
+		d3dTextureDesc.MipLevels = textureDesc->mipLevels;
+		d3dTextureDesc.ArraySize = textureDesc->arraySize;
+		d3dTextureDesc.Format = (DXGI_FORMAT)textureDesc->format;
+		d3dTextureDesc.SampleDesc.Count = textureDesc->sampleCount;
+		d3dTextureDesc.SampleDesc.Quality = textureDesc->sampleQuality;
+		d3dTextureDesc.Usage = (D3D11_USAGE)textureDesc->usage;
+		d3dTextureDesc.BindFlags = textureDesc->bindFlags;
+		d3dTextureDesc.CPUAccessFlags = textureDesc->cpuAccessFlags;
+		d3dTextureDesc.MiscFlags = textureDesc->miscFlags;
+
+		if (d3dTextureDesc.Usage != D3D11_USAGE_STAGING)
+		{
+			d3dTextureDesc.Usage = D3D11_USAGE_DEFAULT;
+			d3dTextureDesc.CPUAccessFlags = 0;
+		}
+
+		result = m_device->CreateTexture2D(&d3dTextureDesc, NULL, (ID3D11Texture2D**)&object);
+		if (SUCCEEDED(result) && d3dTextureDesc.Usage == D3D11_USAGE_DEFAULT && define->dataSize > 0)
+		{
+			if (!UploadTexture((ID3D11Texture2D*)object, textureDesc, data, define->dataSize))
+			{
+				object->Release();
+				return false;
+			}
+		}
+		break;
+
+	case COMMAND_OBJECT_SHADER_RESOURCE_VIEW:
+	case COMMAND_OBJECT_RENDER_TARGET_VIEW:
+	case COMMAND_OBJECT_DEPTH_STENCIL_VIEW:
+		parent = FindBufferOrTexture(define->parent);
+		if (!parent)
+		{
+			return false;
+		}
+
+		if (define->kind == COMMAND_OBJECT_SHADER_RESOURCE_VIEW && define->descSize == sizeof(D3D11_SHADER_RESOURCE_VIEW_DESC))
+		{
+			result = m_device->CreateShaderResourceView(parent, (const D3D11_SHADER_RESOURCE_VIEW_DESC*)desc, (ID3D11ShaderResourceView**)&object);
+		}
+		else if (define->kind == COMMAND_OBJECT_RENDER_TARGET_VIEW && define->descSize == sizeof(D3D11_RENDER_TARGET_VIEW_DESC))
+		{
+			result = m_device->CreateRenderTargetView(parent, (const D3D11_RENDER_TARGET_VIEW_DESC*)desc, (ID3D11RenderTargetView**)&object);
+		}
+		else if (define->kind == COMMAND_OBJECT_DEPTH_STENCIL_VIEW && define->descSize == sizeof(D3D11_DEPTH_STENCIL_VIEW_DESC))
+		{
+			result = m_device->CreateDepthStencilView(parent, (const D3D11_DEPTH_STENCIL_VIEW_DESC*)desc, (ID3D11DepthStencilView**)&object);
+		}
+		else
+		{
+			return false;
+		}
+		break;
+
+	case COMMAND_OBJECT_RASTERIZER_STATE:
+		if (define->descSize != sizeof(D3D11_RASTERIZER_DESC))
+		{
+			return false;
+		}
+		result = m_device->CreateRasterizerState((const D3D11_RASTERIZER_DESC*)desc, (ID3D11RasterizerState**)&object);
+		break;
+
+	case COMMAND_OBJECT_BLEND_STATE:
+		if (define->descSize != sizeof(D3D11_BLEND_DESC))
+		{
+			return false;
+		}
+		result = m_device->CreateBlendState((const D3D11_BLEND_DESC*)desc, (ID3D11BlendState**)&object);
+		break;
+
+	case COMMAND_OBJECT_DEPTH_STENCIL_STATE:
+		if (define->descSize != sizeof(D3D11_DEPTH_STENCIL_DESC))
+		{
+			return false;
+		}
+		result = m_device->CreateDepthStencilState((const D3D11_DEPTH_STENCIL_DESC*)desc, (ID3D11DepthStencilState**)&object);
+		break;
+
+	case COMMAND_OBJECT_SAMPLER_STATE:
+		if (define->descSize != sizeof(D3D11_SAMPLER_DESC))
+		{
+			return false;
+		}
+		result = m_device->CreateSamplerState((const D3D11_SAMPLER_DESC*)desc, (ID3D11SamplerState**)&object);
+		break;
+
+	case COMMAND_OBJECT_VERTEX_SHADER:
+		if (define->dataSize > 0)
+		{
+			result = m_device->CreateVertexShader(data, define->dataSize, NULL, (ID3D11VertexShader**)&object);
+		}
+		break;
+
+	case COMMAND_OBJECT_PIXEL_SHADER:
+		if (define->dataSize > 0)
+		{
+			result = m_device->CreatePixelShader(data, define->dataSize, NULL, (ID3D11PixelShader**)&object);
+		}
+		break;
+
+//	The semantic names point into the record, which lives as long as the replay does:
+	case COMMAND_OBJECT_INPUT_LAYOUT:
+		memcpy(&count, desc, sizeof(unsigned int));
+		elements = (const CommandInputElementType*)(desc + sizeof(unsigned int));
+
+		if (define->dataSize > 0 && count > 0)
+		{
+			layout.resize(count);
+			for (i = 0; i < count; i++)
+			{
+				if (memchr(elements[i].semanticName, 0, sizeof(elements[i].semanticName)) == NULL)
+				{
+					return false;
+				}
+
+				layout[i].SemanticName = elements[i].semanticName;
+				layout[i].SemanticIndex = elements[i].semanticIndex;
+				layout[i].Format = (DXGI_FORMAT)elements[i].format;
+				layout[i].InputSlot = elements[i].inputSlot;
+				layout[i].AlignedByteOffset = elements[i].alignedByteOffset;
+				layout[i].InputSlotClass = (D3D11_INPUT_CLASSIFICATION)elements[i].inputSlotClass;
+				layout[i].InstanceDataStepRate = elements[i].instanceDataStepRate;
+			}
+
+			result = m_device->CreateInputLayout(layout.data(), count, data, define->dataSize, (ID3D11InputLayout**)&object);
+		}
+		break;
+	}
+
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_objects.push_back(object);
+	m_kinds.push_back(define->kind);
+	m_constantBuffers.push_back(constants);
+
+	return true;
+}
+
+//	Execute plays one command. Every object is looked up with the kind the command needs, so a file that
+//	names the wrong kind of object fails instead of handing Direct3D something it doesn't expect.
+bool D3DReplayBackendClass::Execute(const CommandRecordType* record, const unsigned char* payload)
+{
+	const unsigned int* words;
+	ID3D11DeviceChild* objects[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT];
+	UINT strides[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT], offsets[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+	D3D11_VIEWPORT viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_BOX box;
+	ID3D11DeviceChild* object;
+	ID3D11Resource* destination;
+	ID3D11Resource* source;
+	FLOAT values[4];
+	unsigned int start, count, limit, kind, i;
+
+	words = (const unsigned int*)payload;
+
+	switch (record->type)
+	{
+	case COMMAND_SET_INPUT_LAYOUT:
+		m_deviceContext->IASetInputLayout((ID3D11InputLayout*)Find(words[0], COMMAND_OBJECT_INPUT_LAYOUT));
+		break;
+
+	case COMMAND_SET_VERTEX_BUFFERS:
+		start = words[0];
+		count = words[1];
+		if (start > D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT || count > D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT - start)
+		{
+			return false;
+		}
+
+		for (i = 0; i < count; i++)
+		{
+			objects[i] = Find(words[2 + i * 3], COMMAND_OBJECT_BUFFER);
+			strides[i] = words[2 + i * 3 + 1];
+			offsets[i] = words[2 + i * 3 + 2];
+		}
+
+		m_deviceContext->IASetVertexBuffers(start, count, (ID3D11Buffer* const*)objects, strides, offsets);
+		break;
+
+	case COMMAND_SET_INDEX_BUFFER:
+		m_deviceContext->IASetIndexBuffer((ID3D11Buffer*)Find(words[0], COMMAND_OBJECT_BUFFER), (DXGI_FORMAT)words[1], words[2]);
+		break;
+
+	case COMMAND_SET_TOPOLOGY:
+		m_deviceContext->IASetPrimitiveTopology((D3D11_PRIMITIVE_TOPOLOGY)words[0]);
+		break;
+
+	case COMMAND_SET_SHADER:
+		if (words[0] == COMMAND_STAGE_VERTEX)
+		{
+			m_deviceContext->VSSetShader((ID3D11VertexShader*)Find(words[1], COMMAND_OBJECT_VERTEX_SHADER), NULL, 0);
+		}
+		else
+		{
+			m_deviceContext->PSSetShader((ID3D11PixelShader*)Find(words[1], COMMAND_OBJECT_PIXEL_SHADER), NULL, 0);
+		}
+		break;
+
+	case COMMAND_SET_CONSTANT_BUFFERS:
+	case COMMAND_SET_SHADER_RESOURCES:
+	case COMMAND_SET_SAMPLERS:
+		if (record->type == COMMAND_SET_CONSTANT_BUFFERS)
+		{
+			limit = D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT;
+			kind = COMMAND_OBJECT_BUFFER;
+		}
+		else if (record->type == COMMAND_SET_SHADER_RESOURCES)
+		{
+			limit = D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT;
+			kind = COMMAND_OBJECT_SHADER_RESOURCE_VIEW;
+		}
+		else
+		{
+			limit = D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT;
+			kind = COMMAND_OBJECT_SAMPLER_STATE;
+		}
+
+		start = words[1];
+		count = words[2];
+		if (start > limit || count > limit - start)
+		{
+			return false;
+		}
+
+		for (i = 0; i < count; i++)
+		{
+			objects[i] = Find(words[3 + i], kind);
+		}
+
+		if (record->type == COMMAND_SET_CONSTANT_BUFFERS)
+		{
+			if (words[0] == COMMAND_STAGE_VERTEX)
+			{
+				m_deviceContext->VSSetConstantBuffers(start, count, (ID3D11Buffer* const*)objects);
+			}
+			else
+			{
+				m_deviceContext->PSSetConstantBuffers(start, count, (ID3D11Buffer* const*)objects);
+			}
+		}
+		else if (record->type == COMMAND_SET_SHADER_RESOURCES)
+		{
+			if (words[0] == COMMAND_STAGE_VERTEX)
+			{
+				m_deviceContext->VSSetShaderResources(start, count, (ID3D11ShaderResourceView* const*)objects);
+			}
+			else
+			{
+				m_deviceContext->PSSetShaderResources(start, count, (ID3D11ShaderResourceView* const*)objects);
+			}
+		}
+		else
+		{
+			if (words[0] == COMMAND_STAGE_VERTEX)
+			{
+				m_deviceContext->VSSetSamplers(start, count, (ID3D11SamplerState* const*)objects);
+			}
+			else
+			{
+				m_deviceContext->PSSetSamplers(start, count, (ID3D11SamplerState* const*)objects);
+			}
+		}
+		break;
+
+	case COMMAND_SET_RENDER_TARGETS:
+		count = words[0];
+		if (count > D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT)
+		{
+			return false;
+		}
+
+		for (i = 0; i < count; i++)
+		{
+			objects[i] = Find(words[2 + i], COMMAND_OBJECT_RENDER_TARGET_VIEW);
+		}
+
+		m_deviceContext->OMSetRenderTargets(count, (ID3D11RenderTargetView* const*)objects, (ID3D11DepthStencilView*)Find(words[1], COMMAND_OBJECT_DEPTH_STENCIL_VIEW));
+		break;
+
+	case COMMAND_SET_BLEND_STATE:
+		memcpy(values, &words[1], sizeof(values));
+		m_deviceContext->OMSetBlendState((ID3D11BlendState*)Find(words[0], COMMAND_OBJECT_BLEND_STATE), values, words[5]);
+		break;
+
+	case COMMAND_SET_DEPTH_STENCIL_STATE:
+		m_deviceContext->OMSetDepthStencilState((ID3D11DepthStencilState*)Find(words[0], COMMAND_OBJECT_DEPTH_STENCIL_STATE), words[1]);
+		break;
+
+	case COMMAND_SET_RASTERIZER_STATE:
+		m_deviceContext->RSSetState((ID3D11RasterizerState*)Find(words[0], COMMAND_OBJECT_RASTERIZER_STATE));
+		break;
+
+	case COMMAND_SET_VIEWPORTS:
+		count = words[0];
+		if (count > D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE)
+		{
+			return false;
+		}
+
+		memcpy(viewports, &words[1], count * sizeof(D3D11_VIEWPORT));
+		m_deviceContext->RSSetViewports(count, viewports);
+		break;
+
+	case COMMAND_CLEAR_RENDER_TARGET:
+		object = Find(words[0], COMMAND_OBJECT_RENDER_TARGET_VIEW);
+		if (object)
+		{
+			memcpy(values, &words[1], sizeof(values));
+			m_deviceContext->ClearRenderTargetView((ID3D11RenderTargetView*)object, values);
+		}
+		break;
+
+	case COMMAND_CLEAR_DEPTH_STENCIL:
+		object = Find(words[0], COMMAND_OBJECT_DEPTH_STENCIL_VIEW);
+		if (object)
+		{
+			memcpy(values, &words[2], sizeof(FLOAT));
+			m_deviceContext->ClearDepthStencilView((ID3D11DepthStencilView*)object, words[1], values[0], (UINT8)words[3]);
+		}
+		break;
+
+	case COMMAND_UPDATE_BUFFER:
+		object = Find(words[0], COMMAND_OBJECT_BUFFER);
+		if (!object)
+		{
+			return false;
+		}
+
+		((ID3D11Buffer*)object)->GetDesc(&bufferDesc);
+		if (words[1] > bufferDesc.ByteWidth || words[2] > bufferDesc.ByteWidth - words[1])
+		{
+			return false;
+		}
+
+		if (bufferDesc.Usage == D3D11_USAGE_STAGING)
+		{
+			break;
+		}
+
+		if (!m_constantBuffers[words[0]].empty())
+		{
+			memcpy(m_constantBuffers[words[0]].data() + words[1], &words[3], words[2]);
+			m_deviceContext->UpdateSubresource((ID3D11Buffer*)object, 0, NULL, m_constantBuffers[words[0]].data(), 0, 0);
+		}
+		else
+		{
+			box.left = words[1];
+			box.right = words[1] + words[2];
+			box.top = 0;
+			box.bottom = 1;
+			box.front = 0;
+			box.back = 1;
+			m_deviceContext->UpdateSubresource((ID3D11Buffer*)object, 0, &box, &words[3], 0, 0);
+		}
+		break;
+
+//	A copy into a constant buffer isn't seen by the contents kept for it, which the capture never makes:
+	case COMMAND_COPY_RESOURCE:
+		destination = FindBufferOrTexture(words[0]);
+		source = FindBufferOrTexture(words[1]);
+		if (destination && source)
+		{
+			m_deviceContext->CopyResource(destination, source);
+		}
+		break;
+
+	case COMMAND_COPY_SUBRESOURCE_REGION:
+		destination = FindBufferOrTexture(words[0]);
+		source = FindBufferOrTexture(words[5]);
+		if (destination && source)
+		{
+			box.left = words[8];
+			box.top = words[9];
+			box.front = words[10];
+			box.right = words[11];
+			box.bottom = words[12];
+			box.back = words[13];
+			m_deviceContext->CopySubresourceRegion(destination, words[1], words[2], words[3], words[4], source, words[6], words[7] ? &box : NULL);
+		}
+		break;
+
+	case COMMAND_DRAW:
+		m_deviceContext->Draw(words[0], words[1]);
+		break;
+
+	case COMMAND_DRAW_INDEXED:
+		m_deviceContext->DrawIndexed(words[0], words[1], (INT)words[2]);
+		break;
+
+	case COMMAND_DRAW_INSTANCED:
+		m_deviceContext->DrawInstanced(words[0], words[1], words[2], words[3]);
+		break;
+
+	case COMMAND_DRAW_INDEXED_INSTANCED:
+		m_deviceContext->DrawIndexedInstanced(words[0], words[1], words[2], (INT)words[3], words[4]);
+		break;
+	}
+
+	return true;
+}
+
+//	Reset puts back the contents a buffer or texture was defined with. Staging resources are left as they
+//	are, since they can't be updated and nothing draws with them.
+bool D3DReplayBackendClass::Reset(const CommandDefineType* define, const unsigned char* data)
+{
+	D3D11_BUFFER_DESC bufferDesc;
+	ID3D11DeviceChild* object;
+
+	if (define->dataSize == 0)
+	{
+		return true;
+	}
+
+	if (define->kind == COMMAND_OBJECT_BUFFER)
+	{
+		object = Find(define->object, COMMAND_OBJECT_BUFFER);
+		((ID3D11Buffer*)object)->GetDesc(&bufferDesc);
+		if (bufferDesc.Usage == D3D11_USAGE_STAGING)
+		{
+			return true;
+		}
+
+		if (!m_constantBuffers[define->object].empty())
+		{
+			memcpy(m_constantBuffers[define->object].data(), data, define->dataSize);
+		}
+
+		m_deviceContext->UpdateSubresource((ID3D11Buffer*)object, 0, NULL, data, 0, 0);
+	}
+	else if (define->kind == COMMAND_OBJECT_TEXTURE2D)
+	{
+		if (((const CommandTextureDescType*)(define + 1))->usage == D3D11_USAGE_STAGING)
+		{
+			return true;
+		}
+
+		object = Find(define->object, COMMAND_OBJECT_TEXTURE2D);
+		return UploadTexture((ID3D11Texture2D*)object, (const CommandTextureDescType*)(define + 1), data, define->dataSize);
+	}
+
+	return true;
+}
+
+//	The first draw of a frame begins the disjoint query the timestamps of the frame are read within.
+void D3DReplayBackendClass::BeginDraw(int draw)
+{
+	D3D11_QUERY_DESC queryDesc;
+	QueryType query;
+	HRESULT result;
+
+	if (!m_frameBegun)
+	{
+		m_deviceContext->Begin(m_disjointQuery);
+		m_frameBegun = true;
+	}
+
+	queryDesc.Query = D3D11_QUERY_TIMESTAMP;
+	queryDesc.MiscFlags = 0;
+
+	while ((int)m_queries.size() <= draw)
+	{
+		result = m_device->CreateQuery(&queryDesc, &query.begin);
+		if (FAILED(result))
+		{
+			return;
+		}
+
+		result = m_device->CreateQuery(&queryDesc, &query.end);
+		if (FAILED(result))
+		{
+			query.begin->Release();
+			return;
+		}
+
+		m_queries.push_back(query);
+	}
+
+	m_deviceContext->End(m_queries[draw].begin);
+
+	return;
+}
+
+void D3DReplayBackendClass::EndDraw(int draw)
+{
+	if (draw < (int)m_queries.size())
+	{
+		m_deviceContext->End(m_queries[draw].end);
+	}
+
+	return;
+}
+
+//	EndFrame waits for the GPU to finish the frame and reads back the time of each of its draws. Times from a
+//	frame the clock was disjoint in are thrown away.
+bool D3DReplayBackendClass::EndFrame(int drawCount)
+{
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+	UINT64 begin, end;
+	int i;
+
+	m_drawTimes.assign(drawCount, -1.0f);
+
+	if (!m_frameBegun)
+	{
+		return true;
+	}
+
+	m_deviceContext->End(m_disjointQuery);
+	m_frameBegun = false;
+
+	while (m_deviceContext->GetData(m_disjointQuery, &disjoint, sizeof(disjoint), 0) != S_OK)
+	{
+	}
+
+	if (disjoint.Disjoint || disjoint.Frequency == 0)
+	{
+		return true;
+	}
+
+	for (i = 0; i < drawCount && i < (int)m_queries.size(); i++)
+	{
+		while (m_deviceContext->GetData(m_queries[i].begin, &begin, sizeof(UINT64), 0) != S_OK)
+		{
+		}
+		while (m_deviceContext->GetData(m_queries[i].end, &end, sizeof(UINT64), 0) != S_OK)
+		{
+		}
+
+		m_drawTimes[i] = (float)((double)(end - begin) * 1000.0 / (double)disjoint.Frequency);
+	}
+
+	return true;
+}
+
+float D3DReplayBackendClass::GetDrawTime(int draw)
+{
+	return draw < (int)m_drawTimes.size() ? m_drawTimes[draw] : -1.0f;
+}
+
+//	Find gives the object with the number, or no object when there isn't one of that kind.
+ID3D11DeviceChild* D3DReplayBackendClass::Find(unsigned int object, unsigned int kind)
+{
+	if (object >= m_objects.size() || m_kinds[object] != kind)
+	{
+		return 0;
+	}
+
+	return m_objects[object];
+}
+
+ID3D11Resource* D3DReplayBackendClass::FindBufferOrTexture(unsigned int object)
+{
+	if (object >= m_objects.size() || (m_kinds[object] != COMMAND_OBJECT_BUFFER && m_kinds[object] != COMMAND_OBJECT_TEXTURE2D))
+	{
+		return 0;
+	}
+
+	return (ID3D11Resource*)m_objects[object];
+}
+
+//	UploadTexture writes every subresource of a texture from the contents the capture read back, checking
+//	that each one is all there.
+bool D3DReplayBackendClass::UploadTexture(ID3D11Texture2D* texture, const CommandTextureDescType* desc, const unsigned char* data, unsigned int dataSize)
+{
+	unsigned int offset, rowPitch, rowCount, subresource;
+
+	offset = 0;
+
+	for (subresource = 0; subresource < desc->mipLevels * desc->arraySize; subresource++)
+	{
+		if (dataSize - offset < 2 * sizeof(unsigned int))
+		{
+			return false;
+		}
+
+		memcpy(&rowPitch, data + offset, sizeof(unsigned int));
+		memcpy(&rowCount, data + offset + sizeof(unsigned int), sizeof(unsigned int));
+		offset += 2 * sizeof(unsigned int);
+
+		if (rowCount > 0 && rowPitch > (dataSize - offset) / rowCount)
+		{
+			return false;
+		}
+
+		m_deviceContext->UpdateSubresource(texture, subresource, NULL, data + offset, rowPitch, rowPitch * rowCount);
+		offset += rowPitch * rowCount;
+	}
+
+	return true;
+}
@@ -0,0 +1,31 @@
+//  The debug vertex shader takes the lines of the Debug Draw Object from world space to clip space.
+
+// Globals:
+cbuffer DebugBuffer
+{
+    matrix viewProjectionMatrix;
+};
+
+//  Typedefs:
+struct VertexInputType
+{
+    float3 position : POSITION;
+    float4 color : COLOR;
+};
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float4 color : COLOR;
+};
+
+//  Vertex Shader:
+PixelInputType DebugVertexShader(VertexInputType input)
+{
+    PixelInputType output;
+
+    output.position = mul(float4(input.position, 1.0f), viewProjectionMatrix);
+    output.color = input.color;
+
+    return output;
+}
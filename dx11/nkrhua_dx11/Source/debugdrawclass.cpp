@@ -0,0 +1,565 @@
+#include "../Headers/debugdrawclass.h"
+
+#if DEBUG_DRAW_ENABLED
+
+#include <math.h>
+
+//	The Debug Draw the calling thread last added to and its buffer there, told apart by an id the same way the
+//	Sprite Batch does.
+static atomic<unsigned int> g_nextDebugDrawId(1);
+static thread_local unsigned int g_threadDebugDrawId = 0;
+static thread_local void* g_threadDebugBuffer = 0;
+
+//	The line vertices every kind of primitive is expanded into: a line, the twelve edges of a box or frustum,
+//	three circles for a sphere and a line with four more for the head of an arrow.
+static const int DEBUG_PRIMITIVE_VERTICES[] = { 2, 24, 6 * DEBUG_DRAW_SPHERE_SEGMENTS, 24, 10 };
+
+//	WriteCube writes the twelve edges of the cube from -1 to 1, or from a depth of 0 to 1 for a frustum, moved
+//	by the transform. The corners are numbered by which of x, y and z are at their maximum, so the edges run
+//	from every corner to the ones with one more of those bits set.
+static void WriteCube(DebugVertexType* vertices, FXMMATRIX transform, float minimumZ, PackedVector::XMUBYTEN4 color)
+{
+	XMFLOAT3 corners[8];
+	int i, bit;
+
+	for (i = 0; i < 8; i++)
+	{
+		XMStoreFloat3(&corners[i], XMVector3TransformCoord(XMVectorSet((i & 1) ? 1.0f : -1.0f, (i & 2) ? 1.0f : -1.0f, (i & 4) ? 1.0f : minimumZ, 1.0f),
+			transform));
+	}
+
+	for (i = 0; i < 8; i++)
+	{
+		for (bit = 1; bit < 8; bit <<= 1)
+		{
+			if (i & bit)
+			{
+				continue;
+			}
+
+			vertices[0].position = corners[i];
+			vertices[0].color = color;
+			vertices[1].position = corners[i | bit];
+			vertices[1].color = color;
+			vertices += 2;
+		}
+	}
+
+	return;
+}
+
+DebugDrawClass::DebugDrawClass()
+{
+	int i;
+
+	m_id = 0;
+	m_maxVertices = 0;
+	for (i = 0; i < DEBUG_DRAW_SPHERE_SEGMENTS; i++)
+	{
+		m_circle[i] = XMFLOAT2(0.0f, 0.0f);
+	}
+	m_threadBuffers = 0;
+	m_vertexCounts[0] = 0;
+	m_vertexCounts[1] = 0;
+	m_droppedCount = 0;
+	m_ResourceRegistry = 0;
+	m_vertexBuffer.id = 0;
+	m_debugBuffer.id = 0;
+	m_ShaderManager = 0;
+	m_shaderFamily = -1;
+}
+
+DebugDrawClass::DebugDrawClass(const DebugDrawClass& other)
+{
+
+}
+
+DebugDrawClass::~DebugDrawClass()
+{
+
+}
+
+//	Precompile compiles the debug shaders ahead of Initialize, the same way the color shader does.
+void DebugDrawClass::Precompile(ShaderManagerClass* shaderManager)
+{
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+
+	if (wcscpy_s(vsFilename, 128, L"./Source/debug.vs") != 0 || wcscpy_s(psFilename, 128, L"./Source/debug.ps") != 0)
+	{
+		return;
+	}
+
+	shaderManager->Precompile(vsFilename, "DebugVertexShader", psFilename, "DebugPixelShader", 0);
+
+	return;
+}
+
+bool DebugDrawClass::Initialize(ID3D11Device* device, ResourceRegistryClass* resourceRegistry, ShaderManagerClass* shaderManager, int maxVertices)
+{
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+	int error, i;
+
+	if (maxVertices <= 0)
+	{
+		return false;
+	}
+
+	m_id = g_nextDebugDrawId++;
+	m_maxVertices = maxVertices;
+	m_ResourceRegistry = resourceRegistry;
+	m_ShaderManager = shaderManager;
+
+//	The points of a circle of radius 1, which every circle of a sphere is scaled from:
+	for (i = 0; i < DEBUG_DRAW_SPHERE_SEGMENTS; i++)
+	{
+		XMScalarSinCos(&m_circle[i].y, &m_circle[i].x, XM_2PI * (float)i / (float)DEBUG_DRAW_SPHERE_SEGMENTS);
+	}
+
+//	Set the filenames of the Vertex and Pixel Shader:
+	error = wcscpy_s(vsFilename, 128, L"./Source/debug.vs");
+	if (error != 0)
+	{
+		return false;
+	}
+
+	error = wcscpy_s(psFilename, 128, L"./Source/debug.ps");
+	if (error != 0)
+	{
+		return false;
+	}
+
+	if (!InitializeShader(vsFilename, psFilename))
+	{
+		return false;
+	}
+
+	return InitializeBuffers(device);
+}
+
+void DebugDrawClass::Shutdown()
+{
+	ThreadBufferType* buffer;
+	ThreadBufferType* next;
+
+	if (m_ResourceRegistry)
+	{
+		m_ResourceRegistry->Release(m_vertexBuffer);
+		m_ResourceRegistry->Release(m_debugBuffer);
+		m_ResourceRegistry = 0;
+	}
+
+//	The Shaders belong to the Shader Manager which releases them on its own Shutdown.
+	m_shaderFamily = -1;
+	m_ShaderManager = 0;
+
+//	The threads that added to this Debug Draw still cache its id, which no other one gets, so they won't use
+//	the buffers after they are gone:
+	for (buffer = m_threadBuffers.exchange(0); buffer; buffer = next)
+	{
+		next = buffer->next;
+		delete buffer;
+	}
+
+	return;
+}
+
+void DebugDrawClass::AddLine(XMFLOAT3 start, XMFLOAT3 end, XMFLOAT4 color, bool depthTest)
+{
+	XMFLOAT4X4 transform;
+
+	transform._11 = start.x;
+	transform._12 = start.y;
+	transform._13 = start.z;
+	transform._21 = end.x;
+	transform._22 = end.y;
+	transform._23 = end.z;
+
+	Add(DEBUG_PRIMITIVE_LINE, transform, color, depthTest);
+
+	return;
+}
+
+//	AddBox adds a box along the axes from its minimum to its maximum corner.
+void DebugDrawClass::AddBox(XMFLOAT3 minimum, XMFLOAT3 maximum, XMFLOAT4 color, bool depthTest)
+{
+	AddOrientedBox(minimum, maximum, XMMatrixIdentity(), color, depthTest);
+
+	return;
+}
+
+//	AddOrientedBox adds a box from its minimum to its maximum corner in the space of a world matrix, such as the
+//	local box of a mesh.
+void DebugDrawClass::AddOrientedBox(XMFLOAT3 minimum, XMFLOAT3 maximum, XMMATRIX worldMatrix, XMFLOAT4 color, bool depthTest)
+{
+	XMFLOAT4X4 transform;
+	XMMATRIX boxMatrix;
+
+	boxMatrix = XMMatrixScaling(0.5f * (maximum.x - minimum.x), 0.5f * (maximum.y - minimum.y), 0.5f * (maximum.z - minimum.z));
+	boxMatrix = XMMatrixMultiply(boxMatrix, XMMatrixTranslation(0.5f * (maximum.x + minimum.x), 0.5f * (maximum.y + minimum.y), 0.5f * (maximum.z + minimum.z)));
+	XMStoreFloat4x4(&transform, XMMatrixMultiply(boxMatrix, worldMatrix));
+
+	Add(DEBUG_PRIMITIVE_BOX, transform, color, depthTest);
+
+	return;
+}
+
+void DebugDrawClass::AddSphere(XMFLOAT3 center, float radius, XMFLOAT4 color, bool depthTest)
+{
+	XMFLOAT4X4 transform;
+
+	transform._11 = center.x;
+	transform._12 = center.y;
+	transform._13 = center.z;
+	transform._14 = radius;
+
+	Add(DEBUG_PRIMITIVE_SPHERE, transform, color, depthTest);
+
+	return;
+}
+
+//	AddFrustum adds the frustum of a view and projection matrix multiplied together, such as that of a camera
+//	or a shadow cascade.
+void DebugDrawClass::AddFrustum(XMMATRIX viewProjectionMatrix, XMFLOAT4 color, bool depthTest)
+{
+	XMFLOAT4X4 transform;
+
+	XMStoreFloat4x4(&transform, XMMatrixInverse(NULL, viewProjectionMatrix));
+
+	Add(DEBUG_PRIMITIVE_FRUSTUM, transform, color, depthTest);
+
+	return;
+}
+
+//	AddArrow adds a line from the start to the end with a head at the end.
+void DebugDrawClass::AddArrow(XMFLOAT3 start, XMFLOAT3 end, XMFLOAT4 color, bool depthTest)
+{
+	XMFLOAT4X4 transform;
+
+	transform._11 = start.x;
+	transform._12 = start.y;
+	transform._13 = start.z;
+	transform._21 = end.x;
+	transform._22 = end.y;
+	transform._23 = end.z;
+
+	Add(DEBUG_PRIMITIVE_ARROW, transform, color, depthTest);
+
+	return;
+}
+
+//	Clear drops the primitives added so far without drawing them.
+void DebugDrawClass::Clear()
+{
+	ThreadBufferType* buffer;
+
+	for (buffer = m_threadBuffers.load(); buffer; buffer = buffer->next)
+	{
+		buffer->primitives[0].clear();
+		buffer->primitives[1].clear();
+	}
+
+	return;
+}
+
+//	Flush expands the primitives of every thread into the vertex buffer, the depth tested ones of all threads
+//	first and then the others, empties the buffers and sets the view projection matrix Render draws them with.
+//	Primitives that don't fit into the most vertices a frame draws are dropped.
+bool DebugDrawClass::Flush(ID3D11DeviceContext* deviceContext, XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+{
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	DebugBufferType* dataPtr;
+	DebugVertexType* vertices;
+	ID3D11Buffer* vertexBuffer;
+	ID3D11Buffer* debugBuffer;
+	ThreadBufferType* buffer;
+	HRESULT result;
+	unsigned int i;
+	int list, count, start;
+
+	m_droppedCount = 0;
+
+	vertexBuffer = m_ResourceRegistry->Get(m_vertexBuffer);
+	debugBuffer = m_ResourceRegistry->Get(m_debugBuffer);
+
+	result = deviceContext->Map(vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	vertices = (DebugVertexType*)mappedResource.pData;
+
+	count = 0;
+	for (list = 0; list < 2; list++)
+	{
+		start = count;
+
+		for (buffer = m_threadBuffers.load(); buffer; buffer = buffer->next)
+		{
+			for (i = 0; i < buffer->primitives[list].size(); i++)
+			{
+				if (count + DEBUG_PRIMITIVE_VERTICES[buffer->primitives[list][i].kind] > m_maxVertices)
+				{
+					m_droppedCount++;
+					continue;
+				}
+
+				count += WritePrimitive(buffer->primitives[list][i], vertices + count);
+			}
+
+			buffer->primitives[list].clear();
+		}
+
+		m_vertexCounts[list] = count - start;
+	}
+
+	deviceContext->Unmap(vertexBuffer, 0);
+
+	result = deviceContext->Map(debugBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	dataPtr = (DebugBufferType*)mappedResource.pData;
+	dataPtr->viewProjection = XMMatrixTranspose(XMMatrixMultiply(viewMatrix, projectionMatrix));
+
+	deviceContext->Unmap(debugBuffer, 0);
+
+	return true;
+}
+
+//	Render draws the depth tested lines of the last Flush, or the ones drawn on top of everything. The caller
+//	sets the depth state for either.
+bool DebugDrawClass::Render(ID3D11DeviceContext* deviceContext, bool depthTest)
+{
+	ID3D11Buffer* vertexBuffer;
+	ID3D11Buffer* debugBuffer;
+	unsigned int stride, offset;
+	int list;
+
+	list = depthTest ? 0 : 1;
+	if (m_vertexCounts[list] == 0)
+	{
+		return true;
+	}
+
+	vertexBuffer = m_ResourceRegistry->Get(m_vertexBuffer);
+	debugBuffer = m_ResourceRegistry->Get(m_debugBuffer);
+
+	if (!m_ShaderManager->SetShader(deviceContext, m_shaderFamily, 0))
+	{
+		return false;
+	}
+
+	stride = sizeof(DebugVertexType);
+	offset = 0;
+
+	deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_LINELIST);
+	deviceContext->VSSetConstantBuffers(0, 1, &debugBuffer);
+
+	deviceContext->Draw(m_vertexCounts[list], depthTest ? 0 : m_vertexCounts[0]);
+
+	return true;
+}
+
+//	The vertices and the primitives that didn't fit of the last Flush.
+int DebugDrawClass::GetVertexCount()
+{
+	return m_vertexCounts[0] + m_vertexCounts[1];
+}
+
+int DebugDrawClass::GetDroppedCount()
+{
+	return m_droppedCount;
+}
+
+bool DebugDrawClass::InitializeShader(WCHAR* vsFilename, WCHAR* psFilename)
+{
+	ShaderInputType input;
+
+	input.flags = 0;
+	input.format = &DebugVertexType::GetFormat();
+
+	m_shaderFamily = m_ShaderManager->AddShader(vsFilename, "DebugVertexShader", psFilename, "DebugPixelShader", 0, &input, 1, NULL);
+	if (m_shaderFamily < 0)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+//	InitializeBuffers creates the dynamic vertex buffer for the lines of a frame and the constant buffer.
+bool DebugDrawClass::InitializeBuffers(ID3D11Device* device)
+{
+	D3D11_BUFFER_DESC bufferDesc;
+	ID3D11Buffer* buffer;
+	HRESULT result;
+
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = sizeof(DebugVertexType) * m_maxVertices;
+	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_vertexBuffer = m_ResourceRegistry->Register(buffer);
+
+	bufferDesc.ByteWidth = sizeof(DebugBufferType);
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_debugBuffer = m_ResourceRegistry->Register(buffer);
+
+	return true;
+}
+
+//	Add packs the color and appends the primitive to the list of the calling thread it belongs in.
+void DebugDrawClass::Add(int kind, const XMFLOAT4X4& transform, XMFLOAT4 color, bool depthTest)
+{
+	PrimitiveType primitive;
+
+	primitive.kind = kind;
+	primitive.transform = transform;
+	PackedVector::XMStoreUByteN4(&primitive.color, XMLoadFloat4(&color));
+
+	GetThreadBuffer()->primitives[depthTest ? 0 : 1].push_back(primitive);
+
+	return;
+}
+
+//	GetThreadBuffer returns the buffer of the calling thread from its thread local cache. Otherwise it looks
+//	for it in the list, and if the thread has none yet it pushes a new one onto the front of the list with a
+//	compare and swap. Buffers are only taken off the list at Shutdown, so walking it needs no lock either.
+DebugDrawClass::ThreadBufferType* DebugDrawClass::GetThreadBuffer()
+{
+	ThreadBufferType* buffer;
+	thread::id owner;
+
+	if (g_threadDebugDrawId == m_id)
+	{
+		return (ThreadBufferType*)g_threadDebugBuffer;
+	}
+
+	owner = this_thread::get_id();
+
+	for (buffer = m_threadBuffers.load(); buffer; buffer = buffer->next)
+	{
+		if (buffer->owner == owner)
+		{
+			break;
+		}
+	}
+
+	if (!buffer)
+	{
+		buffer = new ThreadBufferType;
+		buffer->owner = owner;
+		buffer->next = m_threadBuffers.load();
+		while (!m_threadBuffers.compare_exchange_weak(buffer->next, buffer))
+		{
+		}
+	}
+
+	g_threadDebugDrawId = m_id;
+	g_threadDebugBuffer = buffer;
+
+	return buffer;
+}
+
+//	WritePrimitive expands one primitive into its line vertices and returns how many it wrote.
+int DebugDrawClass::WritePrimitive(const PrimitiveType& primitive, DebugVertexType* vertices)
+{
+	XMVECTOR start, end, direction, side, up, base, center;
+	XMVECTOR axes[3];
+	XMFLOAT3 tips[4];
+	float length, radius;
+	int axis, i, next;
+
+	if (primitive.kind == DEBUG_PRIMITIVE_BOX || primitive.kind == DEBUG_PRIMITIVE_FRUSTUM)
+	{
+		WriteCube(vertices, XMLoadFloat4x4(&primitive.transform), (primitive.kind == DEBUG_PRIMITIVE_BOX) ? -1.0f : 0.0f, primitive.color);
+	}
+	else if (primitive.kind == DEBUG_PRIMITIVE_SPHERE)
+	{
+//	A circle around each axis:
+		center = XMVectorSet(primitive.transform._11, primitive.transform._12, primitive.transform._13, 0.0f);
+		radius = primitive.transform._14;
+
+		axes[0] = XMVectorSet(radius, 0.0f, 0.0f, 0.0f);
+		axes[1] = XMVectorSet(0.0f, radius, 0.0f, 0.0f);
+		axes[2] = XMVectorSet(0.0f, 0.0f, radius, 0.0f);
+
+		for (axis = 0; axis < 3; axis++)
+		{
+			for (i = 0; i < DEBUG_DRAW_SPHERE_SEGMENTS; i++)
+			{
+				next = (i + 1 < DEBUG_DRAW_SPHERE_SEGMENTS) ? i + 1 : 0;
+
+				XMStoreFloat3(&vertices[0].position, XMVectorAdd(center, XMVectorAdd(XMVectorScale(axes[axis], m_circle[i].x),
+					XMVectorScale(axes[(axis + 1) % 3], m_circle[i].y))));
+				vertices[0].color = primitive.color;
+				XMStoreFloat3(&vertices[1].position, XMVectorAdd(center, XMVectorAdd(XMVectorScale(axes[axis], m_circle[next].x),
+					XMVectorScale(axes[(axis + 1) % 3], m_circle[next].y))));
+				vertices[1].color = primitive.color;
+				vertices += 2;
+			}
+		}
+	}
+	else
+	{
+		vertices[0].position = XMFLOAT3(primitive.transform._11, primitive.transform._12, primitive.transform._13);
+		vertices[0].color = primitive.color;
+		vertices[1].position = XMFLOAT3(primitive.transform._21, primitive.transform._22, primitive.transform._23);
+		vertices[1].color = primitive.color;
+
+//	The head of an arrow is four lines back from the end, a fifth of its length long and spread out across
+//	two directions at right angles to it:
+		if (primitive.kind == DEBUG_PRIMITIVE_ARROW)
+		{
+			start = XMLoadFloat3(&vertices[0].position);
+			end = XMLoadFloat3(&vertices[1].position);
+
+			direction = XMVectorSubtract(end, start);
+			length = XMVectorGetX(XMVector3Length(direction));
+			direction = (length > 0.0f) ? XMVectorScale(direction, 1.0f / length) : XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
+
+			up = (fabsf(XMVectorGetY(direction)) < 0.99f) ? XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f) : XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f);
+			side = XMVectorScale(XMVector3Normalize(XMVector3Cross(direction, up)), 0.1f * length);
+			up = XMVectorScale(XMVector3Normalize(XMVector3Cross(direction, side)), 0.1f * length);
+			base = XMVectorSubtract(end, XMVectorScale(direction, 0.2f * length));
+
+			XMStoreFloat3(&tips[0], XMVectorAdd(base, side));
+			XMStoreFloat3(&tips[1], XMVectorSubtract(base, side));
+			XMStoreFloat3(&tips[2], XMVectorAdd(base, up));
+			XMStoreFloat3(&tips[3], XMVectorSubtract(base, up));
+
+			for (i = 0; i < 4; i++)
+			{
+				vertices[2 + i * 2].position = vertices[1].position;
+				vertices[2 + i * 2].color = primitive.color;
+				vertices[3 + i * 2].position = tips[i];
+				vertices[3 + i * 2].color = primitive.color;
+			}
+		}
+	}
+
+	return DEBUG_PRIMITIVE_VERTICES[primitive.kind];
+}
+
+#endif
@@ -0,0 +1,635 @@
+#include "../Headers/devicecontextproxyclass.h"
+
+DeviceContextProxyClass::DeviceContextProxyClass()
+{
+	m_deviceContext = 0;
+	m_referenceCount = 1;
+}
+
+//	A copy is a new proxy in front of nothing, with the one reference of its creator.
+DeviceContextProxyClass::DeviceContextProxyClass(const DeviceContextProxyClass& other)
+{
+	m_deviceContext = 0;
+	m_referenceCount = 1;
+}
+
+DeviceContextProxyClass::~DeviceContextProxyClass()
+{
+	SetDeviceContext(0);
+}
+
+ID3D11DeviceContext* DeviceContextProxyClass::GetDeviceContext()
+{
+	return m_deviceContext;
+}
+
+//	SetDeviceContext puts the proxy in front of a device context, holding a reference to it, and lets go of
+//	the one it stood in front of before.
+void DeviceContextProxyClass::SetDeviceContext(ID3D11DeviceContext* deviceContext)
+{
+	if (deviceContext)
+	{
+		deviceContext->AddRef();
+	}
+
+	if (m_deviceContext)
+	{
+		m_deviceContext->Release();
+	}
+
+	m_deviceContext = deviceContext;
+
+	return;
+}
+
+//	Asking for the device context itself gives back the proxy, so the calls made through what comes back are
+//	still seen. Any other interface is the device context's own.
+HRESULT DeviceContextProxyClass::QueryInterface(REFIID riid, void** object)
+{
+	if (IsEqualIID(riid, __uuidof(ID3D11DeviceContext)) || IsEqualIID(riid, __uuidof(ID3D11DeviceChild)) || IsEqualIID(riid, __uuidof(IUnknown)))
+	{
+		*object = this;
+		AddRef();
+		return S_OK;
+	}
+
+	return m_deviceContext->QueryInterface(riid, object);
+}
+
+ULONG DeviceContextProxyClass::AddRef()
+{
+	return (ULONG)InterlockedIncrement(&m_referenceCount);
+}
+
+ULONG DeviceContextProxyClass::Release()
+{
+	long count;
+
+	count = InterlockedDecrement(&m_referenceCount);
+	if (count == 0)
+	{
+		delete this;
+	}
+
+	return (ULONG)count;
+}
+
+void DeviceContextProxyClass::GetDevice(ID3D11Device** device)
+{
+	m_deviceContext->GetDevice(device);
+}
+
+HRESULT DeviceContextProxyClass::GetPrivateData(REFGUID guid, UINT* dataSize, void* data)
+{
+	return m_deviceContext->GetPrivateData(guid, dataSize, data);
+}
+
+HRESULT DeviceContextProxyClass::SetPrivateData(REFGUID guid, UINT dataSize, const void* data)
+{
+	return m_deviceContext->SetPrivateData(guid, dataSize, data);
+}
+
+HRESULT DeviceContextProxyClass::SetPrivateDataInterface(REFGUID guid, const IUnknown* data)
+{
+	return m_deviceContext->SetPrivateDataInterface(guid, data);
+}
+
+void DeviceContextProxyClass::IASetInputLayout(ID3D11InputLayout* layout)
+{
+	m_deviceContext->IASetInputLayout(layout);
+}
+
+void DeviceContextProxyClass::IASetVertexBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers, const UINT* strides, const UINT* offsets)
+{
+	m_deviceContext->IASetVertexBuffers(startSlot, count, buffers, strides, offsets);
+}
+
+void DeviceContextProxyClass::IASetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset)
+{
+	m_deviceContext->IASetIndexBuffer(buffer, format, offset);
+}
+
+void DeviceContextProxyClass::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	m_deviceContext->IASetPrimitiveTopology(topology);
+}
+
+void DeviceContextProxyClass::VSSetShader(ID3D11VertexShader* shader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount)
+{
+	m_deviceContext->VSSetShader(shader, classInstances, classInstanceCount);
+}
+
+void DeviceContextProxyClass::VSSetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers)
+{
+	m_deviceContext->VSSetConstantBuffers(startSlot, count, buffers);
+}
+
+void DeviceContextProxyClass::VSSetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	m_deviceContext->VSSetShaderResources(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::VSSetSamplers(UINT startSlot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	m_deviceContext->VSSetSamplers(startSlot, count, samplers);
+}
+
+void DeviceContextProxyClass::PSSetShader(ID3D11PixelShader* shader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount)
+{
+	m_deviceContext->PSSetShader(shader, classInstances, classInstanceCount);
+}
+
+void DeviceContextProxyClass::PSSetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers)
+{
+	m_deviceContext->PSSetConstantBuffers(startSlot, count, buffers);
+}
+
+void DeviceContextProxyClass::PSSetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	m_deviceContext->PSSetShaderResources(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::PSSetSamplers(UINT startSlot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	m_deviceContext->PSSetSamplers(startSlot, count, samplers);
+}
+
+void DeviceContextProxyClass::OMSetRenderTargets(UINT count, ID3D11RenderTargetView* const* renderTargets, ID3D11DepthStencilView* depthStencilView)
+{
+	m_deviceContext->OMSetRenderTargets(count, renderTargets, depthStencilView);
+}
+
+void DeviceContextProxyClass::OMSetBlendState(ID3D11BlendState* state, const FLOAT blendFactor[4], UINT sampleMask)
+{
+	m_deviceContext->OMSetBlendState(state, blendFactor, sampleMask);
+}
+
+void DeviceContextProxyClass::OMSetDepthStencilState(ID3D11DepthStencilState* state, UINT stencilRef)
+{
+	m_deviceContext->OMSetDepthStencilState(state, stencilRef);
+}
+
+void DeviceContextProxyClass::RSSetState(ID3D11RasterizerState* state)
+{
+	m_deviceContext->RSSetState(state);
+}
+
+void DeviceContextProxyClass::RSSetViewports(UINT count, const D3D11_VIEWPORT* viewports)
+{
+	m_deviceContext->RSSetViewports(count, viewports);
+}
+
+void DeviceContextProxyClass::ClearRenderTargetView(ID3D11RenderTargetView* view, const FLOAT color[4])
+{
+	m_deviceContext->ClearRenderTargetView(view, color);
+}
+
+void DeviceContextProxyClass::ClearDepthStencilView(ID3D11DepthStencilView* view, UINT clearFlags, FLOAT depth, UINT8 stencil)
+{
+	m_deviceContext->ClearDepthStencilView(view, clearFlags, depth, stencil);
+}
+
+HRESULT DeviceContextProxyClass::Map(ID3D11Resource* resource, UINT subresource, D3D11_MAP mapType, UINT mapFlags, D3D11_MAPPED_SUBRESOURCE* mappedResource)
+{
+	return m_deviceContext->Map(resource, subresource, mapType, mapFlags, mappedResource);
+}
+
+void DeviceContextProxyClass::Unmap(ID3D11Resource* resource, UINT subresource)
+{
+	m_deviceContext->Unmap(resource, subresource);
+}
+
+void DeviceContextProxyClass::UpdateSubresource(ID3D11Resource* resource, UINT subresource, const D3D11_BOX* box, const void* data, UINT rowPitch, UINT depthPitch)
+{
+	m_deviceContext->UpdateSubresource(resource, subresource, box, data, rowPitch, depthPitch);
+}
+
+void DeviceContextProxyClass::CopyResource(ID3D11Resource* destination, ID3D11Resource* source)
+{
+	m_deviceContext->CopyResource(destination, source);
+}
+
+void DeviceContextProxyClass::CopySubresourceRegion(ID3D11Resource* destination, UINT destinationSubresource, UINT x, UINT y, UINT z, ID3D11Resource* source, UINT sourceSubresource, const D3D11_BOX* sourceBox)
+{
+	m_deviceContext->CopySubresourceRegion(destination, destinationSubresource, x, y, z, source, sourceSubresource, sourceBox);
+}
+
+void DeviceContextProxyClass::Draw(UINT vertexCount, UINT startVertex)
+{
+	m_deviceContext->Draw(vertexCount, startVertex);
+}
+
+void DeviceContextProxyClass::DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex)
+{
+	m_deviceContext->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void DeviceContextProxyClass::DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance)
+{
+	m_deviceContext->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+}
+
+void DeviceContextProxyClass::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	m_deviceContext->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+void DeviceContextProxyClass::GSSetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers)
+{
+	m_deviceContext->GSSetConstantBuffers(startSlot, count, buffers);
+}
+
+void DeviceContextProxyClass::GSSetShader(ID3D11GeometryShader* shader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount)
+{
+	m_deviceContext->GSSetShader(shader, classInstances, classInstanceCount);
+}
+
+void DeviceContextProxyClass::GSSetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	m_deviceContext->GSSetShaderResources(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::GSSetSamplers(UINT startSlot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	m_deviceContext->GSSetSamplers(startSlot, count, samplers);
+}
+
+void DeviceContextProxyClass::HSSetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	m_deviceContext->HSSetShaderResources(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::HSSetShader(ID3D11HullShader* shader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount)
+{
+	m_deviceContext->HSSetShader(shader, classInstances, classInstanceCount);
+}
+
+void DeviceContextProxyClass::HSSetSamplers(UINT startSlot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	m_deviceContext->HSSetSamplers(startSlot, count, samplers);
+}
+
+void DeviceContextProxyClass::HSSetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers)
+{
+	m_deviceContext->HSSetConstantBuffers(startSlot, count, buffers);
+}
+
+void DeviceContextProxyClass::DSSetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	m_deviceContext->DSSetShaderResources(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::DSSetShader(ID3D11DomainShader* shader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount)
+{
+	m_deviceContext->DSSetShader(shader, classInstances, classInstanceCount);
+}
+
+void DeviceContextProxyClass::DSSetSamplers(UINT startSlot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	m_deviceContext->DSSetSamplers(startSlot, count, samplers);
+}
+
+void DeviceContextProxyClass::DSSetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers)
+{
+	m_deviceContext->DSSetConstantBuffers(startSlot, count, buffers);
+}
+
+void DeviceContextProxyClass::CSSetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	m_deviceContext->CSSetShaderResources(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::CSSetUnorderedAccessViews(UINT startSlot, UINT count, ID3D11UnorderedAccessView* const* views, const UINT* initialCounts)
+{
+	m_deviceContext->CSSetUnorderedAccessViews(startSlot, count, views, initialCounts);
+}
+
+void DeviceContextProxyClass::CSSetShader(ID3D11ComputeShader* shader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount)
+{
+	m_deviceContext->CSSetShader(shader, classInstances, classInstanceCount);
+}
+
+void DeviceContextProxyClass::CSSetSamplers(UINT startSlot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	m_deviceContext->CSSetSamplers(startSlot, count, samplers);
+}
+
+void DeviceContextProxyClass::CSSetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers)
+{
+	m_deviceContext->CSSetConstantBuffers(startSlot, count, buffers);
+}
+
+void DeviceContextProxyClass::SetPredication(ID3D11Predicate* predicate, BOOL value)
+{
+	m_deviceContext->SetPredication(predicate, value);
+}
+
+void DeviceContextProxyClass::OMSetRenderTargetsAndUnorderedAccessViews(UINT renderTargetCount, ID3D11RenderTargetView* const* renderTargets, ID3D11DepthStencilView* depthStencilView, UINT startSlot, UINT viewCount, ID3D11UnorderedAccessView* const* views, const UINT* initialCounts)
+{
+	m_deviceContext->OMSetRenderTargetsAndUnorderedAccessViews(renderTargetCount, renderTargets, depthStencilView, startSlot, viewCount, views, initialCounts);
+}
+
+void DeviceContextProxyClass::SOSetTargets(UINT count, ID3D11Buffer* const* buffers, const UINT* offsets)
+{
+	m_deviceContext->SOSetTargets(count, buffers, offsets);
+}
+
+void DeviceContextProxyClass::DrawAuto()
+{
+	m_deviceContext->DrawAuto();
+}
+
+void DeviceContextProxyClass::DrawIndexedInstancedIndirect(ID3D11Buffer* arguments, UINT offset)
+{
+	m_deviceContext->DrawIndexedInstancedIndirect(arguments, offset);
+}
+
+void DeviceContextProxyClass::DrawInstancedIndirect(ID3D11Buffer* arguments, UINT offset)
+{
+	m_deviceContext->DrawInstancedIndirect(arguments, offset);
+}
+
+void DeviceContextProxyClass::Dispatch(UINT x, UINT y, UINT z)
+{
+	m_deviceContext->Dispatch(x, y, z);
+}
+
+void DeviceContextProxyClass::DispatchIndirect(ID3D11Buffer* arguments, UINT offset)
+{
+	m_deviceContext->DispatchIndirect(arguments, offset);
+}
+
+void DeviceContextProxyClass::RSSetScissorRects(UINT count, const D3D11_RECT* rects)
+{
+	m_deviceContext->RSSetScissorRects(count, rects);
+}
+
+void DeviceContextProxyClass::CopyStructureCount(ID3D11Buffer* destination, UINT offset, ID3D11UnorderedAccessView* view)
+{
+	m_deviceContext->CopyStructureCount(destination, offset, view);
+}
+
+void DeviceContextProxyClass::ClearUnorderedAccessViewUint(ID3D11UnorderedAccessView* view, const UINT values[4])
+{
+	m_deviceContext->ClearUnorderedAccessViewUint(view, values);
+}
+
+void DeviceContextProxyClass::ClearUnorderedAccessViewFloat(ID3D11UnorderedAccessView* view, const FLOAT values[4])
+{
+	m_deviceContext->ClearUnorderedAccessViewFloat(view, values);
+}
+
+void DeviceContextProxyClass::GenerateMips(ID3D11ShaderResourceView* view)
+{
+	m_deviceContext->GenerateMips(view);
+}
+
+void DeviceContextProxyClass::SetResourceMinLOD(ID3D11Resource* resource, FLOAT minLOD)
+{
+	m_deviceContext->SetResourceMinLOD(resource, minLOD);
+}
+
+void DeviceContextProxyClass::ResolveSubresource(ID3D11Resource* destination, UINT destinationSubresource, ID3D11Resource* source, UINT sourceSubresource, DXGI_FORMAT format)
+{
+	m_deviceContext->ResolveSubresource(destination, destinationSubresource, source, sourceSubresource, format);
+}
+
+void DeviceContextProxyClass::ExecuteCommandList(ID3D11CommandList* commandList, BOOL restoreState)
+{
+	m_deviceContext->ExecuteCommandList(commandList, restoreState);
+}
+
+void DeviceContextProxyClass::ClearState()
+{
+	m_deviceContext->ClearState();
+}
+
+void DeviceContextProxyClass::Begin(ID3D11Asynchronous* async)
+{
+	m_deviceContext->Begin(async);
+}
+
+void DeviceContextProxyClass::End(ID3D11Asynchronous* async)
+{
+	m_deviceContext->End(async);
+}
+
+HRESULT DeviceContextProxyClass::GetData(ID3D11Asynchronous* async, void* data, UINT dataSize, UINT flags)
+{
+	return m_deviceContext->GetData(async, data, dataSize, flags);
+}
+
+FLOAT DeviceContextProxyClass::GetResourceMinLOD(ID3D11Resource* resource)
+{
+	return m_deviceContext->GetResourceMinLOD(resource);
+}
+
+void DeviceContextProxyClass::VSGetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer** buffers)
+{
+	m_deviceContext->VSGetConstantBuffers(startSlot, count, buffers);
+}
+
+void DeviceContextProxyClass::PSGetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView** views)
+{
+	m_deviceContext->PSGetShaderResources(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::PSGetShader(ID3D11PixelShader** shader, ID3D11ClassInstance** classInstances, UINT* classInstanceCount)
+{
+	m_deviceContext->PSGetShader(shader, classInstances, classInstanceCount);
+}
+
+void DeviceContextProxyClass::PSGetSamplers(UINT startSlot, UINT count, ID3D11SamplerState** samplers)
+{
+	m_deviceContext->PSGetSamplers(startSlot, count, samplers);
+}
+
+void DeviceContextProxyClass::VSGetShader(ID3D11VertexShader** shader, ID3D11ClassInstance** classInstances, UINT* classInstanceCount)
+{
+	m_deviceContext->VSGetShader(shader, classInstances, classInstanceCount);
+}
+
+void DeviceContextProxyClass::PSGetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer** buffers)
+{
+	m_deviceContext->PSGetConstantBuffers(startSlot, count, buffers);
+}
+
+void DeviceContextProxyClass::IAGetInputLayout(ID3D11InputLayout** layout)
+{
+	m_deviceContext->IAGetInputLayout(layout);
+}
+
+void DeviceContextProxyClass::IAGetVertexBuffers(UINT startSlot, UINT count, ID3D11Buffer** buffers, UINT* strides, UINT* offsets)
+{
+	m_deviceContext->IAGetVertexBuffers(startSlot, count, buffers, strides, offsets);
+}
+
+void DeviceContextProxyClass::IAGetIndexBuffer(ID3D11Buffer** buffer, DXGI_FORMAT* format, UINT* offset)
+{
+	m_deviceContext->IAGetIndexBuffer(buffer, format, offset);
+}
+
+void DeviceContextProxyClass::GSGetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer** buffers)
+{
+	m_deviceContext->GSGetConstantBuffers(startSlot, count, buffers);
+}
+
+void DeviceContextProxyClass::GSGetShader(ID3D11GeometryShader** shader, ID3D11ClassInstance** classInstances, UINT* classInstanceCount)
+{
+	m_deviceContext->GSGetShader(shader, classInstances, classInstanceCount);
+}
+
+void DeviceContextProxyClass::IAGetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY* topology)
+{
+	m_deviceContext->IAGetPrimitiveTopology(topology);
+}
+
+void DeviceContextProxyClass::VSGetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView** views)
+{
+	m_deviceContext->VSGetShaderResources(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::VSGetSamplers(UINT startSlot, UINT count, ID3D11SamplerState** samplers)
+{
+	m_deviceContext->VSGetSamplers(startSlot, count, samplers);
+}
+
+void DeviceContextProxyClass::GetPredication(ID3D11Predicate** predicate, BOOL* value)
+{
+	m_deviceContext->GetPredication(predicate, value);
+}
+
+void DeviceContextProxyClass::GSGetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView** views)
+{
+	m_deviceContext->GSGetShaderResources(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::GSGetSamplers(UINT startSlot, UINT count, ID3D11SamplerState** samplers)
+{
+	m_deviceContext->GSGetSamplers(startSlot, count, samplers);
+}
+
+void DeviceContextProxyClass::OMGetRenderTargets(UINT count, ID3D11RenderTargetView** renderTargets, ID3D11DepthStencilView** depthStencilView)
+{
+	m_deviceContext->OMGetRenderTargets(count, renderTargets, depthStencilView);
+}
+
+void DeviceContextProxyClass::OMGetRenderTargetsAndUnorderedAccessViews(UINT renderTargetCount, ID3D11RenderTargetView** renderTargets, ID3D11DepthStencilView** depthStencilView, UINT startSlot, UINT viewCount, ID3D11UnorderedAccessView** views)
+{
+	m_deviceContext->OMGetRenderTargetsAndUnorderedAccessViews(renderTargetCount, renderTargets, depthStencilView, startSlot, viewCount, views);
+}
+
+void DeviceContextProxyClass::OMGetBlendState(ID3D11BlendState** state, FLOAT blendFactor[4], UINT* sampleMask)
+{
+	m_deviceContext->OMGetBlendState(state, blendFactor, sampleMask);
+}
+
+void DeviceContextProxyClass::OMGetDepthStencilState(ID3D11DepthStencilState** state, UINT* stencilRef)
+{
+	m_deviceContext->OMGetDepthStencilState(state, stencilRef);
+}
+
+void DeviceContextProxyClass::SOGetTargets(UINT count, ID3D11Buffer** buffers)
+{
+	m_deviceContext->SOGetTargets(count, buffers);
+}
+
+void DeviceContextProxyClass::RSGetState(ID3D11RasterizerState** state)
+{
+	m_deviceContext->RSGetState(state);
+}
+
+void DeviceContextProxyClass::RSGetViewports(UINT* count, D3D11_VIEWPORT* viewports)
+{
+	m_deviceContext->RSGetViewports(count, viewports);
+}
+
+void DeviceContextProxyClass::RSGetScissorRects(UINT* count, D3D11_RECT* rects)
+{
+	m_deviceContext->RSGetScissorRects(count, rects);
+}
+
+void DeviceContextProxyClass::HSGetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView** views)
+{
+	m_deviceContext->HSGetShaderResources(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::HSGetShader(ID3D11HullShader** shader, ID3D11ClassInstance** classInstances, UINT* classInstanceCount)
+{
+	m_deviceContext->HSGetShader(shader, classInstances, classInstanceCount);
+}
+
+void DeviceContextProxyClass::HSGetSamplers(UINT startSlot, UINT count, ID3D11SamplerState** samplers)
+{
+	m_deviceContext->HSGetSamplers(startSlot, count, samplers);
+}
+
+void DeviceContextProxyClass::HSGetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer** buffers)
+{
+	m_deviceContext->HSGetConstantBuffers(startSlot, count, buffers);
+}
+
+void DeviceContextProxyClass::DSGetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView** views)
+{
+	m_deviceContext->DSGetShaderResources(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::DSGetShader(ID3D11DomainShader** shader, ID3D11ClassInstance** classInstances, UINT* classInstanceCount)
+{
+	m_deviceContext->DSGetShader(shader, classInstances, classInstanceCount);
+}
+
+void DeviceContextProxyClass::DSGetSamplers(UINT startSlot, UINT count, ID3D11SamplerState** samplers)
+{
+	m_deviceContext->DSGetSamplers(startSlot, count, samplers);
+}
+
+void DeviceContextProxyClass::DSGetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer** buffers)
+{
+	m_deviceContext->DSGetConstantBuffers(startSlot, count, buffers);
+}
+
+void DeviceContextProxyClass::CSGetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView** views)
+{
+	m_deviceContext->CSGetShaderResources(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::CSGetUnorderedAccessViews(UINT startSlot, UINT count, ID3D11UnorderedAccessView** views)
+{
+	m_deviceContext->CSGetUnorderedAccessViews(startSlot, count, views);
+}
+
+void DeviceContextProxyClass::CSGetShader(ID3D11ComputeShader** shader, ID3D11ClassInstance** classInstances, UINT* classInstanceCount)
+{
+	m_deviceContext->CSGetShader(shader, classInstances, classInstanceCount);
+}
+
+void DeviceContextProxyClass::CSGetSamplers(UINT startSlot, UINT count, ID3D11SamplerState** samplers)
+{
+	m_deviceContext->CSGetSamplers(startSlot, count, samplers);
+}
+
+void DeviceContextProxyClass::CSGetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer** buffers)
+{
+	m_deviceContext->CSGetConstantBuffers(startSlot, count, buffers);
+}
+
+void DeviceContextProxyClass::Flush()
+{
+	m_deviceContext->Flush();
+}
+
+D3D11_DEVICE_CONTEXT_TYPE DeviceContextProxyClass::GetType()
+{
+	return m_deviceContext->GetType();
+}
+
+UINT DeviceContextProxyClass::GetContextFlags()
+{
+	return m_deviceContext->GetContextFlags();
+}
+
+HRESULT DeviceContextProxyClass::FinishCommandList(BOOL restoreState, ID3D11CommandList** commandList)
+{
+	return m_deviceContext->FinishCommandList(restoreState, commandList);
+}
@@ -0,0 +1,423 @@
+#include "../Headers/dynamicresolutionclass.h"
+
+DynamicResolutionClass::DynamicResolutionClass()
+{
+	int i;
+
+	m_screenWidth = 0;
+	m_screenHeight = 0;
+	m_width = 0;
+	m_height = 0;
+	m_maximumScale = 1.0f;
+	m_gpuTime = 0.0f;
+	m_RenderTexture = 0;
+	m_Controller = 0;
+	m_ResourceRegistry = 0;
+	m_upscaleBuffer.id = 0;
+	m_sampleState.id = 0;
+	m_ShaderManager = 0;
+	m_shaderFamily = -1;
+	for (i = 0; i < DYNAMIC_RESOLUTION_QUERY_FRAMES; i++)
+	{
+		m_queries[i].disjoint = 0;
+		m_queries[i].begin = 0;
+		m_queries[i].end = 0;
+		m_queries[i].issued = false;
+	}
+	m_queryWrite = 0;
+	m_queryRead = 0;
+	m_timing = false;
+}
+
+DynamicResolutionClass::DynamicResolutionClass(const DynamicResolutionClass& other)
+{
+
+}
+
+DynamicResolutionClass::~DynamicResolutionClass()
+{
+
+}
+
+//	Precompile compiles the upscale shaders ahead of Initialize, the same way the color shader does.
+void DynamicResolutionClass::Precompile(ShaderManagerClass* shaderManager)
+{
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+
+	if (wcscpy_s(vsFilename, 128, L"./Source/upscale.vs") != 0 || wcscpy_s(psFilename, 128, L"./Source/upscale.ps") != 0)
+	{
+		return;
+	}
+
+	shaderManager->Precompile(vsFilename, "UpscaleVertexShader", psFilename, "UpscalePixelShader", 0);
+
+	return;
+}
+
+bool DynamicResolutionClass::Initialize(ID3D11Device* device, ResourceRegistryClass* resourceRegistry, ShaderManagerClass* shaderManager,
+	int screenWidth, int screenHeight, float screenDepth, float screenNear, float targetTime, float minimumScale, float maximumScale)
+{
+	D3D11_SAMPLER_DESC samplerDesc;
+	D3D11_BUFFER_DESC bufferDesc;
+	ID3D11SamplerState* sampleState;
+	ID3D11Buffer* buffer;
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+	HRESULT result;
+	int error;
+
+	m_screenWidth = screenWidth;
+	m_screenHeight = screenHeight;
+	m_maximumScale = maximumScale;
+	m_ResourceRegistry = resourceRegistry;
+	m_ShaderManager = shaderManager;
+
+//	The render target is as large as the scene gets, which is more than the screen when the largest scale
+//	is above one:
+	m_RenderTexture = new RenderTextureClass;
+
+	if (!m_RenderTexture->Initialize(device, (int)(screenWidth * maximumScale + 0.5f), (int)(screenHeight * maximumScale + 0.5f), screenDepth, screenNear,
+		DXGI_FORMAT_R8G8B8A8_UNORM))
+	{
+		return false;
+	}
+
+	m_Controller = new ResolutionControllerClass;
+	m_Controller->Initialize(targetTime, minimumScale, maximumScale);
+
+	m_width = (int)(screenWidth * m_Controller->GetScale() + 0.5f);
+	m_height = (int)(screenHeight * m_Controller->GetScale() + 0.5f);
+
+//	Set the filenames of the Vertex and Pixel Shader:
+	error = wcscpy_s(vsFilename, 128, L"./Source/upscale.vs");
+	if (error != 0)
+	{
+		return false;
+	}
+
+	error = wcscpy_s(psFilename, 128, L"./Source/upscale.ps");
+	if (error != 0)
+	{
+		return false;
+	}
+
+	if (!InitializeShader(vsFilename, psFilename))
+	{
+		return false;
+	}
+
+//	The scene is filtered as it is stretched, and the texture coordinates are kept inside its part of the
+//	texture by the shader:
+	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.MipLODBias = 0.0f;
+	samplerDesc.MaxAnisotropy = 1;
+	samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+	samplerDesc.BorderColor[0] = 0.0f;
+	samplerDesc.BorderColor[1] = 0.0f;
+	samplerDesc.BorderColor[2] = 0.0f;
+	samplerDesc.BorderColor[3] = 0.0f;
+	samplerDesc.MinLOD = 0.0f;
+	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+
+	result = device->CreateSamplerState(&samplerDesc, &sampleState);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_sampleState = m_ResourceRegistry->Register(sampleState);
+
+//	Setup the description of the Dynamic Constant Buffer of the upscale:
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = sizeof(UpscaleBufferType);
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_upscaleBuffer = m_ResourceRegistry->Register(buffer);
+
+	return InitializeQueries(device);
+}
+
+void DynamicResolutionClass::Shutdown()
+{
+	int i;
+
+	for (i = 0; i < DYNAMIC_RESOLUTION_QUERY_FRAMES; i++)
+	{
+		if (m_queries[i].disjoint)
+		{
+			m_queries[i].disjoint->Release();
+			m_queries[i].disjoint = 0;
+		}
+
+		if (m_queries[i].begin)
+		{
+			m_queries[i].begin->Release();
+			m_queries[i].begin = 0;
+		}
+
+		if (m_queries[i].end)
+		{
+			m_queries[i].end->Release();
+			m_queries[i].end = 0;
+		}
+
+		m_queries[i].issued = false;
+	}
+
+	if (m_ResourceRegistry)
+	{
+		m_ResourceRegistry->Release(m_upscaleBuffer);
+		m_ResourceRegistry->Release(m_sampleState);
+		m_ResourceRegistry = 0;
+	}
+
+//	The Shaders belong to the Shader Manager which releases them on its own Shutdown.
+	m_shaderFamily = -1;
+	m_ShaderManager = 0;
+
+	if (m_Controller)
+	{
+		delete m_Controller;
+		m_Controller = 0;
+	}
+
+	if (m_RenderTexture)
+	{
+		m_RenderTexture->Shutdown();
+		delete m_RenderTexture;
+		m_RenderTexture = 0;
+	}
+
+	return;
+}
+
+//	BeginFrame starts timing the frame on the GPU. When the timings of all the frames in flight are still
+//	waiting to be read back, this frame goes untimed.
+void DynamicResolutionClass::BeginFrame(ID3D11DeviceContext* deviceContext)
+{
+	TimerQueryType* query;
+
+	query = &m_queries[m_queryWrite];
+
+	m_timing = !query->issued;
+	if (m_timing)
+	{
+		deviceContext->Begin(query->disjoint);
+		deviceContext->End(query->begin);
+	}
+
+	return;
+}
+
+//	BeginScene points rendering at the render target, through a viewport of the current scale, and clears it.
+void DynamicResolutionClass::BeginScene(ID3D11DeviceContext* deviceContext, float red, float green, float blue, float alpha)
+{
+	m_RenderTexture->SetViewportSize(m_width, m_height);
+	m_RenderTexture->SetRenderTarget(deviceContext);
+	m_RenderTexture->ClearRenderTarget(deviceContext, red, green, blue, alpha);
+
+	return;
+}
+
+//	Upscale draws the scene over whatever render target and viewport are set, which should be the back
+//	buffer and the screen. The texture is taken off the pixel shader again afterwards, so it can be drawn
+//	into in the next frame.
+bool DynamicResolutionClass::Upscale(ID3D11DeviceContext* deviceContext)
+{
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	UpscaleBufferType* dataPtr;
+	ID3D11Buffer* upscaleBuffer;
+	ID3D11SamplerState* sampleState;
+	ID3D11ShaderResourceView* shaderResourceView;
+	ID3D11ShaderResourceView* nullView;
+	float textureWidth, textureHeight;
+	HRESULT result;
+
+	upscaleBuffer = m_ResourceRegistry->Get(m_upscaleBuffer);
+	sampleState = m_ResourceRegistry->Get(m_sampleState);
+	shaderResourceView = m_RenderTexture->GetShaderResourceView();
+	nullView = 0;
+
+	textureWidth = (float)m_RenderTexture->GetTextureWidth();
+	textureHeight = (float)m_RenderTexture->GetTextureHeight();
+
+	result = deviceContext->Map(upscaleBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+//	The limit is half a texel inside the last row and column the scene was drawn into:
+	dataPtr = (UpscaleBufferType*)mappedResource.pData;
+	dataPtr->texScale = XMFLOAT2((float)m_width / textureWidth, (float)m_height / textureHeight);
+	dataPtr->texLimit = XMFLOAT2(((float)m_width - 0.5f) / textureWidth, ((float)m_height - 0.5f) / textureHeight);
+
+	deviceContext->Unmap(upscaleBuffer, 0);
+
+	if (!m_ShaderManager->SetShader(deviceContext, m_shaderFamily, 0))
+	{
+		return false;
+	}
+
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	deviceContext->PSSetConstantBuffers(2, 1, &upscaleBuffer);
+	deviceContext->PSSetShaderResources(0, 1, &shaderResourceView);
+	deviceContext->PSSetSamplers(0, 1, &sampleState);
+
+	deviceContext->Draw(3, 0);
+
+	deviceContext->PSSetShaderResources(0, 1, &nullView);
+
+	return true;
+}
+
+//	EndFrame ends the timing of the frame, hands the timings that have come back to the controller and sizes
+//	the viewport of the next frame by the scale it picks.
+void DynamicResolutionClass::EndFrame(ID3D11DeviceContext* deviceContext)
+{
+	TimerQueryType* query;
+	float scale;
+
+	if (m_timing)
+	{
+		query = &m_queries[m_queryWrite];
+
+		deviceContext->End(query->end);
+		deviceContext->End(query->disjoint);
+		query->issued = true;
+
+		m_queryWrite = (m_queryWrite + 1) % DYNAMIC_RESOLUTION_QUERY_FRAMES;
+		m_timing = false;
+	}
+
+	ReadQueries(deviceContext);
+
+	scale = m_Controller->GetScale();
+
+	m_width = (int)(m_screenWidth * scale + 0.5f);
+	m_width = m_width > 1 ? m_width : 1;
+	m_height = (int)(m_screenHeight * scale + 0.5f);
+	m_height = m_height > 1 ? m_height : 1;
+
+	return;
+}
+
+float DynamicResolutionClass::GetScale()
+{
+	return m_Controller->GetScale();
+}
+
+//	The size in pixels the scene is drawn at in the frame being drawn.
+int DynamicResolutionClass::GetWidth()
+{
+	return m_width;
+}
+
+int DynamicResolutionClass::GetHeight()
+{
+	return m_height;
+}
+
+//	The GPU time in milliseconds of the last frame whose timing has come back.
+float DynamicResolutionClass::GetGPUTime()
+{
+	return m_gpuTime;
+}
+
+int DynamicResolutionClass::GetChangeCount()
+{
+	return m_Controller->GetChangeCount();
+}
+
+bool DynamicResolutionClass::InitializeShader(WCHAR* vsFilename, WCHAR* psFilename)
+{
+//	The full screen triangle is made in the vertex shader, so there are no vertex formats to feed it from:
+	m_shaderFamily = m_ShaderManager->AddShader(vsFilename, "UpscaleVertexShader", psFilename, "UpscalePixelShader", 0, NULL, 0, NULL);
+	if (m_shaderFamily < 0)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+bool DynamicResolutionClass::InitializeQueries(ID3D11Device* device)
+{
+	D3D11_QUERY_DESC queryDesc;
+	HRESULT result;
+	int i;
+
+	queryDesc.MiscFlags = 0;
+
+	for (i = 0; i < DYNAMIC_RESOLUTION_QUERY_FRAMES; i++)
+	{
+		queryDesc.Query = D3D11_QUERY_TIMESTAMP_DISJOINT;
+
+		result = device->CreateQuery(&queryDesc, &m_queries[i].disjoint);
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		queryDesc.Query = D3D11_QUERY_TIMESTAMP;
+
+		result = device->CreateQuery(&queryDesc, &m_queries[i].begin);
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		result = device->CreateQuery(&queryDesc, &m_queries[i].end);
+		if (FAILED(result))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//	ReadQueries reads back the timings of the frames the GPU has finished, oldest first, without waiting
+//	for the ones it hasn't. Frames the clock was disjoint in are dropped.
+void DynamicResolutionClass::ReadQueries(ID3D11DeviceContext* deviceContext)
+{
+	D3D11_QUERY_DATA_TIMESTAMP_DISJOINT disjoint;
+	TimerQueryType* query;
+	UINT64 begin, end;
+
+	while (m_queries[m_queryRead].issued)
+	{
+		query = &m_queries[m_queryRead];
+
+		if (deviceContext->GetData(query->disjoint, &disjoint, sizeof(disjoint), D3D11_ASYNC_GETDATA_DONOTFLUSH) != S_OK)
+		{
+			break;
+		}
+
+		if (!disjoint.Disjoint && disjoint.Frequency != 0 &&
+			deviceContext->GetData(query->begin, &begin, sizeof(UINT64), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK &&
+			deviceContext->GetData(query->end, &end, sizeof(UINT64), D3D11_ASYNC_GETDATA_DONOTFLUSH) == S_OK)
+		{
+			m_gpuTime = (float)((double)(end - begin) * 1000.0 / (double)disjoint.Frequency);
+			m_Controller->Update(m_gpuTime);
+		}
+
+		query->issued = false;
+		m_queryRead = (m_queryRead + 1) % DYNAMIC_RESOLUTION_QUERY_FRAMES;
+	}
+
+	return;
+}
@@ -0,0 +1,141 @@
+//	The entity benchmark creates entities as meshes scattered through a cube in an Entity World, with the
+//	components and systems of the scene, and runs the systems over them on this thread and on the job
+//	threads. Then it runs the same two passes over an array of structs that hold the three components side
+//	by side, and prints the fastest of a few runs of each. Nothing in it needs Direct3D. It is not part of the
+//	engine's project and is built on its own, with the DirectXMath headers on the include path, for example
+//	with:
+//	g++ -O2 -o entitybenchmark Source/entitybenchmarkmain.cpp Source/entityworldclass.cpp
+//	    Source/scenesystemsclass.cpp Source/jobsystemclass.cpp -lpthread
+//	and run as: entitybenchmark [entities]
+#include "../Headers/scenesystemsclass.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+static const int BENCHMARK_PASSES = 5;
+
+int main(int argc, char* argv[])
+{
+	struct EntityStructType
+	{
+		TransformType transform;
+		RenderableType renderable;
+		EntityBoundsType bounds;
+	};
+
+	JobSystemClass jobSystem;
+	EntityWorldClass world;
+	SceneSystemsClass systems;
+	vector<EntityStructType> structs;
+	TransformType* transform;
+	RenderableType* renderable;
+	EntityBoundsType* bounds;
+	chrono::high_resolution_clock::time_point startTime;
+	float time, createTime, serialTime, parallelTime, structTime;
+	unsigned int seed, entity;
+	int entityCount, i, pass, archetypeCount, chunkCount;
+
+	entityCount = argc > 1 ? atoi(argv[1]) : 1000000;
+	if (entityCount <= 0)
+	{
+		fprintf(stderr, "usage: %s [entities]\n", argv[0]);
+		return 1;
+	}
+
+	jobSystem.Initialize(0);
+
+	seed = 11;
+	auto random = [&seed]()
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (float)(seed >> 8) / 16777216.0f;
+	};
+
+//	Every entity is a mesh, so the bounds system never asks for the box of a character:
+	world.Initialize();
+	systems.Initialize(&world, [](int, XMFLOAT3& minimum, XMFLOAT3& maximum)
+	{
+		minimum = XMFLOAT3(-1.0f, -1.0f, -1.0f);
+		maximum = XMFLOAT3(1.0f, 1.0f, 1.0f);
+	});
+
+	startTime = chrono::high_resolution_clock::now();
+	for (i = 0; i < entityCount; i++)
+	{
+		entity = world.CreateEntity(systems.GetMask());
+
+		transform = (TransformType*)world.GetComponent(entity, systems.GetTransformComponent());
+		transform->position = XMFLOAT3(1000.0f * random(), 1000.0f * random(), 1000.0f * random());
+		transform->scale = 0.5f + random();
+
+		renderable = (RenderableType*)world.GetComponent(entity, systems.GetRenderableComponent());
+		renderable->kind = RENDERABLE_MESH;
+		renderable->index = i;
+		renderable->object = i;
+
+		bounds = (EntityBoundsType*)world.GetComponent(entity, systems.GetBoundsComponent());
+		bounds->localMinimum = XMFLOAT3(-1.0f, -1.0f, -1.0f);
+		bounds->localMaximum = XMFLOAT3(1.0f, 1.0f, 1.0f);
+	}
+	createTime = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+
+	serialTime = 1.0e9f;
+	parallelTime = 1.0e9f;
+	for (pass = 0; pass < BENCHMARK_PASSES; pass++)
+	{
+		startTime = chrono::high_resolution_clock::now();
+		world.RunSystems(NULL);
+		time = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+		serialTime = (time < serialTime) ? time : serialTime;
+
+		startTime = chrono::high_resolution_clock::now();
+		world.RunSystems(&jobSystem);
+		time = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+		parallelTime = (time < parallelTime) ? time : parallelTime;
+	}
+
+	archetypeCount = world.GetArchetypeCount();
+	chunkCount = world.GetChunkCount();
+
+	world.Shutdown();
+
+//	The same entities again as structs, built the same way so the numbers match:
+	seed = 11;
+	structs.resize(entityCount);
+	for (i = 0; i < entityCount; i++)
+	{
+		structs[i] = EntityStructType();
+		structs[i].transform.position = XMFLOAT3(1000.0f * random(), 1000.0f * random(), 1000.0f * random());
+		structs[i].transform.scale = 0.5f + random();
+		structs[i].renderable.kind = RENDERABLE_MESH;
+		structs[i].renderable.index = i;
+		structs[i].renderable.object = i;
+		structs[i].bounds.localMinimum = XMFLOAT3(-1.0f, -1.0f, -1.0f);
+		structs[i].bounds.localMaximum = XMFLOAT3(1.0f, 1.0f, 1.0f);
+	}
+
+	structTime = 1.0e9f;
+	for (pass = 0; pass < BENCHMARK_PASSES; pass++)
+	{
+		startTime = chrono::high_resolution_clock::now();
+		for (i = 0; i < entityCount; i++)
+		{
+			SceneSystemsClass::UpdateWorldMatrix(structs[i].transform);
+		}
+
+		for (i = 0; i < entityCount; i++)
+		{
+			systems.UpdateBounds(structs[i].transform, structs[i].renderable, structs[i].bounds);
+		}
+		time = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+		structTime = (time < structTime) ? time : structTime;
+	}
+
+	printf("%d entities in %d archetypes, %d chunks: create %.2f ms; systems %.3f ms on one thread, %.3f ms on %d threads; array of structs %.3f ms\n",
+		entityCount, archetypeCount, chunkCount, createTime, serialTime, parallelTime, jobSystem.GetThreadCount(), structTime);
+
+	jobSystem.Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,537 @@
+#include "../Headers/entityworldclass.h"
+
+#if defined(_MSC_VER)
+#include <malloc.h>
+#endif
+#include <stdlib.h>
+#include <string.h>
+
+//	The chunks are aligned for the vector loads of the systems. MSVC has calls of its own for aligned memory,
+//	which has to be freed with the matching call.
+static unsigned char* AllocateAligned(size_t size, size_t alignment)
+{
+#if defined(_MSC_VER)
+	return (unsigned char*)_aligned_malloc(size, alignment);
+#else
+	void* memory;
+
+	if (posix_memalign(&memory, alignment, size) != 0)
+	{
+		return 0;
+	}
+
+	return (unsigned char*)memory;
+#endif
+}
+
+static void FreeAligned(void* memory)
+{
+#if defined(_MSC_VER)
+	_aligned_free(memory);
+#else
+	free(memory);
+#endif
+}
+
+EntityWorldClass::EntityWorldClass()
+{
+	m_entityCount = 0;
+	m_phaseCount = 0;
+}
+
+EntityWorldClass::EntityWorldClass(const EntityWorldClass& other)
+{
+
+}
+
+EntityWorldClass::~EntityWorldClass()
+{
+
+}
+
+bool EntityWorldClass::Initialize()
+{
+	m_entityCount = 0;
+	m_phaseCount = 0;
+
+	return true;
+}
+
+void EntityWorldClass::Shutdown()
+{
+	unsigned int i, j;
+
+	for (i = 0; i < m_archetypes.size(); i++)
+	{
+		for (j = 0; j < m_archetypes[i].chunks.size(); j++)
+		{
+			FreeAligned(m_archetypes[i].chunks[j].data);
+		}
+	}
+
+	m_archetypes.clear();
+	m_entities.clear();
+	m_freeEntities.clear();
+	m_componentSizes.clear();
+	m_systems.clear();
+	m_work.clear();
+	m_entityCount = 0;
+	m_phaseCount = 0;
+
+	return;
+}
+
+int EntityWorldClass::RegisterComponent(unsigned int size)
+{
+	if (m_componentSizes.size() >= ENTITY_MAX_COMPONENT_TYPES)
+	{
+		return -1;
+	}
+
+	m_componentSizes.push_back(size);
+
+	return (int)m_componentSizes.size() - 1;
+}
+
+//	CreateEntity reuses the index of a destroyed entity if there is one. The generation of the index was
+//	bumped when it was destroyed, so the old id doesn't name the new entity.
+unsigned int EntityWorldClass::CreateEntity(unsigned int componentMask)
+{
+	EntityType entity;
+	unsigned int index, id;
+	int archetype;
+
+	if (!m_freeEntities.empty())
+	{
+		index = m_freeEntities.back();
+		m_freeEntities.pop_back();
+	}
+	else
+	{
+		index = (unsigned int)m_entities.size();
+		if (index > ENTITY_INDEX_MASK)
+		{
+			return 0;
+		}
+
+		entity.archetype = -1;
+		entity.chunk = 0;
+		entity.row = 0;
+		entity.generation = 1;
+		m_entities.push_back(entity);
+	}
+
+	archetype = FindArchetype(componentMask);
+	id = (m_entities[index].generation << ENTITY_INDEX_BITS) | index;
+
+	PlaceEntity(id, archetype);
+	m_entityCount++;
+
+	return id;
+}
+
+void EntityWorldClass::DestroyEntity(unsigned int id)
+{
+	EntityType* entity;
+
+	if (!IsAlive(id))
+	{
+		return;
+	}
+
+	entity = &m_entities[id & ENTITY_INDEX_MASK];
+	RemoveFromChunk(entity->archetype, entity->chunk, entity->row);
+
+	entity->archetype = -1;
+	entity->generation = (entity->generation + 1) & ENTITY_GENERATION_MASK;
+	if (entity->generation == 0)
+	{
+		entity->generation = 1;
+	}
+
+	m_freeEntities.push_back(id & ENTITY_INDEX_MASK);
+	m_entityCount--;
+
+	return;
+}
+
+bool EntityWorldClass::IsAlive(unsigned int id)
+{
+	unsigned int index;
+
+	index = id & ENTITY_INDEX_MASK;
+
+	return index < m_entities.size() && m_entities[index].archetype != -1 && m_entities[index].generation == (id >> ENTITY_INDEX_BITS);
+}
+
+void EntityWorldClass::AddComponents(unsigned int id, unsigned int componentMask)
+{
+	if (!IsAlive(id))
+	{
+		return;
+	}
+
+	MoveEntity(id, m_archetypes[m_entities[id & ENTITY_INDEX_MASK].archetype].mask | componentMask);
+
+	return;
+}
+
+void EntityWorldClass::RemoveComponents(unsigned int id, unsigned int componentMask)
+{
+	if (!IsAlive(id))
+	{
+		return;
+	}
+
+	MoveEntity(id, m_archetypes[m_entities[id & ENTITY_INDEX_MASK].archetype].mask & ~componentMask);
+
+	return;
+}
+
+void* EntityWorldClass::GetComponent(unsigned int id, int type)
+{
+	EntityType* entity;
+	ArchetypeType* archetype;
+
+	if (!IsAlive(id) || type < 0 || type >= (int)m_componentSizes.size())
+	{
+		return 0;
+	}
+
+	entity = &m_entities[id & ENTITY_INDEX_MASK];
+	archetype = &m_archetypes[entity->archetype];
+	if ((archetype->mask & (1u << type)) == 0)
+	{
+		return 0;
+	}
+
+	return archetype->chunks[entity->chunk].data + archetype->offsets[type] + (size_t)entity->row * m_componentSizes[type];
+}
+
+//	ForEachChunk calls the function on this thread for every chunk of every archetype that has all the
+//	component types of the mask.
+void EntityWorldClass::ForEachChunk(unsigned int componentMask, const SystemFunctionType& function)
+{
+	ChunkViewType view;
+	int i, j;
+
+	for (i = 0; i < (int)m_archetypes.size(); i++)
+	{
+		if ((m_archetypes[i].mask & componentMask) != componentMask)
+		{
+			continue;
+		}
+
+		for (j = 0; j < (int)m_archetypes[i].chunks.size(); j++)
+		{
+			GetChunkView(i, j, view);
+			function(view);
+		}
+	}
+
+	return;
+}
+
+//	AddSystem puts the system in the phase after the last of the earlier systems it conflicts with, so the
+//	systems that touch the same components still run in the order they were added.
+int EntityWorldClass::AddSystem(unsigned int readMask, unsigned int writeMask, const SystemFunctionType& function)
+{
+	SystemType system;
+	int i;
+
+	system.readMask = readMask;
+	system.writeMask = writeMask;
+	system.phase = 0;
+	system.function = function;
+
+	for (i = 0; i < (int)m_systems.size(); i++)
+	{
+		if ((system.writeMask & (m_systems[i].readMask | m_systems[i].writeMask)) != 0 || (m_systems[i].writeMask & system.readMask) != 0)
+		{
+			system.phase = (m_systems[i].phase + 1 > system.phase) ? m_systems[i].phase + 1 : system.phase;
+		}
+	}
+
+	m_systems.push_back(system);
+	m_phaseCount = (system.phase + 1 > m_phaseCount) ? system.phase + 1 : m_phaseCount;
+
+	return (int)m_systems.size() - 1;
+}
+
+//	RunSystems makes a list of every chunk every system of a phase has to go over and hands the list to the
+//	job threads, so a phase with one system over many chunks spreads out as well as one with many systems.
+//	Without a job system everything runs on this thread.
+void EntityWorldClass::RunSystems(JobSystemClass* jobSystem)
+{
+	WorkType work;
+	unsigned int mask;
+	int phase, i, j, k;
+
+	auto runWork = [this](int begin, int end)
+	{
+		ChunkViewType view;
+		int i;
+
+		for (i = begin; i < end; i++)
+		{
+			GetChunkView(m_work[i].archetype, m_work[i].chunk, view);
+			m_systems[m_work[i].system].function(view);
+		}
+	};
+
+	for (phase = 0; phase < m_phaseCount; phase++)
+	{
+		m_work.clear();
+
+		for (i = 0; i < (int)m_systems.size(); i++)
+		{
+			if (m_systems[i].phase != phase)
+			{
+				continue;
+			}
+
+			mask = m_systems[i].readMask | m_systems[i].writeMask;
+			for (j = 0; j < (int)m_archetypes.size(); j++)
+			{
+				if ((m_archetypes[j].mask & mask) != mask)
+				{
+					continue;
+				}
+
+				for (k = 0; k < (int)m_archetypes[j].chunks.size(); k++)
+				{
+					work.system = i;
+					work.archetype = j;
+					work.chunk = k;
+					m_work.push_back(work);
+				}
+			}
+		}
+
+		if (jobSystem)
+		{
+			jobSystem->ParallelFor((int)m_work.size(), 1, runWork);
+		}
+		else
+		{
+			runWork(0, (int)m_work.size());
+		}
+	}
+
+	return;
+}
+
+int EntityWorldClass::GetEntityCount()
+{
+	return m_entityCount;
+}
+
+int EntityWorldClass::GetArchetypeCount()
+{
+	return (int)m_archetypes.size();
+}
+
+int EntityWorldClass::GetChunkCount()
+{
+	int i, count;
+
+	count = 0;
+	for (i = 0; i < (int)m_archetypes.size(); i++)
+	{
+		count += (int)m_archetypes[i].chunks.size();
+	}
+
+	return count;
+}
+
+int EntityWorldClass::GetPhaseCount()
+{
+	return m_phaseCount;
+}
+
+//	FindArchetype returns the archetype with exactly the given component types, creating it the first time.
+//	The capacity of its chunks is what fits in ENTITY_CHUNK_SIZE once every array is aligned.
+int EntityWorldClass::FindArchetype(unsigned int componentMask)
+{
+	ArchetypeType archetype;
+	unsigned int rowSize, padding, offset;
+	int i;
+
+	for (i = 0; i < (int)m_archetypes.size(); i++)
+	{
+		if (m_archetypes[i].mask == componentMask)
+		{
+			return i;
+		}
+	}
+
+	archetype.mask = componentMask;
+
+	rowSize = sizeof(unsigned int);
+	padding = ENTITY_ALIGNMENT;
+	for (i = 0; i < (int)m_componentSizes.size(); i++)
+	{
+		if (componentMask & (1u << i))
+		{
+			rowSize += m_componentSizes[i];
+			padding += ENTITY_ALIGNMENT;
+		}
+	}
+
+	archetype.capacity = (ENTITY_CHUNK_SIZE > padding + rowSize) ? (ENTITY_CHUNK_SIZE - padding) / rowSize : 1;
+
+	offset = (archetype.capacity * sizeof(unsigned int) + ENTITY_ALIGNMENT - 1) & ~(ENTITY_ALIGNMENT - 1);
+	for (i = 0; i < ENTITY_MAX_COMPONENT_TYPES; i++)
+	{
+		archetype.offsets[i] = 0;
+		if (i < (int)m_componentSizes.size() && (componentMask & (1u << i)))
+		{
+			archetype.offsets[i] = offset;
+			offset = (offset + archetype.capacity * m_componentSizes[i] + ENTITY_ALIGNMENT - 1) & ~(ENTITY_ALIGNMENT - 1);
+		}
+	}
+
+	archetype.chunkSize = offset;
+
+	m_archetypes.push_back(archetype);
+
+	return (int)m_archetypes.size() - 1;
+}
+
+//	PlaceEntity puts the entity in the first free row of the archetype, at the end of its last chunk or in a
+//	new chunk if that one is full, and zeroes its components.
+void EntityWorldClass::PlaceEntity(unsigned int id, int archetypeIndex)
+{
+	ArchetypeType* archetype;
+	ChunkType chunk;
+	EntityType* entity;
+	int i;
+
+	archetype = &m_archetypes[archetypeIndex];
+
+	if (archetype->chunks.empty() || archetype->chunks.back().count == archetype->capacity)
+	{
+		chunk.data = AllocateAligned(archetype->chunkSize, ENTITY_ALIGNMENT);
+		chunk.count = 0;
+		archetype->chunks.push_back(chunk);
+	}
+
+	entity = &m_entities[id & ENTITY_INDEX_MASK];
+	entity->archetype = archetypeIndex;
+	entity->chunk = (int)archetype->chunks.size() - 1;
+	entity->row = archetype->chunks.back().count++;
+
+	((unsigned int*)archetype->chunks.back().data)[entity->row] = id;
+
+	for (i = 0; i < (int)m_componentSizes.size(); i++)
+	{
+		if (archetype->mask & (1u << i))
+		{
+			memset(archetype->chunks.back().data + archetype->offsets[i] + (size_t)entity->row * m_componentSizes[i], 0, m_componentSizes[i]);
+		}
+	}
+
+	return;
+}
+
+//	RemoveFromChunk fills the row with the last entity of the archetype, so the chunks stay packed, and
+//	frees the last chunk once it is empty.
+void EntityWorldClass::RemoveFromChunk(int archetypeIndex, int chunkIndex, int row)
+{
+	ArchetypeType* archetype;
+	ChunkType* chunk, * lastChunk;
+	unsigned int movedId;
+	int lastRow, i;
+
+	archetype = &m_archetypes[archetypeIndex];
+	chunk = &archetype->chunks[chunkIndex];
+	lastChunk = &archetype->chunks.back();
+	lastRow = lastChunk->count - 1;
+
+	if (chunk != lastChunk || row != lastRow)
+	{
+		movedId = ((unsigned int*)lastChunk->data)[lastRow];
+		((unsigned int*)chunk->data)[row] = movedId;
+
+		for (i = 0; i < (int)m_componentSizes.size(); i++)
+		{
+			if (archetype->mask & (1u << i))
+			{
+				memcpy(chunk->data + archetype->offsets[i] + (size_t)row * m_componentSizes[i],
+					lastChunk->data + archetype->offsets[i] + (size_t)lastRow * m_componentSizes[i], m_componentSizes[i]);
+			}
+		}
+
+		m_entities[movedId & ENTITY_INDEX_MASK].chunk = chunkIndex;
+		m_entities[movedId & ENTITY_INDEX_MASK].row = row;
+	}
+
+	lastChunk->count--;
+	if (lastChunk->count == 0)
+	{
+		FreeAligned(lastChunk->data);
+		archetype->chunks.pop_back();
+	}
+
+	return;
+}
+
+//	MoveEntity places the entity in the archetype of the new mask, copies over the components both
+//	archetypes have and takes it out of the old one. The components that are new to it start out zeroed.
+void EntityWorldClass::MoveEntity(unsigned int id, unsigned int componentMask)
+{
+	EntityType oldEntity, * entity;
+	ArchetypeType* oldArchetype, * newArchetype;
+	unsigned int sharedMask;
+	int archetype, i;
+
+	entity = &m_entities[id & ENTITY_INDEX_MASK];
+	if (m_archetypes[entity->archetype].mask == componentMask)
+	{
+		return;
+	}
+
+//	Finding the archetype can add one, which moves the others, so the pointers are taken after it:
+	archetype = FindArchetype(componentMask);
+	oldEntity = *entity;
+
+	PlaceEntity(id, archetype);
+
+	oldArchetype = &m_archetypes[oldEntity.archetype];
+	newArchetype = &m_archetypes[archetype];
+	sharedMask = oldArchetype->mask & newArchetype->mask;
+
+	for (i = 0; i < (int)m_componentSizes.size(); i++)
+	{
+		if (sharedMask & (1u << i))
+		{
+			memcpy(newArchetype->chunks[entity->chunk].data + newArchetype->offsets[i] + (size_t)entity->row * m_componentSizes[i],
+				oldArchetype->chunks[oldEntity.chunk].data + oldArchetype->offsets[i] + (size_t)oldEntity.row * m_componentSizes[i],
+				m_componentSizes[i]);
+		}
+	}
+
+	RemoveFromChunk(oldEntity.archetype, oldEntity.chunk, oldEntity.row);
+
+	return;
+}
+
+void EntityWorldClass::GetChunkView(int archetypeIndex, int chunkIndex, ChunkViewType& view)
+{
+	ArchetypeType* archetype;
+	ChunkType* chunk;
+	int i;
+
+	archetype = &m_archetypes[archetypeIndex];
+	chunk = &archetype->chunks[chunkIndex];
+
+	view.count = chunk->count;
+	view.entities = (const unsigned int*)chunk->data;
+
+	for (i = 0; i < ENTITY_MAX_COMPONENT_TYPES; i++)
+	{
+		view.components[i] = (archetype->mask & (1u << i)) ? chunk->data + archetype->offsets[i] : 0;
+	}
+
+	return;
+}
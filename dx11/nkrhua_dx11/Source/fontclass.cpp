@@ -0,0 +1,251 @@
+#include "../Headers/fontclass.h"
+
+static const int FONT_GLYPH_COUNT = FONT_LAST_CHARACTER - FONT_FIRST_CHARACTER + 1;
+
+FontClass::FontClass()
+{
+	int i;
+
+	for (i = 0; i < FONT_GLYPH_COUNT; i++)
+	{
+		m_glyphs[i].left = 0.0f;
+		m_glyphs[i].top = 0.0f;
+		m_glyphs[i].right = 0.0f;
+		m_glyphs[i].bottom = 0.0f;
+		m_glyphs[i].width = 0.0f;
+		m_glyphs[i].height = 0.0f;
+		m_glyphs[i].advance = 0.0f;
+	}
+	m_lineHeight = 0.0f;
+	m_atlasHeight = 0;
+	m_ResourceRegistry = 0;
+	m_texture.id = 0;
+	m_shaderResourceView.id = 0;
+}
+
+FontClass::FontClass(const FontClass& other)
+{
+
+}
+
+FontClass::~FontClass()
+{
+
+}
+
+bool FontClass::Initialize(ID3D11Device* device, ResourceRegistryClass* resourceRegistry, const wchar_t* faceName, int pixelHeight)
+{
+	vector<unsigned char> atlas;
+
+	m_ResourceRegistry = resourceRegistry;
+
+	if (!RasterizeGlyphs(faceName, pixelHeight, atlas))
+	{
+		return false;
+	}
+
+	return InitializeTexture(device, atlas);
+}
+
+void FontClass::Shutdown()
+{
+	if (m_ResourceRegistry)
+	{
+		m_ResourceRegistry->Release(m_shaderResourceView);
+		m_ResourceRegistry->Release(m_texture);
+		m_ResourceRegistry = 0;
+	}
+
+	return;
+}
+
+const FontClass::GlyphType& FontClass::GetGlyph(char character)
+{
+	if (character < FONT_FIRST_CHARACTER || character > FONT_LAST_CHARACTER)
+	{
+		character = FONT_FALLBACK;
+	}
+
+	return m_glyphs[character - FONT_FIRST_CHARACTER];
+}
+
+float FontClass::GetLineHeight()
+{
+	return m_lineHeight;
+}
+
+ID3D11ShaderResourceView* FontClass::GetShaderResourceView()
+{
+	return m_ResourceRegistry->Get(m_shaderResourceView);
+}
+
+int FontClass::GetAtlasHeight()
+{
+	return m_atlasHeight;
+}
+
+//	RasterizeGlyphs measures every glyph, lays them out in rows a texel apart, draws them white on black into
+//	a DIB section of that size and keeps one channel of it as the coverage. Anti-aliased quality keeps GDI
+//	from drawing ClearType, whose channels differ.
+bool FontClass::RasterizeGlyphs(const wchar_t* faceName, int pixelHeight, vector<unsigned char>& atlas)
+{
+	BITMAPINFO bitmapInfo;
+	TEXTMETRICW metrics;
+	SIZE size;
+	HDC deviceContext;
+	HFONT font;
+	HBITMAP bitmap;
+	HGDIOBJ oldFont, oldBitmap;
+	unsigned char* pixels;
+	wchar_t character;
+	int glyphX[FONT_GLYPH_COUNT], glyphY[FONT_GLYPH_COUNT];
+	int i, penX, penY, cellHeight;
+
+	deviceContext = CreateCompatibleDC(NULL);
+	if (!deviceContext)
+	{
+		return false;
+	}
+
+	font = CreateFontW(-pixelHeight, 0, 0, 0, FW_NORMAL, FALSE, FALSE, FALSE, DEFAULT_CHARSET, OUT_TT_PRECIS, CLIP_DEFAULT_PRECIS,
+		ANTIALIASED_QUALITY, DEFAULT_PITCH | FF_DONTCARE, faceName);
+	if (!font)
+	{
+		DeleteDC(deviceContext);
+		return false;
+	}
+
+	oldFont = SelectObject(deviceContext, font);
+
+	GetTextMetricsW(deviceContext, &metrics);
+	cellHeight = metrics.tmHeight;
+
+	penX = 0;
+	penY = 0;
+	for (i = 0; i < FONT_GLYPH_COUNT; i++)
+	{
+		character = (wchar_t)(FONT_FIRST_CHARACTER + i);
+		GetTextExtentPoint32W(deviceContext, &character, 1, &size);
+
+		if (penX + size.cx > FONT_ATLAS_WIDTH)
+		{
+			penX = 0;
+			penY += cellHeight + 1;
+		}
+
+		glyphX[i] = penX;
+		glyphY[i] = penY;
+
+		m_glyphs[i].width = (float)size.cx;
+		m_glyphs[i].height = (float)cellHeight;
+		m_glyphs[i].advance = (float)size.cx;
+
+		penX += size.cx + 1;
+	}
+
+	m_atlasHeight = penY + cellHeight;
+	m_lineHeight = (float)cellHeight;
+
+//	The DIB section is top down, so its rows are in the order of the texture's:
+	ZeroMemory(&bitmapInfo, sizeof(bitmapInfo));
+	bitmapInfo.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	bitmapInfo.bmiHeader.biWidth = FONT_ATLAS_WIDTH;
+	bitmapInfo.bmiHeader.biHeight = -m_atlasHeight;
+	bitmapInfo.bmiHeader.biPlanes = 1;
+	bitmapInfo.bmiHeader.biBitCount = 32;
+	bitmapInfo.bmiHeader.biCompression = BI_RGB;
+
+	bitmap = CreateDIBSection(deviceContext, &bitmapInfo, DIB_RGB_COLORS, (void**)&pixels, NULL, 0);
+	if (!bitmap)
+	{
+		SelectObject(deviceContext, oldFont);
+		DeleteObject(font);
+		DeleteDC(deviceContext);
+		return false;
+	}
+
+	oldBitmap = SelectObject(deviceContext, bitmap);
+	ZeroMemory(pixels, (size_t)FONT_ATLAS_WIDTH * m_atlasHeight * 4);
+
+	SetTextColor(deviceContext, RGB(255, 255, 255));
+	SetBkColor(deviceContext, RGB(0, 0, 0));
+	SetBkMode(deviceContext, OPAQUE);
+
+	for (i = 0; i < FONT_GLYPH_COUNT; i++)
+	{
+		character = (wchar_t)(FONT_FIRST_CHARACTER + i);
+		TextOutW(deviceContext, glyphX[i], glyphY[i], &character, 1);
+	}
+	GdiFlush();
+
+	atlas.resize((size_t)FONT_ATLAS_WIDTH * m_atlasHeight);
+	for (i = 0; i < (int)atlas.size(); i++)
+	{
+		atlas[i] = pixels[(size_t)i * 4 + 1];
+	}
+
+	for (i = 0; i < FONT_GLYPH_COUNT; i++)
+	{
+		m_glyphs[i].left = (float)glyphX[i] / (float)FONT_ATLAS_WIDTH;
+		m_glyphs[i].top = (float)glyphY[i] / (float)m_atlasHeight;
+		m_glyphs[i].right = ((float)glyphX[i] + m_glyphs[i].width) / (float)FONT_ATLAS_WIDTH;
+		m_glyphs[i].bottom = (float)(glyphY[i] + cellHeight) / (float)m_atlasHeight;
+	}
+
+	SelectObject(deviceContext, oldBitmap);
+	SelectObject(deviceContext, oldFont);
+	DeleteObject(bitmap);
+	DeleteObject(font);
+	DeleteDC(deviceContext);
+
+	return true;
+}
+
+bool FontClass::InitializeTexture(ID3D11Device* device, const vector<unsigned char>& atlas)
+{
+	D3D11_TEXTURE2D_DESC textureDesc;
+	D3D11_SUBRESOURCE_DATA textureData;
+	D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc;
+	ID3D11Texture2D* texture;
+	ID3D11ShaderResourceView* shaderResourceView;
+	HRESULT result;
+
+	textureDesc.Width = FONT_ATLAS_WIDTH;
+	textureDesc.Height = m_atlasHeight;
+	textureDesc.MipLevels = 1;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = DXGI_FORMAT_R8_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.MiscFlags = 0;
+
+	textureData.pSysMem = atlas.data();
+	textureData.SysMemPitch = FONT_ATLAS_WIDTH;
+	textureData.SysMemSlicePitch = 0;
+
+	result = device->CreateTexture2D(&textureDesc, &textureData, &texture);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_texture = m_ResourceRegistry->Register(texture);
+
+	shaderResourceViewDesc.Format = DXGI_FORMAT_R8_UNORM;
+	shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	shaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
+	shaderResourceViewDesc.Texture2D.MipLevels = 1;
+
+	result = device->CreateShaderResourceView(texture, &shaderResourceViewDesc, &shaderResourceView);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_shaderResourceView = m_ResourceRegistry->Register(shaderResourceView);
+
+	return true;
+}
@@ -0,0 +1,288 @@
+#include "../Headers/framecaptureclass.h"
+
+#include <string.h>
+
+FrameCaptureClass::FrameCaptureClass()
+{
+	int i;
+
+	for (i = 0; i < CAPTURE_STAGING_COUNT; i++)
+	{
+		m_staging[i].texture = 0;
+		m_staging[i].frameNumber = 0;
+		m_staging[i].pending = false;
+	}
+
+	m_oldestSlot = 0;
+	m_pendingCount = 0;
+	m_quit = false;
+	m_failedCount = 0;
+}
+
+FrameCaptureClass::FrameCaptureClass(const FrameCaptureClass& other)
+{
+
+}
+
+FrameCaptureClass::~FrameCaptureClass()
+{
+
+}
+
+//	Initialize creates the staging textures for captures of the given size and starts the writer thread.
+//	Captured frames are written to outputPrefix followed by the frame number, and compared against the
+//	file with the same name under goldenPrefix if there is one.
+bool FrameCaptureClass::Initialize(ID3D11Device* device, int width, int height, const char* outputPrefix, const char* goldenPrefix)
+{
+	D3D11_TEXTURE2D_DESC textureDesc;
+	HRESULT result;
+	int i;
+
+	m_width = width;
+	m_height = height;
+	strncpy_s(m_outputPrefix, sizeof(m_outputPrefix), outputPrefix, _TRUNCATE);
+	strncpy_s(m_goldenPrefix, sizeof(m_goldenPrefix), goldenPrefix, _TRUNCATE);
+
+//	Setup the staging texture description. Staging textures can't be bound to the pipeline, they only
+//	exist to be copied into by the GPU and mapped for reading by the CPU:
+	ZeroMemory(&textureDesc, sizeof(textureDesc));
+
+	textureDesc.Width = width;
+	textureDesc.Height = height;
+	textureDesc.MipLevels = 1;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.Usage = D3D11_USAGE_STAGING;
+	textureDesc.BindFlags = 0;
+	textureDesc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+	textureDesc.MiscFlags = 0;
+
+	for (i = 0; i < CAPTURE_STAGING_COUNT; i++)
+	{
+		result = device->CreateTexture2D(&textureDesc, NULL, &m_staging[i].texture);
+		if (FAILED(result))
+		{
+			return false;
+		}
+	}
+
+	m_quit = false;
+	m_writerThread = thread(&FrameCaptureClass::WriterThread, this);
+
+	return true;
+}
+
+void FrameCaptureClass::Shutdown()
+{
+	int i;
+
+//	Tell the writer thread to stop once the queue is empty and wait for it:
+	if (m_writerThread.joinable())
+	{
+		{
+			lock_guard<mutex> lock(m_queueMutex);
+			m_quit = true;
+		}
+		m_queueCondition.notify_one();
+		m_writerThread.join();
+	}
+
+	for (i = 0; i < CAPTURE_STAGING_COUNT; i++)
+	{
+		if (m_staging[i].texture)
+		{
+			m_staging[i].texture->Release();
+			m_staging[i].texture = 0;
+		}
+	}
+
+	return;
+}
+
+//	Capture queues a copy of the source texture into the next staging texture. The source must have the
+//	size and format the class was initialized with. If every staging texture is still waiting to be read
+//	back the frame is dropped, since waiting for the GPU here is exactly the stall the ring avoids.
+bool FrameCaptureClass::Capture(ID3D11DeviceContext* deviceContext, ID3D11Texture2D* source, int frameNumber)
+{
+	int slot;
+
+	if (m_pendingCount == CAPTURE_STAGING_COUNT)
+	{
+		return false;
+	}
+
+	slot = (m_oldestSlot + m_pendingCount) % CAPTURE_STAGING_COUNT;
+
+	deviceContext->CopyResource(m_staging[slot].texture, source);
+	m_staging[slot].frameNumber = frameNumber;
+	m_staging[slot].pending = true;
+	m_pendingCount++;
+
+	return true;
+}
+
+//	Update is called once per frame and reads back every capture the GPU has finished, oldest first.
+//	It stops at the first one that is not ready so the images reach the writer thread in order.
+void FrameCaptureClass::Update(ID3D11DeviceContext* deviceContext)
+{
+	while (m_pendingCount > 0)
+	{
+		if (!ReadBack(deviceContext, m_staging[m_oldestSlot], false))
+		{
+			break;
+		}
+
+		m_oldestSlot = (m_oldestSlot + 1) % CAPTURE_STAGING_COUNT;
+		m_pendingCount--;
+	}
+
+	return;
+}
+
+//	Flush waits for all pending captures, for use when the application is about to stop.
+void FrameCaptureClass::Flush(ID3D11DeviceContext* deviceContext)
+{
+	while (m_pendingCount > 0)
+	{
+		ReadBack(deviceContext, m_staging[m_oldestSlot], true);
+
+		m_oldestSlot = (m_oldestSlot + 1) % CAPTURE_STAGING_COUNT;
+		m_pendingCount--;
+	}
+
+	return;
+}
+
+//	GetFailedCount returns how many captures so far did not match their golden image.
+int FrameCaptureClass::GetFailedCount()
+{
+	lock_guard<mutex> lock(m_queueMutex);
+	return m_failedCount;
+}
+
+//	ReadBack maps a staging texture and copies its rows into a new job for the writer thread. Without
+//	wait the map is done with DO_NOT_WAIT and returns false if the GPU has not finished the copy yet.
+bool FrameCaptureClass::ReadBack(ID3D11DeviceContext* deviceContext, StagingSlotType& slot, bool wait)
+{
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	HRESULT result;
+	CaptureJobType* job;
+	unsigned char* source;
+	int y;
+
+	result = deviceContext->Map(slot.texture, 0, D3D11_MAP_READ, wait ? 0 : D3D11_MAP_FLAG_DO_NOT_WAIT, &mappedResource);
+	if (result == DXGI_ERROR_WAS_STILL_DRAWING)
+	{
+		return false;
+	}
+
+	slot.pending = false;
+
+//	If the map failed for any other reason the capture is lost, but the slot can still be reused:
+	if (FAILED(result))
+	{
+		return true;
+	}
+
+	job = new CaptureJobType;
+	job->frameNumber = slot.frameNumber;
+	job->image.width = m_width;
+	job->image.height = m_height;
+	job->image.pixels.resize((size_t)m_width * m_height * 4);
+
+//	The rows of the mapped texture can be padded, so copy them one at a time:
+	source = (unsigned char*)mappedResource.pData;
+	for (y = 0; y < m_height; y++)
+	{
+		memcpy(&job->image.pixels[(size_t)y * m_width * 4], source + (size_t)y * mappedResource.RowPitch, (size_t)m_width * 4);
+	}
+
+	deviceContext->Unmap(slot.texture, 0);
+
+	{
+		lock_guard<mutex> lock(m_queueMutex);
+		m_queue.push_back(job);
+	}
+	m_queueCondition.notify_one();
+
+	return true;
+}
+
+//	WriterThread takes jobs off the queue until it is told to quit and the queue is empty, so no
+//	capture that was read back is lost on shutdown.
+void FrameCaptureClass::WriterThread()
+{
+	CaptureJobType* job;
+
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(m_queueMutex);
+			m_queueCondition.wait(lock, [this] { return m_quit || !m_queue.empty(); });
+
+			if (m_queue.empty())
+			{
+				return;
+			}
+
+			job = m_queue.front();
+			m_queue.pop_front();
+		}
+
+		WriteCapture(job);
+		delete job;
+	}
+}
+
+//	WriteCapture saves the image and compares it against its golden image. Frames that fail also get a
+//	diff image next to them, and every comparison is appended to the report.
+void FrameCaptureClass::WriteCapture(CaptureJobType* job)
+{
+	ImageCompareClass::ImageType golden, diff;
+	ImageCompareClass::CompareResultType compareResult;
+	char filename[160], goldenFilename[160], diffFilename[160];
+	FILE* reportPtr;
+	bool result;
+
+	sprintf_s(filename, sizeof(filename), "%s%05d.tga", m_outputPrefix, job->frameNumber);
+	m_ImageCompare.SaveTarga(filename, job->image);
+
+//	Frames without a golden image are only captured:
+	sprintf_s(goldenFilename, sizeof(goldenFilename), "%s%05d.tga", m_goldenPrefix, job->frameNumber);
+	if (!m_ImageCompare.LoadTarga(goldenFilename, golden))
+	{
+		return;
+	}
+
+	result = m_ImageCompare.Compare(job->image, golden, CAPTURE_COMPARE_THRESHOLD, CAPTURE_COMPARE_MAX_RATIO, compareResult, &diff);
+	if (!result || !compareResult.passed)
+	{
+		{
+			lock_guard<mutex> lock(m_queueMutex);
+			m_failedCount++;
+		}
+
+		if (result)
+		{
+			sprintf_s(diffFilename, sizeof(diffFilename), "%s%05d-diff.tga", m_outputPrefix, job->frameNumber);
+			m_ImageCompare.SaveTarga(diffFilename, diff);
+		}
+	}
+
+	if (fopen_s(&reportPtr, "capture-report.txt", "a") == 0)
+	{
+		if (result)
+		{
+			fprintf(reportPtr, "%s %s: %d different pixels (%.4f%%), largest difference %.3f\n", filename,
+				compareResult.passed ? "passed" : "FAILED", compareResult.differentPixels, compareResult.differentRatio * 100.0f, compareResult.maxDelta);
+		}
+		else
+		{
+			fprintf(reportPtr, "%s FAILED: size does not match %s\n", filename, goldenFilename);
+		}
+		fclose(reportPtr);
+	}
+
+	return;
+}
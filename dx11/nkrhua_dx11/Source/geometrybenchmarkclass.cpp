@@ -0,0 +1,195 @@
+#include "../Headers/geometrybenchmarkclass.h"
+
+#include <stdio.h>
+#include <chrono>
+
+bool GeometryBenchmarkClass::Run(D3DClass* direct3D, ColorShaderClass* colorShader, unsigned int stride, XMMATRIX viewMatrix, int meshCount,
+	unsigned int defragBytes, const char* report)
+{
+	GeometryHeapClass heap;
+	vector<int> meshes, vertexCounts;
+	vector<ID3D11Buffer*> vertexBuffers, indexBuffers;
+	vector<unsigned char> vertices;
+	vector<unsigned long> indices;
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_SUBRESOURCE_DATA bufferData;
+	XMMATRIX worldMatrix, projectionMatrix;
+	chrono::high_resolution_clock::time_point startTime;
+	ID3D11DeviceContext* deviceContext;
+	FILE* reportPtr;
+	float time, heapCreateTime, bufferCreateTime, heapDrawTime, bufferDrawTime, defragTime;
+	unsigned int seed, offset, totalVertices, largestBefore, largestAfter, frameBytes, movedBytes;
+	int i, pass, defragFrames, indexCount;
+	HRESULT hresult;
+	bool result;
+
+	seed = 1;
+	auto random = [&seed](int range)
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (int)((seed >> 8) % (unsigned int)range);
+	};
+
+	deviceContext = direct3D->GetDeviceContext();
+
+	vertexCounts.resize(meshCount);
+	totalVertices = 0;
+	for (i = 0; i < meshCount; i++)
+	{
+		vertexCounts[i] = 24 + random(1000);
+		totalVertices += vertexCounts[i];
+	}
+
+	vertices.resize(1024 * stride, 0);
+	indices.resize(3 * 1024, 0);
+
+//	The heap gets twice the room the meshes need, so the replaced half fits in beside them.
+	result = heap.Initialize(direct3D->GetDevice(), direct3D->GetResourceRegistry(), stride, 2 * totalVertices,
+		6 * totalVertices, defragBytes);
+	if (!result)
+	{
+		return false;
+	}
+
+	meshes.resize(meshCount);
+	startTime = chrono::high_resolution_clock::now();
+	for (i = 0; i < meshCount; i++)
+	{
+		meshes[i] = heap.CreateMesh(deviceContext, vertices.data(), vertexCounts[i], indices.data(), 3 * vertexCounts[i]);
+		if (meshes[i] == -1)
+		{
+			return false;
+		}
+	}
+	heapCreateTime = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+
+	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	bufferDesc.CPUAccessFlags = 0;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+	bufferData.SysMemPitch = 0;
+	bufferData.SysMemSlicePitch = 0;
+
+	vertexBuffers.resize(meshCount, 0);
+	indexBuffers.resize(meshCount, 0);
+	hresult = S_OK;
+	startTime = chrono::high_resolution_clock::now();
+	for (i = 0; i < meshCount; i++)
+	{
+		bufferDesc.ByteWidth = vertexCounts[i] * stride;
+		bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bufferData.pSysMem = vertices.data();
+		hresult = direct3D->GetDevice()->CreateBuffer(&bufferDesc, &bufferData, &vertexBuffers[i]);
+		if (FAILED(hresult))
+		{
+			break;
+		}
+
+		bufferDesc.ByteWidth = 3 * vertexCounts[i] * sizeof(unsigned long);
+		bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		bufferData.pSysMem = indices.data();
+		hresult = direct3D->GetDevice()->CreateBuffer(&bufferDesc, &bufferData, &indexBuffers[i]);
+		if (FAILED(hresult))
+		{
+			break;
+		}
+	}
+	bufferCreateTime = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+
+//	Draw both ways a few times and keep the fastest, so the first pass warming up the driver doesn't count.
+	direct3D->GetWorldMatrix(worldMatrix);
+	direct3D->GetProjectionMatrix(projectionMatrix);
+
+	result = true;
+	heapDrawTime = 1.0e9f;
+	bufferDrawTime = 1.0e9f;
+	for (pass = 0; pass < 4 && result && !FAILED(hresult); pass++)
+	{
+		startTime = chrono::high_resolution_clock::now();
+		heap.Render(deviceContext);
+		for (i = 0; i < meshCount && result; i++)
+		{
+			result = colorShader->Render(deviceContext, heap.GetIndexCount(meshes[i]), heap.GetStartIndex(meshes[i]),
+				heap.GetBaseVertex(meshes[i]), worldMatrix, viewMatrix, projectionMatrix);
+		}
+		deviceContext->Flush();
+		time = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+		heapDrawTime = (time < heapDrawTime) ? time : heapDrawTime;
+
+		startTime = chrono::high_resolution_clock::now();
+		offset = 0;
+		for (i = 0; i < meshCount && result; i++)
+		{
+			indexCount = 3 * vertexCounts[i];
+			deviceContext->IASetVertexBuffers(0, 1, &vertexBuffers[i], &stride, &offset);
+			deviceContext->IASetIndexBuffer(indexBuffers[i], DXGI_FORMAT_R32_UINT, 0);
+			result = colorShader->Render(deviceContext, indexCount, worldMatrix, viewMatrix, projectionMatrix);
+		}
+		deviceContext->Flush();
+		time = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+		bufferDrawTime = (time < bufferDrawTime) ? time : bufferDrawTime;
+	}
+
+	for (i = 0; i < meshCount; i++)
+	{
+		if (indexBuffers[i])
+		{
+			indexBuffers[i]->Release();
+		}
+
+		if (vertexBuffers[i])
+		{
+			vertexBuffers[i]->Release();
+		}
+	}
+
+	if (!result || FAILED(hresult))
+	{
+		heap.Shutdown();
+		return false;
+	}
+
+//	Replace every other mesh with one of a new size, then defragment until a walk down the heap moves nothing.
+	for (i = 0; i < meshCount; i += 2)
+	{
+		heap.ReleaseMesh(meshes[i]);
+	}
+
+	for (i = 0; i < meshCount; i += 2)
+	{
+		vertexCounts[i] = 24 + random(1000);
+		meshes[i] = heap.CreateMesh(deviceContext, vertices.data(), vertexCounts[i], indices.data(), 3 * vertexCounts[i]);
+	}
+
+	largestBefore = heap.GetLargestFreeVertexCount();
+
+	defragFrames = 0;
+	movedBytes = 0;
+	startTime = chrono::high_resolution_clock::now();
+	while (!heap.IsPacked())
+	{
+		frameBytes = heap.Defragment(deviceContext, defragBytes);
+
+		movedBytes += frameBytes;
+		defragFrames++;
+	}
+	defragTime = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+
+	largestAfter = heap.GetLargestFreeVertexCount();
+
+	heap.Shutdown();
+
+	if (fopen_s(&reportPtr, report, "a") != 0)
+	{
+		return true;
+	}
+
+	fprintf(reportPtr, "%d meshes, %u vertices: create %.3f ms heap, %.3f ms buffers; draw %.3f ms heap, %.3f ms buffers\n",
+		meshCount, totalVertices, heapCreateTime, bufferCreateTime, heapDrawTime, bufferDrawTime);
+	fprintf(reportPtr, "defragment after replacing half: %d frames, %u bytes moved, %.3f ms, largest free %u -> %u vertices\n",
+		defragFrames, movedBytes, defragTime, largestBefore, largestAfter);
+
+	fclose(reportPtr);
+
+	return true;
+}
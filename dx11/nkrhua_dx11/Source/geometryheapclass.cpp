@@ -0,0 +1,380 @@
+#include "../Headers/geometryheapclass.h"
+
+GeometryHeapClass::GeometryHeapClass()
+{
+	m_ResourceRegistry = 0;
+	m_vertexBuffer.id = 0;
+	m_indexBuffer.id = 0;
+	m_scratchBuffer.id = 0;
+	m_vertexStride = 0;
+	m_scratchSize = 0;
+	m_meshCount = 0;
+	ResetDefragment();
+}
+
+GeometryHeapClass::GeometryHeapClass(const GeometryHeapClass& other)
+{
+
+}
+
+GeometryHeapClass::~GeometryHeapClass()
+{
+
+}
+
+//	Initialize creates the vertex buffer with room for the given number of vertices of the given stride, the
+//	index buffer with room for the given number of indices, and the scratch buffer that meshes are moved
+//	through, all three in the Resource Registry. Without a device only the allocators are set up, which is
+//	enough to time them.
+bool GeometryHeapClass::Initialize(ID3D11Device* device, ResourceRegistryClass* resourceRegistry, unsigned int vertexStride,
+	unsigned int vertexCapacity, unsigned int indexCapacity, unsigned int scratchSize)
+{
+	D3D11_BUFFER_DESC bufferDesc;
+	ID3D11Buffer* buffer;
+	HRESULT result;
+
+	m_vertexStride = vertexStride;
+	m_scratchSize = scratchSize;
+
+	if (!m_vertexAllocator.Initialize(vertexCapacity) || !m_indexAllocator.Initialize(indexCapacity))
+	{
+		return false;
+	}
+
+	ResetDefragment();
+
+	if (!device)
+	{
+		return true;
+	}
+
+	m_ResourceRegistry = resourceRegistry;
+
+//	Both buffers are filled and moved around with copies on the video card only, so they are default usage.
+	bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	bufferDesc.ByteWidth = vertexStride * vertexCapacity;
+	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bufferDesc.CPUAccessFlags = 0;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_vertexBuffer = m_ResourceRegistry->Register(buffer);
+
+	bufferDesc.ByteWidth = sizeof(unsigned long) * indexCapacity;
+	bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_indexBuffer = m_ResourceRegistry->Register(buffer);
+
+//	A buffer can't be copied onto itself, so a mesh that moves is copied out to the scratch buffer and back.
+	if (scratchSize > 0)
+	{
+		bufferDesc.ByteWidth = scratchSize;
+		bufferDesc.BindFlags = 0;
+
+		result = device->CreateBuffer(&bufferDesc, NULL, &buffer);
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		m_scratchBuffer = m_ResourceRegistry->Register(buffer);
+	}
+
+	return true;
+}
+
+void GeometryHeapClass::Shutdown()
+{
+	if (m_ResourceRegistry)
+	{
+		m_ResourceRegistry->Release(m_scratchBuffer);
+		m_ResourceRegistry->Release(m_indexBuffer);
+		m_ResourceRegistry->Release(m_vertexBuffer);
+		m_ResourceRegistry = 0;
+	}
+
+	m_indexAllocator.Shutdown();
+	m_vertexAllocator.Shutdown();
+	m_meshes.clear();
+	m_unusedMeshes.clear();
+	m_meshCount = 0;
+
+	return;
+}
+
+//	CreateMesh takes a block of each buffer from the allocators and copies the data into them. The copies
+//	go through the device context, so no buffer has to be mapped.
+int GeometryHeapClass::CreateMesh(ID3D11DeviceContext* deviceContext, const void* vertices, int vertexCount,
+	const unsigned long* indices, int indexCount)
+{
+	MeshType meshData;
+	D3D11_BOX box;
+	int mesh;
+
+//	The allocators hand out no empty blocks, so an empty mesh is turned down here rather than look like a
+//	full heap:
+	if (vertexCount <= 0 || indexCount <= 0)
+	{
+		return -1;
+	}
+
+	if (!m_unusedMeshes.empty())
+	{
+		mesh = m_unusedMeshes.back();
+	}
+	else
+	{
+		mesh = (int)m_meshes.size();
+	}
+
+	meshData.vertexCount = vertexCount;
+	meshData.indexCount = indexCount;
+
+	meshData.vertexBlock = m_vertexAllocator.Allocate(vertexCount);
+	if (meshData.vertexBlock == -1)
+	{
+		return -1;
+	}
+
+	meshData.indexBlock = m_indexAllocator.Allocate(indexCount);
+	if (meshData.indexBlock == -1)
+	{
+		m_vertexAllocator.Free(meshData.vertexBlock);
+		return -1;
+	}
+
+	if (deviceContext && m_ResourceRegistry)
+	{
+		box.left = m_vertexAllocator.GetOffset(meshData.vertexBlock) * m_vertexStride;
+		box.right = box.left + vertexCount * m_vertexStride;
+		box.top = 0;
+		box.bottom = 1;
+		box.front = 0;
+		box.back = 1;
+		deviceContext->UpdateSubresource(m_ResourceRegistry->Get(m_vertexBuffer), 0, &box, vertices, 0, 0);
+
+		box.left = m_indexAllocator.GetOffset(meshData.indexBlock) * sizeof(unsigned long);
+		box.right = box.left + indexCount * sizeof(unsigned long);
+		deviceContext->UpdateSubresource(m_ResourceRegistry->Get(m_indexBuffer), 0, &box, indices, 0, 0);
+	}
+
+	if (!m_unusedMeshes.empty())
+	{
+		m_unusedMeshes.pop_back();
+		m_meshes[mesh] = meshData;
+	}
+	else
+	{
+		m_meshes.push_back(meshData);
+	}
+
+	m_meshCount++;
+	ResetDefragment();
+
+	return mesh;
+}
+
+void GeometryHeapClass::ReleaseMesh(int mesh)
+{
+	if (mesh < 0 || mesh >= (int)m_meshes.size() || m_meshes[mesh].vertexBlock == -1)
+	{
+		return;
+	}
+
+	m_vertexAllocator.Free(m_meshes[mesh].vertexBlock);
+	m_indexAllocator.Free(m_meshes[mesh].indexBlock);
+	m_meshes[mesh].vertexBlock = -1;
+	m_meshes[mesh].indexBlock = -1;
+	m_unusedMeshes.push_back(mesh);
+	m_meshCount--;
+	ResetDefragment();
+
+	return;
+}
+
+void GeometryHeapClass::Render(ID3D11DeviceContext* deviceContext)
+{
+	ID3D11Buffer* vertexBuffer;
+	unsigned int stride;
+	unsigned int offset;
+
+	vertexBuffer = m_ResourceRegistry->Get(m_vertexBuffer);
+	stride = m_vertexStride;
+	offset = 0;
+
+	deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+	deviceContext->IASetIndexBuffer(m_ResourceRegistry->Get(m_indexBuffer), DXGI_FORMAT_R32_UINT, 0);
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	return;
+}
+
+int GeometryHeapClass::GetIndexCount(int mesh)
+{
+	return m_meshes[mesh].indexCount;
+}
+
+int GeometryHeapClass::GetStartIndex(int mesh)
+{
+	return (int)m_indexAllocator.GetOffset(m_meshes[mesh].indexBlock);
+}
+
+int GeometryHeapClass::GetBaseVertex(int mesh)
+{
+	return (int)m_vertexAllocator.GetOffset(m_meshes[mesh].vertexBlock);
+}
+
+//	Defragment takes turns between the two buffers so neither waits on the other to be packed. Without a
+//	device only the allocations move, which is enough to time it.
+unsigned int GeometryHeapClass::Defragment(ID3D11DeviceContext* deviceContext, unsigned int byteBudget)
+{
+	ID3D11Buffer* vertexBuffer, * indexBuffer;
+	unsigned int movedBytes;
+	int steps;
+
+	if (m_scratchSize == 0)
+	{
+		return 0;
+	}
+
+	vertexBuffer = 0;
+	indexBuffer = 0;
+	if (m_ResourceRegistry)
+	{
+		vertexBuffer = m_ResourceRegistry->Get(m_vertexBuffer);
+		indexBuffer = m_ResourceRegistry->Get(m_indexBuffer);
+	}
+
+	movedBytes = 0;
+	steps = 0;
+	while (movedBytes < byteBudget && steps < GEOMETRY_HEAP_DEFRAG_STEPS && !IsPacked())
+	{
+		movedBytes += MoveBlock(deviceContext, m_vertexAllocator, m_vertexDefragment, vertexBuffer, m_vertexStride);
+		movedBytes += MoveBlock(deviceContext, m_indexAllocator, m_indexDefragment, indexBuffer, sizeof(unsigned long));
+		steps++;
+	}
+
+	return movedBytes;
+}
+
+bool GeometryHeapClass::IsPacked()
+{
+	return m_vertexDefragment.packed && m_indexDefragment.packed;
+}
+
+//	MoveBlock slides the block at the cursor down over the free space right below it and steps the cursor
+//	up to the next block. The data goes out to the scratch buffer and back, so the old and new range may
+//	overlap, and the copies are queued on the device context behind any draws that still read the old
+//	range. The mesh keeps its block, only the offset changes. Blocks larger than the scratch buffer stay
+//	where they are and the free space below them stays with them.
+unsigned int GeometryHeapClass::MoveBlock(ID3D11DeviceContext* deviceContext, TLSFAllocatorClass& allocator,
+	DefragmentType& defragment, ID3D11Buffer* buffer, unsigned int stride)
+{
+	D3D11_BOX box;
+	ID3D11Buffer* scratchBuffer;
+	unsigned int size, offset;
+	int block;
+
+	if (defragment.packed)
+	{
+		return 0;
+	}
+
+	if (defragment.cursor == -1)
+	{
+		defragment.cursor = allocator.GetNextUsedBlock(-1);
+		defragment.moved = false;
+		if (defragment.cursor == -1)
+		{
+			defragment.packed = true;
+			return 0;
+		}
+	}
+
+	block = defragment.cursor;
+	defragment.cursor = allocator.GetNextUsedBlock(block);
+
+	size = allocator.GetSize(block) * stride;
+	offset = allocator.GetOffset(block) * stride;
+	if (size > m_scratchSize || !allocator.SlideDown(block))
+	{
+		size = 0;
+	}
+
+	if (size > 0)
+	{
+		if (deviceContext && buffer)
+		{
+			scratchBuffer = m_ResourceRegistry->Get(m_scratchBuffer);
+
+			box.left = offset;
+			box.right = offset + size;
+			box.top = 0;
+			box.bottom = 1;
+			box.front = 0;
+			box.back = 1;
+			deviceContext->CopySubresourceRegion(scratchBuffer, 0, 0, 0, 0, buffer, 0, &box);
+
+			box.left = 0;
+			box.right = size;
+			deviceContext->CopySubresourceRegion(buffer, 0, allocator.GetOffset(block) * stride, 0, 0, scratchBuffer, 0, &box);
+		}
+
+		defragment.moved = true;
+	}
+
+//	A walk up the whole buffer that moved nothing means it is packed as far as it will go.
+	if (defragment.cursor == -1 && !defragment.moved)
+	{
+		defragment.packed = true;
+	}
+
+	return size;
+}
+
+void GeometryHeapClass::ResetDefragment()
+{
+	m_vertexDefragment.cursor = -1;
+	m_vertexDefragment.moved = false;
+	m_vertexDefragment.packed = false;
+	m_indexDefragment = m_vertexDefragment;
+
+	return;
+}
+
+int GeometryHeapClass::GetMeshCount()
+{
+	return m_meshCount;
+}
+
+unsigned int GeometryHeapClass::GetUsedVertexCount()
+{
+	return m_vertexAllocator.GetUsedSize();
+}
+
+unsigned int GeometryHeapClass::GetUsedIndexCount()
+{
+	return m_indexAllocator.GetUsedSize();
+}
+
+unsigned int GeometryHeapClass::GetLargestFreeVertexCount()
+{
+	return m_vertexAllocator.GetLargestFreeSize();
+}
+
+unsigned int GeometryHeapClass::GetLargestFreeIndexCount()
+{
+	return m_indexAllocator.GetLargestFreeSize();
+}
@@ -0,0 +1,392 @@
+#include "../Headers/geometrystreamclass.h"
+
+GeometryStreamClass::GeometryStreamClass()
+{
+	int i;
+
+	m_buffer = 0;
+	m_bufferSize = 0;
+	m_mappedData = 0;
+
+	m_cursor = 0;
+	m_overflowed = false;
+	m_limit = 0;
+	m_frameBegin = 0;
+	m_frameBytes = 0;
+	m_frameEnd = 0;
+	m_fenceDue = false;
+	m_discardNext = true;
+
+	for (i = 0; i < GEOMETRY_STREAM_FRAMES; i++)
+	{
+		m_fences[i].query = 0;
+		m_fences[i].begin = 0;
+		m_fences[i].end = 0;
+		m_fences[i].pending = false;
+		m_fences[i].hasRange = false;
+	}
+
+	m_oldestFence = 0;
+	m_fenceCount = 0;
+}
+
+GeometryStreamClass::GeometryStreamClass(const GeometryStreamClass& other)
+{
+
+}
+
+GeometryStreamClass::~GeometryStreamClass()
+{
+
+}
+
+//	Initialize creates the ring buffer and one event query per frame we allow in flight.
+//	The bind flags decide whether the ring holds vertices, indices or instance data.
+bool GeometryStreamClass::Initialize(ID3D11Device* device, unsigned int bufferSize, unsigned int bindFlags)
+{
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_QUERY_DESC queryDesc;
+	HRESULT result;
+	int i;
+
+	m_bufferSize = bufferSize;
+
+//	Setup the description of the dynamic ring buffer. Unlike the static buffers in the ModelClass
+//	this one is written by the CPU every frame so it needs dynamic usage and CPU write access:
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = m_bufferSize;
+	bufferDesc.BindFlags = bindFlags;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &m_buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+//	Create the frame fences. An event query signals once the GPU has processed every command before it:
+	queryDesc.Query = D3D11_QUERY_EVENT;
+	queryDesc.MiscFlags = 0;
+
+	for (i = 0; i < GEOMETRY_STREAM_FRAMES; i++)
+	{
+		result = device->CreateQuery(&queryDesc, &m_fences[i].query);
+		if (FAILED(result))
+		{
+			return false;
+		}
+	}
+
+//	The first map of a dynamic buffer has to discard:
+	m_discardNext = true;
+
+	return true;
+}
+
+void GeometryStreamClass::Shutdown()
+{
+	int i;
+
+//	Release the frame fences:
+	for (i = 0; i < GEOMETRY_STREAM_FRAMES; i++)
+	{
+		if (m_fences[i].query)
+		{
+			m_fences[i].query->Release();
+			m_fences[i].query = 0;
+		}
+	}
+
+//	Release the ring buffer:
+	if (m_buffer)
+	{
+		m_buffer->Release();
+		m_buffer = 0;
+	}
+
+	return;
+}
+
+//	BeginFrame decides where this frame's writes go and maps the buffer. Writers always append with
+//	NO_OVERWRITE, which is only safe as long as we stay out of the regions the fences say are still in
+//	flight. When the space ahead runs low we wrap to the start of the buffer: if the GPU is already done
+//	with that region we keep using NO_OVERWRITE, otherwise we map with WRITE_DISCARD so the driver gives
+//	us fresh memory and the in-flight frames keep reading the old contents.
+bool GeometryStreamClass::BeginFrame(ID3D11DeviceContext* deviceContext)
+{
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	D3D11_MAP mapType;
+	unsigned int head, limit, tail, threshold;
+	bool inFlight, inFlightWraps, wrap;
+	HRESULT result;
+
+//	A frame that was never fenced is fenced now, late but still before any of its range can be handed out again:
+	Fence(deviceContext);
+
+//	Retire every frame the GPU has finished. If all the fences are still busy we have to wait for the
+//	oldest one since we need a free fence for this frame:
+	RetireFrames(deviceContext, m_fenceCount == GEOMETRY_STREAM_FRAMES);
+
+//	Start where the last frame stopped. Reservations that failed may have pushed the cursor past the limit:
+	head = m_cursor.load();
+	if (head > m_limit)
+	{
+		head = m_limit;
+	}
+
+//	Wrap once less than a quarter of the buffer is left, or if the last frame ran out of space:
+	threshold = m_bufferSize / 4;
+	wrap = m_overflowed.load();
+	mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
+
+	inFlight = FindInFlightTail(tail, inFlightWraps);
+	if (!inFlight)
+	{
+//	Nothing written to this buffer is in flight, so the whole buffer is free:
+		limit = m_bufferSize;
+		if (wrap || (m_bufferSize - head) < threshold)
+		{
+			head = 0;
+		}
+	}
+	else if (!inFlightWraps && tail <= head)
+	{
+//	The in-flight data sits behind us in [tail, head), so we may write up to the end of the buffer:
+		limit = m_bufferSize;
+		if (wrap || (m_bufferSize - head) < threshold)
+		{
+			if (tail >= threshold)
+			{
+				head = 0;
+				limit = tail;
+			}
+			else
+			{
+				m_discardNext = true;
+			}
+		}
+	}
+	else
+	{
+//	We already wrapped and the in-flight data lies ahead of us, so stop where it starts:
+		limit = tail;
+		if (wrap || (tail - head) < threshold)
+		{
+			m_discardNext = true;
+		}
+	}
+
+	if (m_discardNext)
+	{
+		mapType = D3D11_MAP_WRITE_DISCARD;
+		head = 0;
+		limit = m_bufferSize;
+		DropRanges();
+	}
+
+//	Lock the ring buffer so it can be written to:
+	result = deviceContext->Map(m_buffer, 0, mapType, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_mappedData = (unsigned char*)mappedResource.pData;
+	m_frameBegin = head;
+	m_limit = limit;
+	m_discardNext = false;
+	m_overflowed.store(false);
+	m_cursor.store(head);
+
+	return true;
+}
+
+//	EndFrame unlocks the buffer and remembers the range this frame wrote for its fence. It has to be called
+//	before any draw that uses the data since a mapped buffer cannot be bound.
+void GeometryStreamClass::EndFrame(ID3D11DeviceContext* deviceContext)
+{
+	unsigned int end;
+
+	if (!m_mappedData)
+	{
+		m_frameBytes = 0;
+		return;
+	}
+
+//	Unlock the ring buffer:
+	deviceContext->Unmap(m_buffer, 0);
+	m_mappedData = 0;
+
+	end = m_cursor.load();
+	if (end > m_limit)
+	{
+		end = m_limit;
+	}
+	m_cursor.store(end);
+	m_frameBytes = end - m_frameBegin;
+
+//	Frames that did not write anything do not need a fence:
+	m_frameEnd = end;
+	m_fenceDue = (end != m_frameBegin);
+
+	return;
+}
+
+//	Fence records the range the last ended frame used and issues its fence. The query signals once the GPU
+//	has processed every command before it, so it has to come after the last draw that reads the range, or
+//	the range would be handed out again while those draws are still in flight.
+void GeometryStreamClass::Fence(ID3D11DeviceContext* deviceContext)
+{
+	int fence;
+
+	if (!m_fenceDue)
+	{
+		return;
+	}
+
+	fence = (m_oldestFence + m_fenceCount) % GEOMETRY_STREAM_FRAMES;
+	m_fences[fence].begin = m_frameBegin;
+	m_fences[fence].end = m_frameEnd;
+	m_fences[fence].pending = true;
+	m_fences[fence].hasRange = true;
+	m_fenceCount++;
+	m_fenceDue = false;
+
+	deviceContext->End(m_fences[fence].query);
+
+	return;
+}
+
+//	Reserve may be called from any thread between BeginFrame and EndFrame. It rounds the cursor up to the
+//	requested alignment (use the vertex stride so the offset can be turned into a start vertex) and bumps
+//	it with a compare-exchange, so two writers can never be handed overlapping space.
+void* GeometryStreamClass::Reserve(unsigned int size, unsigned int alignment, unsigned int& offset)
+{
+	unsigned int current, aligned;
+
+	if (!m_mappedData)
+	{
+		return 0;
+	}
+
+	if (alignment == 0)
+	{
+		alignment = 1;
+	}
+
+	current = m_cursor.load(memory_order_relaxed);
+	do
+	{
+		aligned = ((current + alignment - 1) / alignment) * alignment;
+		if (aligned < current || aligned + size < aligned || aligned + size > m_limit)
+		{
+//	Out of space for this frame. Remember it so the next frame wraps around:
+			m_overflowed.store(true, memory_order_relaxed);
+			return 0;
+		}
+	} while (!m_cursor.compare_exchange_weak(current, aligned + size, memory_order_relaxed));
+
+	offset = aligned;
+
+	return m_mappedData + aligned;
+}
+
+ID3D11Buffer* GeometryStreamClass::GetBuffer()
+{
+	return m_buffer;
+}
+
+unsigned int GeometryStreamClass::GetBufferSize()
+{
+	return m_bufferSize;
+}
+
+unsigned int GeometryStreamClass::GetFrameBytes()
+{
+	return m_frameBytes;
+}
+
+//	RetireFrames polls the fences from the oldest onwards and frees the ones the GPU has passed.
+//	The DONOTFLUSH flag keeps the poll cheap, the blocking wait is only used when every fence is busy.
+void GeometryStreamClass::RetireFrames(ID3D11DeviceContext* deviceContext, bool waitForOldest)
+{
+	HRESULT result;
+	FrameFenceType* fence;
+
+	while (m_fenceCount > 0)
+	{
+		fence = &m_fences[m_oldestFence];
+
+		if (waitForOldest)
+		{
+			do
+			{
+				result = deviceContext->GetData(fence->query, NULL, 0, 0);
+			} while (result == S_FALSE);
+			waitForOldest = false;
+		}
+		else
+		{
+			result = deviceContext->GetData(fence->query, NULL, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH);
+		}
+
+		if (result != S_OK)
+		{
+			break;
+		}
+
+		fence->pending = false;
+		fence->hasRange = false;
+
+		m_oldestFence = (m_oldestFence + 1) % GEOMETRY_STREAM_FRAMES;
+		m_fenceCount--;
+	}
+
+	return;
+}
+
+//	After a discard the in-flight frames read from memory the driver has already swapped out, so their
+//	ranges no longer restrict us. Their fences stay pending until the GPU passes them.
+void GeometryStreamClass::DropRanges()
+{
+	int i;
+
+	for (i = 0; i < GEOMETRY_STREAM_FRAMES; i++)
+	{
+		m_fences[i].hasRange = false;
+	}
+
+	return;
+}
+
+//	The tail of the ring is the start of the oldest frame the GPU may still be reading. The in-flight data
+//	runs from there to the end of the newest frame, and wraps if the newest frame starts before the tail.
+bool GeometryStreamClass::FindInFlightTail(unsigned int& tail, bool& wraps)
+{
+	int i, fence;
+	bool found;
+
+	found = false;
+	wraps = false;
+
+	for (i = 0; i < m_fenceCount; i++)
+	{
+		fence = (m_oldestFence + i) % GEOMETRY_STREAM_FRAMES;
+		if (m_fences[fence].hasRange)
+		{
+			if (!found)
+			{
+				tail = m_fences[fence].begin;
+				found = true;
+			}
+			else if (m_fences[fence].begin < tail)
+			{
+				wraps = true;
+			}
+		}
+	}
+
+	return found;
+}
@@ -0,0 +1,274 @@
+#include "../Headers/imagecompareclass.h"
+
+#include <math.h>
+#include <string.h>
+
+//	The largest possible weighted YIQ difference, between black and white.
+const float IMAGE_MAX_YIQ_DELTA = 35215.0f;
+
+ImageCompareClass::ImageCompareClass()
+{
+}
+
+ImageCompareClass::ImageCompareClass(const ImageCompareClass& other)
+{
+}
+
+ImageCompareClass::~ImageCompareClass()
+{
+}
+
+//	LoadTarga reads an uncompressed 24 or 32 bit targa file into an RGBA image.
+bool ImageCompareClass::LoadTarga(const char* filename, ImageType& image)
+{
+	FILE* filePtr;
+	unsigned char header[18];
+	vector<unsigned char> data;
+	int error, bpp, bytesPerPixel, x, y, sourceRow, source, destination;
+	unsigned long long count;
+	bool topDown;
+
+//	Open the targa file for reading in binary:
+	error = fopen_s(&filePtr, filename, "rb");
+	if (error != 0)
+	{
+		return false;
+	}
+
+//	Read in the file header:
+	count = fread(header, 1, sizeof(header), filePtr);
+	if (count != sizeof(header))
+	{
+		fclose(filePtr);
+		return false;
+	}
+
+//	Only uncompressed true color images are supported:
+	bpp = header[16];
+	if (header[2] != 2 || (bpp != 24 && bpp != 32))
+	{
+		fclose(filePtr);
+		return false;
+	}
+
+	image.width = header[12] | (header[13] << 8);
+	image.height = header[14] | (header[15] << 8);
+	topDown = (header[17] & 0x20) != 0;
+	bytesPerPixel = bpp / 8;
+
+//	Skip the image id and read in the pixel data:
+	fseek(filePtr, 18 + header[0], SEEK_SET);
+
+	data.resize((size_t)image.width * image.height * bytesPerPixel);
+	count = fread(data.data(), 1, data.size(), filePtr);
+	fclose(filePtr);
+	if (count != data.size())
+	{
+		return false;
+	}
+
+//	Targa stores BGR(A) and by default starts at the bottom row, so flip both into our layout:
+	image.pixels.resize((size_t)image.width * image.height * 4);
+	for (y = 0; y < image.height; y++)
+	{
+		sourceRow = topDown ? y : (image.height - 1 - y);
+		for (x = 0; x < image.width; x++)
+		{
+			source = (sourceRow * image.width + x) * bytesPerPixel;
+			destination = (y * image.width + x) * 4;
+
+			image.pixels[destination + 0] = data[source + 2];
+			image.pixels[destination + 1] = data[source + 1];
+			image.pixels[destination + 2] = data[source + 0];
+			image.pixels[destination + 3] = (bytesPerPixel == 4) ? data[source + 3] : 255;
+		}
+	}
+
+	return true;
+}
+
+//	SaveTarga writes the image as an uncompressed 32 bit top-down targa file.
+bool ImageCompareClass::SaveTarga(const char* filename, const ImageType& image)
+{
+	FILE* filePtr;
+	unsigned char header[18];
+	vector<unsigned char> data;
+	unsigned long long count, i;
+	int error;
+
+	memset(header, 0, sizeof(header));
+	header[2] = 2;
+	header[12] = (unsigned char)(image.width & 0xFF);
+	header[13] = (unsigned char)((image.width >> 8) & 0xFF);
+	header[14] = (unsigned char)(image.height & 0xFF);
+	header[15] = (unsigned char)((image.height >> 8) & 0xFF);
+	header[16] = 32;
+	header[17] = 0x20 | 8;
+
+//	Swap RGBA into the BGRA order targa expects:
+	data.resize(image.pixels.size());
+	for (i = 0; i + 3 < data.size(); i += 4)
+	{
+		data[i + 0] = image.pixels[i + 2];
+		data[i + 1] = image.pixels[i + 1];
+		data[i + 2] = image.pixels[i + 0];
+		data[i + 3] = image.pixels[i + 3];
+	}
+
+//	Open the file for writing in binary:
+	error = fopen_s(&filePtr, filename, "wb");
+	if (error != 0)
+	{
+		return false;
+	}
+
+	count = fwrite(header, 1, sizeof(header), filePtr);
+	count += fwrite(data.data(), 1, data.size(), filePtr);
+	fclose(filePtr);
+
+	return count == sizeof(header) + data.size();
+}
+
+//	Compare counts the pixels of the result that are perceptibly different from the golden image.
+//	The threshold is the largest accepted color difference between 0 and 1, and the test passes if the
+//	share of different pixels is at most maxDifferentRatio. If a diff image is given the different
+//	pixels are painted red in it over a faded copy of the golden image.
+bool ImageCompareClass::Compare(const ImageType& result, const ImageType& golden, float threshold, float maxDifferentRatio,
+	CompareResultType& compareResult, ImageType* diff)
+{
+	float delta, limit, gray;
+	int x, y, index;
+
+	compareResult.differentPixels = 0;
+	compareResult.differentRatio = 1.0f;
+	compareResult.maxDelta = 0.0f;
+	compareResult.passed = false;
+
+//	Images of different size never match:
+	if (result.width != golden.width || result.height != golden.height || result.width <= 0 || result.height <= 0)
+	{
+		return false;
+	}
+
+	if (diff)
+	{
+		diff->width = golden.width;
+		diff->height = golden.height;
+		diff->pixels.resize(golden.pixels.size());
+	}
+
+	limit = threshold * threshold;
+
+	for (y = 0; y < result.height; y++)
+	{
+		for (x = 0; x < result.width; x++)
+		{
+			index = (y * result.width + x) * 4;
+
+//	Try the pixel at the same position first since that is by far the most common match:
+			delta = ColorDelta(&result.pixels[index], &golden.pixels[index]);
+			if (delta > limit)
+			{
+				delta = NeighbourDelta(result, golden, x, y);
+			}
+
+			if (delta > compareResult.maxDelta)
+			{
+				compareResult.maxDelta = delta;
+			}
+
+			if (delta > limit)
+			{
+				compareResult.differentPixels++;
+			}
+
+			if (diff)
+			{
+				if (delta > limit)
+				{
+					diff->pixels[index + 0] = 255;
+					diff->pixels[index + 1] = 0;
+					diff->pixels[index + 2] = 0;
+				}
+				else
+				{
+					gray = 0.299f * golden.pixels[index + 0] + 0.587f * golden.pixels[index + 1] + 0.114f * golden.pixels[index + 2];
+					diff->pixels[index + 0] = (unsigned char)(255.0f - (255.0f - gray) * 0.1f);
+					diff->pixels[index + 1] = diff->pixels[index + 0];
+					diff->pixels[index + 2] = diff->pixels[index + 0];
+				}
+				diff->pixels[index + 3] = 255;
+			}
+		}
+	}
+
+	compareResult.maxDelta = sqrtf(compareResult.maxDelta);
+	compareResult.differentRatio = (float)compareResult.differentPixels / (float)(result.width * result.height);
+	compareResult.passed = compareResult.differentRatio <= maxDifferentRatio;
+
+	return true;
+}
+
+//	ColorDelta returns the weighted YIQ distance between two pixels, normalized to 0..1 squared.
+//	Alpha is blended against white first so transparent pixels of any color compare as equal.
+float ImageCompareClass::ColorDelta(const unsigned char* a, const unsigned char* b)
+{
+	float ra, ga, ba, rb, gb, bb, alphaA, alphaB;
+	float y, i, q;
+
+	alphaA = a[3] / 255.0f;
+	alphaB = b[3] / 255.0f;
+
+	ra = 255.0f + (a[0] - 255.0f) * alphaA;
+	ga = 255.0f + (a[1] - 255.0f) * alphaA;
+	ba = 255.0f + (a[2] - 255.0f) * alphaA;
+	rb = 255.0f + (b[0] - 255.0f) * alphaB;
+	gb = 255.0f + (b[1] - 255.0f) * alphaB;
+	bb = 255.0f + (b[2] - 255.0f) * alphaB;
+
+	y = (ra - rb) * 0.29889531f + (ga - gb) * 0.58662247f + (ba - bb) * 0.11448223f;
+	i = (ra - rb) * 0.59597799f - (ga - gb) * 0.27417610f - (ba - bb) * 0.32180189f;
+	q = (ra - rb) * 0.21147017f - (ga - gb) * 0.52261711f + (ba - bb) * 0.31114694f;
+
+	return (0.5053f * y * y + 0.299f * i * i + 0.1957f * q * q) / IMAGE_MAX_YIQ_DELTA;
+}
+
+//	NeighbourDelta returns the smallest difference between the result pixel and the golden pixels around it,
+//	and between the golden pixel and the result pixels around it, so an edge that moved by one pixel in
+//	either direction is not reported.
+float ImageCompareClass::NeighbourDelta(const ImageType& result, const ImageType& golden, int x, int y)
+{
+	float best, forward, backward;
+	int dx, dy, nx, ny, index, neighbour;
+
+	index = (y * result.width + x) * 4;
+	best = 1.0f;
+
+	for (dy = -1; dy <= 1; dy++)
+	{
+		for (dx = -1; dx <= 1; dx++)
+		{
+			nx = x + dx;
+			ny = y + dy;
+			if (nx < 0 || ny < 0 || nx >= result.width || ny >= result.height)
+			{
+				continue;
+			}
+
+			neighbour = (ny * result.width + nx) * 4;
+			forward = ColorDelta(&result.pixels[index], &golden.pixels[neighbour]);
+			backward = ColorDelta(&golden.pixels[index], &result.pixels[neighbour]);
+
+			if (forward < best)
+			{
+				best = forward;
+			}
+			if (backward < best)
+			{
+				best = backward;
+			}
+		}
+	}
+
+	return best;
+}
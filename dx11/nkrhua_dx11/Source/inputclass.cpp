@@ -24,6 +24,10 @@ void InputClass::Initialize()
 		m_keys[i] = false;
 	}
 
+	m_mouseX = 0;
+	m_mouseY = 0;
+	m_mouseButton = false;
+
 	return;
 }
 
@@ -42,4 +46,35 @@ void InputClass::KeyUp(unsigned int input)
 bool InputClass::IsKeyDown(unsigned int key)
 {
 	return m_keys[key];
+}
+
+void InputClass::MouseMove(int x, int y)
+{
+	m_mouseX = x;
+	m_mouseY = y;
+	return;
+}
+
+void InputClass::MouseButtonDown()
+{
+	m_mouseButton = true;
+	return;
+}
+
+void InputClass::MouseButtonUp()
+{
+	m_mouseButton = false;
+	return;
+}
+
+void InputClass::GetMousePosition(int& x, int& y)
+{
+	x = m_mouseX;
+	y = m_mouseY;
+	return;
+}
+
+bool InputClass::IsMouseButtonDown()
+{
+	return m_mouseButton;
 }
\ No newline at end of file
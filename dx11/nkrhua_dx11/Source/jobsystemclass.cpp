@@ -0,0 +1,171 @@
+#include "../Headers/jobsystemclass.h"
+
+JobSystemClass::JobSystemClass()
+{
+	m_job = 0;
+	m_count = 0;
+	m_batchSize = 1;
+	m_nextIndex = 0;
+	m_busyWorkers = 0;
+	m_generation = 0;
+	m_quit = false;
+}
+
+JobSystemClass::JobSystemClass(const JobSystemClass& other)
+{
+
+}
+
+JobSystemClass::~JobSystemClass()
+{
+
+}
+
+bool JobSystemClass::Initialize(int threadCount)
+{
+	int i;
+
+	if (threadCount <= 0)
+	{
+		threadCount = (int)thread::hardware_concurrency() - 1;
+	}
+
+	m_quit = false;
+	for (i = 0; i < threadCount; i++)
+	{
+		m_threads.push_back(thread(&JobSystemClass::WorkerThread, this));
+	}
+
+	return true;
+}
+
+void JobSystemClass::Shutdown()
+{
+	unsigned int i;
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+	m_threads.clear();
+
+	return;
+}
+
+//	ParallelFor calls the job with ranges [begin, end) of at most batchSize items until all count items
+//	are done. Workers that woke up for the call are waited for as well before returning, so none of them
+//	can still be holding on to the job when the next ParallelFor starts.
+void JobSystemClass::ParallelFor(int count, int batchSize, const function<void(int, int)>& job)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	if (batchSize < 1)
+	{
+		batchSize = 1;
+	}
+
+//	Small ranges and machines without workers just run on this thread:
+	if (m_threads.empty() || count <= batchSize)
+	{
+		job(0, count);
+		return;
+	}
+
+//	A call from another thread waits here until the one running has finished:
+	lock_guard<mutex> callLock(m_callMutex);
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_job = &job;
+		m_count = count;
+		m_batchSize = batchSize;
+		m_nextIndex = 0;
+		m_generation++;
+	}
+	m_wakeCondition.notify_all();
+
+	RunBatches(&job, count, batchSize);
+
+	{
+		unique_lock<mutex> lock(m_mutex);
+		m_doneCondition.wait(lock, [this] { return m_busyWorkers == 0; });
+		m_job = 0;
+	}
+
+	return;
+}
+
+//	GetThreadCount returns the number of threads that run jobs, including the calling thread.
+int JobSystemClass::GetThreadCount()
+{
+	return (int)m_threads.size() + 1;
+}
+
+void JobSystemClass::WorkerThread()
+{
+	const function<void(int, int)>* job;
+	unsigned int generation;
+	int count, batchSize;
+
+	generation = 0;
+
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_wakeCondition.wait(lock, [this, generation] { return m_quit || (m_job && m_generation != generation); });
+
+			if (m_quit)
+			{
+				return;
+			}
+
+			generation = m_generation;
+			job = m_job;
+			count = m_count;
+			batchSize = m_batchSize;
+			m_busyWorkers++;
+		}
+
+		RunBatches(job, count, batchSize);
+
+		{
+			lock_guard<mutex> lock(m_mutex);
+			m_busyWorkers--;
+		}
+		m_doneCondition.notify_one();
+	}
+}
+
+void JobSystemClass::RunBatches(const function<void(int, int)>* job, int count, int batchSize)
+{
+	int begin, end;
+
+	while (true)
+	{
+		begin = m_nextIndex.fetch_add(batchSize);
+		if (begin >= count)
+		{
+			break;
+		}
+
+		end = begin + batchSize;
+		if (end > count)
+		{
+			end = count;
+		}
+
+		(*job)(begin, end);
+	}
+
+	return;
+}
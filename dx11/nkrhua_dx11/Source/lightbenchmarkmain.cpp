@@ -0,0 +1,92 @@
+//	The light benchmark culls the lights of the scene, point and spot lights circling above the terrain, into
+//	the clusters of a Light Cluster over and over from the starting view of the camera, without a window or a
+//	device, and prints the fastest, average and slowest time along with the size of the lists. It is not part
+//	of the engine's project and is built on its own, for example from a developer command prompt with:
+//	cl /O2 /EHsc Source\lightbenchmarkmain.cpp Source\lightclusterclass.cpp Source\jobsystemclass.cpp
+//	and run as: lightbenchmark [lights] [frames]
+#include "../Headers/lightclusterclass.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char* argv[])
+{
+	JobSystemClass jobSystem;
+	LightClusterClass lightCluster;
+	vector<LightClusterClass::LightType> lights;
+	LightClusterClass::LightType* light;
+	XMMATRIX viewMatrix;
+	unsigned int seed;
+	float time, fastest, slowest, total;
+	int lightCount, frameCount, i;
+
+	lightCount = argc > 1 ? atoi(argv[1]) : 4096;
+	frameCount = argc > 2 ? atoi(argv[2]) : 1000;
+	if (lightCount <= 0 || frameCount <= 0)
+	{
+		fprintf(stderr, "usage: %s [lights] [frames]\n", argv[0]);
+		return 1;
+	}
+
+	jobSystem.Initialize(0);
+
+	if (!lightCluster.Initialize(NULL, lightCount))
+	{
+		fprintf(stderr, "Could not set aside room for %d lights\n", lightCount);
+		return 1;
+	}
+
+//	The lights are placed like the ones of the scene, every fourth one a spot light pointing down:
+	seed = 7;
+	auto random = [&seed]()
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (float)(seed >> 8) / 16777216.0f;
+	};
+
+	lights.resize(lightCount);
+	for (i = 0; i < lightCount; i++)
+	{
+		light = &lights[i];
+		light->position = XMFLOAT3(-80.0f + 160.0f * random(), -45.0f + 40.0f * random(), 160.0f * random());
+		light->range = 6.0f + 10.0f * random();
+		light->color = XMFLOAT3(0.3f + 0.7f * random(), 0.3f + 0.7f * random(), 0.3f + 0.7f * random());
+		light->direction = XMFLOAT3(0.0f, -1.0f, 0.0f);
+
+		if (i % 4 == 0)
+		{
+			light->outerCosine = 0.8f;
+			light->innerCosine = 0.9f;
+		}
+		else
+		{
+			light->outerCosine = -2.0f;
+			light->innerCosine = -2.0f;
+		}
+	}
+
+//	The camera of the scene starts five units back from the origin, looking down the z axis:
+	viewMatrix = XMMatrixLookToLH(XMVectorSet(0.0f, 0.0f, -5.0f, 1.0f), XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+
+	fastest = 1.0e9f;
+	slowest = 0.0f;
+	total = 0.0f;
+	for (i = 0; i < frameCount; i++)
+	{
+		lightCluster.Cull(&jobSystem, lights.data(), lightCount, viewMatrix);
+
+		time = lightCluster.GetCullTime();
+		fastest = (time < fastest) ? time : fastest;
+		slowest = (time > slowest) ? time : slowest;
+		total += time;
+	}
+
+	printf("%d lights, %d clusters, %d threads: %.3f ms fastest, %.3f ms average, %.3f ms slowest, %d indices, %d dropped\n", lightCount,
+		LIGHT_CLUSTER_COUNT, jobSystem.GetThreadCount(), fastest, total / (float)frameCount, slowest, lightCluster.GetLightIndexCount(),
+		lightCluster.GetDroppedLightCount());
+
+	lightCluster.Shutdown();
+	jobSystem.Shutdown();
+
+	return 0;
+}
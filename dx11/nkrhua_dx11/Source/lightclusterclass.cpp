@@ -0,0 +1,662 @@
+#include "../Headers/lightclusterclass.h"
+
+#include <math.h>
+#include <string.h>
+#include <chrono>
+
+LightClusterClass::LightClusterClass()
+{
+	m_maxLights = 0;
+	m_projectionX = 1.0f;
+	m_projectionY = 1.0f;
+	m_nearZ = 1.0f;
+	m_farZ = 2.0f;
+	m_sliceScale = 0.0f;
+	m_sliceBias = 0.0f;
+	m_screenWidth = 1;
+	m_screenHeight = 1;
+	m_ambient = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	m_lights = 0;
+	m_lightCount = 0;
+	m_droppedCount = 0;
+	m_clusterBuffer = 0;
+	m_clusterListBuffer = 0;
+	m_indexBuffer = 0;
+	m_lightBuffer = 0;
+	m_clusterListView = 0;
+	m_indexView = 0;
+	m_lightView = 0;
+	m_cullTime = 0.0f;
+}
+
+LightClusterClass::LightClusterClass(const LightClusterClass& other)
+{
+
+}
+
+LightClusterClass::~LightClusterClass()
+{
+
+}
+
+//	Initialize sets aside room for the given number of lights. Without a device the buffers on the video
+//	card are not created and Render must not be called.
+bool LightClusterClass::Initialize(ID3D11Device* device, int maxLights)
+{
+	bool result;
+
+	if (maxLights <= 0 || maxLights > 65536)
+	{
+		return false;
+	}
+
+	m_maxLights = maxLights;
+
+	m_viewLights.resize(m_maxLights);
+	m_lightBounds.resize(m_maxLights);
+
+	m_columnMinimum.resize(LIGHT_CLUSTER_Z * LIGHT_CLUSTER_X / 4);
+	m_columnMaximum.resize(LIGHT_CLUSTER_Z * LIGHT_CLUSTER_X / 4);
+	m_rowBoundsY.resize(LIGHT_CLUSTER_Z * LIGHT_CLUSTER_Y);
+	m_sliceBoundsZ.resize(LIGHT_CLUSTER_Z);
+	m_sliceOffsets.resize(LIGHT_CLUSTER_Z + 1);
+
+	m_clusterLights.resize(LIGHT_CLUSTER_COUNT * LIGHT_CLUSTER_MAX_LIGHTS);
+	m_clusterCounts.resize(LIGHT_CLUSTER_COUNT);
+	m_clusters.resize(LIGHT_CLUSTER_COUNT);
+	m_lightIndices.reserve(LIGHT_CLUSTER_MAX_INDICES);
+
+	if (device)
+	{
+		result = InitializeBuffers(device);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void LightClusterClass::Shutdown()
+{
+	ShutdownBuffers();
+
+	m_viewLights.clear();
+	m_lightBounds.clear();
+	m_sliceLights.clear();
+	m_clusterLights.clear();
+	m_clusterCounts.clear();
+	m_clusters.clear();
+	m_lightIndices.clear();
+
+	return;
+}
+
+//	SetProjection works out the view space bounds of every cluster from a perspective projection matrix
+//	and the size of the screen in pixels. The near and far planes are read back from the matrix.
+void LightClusterClass::SetProjection(XMMATRIX projectionMatrix, int screenWidth, int screenHeight)
+{
+	XMFLOAT4X4 projection;
+	XMFLOAT4A* minimum;
+	XMFLOAT4A* maximum;
+	float nearZ, farZ, left, right, top, bottom;
+	int slice, column, row;
+
+	XMStoreFloat4x4(&projection, projectionMatrix);
+
+	m_projectionX = projection._11;
+	m_projectionY = projection._22;
+	m_nearZ = -projection._43 / projection._33;
+	m_farZ = projection._43 / (1.0f - projection._33);
+	m_screenWidth = screenWidth;
+	m_screenHeight = screenHeight;
+
+//	The slices are spaced evenly in the logarithm of the depth:
+	m_sliceScale = (float)LIGHT_CLUSTER_Z / logf(m_farZ / m_nearZ);
+	m_sliceBias = -m_sliceScale * logf(m_nearZ);
+
+	for (slice = 0; slice < LIGHT_CLUSTER_Z; slice++)
+	{
+		nearZ = m_nearZ * powf(m_farZ / m_nearZ, (float)slice / (float)LIGHT_CLUSTER_Z);
+		farZ = m_nearZ * powf(m_farZ / m_nearZ, (float)(slice + 1) / (float)LIGHT_CLUSTER_Z);
+		m_sliceBoundsZ[slice] = XMFLOAT2(nearZ, farZ);
+
+//	A tile edge is a plane through the eye, so in view space it is furthest out at the far end of the slice
+//	and furthest in at the near end:
+		for (column = 0; column < LIGHT_CLUSTER_X; column++)
+		{
+			left = -1.0f + 2.0f * (float)column / (float)LIGHT_CLUSTER_X;
+			right = -1.0f + 2.0f * (float)(column + 1) / (float)LIGHT_CLUSTER_X;
+
+			minimum = &m_columnMinimum[slice * LIGHT_CLUSTER_X / 4 + column / 4];
+			maximum = &m_columnMaximum[slice * LIGHT_CLUSTER_X / 4 + column / 4];
+			(&minimum->x)[column % 4] = left * ((left < 0.0f) ? farZ : nearZ) / m_projectionX;
+			(&maximum->x)[column % 4] = right * ((right > 0.0f) ? farZ : nearZ) / m_projectionX;
+		}
+
+//	Rows count down from the top of the screen like pixels do:
+		for (row = 0; row < LIGHT_CLUSTER_Y; row++)
+		{
+			top = 1.0f - 2.0f * (float)row / (float)LIGHT_CLUSTER_Y;
+			bottom = 1.0f - 2.0f * (float)(row + 1) / (float)LIGHT_CLUSTER_Y;
+
+			m_rowBoundsY[slice * LIGHT_CLUSTER_Y + row] = XMFLOAT2(bottom * ((bottom < 0.0f) ? farZ : nearZ) / m_projectionY,
+				top * ((top > 0.0f) ? farZ : nearZ) / m_projectionY);
+		}
+	}
+
+	return;
+}
+
+//	SetScreenSize changes the size in pixels the scene is drawn at without changing the projection, which the
+//	bounds of the clusters depend on. It takes effect at the next Render.
+void LightClusterClass::SetScreenSize(int screenWidth, int screenHeight)
+{
+	m_screenWidth = screenWidth;
+	m_screenHeight = screenHeight;
+
+	return;
+}
+
+//	The ambient light is added to the clustered lights of every pixel.
+void LightClusterClass::SetAmbient(XMFLOAT3 ambient)
+{
+	m_ambient = ambient;
+	return;
+}
+
+//	Cull assigns the lights to the clusters of the view. The light array has to stay valid until Cull
+//	returns, lights past the maximum given to Initialize are ignored.
+void LightClusterClass::Cull(JobSystemClass* jobSystem, const LightType* lights, int lightCount, XMMATRIX viewMatrix)
+{
+	chrono::high_resolution_clock::time_point startTime;
+	ClusterType* cluster;
+	int i, slice, count, stored;
+
+	startTime = chrono::high_resolution_clock::now();
+
+	m_lights = lights;
+	m_lightCount = (lightCount < m_maxLights) ? lightCount : m_maxLights;
+
+//	Move the lights into view space and find the clusters they might reach:
+	jobSystem->ParallelFor(m_lightCount, LIGHT_CLUSTER_LIGHT_BATCH_SIZE, [this, viewMatrix](int begin, int end)
+	{
+		BoundLights(begin, end, viewMatrix);
+	});
+
+//	Sort the lights into buckets by slice, so a row of clusters only looks at the lights of its slice. A
+//	light goes into every slice it overlaps:
+	for (slice = 0; slice <= LIGHT_CLUSTER_Z; slice++)
+	{
+		m_sliceOffsets[slice] = 0;
+	}
+
+	for (i = 0; i < m_lightCount; i++)
+	{
+		for (slice = m_lightBounds[i].minimumZ; slice <= m_lightBounds[i].maximumZ; slice++)
+		{
+			m_sliceOffsets[slice + 1]++;
+		}
+	}
+
+	for (slice = 0; slice < LIGHT_CLUSTER_Z; slice++)
+	{
+		m_sliceOffsets[slice + 1] += m_sliceOffsets[slice];
+	}
+
+	m_sliceLights.resize(m_sliceOffsets[LIGHT_CLUSTER_Z]);
+	for (i = 0; i < m_lightCount; i++)
+	{
+		for (slice = m_lightBounds[i].minimumZ; slice <= m_lightBounds[i].maximumZ; slice++)
+		{
+			m_sliceLights[m_sliceOffsets[slice]++] = i;
+		}
+	}
+
+//	Filling the buckets moved every offset to the start of the next slice, so shift them back:
+	for (slice = LIGHT_CLUSTER_Z; slice > 0; slice--)
+	{
+		m_sliceOffsets[slice] = m_sliceOffsets[slice - 1];
+	}
+	m_sliceOffsets[0] = 0;
+
+//	Test the lights against the clusters, every row on its own so the threads never share a cluster:
+	jobSystem->ParallelFor(LIGHT_CLUSTER_Z * LIGHT_CLUSTER_Y, LIGHT_CLUSTER_ROW_BATCH_SIZE, [this](int begin, int end)
+	{
+		CullRows(begin, end);
+	});
+
+//	Pack the lists of all clusters one after the other:
+	m_lightIndices.clear();
+	m_droppedCount = 0;
+	for (i = 0; i < LIGHT_CLUSTER_COUNT; i++)
+	{
+		count = m_clusterCounts[i];
+		stored = (count < LIGHT_CLUSTER_MAX_LIGHTS) ? count : LIGHT_CLUSTER_MAX_LIGHTS;
+		if (stored > LIGHT_CLUSTER_MAX_INDICES - (int)m_lightIndices.size())
+		{
+			stored = LIGHT_CLUSTER_MAX_INDICES - (int)m_lightIndices.size();
+		}
+
+		cluster = &m_clusters[i];
+		cluster->offset = (unsigned int)m_lightIndices.size();
+		cluster->count = (unsigned int)stored;
+
+		m_lightIndices.insert(m_lightIndices.end(), m_clusterLights.begin() + i * LIGHT_CLUSTER_MAX_LIGHTS,
+			m_clusterLights.begin() + i * LIGHT_CLUSTER_MAX_LIGHTS + stored);
+		m_droppedCount += count - stored;
+	}
+
+	m_cullTime = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+
+	return;
+}
+
+//	Render copies the lights, the cluster lists and the light indices of the last Cull to the video card
+//	and binds them to the pixel shader, the constant buffer to slot 0 and the lists to slots 1 to 3.
+bool LightClusterClass::Render(ID3D11DeviceContext* deviceContext)
+{
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	ClusterBufferType* clusterData;
+	ID3D11ShaderResourceView* views[3];
+
+	result = deviceContext->Map(m_clusterBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	clusterData = (ClusterBufferType*)mappedResource.pData;
+	clusterData->tileScale = XMFLOAT4((float)LIGHT_CLUSTER_X / (float)m_screenWidth, (float)LIGHT_CLUSTER_Y / (float)m_screenHeight,
+		(float)LIGHT_CLUSTER_X, (float)LIGHT_CLUSTER_Y);
+	clusterData->depthScale = XMFLOAT4(m_sliceScale, m_sliceBias, (float)LIGHT_CLUSTER_Z, 0.0f);
+	clusterData->ambient = XMFLOAT4(m_ambient.x, m_ambient.y, m_ambient.z, 1.0f);
+
+	deviceContext->Unmap(m_clusterBuffer, 0);
+
+	result = deviceContext->Map(m_clusterListBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	memcpy(mappedResource.pData, m_clusters.data(), sizeof(ClusterType) * LIGHT_CLUSTER_COUNT);
+
+	deviceContext->Unmap(m_clusterListBuffer, 0);
+
+	result = deviceContext->Map(m_indexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	memcpy(mappedResource.pData, m_lightIndices.data(), sizeof(unsigned int) * m_lightIndices.size());
+
+	deviceContext->Unmap(m_indexBuffer, 0);
+
+	result = deviceContext->Map(m_lightBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	memcpy(mappedResource.pData, m_viewLights.data(), sizeof(LightType) * m_lightCount);
+
+	deviceContext->Unmap(m_lightBuffer, 0);
+
+	views[0] = m_clusterListView;
+	views[1] = m_indexView;
+	views[2] = m_lightView;
+
+	deviceContext->PSSetConstantBuffers(0, 1, &m_clusterBuffer);
+	deviceContext->PSSetShaderResources(1, 3, views);
+
+	return true;
+}
+
+//	GetClusterLightCount and GetClusterLights return the list of the cluster at the given column, row and
+//	slice after the last Cull. The light indices are the positions in the array Cull was given.
+int LightClusterClass::GetClusterLightCount(int x, int y, int z)
+{
+	return (int)m_clusters[(z * LIGHT_CLUSTER_Y + y) * LIGHT_CLUSTER_X + x].count;
+}
+
+const unsigned int* LightClusterClass::GetClusterLights(int x, int y, int z)
+{
+	return m_lightIndices.data() + m_clusters[(z * LIGHT_CLUSTER_Y + y) * LIGHT_CLUSTER_X + x].offset;
+}
+
+int LightClusterClass::GetLightIndexCount()
+{
+	return (int)m_lightIndices.size();
+}
+
+//	The number of times a light was left out of a cluster it reached because a list was full.
+int LightClusterClass::GetDroppedLightCount()
+{
+	return m_droppedCount;
+}
+
+float LightClusterClass::GetCullTime()
+{
+	return m_cullTime;
+}
+
+//	The lists are dynamic structured buffers, rewritten every frame with Map and read by the pixel shader
+//	through shader resource views.
+bool LightClusterClass::InitializeBuffers(ID3D11Device* device)
+{
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+	HRESULT result;
+
+//	Setup the description of the Dynamic Cluster Constant Buffer that is in the Pixel Shader:
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = sizeof(ClusterBufferType);
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &m_clusterBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+//	The three lists only differ in the size and count of their elements:
+	bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+
+	viewDesc.Format = DXGI_FORMAT_UNKNOWN;
+	viewDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	viewDesc.Buffer.FirstElement = 0;
+
+	bufferDesc.ByteWidth = sizeof(ClusterType) * LIGHT_CLUSTER_COUNT;
+	bufferDesc.StructureByteStride = sizeof(ClusterType);
+	viewDesc.Buffer.NumElements = LIGHT_CLUSTER_COUNT;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &m_clusterListBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	result = device->CreateShaderResourceView(m_clusterListBuffer, &viewDesc, &m_clusterListView);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	bufferDesc.ByteWidth = sizeof(unsigned int) * LIGHT_CLUSTER_MAX_INDICES;
+	bufferDesc.StructureByteStride = sizeof(unsigned int);
+	viewDesc.Buffer.NumElements = LIGHT_CLUSTER_MAX_INDICES;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &m_indexBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	result = device->CreateShaderResourceView(m_indexBuffer, &viewDesc, &m_indexView);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	bufferDesc.ByteWidth = sizeof(LightType) * m_maxLights;
+	bufferDesc.StructureByteStride = sizeof(LightType);
+	viewDesc.Buffer.NumElements = m_maxLights;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &m_lightBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	result = device->CreateShaderResourceView(m_lightBuffer, &viewDesc, &m_lightView);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void LightClusterClass::ShutdownBuffers()
+{
+	if (m_lightView)
+	{
+		m_lightView->Release();
+		m_lightView = 0;
+	}
+
+	if (m_lightBuffer)
+	{
+		m_lightBuffer->Release();
+		m_lightBuffer = 0;
+	}
+
+	if (m_indexView)
+	{
+		m_indexView->Release();
+		m_indexView = 0;
+	}
+
+	if (m_indexBuffer)
+	{
+		m_indexBuffer->Release();
+		m_indexBuffer = 0;
+	}
+
+	if (m_clusterListView)
+	{
+		m_clusterListView->Release();
+		m_clusterListView = 0;
+	}
+
+	if (m_clusterListBuffer)
+	{
+		m_clusterListBuffer->Release();
+		m_clusterListBuffer = 0;
+	}
+
+	if (m_clusterBuffer)
+	{
+		m_clusterBuffer->Release();
+		m_clusterBuffer = 0;
+	}
+
+	return;
+}
+
+//	BoundLights moves a range of lights into view space and bounds each of them with a sphere. A spot light
+//	gets the smallest sphere around its cone instead of the sphere of its range. The sphere is then
+//	projected to find the tiles and slices it covers. The tiles are taken from the box around the sphere,
+//	which is a little too many near the corners of the screen but never too few.
+void LightClusterClass::BoundLights(int begin, int end, XMMATRIX viewMatrix)
+{
+	const LightType* light;
+	LightType* viewLight;
+	LightBoundsType* bounds;
+	XMVECTOR position, direction, center;
+	float radius, sine, nearZ, farZ, left, right, top, bottom;
+	int i;
+
+	for (i = begin; i < end; i++)
+	{
+		light = &m_lights[i];
+		viewLight = &m_viewLights[i];
+		bounds = &m_lightBounds[i];
+
+		position = XMVector3TransformCoord(XMLoadFloat3(&light->position), viewMatrix);
+		direction = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&light->direction), viewMatrix));
+
+		*viewLight = *light;
+		XMStoreFloat3(&viewLight->position, position);
+		XMStoreFloat3(&viewLight->direction, direction);
+
+		center = position;
+		radius = light->range;
+
+//	A cone of at most 45 degrees fits a sphere through its tip and the rim of its base, a wider cone
+//	fits the sphere around the rim alone:
+		if (light->outerCosine > -1.0f)
+		{
+			sine = sqrtf(1.0f - light->outerCosine * light->outerCosine);
+			if (light->outerCosine >= 0.70710678f)
+			{
+				radius = light->range / (2.0f * light->outerCosine);
+				center = XMVectorMultiplyAdd(direction, XMVectorReplicate(radius), position);
+			}
+			else if (light->outerCosine > 0.0f)
+			{
+				radius = light->range * sine;
+				center = XMVectorMultiplyAdd(direction, XMVectorReplicate(light->range * light->outerCosine), position);
+			}
+		}
+
+		XMStoreFloat4(&bounds->sphere, XMVectorSetW(center, radius));
+
+//	Lights behind the near plane or past the far plane reach no cluster:
+		nearZ = bounds->sphere.z - radius;
+		farZ = bounds->sphere.z + radius;
+		if (farZ < m_nearZ || nearZ > m_farZ)
+		{
+			bounds->minimumX = bounds->minimumY = bounds->minimumZ = 1;
+			bounds->maximumX = bounds->maximumY = bounds->maximumZ = 0;
+			continue;
+		}
+
+		nearZ = (nearZ > m_nearZ) ? nearZ : m_nearZ;
+		bounds->minimumZ = GetSlice(nearZ);
+		bounds->maximumZ = GetSlice(farZ);
+
+//	Project the sides of the box onto the screen, each from the depth that puts it furthest out:
+		left = bounds->sphere.x - radius;
+		right = bounds->sphere.x + radius;
+		bottom = bounds->sphere.y - radius;
+		top = bounds->sphere.y + radius;
+
+		left = left * m_projectionX / ((left < 0.0f) ? nearZ : farZ);
+		right = right * m_projectionX / ((right > 0.0f) ? nearZ : farZ);
+		bottom = bottom * m_projectionY / ((bottom < 0.0f) ? nearZ : farZ);
+		top = top * m_projectionY / ((top > 0.0f) ? nearZ : farZ);
+
+		left = (left > -1.0f) ? left : -1.0f;
+		right = (right < 1.0f) ? right : 1.0f;
+		bottom = (bottom > -1.0f) ? bottom : -1.0f;
+		top = (top < 1.0f) ? top : 1.0f;
+
+		if (left > right || bottom > top)
+		{
+			bounds->minimumX = bounds->minimumY = bounds->minimumZ = 1;
+			bounds->maximumX = bounds->maximumY = bounds->maximumZ = 0;
+			continue;
+		}
+
+		bounds->minimumX = (int)((left + 1.0f) * 0.5f * (float)LIGHT_CLUSTER_X);
+		bounds->maximumX = (int)((right + 1.0f) * 0.5f * (float)LIGHT_CLUSTER_X);
+		bounds->minimumY = (int)((1.0f - top) * 0.5f * (float)LIGHT_CLUSTER_Y);
+		bounds->maximumY = (int)((1.0f - bottom) * 0.5f * (float)LIGHT_CLUSTER_Y);
+
+		bounds->maximumX = (bounds->maximumX < LIGHT_CLUSTER_X - 1) ? bounds->maximumX : LIGHT_CLUSTER_X - 1;
+		bounds->maximumY = (bounds->maximumY < LIGHT_CLUSTER_Y - 1) ? bounds->maximumY : LIGHT_CLUSTER_Y - 1;
+	}
+
+	return;
+}
+
+//	CullRows fills the lists of the clusters in a range of rows, numbered slice by slice. Every light of the
+//	slice whose tiles reach the row is first tested against the y and z bounds the row shares, and then
+//	against the x bounds of four clusters at a time. The test is the distance from the sphere center to the
+//	box of the cluster.
+void LightClusterClass::CullRows(int begin, int end)
+{
+	const LightBoundsType* bounds;
+	XMVECTOR centerX, radiusSquared, distance, minimum, maximum, inside;
+	XMFLOAT2 boundsY, boundsZ;
+	XMUINT4 mask;
+	unsigned short* lights;
+	int* counts;
+	int row, slice, y, i, light, group, column, firstGroup, lastGroup;
+	float distanceY, distanceZ, rowDistance;
+
+	for (row = begin; row < end; row++)
+	{
+		slice = row / LIGHT_CLUSTER_Y;
+		y = row % LIGHT_CLUSTER_Y;
+		boundsY = m_rowBoundsY[row];
+		boundsZ = m_sliceBoundsZ[slice];
+
+		lights = &m_clusterLights[row * LIGHT_CLUSTER_X * LIGHT_CLUSTER_MAX_LIGHTS];
+		counts = &m_clusterCounts[row * LIGHT_CLUSTER_X];
+		for (column = 0; column < LIGHT_CLUSTER_X; column++)
+		{
+			counts[column] = 0;
+		}
+
+		for (i = m_sliceOffsets[slice]; i < m_sliceOffsets[slice + 1]; i++)
+		{
+			light = m_sliceLights[i];
+			bounds = &m_lightBounds[light];
+			if (y < bounds->minimumY || y > bounds->maximumY)
+			{
+				continue;
+			}
+
+			distanceY = (bounds->sphere.y < boundsY.x) ? boundsY.x - bounds->sphere.y : ((bounds->sphere.y > boundsY.y) ? bounds->sphere.y - boundsY.y : 0.0f);
+			distanceZ = (bounds->sphere.z < boundsZ.x) ? boundsZ.x - bounds->sphere.z : ((bounds->sphere.z > boundsZ.y) ? bounds->sphere.z - boundsZ.y : 0.0f);
+			rowDistance = distanceY * distanceY + distanceZ * distanceZ;
+			if (rowDistance > bounds->sphere.w * bounds->sphere.w)
+			{
+				continue;
+			}
+
+			centerX = XMVectorReplicate(bounds->sphere.x);
+			radiusSquared = XMVectorReplicate(bounds->sphere.w * bounds->sphere.w - rowDistance);
+
+			firstGroup = bounds->minimumX / 4;
+			lastGroup = bounds->maximumX / 4;
+			for (group = firstGroup; group <= lastGroup; group++)
+			{
+				minimum = XMLoadFloat4A(&m_columnMinimum[slice * LIGHT_CLUSTER_X / 4 + group]);
+				maximum = XMLoadFloat4A(&m_columnMaximum[slice * LIGHT_CLUSTER_X / 4 + group]);
+
+				distance = XMVectorMax(XMVectorSubtract(minimum, centerX), XMVectorSubtract(centerX, maximum));
+				distance = XMVectorMax(distance, XMVectorZero());
+				inside = XMVectorLessOrEqual(XMVectorMultiply(distance, distance), radiusSquared);
+
+				XMStoreUInt4(&mask, inside);
+				for (column = group * 4; column < group * 4 + 4; column++)
+				{
+					if ((&mask.x)[column % 4] == 0 || column < bounds->minimumX || column > bounds->maximumX)
+					{
+						continue;
+					}
+
+//	Keep counting past a full list, so the packing knows how many lights were dropped:
+					if (counts[column] < LIGHT_CLUSTER_MAX_LIGHTS)
+					{
+						lights[column * LIGHT_CLUSTER_MAX_LIGHTS + counts[column]] = (unsigned short)light;
+					}
+					counts[column]++;
+				}
+			}
+		}
+	}
+
+	return;
+}
+
+//	GetSlice returns the slice a view space depth falls into.
+int LightClusterClass::GetSlice(float z)
+{
+	int slice;
+
+	slice = (int)(logf(z) * m_sliceScale + m_sliceBias);
+
+	return (slice < 0) ? 0 : ((slice >= LIGHT_CLUSTER_Z) ? LIGHT_CLUSTER_Z - 1 : slice);
+}
@@ -0,0 +1,193 @@
+#include "../Headers/mathbenchmarkclass.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+#include <chrono>
+#include <functional>
+//	Namespaces:
+using namespace std;
+
+void MathBenchmarkClass::Run(int count, const char* report)
+{
+	vector<XMFLOAT3> points, coords, normals, referenceCoords, referenceNormals;
+	vector<XMFLOAT4X4> left, right, products, transposes, referenceProducts, referenceTransposes;
+	vector<XMFLOAT4> packed, referencePacked;
+	XMFLOAT4X4 transform;
+	XMMATRIX matrix;
+	FILE* reportPtr;
+	float referenceTimes[5], times[5], errors[5];
+	int mismatches[5];
+	unsigned int seed;
+	int i, j, path, pickedPath;
+
+	seed = 23;
+	auto random = [&seed]()
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (float)(seed >> 8) / 16777216.0f;
+	};
+
+//	The fastest of five runs of a piece of work, in milliseconds:
+	auto best = [](const function<void()>& work)
+	{
+		chrono::high_resolution_clock::time_point startTime;
+		float time, bestTime;
+		int pass;
+
+		bestTime = 1.0e9f;
+		for (pass = 0; pass < 5; pass++)
+		{
+			startTime = chrono::high_resolution_clock::now();
+			work();
+			time = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+			bestTime = (time < bestTime) ? time : bestTime;
+		}
+
+		return bestTime;
+	};
+
+//	Counts the floats that are not bit for bit the reference, and the largest difference relative to the
+//	size of the reference value, or to one for values smaller than that:
+	auto compare = [](const float* values, const float* reference, int floatCount, int& mismatchCount, float& maximumError)
+	{
+		float error, size;
+		int k;
+
+		mismatchCount = 0;
+		maximumError = 0.0f;
+		for (k = 0; k < floatCount; k++)
+		{
+			if (memcmp(&values[k], &reference[k], sizeof(float)) != 0)
+			{
+				mismatchCount++;
+				size = fabsf(reference[k]);
+				error = fabsf(values[k] - reference[k]) / ((size > 1.0f) ? size : 1.0f);
+				maximumError = (error > maximumError) ? error : maximumError;
+			}
+		}
+	};
+
+	points.resize(count);
+	left.resize(count);
+	right.resize(count);
+	for (i = 0; i < count; i++)
+	{
+		points[i] = XMFLOAT3(200.0f * random() - 100.0f, 200.0f * random() - 100.0f, 200.0f * random() - 100.0f);
+
+		matrix = XMMatrixScaling(0.5f + random(), 0.5f + random(), 0.5f + random());
+		matrix = XMMatrixMultiply(matrix, XMMatrixRotationRollPitchYaw(6.0f * random(), 6.0f * random(), 6.0f * random()));
+		matrix = XMMatrixMultiply(matrix, XMMatrixTranslation(100.0f * random(), 100.0f * random(), 100.0f * random()));
+		XMStoreFloat4x4(&left[i], matrix);
+
+		matrix = XMMatrixRotationRollPitchYaw(6.0f * random(), 6.0f * random(), 6.0f * random());
+		matrix = XMMatrixMultiply(matrix, XMMatrixTranslation(100.0f * random(), 100.0f * random(), 100.0f * random()));
+		XMStoreFloat4x4(&right[i], matrix);
+	}
+
+//	The points are transformed by a view and a projection, so the divide by w is part of the work:
+	matrix = XMMatrixLookAtLH(XMVectorSet(10.0f, 20.0f, -150.0f, 1.0f), XMVectorZero(), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	matrix = XMMatrixMultiply(matrix, XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f));
+	XMStoreFloat4x4(&transform, matrix);
+
+	referenceCoords.resize(count);
+	referenceNormals.resize(count);
+	referenceProducts.resize(count);
+	referenceTransposes.resize(count);
+	referencePacked.resize(count * 3);
+
+	referenceTimes[0] = best([&]()
+	{
+		XMMATRIX m = XMLoadFloat4x4(&transform);
+		for (int k = 0; k < count; k++)
+		{
+			XMStoreFloat3(&referenceCoords[k], XMVector3TransformCoord(XMLoadFloat3(&points[k]), m));
+		}
+	});
+
+	referenceTimes[1] = best([&]()
+	{
+		XMMATRIX m = XMLoadFloat4x4(&transform);
+		for (int k = 0; k < count; k++)
+		{
+			XMStoreFloat3(&referenceNormals[k], XMVector3TransformNormal(XMLoadFloat3(&points[k]), m));
+		}
+	});
+
+	referenceTimes[2] = best([&]()
+	{
+		for (int k = 0; k < count; k++)
+		{
+			XMStoreFloat4x4(&referenceProducts[k], XMMatrixMultiply(XMLoadFloat4x4(&left[k]), XMLoadFloat4x4(&right[k])));
+		}
+	});
+
+	referenceTimes[3] = best([&]()
+	{
+		for (int k = 0; k < count; k++)
+		{
+			XMStoreFloat4x4(&referenceTransposes[k], XMMatrixTranspose(XMLoadFloat4x4(&left[k])));
+		}
+	});
+
+	referenceTimes[4] = best([&]()
+	{
+		for (int k = 0; k < count; k++)
+		{
+			XMMATRIX t = XMMatrixTranspose(XMLoadFloat4x4(&left[k]));
+			XMStoreFloat4(&referencePacked[k * 3 + 0], t.r[0]);
+			XMStoreFloat4(&referencePacked[k * 3 + 1], t.r[1]);
+			XMStoreFloat4(&referencePacked[k * 3 + 2], t.r[2]);
+		}
+	});
+
+	if (fopen_s(&reportPtr, report, "a") != 0)
+	{
+		return;
+	}
+
+	fprintf(reportPtr, "%d items, one at a time: coords %.3f ms, normals %.3f ms, multiply %.3f ms, transpose %.3f ms, pack %.3f ms\n",
+		count, referenceTimes[0], referenceTimes[1], referenceTimes[2], referenceTimes[3], referenceTimes[4]);
+
+	coords.resize(count);
+	normals.resize(count);
+	products.resize(count);
+	transposes.resize(count);
+	packed.resize(count * 3);
+
+	pickedPath = BatchMathClass::GetPath();
+	for (path = 0; path < BATCH_MATH_PATH_COUNT; path++)
+	{
+		if (!BatchMathClass::SetPath(path))
+		{
+			fprintf(reportPtr, "  %s: not supported\n", BatchMathClass::GetPathName(path));
+			continue;
+		}
+
+		times[0] = best([&]() { BatchMathClass::TransformCoords(points.data(), count, transform, coords.data()); });
+		times[1] = best([&]() { BatchMathClass::TransformNormals(points.data(), count, transform, normals.data()); });
+		times[2] = best([&]() { BatchMathClass::MultiplyMatrices(left.data(), right.data(), count, products.data()); });
+		times[3] = best([&]() { BatchMathClass::TransposeMatrices(left.data(), count, transposes.data()); });
+		times[4] = best([&]() { BatchMathClass::PackAffineMatrices(left.data(), count, packed.data()); });
+
+		compare(&coords[0].x, &referenceCoords[0].x, count * 3, mismatches[0], errors[0]);
+		compare(&normals[0].x, &referenceNormals[0].x, count * 3, mismatches[1], errors[1]);
+		compare(&products[0]._11, &referenceProducts[0]._11, count * 16, mismatches[2], errors[2]);
+		compare(&transposes[0]._11, &referenceTransposes[0]._11, count * 16, mismatches[3], errors[3]);
+		compare(&packed[0].x, &referencePacked[0].x, count * 12, mismatches[4], errors[4]);
+
+		fprintf(reportPtr, "  %s:", BatchMathClass::GetPathName(path));
+		for (j = 0; j < 5; j++)
+		{
+			fprintf(reportPtr, " %.3f ms (%d inexact, %.2g)", times[j], mismatches[j], errors[j]);
+		}
+		fprintf(reportPtr, "\n");
+	}
+
+	BatchMathClass::SetPath(pickedPath);
+
+	fclose(reportPtr);
+
+	return;
+}
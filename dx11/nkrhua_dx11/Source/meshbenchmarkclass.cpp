@@ -0,0 +1,205 @@
+#include "../Headers/meshbenchmarkclass.h"
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <functional>
+
+bool MeshBenchmarkClass::Run(int size, const char* report)
+{
+	ColorVertexType::SourceType source;
+	ColorCompactVertexType::SourceType compactSource;
+	vector<ColorVertexType> fullVertices;
+	vector<ColorCompactVertexType> compactVertices;
+	vector<unsigned long> indices;
+	FILE* reportPtr;
+	float height;
+	int x, z, i;
+	bool result;
+
+//	The fastest of a number of runs of a piece of work, in milliseconds:
+	auto best = [](int passes, const function<void()>& work)
+	{
+		chrono::high_resolution_clock::time_point startTime;
+		float time, bestTime;
+		int pass;
+
+		bestTime = 1.0e9f;
+		for (pass = 0; pass < passes; pass++)
+		{
+			startTime = chrono::high_resolution_clock::now();
+			work();
+			time = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+			bestTime = (time < bestTime) ? time : bestTime;
+		}
+
+		return bestTime;
+	};
+
+//	Encodes, decodes and reads back the mesh with the vertices given, and appends a line for it to the report:
+	auto measure = [&](const char* name, const void* vertices, int stride)
+	{
+		vector<unsigned char> vertexCopy, vertexData, indexData, decodedVertices, readVertices;
+		vector<unsigned long> indexCopy, decodedIndices, readIndices;
+		const unsigned long* triangle;
+		const unsigned long* decoded;
+		FILE* filePtr;
+		float simdTime, scalarTime, indexTime, readTime, rawTime;
+		size_t rawSize, meshSize;
+		int vertexCount, indexCount, j, k;
+		bool correct;
+
+		vertexCount = size * size;
+		indexCount = (int)indices.size();
+		rawSize = (size_t)vertexCount * stride + indices.size() * sizeof(unsigned long);
+
+//	The mesh file has the vertices in the order OptimizeVertexFetch puts them in, so that is what is compared:
+		vertexCopy.assign((const unsigned char*)vertices, (const unsigned char*)vertices + (size_t)vertexCount * stride);
+		indexCopy = indices;
+		MeshCodecClass::OptimizeVertexFetch(vertexCopy.data(), vertexCount, stride, indexCopy.data(), indexCount);
+
+		if (!MeshCodecClass::EncodeVertices(vertexCopy.data(), vertexCount, stride, vertexData) ||
+			!MeshCodecClass::EncodeIndices(indexCopy.data(), indexCount, indexData))
+		{
+			return false;
+		}
+
+		decodedVertices.resize(vertexCopy.size());
+		decodedIndices.resize(indexCopy.size());
+		correct = true;
+
+		simdTime = best(5, [&]()
+		{
+			correct = MeshCodecClass::DecodeVertices(vertexData.data(), vertexData.size(), vertexCount, stride, decodedVertices.data()) && correct;
+		});
+		correct = correct && decodedVertices == vertexCopy;
+
+		scalarTime = best(5, [&]()
+		{
+			correct = MeshCodecClass::DecodeVerticesScalar(vertexData.data(), vertexData.size(), vertexCount, stride, decodedVertices.data()) && correct;
+		});
+		correct = correct && decodedVertices == vertexCopy;
+
+		indexTime = best(5, [&]()
+		{
+			correct = MeshCodecClass::DecodeIndices(indexData.data(), indexData.size(), indexCount, decodedIndices.data()) && correct;
+		});
+
+//	Every decoded triangle has to be its triangle, started from any of its three corners:
+		for (j = 0; j < indexCount && correct; j += 3)
+		{
+			triangle = &indexCopy[j];
+			decoded = &decodedIndices[j];
+			for (k = 0; k < 3; k++)
+			{
+				if (decoded[0] == triangle[k] && decoded[1] == triangle[(k + 1) % 3] && decoded[2] == triangle[(k + 2) % 3])
+				{
+					break;
+				}
+			}
+			correct = (k < 3);
+		}
+
+//	Write the mesh file and the same mesh uncompressed, then time reading each of them back:
+		if (!MeshCodecClass::WriteMesh("mesh-benchmark.mesh", vertexCopy.data(), vertexCount, stride, indexCopy.data(), indexCount))
+		{
+			return false;
+		}
+		meshSize = sizeof(MeshCodecClass::MeshHeaderType) + vertexData.size() + indexData.size();
+
+		if (fopen_s(&filePtr, "mesh-benchmark.raw", "wb") != 0)
+		{
+			return false;
+		}
+		fwrite(vertexCopy.data(), 1, vertexCopy.size(), filePtr);
+		fwrite(indexCopy.data(), sizeof(unsigned long), indexCopy.size(), filePtr);
+		fclose(filePtr);
+
+		rawTime = best(3, [&]()
+		{
+			readVertices.resize(vertexCopy.size());
+			readIndices.resize(indexCopy.size());
+			if (fopen_s(&filePtr, "mesh-benchmark.raw", "rb") != 0)
+			{
+				correct = false;
+				return;
+			}
+			correct = fread(readVertices.data(), 1, readVertices.size(), filePtr) == readVertices.size() && correct;
+			correct = fread(readIndices.data(), sizeof(unsigned long), readIndices.size(), filePtr) == readIndices.size() && correct;
+			fclose(filePtr);
+		});
+
+		readTime = best(3, [&]()
+		{
+			correct = MeshCodecClass::ReadMesh("mesh-benchmark.mesh", stride, readVertices, readIndices) && correct;
+		});
+		correct = correct && readVertices == vertexCopy;
+
+		if (fopen_s(&reportPtr, report, "a") != 0)
+		{
+			return false;
+		}
+
+		fprintf(reportPtr, "%s, %d vertices of %d bytes, %d triangles: vertices %.2fx smaller, indices %.2f bytes a triangle, "
+			"%.1f MB file for %.1f MB; vertices decoded at %.2f GB/s with SSE2, %.2f GB/s a byte at a time, indices at %.1f million "
+			"triangles/s; read in %.2f ms against %.2f ms uncompressed%s\n",
+			name, vertexCount, stride, indexCount / 3, (float)vertexCopy.size() / (float)vertexData.size(),
+			(float)indexData.size() / (float)(indexCount / 3), (float)meshSize / (1024.0f * 1024.0f), (float)rawSize / (1024.0f * 1024.0f),
+			(float)vertexCopy.size() / (simdTime * 1.0e6f), (float)vertexCopy.size() / (scalarTime * 1.0e6f),
+			(float)(indexCount / 3) / (indexTime * 1000.0f), readTime, rawTime, correct ? "" : ", DECODED WRONG");
+
+		fclose(reportPtr);
+
+		return true;
+	};
+
+	fullVertices.resize(size * size);
+	compactVertices.resize(size * size);
+	for (z = 0; z < size; z++)
+	{
+		for (x = 0; x < size; x++)
+		{
+			i = z * size + x;
+			height = 4.0f * sinf((float)x * 0.05f) * cosf((float)z * 0.07f);
+
+			source.position = XMFLOAT3((float)x, height, (float)z);
+			source.color = XMFLOAT4(0.5f + height / 8.0f, (float)x / (float)size, (float)z / (float)size, 1.0f);
+
+			compactSource.position = source.position;
+			compactSource.color = source.color;
+
+			ColorVertexType::Pack(source, fullVertices[i]);
+			ColorCompactVertexType::Pack(compactSource, compactVertices[i]);
+		}
+	}
+
+	for (z = 0; z < size - 1; z++)
+	{
+		for (x = 0; x < size - 1; x++)
+		{
+			i = z * size + x;
+
+			indices.push_back(i);
+			indices.push_back(i + size);
+			indices.push_back(i + 1);
+
+			indices.push_back(i + 1);
+			indices.push_back(i + size);
+			indices.push_back(i + size + 1);
+		}
+	}
+
+	result = measure("ColorVertexType", fullVertices.data(), sizeof(ColorVertexType));
+	if (!result)
+	{
+		return false;
+	}
+
+	result = measure("ColorCompactVertexType", compactVertices.data(), sizeof(ColorCompactVertexType));
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
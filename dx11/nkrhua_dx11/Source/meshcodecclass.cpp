@@ -0,0 +1,743 @@
+#include "../Headers/meshcodecclass.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <emmintrin.h>
+
+//	The bytes the 16 changes of one byte of the vertex take at each of the four widths they can be stored with.
+static const int VERTEX_MODE_BYTES[4] = { 0, 4, 8, 16 };
+
+//	The edge and vertex FIFOs of the index codec. A code has room to name 15 of the edges and 14 of the vertices,
+//	the last value of each nibble being taken by the escape.
+static const int INDEX_FIFO_SIZE = 16;
+static const int INDEX_EDGE_LIMIT = 15;
+static const int INDEX_VERTEX_LIMIT = 14;
+static const int INDEX_ESCAPE = 15;
+
+//	What the index encoder and decoder both keep track of, so that they make the same decisions.
+struct IndexStateType
+{
+	unsigned long edges[INDEX_FIFO_SIZE][2];
+	unsigned long vertices[INDEX_FIFO_SIZE];
+	int edgeHead, vertexHead;
+	unsigned long next;
+};
+
+static void ResetIndexState(IndexStateType& state)
+{
+	int i;
+
+	for (i = 0; i < INDEX_FIFO_SIZE; i++)
+	{
+		state.edges[i][0] = 0xFFFFFFFF;
+		state.edges[i][1] = 0xFFFFFFFF;
+		state.vertices[i] = 0xFFFFFFFF;
+	}
+
+	state.edgeHead = 0;
+	state.vertexHead = 0;
+	state.next = 0;
+
+	return;
+}
+
+//	The slot of the FIFO entry pushed age entries ago, the newest having an age of 0.
+static int GetFifoSlot(int head, int age)
+{
+	return (head + INDEX_FIFO_SIZE - 1 - age) & (INDEX_FIFO_SIZE - 1);
+}
+
+static void PushEdge(IndexStateType& state, unsigned long first, unsigned long second)
+{
+	state.edges[state.edgeHead][0] = first;
+	state.edges[state.edgeHead][1] = second;
+	state.edgeHead = (state.edgeHead + 1) & (INDEX_FIFO_SIZE - 1);
+
+	return;
+}
+
+static void PushVertex(IndexStateType& state, unsigned long index)
+{
+	state.vertices[state.vertexHead] = index;
+	state.vertexHead = (state.vertexHead + 1) & (INDEX_FIFO_SIZE - 1);
+
+	return;
+}
+
+//	A triangle's neighbors run the edges it shares with them the other way around, so those are the edges
+//	pushed for the triangles to come to find.
+static void PushTriangleEdges(IndexStateType& state, unsigned long a, unsigned long b, unsigned long c, bool sharedEdge)
+{
+	if (!sharedEdge)
+	{
+		PushEdge(state, b, a);
+	}
+	PushEdge(state, c, b);
+	PushEdge(state, a, c);
+
+	return;
+}
+
+//	EncodeVertexReference returns the nibble that names a vertex: 0 for the next vertex never used, the age
+//	plus one for one of the recent vertices, or the escape with the zigzagged difference from the next
+//	vertex to write after the codes.
+static int EncodeVertexReference(IndexStateType& state, unsigned long index, unsigned int& explicitValue)
+{
+	int difference, age;
+
+	if (index == state.next)
+	{
+		state.next++;
+		PushVertex(state, index);
+		return 0;
+	}
+
+	for (age = 0; age < INDEX_VERTEX_LIMIT; age++)
+	{
+		if (state.vertices[GetFifoSlot(state.vertexHead, age)] == index)
+		{
+			return age + 1;
+		}
+	}
+
+	difference = (int)(index - state.next);
+	explicitValue = ((unsigned int)difference << 1) ^ (unsigned int)(difference >> 31);
+	PushVertex(state, index);
+
+	return INDEX_ESCAPE;
+}
+
+static bool DecodeVertexReference(IndexStateType& state, int reference, const unsigned char*& data, const unsigned char* end, unsigned long& index)
+{
+	unsigned int value;
+	int shift, difference;
+
+	if (reference == 0)
+	{
+		index = state.next++;
+		PushVertex(state, index);
+		return true;
+	}
+
+	if (reference != INDEX_ESCAPE)
+	{
+		index = state.vertices[GetFifoSlot(state.vertexHead, reference - 1)];
+		return true;
+	}
+
+//	The difference is seven bits a byte, the low bits first, with the top bit set on every byte but the last:
+	value = 0;
+	for (shift = 0; ; shift += 7)
+	{
+		if (data == end || shift > 28)
+		{
+			return false;
+		}
+
+		value |= (unsigned int)(*data & 0x7F) << shift;
+		if ((*data++ & 0x80) == 0)
+		{
+			break;
+		}
+	}
+
+	difference = (int)((value >> 1) ^ (0u - (value & 1)));
+	index = (unsigned long)((unsigned int)state.next + (unsigned int)difference);
+	PushVertex(state, index);
+
+	return true;
+}
+
+static void WriteExplicitValue(vector<unsigned char>& data, unsigned int value)
+{
+	while (value >= 0x80)
+	{
+		data.push_back((unsigned char)(value | 0x80));
+		value >>= 7;
+	}
+	data.push_back((unsigned char)value);
+
+	return;
+}
+
+static unsigned char ZigzagByte(unsigned char delta)
+{
+	return (unsigned char)((delta << 1) ^ (unsigned char)((signed char)delta >> 7));
+}
+
+static unsigned char UnzigzagByte(unsigned char value)
+{
+	return (unsigned char)((value >> 1) ^ (unsigned char)(0 - (value & 1)));
+}
+
+//	The masks UnpackDeltas picks the unpacked values of each width with, a row of 16 bytes for each of the
+//	2, 4 and 8 bit unpackings for each width.
+static const unsigned char VERTEX_MODE_MASKS[4][3][16] =
+{
+	{ { 0 }, { 0 }, { 0 } },
+	{ { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }, { 0 }, { 0 } },
+	{ { 0 }, { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF }, { 0 } },
+	{ { 0 }, { 0 }, { 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF } }
+};
+
+//	UnpackDeltas spreads the 16 stored values of one byte of the vertex out to a byte each. The width changes
+//	from one byte of the vertex to the next too often for a branch on it to be predicted, so all three
+//	unpackings are made from the same 16 bytes and the masks of the width keep the right one.
+static __m128i UnpackDeltas(__m128i packed, int mode)
+{
+	__m128i twoBits, fourBits, mask;
+
+	mask = _mm_set1_epi8(3);
+	twoBits = _mm_unpacklo_epi16(
+		_mm_unpacklo_epi8(_mm_and_si128(packed, mask), _mm_and_si128(_mm_srli_epi16(packed, 2), mask)),
+		_mm_unpacklo_epi8(_mm_and_si128(_mm_srli_epi16(packed, 4), mask), _mm_and_si128(_mm_srli_epi16(packed, 6), mask)));
+
+	mask = _mm_set1_epi8(15);
+	fourBits = _mm_unpacklo_epi8(_mm_and_si128(packed, mask), _mm_and_si128(_mm_srli_epi16(packed, 4), mask));
+
+	return _mm_or_si128(_mm_or_si128(
+		_mm_and_si128(twoBits, _mm_loadu_si128((const __m128i*)VERTEX_MODE_MASKS[mode][0])),
+		_mm_and_si128(fourBits, _mm_loadu_si128((const __m128i*)VERTEX_MODE_MASKS[mode][1]))),
+		_mm_and_si128(packed, _mm_loadu_si128((const __m128i*)VERTEX_MODE_MASKS[mode][2])));
+}
+
+//	AddDeltas undoes the zigzag and adds the changes up along the block, starting from the same byte of the
+//	vertex before the block.
+static __m128i AddDeltas(__m128i zigzag, unsigned char last)
+{
+	__m128i deltas;
+
+	deltas = _mm_xor_si128(_mm_and_si128(_mm_srli_epi16(zigzag, 1), _mm_set1_epi8(0x7F)),
+		_mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(zigzag, _mm_set1_epi8(1))));
+
+	deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 1));
+	deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 2));
+	deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 4));
+	deltas = _mm_add_epi8(deltas, _mm_slli_si128(deltas, 8));
+
+	return _mm_add_epi8(deltas, _mm_set1_epi8((char)last));
+}
+
+static void StoreWord(unsigned char* target, __m128i value)
+{
+	int word;
+
+	word = _mm_cvtsi128_si32(value);
+	memcpy(target, &word, 4);
+
+	return;
+}
+
+//	EncodeVertices writes every block as a header of two bits per byte of the vertex, giving the width its
+//	changes are stored with, followed by the stored changes of each byte in turn. A last block of fewer than
+//	16 vertices is filled out with changes of zero.
+bool MeshCodecClass::EncodeVertices(const void* vertices, int vertexCount, int stride, vector<unsigned char>& data)
+{
+	const unsigned char* bytes;
+	unsigned char last[MESH_CODEC_MAX_STRIDE];
+	unsigned char values[MESH_CODEC_BLOCK_SIZE];
+	unsigned char current, previous, maximum;
+	size_t header;
+	int block, count, k, i, mode;
+
+	if (stride <= 0 || stride > MESH_CODEC_MAX_STRIDE || stride % 4 != 0 || vertexCount < 0)
+	{
+		return false;
+	}
+
+	bytes = (const unsigned char*)vertices;
+	memset(last, 0, sizeof(last));
+	data.clear();
+
+	for (block = 0; block < vertexCount; block += MESH_CODEC_BLOCK_SIZE)
+	{
+		count = (vertexCount - block < MESH_CODEC_BLOCK_SIZE) ? vertexCount - block : MESH_CODEC_BLOCK_SIZE;
+
+		header = data.size();
+		data.resize(header + GetHeaderSize(stride), 0);
+
+		for (k = 0; k < stride; k++)
+		{
+			previous = last[k];
+			maximum = 0;
+			for (i = 0; i < MESH_CODEC_BLOCK_SIZE; i++)
+			{
+				current = bytes[(size_t)(block + ((i < count) ? i : count - 1)) * stride + k];
+				values[i] = ZigzagByte((unsigned char)(current - previous));
+				maximum = (values[i] > maximum) ? values[i] : maximum;
+				previous = current;
+			}
+			last[k] = previous;
+
+			mode = (maximum == 0) ? 0 : (maximum < 4) ? 1 : (maximum < 16) ? 2 : 3;
+			data[header + k / 4] |= (unsigned char)(mode << (2 * (k % 4)));
+
+			switch (mode)
+			{
+			case 1:
+				for (i = 0; i < MESH_CODEC_BLOCK_SIZE; i += 4)
+				{
+					data.push_back((unsigned char)(values[i] | (values[i + 1] << 2) | (values[i + 2] << 4) | (values[i + 3] << 6)));
+				}
+				break;
+
+			case 2:
+				for (i = 0; i < MESH_CODEC_BLOCK_SIZE; i += 2)
+				{
+					data.push_back((unsigned char)(values[i] | (values[i + 1] << 4)));
+				}
+				break;
+
+			case 3:
+				data.insert(data.end(), values, values + MESH_CODEC_BLOCK_SIZE);
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+//	DecodeVertices decodes four bytes of the vertex at a time for all 16 vertices of a block, one register a
+//	byte, and transposes the four registers into the four byte words of the 16 vertices to store them. A last
+//	block of fewer than 16 vertices is decoded aside and only its vertices copied out. Data that runs out
+//	early or has anything left over fails.
+bool MeshCodecClass::DecodeVertices(const unsigned char* data, size_t size, int vertexCount, int stride, void* vertices)
+{
+	const unsigned char* end;
+	const unsigned char* header;
+	unsigned char* bytes;
+	unsigned char* target;
+	unsigned char last[MESH_CODEC_MAX_STRIDE];
+	unsigned char scratch[MESH_CODEC_BLOCK_SIZE * MESH_CODEC_MAX_STRIDE];
+	unsigned char tail[64];
+	const unsigned char* source;
+	__m128i columns[4], pairs[4], words[4];
+	int offsets[4];
+	int block, count, headerSize, groupSize, k, i, j, modes;
+
+	if (stride <= 0 || stride > MESH_CODEC_MAX_STRIDE || stride % 4 != 0 || vertexCount < 0)
+	{
+		return false;
+	}
+
+	bytes = (unsigned char*)vertices;
+	end = data + size;
+	headerSize = GetHeaderSize(stride);
+	memset(last, 0, sizeof(last));
+
+	for (block = 0; block < vertexCount; block += MESH_CODEC_BLOCK_SIZE)
+	{
+		count = (vertexCount - block < MESH_CODEC_BLOCK_SIZE) ? vertexCount - block : MESH_CODEC_BLOCK_SIZE;
+
+		if (end - data < headerSize)
+		{
+			return false;
+		}
+
+		header = data;
+		data += headerSize;
+
+		target = (count == MESH_CODEC_BLOCK_SIZE) ? bytes + (size_t)block * stride : scratch;
+
+		for (k = 0; k < stride; k += 4)
+		{
+//	The four bytes of the vertex share a header byte, which gives where the stored values of each of them
+//	start, so they are loaded independently of each other:
+			modes = header[k / 4];
+			offsets[0] = 0;
+			offsets[1] = VERTEX_MODE_BYTES[modes & 3];
+			offsets[2] = offsets[1] + VERTEX_MODE_BYTES[(modes >> 2) & 3];
+			offsets[3] = offsets[2] + VERTEX_MODE_BYTES[(modes >> 4) & 3];
+			groupSize = offsets[3] + VERTEX_MODE_BYTES[modes >> 6];
+			if (end - data < groupSize)
+			{
+				return false;
+			}
+
+//	Near the end of the data the group is copied out, so the 16 bytes loaded for each byte never run past it:
+			source = data;
+			if (end - data < (ptrdiff_t)sizeof(tail))
+			{
+				memset(tail, 0, sizeof(tail));
+				memcpy(tail, data, end - data);
+				source = tail;
+			}
+
+			for (j = 0; j < 4; j++)
+			{
+				columns[j] = AddDeltas(UnpackDeltas(_mm_loadu_si128((const __m128i*)(source + offsets[j])), (modes >> (2 * j)) & 3), last[k + j]);
+				last[k + j] = (unsigned char)(_mm_extract_epi16(columns[j], 7) >> 8);
+			}
+
+			data += groupSize;
+
+//	Transpose the four bytes of the 16 vertices into a word a vertex, four vertices a register:
+			pairs[0] = _mm_unpacklo_epi8(columns[0], columns[1]);
+			pairs[1] = _mm_unpackhi_epi8(columns[0], columns[1]);
+			pairs[2] = _mm_unpacklo_epi8(columns[2], columns[3]);
+			pairs[3] = _mm_unpackhi_epi8(columns[2], columns[3]);
+
+			words[0] = _mm_unpacklo_epi16(pairs[0], pairs[2]);
+			words[1] = _mm_unpackhi_epi16(pairs[0], pairs[2]);
+			words[2] = _mm_unpacklo_epi16(pairs[1], pairs[3]);
+			words[3] = _mm_unpackhi_epi16(pairs[1], pairs[3]);
+
+			for (i = 0; i < 4; i++)
+			{
+				StoreWord(target + (size_t)(4 * i + 0) * stride + k, words[i]);
+				StoreWord(target + (size_t)(4 * i + 1) * stride + k, _mm_shuffle_epi32(words[i], 1));
+				StoreWord(target + (size_t)(4 * i + 2) * stride + k, _mm_shuffle_epi32(words[i], 2));
+				StoreWord(target + (size_t)(4 * i + 3) * stride + k, _mm_shuffle_epi32(words[i], 3));
+			}
+		}
+
+		if (count < MESH_CODEC_BLOCK_SIZE)
+		{
+			memcpy(bytes + (size_t)block * stride, scratch, (size_t)count * stride);
+		}
+	}
+
+	return data == end;
+}
+
+//	DecodeVerticesScalar decodes the same data a byte at a time. It gives exactly what DecodeVertices does and
+//	is kept to check it against and to time it by.
+bool MeshCodecClass::DecodeVerticesScalar(const unsigned char* data, size_t size, int vertexCount, int stride, void* vertices)
+{
+	const unsigned char* end;
+	const unsigned char* header;
+	unsigned char* bytes;
+	unsigned char last[MESH_CODEC_MAX_STRIDE];
+	unsigned char value;
+	int block, count, headerSize, k, i, mode;
+
+	if (stride <= 0 || stride > MESH_CODEC_MAX_STRIDE || stride % 4 != 0 || vertexCount < 0)
+	{
+		return false;
+	}
+
+	bytes = (unsigned char*)vertices;
+	end = data + size;
+	headerSize = GetHeaderSize(stride);
+	memset(last, 0, sizeof(last));
+
+	for (block = 0; block < vertexCount; block += MESH_CODEC_BLOCK_SIZE)
+	{
+		count = (vertexCount - block < MESH_CODEC_BLOCK_SIZE) ? vertexCount - block : MESH_CODEC_BLOCK_SIZE;
+
+		if (end - data < headerSize)
+		{
+			return false;
+		}
+
+		header = data;
+		data += headerSize;
+
+		for (k = 0; k < stride; k++)
+		{
+			mode = (header[k / 4] >> (2 * (k % 4))) & 3;
+			if (end - data < VERTEX_MODE_BYTES[mode])
+			{
+				return false;
+			}
+
+			for (i = 0; i < MESH_CODEC_BLOCK_SIZE; i++)
+			{
+				switch (mode)
+				{
+				case 0:
+					value = 0;
+					break;
+				case 1:
+					value = (data[i / 4] >> (2 * (i % 4))) & 3;
+					break;
+				case 2:
+					value = (data[i / 2] >> (4 * (i % 2))) & 15;
+					break;
+				default:
+					value = data[i];
+					break;
+				}
+
+				last[k] = (unsigned char)(last[k] + UnzigzagByte(value));
+				if (i < count)
+				{
+					bytes[(size_t)(block + i) * stride + k] = last[k];
+				}
+			}
+
+			data += VERTEX_MODE_BYTES[mode];
+		}
+	}
+
+	return data == end;
+}
+
+//	EncodeIndices writes a code byte for every triangle. A high nibble below 15 is the age of the edge the
+//	triangle shares, which becomes its first two vertices, and the low nibble names the third vertex. A high
+//	nibble of 15 is a triangle that shares no recent edge, and its three vertices are named by the low nibble
+//	and the two nibbles of the byte after. The explicit differences of any escaped vertices come last, in order.
+bool MeshCodecClass::EncodeIndices(const unsigned long* indices, int indexCount, vector<unsigned char>& data)
+{
+	IndexStateType state;
+	unsigned long triangle[3];
+	unsigned int explicitValues[3];
+	int references[3];
+	int i, j, age, rotation, edge, slot;
+
+	if (indexCount < 0 || indexCount % 3 != 0)
+	{
+		return false;
+	}
+
+	ResetIndexState(state);
+	data.clear();
+
+	for (i = 0; i < indexCount; i += 3)
+	{
+//	Look for the newest edge the triangle shares, turning the triangle so the edge comes first:
+		edge = -1;
+		for (age = 0; age < INDEX_EDGE_LIMIT && edge < 0; age++)
+		{
+			slot = GetFifoSlot(state.edgeHead, age);
+			for (rotation = 0; rotation < 3; rotation++)
+			{
+				if (state.edges[slot][0] == indices[i + rotation] && state.edges[slot][1] == indices[i + (rotation + 1) % 3])
+				{
+					edge = age;
+					triangle[0] = indices[i + rotation];
+					triangle[1] = indices[i + (rotation + 1) % 3];
+					triangle[2] = indices[i + (rotation + 2) % 3];
+					break;
+				}
+			}
+		}
+
+		if (edge >= 0)
+		{
+			references[2] = EncodeVertexReference(state, triangle[2], explicitValues[2]);
+
+			data.push_back((unsigned char)((edge << 4) | references[2]));
+			if (references[2] == INDEX_ESCAPE)
+			{
+				WriteExplicitValue(data, explicitValues[2]);
+			}
+
+			PushTriangleEdges(state, triangle[0], triangle[1], triangle[2], true);
+		}
+		else
+		{
+			for (j = 0; j < 3; j++)
+			{
+				references[j] = EncodeVertexReference(state, indices[i + j], explicitValues[j]);
+			}
+
+			data.push_back((unsigned char)((INDEX_ESCAPE << 4) | references[0]));
+			data.push_back((unsigned char)(references[1] | (references[2] << 4)));
+			for (j = 0; j < 3; j++)
+			{
+				if (references[j] == INDEX_ESCAPE)
+				{
+					WriteExplicitValue(data, explicitValues[j]);
+				}
+			}
+
+			PushTriangleEdges(state, indices[i], indices[i + 1], indices[i + 2], false);
+		}
+	}
+
+	return true;
+}
+
+bool MeshCodecClass::DecodeIndices(const unsigned char* data, size_t size, int indexCount, unsigned long* indices)
+{
+	IndexStateType state;
+	const unsigned char* end;
+	unsigned char code, second;
+	int i, slot;
+
+	if (indexCount < 0 || indexCount % 3 != 0)
+	{
+		return false;
+	}
+
+	ResetIndexState(state);
+	end = data + size;
+
+	for (i = 0; i < indexCount; i += 3)
+	{
+		if (data == end)
+		{
+			return false;
+		}
+
+		code = *data++;
+		if ((code >> 4) != INDEX_ESCAPE)
+		{
+			slot = GetFifoSlot(state.edgeHead, code >> 4);
+			indices[i] = state.edges[slot][0];
+			indices[i + 1] = state.edges[slot][1];
+
+			if (!DecodeVertexReference(state, code & 15, data, end, indices[i + 2]))
+			{
+				return false;
+			}
+
+			PushTriangleEdges(state, indices[i], indices[i + 1], indices[i + 2], true);
+		}
+		else
+		{
+			if (data == end)
+			{
+				return false;
+			}
+
+			second = *data++;
+			if (!DecodeVertexReference(state, code & 15, data, end, indices[i]) ||
+				!DecodeVertexReference(state, second & 15, data, end, indices[i + 1]) ||
+				!DecodeVertexReference(state, second >> 4, data, end, indices[i + 2]))
+			{
+				return false;
+			}
+
+			PushTriangleEdges(state, indices[i], indices[i + 1], indices[i + 2], false);
+		}
+	}
+
+	return data == end;
+}
+
+void MeshCodecClass::OptimizeVertexFetch(void* vertices, int vertexCount, int stride, unsigned long* indices, int indexCount)
+{
+	vector<unsigned long> remap;
+	vector<unsigned char> copy;
+	unsigned char* bytes;
+	unsigned long next;
+	int i;
+
+	bytes = (unsigned char*)vertices;
+	remap.resize(vertexCount, 0xFFFFFFFF);
+	copy.assign(bytes, bytes + (size_t)vertexCount * stride);
+
+	next = 0;
+	for (i = 0; i < indexCount; i++)
+	{
+		if (indices[i] < (unsigned long)vertexCount)
+		{
+			if (remap[indices[i]] == 0xFFFFFFFF)
+			{
+				remap[indices[i]] = next++;
+			}
+			indices[i] = remap[indices[i]];
+		}
+	}
+
+	for (i = 0; i < vertexCount; i++)
+	{
+		if (remap[i] == 0xFFFFFFFF)
+		{
+			remap[i] = next++;
+		}
+
+		memcpy(bytes + (size_t)remap[i] * stride, copy.data() + (size_t)i * stride, stride);
+	}
+
+	return;
+}
+
+bool MeshCodecClass::WriteMesh(const char* filename, const void* vertices, int vertexCount, int stride, const unsigned long* indices, int indexCount)
+{
+	vector<unsigned char> vertexCopy, vertexData, indexData;
+	vector<unsigned long> indexCopy;
+	MeshHeaderType header;
+	FILE* filePtr;
+	size_t count;
+
+	vertexCopy.assign((const unsigned char*)vertices, (const unsigned char*)vertices + (size_t)vertexCount * stride);
+	indexCopy.assign(indices, indices + indexCount);
+
+	OptimizeVertexFetch(vertexCopy.data(), vertexCount, stride, indexCopy.data(), indexCount);
+
+	if (!EncodeVertices(vertexCopy.data(), vertexCount, stride, vertexData) || !EncodeIndices(indexCopy.data(), indexCount, indexData))
+	{
+		return false;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "MSH1", 4);
+	header.version = MESH_FILE_VERSION;
+	header.vertexCount = (unsigned int)vertexCount;
+	header.vertexStride = (unsigned int)stride;
+	header.indexCount = (unsigned int)indexCount;
+	header.vertexBytes = (unsigned int)vertexData.size();
+	header.indexBytes = (unsigned int)indexData.size();
+
+	if (fopen_s(&filePtr, filename, "wb") != 0)
+	{
+		return false;
+	}
+
+	count = fwrite(&header, sizeof(header), 1, filePtr);
+	count += fwrite(vertexData.data(), 1, vertexData.size(), filePtr);
+	count += fwrite(indexData.data(), 1, indexData.size(), filePtr);
+	fclose(filePtr);
+
+	return count == 1 + vertexData.size() + indexData.size();
+}
+
+bool MeshCodecClass::ReadMesh(const char* filename, int stride, vector<unsigned char>& vertices, vector<unsigned long>& indices)
+{
+	vector<unsigned char> data;
+	MeshHeaderType header;
+	FILE* filePtr;
+	size_t count;
+	unsigned int i;
+
+	if (fopen_s(&filePtr, filename, "rb") != 0)
+	{
+		return false;
+	}
+
+	count = fread(&header, sizeof(header), 1, filePtr);
+	if (count != 1 || memcmp(header.magic, "MSH1", 4) != 0 || header.version != MESH_FILE_VERSION || header.vertexStride != (unsigned int)stride ||
+		header.vertexCount > 0x7FFFFFFF || header.indexCount > 0x7FFFFFFF || header.indexCount % 3 != 0)
+	{
+		fclose(filePtr);
+		return false;
+	}
+
+	data.resize((size_t)header.vertexBytes + header.indexBytes);
+	count = fread(data.data(), 1, data.size(), filePtr);
+	fclose(filePtr);
+	if (count != data.size())
+	{
+		return false;
+	}
+
+	vertices.resize((size_t)header.vertexCount * stride);
+	indices.resize(header.indexCount);
+
+	if (!DecodeVertices(data.data(), header.vertexBytes, (int)header.vertexCount, stride, vertices.data()) ||
+		!DecodeIndices(data.data() + header.vertexBytes, header.indexBytes, (int)header.indexCount, indices.data()))
+	{
+		return false;
+	}
+
+//	The indices decode from differences, so a damaged file can give back any value:
+	for (i = 0; i < header.indexCount; i++)
+	{
+		if (indices[i] >= header.vertexCount)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//	The header of a block has a byte for every four bytes of the vertex.
+int MeshCodecClass::GetHeaderSize(int stride)
+{
+	return (stride + 3) / 4;
+}
@@ -1,9 +1,17 @@
 #include "../Headers/modelclass.h"
 
+#include <string.h>
+#include "../Headers/meshcodecclass.h"
+
 ModelClass::ModelClass()
 {
 	m_vertexBuffer = 0;
 	m_indexBuffer = 0;
+	m_GeometryHeap = 0;
+	m_mesh = -1;
+	m_vertices = 0;
+	m_positions = 0;
+	m_indices = 0;
 }
 
 ModelClass::ModelClass(const ModelClass& other)
@@ -17,12 +25,14 @@ ModelClass::~ModelClass()
 }
 
 //	The Initialize function will call the initialization functions for the Vertex and Index Buffers.
-bool ModelClass::Initialize(ID3D11Device* device)
+bool ModelClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, GeometryHeapClass* geometryHeap, const char* filename)
 {
 	bool result;
 
+	m_GeometryHeap = geometryHeap;
+
 //	Initialize the Vertex and Index Buffers:
-	result = InitializeBuffers(device);
+	result = InitializeBuffers(device, deviceContext, filename);
 	if (!result)
 	{
 		return false;
@@ -45,7 +55,14 @@ void ModelClass::Shutdown()
 void ModelClass::Render(ID3D11DeviceContext* deviceContext)
 {
 //	Put the Vertex and index Buffers on the graphics pipeline to prepare them for drawing.
-	RenderBuffers(deviceContext);
+	if (m_GeometryHeap)
+	{
+		m_GeometryHeap->Render(deviceContext);
+	}
+	else
+	{
+		RenderBuffers(deviceContext);
+	}
 
 	return;
 }
@@ -57,36 +74,125 @@ int ModelClass::GetIndexCount()
 	return m_indexCount;
 }
 
+//	The heap may move the model while defragmenting, so the start index and base vertex are asked for every
+//	time. With buffers of its own the model starts at zero in both.
+int ModelClass::GetStartIndex()
+{
+	if (m_GeometryHeap)
+	{
+		return m_GeometryHeap->GetStartIndex(m_mesh);
+	}
+
+	return 0;
+}
+
+int ModelClass::GetBaseVertex()
+{
+	if (m_GeometryHeap)
+	{
+		return m_GeometryHeap->GetBaseVertex(m_mesh);
+	}
+
+	return 0;
+}
+
+//	The id of the model's mesh in the Geometry Heap, or -1 when it has buffers of its own.
+int ModelClass::GetMesh()
+{
+	return m_GeometryHeap ? m_mesh : -1;
+}
+
+unsigned int ModelClass::GetVertexStride()
+{
+	return sizeof(VertexType);
+}
+
+int ModelClass::GetVertexCount()
+{
+	return m_vertexCount;
+}
+
+const ModelClass::VertexType* ModelClass::GetVertices()
+{
+	return m_vertices;
+}
+
+const XMFLOAT3* ModelClass::GetPositions()
+{
+	return m_positions;
+}
+
+const unsigned long* ModelClass::GetIndices()
+{
+	return m_indices;
+}
+
 //	The InitializeBuffers function is where we handle creating the Vertex and Index Buffers.
-//	Usually, you would read in a model and create the buffers from that data file.
-bool ModelClass::InitializeBuffers(ID3D11Device* device)
+//	The model is read in from its mesh file, which is only made here, from the triangle, when it doesn't exist yet.
+bool ModelClass::InitializeBuffers(ID3D11Device* device, ID3D11DeviceContext* deviceContext, const char* filename)
 {
+	VertexType::SourceType* sources;
 	VertexType* vertices;
 	unsigned long* indices;
+	vector<unsigned char> meshVertices;
+	vector<unsigned long> meshIndices;
 	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
 	D3D11_SUBRESOURCE_DATA vertexData, indexData;
 	HRESULT result;
+	int i;
 
+	sources = 0;
+
+//	Import the mesh file. It has the vertices in the Vertex Type as they go into the buffer, so they are
+//	only copied into the Vertex Array:
+	if (MeshCodecClass::ReadMesh(filename, sizeof(VertexType), meshVertices, meshIndices))
+	{
+		m_vertexCount = (int)(meshVertices.size() / sizeof(VertexType));
+		m_indexCount = (int)meshIndices.size();
+
+		vertices = new VertexType[m_vertexCount];
+		if (!vertices)
+		{
+			return false;
+		}
+
+		indices = new unsigned long[m_indexCount];
+		if (!indices)
+		{
+			return false;
+		}
+
+		memcpy(vertices, meshVertices.data(), meshVertices.size());
+		memcpy(indices, meshIndices.data(), meshIndices.size() * sizeof(unsigned long));
+	}
+	else
+	{
 //	First create two temporary arrays to hold the Vertex and Index Data that we will use later:
 //	Set the number of vertices in the Vertex Array:
-	m_vertexCount = 3;
+		m_vertexCount = 3;
 
 //	Set the number of indices in the Index Array:
-	m_indexCount = 3;
+		m_indexCount = 3;
 
-//	Create the vertex Array:
-	vertices = new VertexType[m_vertexCount];
-	if (!vertices)
-	{
-		return false;
-	}
+//	Create the vertex Array, and the array of full float vertices it is packed from:
+		sources = new VertexType::SourceType[m_vertexCount];
+		if (!sources)
+		{
+			return false;
+		}
+
+		vertices = new VertexType[m_vertexCount];
+		if (!vertices)
+		{
+			return false;
+		}
 
 //	Create the Index Array:
-	indices = new unsigned long[m_indexCount];
-	if (!indices)
-	{
-		return false;
-	}
+		indices = new unsigned long[m_indexCount];
+		if (!indices)
+		{
+			return false;
+		}
 
 //	Now fill both the Vertex and Index array with the three points of the triangle as well as the index
 //	to each of the points. Please note that I create the points in the clockwise order of drawing them.
@@ -94,30 +200,47 @@ bool ModelClass::InitializeBuffers(ID3D11Device* device)
 // 	draw it due to back face culling. Always remember that the order in which you send your vertices to
 // 	the GPU is very important. The color is set here as well since it is part of the Vertex Description.
 
-//	Load the Vertex Array with data:
-	vertices[0].position = XMFLOAT3(-1.0f, -1.0f, 0.0f); 
-	vertices[0].color = XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f);
+//	Load the Vertex Array with data. The vertices are written as full floats and packed into the vertex
+//	format afterwards, so the format can be made compact without touching this:
+		sources[0].position = XMFLOAT3(-1.0f, -1.0f, 0.0f); 
+		sources[0].color = XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f);
+
+		sources[1].position = XMFLOAT3(0.0f, 1.0f, 0.0f);;
+		sources[1].color = XMFLOAT4(0.0f, 1.0f, 0.0f, 1.0f);
 
-	vertices[1].position = XMFLOAT3(0.0f, 1.0f, 0.0f);;
-	vertices[1].color = XMFLOAT4(0.0f, 1.0f, 0.0f, 1.0f);
+		sources[2].position = XMFLOAT3(1.0f, -1.0f, 0.0f);
+		sources[2].color = XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f);
 
-	vertices[2].position = XMFLOAT3(1.0f, -1.0f, 0.0f);
-	vertices[2].color = XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f);
+//	sources[3].position = XMFLOAT3(1.0f, -1.0f, -1.5f);
+//	sources[3].color = XMFLOAT4(0.0f, 1.0f, 0.0f, 1.0f);
 
-//	vertices[3].position = XMFLOAT3(1.0f, -1.0f, -1.5f);
-//	vertices[3].color = XMFLOAT4(0.0f, 1.0f, 0.0f, 1.0f);
+		VertexType::Pack(sources, m_vertexCount, vertices);
 
 
 //	Load the Index Array with Data:
-	indices[0] = 0;
-	indices[1] = 1;
-	indices[2] = 2;
+		indices[0] = 0;
+		indices[1] = 1;
+		indices[2] = 2;
 
 //	indices[3] = 3;
 //	indices[4] = 0;
 //	indices[5] = 2;
 
+//	Export the triangle, so the next run imports it. A model that can't be written is still drawn:
+		MeshCodecClass::WriteMesh(filename, vertices, m_vertexCount, sizeof(VertexType), indices, m_indexCount);
+	}
 
+//	With a Geometry Heap the arrays are copied into a block of its buffers instead of new buffers:
+	if (m_GeometryHeap)
+	{
+		m_mesh = m_GeometryHeap->CreateMesh(deviceContext, vertices, m_vertexCount, indices, m_indexCount);
+		if (m_mesh == -1)
+		{
+			return false;
+		}
+	}
+	else
+	{
 //	With the Vertex Array and Index Array filled out we can now use those to create the Vertex Buffer and Index Buffer.
 //	Creating both buffers is done in the same fashion. First fill out a description of th buffer. In the description,
 // 	the ByteWidth (size of the buffer) and the BindFlags (type of the buffer) are what you need to ensure are filled out
@@ -126,52 +249,66 @@ bool ModelClass::InitializeBuffers(ID3D11Device* device)
 //	CreateBuffer using the D3D device and it will return a pointer to your new buffer.
 
 // 	Setup the description of the static vertex buffer:
-	vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType) * m_vertexCount;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = 0;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
+		vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+		vertexBufferDesc.ByteWidth = sizeof(VertexType) * m_vertexCount;
+		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		vertexBufferDesc.CPUAccessFlags = 0;
+		vertexBufferDesc.MiscFlags = 0;
+		vertexBufferDesc.StructureByteStride = 0;
 
 //	Give the subresource structure a pointer to the Vertex Data.
-	vertexData.pSysMem = vertices;
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
+		vertexData.pSysMem = vertices;
+		vertexData.SysMemPitch = 0;
+		vertexData.SysMemSlicePitch = 0;
 
 //	Now create the Vertex Buffer.
-	result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &m_vertexBuffer);
-	if (FAILED(result))
-	{
-		return false;
-	}
+		result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &m_vertexBuffer);
+		if (FAILED(result))
+		{
+			return false;
+		}
 
 //	Setup the description of the Static Index Buffer:
-	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	indexBufferDesc.ByteWidth = sizeof(unsigned long) * m_indexCount;
-	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDesc.CPUAccessFlags = 0;
-	indexBufferDesc.MiscFlags = 0;
-	indexBufferDesc.StructureByteStride = 0;
+		indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+		indexBufferDesc.ByteWidth = sizeof(unsigned long) * m_indexCount;
+		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		indexBufferDesc.CPUAccessFlags = 0;
+		indexBufferDesc.MiscFlags = 0;
+		indexBufferDesc.StructureByteStride = 0;
 
 //	Create the subresource structure a pointer to the Index Data:
-	indexData.pSysMem = indices;
-	indexData.SysMemPitch = 0;
-	indexData.SysMemSlicePitch = 0;
+		indexData.pSysMem = indices;
+		indexData.SysMemPitch = 0;
+		indexData.SysMemSlicePitch = 0;
 
 //	Create the Index Buffer:
-	result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
-	if (FAILED(result))
-	{
-		return false;
+		result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
+		if (FAILED(result))
+		{
+			return false;
+		}
 	}
 
 //	After the Vertex Buffer and Index Buffer have been created you can delete the Vertex and Index arrays as
 //	theyre no longer needed since the data was copied into the Buffers.
-//	Release the Arrays now that the Vertex and Index Buffers have been created and loaded:
-	delete[] vertices;
+//	Release the Arrays now that the Vertex and Index Buffers have been created and loaded. The positions
+//	are copied out first, and the Vertex and Index Arrays are kept as they are:
+	m_positions = new XMFLOAT3[m_vertexCount];
+	for (i = 0; i < m_vertexCount; i++)
+	{
+		m_positions[i] = vertices[i].position;
+	}
+
+	m_vertices = vertices;
 	vertices = 0;
 
-	delete[] indices;
+	if (sources)
+	{
+		delete[] sources;
+		sources = 0;
+	}
+
+	m_indices = indices;
 	indices = 0;
 
 	return true;
@@ -182,6 +319,33 @@ bool ModelClass::InitializeBuffers(ID3D11Device* device)
 
 void ModelClass::ShutdownBuffers()
 {
+//	Release the CPU copies of the vertices, positions and indices:
+	if (m_indices)
+	{
+		delete[] m_indices;
+		m_indices = 0;
+	}
+
+	if (m_positions)
+	{
+		delete[] m_positions;
+		m_positions = 0;
+	}
+
+	if (m_vertices)
+	{
+		delete[] m_vertices;
+		m_vertices = 0;
+	}
+
+//	Give the model's blocks back to the Geometry Heap:
+	if (m_GeometryHeap)
+	{
+		m_GeometryHeap->ReleaseMesh(m_mesh);
+		m_mesh = -1;
+		m_GeometryHeap = 0;
+	}
+
 //	Release the Index Buffers:
 	if (m_indexBuffer)
 	{
@@ -0,0 +1,91 @@
+//	The particle benchmark runs a fountain like the one of the scene on the job threads without a window or a
+//	device, and prints how many particles were killed, simulated and emitted per second and how long the depth
+//	sort of the live particles took. It is not part of the engine's project and is built on its own, for example
+//	from a developer command prompt with:
+//	cl /O2 /EHsc Source\particlebenchmarkmain.cpp Source\particlesystemclass.cpp Source\geometrystreamclass.cpp
+//	    Source\jobsystemclass.cpp
+//	and run as: particlebenchmark [particles] [frames]
+#include "../Headers/particlesystemclass.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+int main(int argc, char* argv[])
+{
+	JobSystemClass jobSystem;
+	ParticleSystemClass particles;
+	ParticleSystemClass::EmitterType emitter;
+	chrono::high_resolution_clock::time_point startTime;
+	XMVECTOR forward;
+	double updateTotal, sortTotal;
+	float rate, fastestRate, sortTime, fastestSort;
+	int particleCount, frameCount, i;
+
+	particleCount = argc > 1 ? atoi(argv[1]) : 500000;
+	frameCount = argc > 2 ? atoi(argv[2]) : 300;
+	if (particleCount <= 0 || frameCount <= 0)
+	{
+		fprintf(stderr, "usage: %s [particles] [frames]\n", argv[0]);
+		return 1;
+	}
+
+	jobSystem.Initialize(0);
+
+//	The fountain of the scene, emitting fast enough to keep the arrays full:
+	emitter.position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	emitter.velocity = XMFLOAT3(0.0f, 4.0f, 0.0f);
+	emitter.velocitySpread = XMFLOAT3(0.8f, 0.8f, 0.8f);
+	emitter.gravity = XMFLOAT3(0.0f, -2.5f, 0.0f);
+	emitter.minLifetime = 1.5f;
+	emitter.maxLifetime = 3.0f;
+	emitter.emissionRate = (float)particleCount / emitter.minLifetime;
+	emitter.startSize = 0.04f;
+	emitter.endSize = 0.1f;
+	emitter.startColor = XMFLOAT4(1.0f, 0.9f, 0.4f, 1.0f);
+	emitter.endColor = XMFLOAT4(1.0f, 0.2f, 0.1f, 0.0f);
+	emitter.alphaBlended = true;
+
+	if (!particles.Initialize(NULL, particleCount, emitter))
+	{
+		fprintf(stderr, "Could not create %d particles\n", particleCount);
+		return 1;
+	}
+
+//	Run for the longest lifetime first, so particles are dying as fast as they are emitted:
+	for (i = 0; i < 180; i++)
+	{
+		particles.Update(&jobSystem, 1.0f / 60.0f);
+	}
+
+	forward = XMVector3Normalize(XMVectorSet(0.3f, -0.2f, 1.0f, 0.0f));
+
+	fastestRate = 0.0f;
+	fastestSort = 1.0e9f;
+	updateTotal = 0.0;
+	sortTotal = 0.0;
+	for (i = 0; i < frameCount; i++)
+	{
+		particles.Update(&jobSystem, 1.0f / 60.0f);
+
+		rate = particles.GetParticlesPerSecond();
+		fastestRate = rate > fastestRate ? rate : fastestRate;
+		updateTotal += rate;
+
+		startTime = chrono::high_resolution_clock::now();
+		particles.SortByDepth(&jobSystem, forward);
+		sortTime = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+
+		fastestSort = sortTime < fastestSort ? sortTime : fastestSort;
+		sortTotal += sortTime;
+	}
+
+	printf("%d particles alive of %d, %d threads: update %.1f million particles/s best, %.1f average; sort %.3f ms best, %.3f ms average\n",
+		particles.GetParticleCount(), particleCount, jobSystem.GetThreadCount(), fastestRate / 1.0e6f, updateTotal / frameCount / 1.0e6,
+		fastestSort, sortTotal / frameCount);
+
+	particles.Shutdown();
+	jobSystem.Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,594 @@
+#include "../Headers/particlesystemclass.h"
+
+#include <malloc.h>
+#include <string.h>
+#include <chrono>
+
+ParticleSystemClass::ParticleSystemClass()
+{
+	m_capacity = 0;
+	m_particleCount = 0;
+	m_positionX = 0;
+	m_positionY = 0;
+	m_positionZ = 0;
+	m_velocityX = 0;
+	m_velocityY = 0;
+	m_velocityZ = 0;
+	m_age = 0;
+	m_lifetime = 0;
+	m_drawOrder = 0;
+	m_emitAccumulator = 0.0f;
+	m_emitSeed = 0;
+	m_particlesPerSecond = 0.0f;
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_instanceOffset = 0;
+	m_instanceCount = 0;
+}
+
+ParticleSystemClass::ParticleSystemClass(const ParticleSystemClass& other)
+{
+
+}
+
+ParticleSystemClass::~ParticleSystemClass()
+{
+
+}
+
+//	Initialize sets aside the arrays for the given number of particles. Without a device the quad is not
+//	created and Render must not be called, which leaves the simulation and the sort to be timed on their own.
+bool ParticleSystemClass::Initialize(ID3D11Device* device, int maxParticles, const EmitterType& emitter)
+{
+	bool result;
+
+	if (maxParticles <= 0 || emitter.maxLifetime <= 0.0f)
+	{
+		return false;
+	}
+
+	m_emitter = emitter;
+
+	result = InitializeArrays(maxParticles);
+	if (!result)
+	{
+		return false;
+	}
+
+	if (device)
+	{
+		result = InitializeBuffers(device);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ParticleSystemClass::Shutdown()
+{
+	ShutdownBuffers();
+	ShutdownArrays();
+
+	return;
+}
+
+//	Update first simulates every chunk of particles and packs the survivors of each chunk to its front,
+//	then closes the gaps between the chunks and finally emits the new particles at the end of the arrays.
+//	Killing particles this way keeps them in the order they were emitted, which the sort benefits from.
+void ParticleSystemClass::Update(JobSystemClass* jobSystem, float frameTime)
+{
+	chrono::high_resolution_clock::time_point startTime;
+	float elapsed;
+	int chunk, chunkCount, write, simulated, emitCount, first;
+
+	startTime = chrono::high_resolution_clock::now();
+	simulated = m_particleCount;
+
+//	Simulate and kill. The job may get a range of several chunks when it runs on one thread, so it
+//	always works chunk by chunk to keep the chunk counts in the same place:
+	chunkCount = (m_particleCount + PARTICLE_BATCH_SIZE - 1) / PARTICLE_BATCH_SIZE;
+	jobSystem->ParallelFor(m_particleCount, PARTICLE_BATCH_SIZE, [this, frameTime](int begin, int end)
+	{
+		int chunkBegin, chunkEnd;
+
+		for (chunkBegin = begin; chunkBegin < end; chunkBegin += PARTICLE_BATCH_SIZE)
+		{
+			chunkEnd = (chunkBegin + PARTICLE_BATCH_SIZE < end) ? chunkBegin + PARTICLE_BATCH_SIZE : end;
+			m_chunkCounts[chunkBegin / PARTICLE_BATCH_SIZE] = SimulateChunk(chunkBegin, chunkEnd, frameTime);
+		}
+	});
+
+//	Move the survivors of every chunk down against the ones before them. This is one block move per
+//	chunk and property rather than any work per particle:
+	write = 0;
+	for (chunk = 0; chunk < chunkCount; chunk++)
+	{
+		if (write != chunk * PARTICLE_BATCH_SIZE)
+		{
+			MoveParticles(write, chunk * PARTICLE_BATCH_SIZE, m_chunkCounts[chunk]);
+		}
+		write += m_chunkCounts[chunk];
+	}
+	m_particleCount = write;
+
+//	Emit the particles that are due this frame, as many as fit:
+	m_emitAccumulator += m_emitter.emissionRate * frameTime;
+	emitCount = (int)m_emitAccumulator;
+	m_emitAccumulator -= (float)emitCount;
+
+	if (emitCount > m_capacity - m_particleCount)
+	{
+		emitCount = m_capacity - m_particleCount;
+	}
+
+	first = m_particleCount;
+	jobSystem->ParallelFor(emitCount, PARTICLE_BATCH_SIZE, [this, first](int begin, int end)
+	{
+		EmitParticles(first + begin, first + end);
+	});
+
+	m_particleCount += emitCount;
+	m_emitSeed++;
+
+	elapsed = chrono::duration<float>(chrono::high_resolution_clock::now() - startTime).count();
+	if (elapsed > 0.0f)
+	{
+		m_particlesPerSecond = (float)(simulated + emitCount) / elapsed;
+	}
+
+	return;
+}
+
+//	WriteInstances reserves room for every live particle in the Geometry Stream and fills it with
+//	billboards facing the camera, on the job threads. It must be called between the stream's BeginFrame
+//	and EndFrame, and returns false if the stream has no room left this frame.
+bool ParticleSystemClass::WriteInstances(JobSystemClass* jobSystem, GeometryStreamClass* stream, XMMATRIX viewMatrix)
+{
+	XMMATRIX cameraMatrix;
+	InstanceType* instances;
+
+	m_instanceCount = 0;
+	if (m_particleCount == 0)
+	{
+		return true;
+	}
+
+//	The rows of the inverse view matrix are the camera's right, up and forward axes and its position:
+	cameraMatrix = XMMatrixInverse(NULL, viewMatrix);
+
+	m_drawOrder = 0;
+	if (m_emitter.alphaBlended)
+	{
+		SortByDepth(jobSystem, cameraMatrix.r[2]);
+	}
+
+	instances = (InstanceType*)stream->Reserve(sizeof(InstanceType) * m_particleCount, sizeof(InstanceType), m_instanceOffset);
+	if (!instances)
+	{
+		return false;
+	}
+
+	jobSystem->ParallelFor(m_particleCount, PARTICLE_BATCH_SIZE, [this, instances, &cameraMatrix](int begin, int end)
+	{
+		XMVECTOR startColor, endColor;
+		float t, size;
+		int i, particle;
+
+		startColor = XMLoadFloat4(&m_emitter.startColor);
+		endColor = XMLoadFloat4(&m_emitter.endColor);
+
+		for (i = begin; i < end; i++)
+		{
+			particle = m_drawOrder ? (int)m_drawOrder[i] : i;
+
+			t = m_age[particle] / m_lifetime[particle];
+			size = m_emitter.startSize + (m_emitter.endSize - m_emitter.startSize) * t;
+
+			XMStoreFloat4(&instances[i].world0, XMVectorScale(cameraMatrix.r[0], size));
+			XMStoreFloat4(&instances[i].world1, XMVectorScale(cameraMatrix.r[1], size));
+			XMStoreFloat4(&instances[i].world2, cameraMatrix.r[2]);
+			instances[i].world3 = XMFLOAT4(m_positionX[particle], m_positionY[particle], m_positionZ[particle], 1.0f);
+			XMStoreFloat4(&instances[i].color, XMVectorLerp(startColor, endColor, t));
+		}
+	});
+
+	m_instanceCount = m_particleCount;
+
+	return true;
+}
+
+//	Render puts the quad in the first vertex buffer slot and the instances written this frame in the
+//	second, ready for ColorShaderClass::RenderInstanced.
+void ParticleSystemClass::Render(ID3D11DeviceContext* deviceContext, GeometryStreamClass* stream)
+{
+	ID3D11Buffer* buffers[2];
+	unsigned int strides[2];
+	unsigned int offsets[2];
+
+	buffers[0] = m_vertexBuffer;
+	buffers[1] = stream->GetBuffer();
+	strides[0] = sizeof(VertexType);
+	strides[1] = sizeof(InstanceType);
+	offsets[0] = 0;
+	offsets[1] = m_instanceOffset;
+
+	deviceContext->IASetVertexBuffers(0, 2, buffers, strides, offsets);
+	deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	return;
+}
+
+int ParticleSystemClass::GetIndexCount()
+{
+	return 6;
+}
+
+int ParticleSystemClass::GetInstanceCount()
+{
+	return m_instanceCount;
+}
+
+int ParticleSystemClass::GetParticleCount()
+{
+	return m_particleCount;
+}
+
+bool ParticleSystemClass::IsAlphaBlended()
+{
+	return m_emitter.alphaBlended;
+}
+
+float ParticleSystemClass::GetParticlesPerSecond()
+{
+	return m_particlesPerSecond;
+}
+
+//	InitializeArrays allocates one aligned array per property, with the capacity rounded up to the SIMD
+//	width. The arrays are cleared so the padding never holds values that are slow to compute with.
+bool ParticleSystemClass::InitializeArrays(int maxParticles)
+{
+	float** arrays[8];
+	size_t size;
+	int i;
+
+	m_capacity = ((maxParticles + PARTICLE_SIMD_WIDTH - 1) / PARTICLE_SIMD_WIDTH) * PARTICLE_SIMD_WIDTH;
+	m_particleCount = 0;
+	size = sizeof(float) * m_capacity;
+
+	arrays[0] = &m_positionX;
+	arrays[1] = &m_positionY;
+	arrays[2] = &m_positionZ;
+	arrays[3] = &m_velocityX;
+	arrays[4] = &m_velocityY;
+	arrays[5] = &m_velocityZ;
+	arrays[6] = &m_age;
+	arrays[7] = &m_lifetime;
+
+	for (i = 0; i < 8; i++)
+	{
+		*arrays[i] = (float*)_aligned_malloc(size, PARTICLE_ALIGNMENT);
+		if (!*arrays[i])
+		{
+			return false;
+		}
+		memset(*arrays[i], 0, size);
+	}
+
+	m_chunkCounts.resize((m_capacity + PARTICLE_BATCH_SIZE - 1) / PARTICLE_BATCH_SIZE);
+	for (i = 0; i < 2; i++)
+	{
+		m_sortKeys[i].resize(m_capacity);
+		m_sortIndices[i].resize(m_capacity);
+	}
+
+	return true;
+}
+
+void ParticleSystemClass::ShutdownArrays()
+{
+	float** arrays[8];
+	int i;
+
+	arrays[0] = &m_positionX;
+	arrays[1] = &m_positionY;
+	arrays[2] = &m_positionZ;
+	arrays[3] = &m_velocityX;
+	arrays[4] = &m_velocityY;
+	arrays[5] = &m_velocityZ;
+	arrays[6] = &m_age;
+	arrays[7] = &m_lifetime;
+
+	for (i = 0; i < 8; i++)
+	{
+		if (*arrays[i])
+		{
+			_aligned_free(*arrays[i]);
+			*arrays[i] = 0;
+		}
+	}
+
+	m_chunkCounts.clear();
+	for (i = 0; i < 2; i++)
+	{
+		m_sortKeys[i].clear();
+		m_sortIndices[i].clear();
+	}
+	m_drawOrder = 0;
+	m_particleCount = 0;
+
+	return;
+}
+
+//	InitializeBuffers creates the unit quad in the XY plane that every particle is drawn with, wound
+//	clockwise as seen from the camera side.
+bool ParticleSystemClass::InitializeBuffers(ID3D11Device* device)
+{
+	VertexType vertices[4];
+	unsigned long indices[6];
+	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
+	D3D11_SUBRESOURCE_DATA vertexData, indexData;
+	HRESULT result;
+
+	vertices[0].position = XMFLOAT3(-0.5f, -0.5f, 0.0f);
+	vertices[1].position = XMFLOAT3(-0.5f, 0.5f, 0.0f);
+	vertices[2].position = XMFLOAT3(0.5f, 0.5f, 0.0f);
+	vertices[3].position = XMFLOAT3(0.5f, -0.5f, 0.0f);
+	vertices[0].color = vertices[1].color = vertices[2].color = vertices[3].color = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+
+	indices[0] = 0;
+	indices[1] = 1;
+	indices[2] = 2;
+	indices[3] = 0;
+	indices[4] = 2;
+	indices[5] = 3;
+
+//	Setup the description of the static vertex buffer:
+	vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	vertexBufferDesc.ByteWidth = sizeof(vertices);
+	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	vertexBufferDesc.CPUAccessFlags = 0;
+	vertexBufferDesc.MiscFlags = 0;
+	vertexBufferDesc.StructureByteStride = 0;
+
+	vertexData.pSysMem = vertices;
+	vertexData.SysMemPitch = 0;
+	vertexData.SysMemSlicePitch = 0;
+
+	result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &m_vertexBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+//	Setup the description of the static index buffer:
+	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	indexBufferDesc.ByteWidth = sizeof(indices);
+	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	indexBufferDesc.CPUAccessFlags = 0;
+	indexBufferDesc.MiscFlags = 0;
+	indexBufferDesc.StructureByteStride = 0;
+
+	indexData.pSysMem = indices;
+	indexData.SysMemPitch = 0;
+	indexData.SysMemSlicePitch = 0;
+
+	result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void ParticleSystemClass::ShutdownBuffers()
+{
+	if (m_indexBuffer)
+	{
+		m_indexBuffer->Release();
+		m_indexBuffer = 0;
+	}
+
+	if (m_vertexBuffer)
+	{
+		m_vertexBuffer->Release();
+		m_vertexBuffer = 0;
+	}
+
+	return;
+}
+
+//	SimulateChunk integrates four particles at a time, then packs the ones still alive to the front of
+//	the chunk and returns how many there are. The packing copies every particle and only advances the
+//	write position by the result of the comparison, so there is no branch for the CPU to mispredict.
+int ParticleSystemClass::SimulateChunk(int begin, int end, float frameTime)
+{
+	XMVECTOR deltaTime, gravityX, gravityY, gravityZ;
+	XMVECTOR velocityX, velocityY, velocityZ;
+	int i, write;
+
+	deltaTime = XMVectorReplicate(frameTime);
+	gravityX = XMVectorReplicate(m_emitter.gravity.x * frameTime);
+	gravityY = XMVectorReplicate(m_emitter.gravity.y * frameTime);
+	gravityZ = XMVectorReplicate(m_emitter.gravity.z * frameTime);
+
+//	Chunks start on a multiple of the SIMD width and the arrays are padded, so the last group of four
+//	may run into the padding but never past the end of the arrays:
+	for (i = begin; i < end; i += 4)
+	{
+		velocityX = XMVectorAdd(XMLoadFloat4A((const XMFLOAT4A*)&m_velocityX[i]), gravityX);
+		velocityY = XMVectorAdd(XMLoadFloat4A((const XMFLOAT4A*)&m_velocityY[i]), gravityY);
+		velocityZ = XMVectorAdd(XMLoadFloat4A((const XMFLOAT4A*)&m_velocityZ[i]), gravityZ);
+
+		XMStoreFloat4A((XMFLOAT4A*)&m_velocityX[i], velocityX);
+		XMStoreFloat4A((XMFLOAT4A*)&m_velocityY[i], velocityY);
+		XMStoreFloat4A((XMFLOAT4A*)&m_velocityZ[i], velocityZ);
+
+		XMStoreFloat4A((XMFLOAT4A*)&m_positionX[i], XMVectorMultiplyAdd(velocityX, deltaTime, XMLoadFloat4A((const XMFLOAT4A*)&m_positionX[i])));
+		XMStoreFloat4A((XMFLOAT4A*)&m_positionY[i], XMVectorMultiplyAdd(velocityY, deltaTime, XMLoadFloat4A((const XMFLOAT4A*)&m_positionY[i])));
+		XMStoreFloat4A((XMFLOAT4A*)&m_positionZ[i], XMVectorMultiplyAdd(velocityZ, deltaTime, XMLoadFloat4A((const XMFLOAT4A*)&m_positionZ[i])));
+
+		XMStoreFloat4A((XMFLOAT4A*)&m_age[i], XMVectorAdd(XMLoadFloat4A((const XMFLOAT4A*)&m_age[i]), deltaTime));
+	}
+
+	write = begin;
+	for (i = begin; i < end; i++)
+	{
+		m_positionX[write] = m_positionX[i];
+		m_positionY[write] = m_positionY[i];
+		m_positionZ[write] = m_positionZ[i];
+		m_velocityX[write] = m_velocityX[i];
+		m_velocityY[write] = m_velocityY[i];
+		m_velocityZ[write] = m_velocityZ[i];
+		m_age[write] = m_age[i];
+		m_lifetime[write] = m_lifetime[i];
+
+		write += (int)(m_age[i] < m_lifetime[i]);
+	}
+
+	return write - begin;
+}
+
+//	EmitParticles starts the particles in [begin, end). Random numbers come from hashing the particle
+//	index with the frame's seed, so the job threads need no shared generator and the result does not
+//	depend on how the range was split.
+void ParticleSystemClass::EmitParticles(int begin, int end)
+{
+	unsigned int hash;
+	float random[4];
+	int i, j;
+
+	for (i = begin; i < end; i++)
+	{
+		hash = (unsigned int)i * 0x9E3779B9u ^ m_emitSeed * 0x85EBCA6Bu;
+		for (j = 0; j < 4; j++)
+		{
+			hash ^= hash >> 16;
+			hash *= 0x7FEB352Du;
+			hash ^= hash >> 15;
+			hash *= 0x846CA68Bu;
+			hash ^= hash >> 16;
+			random[j] = (float)(hash >> 8) * (1.0f / 16777216.0f);
+		}
+
+		m_positionX[i] = m_emitter.position.x;
+		m_positionY[i] = m_emitter.position.y;
+		m_positionZ[i] = m_emitter.position.z;
+		m_velocityX[i] = m_emitter.velocity.x + m_emitter.velocitySpread.x * (2.0f * random[0] - 1.0f);
+		m_velocityY[i] = m_emitter.velocity.y + m_emitter.velocitySpread.y * (2.0f * random[1] - 1.0f);
+		m_velocityZ[i] = m_emitter.velocity.z + m_emitter.velocitySpread.z * (2.0f * random[2] - 1.0f);
+		m_age[i] = 0.0f;
+		m_lifetime[i] = m_emitter.minLifetime + (m_emitter.maxLifetime - m_emitter.minLifetime) * random[3];
+	}
+
+	return;
+}
+
+//	MoveParticles moves a block of particles down to a lower index. The ranges may overlap.
+void ParticleSystemClass::MoveParticles(int destination, int source, int count)
+{
+	size_t size;
+
+	size = sizeof(float) * count;
+
+	memmove(&m_positionX[destination], &m_positionX[source], size);
+	memmove(&m_positionY[destination], &m_positionY[source], size);
+	memmove(&m_positionZ[destination], &m_positionZ[source], size);
+	memmove(&m_velocityX[destination], &m_velocityX[source], size);
+	memmove(&m_velocityY[destination], &m_velocityY[source], size);
+	memmove(&m_velocityZ[destination], &m_velocityZ[source], size);
+	memmove(&m_age[destination], &m_age[source], size);
+	memmove(&m_lifetime[destination], &m_lifetime[source], size);
+
+	return;
+}
+
+//	SortByDepth orders the particles from farthest to nearest along the view direction. The keys are
+//	computed on the job threads: the depth's float bits are flipped so they sort as unsigned integers,
+//	and inverted so the farthest particle comes first. The radix sort itself then makes three stable
+//	counting passes over them.
+void ParticleSystemClass::SortByDepth(JobSystemClass* jobSystem, XMVECTOR forward)
+{
+	unsigned int histogram[1 << PARTICLE_SORT_BITS];
+	unsigned int* keys, * indices, * sortedKeys, * sortedIndices, * swap;
+	unsigned int total, digit, count;
+	int pass, i;
+
+	keys = m_sortKeys[0].data();
+	indices = m_sortIndices[0].data();
+	sortedKeys = m_sortKeys[1].data();
+	sortedIndices = m_sortIndices[1].data();
+
+	jobSystem->ParallelFor(m_particleCount, PARTICLE_BATCH_SIZE, [this, keys, indices, forward](int begin, int end)
+	{
+		XMFLOAT4A depths;
+		XMVECTOR forwardX, forwardY, forwardZ, depth;
+		unsigned int bits;
+		int i, j;
+
+		forwardX = XMVectorSplatX(forward);
+		forwardY = XMVectorSplatY(forward);
+		forwardZ = XMVectorSplatZ(forward);
+
+//	The camera's own depth along the view direction is the same for every particle, so it is left out:
+		for (i = begin; i < end; i += 4)
+		{
+			depth = XMVectorMultiply(XMLoadFloat4A((const XMFLOAT4A*)&m_positionX[i]), forwardX);
+			depth = XMVectorMultiplyAdd(XMLoadFloat4A((const XMFLOAT4A*)&m_positionY[i]), forwardY, depth);
+			depth = XMVectorMultiplyAdd(XMLoadFloat4A((const XMFLOAT4A*)&m_positionZ[i]), forwardZ, depth);
+			XMStoreFloat4A(&depths, depth);
+
+			for (j = 0; j < 4 && i + j < end; j++)
+			{
+				memcpy(&bits, &(&depths.x)[j], sizeof(bits));
+				bits ^= (unsigned int)((int)bits >> 31) | 0x80000000u;
+
+				keys[i + j] = ~bits;
+				indices[i + j] = (unsigned int)(i + j);
+			}
+		}
+	});
+
+	count = (unsigned int)m_particleCount;
+	for (pass = 0; pass * PARTICLE_SORT_BITS < 32; pass++)
+	{
+		memset(histogram, 0, sizeof(histogram));
+		for (i = 0; i < (int)count; i++)
+		{
+			histogram[(keys[i] >> (pass * PARTICLE_SORT_BITS)) & ((1 << PARTICLE_SORT_BITS) - 1)]++;
+		}
+
+//	Turn the counts into the first output position of every digit:
+		total = 0;
+		for (i = 0; i < (1 << PARTICLE_SORT_BITS); i++)
+		{
+			digit = histogram[i];
+			histogram[i] = total;
+			total += digit;
+		}
+
+		for (i = 0; i < (int)count; i++)
+		{
+			digit = (keys[i] >> (pass * PARTICLE_SORT_BITS)) & ((1 << PARTICLE_SORT_BITS) - 1);
+			sortedKeys[histogram[digit]] = keys[i];
+			sortedIndices[histogram[digit]] = indices[i];
+			histogram[digit]++;
+		}
+
+		swap = keys;
+		keys = sortedKeys;
+		sortedKeys = swap;
+
+		swap = indices;
+		indices = sortedIndices;
+		sortedIndices = swap;
+	}
+
+	m_drawOrder = indices;
+
+	return;
+}
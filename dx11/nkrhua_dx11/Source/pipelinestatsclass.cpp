@@ -0,0 +1,58 @@
+#include "../Headers/pipelinestatsclass.h"
+
+#include <stdio.h>
+
+PipelineStatsClass::PipelineStatsClass()
+{
+	m_latencyTotal = 0.0;
+	m_latencyMaximum = 0.0f;
+	m_latencyFrames = 0;
+	m_repeatedFrames = 0;
+}
+
+PipelineStatsClass::PipelineStatsClass(const PipelineStatsClass& other)
+{
+
+}
+
+PipelineStatsClass::~PipelineStatsClass()
+{
+
+}
+
+void PipelineStatsClass::AddFrame(float latency)
+{
+	m_latencyTotal += latency;
+	m_latencyMaximum = latency > m_latencyMaximum ? latency : m_latencyMaximum;
+	m_latencyFrames++;
+
+	return;
+}
+
+void PipelineStatsClass::AddRepeatedFrame()
+{
+	m_repeatedFrames++;
+
+	return;
+}
+
+//	WriteReport appends the steps published, the snapshots no frame drew, the frames that drew the same
+//	snapshot again and the mean and largest latency.
+void PipelineStatsClass::WriteReport(const char* filename, TripleBufferClass* snapshotBuffer, bool threaded, int rate)
+{
+	FILE* reportPtr;
+
+	if (fopen_s(&reportPtr, filename, "a") != 0)
+	{
+		return;
+	}
+
+	fprintf(reportPtr, "%s simulation at %d Hz: %d steps published, %d never drawn, %d of %d frames drew the last snapshot again\n",
+		threaded ? "threaded" : "inline", rate, snapshotBuffer->GetPublishCount(), snapshotBuffer->GetDroppedCount(),
+		m_repeatedFrames, m_latencyFrames);
+	fprintf(reportPtr, "latency: mean %.2f ms, max %.2f ms\n\n", m_latencyFrames > 0 ? m_latencyTotal / m_latencyFrames : 0.0, m_latencyMaximum);
+
+	fclose(reportPtr);
+
+	return;
+}
@@ -0,0 +1,292 @@
+#include "../Headers/renderstatsclass.h"
+
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+//	The names of the counters in the exports, in the order of RenderStat.
+static const char* RENDER_STAT_NAMES[STAT_COUNT] =
+{
+	"frame_ms",
+	"draws",
+	"primitives",
+	"state_binds",
+	"maps",
+	"unmaps",
+	"upload_bytes",
+	"culled_objects",
+	"memory_bytes",
+	"latency_ms"
+};
+
+RenderStatsClass::RenderStatsClass()
+{
+	memset(m_current, 0, sizeof(m_current));
+	memset(m_last, 0, sizeof(m_last));
+	m_windowSize = 0;
+	m_windowCount = 0;
+	m_windowNext = 0;
+	m_frameCount = 0;
+	m_csvFile = 0;
+}
+
+RenderStatsClass::RenderStatsClass(const RenderStatsClass& other)
+{
+
+}
+
+RenderStatsClass::~RenderStatsClass()
+{
+
+}
+
+bool RenderStatsClass::Initialize(int windowSize, const char* csvFilename)
+{
+	int i;
+
+	if (windowSize < 1)
+	{
+		return false;
+	}
+
+	m_windowSize = windowSize;
+	m_window.assign((size_t)windowSize * STAT_COUNT, 0.0);
+	m_sorted.reserve(windowSize);
+
+//	The CSV file starts over with its header every run:
+	if (csvFilename && csvFilename[0] != 0)
+	{
+#ifdef _MSC_VER
+		if (fopen_s(&m_csvFile, csvFilename, "w") != 0)
+		{
+			m_csvFile = 0;
+		}
+#else
+		m_csvFile = fopen(csvFilename, "w");
+#endif
+		if (!m_csvFile)
+		{
+			return false;
+		}
+
+		fprintf(m_csvFile, "frame");
+		for (i = 0; i < STAT_COUNT; i++)
+		{
+			fprintf(m_csvFile, ",%s", RENDER_STAT_NAMES[i]);
+		}
+		fprintf(m_csvFile, "\n");
+	}
+
+	return true;
+}
+
+void RenderStatsClass::Shutdown()
+{
+	if (m_csvFile)
+	{
+		fclose(m_csvFile);
+		m_csvFile = 0;
+	}
+
+	m_window.clear();
+	m_sorted.clear();
+	m_windowCount = 0;
+	m_windowNext = 0;
+
+	return;
+}
+
+//	Add counts towards the frame being drawn, and Set is for what is a level rather than a count, like memory.
+void RenderStatsClass::Add(int stat, double value)
+{
+	m_current[stat] += value;
+
+	return;
+}
+
+void RenderStatsClass::Set(int stat, double value)
+{
+	m_current[stat] = value;
+
+	return;
+}
+
+//	EndFrame puts the counters of the frame in the place of the oldest frame of the window and starts the
+//	next frame from zero.
+void RenderStatsClass::EndFrame()
+{
+	int i;
+
+	for (i = 0; i < STAT_COUNT; i++)
+	{
+		GetWindow(i)[m_windowNext] = m_current[i];
+	}
+
+	m_windowNext = (m_windowNext + 1) % m_windowSize;
+	m_windowCount = m_windowCount < m_windowSize ? m_windowCount + 1 : m_windowSize;
+
+	if (m_csvFile)
+	{
+		fprintf(m_csvFile, "%d", m_frameCount);
+		for (i = 0; i < STAT_COUNT; i++)
+		{
+			fprintf(m_csvFile, ",%.17g", m_current[i]);
+		}
+		fprintf(m_csvFile, "\n");
+	}
+
+	memcpy(m_last, m_current, sizeof(m_last));
+	memset(m_current, 0, sizeof(m_current));
+	m_frameCount++;
+
+	return;
+}
+
+int RenderStatsClass::GetFrameCount()
+{
+	return m_frameCount;
+}
+
+int RenderStatsClass::GetWindowCount()
+{
+	return m_windowCount;
+}
+
+//	The counter of the frame that was ended last.
+double RenderStatsClass::GetLast(int stat)
+{
+	return m_last[stat];
+}
+
+double RenderStatsClass::GetMinimum(int stat)
+{
+	double* window;
+	double minimum;
+	int i;
+
+	if (m_windowCount == 0)
+	{
+		return 0.0;
+	}
+
+	window = GetWindow(stat);
+	minimum = window[0];
+	for (i = 1; i < m_windowCount; i++)
+	{
+		minimum = window[i] < minimum ? window[i] : minimum;
+	}
+
+	return minimum;
+}
+
+double RenderStatsClass::GetMean(int stat)
+{
+	double* window;
+	double total;
+	int i;
+
+	if (m_windowCount == 0)
+	{
+		return 0.0;
+	}
+
+	window = GetWindow(stat);
+	total = 0.0;
+	for (i = 0; i < m_windowCount; i++)
+	{
+		total += window[i];
+	}
+
+	return total / m_windowCount;
+}
+
+double RenderStatsClass::GetMaximum(int stat)
+{
+	double* window;
+	double maximum;
+	int i;
+
+	if (m_windowCount == 0)
+	{
+		return 0.0;
+	}
+
+	window = GetWindow(stat);
+	maximum = window[0];
+	for (i = 1; i < m_windowCount; i++)
+	{
+		maximum = window[i] > maximum ? window[i] : maximum;
+	}
+
+	return maximum;
+}
+
+//	GetPercentile gives the smallest value of the window that the given fraction of its frames are at or
+//	below, so the 0.99 percentile of 300 frames is the third largest.
+double RenderStatsClass::GetPercentile(int stat, float fraction)
+{
+	double* window;
+	int rank;
+
+	if (m_windowCount == 0)
+	{
+		return 0.0;
+	}
+
+	window = GetWindow(stat);
+	m_sorted.assign(window, window + m_windowCount);
+
+//	The fraction is a float, so 0.99 of 300 comes out a hair above 297 and is taken down before rounding up:
+	rank = (int)ceil((double)fraction * m_windowCount - 0.0001) - 1;
+	rank = rank < 0 ? 0 : rank;
+	rank = rank < m_windowCount - 1 ? rank : m_windowCount - 1;
+
+	nth_element(m_sorted.begin(), m_sorted.begin() + rank, m_sorted.end());
+
+	return m_sorted[rank];
+}
+
+//	WriteJSON writes the last frame and the window of every counter to the file, replacing what was in it, so
+//	the file always holds one whole object.
+bool RenderStatsClass::WriteJSON(const char* filename)
+{
+	FILE* filePtr;
+	int i;
+
+#ifdef _MSC_VER
+	if (fopen_s(&filePtr, filename, "w") != 0)
+	{
+		return false;
+	}
+#else
+	filePtr = fopen(filename, "w");
+	if (!filePtr)
+	{
+		return false;
+	}
+#endif
+
+	fprintf(filePtr, "{\n  \"frame\": %d,\n  \"window\": %d,\n  \"stats\": {\n", m_frameCount, m_windowCount);
+	for (i = 0; i < STAT_COUNT; i++)
+	{
+		fprintf(filePtr, "    \"%s\": { \"last\": %.17g, \"min\": %.17g, \"mean\": %.17g, \"p50\": %.17g, \"p99\": %.17g, \"max\": %.17g }%s\n",
+			RENDER_STAT_NAMES[i], GetLast(i), GetMinimum(i), GetMean(i), GetPercentile(i, 0.5f), GetPercentile(i, 0.99f), GetMaximum(i),
+			i < STAT_COUNT - 1 ? "," : "");
+	}
+	fprintf(filePtr, "  }\n}\n");
+
+	fclose(filePtr);
+
+	return true;
+}
+
+const char* RenderStatsClass::GetName(int stat)
+{
+	return RENDER_STAT_NAMES[stat];
+}
+
+//	The window keeps each counter in a run of its own, so its frames are next to each other.
+double* RenderStatsClass::GetWindow(int stat)
+{
+	return m_window.data() + (size_t)stat * m_windowSize;
+}
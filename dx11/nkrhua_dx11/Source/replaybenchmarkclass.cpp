@@ -0,0 +1,42 @@
+#include "../Headers/replaybenchmarkclass.h"
+
+#include <stdio.h>
+
+bool ReplayBenchmarkClass::Run(const char* filename, int loops, bool software, const char* report)
+{
+	CommandReplayClass replay;
+	D3DReplayBackendClass backend;
+	FILE* reportPtr;
+	bool result;
+
+	result = replay.Initialize(filename);
+	if (!result)
+	{
+		return false;
+	}
+
+	result = backend.Initialize(software);
+	if (!result)
+	{
+		backend.Shutdown();
+		replay.Shutdown();
+		return false;
+	}
+
+	result = replay.Play(&backend, loops);
+
+	backend.Shutdown();
+
+	if (result && fopen_s(&reportPtr, report, "a") == 0)
+	{
+		fprintf(reportPtr, "%s on the %s renderer, %d loops:\n", filename, software ? "software" : "hardware", loops);
+		replay.WriteReport(reportPtr);
+		fprintf(reportPtr, "\n");
+
+		fclose(reportPtr);
+	}
+
+	replay.Shutdown();
+
+	return result;
+}
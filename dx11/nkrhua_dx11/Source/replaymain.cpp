@@ -0,0 +1,61 @@
+//	The replay tool plays a command file captured by the engine through the null backend and writes the
+//	report of every draw, so captures can be looked at on machines without Direct3D. It is not part of the
+//	engine's project and is built on its own, for example with:
+//	g++ -O2 -o replay Source/replaymain.cpp Source/commandreplayclass.cpp
+//	and run as: replay frame.cmd [loops] [report]
+#include "../Headers/commandreplayclass.h"
+
+#include <stdlib.h>
+
+int main(int argc, char* argv[])
+{
+	CommandReplayClass* Replay;
+	FILE* filePtr;
+	int loops;
+	bool result;
+
+	if (argc < 2)
+	{
+		fprintf(stderr, "usage: %s file [loops] [report]\n", argv[0]);
+		return 1;
+	}
+
+	loops = argc > 2 ? atoi(argv[2]) : 1;
+	loops = loops > 1 ? loops : 1;
+
+	Replay = new CommandReplayClass;
+
+	result = Replay->Initialize(argv[1]);
+	if (!result)
+	{
+		fprintf(stderr, "Could not read the command file %s\n", argv[1]);
+		delete Replay;
+		return 1;
+	}
+
+	result = Replay->Play(0, loops);
+	if (!result)
+	{
+		fprintf(stderr, "Could not play the command file %s\n", argv[1]);
+		Replay->Shutdown();
+		delete Replay;
+		return 1;
+	}
+
+//	Write the report to the file given, or to the console:
+	filePtr = argc > 3 ? CommandReplayClass::OpenFile(argv[3], "a") : stdout;
+	if (filePtr)
+	{
+		Replay->WriteReport(filePtr);
+		if (filePtr != stdout)
+		{
+			fclose(filePtr);
+		}
+	}
+
+	Replay->Shutdown();
+	delete Replay;
+	Replay = 0;
+
+	return 0;
+}
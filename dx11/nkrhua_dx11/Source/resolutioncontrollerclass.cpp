@@ -0,0 +1,165 @@
+#include "../Headers/resolutioncontrollerclass.h"
+
+//	How much of each new frame time goes into the smoothed one. With a quarter, a change of scale has shown
+//	nine tenths of its effect by the end of the frames held after it.
+static const float RESOLUTION_SMOOTHING = 0.25f;
+
+//	The gains of the controller. Its output is the relative change of the scale, and the cost of a frame
+//	grows with the square of the scale, so half of the relative error would take the frame time right to
+//	the target if nothing else was in the frame.
+static const float RESOLUTION_PROPORTIONAL_GAIN = 0.5f;
+static const float RESOLUTION_INTEGRAL_GAIN = 0.1f;
+static const float RESOLUTION_DERIVATIVE_GAIN = 1.0f;
+static const float RESOLUTION_INTEGRAL_LIMIT = 2.0f;
+static const float RESOLUTION_INTEGRAL_DECAY = 0.9f;
+
+//	The band around the target the controller leaves the scale alone in, as fractions of the target: it drops
+//	the scale when the frames are 5% over and raises it when they are 15% under.
+static const float RESOLUTION_DROP_BAND = 0.05f;
+static const float RESOLUTION_RAISE_BAND = 0.15f;
+
+//	The frames to wait after a change, and the smallest change worth making.
+static const int RESOLUTION_SETTLE_FRAMES = 8;
+static const float RESOLUTION_MINIMUM_STEP = 0.01f;
+
+ResolutionControllerClass::ResolutionControllerClass()
+{
+	m_targetTime = 16.0f;
+	m_minimumScale = 1.0f;
+	m_maximumScale = 1.0f;
+	m_scale = 1.0f;
+	m_recentTimes[0] = m_recentTimes[1] = m_recentTimes[2] = 0.0f;
+	m_recentCount = 0;
+	m_smoothedTime = 0.0f;
+	m_lastSmoothedTime = 0.0f;
+	m_integral = 0.0f;
+	m_holdFrames = 0;
+	m_changeCount = 0;
+	m_started = false;
+}
+
+ResolutionControllerClass::ResolutionControllerClass(const ResolutionControllerClass& other)
+{
+
+}
+
+ResolutionControllerClass::~ResolutionControllerClass()
+{
+
+}
+
+void ResolutionControllerClass::Initialize(float targetTime, float minimumScale, float maximumScale)
+{
+	m_targetTime = targetTime;
+	m_minimumScale = minimumScale < maximumScale ? minimumScale : maximumScale;
+	m_maximumScale = maximumScale;
+
+	Reset();
+
+	return;
+}
+
+//	Reset goes back to the largest scale and forgets the frame times, for when the scene changes completely.
+void ResolutionControllerClass::Reset()
+{
+	m_scale = m_maximumScale;
+	m_recentCount = 0;
+	m_smoothedTime = 0.0f;
+	m_lastSmoothedTime = 0.0f;
+	m_integral = 0.0f;
+	m_holdFrames = 0;
+	m_changeCount = 0;
+	m_started = false;
+
+	return;
+}
+
+//	Update takes the time of the last frame in milliseconds and returns the scale to render the next one at.
+float ResolutionControllerClass::Update(float frameTime)
+{
+	float error, derivative, output, scale, low, high;
+	bool saturated;
+
+//	Take the median of the last three frame times, or of the ones there are so far. A lone frame far off
+//	the others is never the median, so it never reaches the smoothed time:
+	m_recentTimes[m_recentCount % 3] = frameTime;
+	m_recentCount++;
+	if (m_recentCount >= 3)
+	{
+		low = m_recentTimes[0] < m_recentTimes[1] ? m_recentTimes[0] : m_recentTimes[1];
+		high = m_recentTimes[0] < m_recentTimes[1] ? m_recentTimes[1] : m_recentTimes[0];
+		frameTime = m_recentTimes[2] < low ? low : (m_recentTimes[2] > high ? high : m_recentTimes[2]);
+	}
+
+	if (!m_started)
+	{
+		m_smoothedTime = frameTime;
+		m_lastSmoothedTime = frameTime;
+		m_started = true;
+	}
+	else
+	{
+		m_smoothedTime += RESOLUTION_SMOOTHING * (frameTime - m_smoothedTime);
+	}
+
+//	The error is positive when there is time to spare. The derivative is taken from the frame times rather
+//	than the error, which is the same thing, and positive when the frames are getting faster:
+	error = (m_targetTime - m_smoothedTime) / m_targetTime;
+	derivative = (m_lastSmoothedTime - m_smoothedTime) / m_targetTime;
+	m_lastSmoothedTime = m_smoothedTime;
+
+	if (m_holdFrames > 0)
+	{
+		m_holdFrames--;
+		return m_scale;
+	}
+
+//	Inside the band nothing is done, and what the integral held from outside it fades away:
+	if (error > -RESOLUTION_DROP_BAND && error < RESOLUTION_RAISE_BAND)
+	{
+		m_integral *= RESOLUTION_INTEGRAL_DECAY;
+		return m_scale;
+	}
+
+//	The integral stops growing while the scale is held at a bound by it, so it can't wind up there:
+	saturated = (error > 0.0f && m_scale >= m_maximumScale) || (error < 0.0f && m_scale <= m_minimumScale);
+	if (!saturated)
+	{
+		m_integral += error;
+		m_integral = m_integral < RESOLUTION_INTEGRAL_LIMIT ? m_integral : RESOLUTION_INTEGRAL_LIMIT;
+		m_integral = m_integral > -RESOLUTION_INTEGRAL_LIMIT ? m_integral : -RESOLUTION_INTEGRAL_LIMIT;
+	}
+
+	output = RESOLUTION_PROPORTIONAL_GAIN * error + RESOLUTION_INTEGRAL_GAIN * m_integral + RESOLUTION_DERIVATIVE_GAIN * derivative;
+
+	scale = m_scale * (1.0f + output);
+	scale = scale < m_maximumScale ? scale : m_maximumScale;
+	scale = scale > m_minimumScale ? scale : m_minimumScale;
+
+	if (scale - m_scale < RESOLUTION_MINIMUM_STEP && m_scale - scale < RESOLUTION_MINIMUM_STEP)
+	{
+		return m_scale;
+	}
+
+	m_scale = scale;
+	m_holdFrames = RESOLUTION_SETTLE_FRAMES;
+	m_changeCount++;
+
+	return m_scale;
+}
+
+float ResolutionControllerClass::GetScale()
+{
+	return m_scale;
+}
+
+float ResolutionControllerClass::GetSmoothedTime()
+{
+	return m_smoothedTime;
+}
+
+//	The number of times the scale has changed since the last Reset.
+int ResolutionControllerClass::GetChangeCount()
+{
+	return m_changeCount;
+}
@@ -0,0 +1,214 @@
+//	The resolution test drives the Resolution Controller with made up GPU frame times and checks that it
+//	settles and that it doesn't swing the scale around. It is not part of the engine's project and is built
+//	on its own, for example with:
+//	g++ -O2 -o resolutiontest Source/resolutiontestmain.cpp Source/resolutioncontrollerclass.cpp
+//	and run as: resolutiontest
+//	It prints a line for every trace and returns 1 if any of them failed.
+#include "../Headers/resolutioncontrollerclass.h"
+
+#include <stdio.h>
+#include <math.h>
+
+//	The target and the bounds the engine runs the controller with, see applicationclass.h.
+static const float TEST_TARGET = 14.0f;
+static const float TEST_MINIMUM_SCALE = 0.5f;
+static const float TEST_MAXIMUM_SCALE = 1.0f;
+
+//	The frames a GPU time reaches the controller behind the frame it was measured on, as with the queries of
+//	the Dynamic Resolution.
+static const int TEST_LATENCY = 3;
+
+//	What the controller has to do: be inside the band around the target, or held at a bound, within this
+//	many frames of a change of load, never change the scale by more than this much of itself at once, and
+//	make at most this many changes once it has settled on a load that stays the same.
+static const int TEST_SETTLE_FRAMES = 90;
+static const float TEST_LARGEST_STEP = 0.5f;
+static const int TEST_SETTLED_CHANGES = 2;
+
+//	The cost of a frame: a part that doesn't depend on the resolution and a part that grows with the number
+//	of pixels, so with the square of the scale. A spike is a single frame that takes this much longer.
+struct LoadType
+{
+	float fixedTime;
+	float pixelTime;
+	float spikeTime;
+};
+
+struct TraceType
+{
+	const char* name;
+	int frameCount;
+	LoadType (*load)(int);
+};
+
+//	A step: the scene gets twice as expensive at frame 200.
+static LoadType StepLoad(int frame)
+{
+	LoadType load;
+
+	load.fixedTime = 2.0f;
+	load.pixelTime = frame < 200 ? 10.0f : 20.0f;
+	load.spikeTime = 0.0f;
+
+	return load;
+}
+
+//	Spikes: a load that fits at full scale with a frame four times as long every 50 frames, as from a
+//	hitch in streaming. The controller should ride them out instead of dropping the scale for each.
+static LoadType SpikeLoad(int frame)
+{
+	LoadType load;
+
+	load.fixedTime = 2.0f;
+	load.pixelTime = 9.0f;
+	load.spikeTime = frame % 50 == 25 ? 33.0f : 0.0f;
+
+	return load;
+}
+
+//	Recovery: a load far over the target until frame 300, which the smallest scale can't even meet, and then
+//	a light one. The scale has to come back up to the largest.
+static LoadType RecoveryLoad(int frame)
+{
+	LoadType load;
+
+	load.fixedTime = frame < 300 ? 8.0f : 2.0f;
+	load.pixelTime = frame < 300 ? 40.0f : 8.0f;
+	load.spikeTime = 0.0f;
+
+	return load;
+}
+
+//	The frame the load last changed at, at or before the given one, found by comparing the load of every
+//	frame with the one before it. Spikes don't count as changes.
+static int GetLoadChange(const TraceType& trace, int frame)
+{
+	LoadType load, previous;
+	int i;
+
+	for (i = frame; i > 0; i--)
+	{
+		load = trace.load(i);
+		previous = trace.load(i - 1);
+		if (load.fixedTime != previous.fixedTime || load.pixelTime != previous.pixelTime)
+		{
+			return i;
+		}
+	}
+
+	return 0;
+}
+
+//	RunTrace plays a trace through a controller and checks every frame of it. The frame time of frame i is
+//	that of the load of frame i at the scale frame i was drawn at, and reaches the controller TEST_LATENCY
+//	frames later.
+static bool RunTrace(const TraceType& trace)
+{
+	ResolutionControllerClass Controller;
+	float pending[TEST_LATENCY];
+	LoadType load;
+	float scale, newScale, frameTime, steadyTime, largestStep, step;
+	int frame, change, settledChanges, lastChange, failures;
+	bool inside;
+
+	Controller.Initialize(TEST_TARGET, TEST_MINIMUM_SCALE, TEST_MAXIMUM_SCALE);
+
+	scale = Controller.GetScale();
+	largestStep = 0.0f;
+	settledChanges = 0;
+	lastChange = -1;
+	failures = 0;
+
+	for (frame = 0; frame < trace.frameCount; frame++)
+	{
+		load = trace.load(frame);
+		steadyTime = load.fixedTime + load.pixelTime * scale * scale;
+		frameTime = steadyTime + load.spikeTime;
+
+//	Until the first frame time arrives the controller is given nothing:
+		if (frame >= TEST_LATENCY)
+		{
+			newScale = Controller.Update(pending[frame % TEST_LATENCY]);
+		}
+		else
+		{
+			newScale = scale;
+		}
+		pending[frame % TEST_LATENCY] = frameTime;
+
+		if (newScale != scale)
+		{
+			step = fabsf(newScale - scale) / scale;
+			largestStep = step > largestStep ? step : largestStep;
+			if (step > TEST_LARGEST_STEP)
+			{
+				printf("%s: frame %d changed the scale from %.3f to %.3f\n", trace.name, frame, scale, newScale);
+				failures++;
+			}
+
+			if (frame - GetLoadChange(trace, frame) > TEST_SETTLE_FRAMES)
+			{
+				settledChanges++;
+			}
+			lastChange = frame;
+		}
+		scale = newScale;
+
+//	Once it has had time to settle the frames without spikes have to be within the band the controller
+//	leaves alone, or the scale has to be at the bound that is as close as it can get:
+		change = GetLoadChange(trace, frame);
+		if (frame - change == TEST_SETTLE_FRAMES)
+		{
+			steadyTime = load.fixedTime + load.pixelTime * scale * scale;
+			inside = steadyTime > TEST_TARGET * 0.85f && steadyTime < TEST_TARGET * 1.05f;
+			inside = inside || (steadyTime >= TEST_TARGET && scale <= TEST_MINIMUM_SCALE);
+			inside = inside || (steadyTime <= TEST_TARGET && scale >= TEST_MAXIMUM_SCALE);
+			if (!inside)
+			{
+				printf("%s: %d frames after the load changed at frame %d the scale is %.3f for %.2f ms\n", trace.name,
+					TEST_SETTLE_FRAMES, change, scale, steadyTime);
+				failures++;
+			}
+		}
+	}
+
+	if (settledChanges > TEST_SETTLED_CHANGES)
+	{
+		printf("%s: the scale changed %d times after it should have settled\n", trace.name, settledChanges);
+		failures++;
+	}
+
+	printf("%s: %s, final scale %.3f, %d changes, largest step %.1f%%, last change at frame %d\n", trace.name,
+		failures == 0 ? "passed" : "FAILED", scale, Controller.GetChangeCount(), largestStep * 100.0f, lastChange);
+
+	return failures == 0;
+}
+
+int main()
+{
+	TraceType traces[3];
+	int i, failed;
+
+	traces[0].name = "step";
+	traces[0].frameCount = 600;
+	traces[0].load = StepLoad;
+
+	traces[1].name = "spike";
+	traces[1].frameCount = 600;
+	traces[1].load = SpikeLoad;
+
+	traces[2].name = "recovery";
+	traces[2].frameCount = 600;
+	traces[2].load = RecoveryLoad;
+
+	failed = 0;
+	for (i = 0; i < 3; i++)
+	{
+		if (!RunTrace(traces[i]))
+		{
+			failed++;
+		}
+	}
+
+	return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,360 @@
+#include "../Headers/resourceregistryclass.h"
+
+ResourceRegistryClass::ResourceRegistryClass()
+{
+	int i;
+
+	m_resourceCount = 0;
+	m_staleLookups = 0;
+	m_resourceBytes = 0;
+	m_oldestFence = 0;
+	m_fenceCount = 0;
+	m_frame = 0;
+	m_completedFrame = 0;
+	m_fenced = false;
+
+	for (i = 0; i < RESOURCE_REGISTRY_FRAMES; i++)
+	{
+		m_fences[i].query = 0;
+		m_fences[i].frame = 0;
+	}
+}
+
+ResourceRegistryClass::ResourceRegistryClass(const ResourceRegistryClass& other)
+{
+
+}
+
+ResourceRegistryClass::~ResourceRegistryClass()
+{
+
+}
+
+//	Initialize creates the event queries the frames are fenced with. Without a device nothing is fenced and
+//	released resources are let go of at the end of the frame they were released in.
+bool ResourceRegistryClass::Initialize(ID3D11Device* device)
+{
+	D3D11_QUERY_DESC queryDesc;
+	HRESULT result;
+	int i;
+
+	if (!device)
+	{
+		return true;
+	}
+
+	queryDesc.Query = D3D11_QUERY_EVENT;
+	queryDesc.MiscFlags = 0;
+
+	for (i = 0; i < RESOURCE_REGISTRY_FRAMES; i++)
+	{
+		result = device->CreateQuery(&queryDesc, &m_fences[i].query);
+		if (FAILED(result))
+		{
+			return false;
+		}
+	}
+
+	m_fenced = true;
+
+	return true;
+}
+
+//	Shutdown is called after everything is done drawing, so whatever is left, released or not, goes at once.
+void ResourceRegistryClass::Shutdown()
+{
+	int i;
+	unsigned int j;
+
+	while (!m_pending.empty())
+	{
+		m_pending.front().resource->Release();
+		m_pending.pop_front();
+	}
+
+	for (i = 0; i < RESOURCE_TYPE_COUNT; i++)
+	{
+		for (j = 0; j < m_slots[i].size(); j++)
+		{
+			if (m_slots[i][j].resource)
+			{
+				m_slots[i][j].resource->Release();
+				m_slots[i][j].resource = 0;
+			}
+		}
+
+		m_slots[i].clear();
+		m_freeSlots[i].clear();
+	}
+
+	for (i = 0; i < RESOURCE_REGISTRY_FRAMES; i++)
+	{
+		if (m_fences[i].query)
+		{
+			m_fences[i].query->Release();
+			m_fences[i].query = 0;
+		}
+	}
+
+	m_resourceCount = 0;
+	m_resourceBytes = 0;
+	m_fenceCount = 0;
+	m_fenced = false;
+
+	return;
+}
+
+//	EndFrame fences the frame that was just submitted and lets go of the resources released in frames the
+//	video card has finished with. With every fence in flight it waits for the oldest one first.
+void ResourceRegistryClass::EndFrame(ID3D11DeviceContext* deviceContext)
+{
+	FrameFenceType* fence;
+
+	if (m_fenced)
+	{
+		RetireFrames(deviceContext, m_fenceCount == RESOURCE_REGISTRY_FRAMES);
+
+		fence = &m_fences[(m_oldestFence + m_fenceCount) % RESOURCE_REGISTRY_FRAMES];
+		deviceContext->End(fence->query);
+		fence->frame = m_frame;
+		m_fenceCount++;
+	}
+	else
+	{
+		m_completedFrame = m_frame + 1;
+	}
+
+	m_frame++;
+
+//	The queue is in the order things were released, so the frames done with are all at the front of it:
+	while (!m_pending.empty() && m_pending.front().frame < m_completedFrame)
+	{
+		m_resourceBytes -= m_pending.front().bytes;
+		m_pending.front().resource->Release();
+		m_pending.pop_front();
+	}
+
+	return;
+}
+
+int ResourceRegistryClass::GetResourceCount()
+{
+	return m_resourceCount;
+}
+
+int ResourceRegistryClass::GetPendingCount()
+{
+	return (int)m_pending.size();
+}
+
+//	The number of times Get was given a handle whose resource had been released. It should stay zero.
+int ResourceRegistryClass::GetStaleLookupCount()
+{
+	return m_staleLookups;
+}
+
+//	The bytes of every buffer and texture the registry holds, counting the released ones the video card may
+//	still be using.
+unsigned long long ResourceRegistryClass::GetResourceBytes()
+{
+	return m_resourceBytes;
+}
+
+//	RegisterResource puts the resource in a free slot of its type, or a new one at the end of the array,
+//	and makes the handle out of the slot and its generation.
+unsigned int ResourceRegistryClass::RegisterResource(ID3D11DeviceChild* resource, ResourceType type)
+{
+	SlotType slot;
+	unsigned int index;
+
+	if (!resource)
+	{
+		return 0;
+	}
+
+	if (!m_freeSlots[type].empty())
+	{
+		index = m_freeSlots[type].back();
+		m_freeSlots[type].pop_back();
+	}
+	else
+	{
+		index = (unsigned int)m_slots[type].size();
+		if (index > RESOURCE_INDEX_MASK)
+		{
+			resource->Release();
+			return 0;
+		}
+
+		slot.resource = 0;
+		slot.generation = 1;
+		slot.bytes = 0;
+		m_slots[type].push_back(slot);
+	}
+
+	m_slots[type][index].resource = resource;
+	m_slots[type][index].bytes = GetSize(resource, type);
+	m_resourceCount++;
+	m_resourceBytes += m_slots[type][index].bytes;
+
+	return ((unsigned int)type << (RESOURCE_INDEX_BITS + RESOURCE_GENERATION_BITS)) |
+		(m_slots[type][index].generation << RESOURCE_INDEX_BITS) | index;
+}
+
+//	GetResource takes the handle apart and only returns the resource if the type and generation still match.
+ID3D11DeviceChild* ResourceRegistryClass::GetResource(unsigned int id, ResourceType type, bool countStale)
+{
+	unsigned int index, generation;
+
+	if (id == 0)
+	{
+		return 0;
+	}
+
+	index = id & RESOURCE_INDEX_MASK;
+	generation = (id >> RESOURCE_INDEX_BITS) & RESOURCE_GENERATION_MASK;
+
+	if ((id >> (RESOURCE_INDEX_BITS + RESOURCE_GENERATION_BITS)) != (unsigned int)type || index >= m_slots[type].size() ||
+		m_slots[type][index].generation != generation || !m_slots[type][index].resource)
+	{
+		if (countStale)
+		{
+			m_staleLookups++;
+		}
+
+		return 0;
+	}
+
+	return m_slots[type][index].resource;
+}
+
+//	ReleaseResource moves the resource to the pending queue and bumps the generation of the slot, so the
+//	slot can be used again at once without old handles finding the new resource. A slot at its last
+//	generation keeps it and is left out of the free slots for good, since any generation it went on to
+//	would already have been handed out.
+void ResourceRegistryClass::ReleaseResource(unsigned int id, ResourceType type)
+{
+	PendingType pending;
+	ID3D11DeviceChild* resource;
+	unsigned int index;
+
+	resource = GetResource(id, type, true);
+	if (!resource)
+	{
+		return;
+	}
+
+	index = id & RESOURCE_INDEX_MASK;
+
+	pending.resource = resource;
+	pending.frame = m_frame;
+	pending.bytes = m_slots[type][index].bytes;
+	m_pending.push_back(pending);
+
+	m_slots[type][index].resource = 0;
+	m_resourceCount--;
+
+	if (m_slots[type][index].generation == RESOURCE_GENERATION_MASK)
+	{
+		return;
+	}
+
+	m_slots[type][index].generation++;
+	m_freeSlots[type].push_back(index);
+
+	return;
+}
+
+//	RetireFrames polls the fences from the oldest onwards and moves the completed frame past the ones the
+//	video card has passed. It only blocks when asked to wait for the oldest.
+void ResourceRegistryClass::RetireFrames(ID3D11DeviceContext* deviceContext, bool waitForOldest)
+{
+	HRESULT result;
+	FrameFenceType* fence;
+
+	while (m_fenceCount > 0)
+	{
+		fence = &m_fences[m_oldestFence];
+
+		if (waitForOldest)
+		{
+			do
+			{
+				result = deviceContext->GetData(fence->query, NULL, 0, 0);
+			} while (result == S_FALSE);
+			waitForOldest = false;
+		}
+		else
+		{
+			result = deviceContext->GetData(fence->query, NULL, 0, D3D11_ASYNC_GETDATA_DONOTFLUSH);
+		}
+
+		if (result != S_OK)
+		{
+			break;
+		}
+
+		m_completedFrame = fence->frame + 1;
+
+		m_oldestFence = (m_oldestFence + 1) % RESOURCE_REGISTRY_FRAMES;
+		m_fenceCount--;
+	}
+
+	return;
+}
+
+//	GetSize gives the bytes a buffer or a texture takes with all of its mip levels, slices and samples.
+//	Views and states take next to nothing of their own.
+unsigned int ResourceRegistryClass::GetSize(ID3D11DeviceChild* resource, ResourceType type)
+{
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_TEXTURE2D_DESC textureDesc;
+	unsigned int bytes, width, height, mip;
+
+	if (type == RESOURCE_BUFFER)
+	{
+		((ID3D11Buffer*)resource)->GetDesc(&bufferDesc);
+		return bufferDesc.ByteWidth;
+	}
+
+	if (type != RESOURCE_TEXTURE)
+	{
+		return 0;
+	}
+
+	((ID3D11Texture2D*)resource)->GetDesc(&textureDesc);
+
+	bytes = 0;
+	width = textureDesc.Width;
+	height = textureDesc.Height;
+	for (mip = 0; mip < (textureDesc.MipLevels > 0 ? textureDesc.MipLevels : 1); mip++)
+	{
+		bytes += width * height * GetTexelBits(textureDesc.Format) / 8;
+		width = width > 1 ? width / 2 : 1;
+		height = height > 1 ? height / 2 : 1;
+	}
+
+	return bytes * textureDesc.ArraySize * textureDesc.SampleDesc.Count;
+}
+
+//	The bits of one texel of the formats the engine makes textures with. Anything else is taken to be 32.
+unsigned int ResourceRegistryClass::GetTexelBits(DXGI_FORMAT format)
+{
+	switch (format)
+	{
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		return 128;
+	case DXGI_FORMAT_R32G32B32_FLOAT:
+		return 96;
+	case DXGI_FORMAT_R16G16B16A16_FLOAT:
+	case DXGI_FORMAT_R32G32_FLOAT:
+		return 64;
+	case DXGI_FORMAT_R8_UNORM:
+		return 8;
+	case DXGI_FORMAT_R16_FLOAT:
+	case DXGI_FORMAT_R16_UNORM:
+		return 16;
+	default:
+		return 32;
+	}
+}
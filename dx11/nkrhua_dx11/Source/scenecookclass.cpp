@@ -0,0 +1,52 @@
+#include "../Headers/scenecookclass.h"
+
+#include <stdio.h>
+
+bool SceneCookClass::Cook(const char* filename, ModelClass* model, const XMFLOAT3* characterPositions, int characterCount)
+{
+	ScenePackageClass::SceneDescType scene;
+	ScenePackageClass::MaterialType material;
+	ScenePackageClass::MeshType mesh;
+	ScenePackageClass::ObjectType object;
+	const XMFLOAT3* positions;
+	char name[32];
+	int i;
+
+	material = ScenePackageClass::MaterialType();
+	material.color = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+	material.name = ScenePackageClass::AddString(scene, "default");
+	scene.materials.push_back(material);
+
+	mesh = ScenePackageClass::MeshType();
+	positions = model->GetPositions();
+	mesh.minimum = mesh.maximum = positions[0];
+	for (i = 1; i < model->GetVertexCount(); i++)
+	{
+		XMStoreFloat3(&mesh.minimum, XMVectorMin(XMLoadFloat3(&mesh.minimum), XMLoadFloat3(&positions[i])));
+		XMStoreFloat3(&mesh.maximum, XMVectorMax(XMLoadFloat3(&mesh.maximum), XMLoadFloat3(&positions[i])));
+	}
+	mesh.name = ScenePackageClass::AddString(scene, "triangle");
+	scene.meshes.push_back(mesh);
+
+	object = ScenePackageClass::ObjectType();
+	object.position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	object.scale = 1.0f;
+	object.kind = SCENE_OBJECT_MESH;
+	object.index = 0;
+	object.material = 0;
+	object.name = ScenePackageClass::AddString(scene, "triangle");
+	scene.objects.push_back(object);
+
+	for (i = 0; i < characterCount; i++)
+	{
+		sprintf_s(name, sizeof(name), "character%d", i);
+
+		object.position = characterPositions[i];
+		object.kind = SCENE_OBJECT_CHARACTER;
+		object.index = i;
+		object.name = ScenePackageClass::AddString(scene, name);
+		scene.objects.push_back(object);
+	}
+
+	return ScenePackageClass::WritePackage(filename, scene);
+}
@@ -0,0 +1,419 @@
+#include "../Headers/scenepackageclass.h"
+
+#include <stdio.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//	The package is used in place, so the types must be laid out the same by every compiler that reads it:
+static_assert(sizeof(ScenePackageClass::HeaderType) == 32, "The package header has to be 32 bytes");
+static_assert(sizeof(ScenePackageClass::SectionType) == 24, "A section entry has to be 24 bytes");
+static_assert(sizeof(ScenePackageClass::ObjectType) == 32, "An object has to be 32 bytes");
+static_assert(sizeof(ScenePackageClass::MaterialType) == 32, "A material has to be 32 bytes");
+static_assert(sizeof(ScenePackageClass::MeshType) == 32, "A mesh has to be 32 bytes");
+
+//	The size of one element of every section, the strings being single characters:
+static const unsigned long long SCENE_SECTION_ELEMENT_SIZES[SCENE_SECTION_COUNT] =
+{
+	sizeof(ScenePackageClass::ObjectType),
+	sizeof(ScenePackageClass::MaterialType),
+	sizeof(ScenePackageClass::MeshType),
+	1
+};
+
+//	The primes of the hash, those of xxHash64:
+static const unsigned long long HASH_PRIME_1 = 0x9E3779B185EBCA87ULL;
+static const unsigned long long HASH_PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+static const unsigned long long HASH_PRIME_3 = 0x165667B19E3779F9ULL;
+static const unsigned long long HASH_PRIME_4 = 0x85EBCA77C2B2AE63ULL;
+static const unsigned long long HASH_PRIME_5 = 0x27D4EB2F165667C5ULL;
+
+static unsigned long long RotateLeft(unsigned long long value, int bits)
+{
+	return (value << bits) | (value >> (64 - bits));
+}
+
+//	HashRound mixes a word into a lane. The rotate carries the high bits of the product back to the bottom
+//	before the second multiply, so every bit of the word reaches every bit of the lane.
+static unsigned long long HashRound(unsigned long long lane, unsigned long long word)
+{
+	lane += word * HASH_PRIME_2;
+	lane = RotateLeft(lane, 31);
+	lane *= HASH_PRIME_1;
+
+	return lane;
+}
+
+ScenePackageClass::ScenePackageClass()
+{
+	m_view = 0;
+	m_size = 0;
+	m_sections = 0;
+}
+
+ScenePackageClass::ScenePackageClass(const ScenePackageClass& other)
+{
+
+}
+
+ScenePackageClass::~ScenePackageClass()
+{
+
+}
+
+//	Initialize maps the whole file read only. The pages are only read from the disk when they are first
+//	touched, so opening costs the same for any size of package unless the hash is checked, which reads it all.
+bool ScenePackageClass::Initialize(const char* filename, bool verify)
+{
+	const HeaderType* header;
+
+#if defined(_WIN32)
+	HANDLE file, mapping;
+	LARGE_INTEGER size;
+
+	file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	if (!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(HeaderType))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+//	The view keeps the mapping and the file open, so both handles can be closed as soon as it exists:
+	mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	CloseHandle(file);
+	if (!mapping)
+	{
+		return false;
+	}
+
+	m_view = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!m_view)
+	{
+		return false;
+	}
+
+	m_size = (unsigned long long)size.QuadPart;
+#else
+	struct stat status;
+	void* view;
+	int file;
+
+	file = open(filename, O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	if (fstat(file, &status) != 0 || status.st_size < (off_t)sizeof(HeaderType))
+	{
+		close(file);
+		return false;
+	}
+
+//	The mapping stays good after the file is closed:
+	view = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (view == MAP_FAILED)
+	{
+		return false;
+	}
+
+	m_view = (const unsigned char*)view;
+	m_size = (unsigned long long)status.st_size;
+#endif
+
+	header = (const HeaderType*)m_view;
+	m_sections = (const SectionType*)(m_view + sizeof(HeaderType));
+
+	if (!CheckContents())
+	{
+		Shutdown();
+		return false;
+	}
+
+	if (verify && HashBytes(m_view + sizeof(HeaderType), m_size - sizeof(HeaderType)) != header->hash)
+	{
+		Shutdown();
+		return false;
+	}
+
+	return true;
+}
+
+void ScenePackageClass::Shutdown()
+{
+	if (m_view)
+	{
+#if defined(_WIN32)
+		UnmapViewOfFile(m_view);
+#else
+		munmap((void*)m_view, (size_t)m_size);
+#endif
+		m_view = 0;
+	}
+
+	m_size = 0;
+	m_sections = 0;
+
+	return;
+}
+
+int ScenePackageClass::GetObjectCount()
+{
+	return (int)m_sections[SCENE_SECTION_OBJECTS].count;
+}
+
+const ScenePackageClass::ObjectType* ScenePackageClass::GetObjects()
+{
+	return (const ObjectType*)(m_view + m_sections[SCENE_SECTION_OBJECTS].offset);
+}
+
+int ScenePackageClass::GetMaterialCount()
+{
+	return (int)m_sections[SCENE_SECTION_MATERIALS].count;
+}
+
+const ScenePackageClass::MaterialType* ScenePackageClass::GetMaterials()
+{
+	return (const MaterialType*)(m_view + m_sections[SCENE_SECTION_MATERIALS].offset);
+}
+
+int ScenePackageClass::GetMeshCount()
+{
+	return (int)m_sections[SCENE_SECTION_MESHES].count;
+}
+
+const ScenePackageClass::MeshType* ScenePackageClass::GetMeshes()
+{
+	return (const MeshType*)(m_view + m_sections[SCENE_SECTION_MESHES].offset);
+}
+
+//	The string section ends with a zero, which CheckContents made sure of, so every offset inside it is a
+//	terminated string. An offset past it gives an empty one.
+const char* ScenePackageClass::GetString(unsigned int offset)
+{
+	if (offset >= m_sections[SCENE_SECTION_STRINGS].size)
+	{
+		return "";
+	}
+
+	return (const char*)(m_view + m_sections[SCENE_SECTION_STRINGS].offset + offset);
+}
+
+unsigned long long ScenePackageClass::GetSize()
+{
+	return m_size;
+}
+
+//	AddString appends a name with its terminating zero to the strings of a scene and returns its offset.
+unsigned int ScenePackageClass::AddString(SceneDescType& scene, const char* text)
+{
+	unsigned int offset;
+
+	offset = (unsigned int)scene.strings.size();
+	scene.strings.insert(scene.strings.end(), text, text + strlen(text) + 1);
+
+	return offset;
+}
+
+//	WritePackage lays the package out in memory first: the header, the table of contents, and every section
+//	at the next aligned offset, the gaps left zero. The hash is taken over everything after the header once
+//	all of it is in place, and then the whole package is written with one call.
+bool ScenePackageClass::WritePackage(const char* filename, const SceneDescType& scene)
+{
+	vector<unsigned char> package;
+	HeaderType header;
+	SectionType sections[SCENE_SECTION_COUNT];
+	const void* data[SCENE_SECTION_COUNT];
+	unsigned long long offset;
+	FILE* filePtr;
+	size_t count;
+	int i;
+
+	sections[SCENE_SECTION_OBJECTS].count = (unsigned int)scene.objects.size();
+	sections[SCENE_SECTION_MATERIALS].count = (unsigned int)scene.materials.size();
+	sections[SCENE_SECTION_MESHES].count = (unsigned int)scene.meshes.size();
+	sections[SCENE_SECTION_STRINGS].count = (unsigned int)scene.strings.size();
+
+	data[SCENE_SECTION_OBJECTS] = scene.objects.data();
+	data[SCENE_SECTION_MATERIALS] = scene.materials.data();
+	data[SCENE_SECTION_MESHES] = scene.meshes.data();
+	data[SCENE_SECTION_STRINGS] = scene.strings.data();
+
+	offset = sizeof(HeaderType) + sizeof(SectionType) * SCENE_SECTION_COUNT;
+	for (i = 0; i < SCENE_SECTION_COUNT; i++)
+	{
+		offset = (offset + SCENE_PACKAGE_ALIGNMENT - 1) & ~(unsigned long long)(SCENE_PACKAGE_ALIGNMENT - 1);
+
+		sections[i].type = i;
+		sections[i].offset = offset;
+		sections[i].size = sections[i].count * SCENE_SECTION_ELEMENT_SIZES[i];
+
+		offset += sections[i].size;
+	}
+
+	package.resize((size_t)offset, 0);
+
+	memcpy(package.data() + sizeof(HeaderType), sections, sizeof(sections));
+	for (i = 0; i < SCENE_SECTION_COUNT; i++)
+	{
+		if (sections[i].size > 0)
+		{
+			memcpy(package.data() + sections[i].offset, data[i], (size_t)sections[i].size);
+		}
+	}
+
+	memset(&header, 0, sizeof(HeaderType));
+	memcpy(header.magic, "SCN1", 4);
+	header.version = SCENE_PACKAGE_VERSION;
+	header.fileSize = offset;
+	header.hash = HashBytes(package.data() + sizeof(HeaderType), offset - sizeof(HeaderType));
+	header.sectionCount = SCENE_SECTION_COUNT;
+	memcpy(package.data(), &header, sizeof(HeaderType));
+
+#if defined(_MSC_VER)
+	if (fopen_s(&filePtr, filename, "wb") != 0)
+	{
+		return false;
+	}
+#else
+	filePtr = fopen(filename, "wb");
+	if (!filePtr)
+	{
+		return false;
+	}
+#endif
+
+	count = fwrite(package.data(), 1, package.size(), filePtr);
+	fclose(filePtr);
+
+	return count == package.size();
+}
+
+//	CheckContents makes sure every pointer the package will hand out is inside the file: the header has to
+//	be the one written by this version, and every section has to be where the table of contents says, aligned,
+//	inside the file and exactly as large as its elements.
+bool ScenePackageClass::CheckContents()
+{
+	const HeaderType* header;
+	unsigned long long start;
+	int i;
+
+	header = (const HeaderType*)m_view;
+	if (memcmp(header->magic, "SCN1", 4) != 0 || header->version != SCENE_PACKAGE_VERSION || header->fileSize != m_size ||
+		header->sectionCount != SCENE_SECTION_COUNT)
+	{
+		return false;
+	}
+
+	start = sizeof(HeaderType) + sizeof(SectionType) * SCENE_SECTION_COUNT;
+	if (m_size < start)
+	{
+		return false;
+	}
+
+	for (i = 0; i < SCENE_SECTION_COUNT; i++)
+	{
+		if (m_sections[i].type != (unsigned int)i || m_sections[i].offset % SCENE_PACKAGE_ALIGNMENT != 0 || m_sections[i].offset < start ||
+			m_sections[i].offset > m_size || m_sections[i].size > m_size - m_sections[i].offset ||
+			m_sections[i].size != m_sections[i].count * SCENE_SECTION_ELEMENT_SIZES[i])
+		{
+			return false;
+		}
+	}
+
+	if (m_sections[SCENE_SECTION_STRINGS].size > 0 &&
+		m_view[m_sections[SCENE_SECTION_STRINGS].offset + m_sections[SCENE_SECTION_STRINGS].size - 1] != 0)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+//	HashBytes is xxHash64 with a seed of zero. It takes eight bytes at a time in four independent lanes, which
+//	keeps it from waiting on one multiply after another and reads large packages several times faster than a
+//	byte at a time. A single multiply only carries a bit upwards, so two flips of the top bit of a lane would
+//	cancel, which is why every word goes through a full round and the lanes are mixed again as they are
+//	combined. The words and bytes left over go in one at a time, and a final avalanche spreads every bit of
+//	the hash over all of it.
+unsigned long long ScenePackageClass::HashBytes(const void* data, unsigned long long size)
+{
+	const unsigned char* bytes;
+	unsigned long long lanes[4], word, hash, i;
+	unsigned int half;
+	int lane;
+
+	bytes = (const unsigned char*)data;
+	i = 0;
+
+	if (size >= 32)
+	{
+		lanes[0] = HASH_PRIME_1 + HASH_PRIME_2;
+		lanes[1] = HASH_PRIME_2;
+		lanes[2] = 0;
+		lanes[3] = 0 - HASH_PRIME_1;
+
+		for (; i + 32 <= size; i += 32)
+		{
+			for (lane = 0; lane < 4; lane++)
+			{
+				memcpy(&word, bytes + i + lane * 8, 8);
+				lanes[lane] = HashRound(lanes[lane], word);
+			}
+		}
+
+		hash = RotateLeft(lanes[0], 1) + RotateLeft(lanes[1], 7) + RotateLeft(lanes[2], 12) + RotateLeft(lanes[3], 18);
+		for (lane = 0; lane < 4; lane++)
+		{
+			hash ^= HashRound(0, lanes[lane]);
+			hash = hash * HASH_PRIME_1 + HASH_PRIME_4;
+		}
+	}
+	else
+	{
+		hash = HASH_PRIME_5;
+	}
+
+	hash += size;
+
+	for (; i + 8 <= size; i += 8)
+	{
+		memcpy(&word, bytes + i, 8);
+		hash ^= HashRound(0, word);
+		hash = RotateLeft(hash, 27) * HASH_PRIME_1 + HASH_PRIME_4;
+	}
+
+	if (i + 4 <= size)
+	{
+		memcpy(&half, bytes + i, 4);
+		hash ^= (unsigned long long)half * HASH_PRIME_1;
+		hash = RotateLeft(hash, 23) * HASH_PRIME_2 + HASH_PRIME_3;
+		i += 4;
+	}
+
+	for (; i < size; i++)
+	{
+		hash ^= bytes[i] * HASH_PRIME_5;
+		hash = RotateLeft(hash, 11) * HASH_PRIME_1;
+	}
+
+	hash ^= hash >> 33;
+	hash *= HASH_PRIME_2;
+	hash ^= hash >> 29;
+	hash *= HASH_PRIME_3;
+	hash ^= hash >> 32;
+
+	return hash;
+}
@@ -0,0 +1,127 @@
+#include "../Headers/scenesystemsclass.h"
+
+SceneSystemsClass::SceneSystemsClass()
+{
+	m_transformComponent = -1;
+	m_renderableComponent = -1;
+	m_boundsComponent = -1;
+}
+
+SceneSystemsClass::SceneSystemsClass(const SceneSystemsClass& other)
+{
+
+}
+
+SceneSystemsClass::~SceneSystemsClass()
+{
+
+}
+
+//	Initialize registers the components with the world and adds the transform system, which runs first, and
+//	the bounds system, which reads the world matrices it made.
+void SceneSystemsClass::Initialize(EntityWorldClass* world, CharacterBoundsFunction characterBounds)
+{
+	m_characterBounds = characterBounds;
+
+	m_transformComponent = world->RegisterComponent(sizeof(TransformType));
+	m_renderableComponent = world->RegisterComponent(sizeof(RenderableType));
+	m_boundsComponent = world->RegisterComponent(sizeof(EntityBoundsType));
+
+	world->AddSystem(0, 1u << m_transformComponent, [this](const EntityWorldClass::ChunkViewType& chunk)
+	{
+		TransformType* transforms;
+		int i;
+
+		transforms = (TransformType*)chunk.components[m_transformComponent];
+
+		for (i = 0; i < chunk.count; i++)
+		{
+			UpdateWorldMatrix(transforms[i]);
+		}
+	});
+
+	world->AddSystem((1u << m_transformComponent) | (1u << m_renderableComponent), 1u << m_boundsComponent,
+		[this](const EntityWorldClass::ChunkViewType& chunk)
+	{
+		TransformType* transforms;
+		RenderableType* renderables;
+		EntityBoundsType* bounds;
+		int i;
+
+		transforms = (TransformType*)chunk.components[m_transformComponent];
+		renderables = (RenderableType*)chunk.components[m_renderableComponent];
+		bounds = (EntityBoundsType*)chunk.components[m_boundsComponent];
+
+		for (i = 0; i < chunk.count; i++)
+		{
+			UpdateBounds(transforms[i], renderables[i], bounds[i]);
+		}
+	});
+
+	return;
+}
+
+int SceneSystemsClass::GetTransformComponent()
+{
+	return m_transformComponent;
+}
+
+int SceneSystemsClass::GetRenderableComponent()
+{
+	return m_renderableComponent;
+}
+
+int SceneSystemsClass::GetBoundsComponent()
+{
+	return m_boundsComponent;
+}
+
+//	GetMask gives the components every entity of the scene has.
+unsigned int SceneSystemsClass::GetMask()
+{
+	return (1u << m_transformComponent) | (1u << m_renderableComponent) | (1u << m_boundsComponent);
+}
+
+void SceneSystemsClass::UpdateWorldMatrix(TransformType& transform)
+{
+	XMStoreFloat4x4(&transform.world, XMMatrixMultiply(XMMatrixScaling(transform.scale, transform.scale, transform.scale),
+		XMMatrixTranslation(transform.position.x, transform.position.y, transform.position.z)));
+
+	return;
+}
+
+//	UpdateWorldBounds moves the center of the local box into the world and grows its half size by the
+//	absolute value of every axis of the world matrix, which gives the box around the moved box.
+void SceneSystemsClass::UpdateWorldBounds(const TransformType& transform, EntityBoundsType& bounds)
+{
+	XMMATRIX worldMatrix;
+	XMVECTOR minimum, maximum, center, extent;
+
+	worldMatrix = XMLoadFloat4x4(&transform.world);
+	minimum = XMLoadFloat3(&bounds.localMinimum);
+	maximum = XMLoadFloat3(&bounds.localMaximum);
+
+	center = XMVector3TransformCoord(XMVectorScale(XMVectorAdd(minimum, maximum), 0.5f), worldMatrix);
+	extent = XMVectorScale(XMVectorSubtract(maximum, minimum), 0.5f);
+	extent = XMVectorMultiplyAdd(XMVectorSplatX(extent), XMVectorAbs(worldMatrix.r[0]),
+		XMVectorMultiplyAdd(XMVectorSplatY(extent), XMVectorAbs(worldMatrix.r[1]), XMVectorMultiply(XMVectorSplatZ(extent), XMVectorAbs(worldMatrix.r[2]))));
+
+	XMStoreFloat3(&bounds.world.minimum, XMVectorSubtract(center, extent));
+	XMStoreFloat3(&bounds.world.maximum, XMVectorAdd(center, extent));
+
+	return;
+}
+
+//	UpdateBounds is the work of the bounds system for one entity: a character takes its local box from its
+//	pose, and then the local box is moved into the world.
+void SceneSystemsClass::UpdateBounds(const TransformType& transform, const RenderableType& renderable, EntityBoundsType& bounds)
+{
+	if (renderable.kind == RENDERABLE_CHARACTER)
+	{
+		m_characterBounds(renderable.index, bounds.localMinimum, bounds.localMaximum);
+	}
+
+	UpdateWorldBounds(transform, bounds);
+
+	return;
+}
@@ -0,0 +1,683 @@
+#include "../Headers/shadermanagerclass.h"
+
+ShaderManagerClass::ShaderManagerClass()
+{
+	m_device = 0;
+	m_hwnd = 0;
+}
+
+ShaderManagerClass::ShaderManagerClass(const ShaderManagerClass& other)
+{
+
+}
+
+ShaderManagerClass::~ShaderManagerClass()
+{
+
+}
+
+//	The manager keeps the device so shader families can be added at any time after startup.
+bool ShaderManagerClass::Initialize(ID3D11Device* device, HWND hwnd)
+{
+	m_device = device;
+	m_hwnd = hwnd;
+
+	return true;
+}
+
+void ShaderManagerClass::Shutdown()
+{
+	unsigned int i, j;
+
+//	Delete the permutation tables. The objects they point to are released below, once each:
+	for (i = 0; i < m_families.size(); i++)
+	{
+		for (j = 0; j < SHADER_PERMUTATION_COUNT; j++)
+		{
+			if (m_families[i].permutations[j])
+			{
+				delete m_families[i].permutations[j];
+				m_families[i].permutations[j] = 0;
+			}
+		}
+	}
+	m_families.clear();
+
+//	Release the unique Layouts, Pixel Shaders and Vertex Shaders:
+	ReleaseShared(m_layouts);
+	ReleaseShared(m_pixelShaders);
+	ReleaseShared(m_vertexShaders);
+
+//	Release the precompiled bytecode:
+	for (auto& entry : m_precompiled)
+	{
+		entry.second->Release();
+	}
+	m_precompiled.clear();
+
+	m_device = 0;
+
+	return;
+}
+
+//	Precompile goes through the same permutations as AddShader does, one stage at a time.
+void ShaderManagerClass::Precompile(WCHAR* vsFilename, const char* vsEntry, WCHAR* psFilename, const char* psEntry, unsigned int supportedFlags)
+{
+	unsigned int flags;
+
+	supportedFlags &= SHADER_PERMUTATION_COUNT - 1;
+	for (flags = 0; flags < SHADER_PERMUTATION_COUNT; flags++)
+	{
+		if ((flags & ~supportedFlags) != 0)
+		{
+			continue;
+		}
+
+		PrecompileShader(vsFilename, vsEntry, "vs_5_0", flags);
+		PrecompileShader(psFilename, psEntry, "ps_5_0", flags);
+	}
+
+	return;
+}
+
+//	AddShader compiles every permutation of a vertex and pixel shader pair that the supported flags allow
+//	and returns the index of the new shader family, or -1 if any permutation failed. Permutations that end
+//	up with the same bytecode or the same input layout share one object through the hash tables, so a
+//	define that only changes the pixel shader does not create a second vertex shader. The vertex formats
+//	are what the input layouts are built from, the instance format may be null for a family that is never
+//	drawn instanced.
+int ShaderManagerClass::AddShader(WCHAR* vsFilename, const char* vsEntry, WCHAR* psFilename, const char* psEntry, unsigned int supportedFlags,
+	const ShaderInputType* inputs, int inputCount, const VertexFormatType* instanceFormat)
+{
+	ShaderFamilyType family;
+	ShaderPermutationType* permutation;
+	ID3D10Blob* vertexShaderBuffer;
+	ID3D10Blob* pixelShaderBuffer;
+	ID3D11VertexShader* vertexShader;
+	ID3D11PixelShader* pixelShader;
+	const VertexFormatType* vertexFormat;
+	unsigned long long hash;
+	unsigned int flags, formatFlags, i;
+	HRESULT result;
+	bool failed;
+	int j;
+
+	lock_guard<mutex> lock(m_addMutex);
+
+	family.supportedFlags = supportedFlags & (SHADER_PERMUTATION_COUNT - 1);
+	for (flags = 0; flags < SHADER_PERMUTATION_COUNT; flags++)
+	{
+		family.permutations[flags] = 0;
+	}
+
+//	The flags that change which vertex format a permutation is fed from:
+	formatFlags = 0;
+	for (j = 0; j < inputCount; j++)
+	{
+		formatFlags |= inputs[j].flags;
+	}
+
+	failed = false;
+	for (flags = 0; flags < SHADER_PERMUTATION_COUNT && !failed; flags++)
+	{
+//	Skip the combinations that use a define this family does not support:
+		if ((flags & ~family.supportedFlags) != 0)
+		{
+			continue;
+		}
+
+		vertexShaderBuffer = 0;
+		pixelShaderBuffer = 0;
+
+		permutation = new ShaderPermutationType;
+		permutation->vertexShader = 0;
+		permutation->pixelShader = 0;
+		permutation->layout = 0;
+		family.permutations[flags] = permutation;
+
+//	Compile both stages with the same set of defines:
+		if (!CompileShader(vsFilename, vsEntry, "vs_5_0", flags, &vertexShaderBuffer) ||
+			!CompileShader(psFilename, psEntry, "ps_5_0", flags, &pixelShaderBuffer))
+		{
+			failed = true;
+		}
+
+//	Look the Vertex Shader bytecode up before creating a new shader object:
+		if (!failed)
+		{
+			hash = HashBytes(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize());
+			vertexShader = (ID3D11VertexShader*)FindShared(m_vertexShaders, hash, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize());
+			if (!vertexShader)
+			{
+				result = m_device->CreateVertexShader(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), NULL, &vertexShader);
+				if (FAILED(result))
+				{
+					failed = true;
+				}
+				else
+				{
+					AddShared(m_vertexShaders, hash, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), vertexShader);
+					CommandCaptureClass::TagShader(vertexShader, vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize());
+				}
+			}
+			permutation->vertexShader = vertexShader;
+		}
+
+//	And the same for the Pixel Shader:
+		if (!failed)
+		{
+			hash = HashBytes(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize());
+			pixelShader = (ID3D11PixelShader*)FindShared(m_pixelShaders, hash, pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize());
+			if (!pixelShader)
+			{
+				result = m_device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &pixelShader);
+				if (FAILED(result))
+				{
+					failed = true;
+				}
+				else
+				{
+					AddShared(m_pixelShaders, hash, pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), pixelShader);
+					CommandCaptureClass::TagShader(pixelShader, pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize());
+				}
+			}
+			permutation->pixelShader = pixelShader;
+		}
+
+//	Build the Input Layout from the vertex format of the permutation and what the Vertex Shader actually reads:
+		if (!failed)
+		{
+			vertexFormat = 0;
+			for (j = 0; j < inputCount; j++)
+			{
+				if (inputs[j].flags == (flags & formatFlags))
+				{
+					vertexFormat = inputs[j].format;
+				}
+			}
+
+			failed = !BuildInputLayout(vertexShaderBuffer, vertexFormat, instanceFormat, vsFilename, &permutation->layout);
+		}
+
+//	Release the compiled buffers since the objects have been created:
+		if (vertexShaderBuffer)
+		{
+			vertexShaderBuffer->Release();
+			vertexShaderBuffer = 0;
+		}
+
+		if (pixelShaderBuffer)
+		{
+			pixelShaderBuffer->Release();
+			pixelShaderBuffer = 0;
+		}
+	}
+
+	if (failed)
+	{
+//	The shared objects stay in the tables and are released at Shutdown, only the family goes away:
+		for (i = 0; i < SHADER_PERMUTATION_COUNT; i++)
+		{
+			if (family.permutations[i])
+			{
+				delete family.permutations[i];
+				family.permutations[i] = 0;
+			}
+		}
+
+		return -1;
+	}
+
+	m_families.push_back(family);
+
+	return (int)m_families.size() - 1;
+}
+
+//	GetPermutation is a plain array lookup so it can be called for every draw. Flags the family was
+//	not compiled with are ignored rather than failing the draw.
+ShaderManagerClass::ShaderPermutationType* ShaderManagerClass::GetPermutation(int family, unsigned int flags)
+{
+	if (family < 0 || family >= (int)m_families.size())
+	{
+		return 0;
+	}
+
+	return m_families[family].permutations[flags & m_families[family].supportedFlags];
+}
+
+//	SetShader binds the Input Layout and the Vertex and Pixel Shaders of one permutation.
+bool ShaderManagerClass::SetShader(ID3D11DeviceContext* deviceContext, int family, unsigned int flags)
+{
+	ShaderPermutationType* permutation;
+
+	permutation = GetPermutation(family, flags);
+	if (!permutation)
+	{
+		return false;
+	}
+
+	deviceContext->IASetInputLayout(permutation->layout);
+	deviceContext->VSSetShader(permutation->vertexShader, NULL, 0);
+	deviceContext->PSSetShader(permutation->pixelShader, NULL, 0);
+
+	return true;
+}
+
+int ShaderManagerClass::GetUniqueShaderCount()
+{
+	return (int)(m_vertexShaders.size() + m_pixelShaders.size());
+}
+
+int ShaderManagerClass::GetUniqueLayoutCount()
+{
+	return (int)m_layouts.size();
+}
+
+//	CompileShader hands out the precompiled bytecode of the stage if there is any and compiles the shader file
+//	otherwise. Errors are reported the same way the ColorShaderClass always did, through shader-error.txt.
+bool ShaderManagerClass::CompileShader(WCHAR* filename, const char* entryPoint, const char* target, unsigned int flags, ID3D10Blob** shaderBuffer)
+{
+	unordered_map<wstring, ID3D10Blob*>::iterator precompiled;
+	ID3D10Blob* errorMessage;
+	HRESULT result;
+
+	{
+		lock_guard<mutex> lock(m_precompiledMutex);
+
+		precompiled = m_precompiled.find(GetCompileKey(filename, entryPoint, target, flags));
+		if (precompiled != m_precompiled.end())
+		{
+			*shaderBuffer = precompiled->second;
+			(*shaderBuffer)->AddRef();
+			return true;
+		}
+	}
+
+	errorMessage = 0;
+	result = CompileShaderFile(filename, entryPoint, target, flags, shaderBuffer, &errorMessage);
+	if (FAILED(result))
+	{
+//	If the Shader failed to compile it should have writen something to the Error Message.
+		if (errorMessage)
+		{
+			OutputShaderErrorMessage(errorMessage, filename);
+		}
+//	If there was nothing in the error message then it simply could not find the Shader itself.
+		else
+		{
+			MessageBox(m_hwnd, filename, L"Missing Shader File", MB_OK);
+		}
+
+		return false;
+	}
+
+	return true;
+}
+
+//	CompileShaderFile turns the permutation flags into defines and compiles one stage of the shader file.
+HRESULT ShaderManagerClass::CompileShaderFile(WCHAR* filename, const char* entryPoint, const char* target, unsigned int flags,
+	ID3D10Blob** shaderBuffer, ID3D10Blob** errorMessage)
+{
+	D3D_SHADER_MACRO defines[SHADER_PERMUTATION_BITS + 1];
+	int count;
+
+	count = 0;
+	if (flags & SHADER_INSTANCED)
+	{
+		defines[count].Name = "INSTANCED";
+		defines[count].Definition = "1";
+		count++;
+	}
+	if (flags & SHADER_QUANTIZED)
+	{
+		defines[count].Name = "QUANTIZED";
+		defines[count].Definition = "1";
+		count++;
+	}
+	if (flags & SHADER_TEXTURED)
+	{
+		defines[count].Name = "TEXTURED";
+		defines[count].Definition = "1";
+		count++;
+	}
+	if (flags & SHADER_LIT)
+	{
+		defines[count].Name = "LIT";
+		defines[count].Definition = "1";
+		count++;
+	}
+
+//	The define list is terminated by a null entry:
+	defines[count].Name = NULL;
+	defines[count].Definition = NULL;
+
+	return D3DCompileFromFile(filename, defines, NULL, entryPoint, target, D3D10_SHADER_ENABLE_STRICTNESS, 0, shaderBuffer, errorMessage);
+}
+
+//	PrecompileShader compiles one stage into the precompiled table unless it is there already. The lock is
+//	not held while compiling, so two threads can compile the same stage at once, and the second one to
+//	finish throws its bytecode away.
+void ShaderManagerClass::PrecompileShader(WCHAR* filename, const char* entryPoint, const char* target, unsigned int flags)
+{
+	wstring key;
+	ID3D10Blob* shaderBuffer;
+	ID3D10Blob* errorMessage;
+	HRESULT result;
+
+	key = GetCompileKey(filename, entryPoint, target, flags);
+
+	{
+		lock_guard<mutex> lock(m_precompiledMutex);
+
+		if (m_precompiled.count(key) > 0)
+		{
+			return;
+		}
+	}
+
+	shaderBuffer = 0;
+	errorMessage = 0;
+	result = CompileShaderFile(filename, entryPoint, target, flags, &shaderBuffer, &errorMessage);
+	if (errorMessage)
+	{
+		errorMessage->Release();
+		errorMessage = 0;
+	}
+
+	if (FAILED(result))
+	{
+		return;
+	}
+
+	{
+		lock_guard<mutex> lock(m_precompiledMutex);
+
+		if (m_precompiled.count(key) == 0)
+		{
+			m_precompiled[key] = shaderBuffer;
+			shaderBuffer = 0;
+		}
+	}
+
+	if (shaderBuffer)
+	{
+		shaderBuffer->Release();
+		shaderBuffer = 0;
+	}
+
+	return;
+}
+
+//	GetCompileKey joins everything a stage is compiled from into one string.
+wstring ShaderManagerClass::GetCompileKey(WCHAR* filename, const char* entryPoint, const char* target, unsigned int flags)
+{
+	wstring key;
+
+	key = filename;
+	key += L'|';
+	key.append(entryPoint, entryPoint + strlen(entryPoint));
+	key += L'|';
+	key.append(target, target + strlen(target));
+	key += L'|';
+	key += (wchar_t)(L'0' + flags);
+
+	return key;
+}
+
+//	BuildInputLayout reflects the input signature of the compiled Vertex Shader and takes the input element
+//	for each parameter from the vertex format, so the offsets and DXGI formats are the ones the C++ struct was
+//	declared with. Semantics starting with INSTANCE come from the instance format in slot 1 once per instance,
+//	everything else from the vertex format in slot 0. A parameter the format does not have, or has with another
+//	number or type of components, fails the layout instead of reading the wrong bytes at draw time.
+bool ShaderManagerClass::BuildInputLayout(ID3D10Blob* vertexShaderBuffer, const VertexFormatType* vertexFormat, const VertexFormatType* instanceFormat,
+	WCHAR* shaderFilename, ID3D11InputLayout** layout)
+{
+	ID3D11ShaderReflection* reflection;
+	D3D11_SHADER_DESC shaderDesc;
+	D3D11_SIGNATURE_PARAMETER_DESC parameterDesc;
+	vector<D3D11_INPUT_ELEMENT_DESC> elements;
+	vector<unsigned char> key;
+	D3D11_INPUT_ELEMENT_DESC element;
+	const VertexFormatType* format;
+	unsigned long long hash;
+	unsigned int i, nameLength;
+	HRESULT result;
+	bool instanced;
+	int index;
+
+	result = D3DReflect(vertexShaderBuffer->GetBufferPointer(), vertexShaderBuffer->GetBufferSize(), IID_ID3D11ShaderReflection, (void**)&reflection);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	result = reflection->GetDesc(&shaderDesc);
+	if (FAILED(result))
+	{
+		reflection->Release();
+		return false;
+	}
+
+	for (i = 0; i < shaderDesc.InputParameters; i++)
+	{
+		reflection->GetInputParameterDesc(i, &parameterDesc);
+
+//	System values such as SV_VertexID are generated by the input assembler and have no element:
+		if (parameterDesc.SystemValueType != D3D_NAME_UNDEFINED)
+		{
+			continue;
+		}
+
+		instanced = strncmp(parameterDesc.SemanticName, SHADER_INSTANCE_SEMANTIC, sizeof(SHADER_INSTANCE_SEMANTIC) - 1) == 0;
+		format = instanced ? instanceFormat : vertexFormat;
+
+		index = format ? FindElement(format, parameterDesc) : -1;
+		if (index < 0)
+		{
+			OutputLayoutErrorMessage(parameterDesc, format, shaderFilename);
+			reflection->Release();
+			return false;
+		}
+
+		element = format->elements[index];
+		element.InputSlot = instanced ? 1 : 0;
+		element.InputSlotClass = instanced ? D3D11_INPUT_PER_INSTANCE_DATA : D3D11_INPUT_PER_VERTEX_DATA;
+		element.InstanceDataStepRate = instanced ? 1 : 0;
+
+		elements.push_back(element);
+
+//	The dedupe key holds the semantic text rather than the pointer, which belongs to the vertex format:
+		nameLength = (unsigned int)strlen(element.SemanticName);
+		key.insert(key.end(), element.SemanticName, element.SemanticName + nameLength + 1);
+		key.insert(key.end(), (unsigned char*)&element.SemanticIndex, (unsigned char*)&element.SemanticIndex + sizeof(UINT));
+		key.insert(key.end(), (unsigned char*)&element.Format, (unsigned char*)&element.Format + sizeof(DXGI_FORMAT));
+		key.insert(key.end(), (unsigned char*)&element.InputSlot, (unsigned char*)&element.InputSlot + sizeof(UINT));
+		key.insert(key.end(), (unsigned char*)&element.AlignedByteOffset, (unsigned char*)&element.AlignedByteOffset + sizeof(UINT));
+	}
+
+//	A shader that reads nothing but system values, like a full screen pass, is drawn without a layout:
+	if (elements.empty())
+	{
+		*layout = 0;
+		reflection->Release();
+		return true;
+	}
+
+//	Reuse an identical layout if another permutation already created one:
+	hash = HashBytes(key.data(), key.size());
+	*layout = (ID3D11InputLayout*)FindShared(m_layouts, hash, key.data(), key.size());
+	if (!*layout)
+	{
+		result = m_device->CreateInputLayout(elements.data(), (unsigned int)elements.size(), vertexShaderBuffer->GetBufferPointer(),
+			vertexShaderBuffer->GetBufferSize(), layout);
+		if (FAILED(result))
+		{
+			reflection->Release();
+			return false;
+		}
+
+		AddShared(m_layouts, hash, key.data(), key.size(), *layout);
+		CommandCaptureClass::TagInputLayout(*layout, elements.data(), (unsigned int)elements.size(), vertexShaderBuffer->GetBufferPointer(),
+			vertexShaderBuffer->GetBufferSize());
+	}
+
+//	Release the reflection now that the input parameters are no longer needed:
+	reflection->Release();
+	reflection = 0;
+
+	return true;
+}
+
+//	FindElement returns the element of the format with the semantic of the shader parameter, or -1 if there is
+//	none or it does not give the shader the number and type of components it declares.
+int ShaderManagerClass::FindElement(const VertexFormatType* format, const D3D11_SIGNATURE_PARAMETER_DESC& parameterDesc)
+{
+	int components, i;
+
+	components = 0;
+	if (parameterDesc.Mask & 1) components++;
+	if (parameterDesc.Mask & 2) components++;
+	if (parameterDesc.Mask & 4) components++;
+	if (parameterDesc.Mask & 8) components++;
+
+	for (i = 0; i < format->elementCount; i++)
+	{
+		if (strcmp(format->elements[i].SemanticName, parameterDesc.SemanticName) == 0 && format->elements[i].SemanticIndex == parameterDesc.SemanticIndex)
+		{
+			if (format->attributes[i].components != components || format->attributes[i].componentType != parameterDesc.ComponentType)
+			{
+				return -1;
+			}
+
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+//	The OutputShaderErrorMessage writes out error messages that are
+//	generating when compiling either Vertex Shaders or Pixel Shaders:
+void ShaderManagerClass::OutputShaderErrorMessage(ID3D10Blob* errorMessage, WCHAR* shaderFilename)
+{
+	char* compileErrors;
+	unsigned long long bufferSize, i;
+	ofstream fout;
+
+//	Get a pointer to the error message text buffer:
+	compileErrors = (char*)(errorMessage->GetBufferPointer());
+
+//	Get the length of the Message:
+	bufferSize = errorMessage->GetBufferSize();
+
+//	Open a file to write the error message to:
+	fout.open("shader-error.txt");
+
+//	Write out the error message:
+	for (i = 0; i < bufferSize; i++)
+	{
+		fout << compileErrors[i];
+	}
+
+//	Close the file:
+	fout.close();
+
+//	Release the Error Message:
+	errorMessage->Release();
+	errorMessage = 0;
+
+//	Pop a message up on the screen to notify the user to check the text file for compile errors.
+	MessageBox(m_hwnd, L"Error compiling shader. Check shader-error.txt for message.", shaderFilename, MB_OK);
+
+	return;
+}
+
+//	OutputLayoutErrorMessage writes out which parameter of the Vertex Shader the vertex format could not feed,
+//	in the same file as the compile errors.
+void ShaderManagerClass::OutputLayoutErrorMessage(const D3D11_SIGNATURE_PARAMETER_DESC& parameterDesc, const VertexFormatType* format, WCHAR* shaderFilename)
+{
+	ofstream fout;
+
+	fout.open("shader-error.txt");
+
+	fout << "The vertex shader reads " << parameterDesc.SemanticName << parameterDesc.SemanticIndex << ", which ";
+	if (format)
+	{
+		fout << format->name << " does not have with the same number and type of components." << endl;
+	}
+	else
+	{
+		fout << "no vertex format was given for." << endl;
+	}
+
+	fout.close();
+
+	MessageBox(m_hwnd, L"Error building input layout. Check shader-error.txt for message.", shaderFilename, MB_OK);
+
+	return;
+}
+
+IUnknown* ShaderManagerClass::FindShared(SharedTableType& table, unsigned long long hash, const void* key, unsigned long long keySize)
+{
+	pair<SharedTableType::iterator, SharedTableType::iterator> range;
+	SharedTableType::iterator it;
+
+//	Objects whose hashes collide share the bucket, so every one with the hash is compared:
+	range = table.equal_range(hash);
+	for (it = range.first; it != range.second; ++it)
+	{
+		if (it->second.key.size() == keySize && memcmp(it->second.key.data(), key, (size_t)keySize) == 0)
+		{
+			return it->second.object;
+		}
+	}
+
+	return 0;
+}
+
+void ShaderManagerClass::AddShared(SharedTableType& table, unsigned long long hash, const void* key, unsigned long long keySize, IUnknown* object)
+{
+	SharedObjectType entry;
+
+	entry.key.assign((const unsigned char*)key, (const unsigned char*)key + keySize);
+	entry.object = object;
+
+	table.insert(make_pair(hash, entry));
+
+	return;
+}
+
+void ShaderManagerClass::ReleaseShared(SharedTableType& table)
+{
+	SharedTableType::iterator it;
+
+	for (it = table.begin(); it != table.end(); ++it)
+	{
+		if (it->second.object)
+		{
+			it->second.object->Release();
+			it->second.object = 0;
+		}
+	}
+	table.clear();
+
+	return;
+}
+
+//	A 64-bit FNV-1a hash, good enough to spread bytecode and layout keys across the tables.
+unsigned long long ShaderManagerClass::HashBytes(const void* data, unsigned long long size)
+{
+	const unsigned char* bytes;
+	unsigned long long hash, i;
+
+	bytes = (const unsigned char*)data;
+	hash = 14695981039346656037ULL;
+
+	for (i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
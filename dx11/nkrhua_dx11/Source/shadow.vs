@@ -0,0 +1,33 @@
+//  The shadow vertex shader draws the shadow casters into the shadow map of one cascade. Only the depth
+//  is written, so it needs nothing but the position and the matrix from the caster's world space to the
+//  clip space of the light.
+
+// Globals:
+cbuffer ShadowBuffer
+{
+    matrix worldViewProjectionMatrix;
+};
+
+//  The layout takes the position from ColorVertexType. The position comes first in every vertex format of
+//  the scene, so the casters are drawn from the same vertex buffers as the scene itself.
+
+//  Typedefs:
+struct VertexInputType
+{
+    float3 position : POSITION;
+};
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+};
+
+//  Vertex Shader:
+PixelInputType ShadowVertexShader(VertexInputType input)
+{
+    PixelInputType output;
+
+    output.position = mul(float4(input.position, 1.0f), worldViewProjectionMatrix);
+
+    return output;
+};
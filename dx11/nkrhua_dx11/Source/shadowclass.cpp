@@ -0,0 +1,716 @@
+#include "../Headers/shadowclass.h"
+
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+#include <chrono>
+
+ShadowClass::ShadowClass()
+{
+	int i;
+
+	m_mapSize = 0;
+	m_lightDirection = XMFLOAT3(0.0f, -1.0f, 0.0f);
+	m_lightColor = XMFLOAT3(1.0f, 1.0f, 1.0f);
+	m_nearZ = 1.0f;
+	m_farZ = 2.0f;
+	m_projectionX = 1.0f;
+	m_projectionY = 1.0f;
+	m_casterCount = 0;
+	m_currentCascade = 0;
+	m_ResourceRegistry = 0;
+	m_shadowMapArray.id = 0;
+	for (i = 0; i < SHADOW_CASCADE_COUNT; i++)
+	{
+		m_depthStencilViews[i].id = 0;
+	}
+	m_shaderResourceView.id = 0;
+	m_sampleState.id = 0;
+	m_rasterState.id = 0;
+	m_shadowBuffer.id = 0;
+	m_casterBuffer.id = 0;
+	m_ShaderManager = 0;
+	m_shaderFamily = -1;
+	m_updateTime = 0.0f;
+}
+
+ShadowClass::ShadowClass(const ShadowClass& other)
+{
+
+}
+
+ShadowClass::~ShadowClass()
+{
+
+}
+
+//	Precompile compiles the caster shaders ahead of Initialize, the same way the color shader does.
+void ShadowClass::Precompile(ShaderManagerClass* shaderManager)
+{
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+
+	if (wcscpy_s(vsFilename, 128, L"./Source/shadow.vs") != 0 || wcscpy_s(psFilename, 128, L"./Source/shadow.ps") != 0)
+	{
+		return;
+	}
+
+	shaderManager->Precompile(vsFilename, "ShadowVertexShader", psFilename, "ShadowPixelShader", 0);
+
+	return;
+}
+
+//	Initialize creates the shadow map array with the given size per cascade in the Resource Registry. Without
+//	a device only the CPU side is set up and nothing may be drawn.
+bool ShadowClass::Initialize(ID3D11Device* device, ResourceRegistryClass* resourceRegistry, ShaderManagerClass* shaderManager,
+	int mapSize)
+{
+	bool result;
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+	int error;
+
+	m_mapSize = mapSize;
+	m_casterBlocks.clear();
+	m_casterCount = 0;
+
+	if (!device)
+	{
+		return true;
+	}
+
+	m_ResourceRegistry = resourceRegistry;
+	m_ShaderManager = shaderManager;
+
+//	Set the filenames of the Vertex and Pixel Shader:
+	error = wcscpy_s(vsFilename, 128, L"./Source/shadow.vs");
+	if (error != 0)
+	{
+		return false;
+	}
+
+	error = wcscpy_s(psFilename, 128, L"./Source/shadow.ps");
+	if (error != 0)
+	{
+		return false;
+	}
+
+	result = InitializeShader(vsFilename, psFilename);
+	if (!result)
+	{
+		return false;
+	}
+
+	result = InitializeShadowMaps(device);
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void ShadowClass::Shutdown()
+{
+	ShutdownShadowMaps();
+
+	m_casterBlocks.clear();
+	m_casterCount = 0;
+
+	return;
+}
+
+//	SetLight sets the direction the light shines in and its color.
+void ShadowClass::SetLight(XMFLOAT3 direction, XMFLOAT3 color)
+{
+	XMStoreFloat3(&m_lightDirection, XMVector3Normalize(XMLoadFloat3(&direction)));
+	m_lightColor = color;
+
+	return;
+}
+
+//	AddCaster adds a shadow caster with its world space box and returns its index, which is what the
+//	render queues hold.
+int ShadowClass::AddCaster(XMFLOAT3 minimum, XMFLOAT3 maximum)
+{
+	CasterBlockType block;
+	XMVECTOR empty;
+
+//	Start a new block with every lane empty. An empty box is inside out, so it fails every plane:
+	if (m_casterCount % SHADOW_CASTER_BLOCK == 0)
+	{
+		empty = XMVectorReplicate(FLT_MAX);
+		XMStoreFloat4A(&block.minimumX, empty);
+		XMStoreFloat4A(&block.minimumY, empty);
+		XMStoreFloat4A(&block.minimumZ, empty);
+
+		empty = XMVectorReplicate(-FLT_MAX);
+		XMStoreFloat4A(&block.maximumX, empty);
+		XMStoreFloat4A(&block.maximumY, empty);
+		XMStoreFloat4A(&block.maximumZ, empty);
+
+		m_casterBlocks.push_back(block);
+	}
+
+	m_casterCount++;
+	SetCasterBounds(m_casterCount - 1, minimum, maximum);
+
+	return m_casterCount - 1;
+}
+
+//	SetCasterBounds moves a caster to a new world space box, for casters that move between frames.
+void ShadowClass::SetCasterBounds(int caster, XMFLOAT3 minimum, XMFLOAT3 maximum)
+{
+	CasterBlockType* block;
+	int lane;
+
+	block = &m_casterBlocks[caster / SHADOW_CASTER_BLOCK];
+	lane = caster % SHADOW_CASTER_BLOCK;
+
+	(&block->minimumX.x)[lane] = minimum.x;
+	(&block->minimumY.x)[lane] = minimum.y;
+	(&block->minimumZ.x)[lane] = minimum.z;
+	(&block->maximumX.x)[lane] = maximum.x;
+	(&block->maximumY.x)[lane] = maximum.y;
+	(&block->maximumZ.x)[lane] = maximum.z;
+
+	return;
+}
+
+int ShadowClass::GetCasterCount()
+{
+	return m_casterCount;
+}
+
+//	Update splits the view frustum of the given view and perspective projection matrix into cascades,
+//	fits the light projection of each and fills the render queues. The cascades are culled side by side on
+//	the job threads. The split distances blend logarithmic and even spacing by SHADOW_SPLIT_LAMBDA.
+void ShadowClass::Update(JobSystemClass* jobSystem, XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+{
+	chrono::high_resolution_clock::time_point startTime;
+	XMFLOAT4X4 projection;
+	XMMATRIX inverseViewMatrix;
+	XMVECTOR up;
+	float fraction, splits[SHADOW_CASCADE_COUNT + 1];
+	int i;
+
+	startTime = chrono::high_resolution_clock::now();
+
+	XMStoreFloat4x4(&projection, projectionMatrix);
+	XMStoreFloat4x4(&m_viewMatrix, viewMatrix);
+
+	m_projectionX = projection._11;
+	m_projectionY = projection._22;
+	m_nearZ = -projection._43 / projection._33;
+	m_farZ = projection._43 / (1.0f - projection._33);
+
+	for (i = 0; i <= SHADOW_CASCADE_COUNT; i++)
+	{
+		fraction = (float)i / (float)SHADOW_CASCADE_COUNT;
+		splits[i] = SHADOW_SPLIT_LAMBDA * m_nearZ * powf(m_farZ / m_nearZ, fraction) + (1.0f - SHADOW_SPLIT_LAMBDA) * (m_nearZ + (m_farZ - m_nearZ) * fraction);
+	}
+
+//	The light looks down its direction from the origin. Only the rotation matters, the cascades are placed
+//	in its space afterwards:
+	up = (fabsf(m_lightDirection.y) > 0.99f) ? XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f) : XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+	XMStoreFloat4x4(&m_lightView, XMMatrixLookToLH(XMVectorZero(), XMLoadFloat3(&m_lightDirection), up));
+
+	inverseViewMatrix = XMMatrixInverse(NULL, viewMatrix);
+	for (i = 0; i < SHADOW_CASCADE_COUNT; i++)
+	{
+		m_cascades[i].nearZ = splits[i];
+		m_cascades[i].farZ = splits[i + 1];
+		FitCascade(i, inverseViewMatrix);
+	}
+
+	jobSystem->ParallelFor(SHADOW_CASCADE_COUNT, 1, [this](int begin, int end)
+	{
+		int i;
+
+		for (i = begin; i < end; i++)
+		{
+			CullCascade(i);
+		}
+	});
+
+	m_updateTime = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+
+	return;
+}
+
+int ShadowClass::GetCascadeCount()
+{
+	return SHADOW_CASCADE_COUNT;
+}
+
+//	GetSplitDistance returns the view space depth a cascade ends at.
+float ShadowClass::GetSplitDistance(int cascade)
+{
+	return m_cascades[cascade].farZ;
+}
+
+//	GetCascadeMatrix returns the view projection matrix of the light for a cascade.
+XMMATRIX ShadowClass::GetCascadeMatrix(int cascade)
+{
+	return XMLoadFloat4x4(&m_cascades[cascade].lightViewProjection);
+}
+
+//	GetQueueSize and GetQueue return the casters of a cascade from the last Update, closest to the light
+//	first.
+int ShadowClass::GetQueueSize(int cascade)
+{
+	return (int)m_cascades[cascade].casters.size();
+}
+
+const int* ShadowClass::GetQueue(int cascade)
+{
+	return m_cascades[cascade].casters.data();
+}
+
+float ShadowClass::GetUpdateTime()
+{
+	return m_updateTime;
+}
+
+//	BeginCascade clears the shadow map of a cascade and makes it the depth target. The shadow map array
+//	is unbound from the pixel shader first, as it can not be read and written at once.
+void ShadowClass::BeginCascade(ID3D11DeviceContext* deviceContext, int cascade)
+{
+	ID3D11ShaderResourceView* nullView;
+	ID3D11DepthStencilView* depthStencilView;
+	D3D11_VIEWPORT viewport;
+
+	nullView = 0;
+	deviceContext->PSSetShaderResources(4, 1, &nullView);
+
+	depthStencilView = m_ResourceRegistry->Get(m_depthStencilViews[cascade]);
+	deviceContext->OMSetRenderTargets(0, NULL, depthStencilView);
+	deviceContext->ClearDepthStencilView(depthStencilView, D3D11_CLEAR_DEPTH, 1.0f, 0);
+
+	viewport.Width = (float)m_mapSize;
+	viewport.Height = (float)m_mapSize;
+	viewport.MinDepth = 0.0f;
+	viewport.MaxDepth = 1.0f;
+	viewport.TopLeftX = 0.0f;
+	viewport.TopLeftY = 0.0f;
+	deviceContext->RSSetViewports(1, &viewport);
+	deviceContext->RSSetState(m_ResourceRegistry->Get(m_rasterState));
+
+	m_ShaderManager->SetShader(deviceContext, m_shaderFamily, 0);
+	m_currentCascade = cascade;
+
+	return;
+}
+
+//	RenderCaster draws the given range of the geometry on the pipeline into the shadow map of the current
+//	cascade.
+bool ShadowClass::RenderCaster(ID3D11DeviceContext* deviceContext, int indexCount, int startIndex, int baseVertex,
+	XMMATRIX worldMatrix)
+{
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	CasterBufferType* dataPtr;
+	ID3D11Buffer* casterBuffer;
+
+	casterBuffer = m_ResourceRegistry->Get(m_casterBuffer);
+
+	result = deviceContext->Map(casterBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	dataPtr = (CasterBufferType*)mappedResource.pData;
+	dataPtr->worldViewProjection = XMMatrixTranspose(XMMatrixMultiply(worldMatrix, XMLoadFloat4x4(&m_cascades[m_currentCascade].lightViewProjection)));
+
+	deviceContext->Unmap(casterBuffer, 0);
+
+	deviceContext->VSSetConstantBuffers(0, 1, &casterBuffer);
+	deviceContext->DrawIndexed(indexCount, startIndex, baseVertex);
+
+	return true;
+}
+
+//	Render hands the shadow maps to the pixel shader for drawing the scene: the constant buffer to slot 1,
+//	the shadow map array to slot 4 and the comparison sampler to slot 1. The cascade matrices take view
+//	space positions, which is what the lit permutation has, straight to shadow map coordinates.
+bool ShadowClass::Render(ID3D11DeviceContext* deviceContext)
+{
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	ShadowBufferType* dataPtr;
+	ID3D11Buffer* shadowBuffer;
+	ID3D11ShaderResourceView* shaderResourceView;
+	ID3D11SamplerState* sampleState;
+	XMMATRIX viewMatrix, inverseViewMatrix, textureMatrix;
+	XMVECTOR direction;
+	int i;
+
+	shadowBuffer = m_ResourceRegistry->Get(m_shadowBuffer);
+	shaderResourceView = m_ResourceRegistry->Get(m_shaderResourceView);
+	sampleState = m_ResourceRegistry->Get(m_sampleState);
+
+	viewMatrix = XMLoadFloat4x4(&m_viewMatrix);
+	inverseViewMatrix = XMMatrixInverse(NULL, viewMatrix);
+
+//	Clip space runs from -1 to +1 with y up, texture coordinates from 0 to 1 with y down:
+	textureMatrix = XMMatrixSet(0.5f, 0.0f, 0.0f, 0.0f, 0.0f, -0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.5f, 0.5f, 0.0f, 1.0f);
+
+	result = deviceContext->Map(shadowBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	dataPtr = (ShadowBufferType*)mappedResource.pData;
+	for (i = 0; i < SHADOW_CASCADE_COUNT; i++)
+	{
+		dataPtr->cascades[i] = XMMatrixTranspose(inverseViewMatrix * XMLoadFloat4x4(&m_cascades[i].lightViewProjection) * textureMatrix);
+	}
+	dataPtr->splits = XMFLOAT4(m_cascades[0].farZ, m_cascades[1].farZ, m_cascades[2].farZ, m_cascades[3].farZ);
+
+//	The pixel shader wants the direction towards the light, in view space:
+	direction = XMVector3Normalize(XMVector3TransformNormal(XMVectorNegate(XMLoadFloat3(&m_lightDirection)), viewMatrix));
+	XMStoreFloat4(&dataPtr->lightDirection, direction);
+	dataPtr->lightColor = XMFLOAT4(m_lightColor.x, m_lightColor.y, m_lightColor.z, 1.0f);
+
+	deviceContext->Unmap(shadowBuffer, 0);
+
+	deviceContext->PSSetConstantBuffers(1, 1, &shadowBuffer);
+	deviceContext->PSSetShaderResources(4, 1, &shaderResourceView);
+	deviceContext->PSSetSamplers(1, 1, &sampleState);
+
+	return true;
+}
+
+//	The shadow maps are one texture array with a depth view for every slice to render into and a single
+//	shader resource view over all slices to sample from.
+bool ShadowClass::InitializeShadowMaps(ID3D11Device* device)
+{
+	D3D11_TEXTURE2D_DESC textureDesc;
+	D3D11_DEPTH_STENCIL_VIEW_DESC depthStencilViewDesc;
+	D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc;
+	D3D11_SAMPLER_DESC samplerDesc;
+	D3D11_RASTERIZER_DESC rasterDesc;
+	D3D11_BUFFER_DESC bufferDesc;
+	ID3D11Texture2D* shadowMapArray;
+	ID3D11DepthStencilView* depthStencilView;
+	ID3D11ShaderResourceView* shaderResourceView;
+	ID3D11SamplerState* sampleState;
+	ID3D11RasterizerState* rasterState;
+	ID3D11Buffer* buffer;
+	HRESULT result;
+	int i;
+
+//	The format is typeless so it can be both written as depth and read as a float:
+	textureDesc.Width = m_mapSize;
+	textureDesc.Height = m_mapSize;
+	textureDesc.MipLevels = 1;
+	textureDesc.ArraySize = SHADOW_CASCADE_COUNT;
+	textureDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_DEFAULT;
+	textureDesc.BindFlags = D3D11_BIND_DEPTH_STENCIL | D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.MiscFlags = 0;
+
+	result = device->CreateTexture2D(&textureDesc, NULL, &shadowMapArray);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_shadowMapArray = m_ResourceRegistry->Register(shadowMapArray);
+
+	depthStencilViewDesc.Format = DXGI_FORMAT_D32_FLOAT;
+	depthStencilViewDesc.ViewDimension = D3D11_DSV_DIMENSION_TEXTURE2DARRAY;
+	depthStencilViewDesc.Flags = 0;
+	depthStencilViewDesc.Texture2DArray.MipSlice = 0;
+	depthStencilViewDesc.Texture2DArray.ArraySize = 1;
+
+	for (i = 0; i < SHADOW_CASCADE_COUNT; i++)
+	{
+		depthStencilViewDesc.Texture2DArray.FirstArraySlice = i;
+
+		result = device->CreateDepthStencilView(shadowMapArray, &depthStencilViewDesc, &depthStencilView);
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		m_depthStencilViews[i] = m_ResourceRegistry->Register(depthStencilView);
+	}
+
+	shaderResourceViewDesc.Format = DXGI_FORMAT_R32_FLOAT;
+	shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+	shaderResourceViewDesc.Texture2DArray.MostDetailedMip = 0;
+	shaderResourceViewDesc.Texture2DArray.MipLevels = 1;
+	shaderResourceViewDesc.Texture2DArray.FirstArraySlice = 0;
+	shaderResourceViewDesc.Texture2DArray.ArraySize = SHADOW_CASCADE_COUNT;
+
+	result = device->CreateShaderResourceView(shadowMapArray, &shaderResourceViewDesc, &shaderResourceView);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_shaderResourceView = m_ResourceRegistry->Register(shaderResourceView);
+
+//	The comparison sampler filters the results of four depth tests. Outside the map everything is lit:
+	samplerDesc.Filter = D3D11_FILTER_COMPARISON_MIN_MAG_LINEAR_MIP_POINT;
+	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_BORDER;
+	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_BORDER;
+	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_BORDER;
+	samplerDesc.MipLODBias = 0.0f;
+	samplerDesc.MaxAnisotropy = 1;
+	samplerDesc.ComparisonFunc = D3D11_COMPARISON_LESS_EQUAL;
+	samplerDesc.BorderColor[0] = 1.0f;
+	samplerDesc.BorderColor[1] = 1.0f;
+	samplerDesc.BorderColor[2] = 1.0f;
+	samplerDesc.BorderColor[3] = 1.0f;
+	samplerDesc.MinLOD = 0.0f;
+	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+
+	result = device->CreateSamplerState(&samplerDesc, &sampleState);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_sampleState = m_ResourceRegistry->Register(sampleState);
+
+//	Casters are drawn from both sides, with a slope scaled bias against shadow acne:
+	rasterDesc.AntialiasedLineEnable = false;
+	rasterDesc.CullMode = D3D11_CULL_NONE;
+	rasterDesc.DepthBias = 100;
+	rasterDesc.DepthBiasClamp = 0.0f;
+	rasterDesc.DepthClipEnable = true;
+	rasterDesc.FillMode = D3D11_FILL_SOLID;
+	rasterDesc.FrontCounterClockwise = false;
+	rasterDesc.MultisampleEnable = false;
+	rasterDesc.ScissorEnable = false;
+	rasterDesc.SlopeScaledDepthBias = 2.0f;
+
+	result = device->CreateRasterizerState(&rasterDesc, &rasterState);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_rasterState = m_ResourceRegistry->Register(rasterState);
+
+//	Setup the description of the Dynamic Constant Buffers of the scene and the casters:
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = sizeof(ShadowBufferType);
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_shadowBuffer = m_ResourceRegistry->Register(buffer);
+
+	bufferDesc.ByteWidth = sizeof(CasterBufferType);
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_casterBuffer = m_ResourceRegistry->Register(buffer);
+
+	return true;
+}
+
+bool ShadowClass::InitializeShader(WCHAR* vsFilename, WCHAR* psFilename)
+{
+	ShaderInputType input;
+
+//	The casters only write depth, so there are no permutations. They are drawn from the vertex buffers of
+//	the scene, which all start with the position of ColorVertexType:
+	input.flags = 0;
+	input.format = &ColorVertexType::GetFormat();
+
+	m_shaderFamily = m_ShaderManager->AddShader(vsFilename, "ShadowVertexShader", psFilename, "ShadowPixelShader", 0, &input, 1, NULL);
+	if (m_shaderFamily < 0)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+//	The shadow maps go back to the Resource Registry, which lets go of them once the frames using them are done.
+void ShadowClass::ShutdownShadowMaps()
+{
+	int i;
+
+	if (m_ResourceRegistry)
+	{
+		m_ResourceRegistry->Release(m_casterBuffer);
+		m_ResourceRegistry->Release(m_shadowBuffer);
+		m_ResourceRegistry->Release(m_rasterState);
+		m_ResourceRegistry->Release(m_sampleState);
+		m_ResourceRegistry->Release(m_shaderResourceView);
+
+		for (i = 0; i < SHADOW_CASCADE_COUNT; i++)
+		{
+			m_ResourceRegistry->Release(m_depthStencilViews[i]);
+		}
+
+		m_ResourceRegistry->Release(m_shadowMapArray);
+		m_ResourceRegistry = 0;
+	}
+
+//	The Shaders and the Layout belong to the Shader Manager which releases them on its own Shutdown.
+	m_shaderFamily = -1;
+	m_ShaderManager = 0;
+
+	return;
+}
+
+//	FitCascade places the bounding sphere of a cascade's slice of the view frustum in light space. The
+//	sphere is centered on the view axis where it passes through both the near and far corners of the
+//	slice, or at the far end when the slice is too long for that. Its size only depends on the projection,
+//	so it does not change as the camera turns. The center is snapped to whole texels of the shadow map.
+void ShadowClass::FitCascade(int cascade, XMMATRIX inverseViewMatrix)
+{
+	CascadeType* target;
+	XMVECTOR center;
+	float spread, centerZ, texelSize;
+
+	target = &m_cascades[cascade];
+
+//	The squared distance of a corner from the view axis per unit of depth:
+	spread = 1.0f / (m_projectionX * m_projectionX) + 1.0f / (m_projectionY * m_projectionY);
+
+	centerZ = 0.5f * (target->farZ + target->nearZ) * (1.0f + spread);
+	centerZ = (centerZ < target->farZ) ? centerZ : target->farZ;
+
+	target->radius = sqrtf((target->farZ - centerZ) * (target->farZ - centerZ) + target->farZ * target->farZ * spread);
+
+//	Round the radius up a little so rounding errors never change the texel size from frame to frame:
+	target->radius = ceilf(target->radius * 16.0f) / 16.0f;
+
+	center = XMVector3TransformCoord(XMVectorSet(0.0f, 0.0f, centerZ, 1.0f), inverseViewMatrix);
+	center = XMVector3TransformCoord(center, XMLoadFloat4x4(&m_lightView));
+	XMStoreFloat3(&target->center, center);
+
+	texelSize = 2.0f * target->radius / (float)m_mapSize;
+	target->center.x = floorf(target->center.x / texelSize) * texelSize;
+	target->center.y = floorf(target->center.y / texelSize) * texelSize;
+
+	return;
+}
+
+//	CullCascade tests the caster boxes against the four sides and the far end of a cascade's light box,
+//	all in world space. The planes come from the rows of the light view matrix, which map a world position
+//	to its light space x, y and depth. For each plane the corner of every box furthest along its normal is
+//	picked, and a box is culled if that corner is behind any plane. The near end is not tested, instead it
+//	is moved back to the closest caster that is kept.
+void ShadowClass::CullCascade(int cascade)
+{
+	CascadeType* target;
+	const CasterBlockType* block;
+	XMFLOAT4 planes[5];
+	XMVECTOR minimumX, minimumY, minimumZ, maximumX, maximumY, maximumZ;
+	XMVECTOR distance, outside, centerDepth, extentDepth, depthX, depthY, depthZ;
+	XMFLOAT4A depths, nearDepths;
+	XMUINT4 mask;
+	QueueEntryType entry;
+	float nearZ;
+	int i, j, lane;
+
+	target = &m_cascades[cascade];
+
+	planes[0] = XMFLOAT4(m_lightView._11, m_lightView._21, m_lightView._31, m_lightView._41 - (target->center.x - target->radius));
+	planes[1] = XMFLOAT4(-m_lightView._11, -m_lightView._21, -m_lightView._31, -m_lightView._41 + (target->center.x + target->radius));
+	planes[2] = XMFLOAT4(m_lightView._12, m_lightView._22, m_lightView._32, m_lightView._42 - (target->center.y - target->radius));
+	planes[3] = XMFLOAT4(-m_lightView._12, -m_lightView._22, -m_lightView._32, -m_lightView._42 + (target->center.y + target->radius));
+	planes[4] = XMFLOAT4(-m_lightView._13, -m_lightView._23, -m_lightView._33, -m_lightView._43 + (target->center.z + target->radius));
+
+	depthX = XMVectorReplicate(m_lightView._13);
+	depthY = XMVectorReplicate(m_lightView._23);
+	depthZ = XMVectorReplicate(m_lightView._33);
+
+	target->queue.clear();
+	nearZ = target->center.z - target->radius;
+
+	for (i = 0; i < (int)m_casterBlocks.size(); i++)
+	{
+		block = &m_casterBlocks[i];
+		minimumX = XMLoadFloat4A(&block->minimumX);
+		minimumY = XMLoadFloat4A(&block->minimumY);
+		minimumZ = XMLoadFloat4A(&block->minimumZ);
+		maximumX = XMLoadFloat4A(&block->maximumX);
+		maximumY = XMLoadFloat4A(&block->maximumY);
+		maximumZ = XMLoadFloat4A(&block->maximumZ);
+
+		outside = XMVectorFalseInt();
+		for (j = 0; j < 5; j++)
+		{
+			distance = XMVectorReplicate(planes[j].w);
+			distance = XMVectorMultiplyAdd((planes[j].x >= 0.0f) ? maximumX : minimumX, XMVectorReplicate(planes[j].x), distance);
+			distance = XMVectorMultiplyAdd((planes[j].y >= 0.0f) ? maximumY : minimumY, XMVectorReplicate(planes[j].y), distance);
+			distance = XMVectorMultiplyAdd((planes[j].z >= 0.0f) ? maximumZ : minimumZ, XMVectorReplicate(planes[j].z), distance);
+			outside = XMVectorOrInt(outside, XMVectorLess(distance, XMVectorZero()));
+		}
+
+		XMStoreUInt4(&mask, outside);
+		if (mask.x && mask.y && mask.z && mask.w)
+		{
+			continue;
+		}
+
+//	The light depth of the box centers for sorting, and of the box corners closest to the light:
+		centerDepth = XMVectorMultiply(XMVectorAdd(minimumX, maximumX), depthX);
+		centerDepth = XMVectorMultiplyAdd(XMVectorAdd(minimumY, maximumY), depthY, centerDepth);
+		centerDepth = XMVectorMultiplyAdd(XMVectorAdd(minimumZ, maximumZ), depthZ, centerDepth);
+		centerDepth = XMVectorAdd(XMVectorScale(centerDepth, 0.5f), XMVectorReplicate(m_lightView._43));
+
+		extentDepth = XMVectorMultiply(XMVectorSubtract(maximumX, minimumX), XMVectorAbs(depthX));
+		extentDepth = XMVectorMultiplyAdd(XMVectorSubtract(maximumY, minimumY), XMVectorAbs(depthY), extentDepth);
+		extentDepth = XMVectorMultiplyAdd(XMVectorSubtract(maximumZ, minimumZ), XMVectorAbs(depthZ), extentDepth);
+
+		XMStoreFloat4A(&depths, centerDepth);
+		XMStoreFloat4A(&nearDepths, XMVectorSubtract(centerDepth, XMVectorScale(extentDepth, 0.5f)));
+
+		for (lane = 0; lane < SHADOW_CASTER_BLOCK; lane++)
+		{
+			if ((&mask.x)[lane])
+			{
+				continue;
+			}
+
+			entry.depth = (&depths.x)[lane];
+			entry.caster = i * SHADOW_CASTER_BLOCK + lane;
+			target->queue.push_back(entry);
+
+			nearZ = ((&nearDepths.x)[lane] < nearZ) ? (&nearDepths.x)[lane] : nearZ;
+		}
+	}
+
+	sort(target->queue.begin(), target->queue.end(), [](const QueueEntryType& a, const QueueEntryType& b)
+	{
+		return a.depth < b.depth;
+	});
+
+	target->casters.resize(target->queue.size());
+	for (i = 0; i < (int)target->queue.size(); i++)
+	{
+		target->casters[i] = target->queue[i].caster;
+	}
+
+	XMStoreFloat4x4(&target->lightViewProjection, XMMatrixMultiply(XMLoadFloat4x4(&m_lightView),
+		XMMatrixOrthographicOffCenterLH(target->center.x - target->radius, target->center.x + target->radius,
+		target->center.y - target->radius, target->center.y + target->radius, nearZ, target->center.z + target->radius)));
+
+	return;
+}
@@ -0,0 +1,113 @@
+#include "../Headers/skeletonclass.h"
+
+SkeletonClass::SkeletonClass()
+{
+	m_jointCount = 0;
+}
+
+SkeletonClass::SkeletonClass(const SkeletonClass& other)
+{
+
+}
+
+SkeletonClass::~SkeletonClass()
+{
+
+}
+
+//	Initialize takes the parent of every joint (-1 for the root) and the bind pose as local rotations and
+//	translations, and computes the inverse bind matrices from it.
+bool SkeletonClass::Initialize(int jointCount, const int* parents, const XMFLOAT4* bindRotations, const XMFLOAT3* bindTranslations)
+{
+	XMMATRIX modelMatrices[SKELETON_MAX_JOINTS];
+	XMMATRIX localMatrix;
+	int i;
+
+	if (jointCount <= 0 || jointCount > SKELETON_MAX_JOINTS)
+	{
+		return false;
+	}
+
+//	The single pass palette computation needs every parent ahead of its children:
+	for (i = 0; i < jointCount; i++)
+	{
+		if (parents[i] >= i || parents[i] < -1)
+		{
+			return false;
+		}
+	}
+
+	m_jointCount = jointCount;
+	m_parents.assign(parents, parents + jointCount);
+	m_bindRotations.assign(bindRotations, bindRotations + jointCount);
+	m_bindTranslations.assign(bindTranslations, bindTranslations + jointCount);
+	m_inverseBindMatrices.resize(jointCount);
+
+	for (i = 0; i < jointCount; i++)
+	{
+		localMatrix = XMMatrixRotationQuaternion(XMLoadFloat4(&bindRotations[i]));
+		localMatrix.r[3] = XMVectorSetW(XMLoadFloat3(&bindTranslations[i]), 1.0f);
+
+		modelMatrices[i] = (parents[i] < 0) ? localMatrix : XMMatrixMultiply(localMatrix, modelMatrices[parents[i]]);
+
+		XMStoreFloat4x4(&m_inverseBindMatrices[i], XMMatrixInverse(NULL, modelMatrices[i]));
+	}
+
+	return true;
+}
+
+void SkeletonClass::Shutdown()
+{
+	m_parents.clear();
+	m_bindRotations.clear();
+	m_bindTranslations.clear();
+	m_inverseBindMatrices.clear();
+	m_jointCount = 0;
+
+	return;
+}
+
+int SkeletonClass::GetJointCount()
+{
+	return m_jointCount;
+}
+
+//	GetBindPose fills the pose arrays with the bind pose, which animation clips that leave a joint
+//	untouched fall back to.
+void SkeletonClass::GetBindPose(XMVECTOR* rotations, XMVECTOR* translations)
+{
+	int i;
+
+	for (i = 0; i < m_jointCount; i++)
+	{
+		rotations[i] = XMLoadFloat4(&m_bindRotations[i]);
+		translations[i] = XMLoadFloat3(&m_bindTranslations[i]);
+	}
+
+	return;
+}
+
+//	ComputeSkinningPalette turns a local pose into skinning matrices. Each joint is concatenated with its
+//	parent's model space matrix, which was computed earlier in the same loop. Once the whole chain is done
+//	every joint is prefixed with its inverse bind matrix in one batch, so the result can be applied to the
+//	bind pose vertices directly.
+void SkeletonClass::ComputeSkinningPalette(const XMVECTOR* rotations, const XMVECTOR* translations, XMFLOAT4X4* palette)
+{
+	XMMATRIX modelMatrices[SKELETON_MAX_JOINTS];
+	XMMATRIX localMatrix;
+	int i;
+
+	for (i = 0; i < m_jointCount; i++)
+	{
+		localMatrix = XMMatrixRotationQuaternion(rotations[i]);
+		localMatrix.r[3] = XMVectorSetW(translations[i], 1.0f);
+
+		modelMatrices[i] = (m_parents[i] < 0) ? localMatrix : XMMatrixMultiply(localMatrix, modelMatrices[m_parents[i]]);
+
+		XMStoreFloat4x4(&palette[i], modelMatrices[i]);
+	}
+
+	BatchMathClass::MultiplyMatrices(m_inverseBindMatrices.data(), palette, m_jointCount, palette);
+
+	return;
+}
@@ -0,0 +1,386 @@
+#include "../Headers/skinnedmodelclass.h"
+
+#include <math.h>
+#include <float.h>
+
+//	The shape of the generated tube. Every joint gets two rings of vertices, one halfway along its bone
+//	and one where it meets the next joint.
+const float SKINNED_MODEL_BONE_LENGTH = 0.5f;
+const float SKINNED_MODEL_RADIUS = 0.15f;
+const int SKINNED_MODEL_SIDES = 4;
+
+//	The clips are sampled at this rate over one second.
+const int SKINNED_MODEL_CLIP_FRAMES = 31;
+const float SKINNED_MODEL_CLIP_RATE = 30.0f;
+
+SkinnedModelClass::SkinnedModelClass()
+{
+	m_indexBuffer = 0;
+	m_indexCount = 0;
+}
+
+SkinnedModelClass::SkinnedModelClass(const SkinnedModelClass& other)
+{
+
+}
+
+SkinnedModelClass::~SkinnedModelClass()
+{
+
+}
+
+bool SkinnedModelClass::Initialize(ID3D11Device* device)
+{
+	bool result;
+
+	result = InitializeSkeleton();
+	if (!result)
+	{
+		return false;
+	}
+
+	result = InitializeClips();
+	if (!result)
+	{
+		return false;
+	}
+
+	result = InitializeBuffers(device);
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void SkinnedModelClass::Shutdown()
+{
+	int i;
+
+	ShutdownBuffers();
+
+	for (i = 0; i < SKINNED_MODEL_CLIPS; i++)
+	{
+		m_Clips[i].Shutdown();
+	}
+
+	m_Skeleton.Shutdown();
+
+	return;
+}
+
+//	Skin deforms the bind pose vertices with the palette of one character and writes them into space
+//	reserved from the Geometry Stream, returning the byte offset of the first vertex. It only reads shared
+//	data, so the job threads can skin many characters at the same time. The output goes straight into
+//	the mapped buffer, which is write combined memory, so it is only ever written and never read back.
+bool SkinnedModelClass::Skin(const XMFLOAT4X4* palette, GeometryStreamClass* stream, unsigned int& offset)
+{
+	XMMATRIX matrices[SKINNED_MODEL_JOINTS];
+	XMVECTOR bindPosition, position;
+	VertexType* output;
+	const SkinnedVertexType* vertex;
+	int i, j;
+
+	output = (VertexType*)stream->Reserve((unsigned int)(sizeof(VertexType) * m_vertices.size()), sizeof(VertexType), offset);
+	if (!output)
+	{
+		return false;
+	}
+
+	for (i = 0; i < SKINNED_MODEL_JOINTS; i++)
+	{
+		matrices[i] = XMLoadFloat4x4(&palette[i]);
+	}
+
+//	Transform every vertex by each of its joints and blend the results by weight, which is the same as
+//	blending the matrices first but needs no temporary matrix:
+	for (i = 0; i < (int)m_vertices.size(); i++)
+	{
+		vertex = &m_vertices[i];
+		bindPosition = XMLoadFloat3(&vertex->position);
+
+		position = XMVectorScale(XMVector3Transform(bindPosition, matrices[vertex->joints[0]]), vertex->weights[0]);
+		for (j = 1; j < 4 && vertex->weights[j] > 0.0f; j++)
+		{
+			position = XMVectorMultiplyAdd(XMVector3Transform(bindPosition, matrices[vertex->joints[j]]), XMVectorReplicate(vertex->weights[j]), position);
+		}
+
+		XMStoreFloat3(&output[i].position, position);
+		output[i].color = vertex->color;
+	}
+
+	return true;
+}
+
+//	Render puts the vertices written by Skin and the shared index buffer on the pipeline. The offset into
+//	the stream is given to the vertex buffer binding, so the indices can stay the same for every character.
+void SkinnedModelClass::Render(ID3D11DeviceContext* deviceContext, GeometryStreamClass* stream, unsigned int offset)
+{
+	ID3D11Buffer* vertexBuffer;
+	unsigned int stride;
+
+	vertexBuffer = stream->GetBuffer();
+	stride = sizeof(VertexType);
+
+	deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+	deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	return;
+}
+
+//	GetBounds returns a box around the vertices Skin would write for a palette without skinning them. Every
+//	skinned vertex is a weighted average of the vertex moved by each of its joints, so it lies inside the
+//	box around the moved boxes of the bind pose vertices of those joints.
+void SkinnedModelClass::GetBounds(const XMFLOAT4X4* palette, XMFLOAT3& minimum, XMFLOAT3& maximum)
+{
+	XMMATRIX matrix;
+	XMVECTOR lowest, highest, corner;
+	int i, j;
+
+	lowest = XMVectorReplicate(FLT_MAX);
+	highest = XMVectorReplicate(-FLT_MAX);
+
+	for (i = 0; i < SKINNED_MODEL_JOINTS; i++)
+	{
+		matrix = XMLoadFloat4x4(&palette[i]);
+
+		for (j = 0; j < 8; j++)
+		{
+			corner = XMVectorSet((j & 1) ? m_jointMaximum[i].x : m_jointMinimum[i].x, (j & 2) ? m_jointMaximum[i].y : m_jointMinimum[i].y, (j & 4) ? m_jointMaximum[i].z : m_jointMinimum[i].z, 1.0f);
+			corner = XMVector3Transform(corner, matrix);
+
+			lowest = XMVectorMin(lowest, corner);
+			highest = XMVectorMax(highest, corner);
+		}
+	}
+
+	XMStoreFloat3(&minimum, lowest);
+	XMStoreFloat3(&maximum, highest);
+
+	return;
+}
+
+int SkinnedModelClass::GetIndexCount()
+{
+	return m_indexCount;
+}
+
+SkeletonClass* SkinnedModelClass::GetSkeleton()
+{
+	return &m_Skeleton;
+}
+
+AnimationClipClass* SkinnedModelClass::GetClip(int index)
+{
+	if (index < 0 || index >= SKINNED_MODEL_CLIPS)
+	{
+		return 0;
+	}
+
+	return &m_Clips[index];
+}
+
+//	InitializeSkeleton builds a chain of joints going straight up, each one bone length above its parent.
+bool SkinnedModelClass::InitializeSkeleton()
+{
+	int parents[SKINNED_MODEL_JOINTS];
+	XMFLOAT4 rotations[SKINNED_MODEL_JOINTS];
+	XMFLOAT3 translations[SKINNED_MODEL_JOINTS];
+	int i;
+
+	for (i = 0; i < SKINNED_MODEL_JOINTS; i++)
+	{
+		parents[i] = i - 1;
+		rotations[i] = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+		translations[i] = XMFLOAT3(0.0f, (i == 0) ? 0.0f : SKINNED_MODEL_BONE_LENGTH, 0.0f);
+	}
+
+	return m_Skeleton.Initialize(SKINNED_MODEL_JOINTS, parents, rotations, translations);
+}
+
+//	InitializeClips generates the two clips: a sway that travels up the chain from side to side, and a
+//	slower bow towards and away from the camera with the root bobbing up and down. Only the root moves
+//	in either clip, so the translation tracks of all other joints compress down to a single value.
+bool SkinnedModelClass::InitializeClips()
+{
+	vector<XMFLOAT4> rotations;
+	vector<XMFLOAT3> translations;
+	float phase;
+	int frame, joint, index;
+	bool result;
+
+	rotations.resize(SKINNED_MODEL_CLIP_FRAMES * SKINNED_MODEL_JOINTS);
+	translations.resize(SKINNED_MODEL_CLIP_FRAMES * SKINNED_MODEL_JOINTS);
+
+//	The sway:
+	for (frame = 0; frame < SKINNED_MODEL_CLIP_FRAMES; frame++)
+	{
+		phase = XM_2PI * (float)frame / (float)(SKINNED_MODEL_CLIP_FRAMES - 1);
+		for (joint = 0; joint < SKINNED_MODEL_JOINTS; joint++)
+		{
+			index = frame * SKINNED_MODEL_JOINTS + joint;
+			XMStoreFloat4(&rotations[index], XMQuaternionRotationRollPitchYaw(0.0f, 0.0f, 0.3f * sinf(phase - 0.6f * (float)joint)));
+			translations[index] = XMFLOAT3(0.0f, (joint == 0) ? 0.0f : SKINNED_MODEL_BONE_LENGTH, 0.0f);
+		}
+	}
+
+	result = m_Clips[0].Initialize(SKINNED_MODEL_JOINTS, SKINNED_MODEL_CLIP_FRAMES, SKINNED_MODEL_CLIP_RATE, rotations.data(), translations.data());
+	if (!result)
+	{
+		return false;
+	}
+
+//	The bow:
+	for (frame = 0; frame < SKINNED_MODEL_CLIP_FRAMES; frame++)
+	{
+		phase = XM_2PI * (float)frame / (float)(SKINNED_MODEL_CLIP_FRAMES - 1);
+		for (joint = 0; joint < SKINNED_MODEL_JOINTS; joint++)
+		{
+			index = frame * SKINNED_MODEL_JOINTS + joint;
+			XMStoreFloat4(&rotations[index], XMQuaternionRotationRollPitchYaw(0.2f * sinf(phase), 0.0f, 0.0f));
+			translations[index] = XMFLOAT3(0.0f, (joint == 0) ? 0.15f * sinf(2.0f * phase) : SKINNED_MODEL_BONE_LENGTH, 0.0f);
+		}
+	}
+
+	result = m_Clips[1].Initialize(SKINNED_MODEL_JOINTS, SKINNED_MODEL_CLIP_FRAMES, SKINNED_MODEL_CLIP_RATE, rotations.data(), translations.data());
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+//	InitializeBuffers builds the tube around the chain. The rings halfway along a bone follow only that
+//	bone's joint, the rings where two bones meet are shared half and half, which bends the tube smoothly.
+//	Only the index buffer goes to the video card, the vertices are kept for skinning.
+bool SkinnedModelClass::InitializeBuffers(ID3D11Device* device)
+{
+	vector<unsigned long> indices;
+	SkinnedVertexType vertex;
+	D3D11_BUFFER_DESC indexBufferDesc;
+	D3D11_SUBRESOURCE_DATA indexData;
+	HRESULT result;
+	float angle, height;
+	int ring, ringCount, side, lower, upper, a, b, c, d, i, j, joint;
+
+	ringCount = SKINNED_MODEL_JOINTS * 2 + 1;
+
+	m_vertices.clear();
+	for (ring = 0; ring < ringCount; ring++)
+	{
+		height = (float)ring * 0.5f * SKINNED_MODEL_BONE_LENGTH;
+
+//	Odd rings sit in the middle of a bone, even rings where two bones meet or at the ends of the chain:
+		if (ring % 2 == 1)
+		{
+			lower = upper = ring / 2;
+		}
+		else
+		{
+			lower = ring / 2 - 1;
+			upper = ring / 2;
+			if (lower < 0)
+			{
+				lower = upper;
+			}
+			if (upper >= SKINNED_MODEL_JOINTS)
+			{
+				upper = lower;
+			}
+		}
+
+		vertex.joints[0] = lower;
+		vertex.joints[1] = upper;
+		vertex.joints[2] = 0;
+		vertex.joints[3] = 0;
+		vertex.weights[0] = (lower == upper) ? 1.0f : 0.5f;
+		vertex.weights[1] = (lower == upper) ? 0.0f : 0.5f;
+		vertex.weights[2] = 0.0f;
+		vertex.weights[3] = 0.0f;
+
+		vertex.color = XMFLOAT4(0.2f, 0.3f + 0.7f * (float)ring / (float)(ringCount - 1), 1.0f - 0.5f * (float)ring / (float)(ringCount - 1), 1.0f);
+
+		for (side = 0; side < SKINNED_MODEL_SIDES; side++)
+		{
+			angle = XM_2PI * (float)side / (float)SKINNED_MODEL_SIDES;
+			vertex.position = XMFLOAT3(SKINNED_MODEL_RADIUS * cosf(angle), height, SKINNED_MODEL_RADIUS * sinf(angle));
+			m_vertices.push_back(vertex);
+		}
+	}
+
+//	Keep a box around the bind pose vertices every joint moves, for GetBounds:
+	for (i = 0; i < SKINNED_MODEL_JOINTS; i++)
+	{
+		m_jointMinimum[i] = XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+		m_jointMaximum[i] = XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	}
+
+	for (i = 0; i < (int)m_vertices.size(); i++)
+	{
+		for (j = 0; j < 4 && m_vertices[i].weights[j] > 0.0f; j++)
+		{
+			joint = m_vertices[i].joints[j];
+			XMStoreFloat3(&m_jointMinimum[joint], XMVectorMin(XMLoadFloat3(&m_jointMinimum[joint]), XMLoadFloat3(&m_vertices[i].position)));
+			XMStoreFloat3(&m_jointMaximum[joint], XMVectorMax(XMLoadFloat3(&m_jointMaximum[joint]), XMLoadFloat3(&m_vertices[i].position)));
+		}
+	}
+
+//	Connect every ring to the next one with two clockwise triangles per side, seen from outside:
+	for (ring = 0; ring < ringCount - 1; ring++)
+	{
+		for (side = 0; side < SKINNED_MODEL_SIDES; side++)
+		{
+			a = ring * SKINNED_MODEL_SIDES + side;
+			b = ring * SKINNED_MODEL_SIDES + (side + 1) % SKINNED_MODEL_SIDES;
+			c = a + SKINNED_MODEL_SIDES;
+			d = b + SKINNED_MODEL_SIDES;
+
+			indices.push_back(a);
+			indices.push_back(c);
+			indices.push_back(d);
+
+			indices.push_back(a);
+			indices.push_back(d);
+			indices.push_back(b);
+		}
+	}
+
+	m_indexCount = (int)indices.size();
+
+//	Setup the description of the Static Index Buffer:
+	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	indexBufferDesc.ByteWidth = sizeof(unsigned long) * m_indexCount;
+	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	indexBufferDesc.CPUAccessFlags = 0;
+	indexBufferDesc.MiscFlags = 0;
+	indexBufferDesc.StructureByteStride = 0;
+
+	indexData.pSysMem = indices.data();
+	indexData.SysMemPitch = 0;
+	indexData.SysMemSlicePitch = 0;
+
+//	Create the Index Buffer:
+	result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void SkinnedModelClass::ShutdownBuffers()
+{
+	if (m_indexBuffer)
+	{
+		m_indexBuffer->Release();
+		m_indexBuffer = 0;
+	}
+
+	m_vertices.clear();
+
+	return;
+}
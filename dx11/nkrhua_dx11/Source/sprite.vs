@@ -0,0 +1,48 @@
+//  The sprite vertex shader draws every instance as a strip of four vertices and makes up the corners from
+//  the vertex id, so the sprites need no vertex buffer. The corner is turned by the rotation of the sprite
+//  around its center, in pixels from the center of the screen, before the orthographic matrix of Direct3D
+//  takes it to clip space. The depth is anything between the near and far plane, since sprites are drawn
+//  without the depth test.
+
+// Globals:
+cbuffer SpriteBuffer
+{
+    matrix orthoMatrix;
+};
+
+//  Typedefs:
+struct VertexInputType
+{
+    uint vertexID : SV_VertexID;
+    float4 rectangle : INSTANCERECTANGLE;
+    float4 tex : INSTANCETEXCOORD;
+    float2 rotation : INSTANCEROTATION;
+    float4 color : INSTANCECOLOR;
+};
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float2 tex : TEXCOORD0;
+    float4 color : COLOR;
+};
+
+//  Vertex Shader:
+PixelInputType SpriteVertexShader(VertexInputType input)
+{
+    PixelInputType output;
+    float2 corner, position;
+
+    // The strip goes top left, top right, bottom left, bottom right:
+    corner = float2((input.vertexID & 1) ? 1.0f : -1.0f, (input.vertexID & 2) ? -1.0f : 1.0f) * input.rectangle.zw;
+
+    // The rotation is the sine and the cosine, clockwise on the screen:
+    position.x = corner.x * input.rotation.y + corner.y * input.rotation.x;
+    position.y = corner.y * input.rotation.y - corner.x * input.rotation.x;
+
+    output.position = mul(float4(input.rectangle.xy + position, 1.0f, 1.0f), orthoMatrix);
+    output.tex = lerp(input.tex.xy, input.tex.zw, float2(input.vertexID & 1, (input.vertexID >> 1) & 1));
+    output.color = input.color;
+
+    return output;
+}
@@ -0,0 +1,648 @@
+#include "../Headers/spritebatchclass.h"
+
+#include <string.h>
+#include <atomic>
+
+//	The Sprite Batch the calling thread last drew into and its buffer there, so a thread only takes the lock
+//	the first time it draws into a batch. Batches are told apart by an id rather than by their address, which a
+//	later batch could get again.
+static atomic<unsigned int> g_nextBatchId(1);
+static thread_local unsigned int g_threadBatchId = 0;
+static thread_local void* g_threadBuffer = 0;
+
+static const unsigned int SPRITE_TEXTURE_MASK = SPRITE_MAX_TEXTURES - 1;
+
+//	RadixSort sorts the keys, and the indices that go with them, eight bits at a time from the lowest. Every
+//	pass is stable, so equal keys keep their order. The counts of all four digits are taken in one read, and a
+//	pass whose digit is the same for every key would not move anything, so with a few layers and textures only
+//	the low digits of the layer and the texture are ever sorted. The result ends up in the first two arrays.
+static void RadixSort(unsigned int* keys, unsigned int* indices, unsigned int* tempKeys, unsigned int* tempIndices, int count)
+{
+	int counts[4][256];
+	unsigned int* sourceKeys;
+	unsigned int* sourceIndices;
+	unsigned int* targetKeys;
+	unsigned int* targetIndices;
+	unsigned int* swapPtr;
+	unsigned int shift, digit;
+	int i, pass, offset, total;
+
+	if (count <= 1)
+	{
+		return;
+	}
+
+	memset(counts, 0, sizeof(counts));
+	for (i = 0; i < count; i++)
+	{
+		counts[0][keys[i] & 255]++;
+		counts[1][(keys[i] >> 8) & 255]++;
+		counts[2][(keys[i] >> 16) & 255]++;
+		counts[3][keys[i] >> 24]++;
+	}
+
+	sourceKeys = keys;
+	sourceIndices = indices;
+	targetKeys = tempKeys;
+	targetIndices = tempIndices;
+
+	for (pass = 0; pass < 4; pass++)
+	{
+		shift = (unsigned int)pass * 8;
+
+		if (counts[pass][(sourceKeys[0] >> shift) & 255] == count)
+		{
+			continue;
+		}
+
+//	Turn the counts into where every digit starts:
+		offset = 0;
+		for (digit = 0; digit < 256; digit++)
+		{
+			total = counts[pass][digit];
+			counts[pass][digit] = offset;
+			offset += total;
+		}
+
+		for (i = 0; i < count; i++)
+		{
+			digit = (sourceKeys[i] >> shift) & 255;
+			targetKeys[counts[pass][digit]] = sourceKeys[i];
+			targetIndices[counts[pass][digit]] = sourceIndices[i];
+			counts[pass][digit]++;
+		}
+
+		swapPtr = sourceKeys;
+		sourceKeys = targetKeys;
+		targetKeys = swapPtr;
+
+		swapPtr = sourceIndices;
+		sourceIndices = targetIndices;
+		targetIndices = swapPtr;
+	}
+
+	if (sourceKeys != keys)
+	{
+		memcpy(keys, sourceKeys, sizeof(unsigned int) * count);
+		memcpy(indices, sourceIndices, sizeof(unsigned int) * count);
+	}
+
+	return;
+}
+
+SpriteBatchClass::SpriteBatchClass()
+{
+	m_id = 0;
+	m_maxSprites = 0;
+	m_halfWidth = 0.0f;
+	m_halfHeight = 0.0f;
+	m_spriteCount = 0;
+	m_drawCount = 0;
+	m_droppedCount = 0;
+	m_ResourceRegistry = 0;
+	m_instanceBuffer.id = 0;
+	m_spriteBuffer.id = 0;
+	m_sampleState.id = 0;
+	m_ShaderManager = 0;
+	m_shaderFamily = -1;
+}
+
+SpriteBatchClass::SpriteBatchClass(const SpriteBatchClass& other)
+{
+
+}
+
+SpriteBatchClass::~SpriteBatchClass()
+{
+
+}
+
+//	Precompile compiles the sprite shaders ahead of Initialize, the same way the color shader does.
+void SpriteBatchClass::Precompile(ShaderManagerClass* shaderManager)
+{
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+
+	if (wcscpy_s(vsFilename, 128, L"./Source/sprite.vs") != 0 || wcscpy_s(psFilename, 128, L"./Source/sprite.ps") != 0)
+	{
+		return;
+	}
+
+	shaderManager->Precompile(vsFilename, "SpriteVertexShader", psFilename, "SpritePixelShader", 0);
+
+	return;
+}
+
+bool SpriteBatchClass::Initialize(ID3D11Device* device, ResourceRegistryClass* resourceRegistry, ShaderManagerClass* shaderManager, int maxSprites,
+	int screenWidth, int screenHeight)
+{
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+	int error;
+
+	if (maxSprites <= 0)
+	{
+		return false;
+	}
+
+	m_id = g_nextBatchId++;
+	m_maxSprites = maxSprites;
+	m_halfWidth = (float)screenWidth * 0.5f;
+	m_halfHeight = (float)screenHeight * 0.5f;
+	m_ResourceRegistry = resourceRegistry;
+	m_ShaderManager = shaderManager;
+
+	m_sprites.resize(maxSprites);
+	m_keys.resize(maxSprites);
+	m_indices.resize(maxSprites);
+	m_sortKeys.resize(maxSprites);
+	m_sortIndices.resize(maxSprites);
+
+//	Set the filenames of the Vertex and Pixel Shader:
+	error = wcscpy_s(vsFilename, 128, L"./Source/sprite.vs");
+	if (error != 0)
+	{
+		return false;
+	}
+
+	error = wcscpy_s(psFilename, 128, L"./Source/sprite.ps");
+	if (error != 0)
+	{
+		return false;
+	}
+
+	if (!InitializeShader(vsFilename, psFilename))
+	{
+		return false;
+	}
+
+	return InitializeBuffers(device);
+}
+
+void SpriteBatchClass::Shutdown()
+{
+	unsigned int i;
+
+	if (m_ResourceRegistry)
+	{
+		for (i = 0; i < m_textures.size(); i++)
+		{
+			m_ResourceRegistry->Release(m_shaderResourceViews[i]);
+			m_ResourceRegistry->Release(m_textures[i]);
+		}
+
+		m_ResourceRegistry->Release(m_instanceBuffer);
+		m_ResourceRegistry->Release(m_spriteBuffer);
+		m_ResourceRegistry->Release(m_sampleState);
+		m_ResourceRegistry = 0;
+	}
+
+	m_textures.clear();
+	m_shaderResourceViews.clear();
+
+//	The Shaders belong to the Shader Manager which releases them on its own Shutdown.
+	m_shaderFamily = -1;
+	m_ShaderManager = 0;
+
+//	The threads that drew into this batch still cache its id, which no other batch gets, so they won't use the
+//	buffers after they are gone:
+	{
+		lock_guard<mutex> lock(m_bufferMutex);
+
+		for (i = 0; i < m_threadBuffers.size(); i++)
+		{
+			delete m_threadBuffers[i];
+		}
+		m_threadBuffers.clear();
+	}
+
+	m_sprites.clear();
+	m_keys.clear();
+	m_indices.clear();
+	m_sortKeys.clear();
+	m_sortIndices.clear();
+
+	return;
+}
+
+//	AddTexture creates an immutable texture from the pixels, which are RGBA bytes packed into one unsigned
+//	int each, and registers it along with its view.
+int SpriteBatchClass::AddTexture(ID3D11Device* device, const unsigned int* pixels, int width, int height)
+{
+	D3D11_TEXTURE2D_DESC textureDesc;
+	D3D11_SUBRESOURCE_DATA textureData;
+	D3D11_SHADER_RESOURCE_VIEW_DESC shaderResourceViewDesc;
+	ID3D11Texture2D* texture;
+	ID3D11ShaderResourceView* shaderResourceView;
+	HRESULT result;
+
+	if ((int)m_textures.size() >= SPRITE_MAX_TEXTURES || width <= 0 || height <= 0)
+	{
+		return -1;
+	}
+
+	textureDesc.Width = width;
+	textureDesc.Height = height;
+	textureDesc.MipLevels = 1;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.MiscFlags = 0;
+
+	textureData.pSysMem = pixels;
+	textureData.SysMemPitch = width * sizeof(unsigned int);
+	textureData.SysMemSlicePitch = 0;
+
+	result = device->CreateTexture2D(&textureDesc, &textureData, &texture);
+	if (FAILED(result))
+	{
+		return -1;
+	}
+
+	shaderResourceViewDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	shaderResourceViewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+	shaderResourceViewDesc.Texture2D.MostDetailedMip = 0;
+	shaderResourceViewDesc.Texture2D.MipLevels = 1;
+
+	result = device->CreateShaderResourceView(texture, &shaderResourceViewDesc, &shaderResourceView);
+	if (FAILED(result))
+	{
+		texture->Release();
+		return -1;
+	}
+
+	m_textures.push_back(m_ResourceRegistry->Register(texture));
+	m_shaderResourceViews.push_back(m_ResourceRegistry->Register(shaderResourceView));
+
+	return (int)m_textures.size() - 1;
+}
+
+//	Draw writes the sprite into the buffer of the calling thread with its sort key. Layers outside of what the
+//	key holds are clamped to the nearest one.
+bool SpriteBatchClass::Draw(int texture, int layer, XMFLOAT4 rectangle, XMFLOAT4 texRectangle, float rotation, XMFLOAT4 color)
+{
+	ThreadBufferType* buffer;
+	SpriteType sprite;
+
+	if (texture < 0 || texture >= (int)m_shaderResourceViews.size())
+	{
+		return false;
+	}
+
+	layer = (layer < 0) ? 0 : layer;
+	layer = (layer < SPRITE_MAX_LAYERS) ? layer : SPRITE_MAX_LAYERS - 1;
+
+	sprite.rectangle = rectangle;
+	sprite.texRectangle = texRectangle;
+	sprite.rotation = rotation;
+	PackedVector::XMStoreUByteN4(&sprite.color, XMLoadFloat4(&color));
+	sprite.key = ((unsigned int)layer << 16) | (unsigned int)texture;
+
+	buffer = GetThreadBuffer();
+	buffer->sprites.push_back(sprite);
+
+	return true;
+}
+
+//	Clear drops the sprites drawn so far without flushing them.
+void SpriteBatchClass::Clear()
+{
+	unsigned int i;
+
+	lock_guard<mutex> lock(m_bufferMutex);
+
+	for (i = 0; i < m_threadBuffers.size(); i++)
+	{
+		m_threadBuffers[i]->sprites.clear();
+	}
+
+	return;
+}
+
+//	Flush draws the sprites of every thread with the orthographic matrix of the screen and clears them for the
+//	next frame. The instances go into the dynamic instance buffer in the sorted order, so every run of sprites
+//	with the same texture is a range of it. Runs on different layers with the same texture are one run, since
+//	nothing is drawn between them. The caller turns on blending and turns off the depth test around it.
+bool SpriteBatchClass::Flush(ID3D11DeviceContext* deviceContext, XMMATRIX orthoMatrix)
+{
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	SpriteBufferType* dataPtr;
+	ID3D11Buffer* instanceBuffer;
+	ID3D11Buffer* spriteBuffer;
+	ID3D11SamplerState* sampleState;
+	ID3D11ShaderResourceView* shaderResourceView;
+	unsigned int stride, offset;
+	HRESULT result;
+	int count, start, i;
+
+	m_drawCount = 0;
+	m_droppedCount = 0;
+
+	count = MergeThreadBuffers();
+	m_spriteCount = count;
+	if (count == 0)
+	{
+		return true;
+	}
+
+	SortSprites(count);
+
+	instanceBuffer = m_ResourceRegistry->Get(m_instanceBuffer);
+	spriteBuffer = m_ResourceRegistry->Get(m_spriteBuffer);
+	sampleState = m_ResourceRegistry->Get(m_sampleState);
+
+	result = deviceContext->Map(instanceBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	PackInstances((SpriteInstanceType*)mappedResource.pData, count);
+
+	deviceContext->Unmap(instanceBuffer, 0);
+
+	result = deviceContext->Map(spriteBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	dataPtr = (SpriteBufferType*)mappedResource.pData;
+	dataPtr->ortho = XMMatrixTranspose(orthoMatrix);
+
+	deviceContext->Unmap(spriteBuffer, 0);
+
+	if (!m_ShaderManager->SetShader(deviceContext, m_shaderFamily, 0))
+	{
+		return false;
+	}
+
+//	The corners come from the vertex id, so only the instances are bound:
+	stride = sizeof(SpriteInstanceType);
+	offset = 0;
+
+	deviceContext->IASetVertexBuffers(1, 1, &instanceBuffer, &stride, &offset);
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+	deviceContext->VSSetConstantBuffers(0, 1, &spriteBuffer);
+	deviceContext->PSSetSamplers(0, 1, &sampleState);
+
+	start = 0;
+	for (i = 1; i <= count; i++)
+	{
+		if (i < count && (m_keys[i] & SPRITE_TEXTURE_MASK) == (m_keys[start] & SPRITE_TEXTURE_MASK))
+		{
+			continue;
+		}
+
+		shaderResourceView = m_ResourceRegistry->Get(m_shaderResourceViews[m_keys[start] & SPRITE_TEXTURE_MASK]);
+		deviceContext->PSSetShaderResources(0, 1, &shaderResourceView);
+
+		deviceContext->DrawInstanced(4, i - start, 0, start);
+		m_drawCount++;
+
+		start = i;
+	}
+
+	return true;
+}
+
+//	The sprites, draws and dropped sprites of the last Flush.
+int SpriteBatchClass::GetSpriteCount()
+{
+	return m_spriteCount;
+}
+
+int SpriteBatchClass::GetDrawCount()
+{
+	return m_drawCount;
+}
+
+int SpriteBatchClass::GetDroppedCount()
+{
+	return m_droppedCount;
+}
+
+int SpriteBatchClass::GetThreadBufferCount()
+{
+	lock_guard<mutex> lock(m_bufferMutex);
+
+	return (int)m_threadBuffers.size();
+}
+
+bool SpriteBatchClass::InitializeShader(WCHAR* vsFilename, WCHAR* psFilename)
+{
+//	sprite.vs reads nothing but the instances and the vertex id, so there is no vertex format:
+	m_shaderFamily = m_ShaderManager->AddShader(vsFilename, "SpriteVertexShader", psFilename, "SpritePixelShader", 0, NULL, 0,
+		&SpriteInstanceType::GetFormat());
+	if (m_shaderFamily < 0)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+//	InitializeBuffers creates the dynamic instance buffer for the sprites of a frame, the constant buffer and
+//	the sampler. Sprites are scaled and turned, so the sampler filters linearly.
+bool SpriteBatchClass::InitializeBuffers(ID3D11Device* device)
+{
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_SAMPLER_DESC samplerDesc;
+	ID3D11Buffer* buffer;
+	ID3D11SamplerState* sampleState;
+	HRESULT result;
+
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = sizeof(SpriteInstanceType) * m_maxSprites;
+	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_instanceBuffer = m_ResourceRegistry->Register(buffer);
+
+	bufferDesc.ByteWidth = sizeof(SpriteBufferType);
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_spriteBuffer = m_ResourceRegistry->Register(buffer);
+
+	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
+	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.MipLODBias = 0.0f;
+	samplerDesc.MaxAnisotropy = 1;
+	samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+	samplerDesc.BorderColor[0] = 0.0f;
+	samplerDesc.BorderColor[1] = 0.0f;
+	samplerDesc.BorderColor[2] = 0.0f;
+	samplerDesc.BorderColor[3] = 0.0f;
+	samplerDesc.MinLOD = 0.0f;
+	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+
+	result = device->CreateSamplerState(&samplerDesc, &sampleState);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_sampleState = m_ResourceRegistry->Register(sampleState);
+
+	return true;
+}
+
+//	GetThreadBuffer returns the buffer of the calling thread from its thread local cache, and only looks it up,
+//	or adds it, under the lock when the thread last drew into another batch. Buffers stay until Shutdown, so
+//	the threads of the Job System find theirs again every frame.
+SpriteBatchClass::ThreadBufferType* SpriteBatchClass::GetThreadBuffer()
+{
+	ThreadBufferType* buffer;
+	thread::id owner;
+	unsigned int i;
+
+	if (g_threadBatchId == m_id)
+	{
+		return (ThreadBufferType*)g_threadBuffer;
+	}
+
+	owner = this_thread::get_id();
+	buffer = 0;
+
+	{
+		lock_guard<mutex> lock(m_bufferMutex);
+
+		for (i = 0; i < m_threadBuffers.size() && !buffer; i++)
+		{
+			if (m_threadBuffers[i]->owner == owner)
+			{
+				buffer = m_threadBuffers[i];
+			}
+		}
+
+		if (!buffer)
+		{
+			buffer = new ThreadBufferType;
+			buffer->owner = owner;
+			m_threadBuffers.push_back(buffer);
+		}
+	}
+
+	g_threadBatchId = m_id;
+	g_threadBuffer = buffer;
+
+	return buffer;
+}
+
+//	MergeThreadBuffers copies the sprites of every thread after one another and empties the buffers, which keep
+//	their memory for the next frame. What doesn't fit into the most sprites a frame draws is dropped.
+int SpriteBatchClass::MergeThreadBuffers()
+{
+	ThreadBufferType* buffer;
+	unsigned int i;
+	int count, taken;
+
+	lock_guard<mutex> lock(m_bufferMutex);
+
+	count = 0;
+	for (i = 0; i < m_threadBuffers.size(); i++)
+	{
+		buffer = m_threadBuffers[i];
+
+		taken = (int)buffer->sprites.size();
+		taken = (count + taken <= m_maxSprites) ? taken : m_maxSprites - count;
+
+		if (taken > 0)
+		{
+			memcpy(&m_sprites[count], buffer->sprites.data(), sizeof(SpriteType) * taken);
+		}
+
+		m_droppedCount += (int)buffer->sprites.size() - taken;
+		count += taken;
+
+		buffer->sprites.clear();
+	}
+
+	return count;
+}
+
+//	SortSprites sorts the indices of the merged sprites by their keys, which leaves the sorted keys in m_keys
+//	for Flush to find the runs in.
+void SpriteBatchClass::SortSprites(int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		m_keys[i] = m_sprites[i].key;
+		m_indices[i] = (unsigned int)i;
+	}
+
+	RadixSort(m_keys.data(), m_indices.data(), m_sortKeys.data(), m_sortIndices.data(), count);
+
+	return;
+}
+
+//	PackInstances writes the instances of the sorted sprites, four at a time so one XMVectorSinCos turns all
+//	four rotations into the sine and cosine the vertex shader rotates the corners with. The rectangle becomes
+//	its center and half its size in one vector, with the center moved from the top left corner of the screen to
+//	the center the orthographic matrix has its origin in. The last group repeats its first sprite for the
+//	rotations it doesn't have.
+void SpriteBatchClass::PackInstances(SpriteInstanceType* instances, int count)
+{
+	const SpriteType* sprites[4];
+	SpriteInstanceType* instance;
+	XMFLOAT4A sines, cosines;
+	XMVECTOR half, flip, origin, rotations, sineVector, cosineVector, rectangle, size, center;
+	int i, j, group;
+
+	half = XMVectorReplicate(0.5f);
+	flip = XMVectorSet(1.0f, -1.0f, 0.0f, 0.0f);
+	origin = XMVectorSet(-m_halfWidth, m_halfHeight, 0.0f, 0.0f);
+
+	for (i = 0; i < count; i += 4)
+	{
+		group = (count - i < 4) ? count - i : 4;
+
+		for (j = 0; j < 4; j++)
+		{
+			sprites[j] = &m_sprites[m_indices[i + ((j < group) ? j : 0)]];
+		}
+
+		rotations = XMVectorSet(sprites[0]->rotation, sprites[1]->rotation, sprites[2]->rotation, sprites[3]->rotation);
+		XMVectorSinCos(&sineVector, &cosineVector, rotations);
+		XMStoreFloat4A(&sines, sineVector);
+		XMStoreFloat4A(&cosines, cosineVector);
+
+		for (j = 0; j < group; j++)
+		{
+			instance = &instances[i + j];
+
+			rectangle = XMLoadFloat4(&sprites[j]->rectangle);
+			size = XMVectorMultiply(XMVectorSwizzle<2, 3, 2, 3>(rectangle), half);
+			center = XMVectorMultiplyAdd(XMVectorAdd(rectangle, size), flip, origin);
+
+			XMStoreFloat4(&instance->rectangle, XMVectorPermute<0, 1, 6, 7>(center, size));
+			instance->tex = sprites[j]->texRectangle;
+			instance->rotation = XMFLOAT2((&sines.x)[j], (&cosines.x)[j]);
+			instance->color = sprites[j]->color;
+		}
+	}
+
+	return;
+}
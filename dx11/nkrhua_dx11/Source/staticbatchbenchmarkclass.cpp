@@ -0,0 +1,91 @@
+#include "../Headers/staticbatchbenchmarkclass.h"
+
+#include <stdio.h>
+#include <chrono>
+
+bool StaticBatchBenchmarkClass::Run(D3DClass* direct3D, ColorShaderClass* colorShader, GeometryHeapClass* geometryHeap, ModelClass* model,
+	XMMATRIX viewMatrix, int objectCount, const char* report, const function<bool(StaticBatchClass*, XMMATRIX, XMMATRIX)>& renderBatch)
+{
+	StaticBatchClass staticBatch;
+	vector<XMFLOAT4X4> worlds;
+	XMMATRIX worldMatrix, projectionMatrix;
+	chrono::high_resolution_clock::time_point startTime;
+	ID3D11DeviceContext* deviceContext;
+	FILE* reportPtr;
+	float time, objectTime, batchTime;
+	unsigned int seed;
+	int i, pass, mesh;
+	bool result;
+
+	seed = 7;
+	auto random = [&seed]()
+	{
+		seed = seed * 1664525 + 1013904223;
+		return (float)(seed >> 8) / 16777216.0f;
+	};
+
+	deviceContext = direct3D->GetDeviceContext();
+
+	mesh = staticBatch.AddMesh(model->GetVertices(), model->GetVertexCount(), model->GetIndices(), model->GetIndexCount());
+
+	worlds.resize(objectCount);
+	for (i = 0; i < objectCount; i++)
+	{
+		worldMatrix = XMMatrixScaling(0.5f + random(), 0.5f + random(), 1.0f);
+		worldMatrix = XMMatrixMultiply(worldMatrix, XMMatrixRotationY(6.0f * random()));
+		worldMatrix = XMMatrixMultiply(worldMatrix, XMMatrixTranslation(400.0f * random() - 200.0f, 100.0f * random() - 50.0f, 5.0f + 300.0f * random()));
+		XMStoreFloat4x4(&worlds[i], worldMatrix);
+
+		staticBatch.AddInstance(mesh, i % 16, worldMatrix);
+	}
+
+	result = staticBatch.Build(direct3D->GetDevice(), direct3D->GetResourceRegistry());
+	if (!result)
+	{
+		staticBatch.Shutdown();
+		return false;
+	}
+
+//	Draw both ways a few times and keep the fastest, so the first pass warming up the driver doesn't count.
+	direct3D->GetProjectionMatrix(projectionMatrix);
+
+	objectTime = 1.0e9f;
+	batchTime = 1.0e9f;
+	for (pass = 0; pass < 4 && result; pass++)
+	{
+		startTime = chrono::high_resolution_clock::now();
+		geometryHeap->Render(deviceContext);
+		for (i = 0; i < objectCount && result; i++)
+		{
+			result = colorShader->Render(deviceContext, model->GetIndexCount(), model->GetStartIndex(), model->GetBaseVertex(),
+				XMLoadFloat4x4(&worlds[i]), viewMatrix, projectionMatrix);
+		}
+		deviceContext->Flush();
+		time = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+		objectTime = (time < objectTime) ? time : objectTime;
+
+		startTime = chrono::high_resolution_clock::now();
+		result = result && renderBatch(&staticBatch, viewMatrix, projectionMatrix);
+		deviceContext->Flush();
+		time = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+		batchTime = (time < batchTime) ? time : batchTime;
+	}
+
+	if (!result)
+	{
+		staticBatch.Shutdown();
+		return false;
+	}
+
+	if (fopen_s(&reportPtr, report, "a") == 0)
+	{
+		fprintf(reportPtr, "%d objects: one by one %d draws in %.3f ms; batched into %d batches of %d ranges, %d ranges visible, %d draws in %.3f ms\n",
+			objectCount, objectCount, objectTime, staticBatch.GetBatchCount(), staticBatch.GetRangeCount(),
+			staticBatch.GetVisibleRangeCount(), staticBatch.GetDrawCount(), batchTime);
+		fclose(reportPtr);
+	}
+
+	staticBatch.Shutdown();
+
+	return true;
+}
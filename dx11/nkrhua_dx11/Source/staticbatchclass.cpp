@@ -0,0 +1,449 @@
+#include "../Headers/staticbatchclass.h"
+
+#include <float.h>
+#include <algorithm>
+
+//	The bits a Morton code gives each axis of where an instance is in the box around all of them.
+static const int STATIC_BATCH_ORDER_BITS = 10;
+
+//	SpreadBits puts two zero bits between each of the low ten bits of a value, so three of them can be
+//	interleaved into a Morton code.
+static unsigned int SpreadBits(unsigned int value)
+{
+	value &= 0x3FF;
+	value = (value | (value << 16)) & 0x030000FF;
+	value = (value | (value << 8)) & 0x0300F00F;
+	value = (value | (value << 4)) & 0x030C30C3;
+	value = (value | (value << 2)) & 0x09249249;
+
+	return value;
+}
+
+StaticBatchClass::StaticBatchClass()
+{
+	m_instanceCount = 0;
+	m_visibleRangeCount = 0;
+	m_vertexCount = 0;
+	m_indexCount = 0;
+	m_ResourceRegistry = 0;
+	m_vertexBuffer.id = 0;
+	m_indexBuffer.id = 0;
+}
+
+StaticBatchClass::StaticBatchClass(const StaticBatchClass& other)
+{
+
+}
+
+StaticBatchClass::~StaticBatchClass()
+{
+
+}
+
+int StaticBatchClass::AddMesh(const VertexType* vertices, int vertexCount, const unsigned long* indices, int indexCount)
+{
+	MeshType mesh;
+
+	mesh.firstVertex = (int)m_meshVertices.size();
+	mesh.vertexCount = vertexCount;
+	mesh.firstIndex = (int)m_meshIndices.size();
+	mesh.indexCount = indexCount;
+
+	m_meshVertices.insert(m_meshVertices.end(), vertices, vertices + vertexCount);
+	m_meshIndices.insert(m_meshIndices.end(), indices, indices + indexCount);
+	m_meshes.push_back(mesh);
+
+	return (int)m_meshes.size() - 1;
+}
+
+void StaticBatchClass::AddInstance(int mesh, int material, XMMATRIX worldMatrix)
+{
+	InstanceType instance;
+
+	instance.mesh = mesh;
+	instance.material = material;
+	XMStoreFloat4x4(&instance.world, worldMatrix);
+	instance.order = 0;
+
+	m_instances.push_back(instance);
+
+	return;
+}
+
+//	Build sorts the instances by material and then by the Morton code of the center of their world box, so
+//	every material is one run of instances and each run goes through the world in small steps. A run becomes
+//	a batch, whose indices are relative to its first vertex, and a range is closed whenever the next instance
+//	would take it over STATIC_BATCH_RANGE_INDICES. An instance is never split between two ranges.
+bool StaticBatchClass::Build(ID3D11Device* device, ResourceRegistryClass* resourceRegistry)
+{
+	vector<VertexType> vertices;
+	vector<unsigned long> indices;
+	vector<XMFLOAT3> minimums, maximums;
+	vector<int> sorted;
+	XMVECTOR sceneMinimum, sceneMaximum, minimum, maximum, position, scale;
+	XMMATRIX worldMatrix;
+	XMFLOAT3 cell;
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_SUBRESOURCE_DATA bufferData;
+	ID3D11Buffer* buffer;
+	const MeshType* mesh;
+	BatchType batch;
+	RangeType range;
+	HRESULT result;
+	int i, j, k, batchVertex;
+
+	m_ResourceRegistry = resourceRegistry;
+	m_instanceCount = (int)m_instances.size();
+
+	for (i = 0; i < m_instanceCount; i++)
+	{
+		if (m_instances[i].mesh < 0 || m_instances[i].mesh >= (int)m_meshes.size())
+		{
+			return false;
+		}
+	}
+
+//	The world box of every instance, from its vertices moved into the world:
+	minimums.resize(m_instanceCount);
+	maximums.resize(m_instanceCount);
+	sceneMinimum = XMVectorReplicate(FLT_MAX);
+	sceneMaximum = XMVectorReplicate(-FLT_MAX);
+	for (i = 0; i < m_instanceCount; i++)
+	{
+		mesh = &m_meshes[m_instances[i].mesh];
+		worldMatrix = XMLoadFloat4x4(&m_instances[i].world);
+
+		minimum = XMVectorReplicate(FLT_MAX);
+		maximum = XMVectorReplicate(-FLT_MAX);
+		for (j = 0; j < mesh->vertexCount; j++)
+		{
+			position = XMVector3TransformCoord(XMLoadFloat3(&m_meshVertices[mesh->firstVertex + j].position), worldMatrix);
+			minimum = XMVectorMin(minimum, position);
+			maximum = XMVectorMax(maximum, position);
+		}
+
+		XMStoreFloat3(&minimums[i], minimum);
+		XMStoreFloat3(&maximums[i], maximum);
+
+		position = XMVectorScale(XMVectorAdd(minimum, maximum), 0.5f);
+		sceneMinimum = XMVectorMin(sceneMinimum, position);
+		sceneMaximum = XMVectorMax(sceneMaximum, position);
+	}
+
+//	Give every instance the Morton code of its center, then sort them:
+	scale = XMVectorDivide(XMVectorReplicate((float)((1 << STATIC_BATCH_ORDER_BITS) - 1)),
+		XMVectorMax(XMVectorSubtract(sceneMaximum, sceneMinimum), XMVectorReplicate(1.0e-6f)));
+	for (i = 0; i < m_instanceCount; i++)
+	{
+		position = XMVectorScale(XMVectorAdd(XMLoadFloat3(&minimums[i]), XMLoadFloat3(&maximums[i])), 0.5f);
+		XMStoreFloat3(&cell, XMVectorMultiply(XMVectorSubtract(position, sceneMinimum), scale));
+		m_instances[i].order = SpreadBits((unsigned int)cell.x) | (SpreadBits((unsigned int)cell.y) << 1) | (SpreadBits((unsigned int)cell.z) << 2);
+	}
+
+	sorted.resize(m_instanceCount);
+	for (i = 0; i < m_instanceCount; i++)
+	{
+		sorted[i] = i;
+	}
+
+	sort(sorted.begin(), sorted.end(), [this](int a, int b)
+	{
+		if (m_instances[a].material != m_instances[b].material)
+		{
+			return m_instances[a].material < m_instances[b].material;
+		}
+
+		return m_instances[a].order < m_instances[b].order;
+	});
+
+//	Append the instances in that order, starting a batch at every new material and a range whenever the
+//	current one is full:
+	m_batches.clear();
+	m_ranges.clear();
+	batchVertex = 0;
+	for (k = 0; k < m_instanceCount; k++)
+	{
+		i = sorted[k];
+		mesh = &m_meshes[m_instances[i].mesh];
+		worldMatrix = XMLoadFloat4x4(&m_instances[i].world);
+
+		if (m_batches.empty() || m_batches.back().material != m_instances[i].material)
+		{
+			batch.material = m_instances[i].material;
+			batch.baseVertex = (int)vertices.size();
+			batch.firstRange = (int)m_ranges.size();
+			batch.rangeCount = 0;
+			batch.minimum = minimums[i];
+			batch.maximum = maximums[i];
+			m_batches.push_back(batch);
+
+			batchVertex = 0;
+		}
+
+		if (m_batches.back().rangeCount == 0 || m_ranges.back().indexCount + mesh->indexCount > STATIC_BATCH_RANGE_INDICES)
+		{
+			range.startIndex = (int)indices.size();
+			range.indexCount = 0;
+			range.minimum = minimums[i];
+			range.maximum = maximums[i];
+			m_ranges.push_back(range);
+
+			m_batches.back().rangeCount++;
+		}
+
+		for (j = 0; j < mesh->vertexCount; j++)
+		{
+			vertices.push_back(m_meshVertices[mesh->firstVertex + j]);
+			XMStoreFloat3(&vertices.back().position, XMVector3TransformCoord(XMLoadFloat3(&vertices.back().position), worldMatrix));
+		}
+
+		for (j = 0; j < mesh->indexCount; j++)
+		{
+			indices.push_back(m_meshIndices[mesh->firstIndex + j] + batchVertex);
+		}
+		batchVertex += mesh->vertexCount;
+
+		XMStoreFloat3(&m_ranges.back().minimum, XMVectorMin(XMLoadFloat3(&m_ranges.back().minimum), XMLoadFloat3(&minimums[i])));
+		XMStoreFloat3(&m_ranges.back().maximum, XMVectorMax(XMLoadFloat3(&m_ranges.back().maximum), XMLoadFloat3(&maximums[i])));
+		m_ranges.back().indexCount += mesh->indexCount;
+
+		XMStoreFloat3(&m_batches.back().minimum, XMVectorMin(XMLoadFloat3(&m_batches.back().minimum), XMLoadFloat3(&minimums[i])));
+		XMStoreFloat3(&m_batches.back().maximum, XMVectorMax(XMLoadFloat3(&m_batches.back().maximum), XMLoadFloat3(&maximums[i])));
+	}
+
+	m_vertexCount = (int)vertices.size();
+	m_indexCount = (int)indices.size();
+
+//	The copies of the meshes and the instances aren't needed any more:
+	vector<VertexType>().swap(m_meshVertices);
+	vector<unsigned long>().swap(m_meshIndices);
+	vector<MeshType>().swap(m_meshes);
+	vector<InstanceType>().swap(m_instances);
+
+//	With nothing to draw there are no buffers, since Direct3D can't create empty ones:
+	if (m_indexCount == 0)
+	{
+		return true;
+	}
+
+//	The batches never change, so both buffers are immutable and filled as they are created:
+	bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	bufferDesc.ByteWidth = sizeof(VertexType) * m_vertexCount;
+	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bufferDesc.CPUAccessFlags = 0;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	bufferData.pSysMem = vertices.data();
+	bufferData.SysMemPitch = 0;
+	bufferData.SysMemSlicePitch = 0;
+
+	result = device->CreateBuffer(&bufferDesc, &bufferData, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_vertexBuffer = m_ResourceRegistry->Register(buffer);
+
+	bufferDesc.ByteWidth = sizeof(unsigned long) * m_indexCount;
+	bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	bufferData.pSysMem = indices.data();
+
+	result = device->CreateBuffer(&bufferDesc, &bufferData, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_indexBuffer = m_ResourceRegistry->Register(buffer);
+
+	return true;
+}
+
+void StaticBatchClass::Shutdown()
+{
+	if (m_ResourceRegistry)
+	{
+		m_ResourceRegistry->Release(m_indexBuffer);
+		m_ResourceRegistry->Release(m_vertexBuffer);
+		m_ResourceRegistry = 0;
+	}
+
+	m_batches.clear();
+	m_ranges.clear();
+	m_draws.clear();
+
+	return;
+}
+
+//	Cull fills the draws for the view and projection given and returns how many there are. The frustum planes
+//	are taken from the view projection matrix the same way the terrain takes them.
+int StaticBatchClass::Cull(XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+{
+	XMMATRIX planes;
+	XMVECTOR frustumPlanes[6];
+	int i, j, test, first;
+
+	planes = XMMatrixTranspose(XMMatrixMultiply(viewMatrix, projectionMatrix));
+	frustumPlanes[0] = XMVectorAdd(planes.r[3], planes.r[0]);
+	frustumPlanes[1] = XMVectorSubtract(planes.r[3], planes.r[0]);
+	frustumPlanes[2] = XMVectorAdd(planes.r[3], planes.r[1]);
+	frustumPlanes[3] = XMVectorSubtract(planes.r[3], planes.r[1]);
+	frustumPlanes[4] = planes.r[2];
+	frustumPlanes[5] = XMVectorSubtract(planes.r[3], planes.r[2]);
+	for (i = 0; i < 6; i++)
+	{
+		frustumPlanes[i] = XMPlaneNormalize(frustumPlanes[i]);
+	}
+
+	m_draws.clear();
+	m_visibleRangeCount = 0;
+
+	for (i = 0; i < (int)m_batches.size(); i++)
+	{
+		test = TestBox(frustumPlanes, m_batches[i].minimum, m_batches[i].maximum);
+		if (test == 0)
+		{
+			continue;
+		}
+
+		if (test == 2)
+		{
+			AddDraw(m_batches[i], m_batches[i].firstRange, m_batches[i].rangeCount);
+			m_visibleRangeCount += m_batches[i].rangeCount;
+			continue;
+		}
+
+//	The batch crosses the edge of the view, so its ranges are tested and every run of visible ones is a draw:
+		first = -1;
+		for (j = m_batches[i].firstRange; j < m_batches[i].firstRange + m_batches[i].rangeCount; j++)
+		{
+			if (TestBox(frustumPlanes, m_ranges[j].minimum, m_ranges[j].maximum) != 0)
+			{
+				first = (first < 0) ? j : first;
+				m_visibleRangeCount++;
+			}
+			else if (first >= 0)
+			{
+				AddDraw(m_batches[i], first, j - first);
+				first = -1;
+			}
+		}
+
+		if (first >= 0)
+		{
+			AddDraw(m_batches[i], first, j - first);
+		}
+	}
+
+	return (int)m_draws.size();
+}
+
+//	Render puts both buffers on the pipeline, after which the draws are drawn with an identity world matrix.
+void StaticBatchClass::Render(ID3D11DeviceContext* deviceContext)
+{
+	ID3D11Buffer* vertexBuffer;
+	unsigned int stride;
+	unsigned int offset;
+
+	if (m_indexCount == 0)
+	{
+		return;
+	}
+
+	vertexBuffer = m_ResourceRegistry->Get(m_vertexBuffer);
+	stride = sizeof(VertexType);
+	offset = 0;
+
+	deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+	deviceContext->IASetIndexBuffer(m_ResourceRegistry->Get(m_indexBuffer), DXGI_FORMAT_R32_UINT, 0);
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	return;
+}
+
+int StaticBatchClass::GetDrawCount()
+{
+	return (int)m_draws.size();
+}
+
+const StaticBatchClass::DrawType* StaticBatchClass::GetDraws()
+{
+	return m_draws.data();
+}
+
+int StaticBatchClass::GetInstanceCount()
+{
+	return m_instanceCount;
+}
+
+int StaticBatchClass::GetBatchCount()
+{
+	return (int)m_batches.size();
+}
+
+int StaticBatchClass::GetRangeCount()
+{
+	return (int)m_ranges.size();
+}
+
+//	The number of ranges the draws of the last Cull cover.
+int StaticBatchClass::GetVisibleRangeCount()
+{
+	return m_visibleRangeCount;
+}
+
+int StaticBatchClass::GetVertexCount()
+{
+	return m_vertexCount;
+}
+
+int StaticBatchClass::GetIndexCount()
+{
+	return m_indexCount;
+}
+
+//	TestBox returns 0 for a box outside the frustum, 2 for a box inside it and 1 for a box crossing it. The
+//	corner furthest along a plane normal being behind it puts the box outside, and the nearest corner being
+//	behind it means the box crosses that plane.
+int StaticBatchClass::TestBox(const XMVECTOR* frustumPlanes, const XMFLOAT3& minimum, const XMFLOAT3& maximum)
+{
+	XMVECTOR boxMinimum, boxMaximum, select;
+	int i, test;
+
+	boxMinimum = XMLoadFloat3(&minimum);
+	boxMaximum = XMLoadFloat3(&maximum);
+
+	test = 2;
+	for (i = 0; i < 6; i++)
+	{
+		select = XMVectorGreaterOrEqual(frustumPlanes[i], XMVectorZero());
+		if (XMVectorGetX(XMPlaneDotCoord(frustumPlanes[i], XMVectorSelect(boxMinimum, boxMaximum, select))) < 0.0f)
+		{
+			return 0;
+		}
+
+		if (XMVectorGetX(XMPlaneDotCoord(frustumPlanes[i], XMVectorSelect(boxMaximum, boxMinimum, select))) < 0.0f)
+		{
+			test = 1;
+		}
+	}
+
+	return test;
+}
+
+//	AddDraw adds a draw of a run of ranges of a batch, which follow each other in the index buffer.
+void StaticBatchClass::AddDraw(const BatchType& batch, int firstRange, int rangeCount)
+{
+	DrawType draw;
+
+	draw.material = batch.material;
+	draw.startIndex = m_ranges[firstRange].startIndex;
+	draw.indexCount = m_ranges[firstRange + rangeCount - 1].startIndex + m_ranges[firstRange + rangeCount - 1].indexCount - draw.startIndex;
+	draw.baseVertex = batch.baseVertex;
+
+	m_draws.push_back(draw);
+
+	return;
+}
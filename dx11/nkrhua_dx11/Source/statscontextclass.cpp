@@ -0,0 +1,247 @@
+#include "../Headers/statscontextclass.h"
+
+StatsContextClass::StatsContextClass()
+{
+	m_RenderStats = 0;
+	m_topology = D3D11_PRIMITIVE_TOPOLOGY_UNDEFINED;
+}
+
+StatsContextClass::StatsContextClass(const StatsContextClass& other) : DeviceContextProxyClass()
+{
+
+}
+
+StatsContextClass::~StatsContextClass()
+{
+
+}
+
+//	Initialize starts from the topology the device context already has, so the first draws are counted right.
+void StatsContextClass::Initialize(ID3D11DeviceContext* deviceContext, RenderStatsClass* renderStats)
+{
+	SetDeviceContext(deviceContext);
+	m_RenderStats = renderStats;
+
+	m_deviceContext->IAGetPrimitiveTopology(&m_topology);
+
+	return;
+}
+
+void StatsContextClass::Shutdown()
+{
+	SetDeviceContext(0);
+	m_RenderStats = 0;
+
+	return;
+}
+
+void StatsContextClass::IASetInputLayout(ID3D11InputLayout* layout)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->IASetInputLayout(layout);
+}
+
+void StatsContextClass::IASetVertexBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers, const UINT* strides, const UINT* offsets)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->IASetVertexBuffers(startSlot, count, buffers, strides, offsets);
+}
+
+void StatsContextClass::IASetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->IASetIndexBuffer(buffer, format, offset);
+}
+
+void StatsContextClass::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	m_topology = topology;
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->IASetPrimitiveTopology(topology);
+}
+
+void StatsContextClass::VSSetShader(ID3D11VertexShader* shader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->VSSetShader(shader, classInstances, classInstanceCount);
+}
+
+void StatsContextClass::VSSetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->VSSetConstantBuffers(startSlot, count, buffers);
+}
+
+void StatsContextClass::VSSetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->VSSetShaderResources(startSlot, count, views);
+}
+
+void StatsContextClass::VSSetSamplers(UINT startSlot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->VSSetSamplers(startSlot, count, samplers);
+}
+
+void StatsContextClass::PSSetShader(ID3D11PixelShader* shader, ID3D11ClassInstance* const* classInstances, UINT classInstanceCount)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->PSSetShader(shader, classInstances, classInstanceCount);
+}
+
+void StatsContextClass::PSSetConstantBuffers(UINT startSlot, UINT count, ID3D11Buffer* const* buffers)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->PSSetConstantBuffers(startSlot, count, buffers);
+}
+
+void StatsContextClass::PSSetShaderResources(UINT startSlot, UINT count, ID3D11ShaderResourceView* const* views)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->PSSetShaderResources(startSlot, count, views);
+}
+
+void StatsContextClass::PSSetSamplers(UINT startSlot, UINT count, ID3D11SamplerState* const* samplers)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->PSSetSamplers(startSlot, count, samplers);
+}
+
+void StatsContextClass::OMSetRenderTargets(UINT count, ID3D11RenderTargetView* const* renderTargets, ID3D11DepthStencilView* depthStencilView)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->OMSetRenderTargets(count, renderTargets, depthStencilView);
+}
+
+void StatsContextClass::OMSetBlendState(ID3D11BlendState* state, const FLOAT blendFactor[4], UINT sampleMask)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->OMSetBlendState(state, blendFactor, sampleMask);
+}
+
+void StatsContextClass::OMSetDepthStencilState(ID3D11DepthStencilState* state, UINT stencilRef)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->OMSetDepthStencilState(state, stencilRef);
+}
+
+void StatsContextClass::RSSetState(ID3D11RasterizerState* state)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->RSSetState(state);
+}
+
+void StatsContextClass::RSSetViewports(UINT count, const D3D11_VIEWPORT* viewports)
+{
+	m_RenderStats->Add(STAT_STATE_BINDS, 1.0);
+	m_deviceContext->RSSetViewports(count, viewports);
+}
+
+HRESULT StatsContextClass::Map(ID3D11Resource* resource, UINT subresource, D3D11_MAP mapType, UINT mapFlags, D3D11_MAPPED_SUBRESOURCE* mappedResource)
+{
+	D3D11_RESOURCE_DIMENSION dimension;
+	D3D11_BUFFER_DESC bufferDesc;
+
+	m_RenderStats->Add(STAT_MAPS, 1.0);
+
+	if (mapType == D3D11_MAP_WRITE_DISCARD)
+	{
+		resource->GetType(&dimension);
+		if (dimension == D3D11_RESOURCE_DIMENSION_BUFFER)
+		{
+			((ID3D11Buffer*)resource)->GetDesc(&bufferDesc);
+			m_RenderStats->Add(STAT_UPLOAD_BYTES, bufferDesc.ByteWidth);
+		}
+	}
+
+	return m_deviceContext->Map(resource, subresource, mapType, mapFlags, mappedResource);
+}
+
+void StatsContextClass::Unmap(ID3D11Resource* resource, UINT subresource)
+{
+	m_RenderStats->Add(STAT_UNMAPS, 1.0);
+	m_deviceContext->Unmap(resource, subresource);
+}
+
+//	An update sends the box it is given, or the whole buffer or the whole mip level when there is none.
+void StatsContextClass::UpdateSubresource(ID3D11Resource* resource, UINT subresource, const D3D11_BOX* box, const void* data, UINT rowPitch, UINT depthPitch)
+{
+	D3D11_RESOURCE_DIMENSION dimension;
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_TEXTURE2D_DESC textureDesc;
+	unsigned int height;
+
+	resource->GetType(&dimension);
+	if (dimension == D3D11_RESOURCE_DIMENSION_BUFFER)
+	{
+		((ID3D11Buffer*)resource)->GetDesc(&bufferDesc);
+		m_RenderStats->Add(STAT_UPLOAD_BYTES, box ? box->right - box->left : bufferDesc.ByteWidth);
+	}
+	else if (dimension == D3D11_RESOURCE_DIMENSION_TEXTURE2D)
+	{
+		((ID3D11Texture2D*)resource)->GetDesc(&textureDesc);
+		height = textureDesc.Height >> (subresource % (textureDesc.MipLevels > 0 ? textureDesc.MipLevels : 1));
+		height = height > 0 ? height : 1;
+		m_RenderStats->Add(STAT_UPLOAD_BYTES, (double)rowPitch * (box ? box->bottom - box->top : height));
+	}
+
+	m_deviceContext->UpdateSubresource(resource, subresource, box, data, rowPitch, depthPitch);
+}
+
+void StatsContextClass::Draw(UINT vertexCount, UINT startVertex)
+{
+	CountDraw(vertexCount, 1);
+	m_deviceContext->Draw(vertexCount, startVertex);
+}
+
+void StatsContextClass::DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex)
+{
+	CountDraw(indexCount, 1);
+	m_deviceContext->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void StatsContextClass::DrawInstanced(UINT vertexCount, UINT instanceCount, UINT startVertex, UINT startInstance)
+{
+	CountDraw(vertexCount, instanceCount);
+	m_deviceContext->DrawInstanced(vertexCount, instanceCount, startVertex, startInstance);
+}
+
+void StatsContextClass::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	CountDraw(indexCount, instanceCount);
+	m_deviceContext->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+//	CountDraw counts a draw and the primitives the current topology makes of its vertices, for every instance.
+void StatsContextClass::CountDraw(UINT elementCount, UINT instanceCount)
+{
+	unsigned int primitives;
+
+	switch (m_topology)
+	{
+	case D3D11_PRIMITIVE_TOPOLOGY_POINTLIST:
+		primitives = elementCount;
+		break;
+	case D3D11_PRIMITIVE_TOPOLOGY_LINELIST:
+		primitives = elementCount / 2;
+		break;
+	case D3D11_PRIMITIVE_TOPOLOGY_LINESTRIP:
+		primitives = elementCount > 1 ? elementCount - 1 : 0;
+		break;
+	case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST:
+		primitives = elementCount / 3;
+		break;
+	case D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP:
+		primitives = elementCount > 2 ? elementCount - 2 : 0;
+		break;
+	default:
+		primitives = 0;
+		break;
+	}
+
+	m_RenderStats->Add(STAT_DRAWS, 1.0);
+	m_RenderStats->Add(STAT_PRIMITIVES, (double)primitives * instanceCount);
+
+	return;
+}
@@ -97,12 +97,20 @@ void SystemClass::Run()
 bool SystemClass::Frame()
 {
 	bool result;
+	int mouseX, mouseY;
 
 	if (m_Input->IsKeyDown(VK_SPACE))
 	{
 		return false;
 	}
 
+//	Pick what is under the mouse for as long as the left button is held:
+	if (m_Input->IsMouseButtonDown())
+	{
+		m_Input->GetMousePosition(mouseX, mouseY);
+		m_Application->Pick(mouseX, mouseY);
+	}
+
 	result = m_Application->Frame();
 	if (!result)
 	{
@@ -126,6 +134,22 @@ LRESULT CALLBACK SystemClass::MessageHandler(HWND hwnd, UINT umsg, WPARAM wparam
 		m_Input->KeyUp((unsigned int)wparam);
 		return 0;
 	}
+	case WM_MOUSEMOVE:
+	{
+		m_Input->MouseMove((int)(short)LOWORD(lparam), (int)(short)HIWORD(lparam));
+		return 0;
+	}
+	case WM_LBUTTONDOWN:
+	{
+		m_Input->MouseMove((int)(short)LOWORD(lparam), (int)(short)HIWORD(lparam));
+		m_Input->MouseButtonDown();
+		return 0;
+	}
+	case WM_LBUTTONUP:
+	{
+		m_Input->MouseButtonUp();
+		return 0;
+	}
 	default:
 	{
 		return DefWindowProc(hwnd, umsg, wparam, lparam);
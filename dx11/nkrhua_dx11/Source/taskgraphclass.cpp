@@ -0,0 +1,309 @@
+#include "../Headers/taskgraphclass.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+//	The number of characters the bars of the timeline are drawn with.
+static const int TIMELINE_WIDTH = 60;
+
+TaskGraphClass::TaskGraphClass()
+{
+	m_threadCount = 0;
+	m_runningCount = 0;
+	m_failedTask = -1;
+	m_totalTime = 0.0f;
+}
+
+TaskGraphClass::TaskGraphClass(const TaskGraphClass& other)
+{
+
+}
+
+TaskGraphClass::~TaskGraphClass()
+{
+
+}
+
+//	There is always at least one worker, otherwise a graph with worker tasks could never finish.
+bool TaskGraphClass::Initialize(int threadCount)
+{
+	if (threadCount <= 0)
+	{
+		threadCount = (int)thread::hardware_concurrency() - 1;
+	}
+
+	m_threadCount = (threadCount > 1) ? threadCount : 1;
+
+	return true;
+}
+
+void TaskGraphClass::Shutdown()
+{
+	m_tasks.clear();
+	m_mainQueue.clear();
+	m_workerQueue.clear();
+
+	return;
+}
+
+int TaskGraphClass::AddTask(const char* name, const wchar_t* error, bool mainThread, const function<bool()>& work)
+{
+	TaskType task;
+
+	task.name = name;
+	task.error = error;
+	task.work = work;
+	task.mainThread = mainThread;
+	task.waitingCount = 0;
+	task.thread = -1;
+	task.startTime = 0.0f;
+	task.endTime = 0.0f;
+	task.finished = false;
+
+	m_tasks.push_back(task);
+
+	return (int)m_tasks.size() - 1;
+}
+
+bool TaskGraphClass::AddDependency(int task, int dependency)
+{
+	if (task < 0 || task >= (int)m_tasks.size() || dependency < 0 || dependency >= task)
+	{
+		return false;
+	}
+
+	m_tasks[task].dependencies.push_back(dependency);
+	m_tasks[task].waitingCount++;
+	m_tasks[dependency].dependents.push_back(task);
+
+	return true;
+}
+
+//	Run queues the tasks that depend on nothing, starts the workers and works through the main thread tasks
+//	itself until every task has finished or one has failed. The workers only live as long as the graph runs.
+bool TaskGraphClass::Run()
+{
+	vector<thread> threads;
+	int i;
+
+	m_startTime = chrono::high_resolution_clock::now();
+	m_runningCount = 0;
+	m_failedTask = -1;
+
+	for (i = 0; i < (int)m_tasks.size(); i++)
+	{
+		if (m_tasks[i].waitingCount == 0)
+		{
+			(m_tasks[i].mainThread ? m_mainQueue : m_workerQueue).push_back(i);
+		}
+	}
+
+	for (i = 0; i < m_threadCount; i++)
+	{
+		threads.push_back(thread(&TaskGraphClass::RunTasks, this, false, i + 1));
+	}
+
+	RunTasks(true, 0);
+
+	for (i = 0; i < (int)threads.size(); i++)
+	{
+		threads[i].join();
+	}
+
+	m_totalTime = GetElapsedTime();
+
+	return m_failedTask < 0;
+}
+
+const wchar_t* TaskGraphClass::GetError()
+{
+	return (m_failedTask >= 0) ? m_tasks[m_failedTask].error : 0;
+}
+
+int TaskGraphClass::GetThreadCount()
+{
+	return m_threadCount + 1;
+}
+
+float TaskGraphClass::GetTotalTime()
+{
+	return m_totalTime;
+}
+
+//	WriteTimeline appends a line for every task that ran, in the order they started, with a bar showing where
+//	it ran within the whole startup. Thread 0 is the main thread. The critical path is followed back from the
+//	task that finished last through whichever of its dependencies finished last.
+bool TaskGraphClass::WriteTimeline(const char* filename)
+{
+	vector<int> order;
+	char bar[TIMELINE_WIDTH + 1];
+	FILE* filePtr;
+	float scale;
+	int i, j, task, next, first, last;
+
+	if (fopen_s(&filePtr, filename, "a") != 0)
+	{
+		return false;
+	}
+
+	fprintf(filePtr, "Startup on %d threads took %.3f ms%s\n", GetThreadCount(), m_totalTime,
+		(m_failedTask >= 0) ? ", stopped by a failed task" : "");
+	fprintf(filePtr, "     start        end   thread  task\n");
+
+	for (i = 0; i < (int)m_tasks.size(); i++)
+	{
+		if (m_tasks[i].finished)
+		{
+			order.push_back(i);
+		}
+	}
+
+	sort(order.begin(), order.end(), [this](int a, int b) { return m_tasks[a].startTime < m_tasks[b].startTime; });
+
+	scale = (m_totalTime > 0.0f) ? (float)TIMELINE_WIDTH / m_totalTime : 0.0f;
+	for (i = 0; i < (int)order.size(); i++)
+	{
+		task = order[i];
+
+		first = (int)(m_tasks[task].startTime * scale);
+		last = (int)(m_tasks[task].endTime * scale);
+		first = (first < TIMELINE_WIDTH - 1) ? first : TIMELINE_WIDTH - 1;
+		last = (last > first) ? last : first;
+		last = (last < TIMELINE_WIDTH - 1) ? last : TIMELINE_WIDTH - 1;
+		for (j = 0; j < TIMELINE_WIDTH; j++)
+		{
+			bar[j] = (j >= first && j <= last) ? '#' : '.';
+		}
+		bar[TIMELINE_WIDTH] = 0;
+
+		fprintf(filePtr, "%10.3f %10.3f   %6d  %-24s |%s|%s\n", m_tasks[task].startTime, m_tasks[task].endTime, m_tasks[task].thread,
+			m_tasks[task].name, bar, (task == m_failedTask) ? " failed" : "");
+	}
+
+//	Follow the critical path back from the last task to finish:
+	task = -1;
+	for (i = 0; i < (int)order.size(); i++)
+	{
+		if (task < 0 || m_tasks[order[i]].endTime > m_tasks[task].endTime)
+		{
+			task = order[i];
+		}
+	}
+
+	fprintf(filePtr, "critical path, from the end:");
+	while (task >= 0)
+	{
+		fprintf(filePtr, " %s %.3f ms", m_tasks[task].name, m_tasks[task].endTime - m_tasks[task].startTime);
+
+		next = -1;
+		for (i = 0; i < (int)m_tasks[task].dependencies.size(); i++)
+		{
+			j = m_tasks[task].dependencies[i];
+			if (m_tasks[j].finished && (next < 0 || m_tasks[j].endTime > m_tasks[next].endTime))
+			{
+				next = j;
+			}
+		}
+
+		task = next;
+		if (task >= 0)
+		{
+			fprintf(filePtr, " <");
+		}
+	}
+	fprintf(filePtr, "\n");
+
+	fclose(filePtr);
+
+	return true;
+}
+
+//	WriteFirstFrame appends how long after the start of startup the first frame was presented, below the
+//	timeline. It is static, since the graph has been shut down by the time there is a frame.
+bool TaskGraphClass::WriteFirstFrame(const char* filename, float time)
+{
+	FILE* filePtr;
+
+	if (fopen_s(&filePtr, filename, "a") != 0)
+	{
+		return false;
+	}
+
+	fprintf(filePtr, "first frame presented after %.3f ms\n\n", time);
+	fclose(filePtr);
+
+	return true;
+}
+
+//	RunTasks keeps taking the next ready task of its kind until nothing is running and nothing is queued,
+//	which is when the graph is done. Finishing a task queues every dependent that was only waiting on it,
+//	unless a task has failed, in which case everything still queued is dropped.
+void TaskGraphClass::RunTasks(bool mainThread, int threadIndex)
+{
+	deque<int>* queue;
+	TaskType* task;
+	int index, i;
+	bool result;
+
+	queue = mainThread ? &m_mainQueue : &m_workerQueue;
+
+	unique_lock<mutex> lock(m_mutex);
+	while (true)
+	{
+		m_condition.wait(lock, [this, queue]
+		{
+			return !queue->empty() || (m_runningCount == 0 && m_mainQueue.empty() && m_workerQueue.empty());
+		});
+
+		if (queue->empty())
+		{
+			break;
+		}
+
+		index = queue->front();
+		queue->pop_front();
+		m_runningCount++;
+
+		task = &m_tasks[index];
+		task->thread = threadIndex;
+		task->startTime = GetElapsedTime();
+
+		lock.unlock();
+		result = task->work();
+		lock.lock();
+
+		task->endTime = GetElapsedTime();
+		task->finished = true;
+		m_runningCount--;
+
+		if (!result)
+		{
+			if (m_failedTask < 0)
+			{
+				m_failedTask = index;
+			}
+
+			m_mainQueue.clear();
+			m_workerQueue.clear();
+		}
+		else if (m_failedTask < 0)
+		{
+			for (i = 0; i < (int)task->dependents.size(); i++)
+			{
+				if (--m_tasks[task->dependents[i]].waitingCount == 0)
+				{
+					(m_tasks[task->dependents[i]].mainThread ? m_mainQueue : m_workerQueue).push_back(task->dependents[i]);
+				}
+			}
+		}
+
+		m_condition.notify_all();
+	}
+
+	return;
+}
+
+float TaskGraphClass::GetElapsedTime()
+{
+	return chrono::duration<float, milli>(chrono::high_resolution_clock::now() - m_startTime).count();
+}
@@ -0,0 +1,71 @@
+//  The terrain vertex shader draws one chunk of the terrain quadtree per draw call. The chunk vertices
+//  are already in world space, so there is no world matrix. Besides the matrices the constant buffer
+//  holds what the geomorph needs: the camera position, the error of the chunk's parent level scaled to
+//  pixels at a distance of one, and the screen space error the terrain is allowed to have.
+
+// Globals:
+cbuffer TerrainBuffer
+{
+    matrix viewMatrix;
+    matrix projectionMatrix;
+    float3 cameraPosition;
+    float parentError;
+    float errorThreshold;
+    float3 padding;
+};
+
+//  Every vertex carries two heights: its own, and the height it has in the parent level, which for the
+//  vertices the parent does not have is the average of the two neighbours it lies between. The layout
+//  is built from TerrainVertexType in vertexformatclass.h, which has to have every member of this structure.
+
+//  Typedefs:
+struct VertexInputType
+{
+    float3 position : POSITION;
+    float morphHeight : MORPHHEIGHT;
+    float4 color : COLOR;
+};
+
+//  The LIT permutation adds the view space position the lit pixel shader of color.ps needs.
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float4 color : COLOR;
+#ifdef LIT
+    float3 viewPosition : TEXCOORD1;
+#endif
+};
+
+//  A chunk replaces its parent once the screen space error of the parent level grows past the threshold,
+//  and is itself replaced by its children once its own error does, which is at twice the threshold or
+//  later because every level has at least twice the error of the level below. So the morph factor goes
+//  from one at the threshold, where the chunk looks exactly like its parent, to zero at twice the
+//  threshold, where it looks exactly like itself. The factor depends on the vertex position and not on the
+//  chunk, so where a chunk meets a coarser neighbour its parent error is below the threshold and it is
+//  already fully morphed into the shape of that neighbour.
+
+//  Vertex Shader:
+PixelInputType TerrainVertexShader(VertexInputType input)
+{
+    PixelInputType output;
+    float4 position;
+    float distance, morph;
+
+//  Work out how far the vertex is morphed towards the parent level.
+    distance = max(length(input.position - cameraPosition), 1.0f);
+    morph = saturate(2.0f - parentError / (distance * errorThreshold));
+
+    position = float4(input.position, 1.0f);
+    position.y = lerp(input.position.y, input.morphHeight, morph);
+
+//  Calculate the position of the vertex against the view and projection matrices.
+    output.position = mul(position, viewMatrix);
+#ifdef LIT
+    output.viewPosition = output.position.xyz;
+#endif
+    output.position = mul(output.position, projectionMatrix);
+
+    output.color = input.color;
+
+    return output;
+};
@@ -0,0 +1,98 @@
+//	The terrain benchmark flies a camera straight across the terrain at 60 frames a second without a window
+//	or a device, streaming and selecting chunks the way a frame of the scene does, and prints the time the
+//	terrain took and the state of its cache once a second. Flying over a terrain 16384 quads a side should
+//	show the memory staying the same and the time staying flat. The terrain file is generated first when it
+//	does not exist yet. It is not part of the engine's project and is built on its own, for example from a
+//	developer command prompt with:
+//	cl /O2 /EHsc Source\terrainbenchmarkmain.cpp Source\terrainclass.cpp Source\terrainshaderclass.cpp
+//	    Source\shadermanagerclass.cpp Source\commandcaptureclass.cpp Source\devicecontextproxyclass.cpp
+//	    Source\jobsystemclass.cpp d3d11.lib d3dcompiler.lib
+//	and run as: terrainbenchmark [file] [size] [speed] [frames]
+#include "../Headers/terrainclass.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+
+//	The camera of the scene: its height over the terrain, its field of view and the height of the screen
+//	the error threshold in pixels is measured on.
+static const float BENCHMARK_FLY_HEIGHT = 30.0f;
+static const int BENCHMARK_SCREEN_WIDTH = 1920;
+static const int BENCHMARK_SCREEN_HEIGHT = 1080;
+static const float BENCHMARK_SCREEN_DEPTH = 1000.0f;
+static const float BENCHMARK_SCREEN_NEAR = 0.3f;
+static const float BENCHMARK_ERROR_THRESHOLD = 2.0f;
+static const int BENCHMARK_REPORT_INTERVAL = 60;
+
+int main(int argc, char* argv[])
+{
+	JobSystemClass jobSystem;
+	TerrainClass terrain;
+	chrono::high_resolution_clock::time_point nextFrame;
+	XMMATRIX viewMatrix, projectionMatrix;
+	XMFLOAT3 position;
+	const char* filename;
+	double total;
+	float speed, distance, time, fastest, slowest;
+	int size, frameCount, i;
+
+	filename = argc > 1 ? argv[1] : "terrain.dat";
+	size = argc > 2 ? atoi(argv[2]) : 4096;
+	speed = argc > 3 ? (float)atof(argv[3]) : 100.0f;
+	frameCount = argc > 4 ? atoi(argv[4]) : 2400;
+	if (size < TERRAIN_CHUNK_SIZE || speed <= 0.0f || frameCount <= 0)
+	{
+		fprintf(stderr, "usage: %s [file] [size, at least %d] [speed] [frames]\n", argv[0], TERRAIN_CHUNK_SIZE);
+		return 1;
+	}
+
+	jobSystem.Initialize(0);
+
+	if (!terrain.Initialize(NULL, NULL, &jobSystem, filename, size, BENCHMARK_SCREEN_HEIGHT, BENCHMARK_ERROR_THRESHOLD))
+	{
+		fprintf(stderr, "Could not open or generate %s\n", filename);
+		return 1;
+	}
+
+	projectionMatrix = XMMatrixPerspectiveFovLH(XM_PIDIV4, (float)BENCHMARK_SCREEN_WIDTH / (float)BENCHMARK_SCREEN_HEIGHT, BENCHMARK_SCREEN_NEAR,
+		BENCHMARK_SCREEN_DEPTH);
+
+//	The loader thread works in real time, so the frames are paced like the ones of the scene to give it the
+//	same time to keep up:
+	distance = 0.0f;
+	fastest = 1.0e9f;
+	slowest = 0.0f;
+	total = 0.0;
+	nextFrame = chrono::high_resolution_clock::now();
+	for (i = 1; i <= frameCount; i++)
+	{
+		distance = fmodf(distance + speed / 60.0f, (float)size);
+		position = XMFLOAT3(0.0f, BENCHMARK_FLY_HEIGHT, -0.5f * (float)size + distance);
+		viewMatrix = XMMatrixLookToLH(XMLoadFloat3(&position), XMVectorSet(0.0f, -0.2f, 1.0f, 0.0f), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+
+		terrain.Frame(NULL, position, viewMatrix, projectionMatrix);
+
+		time = terrain.GetFrameTime();
+		fastest = time < fastest ? time : fastest;
+		slowest = time > slowest ? time : slowest;
+		total += time;
+
+		if (i % BENCHMARK_REPORT_INTERVAL == 0)
+		{
+			printf("frame %d: terrain %.3f ms, %d chunks drawn, %d resident, %d loading, %u KB\n", i, time, terrain.GetDrawnChunkCount(),
+				terrain.GetResidentChunkCount(), terrain.GetPendingChunkCount(), terrain.GetMemoryUsage() / 1024);
+		}
+
+		nextFrame += chrono::microseconds(1000000 / 60);
+		this_thread::sleep_until(nextFrame);
+	}
+
+	printf("%d frames over %d quads at %.0f units/s: terrain %.3f ms best, %.3f ms average, %.3f ms worst\n", frameCount, size, speed, fastest,
+		total / frameCount, slowest);
+
+	terrain.Shutdown();
+	jobSystem.Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,1054 @@
+#include "../Headers/terrainclass.h"
+
+#include <math.h>
+#include <string.h>
+#include <chrono>
+
+//	The look of the generated terrain: one heightmap sample per unit, heights between the base height
+//	and the base height plus the height scale.
+const float TERRAIN_SPACING = 1.0f;
+const float TERRAIN_BASE_HEIGHT = -50.0f;
+const float TERRAIN_HEIGHT_SCALE = 60.0f;
+const int TERRAIN_OCTAVES = 8;
+
+//	The parent error given to chunks of the coarsest level, which have no parent to morph into. It makes
+//	the morph factor zero everywhere.
+const float TERRAIN_NO_PARENT_ERROR = 1.0e30f;
+
+TerrainClass::TerrainClass()
+{
+	m_originX = 0.0f;
+	m_originZ = 0.0f;
+	m_screenHeight = 0;
+	m_pixelsPerUnit = 0.0f;
+	m_errorThreshold = 0.0f;
+	m_indexBuffer = 0;
+	m_indexCount = 0;
+	m_frameNumber = 0;
+	m_pendingCount = 0;
+	m_quit = false;
+	m_frameTime = 0.0f;
+}
+
+TerrainClass::TerrainClass(const TerrainClass& other)
+{
+
+}
+
+TerrainClass::~TerrainClass()
+{
+
+}
+
+//	Initialize opens the terrain file, or generates one of the given size first if there is none, and
+//	loads the coarsest levels before starting the loader thread. The error threshold is in pixels. Without a
+//	device the buffers on the video card are not created and Render must not be called, which leaves the
+//	streaming and the selection of chunks to be timed on their own.
+bool TerrainClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, JobSystemClass* jobSystem, const char* filename,
+	int size, int screenHeight, float errorThreshold)
+{
+	FILE* filePtr;
+	ChunkType* chunk;
+	int level, tiles, x, z, index;
+	bool result;
+
+	strncpy_s(m_filename, sizeof(m_filename), filename, _TRUNCATE);
+	m_screenHeight = screenHeight;
+	m_errorThreshold = errorThreshold;
+
+	result = ReadTerrainFile(m_filename);
+	if (!result)
+	{
+		result = CreateTerrainFile(jobSystem, m_filename, size);
+		if (!result)
+		{
+			return false;
+		}
+
+		result = ReadTerrainFile(m_filename);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+//	The terrain is centered on the origin:
+	m_originX = -0.5f * (float)m_header.size * m_header.spacing;
+	m_originZ = m_originX;
+
+	result = InitializeBuffers(device);
+	if (!result)
+	{
+		return false;
+	}
+
+//	Load the pinned levels right away, the coarsest level being a single chunk covering everything:
+	if (fopen_s(&filePtr, m_filename, "rb") != 0)
+	{
+		return false;
+	}
+
+	for (level = m_header.levelCount - 1; level >= 0 && level >= m_header.levelCount - TERRAIN_PINNED_LEVELS; level--)
+	{
+		tiles = (m_header.size / TERRAIN_CHUNK_SIZE) >> level;
+		for (z = 0; z < tiles; z++)
+		{
+			for (x = 0; x < tiles; x++)
+			{
+				index = AllocateChunk();
+				chunk = &m_chunks[index];
+				chunk->level = level;
+				chunk->x = x;
+				chunk->z = z;
+				chunk->pinned = true;
+
+				result = ReadTile(filePtr, chunk);
+				if (!result)
+				{
+					fclose(filePtr);
+					return false;
+				}
+
+				UploadChunk(deviceContext, index);
+				chunk->state = CHUNK_READY;
+				m_chunkMap[((unsigned long long)level << 48) | ((unsigned long long)z << 24) | (unsigned long long)x] = index;
+			}
+		}
+	}
+
+	fclose(filePtr);
+
+	m_quit = false;
+	m_loaderThread = thread(&TerrainClass::LoaderThread, this);
+
+	return true;
+}
+
+void TerrainClass::Shutdown()
+{
+//	Stop the loader thread, dropping whatever it had not read yet:
+	if (m_loaderThread.joinable())
+	{
+		{
+			lock_guard<mutex> lock(m_queueMutex);
+			m_quit = true;
+		}
+		m_queueCondition.notify_all();
+		m_loaderThread.join();
+	}
+
+	m_loadQueue.clear();
+	m_uploadQueue.clear();
+	m_pendingCount = 0;
+
+	ShutdownBuffers();
+
+	m_tileBounds.clear();
+	m_levelOffsets.clear();
+	m_levelTiles.clear();
+
+	return;
+}
+
+//	Frame copies the chunks the loader thread has finished to the video card and selects the chunks to
+//	draw for the camera. The pixels per unit at a distance of one come from the projection matrix, whose
+//	second row starts with the cotangent of half the vertical field of view.
+void TerrainClass::Frame(ID3D11DeviceContext* deviceContext, XMFLOAT3 cameraPosition, XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+{
+	chrono::high_resolution_clock::time_point startTime;
+	XMMATRIX planes;
+	int i, index, uploads;
+
+	startTime = chrono::high_resolution_clock::now();
+
+	m_frameNumber++;
+
+	for (uploads = 0; uploads < TERRAIN_UPLOADS_PER_FRAME; uploads++)
+	{
+		{
+			lock_guard<mutex> lock(m_queueMutex);
+			if (m_uploadQueue.empty())
+			{
+				break;
+			}
+
+			index = m_uploadQueue.front();
+			m_uploadQueue.pop_front();
+		}
+
+		m_pendingCount--;
+
+		UploadChunk(deviceContext, index);
+		m_chunks[index].state = CHUNK_READY;
+		m_chunks[index].lastUsedFrame = m_frameNumber;
+	}
+
+	m_cameraPosition = cameraPosition;
+	m_pixelsPerUnit = 0.5f * (float)m_screenHeight * XMVectorGetY(projectionMatrix.r[1]);
+
+//	The frustum planes are the sums and differences of the columns of the view projection matrix:
+	planes = XMMatrixTranspose(XMMatrixMultiply(viewMatrix, projectionMatrix));
+	m_frustumPlanes[0] = XMVectorAdd(planes.r[3], planes.r[0]);
+	m_frustumPlanes[1] = XMVectorSubtract(planes.r[3], planes.r[0]);
+	m_frustumPlanes[2] = XMVectorAdd(planes.r[3], planes.r[1]);
+	m_frustumPlanes[3] = XMVectorSubtract(planes.r[3], planes.r[1]);
+	m_frustumPlanes[4] = planes.r[2];
+	m_frustumPlanes[5] = XMVectorSubtract(planes.r[3], planes.r[2]);
+	for (i = 0; i < 6; i++)
+	{
+		m_frustumPlanes[i] = XMPlaneNormalize(m_frustumPlanes[i]);
+	}
+
+	m_drawList.clear();
+	SelectChunk(m_header.levelCount - 1, 0, 0);
+
+	m_frameTime = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+
+	return;
+}
+
+//	Render draws the chunks selected by the last Frame. They all use the shared index buffer, only the
+//	vertex buffer and the error of the parent level change from one chunk to the next.
+bool TerrainClass::Render(ID3D11DeviceContext* deviceContext, TerrainShaderClass* terrainShader, XMMATRIX viewMatrix, XMMATRIX projectionMatrix)
+{
+	ChunkType* chunk;
+	unsigned int stride, offset;
+	float parentError;
+	int i;
+	bool result;
+
+	terrainShader->SetParameters(viewMatrix, projectionMatrix, m_cameraPosition, m_errorThreshold);
+
+	stride = sizeof(VertexType);
+	offset = 0;
+
+	deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	for (i = 0; i < (int)m_drawList.size(); i++)
+	{
+		chunk = &m_chunks[m_drawList[i]];
+
+		if (chunk->level + 1 < m_header.levelCount)
+		{
+			parentError = m_header.levelErrors[chunk->level + 1] * m_pixelsPerUnit;
+		}
+		else
+		{
+			parentError = TERRAIN_NO_PARENT_ERROR;
+		}
+
+		deviceContext->IASetVertexBuffers(0, 1, &chunk->vertexBuffer, &stride, &offset);
+
+		result = terrainShader->Render(deviceContext, m_indexCount, parentError);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+float TerrainClass::GetErrorThreshold()
+{
+	return m_errorThreshold;
+}
+
+int TerrainClass::GetDrawnChunkCount()
+{
+	return (int)m_drawList.size();
+}
+
+int TerrainClass::GetResidentChunkCount()
+{
+	int i, count;
+
+	count = 0;
+	for (i = 0; i < (int)m_chunks.size(); i++)
+	{
+		if (m_chunks[i].state == CHUNK_READY)
+		{
+			count++;
+		}
+	}
+
+	return count;
+}
+
+int TerrainClass::GetPendingChunkCount()
+{
+	return m_pendingCount;
+}
+
+//	GetMemoryUsage returns the bytes held by the terrain on the video card and for loading, which is fixed
+//	by the cache size. Only the bounds of the tiles grow with the heightmap, by four bytes a tile.
+unsigned int TerrainClass::GetMemoryUsage()
+{
+	unsigned int chunkBytes;
+
+	chunkBytes = sizeof(VertexType) * TERRAIN_CHUNK_VERTICES * TERRAIN_CHUNK_VERTICES + sizeof(unsigned short) * TERRAIN_CHUNK_VERTICES * TERRAIN_CHUNK_VERTICES;
+
+	return (unsigned int)m_chunks.size() * chunkBytes + sizeof(unsigned long) * m_indexCount + sizeof(TileBoundsType) * (unsigned int)m_tileBounds.size();
+}
+
+float TerrainClass::GetFrameTime()
+{
+	return m_frameTime;
+}
+
+//	CreateTerrainFile generates a terrain of size by size quads and writes it level by level. Every level
+//	samples the same height function at every other point of the level below, one row of tiles at a time
+//	on the job threads, so generating even a very large terrain only needs memory for one row of tiles.
+//	The geometric error of a level is how far its surface can be from the full resolution surface. It is
+//	built up from how far the vertices of each level are from where they end up when morphed into the
+//	next level, and every level gets at least twice the error of the one below, which the morph in
+//	terrain.vs relies on.
+bool TerrainClass::CreateTerrainFile(JobSystemClass* jobSystem, const char* filename, int size)
+{
+	FileHeaderType header;
+	vector<TileBoundsType> bounds;
+	vector<unsigned short> rowHeights;
+	vector<int> rowDeltas;
+	FILE* filePtr;
+	int level, tiles, firstTile, z, x, maxDelta;
+	float delta;
+	size_t tileSamples;
+
+//	The size has to be the chunk size times a power of two:
+	if (size < TERRAIN_CHUNK_SIZE || (size & (size - 1)) != 0)
+	{
+		return false;
+	}
+
+	memcpy(header.magic, "TRN1", 4);
+	header.size = size;
+	header.levelCount = 1;
+	while ((TERRAIN_CHUNK_SIZE << (header.levelCount - 1)) < size)
+	{
+		header.levelCount++;
+	}
+	if (header.levelCount > TERRAIN_MAX_LEVELS)
+	{
+		return false;
+	}
+
+	header.spacing = TERRAIN_SPACING;
+	header.baseHeight = TERRAIN_BASE_HEIGHT;
+	header.heightScale = TERRAIN_HEIGHT_SCALE;
+	for (level = 0; level < TERRAIN_MAX_LEVELS; level++)
+	{
+		header.levelErrors[level] = 0.0f;
+	}
+
+	tiles = 0;
+	for (level = 0; level < header.levelCount; level++)
+	{
+		tiles += ((size / TERRAIN_CHUNK_SIZE) >> level) * ((size / TERRAIN_CHUNK_SIZE) >> level);
+	}
+	bounds.resize(tiles);
+
+	tileSamples = TERRAIN_CHUNK_VERTICES * TERRAIN_CHUNK_VERTICES;
+	rowHeights.resize((size / TERRAIN_CHUNK_SIZE) * tileSamples);
+	rowDeltas.resize(size / TERRAIN_CHUNK_SIZE);
+
+	if (fopen_s(&filePtr, filename, "wb") != 0)
+	{
+		return false;
+	}
+
+//	The header and bounds are written again at the end, once the errors and bounds are known:
+	if (fwrite(&header, sizeof(FileHeaderType), 1, filePtr) != 1 || fwrite(bounds.data(), sizeof(TileBoundsType), bounds.size(), filePtr) != bounds.size())
+	{
+		fclose(filePtr);
+		return false;
+	}
+
+	firstTile = 0;
+	for (level = 0; level < header.levelCount; level++)
+	{
+		tiles = (size / TERRAIN_CHUNK_SIZE) >> level;
+		maxDelta = 0;
+
+		for (z = 0; z < tiles; z++)
+		{
+			jobSystem->ParallelFor(tiles, 1, [&](int begin, int end)
+			{
+				unsigned short* heights;
+				int tile, i, j, height, morphHeight, minimum, maximum, tileDelta;
+
+				for (tile = begin; tile < end; tile++)
+				{
+					heights = &rowHeights[tile * tileSamples];
+					minimum = 65535;
+					maximum = 0;
+
+					for (j = 0; j < TERRAIN_CHUNK_VERTICES; j++)
+					{
+						for (i = 0; i < TERRAIN_CHUNK_VERTICES; i++)
+						{
+							height = (int)(GenerateHeight((tile * TERRAIN_CHUNK_SIZE + i) << level, (z * TERRAIN_CHUNK_SIZE + j) << level) * 65535.0f + 0.5f);
+							height = (height < 0) ? 0 : (height > 65535) ? 65535 : height;
+							heights[j * TERRAIN_CHUNK_VERTICES + i] = (unsigned short)height;
+
+							minimum = (height < minimum) ? height : minimum;
+							maximum = (height > maximum) ? height : maximum;
+						}
+					}
+
+//	Compare every vertex the next level does not have with the average of its neighbours there:
+					tileDelta = 0;
+					for (j = 0; j < TERRAIN_CHUNK_VERTICES; j++)
+					{
+						for (i = 0; i < TERRAIN_CHUNK_VERTICES; i++)
+						{
+							if (i % 2 == 1 && j % 2 == 1)
+							{
+								morphHeight = (heights[(j - 1) * TERRAIN_CHUNK_VERTICES + i - 1] + heights[(j + 1) * TERRAIN_CHUNK_VERTICES + i + 1]) / 2;
+							}
+							else if (i % 2 == 1)
+							{
+								morphHeight = (heights[j * TERRAIN_CHUNK_VERTICES + i - 1] + heights[j * TERRAIN_CHUNK_VERTICES + i + 1]) / 2;
+							}
+							else if (j % 2 == 1)
+							{
+								morphHeight = (heights[(j - 1) * TERRAIN_CHUNK_VERTICES + i] + heights[(j + 1) * TERRAIN_CHUNK_VERTICES + i]) / 2;
+							}
+							else
+							{
+								continue;
+							}
+
+							height = abs((int)heights[j * TERRAIN_CHUNK_VERTICES + i] - morphHeight);
+							tileDelta = (height > tileDelta) ? height : tileDelta;
+						}
+					}
+
+					bounds[firstTile + z * tiles + tile].minimum = (unsigned short)minimum;
+					bounds[firstTile + z * tiles + tile].maximum = (unsigned short)maximum;
+					rowDeltas[tile] = tileDelta;
+				}
+			});
+
+			for (x = 0; x < tiles; x++)
+			{
+				maxDelta = (rowDeltas[x] > maxDelta) ? rowDeltas[x] : maxDelta;
+			}
+
+			if (fwrite(rowHeights.data(), sizeof(unsigned short), tiles * tileSamples, filePtr) != tiles * tileSamples)
+			{
+				fclose(filePtr);
+				return false;
+			}
+		}
+
+//	The deltas of this level make up the error of the next one:
+		if (level + 1 < header.levelCount)
+		{
+			delta = (float)maxDelta * header.heightScale / 65535.0f;
+			header.levelErrors[level + 1] = header.levelErrors[level] + delta;
+			if (header.levelErrors[level + 1] < 2.0f * header.levelErrors[level])
+			{
+				header.levelErrors[level + 1] = 2.0f * header.levelErrors[level];
+			}
+		}
+
+		firstTile += tiles * tiles;
+	}
+
+	if (fseek(filePtr, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(FileHeaderType), 1, filePtr) != 1 ||
+		fwrite(bounds.data(), sizeof(TileBoundsType), bounds.size(), filePtr) != bounds.size())
+	{
+		fclose(filePtr);
+		return false;
+	}
+
+	fclose(filePtr);
+
+	return true;
+}
+
+//	ReadTerrainFile reads the header and the tile bounds and works out where each level starts. The
+//	heights themselves are only read tile by tile when needed.
+bool TerrainClass::ReadTerrainFile(const char* filename)
+{
+	FILE* filePtr;
+	long long offset;
+	int level, tiles, totalTiles;
+	size_t count;
+
+	if (fopen_s(&filePtr, filename, "rb") != 0)
+	{
+		return false;
+	}
+
+	count = fread(&m_header, sizeof(FileHeaderType), 1, filePtr);
+	if (count != 1 || memcmp(m_header.magic, "TRN1", 4) != 0 || m_header.levelCount < 1 || m_header.levelCount > TERRAIN_MAX_LEVELS ||
+		m_header.size != (TERRAIN_CHUNK_SIZE << (m_header.levelCount - 1)))
+	{
+		fclose(filePtr);
+		return false;
+	}
+
+	m_levelTiles.resize(m_header.levelCount);
+	totalTiles = 0;
+	for (level = 0; level < m_header.levelCount; level++)
+	{
+		tiles = (m_header.size / TERRAIN_CHUNK_SIZE) >> level;
+		m_levelTiles[level] = totalTiles;
+		totalTiles += tiles * tiles;
+	}
+
+	m_tileBounds.resize(totalTiles);
+	count = fread(m_tileBounds.data(), sizeof(TileBoundsType), totalTiles, filePtr);
+	fclose(filePtr);
+	if (count != (size_t)totalTiles)
+	{
+		return false;
+	}
+
+	m_levelOffsets.resize(m_header.levelCount);
+	offset = sizeof(FileHeaderType) + sizeof(TileBoundsType) * (long long)totalTiles;
+	for (level = 0; level < m_header.levelCount; level++)
+	{
+		tiles = (m_header.size / TERRAIN_CHUNK_SIZE) >> level;
+		m_levelOffsets[level] = offset;
+		offset += (long long)tiles * tiles * TERRAIN_CHUNK_VERTICES * TERRAIN_CHUNK_VERTICES * sizeof(unsigned short);
+	}
+
+	return true;
+}
+
+//	InitializeBuffers creates the index buffer shared by every chunk and the vertex buffers of the cache.
+//	Every quad is split along the same diagonal the morph heights of the middle vertices are taken on, so
+//	a fully morphed chunk has exactly the surface of its parent.
+bool TerrainClass::InitializeBuffers(ID3D11Device* device)
+{
+	vector<unsigned long> indices;
+	D3D11_BUFFER_DESC indexBufferDesc, vertexBufferDesc;
+	D3D11_SUBRESOURCE_DATA indexData;
+	HRESULT result;
+	int i, j, a, b, c, d;
+
+	for (j = 0; j < TERRAIN_CHUNK_SIZE; j++)
+	{
+		for (i = 0; i < TERRAIN_CHUNK_SIZE; i++)
+		{
+			a = j * TERRAIN_CHUNK_VERTICES + i;
+			b = a + 1;
+			c = a + TERRAIN_CHUNK_VERTICES;
+			d = c + 1;
+
+			indices.push_back(a);
+			indices.push_back(c);
+			indices.push_back(d);
+
+			indices.push_back(a);
+			indices.push_back(d);
+			indices.push_back(b);
+		}
+	}
+
+	m_indexCount = (int)indices.size();
+
+//	Setup the description of the Static Index Buffer:
+	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	indexBufferDesc.ByteWidth = sizeof(unsigned long) * m_indexCount;
+	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	indexBufferDesc.CPUAccessFlags = 0;
+	indexBufferDesc.MiscFlags = 0;
+	indexBufferDesc.StructureByteStride = 0;
+
+	indexData.pSysMem = indices.data();
+	indexData.SysMemPitch = 0;
+	indexData.SysMemSlicePitch = 0;
+
+	if (device)
+	{
+		result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
+		if (FAILED(result))
+		{
+			return false;
+		}
+	}
+
+//	The chunk vertex buffers are filled with UpdateSubresource when a chunk is loaded into them:
+	vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+	vertexBufferDesc.ByteWidth = sizeof(VertexType) * TERRAIN_CHUNK_VERTICES * TERRAIN_CHUNK_VERTICES;
+	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	vertexBufferDesc.CPUAccessFlags = 0;
+	vertexBufferDesc.MiscFlags = 0;
+	vertexBufferDesc.StructureByteStride = 0;
+
+	m_chunks.resize(TERRAIN_CACHE_SIZE);
+	for (i = 0; i < TERRAIN_CACHE_SIZE; i++)
+	{
+		m_chunks[i].level = 0;
+		m_chunks[i].x = 0;
+		m_chunks[i].z = 0;
+		m_chunks[i].state = CHUNK_FREE;
+		m_chunks[i].lastUsedFrame = 0;
+		m_chunks[i].pinned = false;
+		m_chunks[i].heights.resize(TERRAIN_CHUNK_VERTICES * TERRAIN_CHUNK_VERTICES);
+		m_chunks[i].vertexBuffer = 0;
+
+		if (device)
+		{
+			result = device->CreateBuffer(&vertexBufferDesc, NULL, &m_chunks[i].vertexBuffer);
+			if (FAILED(result))
+			{
+				m_chunks[i].vertexBuffer = 0;
+				return false;
+			}
+		}
+	}
+
+	for (i = TERRAIN_CACHE_SIZE - 1; i >= 0; i--)
+	{
+		m_freeChunks.push_back(i);
+	}
+
+	m_vertices.resize(TERRAIN_CHUNK_VERTICES * TERRAIN_CHUNK_VERTICES);
+
+	return true;
+}
+
+void TerrainClass::ShutdownBuffers()
+{
+	int i;
+
+	for (i = 0; i < (int)m_chunks.size(); i++)
+	{
+		if (m_chunks[i].vertexBuffer)
+		{
+			m_chunks[i].vertexBuffer->Release();
+			m_chunks[i].vertexBuffer = 0;
+		}
+	}
+
+	if (m_indexBuffer)
+	{
+		m_indexBuffer->Release();
+		m_indexBuffer = 0;
+	}
+
+	m_chunks.clear();
+	m_chunkMap.clear();
+	m_freeChunks.clear();
+	m_drawList.clear();
+	m_vertices.clear();
+
+	return;
+}
+
+//	GenerateHeight returns the height between zero and one at a point of the full resolution heightmap.
+//	It adds up octaves of value noise, each one with twice the frequency and half the amplitude of the
+//	one before, with the lattice values coming from an integer hash so every point can be generated on
+//	its own.
+float TerrainClass::GenerateHeight(int x, int z)
+{
+	unsigned int hash[4];
+	float height, amplitude, frequency, fx, fz, sx, sz;
+	int octave, ix, iz, i;
+
+	height = 0.0f;
+	amplitude = 0.5f;
+	frequency = 1.0f / 2048.0f;
+
+	for (octave = 0; octave < TERRAIN_OCTAVES; octave++)
+	{
+		fx = (float)x * frequency;
+		fz = (float)z * frequency;
+		ix = (int)floorf(fx);
+		iz = (int)floorf(fz);
+		fx -= (float)ix;
+		fz -= (float)iz;
+
+		for (i = 0; i < 4; i++)
+		{
+			hash[i] = (unsigned int)(ix + (i & 1)) * 374761393u + (unsigned int)(iz + (i >> 1)) * 668265263u + (unsigned int)octave * 2246822519u;
+			hash[i] = (hash[i] ^ (hash[i] >> 13)) * 1274126177u;
+			hash[i] = hash[i] ^ (hash[i] >> 16);
+		}
+
+		sx = fx * fx * (3.0f - 2.0f * fx);
+		sz = fz * fz * (3.0f - 2.0f * fz);
+
+		height += amplitude * ((1.0f - sz) * ((1.0f - sx) * (float)(hash[0] & 0xFFFF) + sx * (float)(hash[1] & 0xFFFF)) +
+			sz * ((1.0f - sx) * (float)(hash[2] & 0xFFFF) + sx * (float)(hash[3] & 0xFFFF))) / 65535.0f;
+
+		amplitude *= 0.5f;
+		frequency *= 2.0f;
+	}
+
+//	Flatten the valleys and sharpen the peaks:
+	return height * height * (3.0f - 2.0f * height);
+}
+
+long long TerrainClass::GetTileOffset(int level, int x, int z)
+{
+	int tiles;
+
+	tiles = (m_header.size / TERRAIN_CHUNK_SIZE) >> level;
+
+	return m_levelOffsets[level] + ((long long)z * tiles + x) * TERRAIN_CHUNK_VERTICES * TERRAIN_CHUNK_VERTICES * sizeof(unsigned short);
+}
+
+int TerrainClass::GetTileIndex(int level, int x, int z)
+{
+	return m_levelTiles[level] + z * ((m_header.size / TERRAIN_CHUNK_SIZE) >> level) + x;
+}
+
+//	SelectChunk walks the quadtree below a chunk that is on the video card. A chunk with too much error
+//	on screen is replaced by its visible children once all of them are on the video card too, until then
+//	the missing ones are requested and the chunk itself is drawn. Every chunk passed is marked as used,
+//	so the parents stay around to fall back on.
+void TerrainClass::SelectChunk(int level, int x, int z)
+{
+	XMVECTOR minimum, maximum;
+	int index, child, childX, childZ, i;
+	bool ready;
+
+	GetChunkBounds(level, x, z, minimum, maximum);
+	if (!IsChunkVisible(minimum, maximum))
+	{
+		return;
+	}
+
+	index = FindChunk(level, x, z);
+	if (index < 0 || m_chunks[index].state != CHUNK_READY)
+	{
+		return;
+	}
+
+	m_chunks[index].lastUsedFrame = m_frameNumber;
+
+	if (level > 0 && GetScreenError(level, minimum, maximum) > m_errorThreshold)
+	{
+		ready = true;
+		for (i = 0; i < 4; i++)
+		{
+			childX = x * 2 + (i & 1);
+			childZ = z * 2 + (i >> 1);
+
+			GetChunkBounds(level - 1, childX, childZ, minimum, maximum);
+			if (!IsChunkVisible(minimum, maximum))
+			{
+				continue;
+			}
+
+			child = FindChunk(level - 1, childX, childZ);
+			if (child >= 0 && m_chunks[child].state == CHUNK_READY)
+			{
+				m_chunks[child].lastUsedFrame = m_frameNumber;
+			}
+			else
+			{
+				RequestChunk(level - 1, childX, childZ);
+				ready = false;
+			}
+		}
+
+		if (ready)
+		{
+			for (i = 0; i < 4; i++)
+			{
+				SelectChunk(level - 1, x * 2 + (i & 1), z * 2 + (i >> 1));
+			}
+			return;
+		}
+	}
+
+	m_drawList.push_back(index);
+
+	return;
+}
+
+//	GetChunkBounds returns the box around a chunk from the height bounds stored for its tile.
+void TerrainClass::GetChunkBounds(int level, int x, int z, XMVECTOR& minimum, XMVECTOR& maximum)
+{
+	const TileBoundsType& bounds = m_tileBounds[GetTileIndex(level, x, z)];
+	float extent, scale;
+
+	extent = (float)(TERRAIN_CHUNK_SIZE << level) * m_header.spacing;
+	scale = m_header.heightScale / 65535.0f;
+
+	minimum = XMVectorSet(m_originX + (float)x * extent, m_header.baseHeight + (float)bounds.minimum * scale, m_originZ + (float)z * extent, 1.0f);
+	maximum = XMVectorSet(m_originX + (float)(x + 1) * extent, m_header.baseHeight + (float)bounds.maximum * scale, m_originZ + (float)(z + 1) * extent, 1.0f);
+
+	return;
+}
+
+//	IsChunkVisible tests the corner of the box furthest along each plane normal, the box is outside the
+//	frustum if that corner is behind any of the planes.
+bool TerrainClass::IsChunkVisible(XMVECTOR minimum, XMVECTOR maximum)
+{
+	XMVECTOR corner;
+	int i;
+
+	for (i = 0; i < 6; i++)
+	{
+		corner = XMVectorSelect(minimum, maximum, XMVectorGreaterOrEqual(m_frustumPlanes[i], XMVectorZero()));
+		if (XMVectorGetX(XMPlaneDotCoord(m_frustumPlanes[i], corner)) < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+//	GetScreenError projects the geometric error of a level to pixels at the closest point of the box.
+float TerrainClass::GetScreenError(int level, XMVECTOR minimum, XMVECTOR maximum)
+{
+	XMVECTOR cameraPosition, outside;
+	float distance;
+
+	cameraPosition = XMLoadFloat3(&m_cameraPosition);
+	outside = XMVectorMax(XMVectorSubtract(minimum, cameraPosition), XMVectorSubtract(cameraPosition, maximum));
+	outside = XMVectorMax(outside, XMVectorZero());
+
+	distance = XMVectorGetX(XMVector3Length(outside));
+	if (distance < 1.0f)
+	{
+		distance = 1.0f;
+	}
+
+	return m_header.levelErrors[level] * m_pixelsPerUnit / distance;
+}
+
+int TerrainClass::FindChunk(int level, int x, int z)
+{
+	unordered_map<unsigned long long, int>::iterator found;
+
+	found = m_chunkMap.find(((unsigned long long)level << 48) | ((unsigned long long)z << 24) | (unsigned long long)x);
+	if (found == m_chunkMap.end())
+	{
+		return -1;
+	}
+
+	return found->second;
+}
+
+//	RequestChunk queues a chunk for the loader thread unless it is already there or on its way. Requests
+//	that don't fit this frame are simply made again the next time the chunk is wanted.
+bool TerrainClass::RequestChunk(int level, int x, int z)
+{
+	ChunkType* chunk;
+	int index;
+
+	if (FindChunk(level, x, z) >= 0)
+	{
+		return true;
+	}
+
+	if (m_pendingCount >= TERRAIN_MAX_PENDING)
+	{
+		return false;
+	}
+
+	index = AllocateChunk();
+	if (index < 0)
+	{
+		return false;
+	}
+
+	chunk = &m_chunks[index];
+	chunk->level = level;
+	chunk->x = x;
+	chunk->z = z;
+	chunk->state = CHUNK_LOADING;
+	chunk->lastUsedFrame = m_frameNumber;
+	chunk->pinned = false;
+
+	m_chunkMap[((unsigned long long)level << 48) | ((unsigned long long)z << 24) | (unsigned long long)x] = index;
+	m_pendingCount++;
+
+	{
+		lock_guard<mutex> lock(m_queueMutex);
+		m_loadQueue.push_back(index);
+	}
+	m_queueCondition.notify_one();
+
+	return true;
+}
+
+//	AllocateChunk returns a free slot of the cache, or else evicts the chunk that has gone unused for the
+//	longest time. Chunks used this frame, pinned chunks and chunks still loading are never evicted.
+int TerrainClass::AllocateChunk()
+{
+	ChunkType* chunk;
+	int index, i;
+
+	if (!m_freeChunks.empty())
+	{
+		index = m_freeChunks.back();
+		m_freeChunks.pop_back();
+		return index;
+	}
+
+	index = -1;
+	for (i = 0; i < (int)m_chunks.size(); i++)
+	{
+		chunk = &m_chunks[i];
+		if (chunk->state == CHUNK_READY && !chunk->pinned && chunk->lastUsedFrame < m_frameNumber &&
+			(index < 0 || chunk->lastUsedFrame < m_chunks[index].lastUsedFrame))
+		{
+			index = i;
+		}
+	}
+
+	if (index >= 0)
+	{
+		chunk = &m_chunks[index];
+		m_chunkMap.erase(((unsigned long long)chunk->level << 48) | ((unsigned long long)chunk->z << 24) | (unsigned long long)chunk->x);
+		chunk->state = CHUNK_FREE;
+	}
+
+	return index;
+}
+
+//	UploadChunk turns the heights of a chunk into vertices and copies them into its vertex buffer. The
+//	color goes from grass to rock to snow with the height and is darkened on slopes facing away from one
+//	fixed direction, which is enough to make out the shape of the terrain without normals.
+void TerrainClass::UploadChunk(ID3D11DeviceContext* deviceContext, int index)
+{
+	ChunkType* chunk;
+	VertexType* vertex;
+	const unsigned short* heights;
+	float cellSize, startX, startZ, scale, height, slope, shade, t;
+	XMFLOAT4 color;
+	int i, j, left, right, back, front;
+
+	chunk = &m_chunks[index];
+	heights = chunk->heights.data();
+
+	cellSize = (float)(1 << chunk->level) * m_header.spacing;
+	startX = m_originX + (float)(chunk->x * TERRAIN_CHUNK_SIZE) * cellSize;
+	startZ = m_originZ + (float)(chunk->z * TERRAIN_CHUNK_SIZE) * cellSize;
+	scale = m_header.heightScale / 65535.0f;
+
+	for (j = 0; j < TERRAIN_CHUNK_VERTICES; j++)
+	{
+		for (i = 0; i < TERRAIN_CHUNK_VERTICES; i++)
+		{
+			vertex = &m_vertices[j * TERRAIN_CHUNK_VERTICES + i];
+			height = m_header.baseHeight + (float)heights[j * TERRAIN_CHUNK_VERTICES + i] * scale;
+
+			vertex->position = XMFLOAT3(startX + (float)i * cellSize, height, startZ + (float)j * cellSize);
+
+//	The parent level splits its quads along the same diagonal as this one:
+			if (i % 2 == 1 && j % 2 == 1)
+			{
+				vertex->morphHeight = m_header.baseHeight + 0.5f * (float)(heights[(j - 1) * TERRAIN_CHUNK_VERTICES + i - 1] + heights[(j + 1) * TERRAIN_CHUNK_VERTICES + i + 1]) * scale;
+			}
+			else if (i % 2 == 1)
+			{
+				vertex->morphHeight = m_header.baseHeight + 0.5f * (float)(heights[j * TERRAIN_CHUNK_VERTICES + i - 1] + heights[j * TERRAIN_CHUNK_VERTICES + i + 1]) * scale;
+			}
+			else if (j % 2 == 1)
+			{
+				vertex->morphHeight = m_header.baseHeight + 0.5f * (float)(heights[(j - 1) * TERRAIN_CHUNK_VERTICES + i] + heights[(j + 1) * TERRAIN_CHUNK_VERTICES + i]) * scale;
+			}
+			else
+			{
+				vertex->morphHeight = height;
+			}
+
+			t = (float)heights[j * TERRAIN_CHUNK_VERTICES + i] / 65535.0f;
+			if (t < 0.5f)
+			{
+				XMStoreFloat4(&color, XMVectorLerp(XMVectorSet(0.2f, 0.45f, 0.15f, 1.0f), XMVectorSet(0.45f, 0.4f, 0.3f, 1.0f), t * 2.0f));
+			}
+			else
+			{
+				XMStoreFloat4(&color, XMVectorLerp(XMVectorSet(0.45f, 0.4f, 0.3f, 1.0f), XMVectorSet(0.95f, 0.95f, 1.0f, 1.0f), (t < 0.75f) ? 0.0f : (t - 0.75f) * 4.0f));
+			}
+
+			left = (i > 0) ? i - 1 : i;
+			right = (i < TERRAIN_CHUNK_SIZE) ? i + 1 : i;
+			back = (j > 0) ? j - 1 : j;
+			front = (j < TERRAIN_CHUNK_SIZE) ? j + 1 : j;
+
+			slope = ((float)heights[j * TERRAIN_CHUNK_VERTICES + left] - (float)heights[j * TERRAIN_CHUNK_VERTICES + right]) / (float)(right - left) +
+				((float)heights[front * TERRAIN_CHUNK_VERTICES + i] - (float)heights[back * TERRAIN_CHUNK_VERTICES + i]) / (float)(front - back);
+			shade = 0.75f + 0.5f * slope * scale / cellSize;
+			shade = (shade < 0.3f) ? 0.3f : (shade > 1.0f) ? 1.0f : shade;
+
+			vertex->color = XMFLOAT4(color.x * shade, color.y * shade, color.z * shade, 1.0f);
+		}
+	}
+
+	if (deviceContext)
+	{
+		deviceContext->UpdateSubresource(chunk->vertexBuffer, 0, NULL, m_vertices.data(), 0, 0);
+	}
+
+	return;
+}
+
+//	LoaderThread reads the heights of the requested chunks from its own handle to the terrain file and
+//	hands them back through the upload queue, in the order they were requested. A tile that can't be read
+//	is handed back flat rather than left loading forever.
+void TerrainClass::LoaderThread()
+{
+	FILE* filePtr;
+	ChunkType* chunk;
+	int index;
+	bool result;
+
+	if (fopen_s(&filePtr, m_filename, "rb") != 0)
+	{
+		filePtr = 0;
+	}
+
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(m_queueMutex);
+			m_queueCondition.wait(lock, [this] { return m_quit || !m_loadQueue.empty(); });
+
+			if (m_quit)
+			{
+				break;
+			}
+
+			index = m_loadQueue.front();
+			m_loadQueue.pop_front();
+		}
+
+		chunk = &m_chunks[index];
+
+		result = filePtr && ReadTile(filePtr, chunk);
+		if (!result)
+		{
+			memset(chunk->heights.data(), 0, chunk->heights.size() * sizeof(unsigned short));
+		}
+
+		{
+			lock_guard<mutex> lock(m_queueMutex);
+			m_uploadQueue.push_back(index);
+		}
+	}
+
+	if (filePtr)
+	{
+		fclose(filePtr);
+	}
+
+	return;
+}
+
+bool TerrainClass::ReadTile(FILE* filePtr, ChunkType* chunk)
+{
+	size_t count;
+
+	if (_fseeki64(filePtr, GetTileOffset(chunk->level, chunk->x, chunk->z), SEEK_SET) != 0)
+	{
+		return false;
+	}
+
+	count = fread(chunk->heights.data(), sizeof(unsigned short), chunk->heights.size(), filePtr);
+
+	return count == chunk->heights.size();
+}
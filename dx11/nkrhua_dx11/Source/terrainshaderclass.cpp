@@ -0,0 +1,193 @@
+#include "../Headers/terrainshaderclass.h"
+
+TerrainShaderClass::TerrainShaderClass()
+{
+	m_ShaderManager = 0;
+	m_shaderFamily = -1;
+	m_permutation = 0;
+	m_terrainBuffer = 0;
+}
+
+TerrainShaderClass::TerrainShaderClass(const TerrainShaderClass& other)
+{
+
+}
+
+TerrainShaderClass::~TerrainShaderClass()
+{
+
+}
+
+//	Precompile compiles the permutations ahead of Initialize, the same way the color shader does.
+void TerrainShaderClass::Precompile(ShaderManagerClass* shaderManager)
+{
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+
+	if (wcscpy_s(vsFilename, 128, L"./Source/terrain.vs") != 0 || wcscpy_s(psFilename, 128, L"./Source/color.ps") != 0)
+	{
+		return;
+	}
+
+	shaderManager->Precompile(vsFilename, "TerrainVertexShader", psFilename, "ColorPixelShader", SHADER_LIT);
+
+	return;
+}
+
+bool TerrainShaderClass::Initialize(ID3D11Device* device, ShaderManagerClass* shaderManager)
+{
+	bool result;
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+	int error;
+
+	m_ShaderManager = shaderManager;
+
+//	Set the filename of the Vertex Shader:
+	error = wcscpy_s(vsFilename, 128, L"./Source/terrain.vs");
+	if (error != 0)
+	{
+		return false;
+	}
+
+//	The terrain only needs the colors interpolated, so it shares the Pixel Shader of the color shader:
+	error = wcscpy_s(psFilename, 128, L"./Source/color.ps");
+	if (error != 0)
+	{
+		return false;
+	}
+
+//	Initialize the Vertex and Pixel Shaders:
+	result = InitializeShader(device, vsFilename, psFilename);
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void TerrainShaderClass::Shutdown()
+{
+	ShutdownShader();
+
+	return;
+}
+
+//	SetParameters keeps the values shared by all chunks of a frame until the chunks are drawn. The
+//	threshold is the screen space error in pixels the terrain selection was made with.
+void TerrainShaderClass::SetParameters(XMMATRIX viewMatrix, XMMATRIX projectionMatrix, XMFLOAT3 cameraPosition, float errorThreshold)
+{
+	m_parameters.view = XMMatrixTranspose(viewMatrix);
+	m_parameters.projection = XMMatrixTranspose(projectionMatrix);
+	m_parameters.cameraPosition = cameraPosition;
+	m_parameters.parentError = 0.0f;
+	m_parameters.errorThreshold = errorThreshold;
+	m_parameters.padding = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+	return;
+}
+
+//	Render draws one chunk. The parent error is the geometric error of the level above the chunk times
+//	the pixels per unit at a distance of one, so dividing it by the distance gives pixels on screen.
+bool TerrainShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCount, float parentError)
+{
+	bool result;
+
+	result = SetShaderParameters(deviceContext, parentError);
+	if (!result)
+	{
+		return false;
+	}
+
+	RenderShader(deviceContext, indexCount);
+
+	return true;
+}
+
+void TerrainShaderClass::SetPermutation(unsigned int permutation)
+{
+	m_permutation = permutation;
+	return;
+}
+
+bool TerrainShaderClass::InitializeShader(ID3D11Device* device, WCHAR* vsFilename, WCHAR* psFilename)
+{
+	HRESULT result;
+	D3D11_BUFFER_DESC terrainBufferDesc;
+	ShaderInputType input;
+
+//	The terrain is drawn either unlit or lit, so the Shader Manager compiles two variants, both fed from the
+//	terrain vertex format:
+	input.flags = 0;
+	input.format = &TerrainVertexType::GetFormat();
+
+	m_shaderFamily = m_ShaderManager->AddShader(vsFilename, "TerrainVertexShader", psFilename, "ColorPixelShader", SHADER_LIT, &input, 1, NULL);
+	if (m_shaderFamily < 0)
+	{
+		return false;
+	}
+
+//	Setup the description of the Dynamic Constant Buffer that is in the Vertex Shader:
+	terrainBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	terrainBufferDesc.ByteWidth = sizeof(TerrainBufferType);
+	terrainBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	terrainBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	terrainBufferDesc.MiscFlags = 0;
+	terrainBufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&terrainBufferDesc, NULL, &m_terrainBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void TerrainShaderClass::ShutdownShader()
+{
+	if (m_terrainBuffer)
+	{
+		m_terrainBuffer->Release();
+		m_terrainBuffer = 0;
+	}
+
+//	The Shaders and the Layout belong to the Shader Manager which releases them on its own Shutdown.
+	m_shaderFamily = -1;
+	m_ShaderManager = 0;
+
+	return;
+}
+
+bool TerrainShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext, float parentError)
+{
+	HRESULT result;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+
+	m_parameters.parentError = parentError;
+
+//	Lock the Constant Buffer, copy the parameters in and unlock it again:
+	result = deviceContext->Map(m_terrainBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	memcpy(mappedResource.pData, &m_parameters, sizeof(TerrainBufferType));
+
+	deviceContext->Unmap(m_terrainBuffer, 0);
+
+	deviceContext->VSSetConstantBuffers(0, 1, &m_terrainBuffer);
+
+	return true;
+}
+
+void TerrainShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
+{
+	m_ShaderManager->SetShader(deviceContext, m_shaderFamily, m_permutation);
+
+	deviceContext->DrawIndexed(indexCount, 0, 0);
+
+	return;
+}
@@ -0,0 +1,36 @@
+//  The text vertex shader places the glyph quads of the Text Object on the screen. The quads are in pixels
+//  from the center of the screen, which the orthographic matrix of Direct3D takes to clip space. The depth
+//  is anything between the near and far plane, since text is drawn without the depth test.
+
+// Globals:
+cbuffer TextBuffer
+{
+    matrix orthoMatrix;
+};
+
+//  Typedefs:
+struct VertexInputType
+{
+    float2 position : POSITION;
+    float2 tex : TEXCOORD0;
+    float4 color : COLOR;
+};
+
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float2 tex : TEXCOORD0;
+    float4 color : COLOR;
+};
+
+//  Vertex Shader:
+PixelInputType TextVertexShader(VertexInputType input)
+{
+    PixelInputType output;
+
+    output.position = mul(float4(input.position, 1.0f, 1.0f), orthoMatrix);
+    output.tex = input.tex;
+    output.color = input.color;
+
+    return output;
+}
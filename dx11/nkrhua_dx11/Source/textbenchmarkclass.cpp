@@ -0,0 +1,54 @@
+#include "../Headers/textbenchmarkclass.h"
+
+#include <stdio.h>
+#include <chrono>
+
+void TextBenchmarkClass::Run(TextClass* text, int stringCount, int frameGlyphs, const char* report)
+{
+	vector<string> strings;
+	chrono::high_resolution_clock::time_point startTime;
+	FILE* reportPtr;
+	char line[64];
+	float times[2];
+	int glyphs[2];
+	int i, pass;
+
+	strings.resize(stringCount);
+	for (i = 0; i < stringCount; i++)
+	{
+		sprintf_s(line, sizeof(line), "object %d: %.3f ms, %d draws", i, 0.001f * (float)i, i % 97);
+		strings[i] = line;
+	}
+
+	for (pass = 0; pass < 2; pass++)
+	{
+		glyphs[pass] = 0;
+
+		startTime = chrono::high_resolution_clock::now();
+		for (i = 0; i < stringCount; i++)
+		{
+			if (text->GetGlyphCount() + 64 > frameGlyphs)
+			{
+				glyphs[pass] += text->GetGlyphCount();
+				text->Clear();
+			}
+
+			text->AddText(0.0f, 0.0f, strings[i].c_str(), XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f));
+		}
+		times[pass] = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+
+		glyphs[pass] += text->GetGlyphCount();
+		text->Clear();
+	}
+
+	if (fopen_s(&reportPtr, report, "a") != 0)
+	{
+		return;
+	}
+
+	fprintf(reportPtr, "%d strings, %d glyphs: laid out %.3f ms (%.0f glyphs/ms), from the cache %.3f ms (%.0f glyphs/ms), %d runs cached\n",
+		stringCount, glyphs[0], times[0], glyphs[0] / times[0], times[1], glyphs[1] / times[1], text->GetRunCount());
+	fclose(reportPtr);
+
+	return;
+}
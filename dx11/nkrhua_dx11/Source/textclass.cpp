@@ -0,0 +1,448 @@
+#include "../Headers/textclass.h"
+
+#include <math.h>
+#include <string.h>
+
+TextClass::TextClass()
+{
+	m_Font = 0;
+	m_maxGlyphs = 0;
+	m_halfWidth = 0.0f;
+	m_halfHeight = 0.0f;
+	m_frame = 0;
+	m_cacheHits = 0;
+	m_cacheMisses = 0;
+	m_glyphCount = 0;
+	m_ResourceRegistry = 0;
+	m_vertexBuffer.id = 0;
+	m_indexBuffer.id = 0;
+	m_textBuffer.id = 0;
+	m_sampleState.id = 0;
+	m_ShaderManager = 0;
+	m_shaderFamily = -1;
+}
+
+TextClass::TextClass(const TextClass& other)
+{
+
+}
+
+TextClass::~TextClass()
+{
+
+}
+
+//	Precompile compiles the text shaders ahead of Initialize, the same way the color shader does.
+void TextClass::Precompile(ShaderManagerClass* shaderManager)
+{
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+
+	if (wcscpy_s(vsFilename, 128, L"./Source/text.vs") != 0 || wcscpy_s(psFilename, 128, L"./Source/text.ps") != 0)
+	{
+		return;
+	}
+
+	shaderManager->Precompile(vsFilename, "TextVertexShader", psFilename, "TextPixelShader", 0);
+
+	return;
+}
+
+bool TextClass::Initialize(ID3D11Device* device, ResourceRegistryClass* resourceRegistry, ShaderManagerClass* shaderManager, FontClass* font,
+	int maxGlyphs, int screenWidth, int screenHeight)
+{
+	wchar_t vsFilename[128];
+	wchar_t psFilename[128];
+	int error;
+
+	if (maxGlyphs <= 0 || maxGlyphs > TEXT_MAX_GLYPHS)
+	{
+		return false;
+	}
+
+	m_Font = font;
+	m_maxGlyphs = maxGlyphs;
+	m_halfWidth = (float)screenWidth * 0.5f;
+	m_halfHeight = (float)screenHeight * 0.5f;
+	m_ResourceRegistry = resourceRegistry;
+	m_ShaderManager = shaderManager;
+
+	m_vertices.resize((size_t)maxGlyphs * 4);
+	m_glyphCount = 0;
+
+//	Set the filenames of the Vertex and Pixel Shader:
+	error = wcscpy_s(vsFilename, 128, L"./Source/text.vs");
+	if (error != 0)
+	{
+		return false;
+	}
+
+	error = wcscpy_s(psFilename, 128, L"./Source/text.ps");
+	if (error != 0)
+	{
+		return false;
+	}
+
+	if (!InitializeShader(vsFilename, psFilename))
+	{
+		return false;
+	}
+
+	return InitializeBuffers(device);
+}
+
+void TextClass::Shutdown()
+{
+	if (m_ResourceRegistry)
+	{
+		m_ResourceRegistry->Release(m_vertexBuffer);
+		m_ResourceRegistry->Release(m_indexBuffer);
+		m_ResourceRegistry->Release(m_textBuffer);
+		m_ResourceRegistry->Release(m_sampleState);
+		m_ResourceRegistry = 0;
+	}
+
+//	The Shaders belong to the Shader Manager which releases them on its own Shutdown.
+	m_shaderFamily = -1;
+	m_ShaderManager = 0;
+
+	m_runs.clear();
+	m_vertices.clear();
+	m_glyphCount = 0;
+	m_Font = 0;
+
+	return;
+}
+
+//	AddText moves the quads of the run of the string to where it is drawn, from the top left corner of the
+//	screen to the center the orthographic matrix has its origin in, and writes their four corners. The start
+//	is rounded to whole pixels so the texels of the glyphs land on pixels.
+bool TextClass::AddText(float positionX, float positionY, const char* text, XMFLOAT4 color)
+{
+	RunType* run;
+	const GlyphQuadType* quad;
+	TextVertexType* vertex;
+	PackedVector::XMUBYTEN4 packedColor;
+	float originX, originY;
+	int i, count;
+
+	run = FindRun(text);
+
+	count = (int)run->quads.size();
+	count = (m_glyphCount + count <= m_maxGlyphs) ? count : m_maxGlyphs - m_glyphCount;
+
+	PackedVector::XMStoreUByteN4(&packedColor, XMLoadFloat4(&color));
+
+	originX = floorf(positionX) - m_halfWidth;
+	originY = m_halfHeight - floorf(positionY);
+
+	vertex = &m_vertices[(size_t)m_glyphCount * 4];
+	for (i = 0; i < count; i++)
+	{
+		quad = &run->quads[i];
+
+		vertex[0].position = XMFLOAT2(originX + quad->left, originY - quad->top);
+		vertex[0].tex = XMFLOAT2(quad->texLeft, quad->texTop);
+		vertex[0].color = packedColor;
+
+		vertex[1].position = XMFLOAT2(originX + quad->right, originY - quad->top);
+		vertex[1].tex = XMFLOAT2(quad->texRight, quad->texTop);
+		vertex[1].color = packedColor;
+
+		vertex[2].position = XMFLOAT2(originX + quad->left, originY - quad->bottom);
+		vertex[2].tex = XMFLOAT2(quad->texLeft, quad->texBottom);
+		vertex[2].color = packedColor;
+
+		vertex[3].position = XMFLOAT2(originX + quad->right, originY - quad->bottom);
+		vertex[3].tex = XMFLOAT2(quad->texRight, quad->texBottom);
+		vertex[3].color = packedColor;
+
+		vertex += 4;
+	}
+
+	m_glyphCount += count;
+
+	return count == (int)run->quads.size();
+}
+
+//	Clear drops the text added so far without drawing it.
+void TextClass::Clear()
+{
+	m_glyphCount = 0;
+
+	return;
+}
+
+//	Render draws the text of the frame with the orthographic matrix of the screen and clears it for the next
+//	frame. The caller turns on blending and turns off the depth test around it.
+bool TextClass::Render(ID3D11DeviceContext* deviceContext, XMMATRIX orthoMatrix)
+{
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	TextBufferType* dataPtr;
+	ID3D11Buffer* vertexBuffer;
+	ID3D11Buffer* indexBuffer;
+	ID3D11Buffer* textBuffer;
+	ID3D11SamplerState* sampleState;
+	ID3D11ShaderResourceView* shaderResourceView;
+	unordered_map<string, RunType>::iterator run;
+	unsigned int stride, offset;
+	HRESULT result;
+
+	if (m_glyphCount > 0)
+	{
+		vertexBuffer = m_ResourceRegistry->Get(m_vertexBuffer);
+		indexBuffer = m_ResourceRegistry->Get(m_indexBuffer);
+		textBuffer = m_ResourceRegistry->Get(m_textBuffer);
+		sampleState = m_ResourceRegistry->Get(m_sampleState);
+		shaderResourceView = m_Font->GetShaderResourceView();
+
+		result = deviceContext->Map(vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		memcpy(mappedResource.pData, m_vertices.data(), (size_t)m_glyphCount * 4 * sizeof(TextVertexType));
+
+		deviceContext->Unmap(vertexBuffer, 0);
+
+		result = deviceContext->Map(textBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		dataPtr = (TextBufferType*)mappedResource.pData;
+		dataPtr->ortho = XMMatrixTranspose(orthoMatrix);
+
+		deviceContext->Unmap(textBuffer, 0);
+
+		if (!m_ShaderManager->SetShader(deviceContext, m_shaderFamily, 0))
+		{
+			return false;
+		}
+
+		stride = sizeof(TextVertexType);
+		offset = 0;
+
+		deviceContext->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+		deviceContext->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R16_UINT, 0);
+		deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		deviceContext->VSSetConstantBuffers(0, 1, &textBuffer);
+		deviceContext->PSSetShaderResources(0, 1, &shaderResourceView);
+		deviceContext->PSSetSamplers(0, 1, &sampleState);
+
+		deviceContext->DrawIndexed(m_glyphCount * 6, 0, 0);
+	}
+
+	m_glyphCount = 0;
+
+//	Keep the cache from growing with text that changes every frame:
+	if ((int)m_runs.size() > TEXT_RUN_CACHE_SIZE)
+	{
+		for (run = m_runs.begin(); run != m_runs.end();)
+		{
+			if (run->second.lastFrame == m_frame)
+			{
+				run++;
+			}
+			else
+			{
+				run = m_runs.erase(run);
+			}
+		}
+	}
+
+	m_frame++;
+
+	return true;
+}
+
+int TextClass::GetGlyphCount()
+{
+	return m_glyphCount;
+}
+
+int TextClass::GetRunCount()
+{
+	return (int)m_runs.size();
+}
+
+int TextClass::GetCacheHitCount()
+{
+	return m_cacheHits;
+}
+
+int TextClass::GetCacheMissCount()
+{
+	return m_cacheMisses;
+}
+
+bool TextClass::InitializeShader(WCHAR* vsFilename, WCHAR* psFilename)
+{
+	ShaderInputType input;
+
+	input.flags = 0;
+	input.format = &TextVertexType::GetFormat();
+
+	m_shaderFamily = m_ShaderManager->AddShader(vsFilename, "TextVertexShader", psFilename, "TextPixelShader", 0, &input, 1, NULL);
+	if (m_shaderFamily < 0)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+//	InitializeBuffers creates the dynamic vertex buffer for the quads of a frame, the index buffer that
+//	splits every quad into two triangles, the constant buffer and the sampler. The glyphs are drawn at the
+//	size they were rasterized at, so the sampler takes the nearest texel.
+bool TextClass::InitializeBuffers(ID3D11Device* device)
+{
+	D3D11_BUFFER_DESC bufferDesc;
+	D3D11_SUBRESOURCE_DATA indexData;
+	D3D11_SAMPLER_DESC samplerDesc;
+	ID3D11Buffer* buffer;
+	ID3D11SamplerState* sampleState;
+	vector<unsigned short> indices;
+	HRESULT result;
+	int i;
+
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = sizeof(TextVertexType) * m_maxGlyphs * 4;
+	bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	bufferDesc.MiscFlags = 0;
+	bufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_vertexBuffer = m_ResourceRegistry->Register(buffer);
+
+	indices.resize((size_t)m_maxGlyphs * 6);
+	for (i = 0; i < m_maxGlyphs; i++)
+	{
+		indices[i * 6 + 0] = (unsigned short)(i * 4 + 0);
+		indices[i * 6 + 1] = (unsigned short)(i * 4 + 1);
+		indices[i * 6 + 2] = (unsigned short)(i * 4 + 2);
+		indices[i * 6 + 3] = (unsigned short)(i * 4 + 2);
+		indices[i * 6 + 4] = (unsigned short)(i * 4 + 1);
+		indices[i * 6 + 5] = (unsigned short)(i * 4 + 3);
+	}
+
+	bufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	bufferDesc.ByteWidth = sizeof(unsigned short) * m_maxGlyphs * 6;
+	bufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	bufferDesc.CPUAccessFlags = 0;
+
+	indexData.pSysMem = indices.data();
+	indexData.SysMemPitch = 0;
+	indexData.SysMemSlicePitch = 0;
+
+	result = device->CreateBuffer(&bufferDesc, &indexData, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_indexBuffer = m_ResourceRegistry->Register(buffer);
+
+	bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	bufferDesc.ByteWidth = sizeof(TextBufferType);
+	bufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+	result = device->CreateBuffer(&bufferDesc, NULL, &buffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_textBuffer = m_ResourceRegistry->Register(buffer);
+
+	samplerDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_POINT;
+	samplerDesc.AddressU = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressV = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
+	samplerDesc.MipLODBias = 0.0f;
+	samplerDesc.MaxAnisotropy = 1;
+	samplerDesc.ComparisonFunc = D3D11_COMPARISON_ALWAYS;
+	samplerDesc.BorderColor[0] = 0.0f;
+	samplerDesc.BorderColor[1] = 0.0f;
+	samplerDesc.BorderColor[2] = 0.0f;
+	samplerDesc.BorderColor[3] = 0.0f;
+	samplerDesc.MinLOD = 0.0f;
+	samplerDesc.MaxLOD = D3D11_FLOAT32_MAX;
+
+	result = device->CreateSamplerState(&samplerDesc, &sampleState);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	m_sampleState = m_ResourceRegistry->Register(sampleState);
+
+	return true;
+}
+
+//	FindRun returns the run of the string, laying it out first if it isn't cached. The pen starts at the top
+//	left corner of the first glyph and every glyph moves it right by its advance. Spaces only move the pen.
+TextClass::RunType* TextClass::FindRun(const char* text)
+{
+	unordered_map<string, RunType>::iterator found;
+	RunType* run;
+	const FontClass::GlyphType* glyph;
+	GlyphQuadType quad;
+	float penX, penY;
+	int i;
+
+	m_key.assign(text);
+
+	found = m_runs.find(m_key);
+	if (found != m_runs.end())
+	{
+		found->second.lastFrame = m_frame;
+		m_cacheHits++;
+		return &found->second;
+	}
+
+	run = &m_runs[m_key];
+	run->lastFrame = m_frame;
+	m_cacheMisses++;
+
+	penX = 0.0f;
+	penY = 0.0f;
+	for (i = 0; text[i] != 0; i++)
+	{
+		if (text[i] == '\n')
+		{
+			penX = 0.0f;
+			penY += m_Font->GetLineHeight();
+			continue;
+		}
+
+		glyph = &m_Font->GetGlyph(text[i]);
+
+		if (text[i] != ' ')
+		{
+			quad.left = penX;
+			quad.top = penY;
+			quad.right = penX + glyph->width;
+			quad.bottom = penY + glyph->height;
+			quad.texLeft = glyph->left;
+			quad.texTop = glyph->top;
+			quad.texRight = glyph->right;
+			quad.texBottom = glyph->bottom;
+
+			run->quads.push_back(quad);
+		}
+
+		penX += glyph->advance;
+	}
+
+	return run;
+}
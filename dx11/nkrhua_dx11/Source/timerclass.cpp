@@ -0,0 +1,64 @@
+#include "../Headers/timerclass.h"
+
+//	Frames longer than this are clamped, so a stall like dragging the window does not make everything
+//	that runs on the frame time jump ahead.
+const float TIMER_MAX_FRAME_TIME = 100.0f;
+
+TimerClass::TimerClass()
+{
+}
+
+TimerClass::TimerClass(const TimerClass& other)
+{
+}
+
+TimerClass::~TimerClass()
+{
+}
+
+bool TimerClass::Initialize()
+{
+	INT64 frequency;
+
+//	Get the cycles per second speed for this system:
+	QueryPerformanceFrequency((LARGE_INTEGER*)&frequency);
+	if (frequency == 0)
+	{
+		return false;
+	}
+
+//	Store it in floating point, in cycles per millisecond:
+	m_frequency = (float)frequency / 1000.0f;
+
+	QueryPerformanceCounter((LARGE_INTEGER*)&m_startTime);
+	m_frameTime = 0.0f;
+
+	return true;
+}
+
+//	Frame is called once per frame and measures the time since the previous call.
+void TimerClass::Frame()
+{
+	INT64 currentTime;
+	INT64 elapsedTicks;
+
+	QueryPerformanceCounter((LARGE_INTEGER*)&currentTime);
+
+	elapsedTicks = currentTime - m_startTime;
+	m_frameTime = (float)elapsedTicks / m_frequency;
+
+	if (m_frameTime > TIMER_MAX_FRAME_TIME)
+	{
+		m_frameTime = TIMER_MAX_FRAME_TIME;
+	}
+
+	m_startTime = currentTime;
+
+	return;
+}
+
+//	GetTime returns the length of the last frame in milliseconds.
+float TimerClass::GetTime()
+{
+	return m_frameTime;
+}
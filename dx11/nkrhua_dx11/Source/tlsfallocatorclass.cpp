@@ -0,0 +1,475 @@
+#include "../Headers/tlsfallocatorclass.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+//	The index of the lowest and of the highest set bit. The mask is never zero where these are used.
+static int FindLowestBit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+
+	_BitScanForward(&index, mask);
+
+	return (int)index;
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+static int FindHighestBit(unsigned int mask)
+{
+#if defined(_MSC_VER)
+	unsigned long index;
+
+	_BitScanReverse(&index, mask);
+
+	return (int)index;
+#else
+	return 31 - __builtin_clz(mask);
+#endif
+}
+
+TLSFAllocatorClass::TLSFAllocatorClass()
+{
+	m_capacity = 0;
+	m_usedSize = 0;
+	m_usedCount = 0;
+	m_firstBlock = -1;
+	m_lastBlock = -1;
+	m_firstLevelMap = 0;
+}
+
+TLSFAllocatorClass::TLSFAllocatorClass(const TLSFAllocatorClass& other)
+{
+
+}
+
+TLSFAllocatorClass::~TLSFAllocatorClass()
+{
+
+}
+
+//	Initialize starts the heap off as one free block of the given capacity.
+bool TLSFAllocatorClass::Initialize(unsigned int capacity)
+{
+	int i, j, block;
+
+	if (capacity == 0 || capacity > 0x7FFFFFFF)
+	{
+		return false;
+	}
+
+	m_capacity = capacity;
+	m_usedSize = 0;
+	m_usedCount = 0;
+	m_blocks.clear();
+	m_unusedBlocks.clear();
+
+	m_firstLevelMap = 0;
+	for (i = 0; i < TLSF_FIRST_LEVEL_COUNT; i++)
+	{
+		m_secondLevelMap[i] = 0;
+		for (j = 0; j < TLSF_SECOND_LEVEL_COUNT; j++)
+		{
+			m_freeLists[i][j] = -1;
+		}
+	}
+
+	block = CreateBlock();
+	m_blocks[block].offset = 0;
+	m_blocks[block].size = capacity;
+	InsertFreeBlock(block);
+	m_firstBlock = block;
+	m_lastBlock = block;
+
+	return true;
+}
+
+void TLSFAllocatorClass::Shutdown()
+{
+	m_blocks.clear();
+	m_unusedBlocks.clear();
+	m_capacity = 0;
+	m_firstBlock = -1;
+	m_lastBlock = -1;
+
+	return;
+}
+
+//	Allocate takes the first free block from the smallest list whose blocks are all large enough and gives
+//	the rest of it back as a new free block.
+int TLSFAllocatorClass::Allocate(unsigned int size)
+{
+	int block, rest;
+
+	if (size == 0 || size > m_capacity - m_usedSize)
+	{
+		return -1;
+	}
+
+	block = FindFreeBlock(size);
+	if (block == -1)
+	{
+		return -1;
+	}
+
+	RemoveFreeBlock(block);
+
+	if (m_blocks[block].size > size)
+	{
+		rest = CreateBlock();
+		m_blocks[rest].offset = m_blocks[block].offset + size;
+		m_blocks[rest].size = m_blocks[block].size - size;
+		m_blocks[rest].previousBlock = block;
+		m_blocks[rest].nextBlock = m_blocks[block].nextBlock;
+		if (m_blocks[rest].nextBlock != -1)
+		{
+			m_blocks[m_blocks[rest].nextBlock].previousBlock = rest;
+		}
+		else
+		{
+			m_lastBlock = rest;
+		}
+
+		m_blocks[block].nextBlock = rest;
+		m_blocks[block].size = size;
+		InsertFreeBlock(rest);
+	}
+
+	m_blocks[block].free = false;
+	m_usedSize += size;
+	m_usedCount++;
+
+	return block;
+}
+
+//	Free merges the block with the free blocks on either side of it before putting it on its list.
+void TLSFAllocatorClass::Free(int block)
+{
+	int neighbour;
+
+	if (block < 0 || block >= (int)m_blocks.size() || m_blocks[block].free)
+	{
+		return;
+	}
+
+	m_usedSize -= m_blocks[block].size;
+	m_usedCount--;
+	m_blocks[block].free = true;
+
+	neighbour = m_blocks[block].previousBlock;
+	if (neighbour != -1 && m_blocks[neighbour].free)
+	{
+		RemoveFreeBlock(neighbour);
+		m_blocks[neighbour].size += m_blocks[block].size;
+		m_blocks[neighbour].nextBlock = m_blocks[block].nextBlock;
+		if (m_blocks[block].nextBlock != -1)
+		{
+			m_blocks[m_blocks[block].nextBlock].previousBlock = neighbour;
+		}
+		else
+		{
+			m_lastBlock = neighbour;
+		}
+
+		DestroyBlock(block);
+		block = neighbour;
+	}
+
+	neighbour = m_blocks[block].nextBlock;
+	if (neighbour != -1 && m_blocks[neighbour].free)
+	{
+		RemoveFreeBlock(neighbour);
+		m_blocks[block].size += m_blocks[neighbour].size;
+		m_blocks[block].nextBlock = m_blocks[neighbour].nextBlock;
+		if (m_blocks[neighbour].nextBlock != -1)
+		{
+			m_blocks[m_blocks[neighbour].nextBlock].previousBlock = block;
+		}
+		else
+		{
+			m_lastBlock = block;
+		}
+
+		DestroyBlock(neighbour);
+	}
+
+	InsertFreeBlock(block);
+
+	return;
+}
+
+//	SlideDown takes the free block below out of the lists and puts its space above the block, merged with
+//	the free block there if there is one.
+bool TLSFAllocatorClass::SlideDown(int block)
+{
+	int below, before, above;
+	unsigned int gap;
+
+	below = m_blocks[block].previousBlock;
+	if (m_blocks[block].free || below == -1 || !m_blocks[below].free)
+	{
+		return false;
+	}
+
+	RemoveFreeBlock(below);
+	gap = m_blocks[below].size;
+	m_blocks[block].offset = m_blocks[below].offset;
+
+	before = m_blocks[below].previousBlock;
+	m_blocks[block].previousBlock = before;
+	if (before != -1)
+	{
+		m_blocks[before].nextBlock = block;
+	}
+	else
+	{
+		m_firstBlock = block;
+	}
+
+	above = m_blocks[block].nextBlock;
+	if (above != -1 && m_blocks[above].free)
+	{
+		RemoveFreeBlock(above);
+		m_blocks[above].offset -= gap;
+		m_blocks[above].size += gap;
+		InsertFreeBlock(above);
+		DestroyBlock(below);
+	}
+	else
+	{
+		m_blocks[below].offset = m_blocks[block].offset + m_blocks[block].size;
+		m_blocks[below].previousBlock = block;
+		m_blocks[below].nextBlock = above;
+		m_blocks[block].nextBlock = below;
+		if (above != -1)
+		{
+			m_blocks[above].previousBlock = below;
+		}
+		else
+		{
+			m_lastBlock = below;
+		}
+
+		InsertFreeBlock(below);
+	}
+
+	return true;
+}
+
+unsigned int TLSFAllocatorClass::GetOffset(int block)
+{
+	return m_blocks[block].offset;
+}
+
+unsigned int TLSFAllocatorClass::GetSize(int block)
+{
+	return m_blocks[block].size;
+}
+
+//	Free blocks are always merged, so there is never more than one between two blocks in use.
+int TLSFAllocatorClass::GetNextUsedBlock(int block)
+{
+	block = (block == -1) ? m_firstBlock : m_blocks[block].nextBlock;
+	if (block != -1 && m_blocks[block].free)
+	{
+		block = m_blocks[block].nextBlock;
+	}
+
+	return block;
+}
+
+unsigned int TLSFAllocatorClass::GetCapacity()
+{
+	return m_capacity;
+}
+
+unsigned int TLSFAllocatorClass::GetUsedSize()
+{
+	return m_usedSize;
+}
+
+//	The largest free block is on the highest list that has any, which only needs to be searched itself.
+unsigned int TLSFAllocatorClass::GetLargestFreeSize()
+{
+	unsigned int largest;
+	int firstLevel, secondLevel, block;
+
+	if (m_firstLevelMap == 0)
+	{
+		return 0;
+	}
+
+	firstLevel = FindHighestBit(m_firstLevelMap);
+	secondLevel = FindHighestBit(m_secondLevelMap[firstLevel]);
+
+	largest = 0;
+	for (block = m_freeLists[firstLevel][secondLevel]; block != -1; block = m_blocks[block].nextFree)
+	{
+		largest = (m_blocks[block].size > largest) ? m_blocks[block].size : largest;
+	}
+
+	return largest;
+}
+
+int TLSFAllocatorClass::GetBlockCount()
+{
+	return m_usedCount;
+}
+
+//	MapSize finds the list a block of the given size goes on. Sizes below the second level count each get a
+//	list of their own on the first level, above that the first level is the highest set bit of the size and
+//	the second level the next TLSF_SECOND_LEVEL_BITS bits below it.
+void TLSFAllocatorClass::MapSize(unsigned int size, int& firstLevel, int& secondLevel)
+{
+	int highestBit;
+
+	if (size < TLSF_SECOND_LEVEL_COUNT)
+	{
+		firstLevel = 0;
+		secondLevel = (int)size;
+		return;
+	}
+
+	highestBit = FindHighestBit(size);
+	secondLevel = (int)(size >> (highestBit - TLSF_SECOND_LEVEL_BITS)) - TLSF_SECOND_LEVEL_COUNT;
+	firstLevel = highestBit - TLSF_SECOND_LEVEL_BITS + 1;
+
+	return;
+}
+
+//	FindFreeBlock rounds the size up to the start of the next list, so that any block on the list it maps
+//	to is large enough, and takes the first list at or above that one that has blocks.
+int TLSFAllocatorClass::FindFreeBlock(unsigned int size)
+{
+	unsigned int mask;
+	int firstLevel, secondLevel;
+
+	if (size >= TLSF_SECOND_LEVEL_COUNT)
+	{
+		size += (1u << (FindHighestBit(size) - TLSF_SECOND_LEVEL_BITS)) - 1;
+	}
+
+	MapSize(size, firstLevel, secondLevel);
+
+	mask = m_secondLevelMap[firstLevel] & (0xFFFFFFFFu << secondLevel);
+	if (mask == 0)
+	{
+		if (firstLevel + 1 >= TLSF_FIRST_LEVEL_COUNT)
+		{
+			return -1;
+		}
+
+		mask = m_firstLevelMap & (0xFFFFFFFFu << (firstLevel + 1));
+		if (mask == 0)
+		{
+			return -1;
+		}
+
+		firstLevel = FindLowestBit(mask);
+		mask = m_secondLevelMap[firstLevel];
+	}
+
+	secondLevel = FindLowestBit(mask);
+
+	return m_freeLists[firstLevel][secondLevel];
+}
+
+void TLSFAllocatorClass::InsertFreeBlock(int block)
+{
+	int firstLevel, secondLevel, head;
+
+	MapSize(m_blocks[block].size, firstLevel, secondLevel);
+
+	head = m_freeLists[firstLevel][secondLevel];
+	m_blocks[block].free = true;
+	m_blocks[block].previousFree = -1;
+	m_blocks[block].nextFree = head;
+	if (head != -1)
+	{
+		m_blocks[head].previousFree = block;
+	}
+
+	m_freeLists[firstLevel][secondLevel] = block;
+	m_firstLevelMap |= 1u << firstLevel;
+	m_secondLevelMap[firstLevel] |= 1u << secondLevel;
+
+	return;
+}
+
+void TLSFAllocatorClass::RemoveFreeBlock(int block)
+{
+	int firstLevel, secondLevel;
+
+	MapSize(m_blocks[block].size, firstLevel, secondLevel);
+
+	if (m_blocks[block].previousFree != -1)
+	{
+		m_blocks[m_blocks[block].previousFree].nextFree = m_blocks[block].nextFree;
+	}
+	else
+	{
+		m_freeLists[firstLevel][secondLevel] = m_blocks[block].nextFree;
+	}
+
+	if (m_blocks[block].nextFree != -1)
+	{
+		m_blocks[m_blocks[block].nextFree].previousFree = m_blocks[block].previousFree;
+	}
+
+	if (m_freeLists[firstLevel][secondLevel] == -1)
+	{
+		m_secondLevelMap[firstLevel] &= ~(1u << secondLevel);
+		if (m_secondLevelMap[firstLevel] == 0)
+		{
+			m_firstLevelMap &= ~(1u << firstLevel);
+		}
+	}
+
+	m_blocks[block].previousFree = -1;
+	m_blocks[block].nextFree = -1;
+
+	return;
+}
+
+//	The block records are reused from a list of destroyed ones, so the array only grows to the most blocks
+//	the heap has been split into at once.
+int TLSFAllocatorClass::CreateBlock()
+{
+	BlockType blockData;
+	int block;
+
+	blockData.offset = 0;
+	blockData.size = 0;
+	blockData.previousBlock = -1;
+	blockData.nextBlock = -1;
+	blockData.previousFree = -1;
+	blockData.nextFree = -1;
+	blockData.free = true;
+
+	if (!m_unusedBlocks.empty())
+	{
+		block = m_unusedBlocks.back();
+		m_unusedBlocks.pop_back();
+		m_blocks[block] = blockData;
+	}
+	else
+	{
+		block = (int)m_blocks.size();
+		m_blocks.push_back(blockData);
+	}
+
+	return block;
+}
+
+void TLSFAllocatorClass::DestroyBlock(int block)
+{
+	m_blocks[block].size = 0;
+	m_blocks[block].free = true;
+	m_blocks[block].previousBlock = -1;
+	m_blocks[block].nextBlock = -1;
+	m_unusedBlocks.push_back(block);
+
+	return;
+}
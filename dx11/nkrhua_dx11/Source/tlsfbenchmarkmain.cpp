@@ -0,0 +1,108 @@
+//	The TLSF benchmark churns a TLSF Allocator the way the Geometry Heap churns its index space: it fills the
+//	heap three quarters full with blocks of random sizes, then over and over frees a random block and
+//	allocates one of another size, and finally slides every block down until the free space is all at the
+//	top. It prints the time a Free and an Allocate took on average and how fragmented the heap was before and
+//	after packing it. Nothing in it needs Direct3D. It is not part of the engine's project and is built on its
+//	own, for example with:
+//	g++ -O2 -o tlsfbenchmark Source/tlsfbenchmarkmain.cpp Source/tlsfallocatorclass.cpp
+//	and run as: tlsfbenchmark [capacity] [operations]
+#include "../Headers/tlsfallocatorclass.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+//	The sizes of the blocks, like the index counts of the meshes of the scene.
+static const unsigned int BENCHMARK_MIN_SIZE = 36;
+static const unsigned int BENCHMARK_MAX_SIZE = 16384;
+
+int main(int argc, char* argv[])
+{
+	TLSFAllocatorClass allocator;
+	vector<int> blocks;
+	chrono::high_resolution_clock::time_point startTime;
+	float churnTime, packTime;
+	unsigned int capacity, seed, size, fragmentedLargest;
+	int operationCount, i, index, block, failures, moves;
+
+	capacity = argc > 1 ? (unsigned int)atoi(argv[1]) : 4 * 1024 * 1024;
+	operationCount = argc > 2 ? atoi(argv[2]) : 1000000;
+	if (capacity < 4 * BENCHMARK_MAX_SIZE || operationCount <= 0)
+	{
+		fprintf(stderr, "usage: %s [capacity, at least %u] [operations]\n", argv[0], 4 * BENCHMARK_MAX_SIZE);
+		return 1;
+	}
+
+	if (!allocator.Initialize(capacity))
+	{
+		fprintf(stderr, "Could not create a heap of %u\n", capacity);
+		return 1;
+	}
+
+	seed = 1;
+	auto random = [&seed]()
+	{
+		seed = seed * 1664525 + 1013904223;
+		return seed >> 8;
+	};
+
+//	Fill the heap three quarters full:
+	while (allocator.GetUsedSize() < capacity / 4 * 3)
+	{
+		size = BENCHMARK_MIN_SIZE + random() % (BENCHMARK_MAX_SIZE - BENCHMARK_MIN_SIZE);
+		block = allocator.Allocate(size);
+		if (block == -1)
+		{
+			break;
+		}
+
+		blocks.push_back(block);
+	}
+
+//	Free a random block and allocate one of a new size in its place. Both are timed together, as reading
+//	the clock would take about as long as either of them:
+	failures = 0;
+	startTime = chrono::high_resolution_clock::now();
+	for (i = 0; i < operationCount; i++)
+	{
+		index = (int)(random() % (unsigned int)blocks.size());
+		size = BENCHMARK_MIN_SIZE + random() % (BENCHMARK_MAX_SIZE - BENCHMARK_MIN_SIZE);
+
+		allocator.Free(blocks[index]);
+		block = allocator.Allocate(size);
+
+//	A size that no longer fits is tried again smaller, so the number of blocks stays the same:
+		while (block == -1)
+		{
+			failures++;
+			size /= 2;
+			block = allocator.Allocate(size > 0 ? size : 1);
+		}
+
+		blocks[index] = block;
+	}
+	churnTime = chrono::duration<float, nano>(chrono::high_resolution_clock::now() - startTime).count();
+
+	fragmentedLargest = allocator.GetLargestFreeSize();
+
+//	Slide every block down over the free space below it, the way Defragment does over a few frames:
+	moves = 0;
+	startTime = chrono::high_resolution_clock::now();
+	for (block = allocator.GetNextUsedBlock(-1); block != -1; block = allocator.GetNextUsedBlock(block))
+	{
+		if (allocator.SlideDown(block))
+		{
+			moves++;
+		}
+	}
+	packTime = chrono::duration<float, milli>(chrono::high_resolution_clock::now() - startTime).count();
+
+	printf("%d blocks in %u, %d operations: %.1f ns a free and allocate, %d allocations retried smaller\n", allocator.GetBlockCount(),
+		capacity, operationCount, churnTime / operationCount, failures);
+	printf("largest free block %u of %u free before packing, %u after sliding %d blocks down in %.3f ms\n", fragmentedLargest,
+		capacity - allocator.GetUsedSize(), allocator.GetLargestFreeSize(), moves, packTime);
+
+	allocator.Shutdown();
+
+	return 0;
+}
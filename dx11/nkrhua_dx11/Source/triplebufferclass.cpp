@@ -0,0 +1,91 @@
+#include "../Headers/triplebufferclass.h"
+
+//	The middle slot carries this bit while it holds a slot that was published and not yet acquired.
+static const int TRIPLE_BUFFER_FRESH = 4;
+static const int TRIPLE_BUFFER_SLOT_MASK = 3;
+
+TripleBufferClass::TripleBufferClass()
+{
+	m_middle = 1;
+	m_write = 0;
+	m_read = 2;
+	m_publishCount = 0;
+	m_droppedCount = 0;
+}
+
+TripleBufferClass::TripleBufferClass(const TripleBufferClass& other)
+{
+
+}
+
+TripleBufferClass::~TripleBufferClass()
+{
+
+}
+
+//	Initialize gives the writer slot 0 and the reader slot 2, so nothing is read before the first Publish.
+void TripleBufferClass::Initialize()
+{
+	m_middle = 1;
+	m_write = 0;
+	m_read = 2;
+	m_publishCount = 0;
+	m_droppedCount = 0;
+
+	return;
+}
+
+//	The slot the writer fills next. Only the writer may call this and Publish.
+int TripleBufferClass::GetWriteSlot()
+{
+	return m_write;
+}
+
+//	Publish puts the written slot in the middle and gives the writer the one that was there. If that one
+//	was never acquired, the reader skipped it.
+void TripleBufferClass::Publish()
+{
+	int previous;
+
+	previous = m_middle.exchange(m_write | TRIPLE_BUFFER_FRESH);
+
+	if (previous & TRIPLE_BUFFER_FRESH)
+	{
+		m_droppedCount++;
+	}
+
+	m_write = previous & TRIPLE_BUFFER_SLOT_MASK;
+	m_publishCount++;
+
+	return;
+}
+
+//	Acquire swaps the slot of the reader for the middle one if that has been published since the last
+//	Acquire, and returns whether it did. Only the reader may call this and GetReadSlot.
+bool TripleBufferClass::Acquire()
+{
+	if (!(m_middle.load() & TRIPLE_BUFFER_FRESH))
+	{
+		return false;
+	}
+
+	m_read = m_middle.exchange(m_read) & TRIPLE_BUFFER_SLOT_MASK;
+
+	return true;
+}
+
+int TripleBufferClass::GetReadSlot()
+{
+	return m_read;
+}
+
+//	The counts belong to the writer, so the reader should only look at them once the writer has stopped.
+int TripleBufferClass::GetPublishCount()
+{
+	return m_publishCount;
+}
+
+int TripleBufferClass::GetDroppedCount()
+{
+	return m_droppedCount;
+}
@@ -0,0 +1,20 @@
+//  The upscale vertex shader draws one triangle that covers the whole screen, made from the vertex id alone,
+//  so it needs no vertex buffer and no input layout. The texture coordinates run from 0 to 1 over the screen.
+
+//  Typedefs:
+struct PixelInputType
+{
+    float4 position : SV_POSITION;
+    float2 tex : TEXCOORD0;
+};
+
+//  Vertex Shader:
+PixelInputType UpscaleVertexShader(uint vertexID : SV_VertexID)
+{
+    PixelInputType output;
+
+    output.tex = float2((vertexID << 1) & 2, vertexID & 2);
+    output.position = float4(output.tex * float2(2.0f, -2.0f) + float2(-1.0f, 1.0f), 0.0f, 1.0f);
+
+    return output;
+}